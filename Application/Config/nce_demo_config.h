@@ -43,6 +43,10 @@
 
 #define PUBLISH_PAYLOAD_FORMAT    "Welcome to 1NCE's Solution"
 
+/* Time a periodic uplink may move to go out while the modem is awake anyway,
+ * instead of waking up the radio on its own (Core/Inc/uplink_scheduler.h). */
+#define CONFIG_UPLINK_SLACK_SECONDS    10
+
 
 
 /* C2D Parameters */
@@ -72,6 +76,9 @@
     #define CONFIG_NCE_ENERGY_SAVER
     #if defined( ENABLE_DTLS )
         #define CONFIG_COAP_SERVER_PORT                  5684
+        /* Keep the Device Authenticator credentials in flash and onboard again
+         * only when the DTLS handshake fails with an authentication error. */
+        #define CONFIG_NCE_PSK_CACHE
     #else
         #define CONFIG_COAP_SERVER_PORT                  5683
     #endif
@@ -109,4 +116,21 @@
     #define LWM2M_OBJECT_SEND                      "/3/0"
     #define CONFIG_LWM2M_SEND_FREQUENCY_SECONDS    60
 
+    /* Confirmable requests are taken from a static pool of transactions. A slot
+     * holds the transaction, its parsed CoAP message and a buffer of
+     * LWM2M_TRANSACTION_BUFFER_SIZE bytes for the serialized message, about
+     * 1.4 KB of RAM with 1024 byte blocks: the 4 slots take about 5.6 KB.
+     * Requests beyond the pool, or larger than the buffer, use the heap.
+     * A pool size of 0 takes all transactions from the heap. */
+    #define LWM2M_TRANSACTION_POOL_SIZE            4
+    #define LWM2M_TRANSACTION_BUFFER_SIZE          ( LWM2M_COAP_DEFAULT_BLOCK_SIZE + 128 )
+
+    /* Queue Mode: register with the UQ binding and keep notifications and
+     * Send operations while the client sleeps. They go out in order after a
+     * registration update, with the next periodic send or when the modem is
+     * connected anyway, and at the latest
+     * CONFIG_LWM2M_QUEUE_MODE_MAX_DELAY_SECONDS after the first was kept. */
+    #define LWM2M_CLIENT_QUEUE_MODE
+    #define CONFIG_LWM2M_QUEUE_MODE_MAX_DELAY_SECONDS    300
+
 #endif /* if defined( CONFIG_LwM2M_DEMO_ENABLED ) */
@@ -16,12 +16,10 @@
 /**
  * @brief Demo function to initialize and manage CoAP communication tasks.
  *
- * This function sets up a FreeRTOS queue and two tasks for CoAP communication:
- * one for sending CoAP messages (`SendCoAPData`) and another for listening
- * and receiving CoAP messages (`ListenCoAPData`). The function creates the
- * necessary queue and tasks, handles error checks, and logs status updates.
- * Once tasks are created successfully, it enters an infinite loop to keep
- * the tasks running.
+ * This function sets up a FreeRTOS queue, a task for sending CoAP messages
+ * (`SendCoAPData`) and a listening socket whose data ready callback runs on the
+ * platform work pool (`ListenCoAPData`). Once set up, it blocks forever to keep
+ * the demo running.
  */
 void CoAPDemo( void );
 
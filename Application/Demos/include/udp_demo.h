@@ -16,12 +16,10 @@
 /**
  * @brief Demo function to initialize and manage UDP communication tasks.
  *
- * This function sets up a FreeRTOS queue and two tasks for UDP communication:
- * one for sending UDP messages (`SendUDPData`) and another for listening
- * and receiving UDP messages (`ListenUDPData`). The function creates the
- * necessary queue and tasks, handles error checks, and logs status updates.
- * Once tasks are created successfully, it enters an infinite loop to keep
- * the tasks running.
+ * This function sets up a FreeRTOS queue, a task for sending UDP messages
+ * (`SendUDPData`) and a listening socket whose data ready callback runs on the
+ * platform work pool (`ListenUDPData`). Once set up, it blocks forever to keep
+ * the demo running.
  */
 void UdpDemo( void );
 
@@ -17,26 +17,10 @@
     #include "FreeRTOS.h"
     #include "event_groups.h"
     #include "nce_iot_c_sdk.h"
-
-
-    typedef struct xSOCKET
-    {
-        CellularSocketHandle_t cellularSocketHandle;
-        uint32_t ulFlags;
-        uint32_t xSendFlags;
-        uint32_t xRecvFlags;
-
-        TickType_t receiveTimeout;
-        TickType_t sendTimeout;
-
-        char * pcDestination;
-        void * pvTLSContext;
-        char * pcServerCertificate;
-        uint32_t ulServerCertificateLength;
-
-        EventGroupHandle_t socketEventGroupHandle;
-    } _cellularSecureSocket_t;
-
+    #include "uplink_scheduler.h"
+    #if defined( ENABLE_DTLS )
+        #include "nce_psk_cache.h"
+    #endif
 
 
 /**
@@ -66,6 +50,31 @@
  */
     static const TickType_t xSendTimeOut = DEFAULT_SOCKET_TIMEOUT_MS;
 
+    #if defined( CONFIG_NCE_ENERGY_SAVER )
+
+/**
+ * @brief Telemetry record sent through the 1NCE Energy Saver.
+ */
+        typedef struct EnergySaverRecord
+        {
+            uint8_t batteryLevel;    /**< Battery percentage. */
+            uint8_t signalStrength;  /**< Signal strength. */
+            char softwareVersion[ 6 ]; /**< Software version string. */
+        } EnergySaverRecord_t;
+
+/**
+ * @brief Translation template, must match the template with selector 1 in the 1NCE portal.
+ */
+        static const NceTemplateField_t xEnergySaverFields[] =
+        {
+            NCE_TEMPLATE_UINT( EnergySaverRecord_t, batteryLevel, 1U, NCE_BIG_ENDIAN ),
+            NCE_TEMPLATE_UINT( EnergySaverRecord_t, signalStrength, 1U, NCE_BIG_ENDIAN ),
+            NCE_TEMPLATE_STRING( EnergySaverRecord_t, softwareVersion, 5U )
+        };
+
+        static const NceTemplate_t xEnergySaverTemplate = NCE_TEMPLATE( 1U, xEnergySaverFields );
+    #endif /* if defined( CONFIG_NCE_ENERGY_SAVER ) */
+
 
     /**
      * @brief Callback function to handle incoming CoAP data on a UDP socket.
@@ -80,14 +89,16 @@
      * - Sending the ACK back to the sender.
      * - Handling errors related to message serialization and memory allocation.
      *
-     * @param[in] pCallbackContext Context passed to the callback (socket details).
+     * Runs on a platform worker, registered with SOCKETS_SO_WAKEUP_CALLBACK.
+     *
+     * @param[in] xSocket The socket with data ready.
      */
 
-    void CoAPDataReadyCallback( void * pCallbackContext )
+    void CoAPDataReadyCallback( Socket_t xSocket )
     {
         /* Set receive and send timeouts for the socket to avoid indefinite blocking. */
-        SOCKETS_SetSockOpt( pCallbackContext, 0, SOCKETS_SO_RCVTIMEO, &xReceiveTimeOut, sizeof( xReceiveTimeOut ) );
-        SOCKETS_SetSockOpt( pCallbackContext, 0, SOCKETS_SO_SNDTIMEO, &xSendTimeOut, sizeof( xSendTimeOut ) );
+        SOCKETS_SetSockOpt( xSocket, 0, SOCKETS_SO_RCVTIMEO, &xReceiveTimeOut, sizeof( xReceiveTimeOut ) );
+        SOCKETS_SetSockOpt( xSocket, 0, SOCKETS_SO_SNDTIMEO, &xSendTimeOut, sizeof( xSendTimeOut ) );
         /* Buffer to store received data. Size defined by NCE_RECEIVE_BUFFER_SIZE_BYTES macro. */
         char receive_buffer[ NCE_RECEIVE_BUFFER_SIZE_BYTES ];
         /* CoAP message packet buffer to parse incoming messages. */
@@ -103,7 +114,7 @@
 
         IotLogInfo( "***************** DATA RECEIVED ***************** \r\n" );
         /* Receive data from the socket into the receive buffer. */
-        ReceivedBytes = SOCKETS_Recv( pCallbackContext, receive_buffer, sizeof( receive_buffer ) - 1, 0 );
+        ReceivedBytes = SOCKETS_Recv( xSocket, receive_buffer, sizeof( receive_buffer ) - 1, 0 );
 
         /* If data has been received, proceed with message processing. */
         if( ReceivedBytes != 0 )
@@ -148,7 +159,7 @@
 
             IotLogInfo( "Send Acknowledgement \r\n" );
             /* Send the acknowledgment message back to the sender via the socket. */
-            status_ack = SOCKETS_Send( pCallbackContext, msgAckBuffer, MAX_SIZE_EMPTY_ACK, NULL );
+            status_ack = SOCKETS_Send( xSocket, msgAckBuffer, MAX_SIZE_EMPTY_ACK, NULL );
         }
     }
 
@@ -169,7 +180,9 @@
      *   and payload.
      * - Serializes the CoAP message into a buffer and sends it via the UDP socket.
      * - Logs the message for debugging purposes.
-     * - The task pauses between sending messages based on a configured frequency.
+     * - The task pauses between sending messages based on a configured frequency,
+     *   moving each message by up to CONFIG_UPLINK_SLACK_SECONDS to send it while
+     *   the modem is awake anyway.
      *
      * The function supports DTLS (if enabled) by configuring the socket with
      * the appropriate security settings.
@@ -185,6 +198,12 @@
 
         memset( &request_packet, 0, sizeof( coap_packet_t ) );
 
+        #if defined( ENABLE_DTLS )
+            /* Send the onboarding request now, its response is collected by the DTLS
+             * handshake after the DNS lookup and socket setup below. */
+            NcePskCache_Prefetch();
+        #endif
+
         IotLogInfo( "Connecting to the CoAP server\r\n" );
         /* Set server address and port (convert port to network byte order) */
 
@@ -232,6 +251,9 @@
             }
         }
 
+        /* Due time of the last message, advanced by the uplink scheduler */
+        TickType_t xLastUpload = xTaskGetTickCount();
+
         /* Infinite loop to send CoAP messages periodically */
 
         while( 1 )
@@ -245,24 +267,17 @@
             /* Set the URI Query path for the message (e.g., "t=test") */
             coap_set_header_uri_query( &request_packet, CONFIG_COAP_URI_QUERY );
             #if defined( CONFIG_NCE_ENERGY_SAVER )
-                /* Buffer to store the transmitted bytes, initialized with a size of 50 bytes. */
-
-                char pcTransmittedString[ 50 ];
-                /* Initialize the buffer to all null ('\0') characters. This ensures the buffer is empty and ready for use. */
-                ( void ) memset( &pcTransmittedString, ( uint8_t ) '\0', sizeof( pcTransmittedString ) );
-                uint8_t selector = 1;
-
-                /* Initialize data elements to be transmitted:
-                 * - battery_level: Integer value representing battery percentage (99%).
-                 * - signal_strength: Integer value representing signal strength (84 dBm).
-                 * - software_version: String representing the software version ("2.2.1").
-                 * Each element is packed into an Element2byte_gen_t structure, which includes its type, value, and template length.
-                 */
-                Element2byte_gen_t battery_level = { .type = E_INTEGER, .value.i = 99, .template_length = 1 };
-                Element2byte_gen_t signal_strength = { .type = E_INTEGER, .value.i = 84, .template_length = 1 };
-                Element2byte_gen_t software_version = { .type = E_STRING, .value.s = "2.2.1", .template_length = 5 };
-                os_energy_save( pcTransmittedString, selector, 3, battery_level, signal_strength, software_version );
-                coap_set_payload( &request_packet, pcTransmittedString, strlen( pcTransmittedString ) );
+                /* Buffer to store the binary payload. It may contain zero bytes, so its length is tracked explicitly. */
+                uint8_t pcTransmittedPayload[ 16 ];
+
+                /* Battery percentage (99%), signal strength (84) and software version ("2.2.1"). */
+                EnergySaverRecord_t xRecord = { 99, 84, "2.2.1" };
+                int payloadLength = os_energy_save_record( pcTransmittedPayload, sizeof( pcTransmittedPayload ), &xEnergySaverTemplate, &xRecord );
+
+                if( payloadLength > 0 )
+                {
+                    coap_set_payload( &request_packet, pcTransmittedPayload, ( size_t ) payloadLength );
+                }
             #else /* if defined( CONFIG_NCE_ENERGY_SAVER ) */
                 /* Set the payload for the CoAP message */
                 coap_set_payload( &request_packet, PUBLISH_PAYLOAD_FORMAT, strlen( PUBLISH_PAYLOAD_FORMAT ) );
@@ -286,36 +301,27 @@
             }
 
             /* Log the serialized message for debugging purposes */
-            IotLogDebug( "Serialized CoAP message:\n" );
-
-            for(size_t i = 0; i < message_size; ++i)
-            {
-                IotLogDebug( "%02x ", buffer[ i ] );
-            }
+            IotLog_PrintBuffer( "Serialized CoAP message:", buffer, message_size );
 
             /* Delay the task for a specified interval (in seconds) before sending the next message */
 
-            vTaskDelay( pdMS_TO_TICKS( CONFIG_COAP_DATA_UPLOAD_FREQUENCY_SECONDS * 1000 ) );
+            if( xUplinkSchedulerDelayUntil( &xLastUpload,
+                                            pdMS_TO_TICKS( CONFIG_COAP_DATA_UPLOAD_FREQUENCY_SECONDS * 1000 ),
+                                            pdMS_TO_TICKS( CONFIG_UPLINK_SLACK_SECONDS * 1000 ) ) == pdTRUE )
+            {
+                IotLogDebug( "Modem awake, sending with its traffic\r\n" );
+            }
         }
     }
 
     /**
-     * @brief Task function to listen for and process incoming CoAP messages over UDP.
-     *
-     * This function sets up a UDP socket to listen for incoming CoAP messages on a
-     * specified port. It continuously waits for data to be received on the socket,
-     * processes the received CoAP messages, and handles any necessary acknowledgments.
+     * @brief Open the socket that listens for incoming CoAP data.
      *
-     * Function Flow:
-     * - Initializes a UDP socket using the IPv4 protocol.
-     * - Binds the socket to the specified local address and port.
-     * - Waits for an event that signals data has been received using
-     *   `xEventGroupWaitBits()`.
-     * - Calls a data-ready callback function to process the received CoAP messages.
-     * - Introduces a delay between consecutive data reception loops to prevent
-     *   excessive CPU usage.
+     * Binds a UDP socket to NCE_RECV_PORT and registers CoAPDataReadyCallback with
+     * SOCKETS_SO_WAKEUP_CALLBACK, so received messages are handled on the
+     * platform work pool instead of by a dedicated listener task.
      */
-    void ListenCoAPData()
+    static void ListenCoAPData( void )
     {
         /* Socket address structure to define the local address and port for the UDP service. */
         SocketsSockaddr_t my_addr =
@@ -342,33 +348,17 @@
 
         IotLogInfo( "UDP socket bound to port %d, waiting for incoming messages.\r\n", NCE_RECV_PORT );
 
-        /* Main task loop for receiving and processing data. */
-        while( 1 )
-        {
-            /* Wait for the socket event indicating data is ready to be received. */
-            xEventGroupWaitBits( listenSocket->socketEventGroupHandle,
-                                 SOCKET_DATA_RECEIVED_CALLBACK_BIT,
-                                 ( BaseType_t ) pdTRUE,  /* Clear the bit when it is set */
-                                 ( BaseType_t ) pdFALSE, /* Do not wait for all bits */
-                                 portMAX_DELAY );        /* Wait indefinitely */
-            /* Call the UDP service callback to handle the received data. */
-            CoAPDataReadyCallback( listenSocket );
-
-            /* Introduce a delay before the next iteration to prevent excessive CPU usage. */
-            vTaskDelay( DEFAULT_TASK_DELAY_MS );
-            IotLogDebug( "Waiting for incoming messages" );
-        }
+        /* Run the data ready callback on the platform work pool. */
+        SOCKETS_SetSockOpt( listenSocket, 0, SOCKETS_SO_WAKEUP_CALLBACK, ( void * ) CoAPDataReadyCallback, sizeof( void * ) );
     }
 
     /**
      * @brief Demo function to initialize and manage CoAP communication tasks.
      *
-     * This function sets up a FreeRTOS queue and two tasks for CoAP communication:
-     * one for sending CoAP messages (`SendCoAPData`) and another for listening
-     * and receiving CoAP messages (`ListenCoAPData`). The function creates the
-     * necessary queue and tasks, handles error checks, and logs status updates.
-     * Once tasks are created successfully, it enters an infinite loop to keep
-     * the tasks running.
+     * This function sets up a FreeRTOS queue, a task for sending CoAP messages
+     * (`SendCoAPData`) and a listening socket whose data ready callback runs on the
+     * platform work pool (`ListenCoAPData`). Once set up, it blocks forever to keep
+     * the demo running.
      */
     void CoAPDemo()
     {
@@ -410,30 +400,14 @@
         /* Log message indicating successful task creation. */
         IotLogDebug( "SendCoAPData task created successfully.\r\n" );
 
-        /* Create the task for listening and receiving CoAP messages. */
-        xTaskCreateStatus = xTaskCreate(
-            ListenCoAPData,           /* Task function. */
-            "ListenCoAPData",         /* Task name. */
-            THREAD_STACK_SIZE,        /* Stack size in bytes. */
-            NULL,                     /* Task parameter (none in this case). */
-            configMAX_PRIORITIES - 1, /* Task priority: highest priority. */
-            NULL                      /* Task handle (not used). */
-            );
-
-        /* Check if the task was created successfully. */
-        if( xTaskCreateStatus != pdPASS )
-        {
-            IotLogError( "Failed to create the ListenCoAPData task.\r\n" );
-            return; /* Exit the function if task creation fails. */
-        }
-
-        /* Log message indicating successful task creation. */
-        IotLogDebug( "ListenCoAPData task created successfully.\r\n" );
+        /* Listen for incoming CoAP messages; the socket callback runs on a worker. */
+        ListenCoAPData();
 
-        /* Infinite loop to keep the demo running and tasks active. */
-        while( 1 )
+        /* The function does not exit, keeping the tasks running. Block instead of
+         * spinning so lower priority tasks get the CPU. */
+        for( ; ; )
         {
-            /* The function does not exit, keeping the tasks running. */
+            vTaskDelay( portMAX_DELAY );
         }
     }
 #endif /* ifdef CONFIG_COAP_DEMO_ENABLED */
@@ -7,19 +7,23 @@
  */
 
 /**
- * @file Lwm2m_demo.c
+ * @file lwm2m_demo.c
  * @brief
  */
 #include "lwm2mclient.h"
 #include "nce_demo_config.h"
 #if defined( CONFIG_LwM2M_DEMO_ENABLED )
 /* The config header is always included first. */
+    #include <stdlib.h>
+    #include <sys/time.h>
     #include "iot_config.h"
     #include "cellular_app.h"
-    #include "Lwm2m_demo.h"
+    #include "lwm2m_demo.h"
     #include "liblwm2m.h"
 /* COAP include. */
     #include "connection.h"
+    #include "uplink_scheduler.h"
+    #include "low_power.h"
 /*-----------------------------------------------------------*/
 
     #define MAX_PACKET_SIZE    2048
@@ -27,7 +31,11 @@
     static int g_quit = 0;
     bool DEVICE_BOOTSTRAPPED = false;
 
-    #define OBJ_COUNT    4
+    #if ( IOT_METRICS_CELLULAR_LWM2M_OBJECT == 1 ) && ( IOT_METRICS_CELLULAR_ENABLED == 1 )
+        #define OBJ_COUNT    5
+    #else
+        #define OBJ_COUNT    4
+    #endif
     lwm2m_object_t * objArray[ OBJ_COUNT ];
 
 /* only backup security and server objects */
@@ -100,9 +108,9 @@
         /* Unused parameters. */
         ( void ) data;
 
-        xReturned = SOCKETS_Recv( socketHandle, /* The socket being received from. */
-                                  buffer,       /* The buffer into which the received data will be written. */
-                                  1500,         /* The size of the buffer provided to receive the data. */
+        xReturned = SOCKETS_Recv( socketHandle,    /* The socket being received from. */
+                                  buffer,          /* The buffer into which the received data will be written. */
+                                  MAX_PACKET_SIZE, /* The size of the buffer provided to receive the data. */
                                   0 );
 
         if( xReturned < 0 )
@@ -114,8 +122,8 @@
         }
         else if( xReturned == 0 )
         {
-            /* Timed out. */
-            IotLogInfo( "Timed out receiving from CoAP server\r\n" );
+            /* Nothing left after a packet that was read before. */
+            IotLogDebug( "No data from CoAP server\r\n" );
             return;
         }
 
@@ -124,6 +132,162 @@
 
 /*-----------------------------------------------------------*/
 
+/**
+ * @brief Wait for packets from the servers the client talks to.
+ *
+ * Blocks until a server socket can be read or waitMs has passed, then hands
+ * every readable packet to the client. With no socket to watch it just waits.
+ */
+    static void Wakaama_Poll( client_data_t data,
+                              lwm2m_context_t * lwm2mH,
+                              uint8_t * buffer,
+                              uint32_t waitMs )
+    {
+        SocketsPollFd_t pollFds[ 2 ];
+        connection_t * connections[ 2 ] = { NULL, NULL };
+        size_t count = 0;
+        size_t i = 0;
+
+        if( lwm2mH->serverList != NULL )
+        {
+            if( ( lwm2mH->state == STATE_REGISTERING ) || ( lwm2mH->state == STATE_READY ) )
+            {
+                /* Primary server and the optional second one. */
+                connections[ 0 ] = ( connection_t * ) lwm2mH->serverList->sessionH;
+
+                if( lwm2mH->serverList->next != NULL )
+                {
+                    connections[ 1 ] = ( connection_t * ) lwm2mH->serverList->next->sessionH;
+                }
+            }
+        }
+        else if( ( lwm2mH->bootstrapServerList != NULL ) && ( lwm2mH->bootstrapServerList->status != STATE_BS_FINISHED ) )
+        {
+            connections[ 0 ] = ( connection_t * ) lwm2mH->bootstrapServerList->sessionH;
+        }
+
+        for( i = 0; i < 2U; i++ )
+        {
+            if( connections[ i ] != NULL )
+            {
+                pollFds[ count ].xSocket = connections[ i ]->sock;
+                pollFds[ count ].ulEvents = SOCKETS_POLLIN;
+                pollFds[ count ].ulREvents = 0U;
+                connections[ count ] = connections[ i ];
+                count++;
+            }
+        }
+
+        if( SOCKETS_Poll( pollFds, count, waitMs ) > 0 )
+        {
+            for( i = 0; i < count; i++ )
+            {
+                if( ( pollFds[ i ].ulREvents & SOCKETS_POLLIN ) != 0U )
+                {
+                    Wakaama_Recv( data, pollFds[ i ].xSocket, lwm2mH, buffer, connections[ i ] );
+                }
+            }
+        }
+    }
+
+/*-----------------------------------------------------------*/
+
+    #if defined( LWM2M_CLIENT_QUEUE_MODE )
+
+/**
+ * @brief Wake the client from Queue Mode sleep when its kept messages are due.
+ *
+ * They are due when the queue is full, when the modem is connected anyway or
+ * CONFIG_LWM2M_QUEUE_MODE_MAX_DELAY_SECONDS after the oldest one was kept.
+ *
+ * @return Milliseconds until they are due, UINT32_MAX if nothing is kept.
+ */
+        static uint32_t Wakaama_QueueModeStep( lwm2m_context_t * lwm2mH )
+        {
+            time_t oldest = 0;
+            time_t now = lwm2m_gettime();
+            size_t pending = lwm2m_queue_mode_pending( lwm2mH, &oldest );
+
+            if( ( lwm2mH->queueState != QUEUE_MODE_SLEEPING ) || ( pending == 0U ) )
+            {
+                return UINT32_MAX;
+            }
+
+            if( ( pending >= LWM2M_QUEUE_MODE_LENGTH ) ||
+                ( ( now - oldest ) >= CONFIG_LWM2M_QUEUE_MODE_MAX_DELAY_SECONDS ) ||
+                ( eLowPowerGetModemState( xTaskGetTickCount(), NULL ) == eLowPowerModemConnected ) )
+            {
+                IotLogInfo( "Queue Mode: waking up for %u kept messages\r\n", ( unsigned ) pending );
+                ( void ) lwm2m_queue_mode_wake( lwm2mH );
+
+                return 0U;
+            }
+
+            return ( uint32_t ) ( oldest + CONFIG_LWM2M_QUEUE_MODE_MAX_DELAY_SECONDS - now ) * 1000U;
+        }
+
+/*-----------------------------------------------------------*/
+    #endif /* if defined( LWM2M_CLIENT_QUEUE_MODE ) */
+
+    #if defined( LWM2M_OBJECT_SEND )
+
+/**
+ * @brief Ticks until the window of the next object send opens, 0 if it is open.
+ */
+        static TickType_t Wakaama_TicksToSendWindow( TickType_t xLastSend,
+                                                     TickType_t xPeriod,
+                                                     TickType_t xSlack )
+        {
+            TickType_t xToOpen = ( xLastSend + xPeriod - xSlack ) - xTaskGetTickCount();
+
+            /* Past the opening the difference wraps around. */
+            return ( xToOpen > ( portMAX_DELAY / 2U ) ) ? 0U : xToOpen;
+        }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Send the device and connectivity monitoring objects to the server.
+ */
+        static void Wakaama_SendObject( lwm2m_context_t * lwm2mH )
+        {
+            IotLogInfo( "************** U P D A T I N G  ************** \r\n" );
+            /* Define the object, instance, and resource to be sent */
+            lwm2m_uri_t uri;
+            lwm2m_stringToUri( LWM2M_OBJECT_SEND, strlen( LWM2M_OBJECT_SEND ), &uri );
+
+            /* Sending the device and connectivity monitoring objects to the LwM2M server */
+            int result = lwm2m_send( lwm2mH, LWM2M_OBJECT_SEND, sizeof(LWM2M_OBJECT_SEND));
+
+            if( result == 0 )
+            {
+                if( LWM2M_URI_IS_SET_INSTANCE( &uri ) )
+                {
+                    if( LWM2M_URI_IS_SET_RESOURCE( &uri ) )
+                    {
+                        IotLogInfo( "Sent LwM2M Object: /%d/%d/%d", uri.objectId, uri.instanceId, uri.resourceId );
+                    }
+                    else
+                    {
+                        IotLogInfo( "Sent LwM2M Object: /%d/%d", uri.objectId, uri.instanceId );
+                    }
+                }
+                else
+                {
+                    IotLogInfo( "Sent LwM2M Object: /%d", uri.objectId );
+                }
+            }
+            else
+            {
+                IotLogError( "Failed to send LwM2M object %s\n", LWM2M_OBJECT_SEND );
+            }
+
+            IotLogInfo( "************** U P D A T E D  ************** \r\n" );
+        }
+
+/*-----------------------------------------------------------*/
+    #endif /* if defined( LWM2M_OBJECT_SEND ) */
+
 
 
 /**
@@ -150,6 +314,13 @@
         int batterylevelchanging = 0;
         time_t reboot_time = 0;
         lwm2m_client_state_t previousState = STATE_INITIAL;
+        /* Receive buffer, only ever filled up to the length of a packet. */
+        uint8_t buffer[ MAX_PACKET_SIZE ];
+        uint32_t waitMs = 0U;
+
+        #if defined( LWM2M_CLIENT_QUEUE_MODE )
+            uint32_t queueWaitMs = 0U;
+        #endif
 
         #if defined( ENABLE_DTLS )
             const char * serverPort = LWM2M_DTLS_PORT_STR;
@@ -188,7 +359,12 @@
         data.securityObjP = objArray[ 0 ];
         /* Initialize server, device, and firmware objects. */
 
-        objArray[ 1 ] = get_server_object( serverId, "U", lifetime, false );
+        #if defined( LWM2M_CLIENT_QUEUE_MODE )
+            /* The server queues its requests while the client sleeps. */
+            objArray[ 1 ] = get_server_object( serverId, "UQ", lifetime, false );
+        #else
+            objArray[ 1 ] = get_server_object( serverId, "U", lifetime, false );
+        #endif
 
         if( NULL == objArray[ 1 ] )
         {
@@ -208,6 +384,15 @@
         {
             IotLogError( "Failed to create Firmware object\r\n" );
         }
+
+        #if ( IOT_METRICS_CELLULAR_LWM2M_OBJECT == 1 ) && ( IOT_METRICS_CELLULAR_ENABLED == 1 )
+            objArray[ 4 ] = get_object_cellular_metrics();
+
+            if( NULL == objArray[ 4 ] )
+            {
+                IotLogError( "Failed to create Cellular Metrics object\r\n" );
+            }
+        #endif
         /*
          * The liblwm2m library is now initialized with the functions that will be in
          * charge of communication
@@ -232,6 +417,20 @@
         init_value_change( lwm2mH );
         IotLogInfo( "LWM2M Client \"%s\" started on port %s\r\n", name, localPort );
 
+        #if defined( LWM2M_OBJECT_SEND )
+            /* Due time of the last object send, advanced by the uplink scheduler. */
+            TickType_t xLastSend = 0;
+            const TickType_t xSendPeriod = pdMS_TO_TICKS( CONFIG_LWM2M_SEND_FREQUENCY_SECONDS * 1000 );
+            TickType_t xSendSlack = pdMS_TO_TICKS( CONFIG_UPLINK_SLACK_SECONDS * 1000 );
+            bool sendStarted = false;
+            uint32_t sendWaitMs = 0U;
+
+            if( xSendSlack > ( xSendPeriod / 2U ) )
+            {
+                xSendSlack = xSendPeriod / 2U;
+            }
+        #endif
+
         /* Main loop to handle client-server communication. */
 
         while( 0 == g_quit )
@@ -342,81 +541,64 @@
             #ifdef LWM2M_BOOTSTRAP
                 update_bootstrap_info( &previousState, lwm2mH );
             #endif
-            /* Receive and process incoming packets. */
-            uint8_t buffer[ MAX_PACKET_SIZE ];
-            memset( buffer, '\0', MAX_PACKET_SIZE );
-
-            if( lwm2mH->serverList != NULL )
-            {
-                /* Receive from the primary server. */
 
-                connection_t * connP = ( connection_t * ) lwm2mH->serverList->sessionH;
+            /* Sleep until the next step of the client is due, unless a server
+             * sends a request or a response first. */
+            waitMs = ( tv.tv_sec > 0 ) ? ( uint32_t ) tv.tv_sec * 1000U : 0U;
 
-                if( ( ( lwm2mH->state == STATE_REGISTERING ) || ( lwm2mH->state == STATE_READY ) ) && ( connP != NULL ) )
+            #if defined( LWM2M_OBJECT_SEND )
+                if( lwm2mH->state == STATE_READY )
                 {
-                    Wakaama_Recv( data, connP->sock, lwm2mH, buffer, connP );
-
-                    /* Send device and connectivity monitoring objects if ready. */
-
-                    #if defined( LWM2M_OBJECT_SEND )
-                        if( ( lwm2mH->state == STATE_READY ) )
-                        {
-                            IotLogInfo( "************** U P D A T I N G  ************** \r\n" );
-                            /* Define the object, instance, and resource to be sent */
-                            lwm2m_uri_t uri;
-                            lwm2m_stringToUri( LWM2M_OBJECT_SEND, strlen( LWM2M_OBJECT_SEND ), &uri );
-
-                            /* Sending the device and connectivity monitoring objects to the LwM2M server */
-                            int result = lwm2m_send( lwm2mH, LWM2M_OBJECT_SEND, sizeof(LWM2M_OBJECT_SEND));
-
-                            if( result == 0 )
-                            {
-                                if( LWM2M_URI_IS_SET_INSTANCE( &uri ) )
-                                {
-                                    if( LWM2M_URI_IS_SET_RESOURCE( &uri ) )
-                                    {
-                                        IotLogInfo( "Sent LwM2M Object: /%d/%d/%d", uri.objectId, uri.instanceId, uri.resourceId );
-                                    }
-                                    else
-                                    {
-                                        IotLogInfo( "Sent LwM2M Object: /%d/%d", uri.objectId, uri.instanceId );
-                                    }
-                                }
-                                else
-                                {
-                                    IotLogInfo( "Sent LwM2M Object: /%d", uri.objectId );
-                                }
-                            }
-                            else
+                    if( sendStarted == false )
+                    {
+                        /* First send right after the registration. */
+                        xLastSend = xTaskGetTickCount();
+                        sendStarted = true;
+                        Wakaama_SendObject( lwm2mH );
+                    }
+                    else if( Wakaama_TicksToSendWindow( xLastSend, xSendPeriod, xSendSlack ) == 0U )
+                    {
+                        /* The window of the next send is open. Send it while the
+                         * modem is awake if possible; this waits at most the slack
+                         * on either side of the due time. */
+                        ( void ) xUplinkSchedulerDelayUntil( &xLastSend, xSendPeriod, xSendSlack );
+                        #if defined( LWM2M_CLIENT_QUEUE_MODE )
+                            if( lwm2mH->queueState == QUEUE_MODE_SLEEPING )
                             {
-                                IotLogError( "Failed to send LwM2M object %s\n", LWM2M_OBJECT_SEND );
+                                /* Announce the wake up right away, the send follows
+                                 * the kept messages once the server acknowledged the
+                                 * registration update. */
+                                ( void ) lwm2m_queue_mode_wake( lwm2mH );
+                                waitMs = 0U;
                             }
+                        #endif
+                        Wakaama_SendObject( lwm2mH );
+                    }
 
-                            IotLogInfo( "************** U P D A T E D  ************** \r\n" );
-                            /* Delay to avoid spamming server with updates. */
-                            vTaskDelay( pdMS_TO_TICKS( CONFIG_LWM2M_SEND_FREQUENCY_SECONDS * 1000 ) );
-                        }
-                    #endif /* if defined( LWM2M_OBJECT_SEND ) */
-                }
+                    sendWaitMs = ( uint32_t ) Wakaama_TicksToSendWindow( xLastSend, xSendPeriod, xSendSlack ) *
+                                 portTICK_PERIOD_MS;
 
-                /* Receive data from the LwM2M Server. */
-                connection_t * connP1 = ( connection_t * ) lwm2mH->serverList->next->sessionH;
-
-                if( ( ( lwm2mH->state == STATE_REGISTERING ) || ( lwm2mH->state == STATE_READY ) ) && ( connP1 != NULL ) )
-                {
-                    Wakaama_Recv( data, connP1->sock, lwm2mH, buffer, connP1 );
+                    if( sendWaitMs < waitMs )
+                    {
+                        waitMs = sendWaitMs;
+                    }
                 }
-            }
-            else
-            {
-                /* Handle bootstrap server communication. */
-                connection_t * connP = ( connection_t * ) lwm2mH->bootstrapServerList->sessionH;
+            #endif /* if defined( LWM2M_OBJECT_SEND ) */
 
-                if( ( lwm2mH->bootstrapServerList->status != STATE_BS_FINISHED ) && ( connP != NULL ) )
+            #if defined( LWM2M_CLIENT_QUEUE_MODE )
+                if( lwm2mH->state == STATE_READY )
                 {
-                    Wakaama_Recv( data, connP->sock, lwm2mH, buffer, connP );
+                    queueWaitMs = Wakaama_QueueModeStep( lwm2mH );
+
+                    if( queueWaitMs < waitMs )
+                    {
+                        waitMs = queueWaitMs;
+                    }
                 }
-            }
+            #endif
+
+            /* Receive and process incoming packets. */
+            Wakaama_Poll( data, lwm2mH, buffer, waitMs );
         }
     }
 
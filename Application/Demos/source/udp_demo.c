@@ -16,24 +16,7 @@
     #include "FreeRTOS.h"
     #include "event_groups.h"
     #include "cellular_types.h"
-
-    typedef struct xSOCKET
-    {
-        CellularSocketHandle_t cellularSocketHandle;
-        uint32_t ulFlags;
-        uint32_t xSendFlags;
-        uint32_t xRecvFlags;
-
-        TickType_t receiveTimeout;
-        TickType_t sendTimeout;
-
-        char * pcDestination;
-        void * pvTLSContext;
-        char * pcServerCertificate;
-        uint32_t ulServerCertificateLength;
-
-        EventGroupHandle_t socketEventGroupHandle;
-    } _cellularSecureSocket_t;
+    #include "uplink_scheduler.h"
 
     /**
      * @brief Socket receive operation timeout in ticks.
@@ -53,6 +36,31 @@
      */
     static const TickType_t xSendTimeOut = DEFAULT_SOCKET_TIMEOUT_MS;
 
+    #if defined( CONFIG_NCE_ENERGY_SAVER )
+
+/**
+ * @brief Telemetry record sent through the 1NCE Energy Saver.
+ */
+        typedef struct EnergySaverRecord
+        {
+            uint8_t batteryLevel;    /**< Battery percentage. */
+            uint8_t signalStrength;  /**< Signal strength. */
+            char softwareVersion[ 6 ]; /**< Software version string. */
+        } EnergySaverRecord_t;
+
+/**
+ * @brief Translation template, must match the template with selector 1 in the 1NCE portal.
+ */
+        static const NceTemplateField_t xEnergySaverFields[] =
+        {
+            NCE_TEMPLATE_UINT( EnergySaverRecord_t, batteryLevel, 1U, NCE_BIG_ENDIAN ),
+            NCE_TEMPLATE_UINT( EnergySaverRecord_t, signalStrength, 1U, NCE_BIG_ENDIAN ),
+            NCE_TEMPLATE_STRING( EnergySaverRecord_t, softwareVersion, 5U )
+        };
+
+        static const NceTemplate_t xEnergySaverTemplate = NCE_TEMPLATE( 1U, xEnergySaverFields );
+    #endif /* if defined( CONFIG_NCE_ENERGY_SAVER ) */
+
     /**
      * @brief Callback function to handle incoming UDP data.
      *
@@ -64,20 +72,22 @@
      * - Parsing the received data.
      * - Handling errors related to memory allocation.
      *
-     * @param[in] pCallbackContext Context passed to the callback (socket details).
+     * Runs on a platform worker, registered with SOCKETS_SO_WAKEUP_CALLBACK.
+     *
+     * @param[in] xSocket The socket with data ready.
      */
-    void UdpServiceDataReadyCallback( void * pCallbackContext )
+    void UdpServiceDataReadyCallback( Socket_t xSocket )
     {
         /* Set receive and send timeouts for the socket to avoid indefinite blocking. */
-        SOCKETS_SetSockOpt( pCallbackContext, 0, SOCKETS_SO_RCVTIMEO, &xReceiveTimeOut, sizeof( xReceiveTimeOut ) );
-        SOCKETS_SetSockOpt( pCallbackContext, 0, SOCKETS_SO_SNDTIMEO, &xSendTimeOut, sizeof( xSendTimeOut ) );
+        SOCKETS_SetSockOpt( xSocket, 0, SOCKETS_SO_RCVTIMEO, &xReceiveTimeOut, sizeof( xReceiveTimeOut ) );
+        SOCKETS_SetSockOpt( xSocket, 0, SOCKETS_SO_SNDTIMEO, &xSendTimeOut, sizeof( xSendTimeOut ) );
         /* Buffer to store received data. Size defined by NCE_RECEIVE_BUFFER_SIZE_BYTES macro. */
         char receive_buffer[ NCE_RECEIVE_BUFFER_SIZE_BYTES ];
         /* Variable to store the number of received bytes. */
         int32_t ReceivedBytes;
 
         /* Receive data from the socket into the receive buffer. */
-        ReceivedBytes = SOCKETS_Recv( pCallbackContext, receive_buffer, sizeof( receive_buffer ) - 1, 0 );
+        ReceivedBytes = SOCKETS_Recv( xSocket, receive_buffer, sizeof( receive_buffer ) - 1, 0 );
 
         /* If data has been received, proceed with message processing. */
         if( ReceivedBytes > 0 )
@@ -112,16 +122,23 @@
  * - Creates a UDP socket and configures timeouts for sending and receiving.
  * - Constructs and sends the message.
  * - Logs the message for debugging purposes.
- * - The task pauses between sending messages based on a configured frequency.
+ * - The task pauses between sending messages based on a configured frequency,
+ *   moving each message by up to CONFIG_UPLINK_SLACK_SECONDS to send it while
+ *   the modem is awake anyway.
  */
     void SendUDPData()
     {
         /* Buffer to store the packet to be sent */
         char send_packet[ 100 ];
+        /* Number of bytes of send_packet to send, the binary payload may contain zero bytes */
+        int32_t send_length = 0;
 
         /* Structure to hold the server address and port */
         SocketsSockaddr_t ServerAddress;
 
+        /* Due time of the last upload, advanced by the uplink scheduler */
+        TickType_t xLastUpload = xTaskGetTickCount();
+
         /* Main loop to send data periodically */
         while( 1 )
         {
@@ -158,34 +175,19 @@
                 IotLogInfo( "Connected to UDP server %s:%u\r\n", IP_TO_STRING( ServerAddress.ulAddress ), SOCKETS_ntohs( ServerAddress.usPort ) );
 
                 #if defined( CONFIG_NCE_ENERGY_SAVER )
-                    /* Buffer to store the transmitted bytes, initialized with a size of 50 bytes. */
-                    char pcTransmittedString[ 50 ];
-
-                    /* Initialize the buffer to all null ('\0') characters. */
-                    ( void ) memset( &pcTransmittedString, ( uint8_t ) '\0', sizeof( pcTransmittedString ) );
-                    uint8_t selector = 1;
-
-                    /* Initialize data elements to be transmitted:
-                     * - battery_level: Integer value representing battery percentage (99%).
-                     * - signal_strength: Integer value representing signal strength (84 dBm).
-                     * - software_version: String representing the software version ("2.2.1").
-                     */
-                    Element2byte_gen_t battery_level = { .type = E_INTEGER, .value.i = 99, .template_length = 1 };
-                    Element2byte_gen_t signal_strength = { .type = E_INTEGER, .value.i = 84, .template_length = 1 };
-                    Element2byte_gen_t software_version = { .type = E_STRING, .value.s = "2.2.1", .template_length = 5 };
-
-                    /* Generate the energy-saving data and add it to the transmitted string */
-                    os_energy_save( pcTransmittedString, selector, 3, battery_level, signal_strength, software_version );
-                    sprintf( send_packet, "%s", pcTransmittedString ); /* Copy the payload into send_packet buffer */
+                    /* Battery percentage (99%), signal strength (84) and software version ("2.2.1"). */
+                    EnergySaverRecord_t xRecord = { 99, 84, "2.2.1" };
+
+                    /* Encode the record with the static translation template directly into send_packet */
+                    send_length = os_energy_save_record( ( uint8_t * ) send_packet, sizeof( send_packet ), &xEnergySaverTemplate, &xRecord );
                 #else /* if defined( CONFIG_NCE_ENERGY_SAVER ) */
                     /* Prepare the payload to be sent */
-                    char pcTransmittedString[] = PUBLISH_PAYLOAD_FORMAT;
-                    sprintf( send_packet, "%s", pcTransmittedString ); /* Copy the payload into send_packet buffer */
+                    send_length = snprintf( send_packet, sizeof( send_packet ), "%s", PUBLISH_PAYLOAD_FORMAT );
                 #endif /* if defined( CONFIG_NCE_ENERGY_SAVER ) */
 
                 /* Send the packet to the server */
-                int32_t SendVal = SOCKETS_Send( udp, send_packet, strlen( send_packet ), 0 );
-                IotLogInfo( "Sending '%s' of length %d to UDP server\r\n", send_packet, strlen( send_packet ) );
+                int32_t SendVal = ( send_length > 0 ) ? SOCKETS_Send( udp, send_packet, ( size_t ) send_length, 0 ) : -1;
+                IotLog_PrintBuffer( "Sending to UDP server:", ( const uint8_t * ) send_packet, ( size_t ) ( ( send_length > 0 ) ? send_length : 0 ) );
 
                 /* Check if sending was successful */
                 if( SendVal < 0 )
@@ -200,8 +202,13 @@
                     result = SOCKETS_Close( udp );
                     configASSERT( result == SOCKETS_ERROR_NONE );
 
-                    /* Pause to avoid network congestion (frequency of sending) */
-                    vTaskDelay( pdMS_TO_TICKS( CONFIG_UDP_DATA_UPLOAD_FREQUENCY_SECONDS * 1000 ) );
+                    /* Pause until the next upload (frequency of sending) */
+                    if( xUplinkSchedulerDelayUntil( &xLastUpload,
+                                                    pdMS_TO_TICKS( CONFIG_UDP_DATA_UPLOAD_FREQUENCY_SECONDS * 1000 ),
+                                                    pdMS_TO_TICKS( CONFIG_UPLINK_SLACK_SECONDS * 1000 ) ) == pdTRUE )
+                    {
+                        IotLogDebug( "Modem awake, uploading with its traffic\r\n" );
+                    }
                 }
             }
             else
@@ -213,19 +220,13 @@
     }
 
     /**
-     * @brief Task function to listen for incoming UDP data.
+     * @brief Open the socket that listens for incoming UDP data.
      *
-     * This function creates a UDP socket bound to a specific port and listens for
-     * incoming UDP messages. Upon receiving data, it processes the message and logs it.
-     * The task runs indefinitely, receiving messages at regular intervals.
-     *
-     * Function Flow:
-     * - Binds the UDP socket to the listening port.
-     * - Waits for incoming data using `SOCKETS_Recv()`.
-     * - Logs the received message for debugging.
-     * - The task continues to listen for messages in an infinite loop.
+     * Binds a UDP socket to NCE_RECV_PORT and registers UdpServiceDataReadyCallback with
+     * SOCKETS_SO_WAKEUP_CALLBACK, so received messages are handled on the
+     * platform work pool instead of by a dedicated listener task.
      */
-    void ListenUDPData()
+    static void ListenUDPData( void )
     {
         /* Socket address structure to define the local address and port for the UDP service. */
         SocketsSockaddr_t my_addr =
@@ -251,33 +252,17 @@
 
         IotLogInfo( "UDP socket bound to port %d, waiting for incoming messages.\r\n", NCE_RECV_PORT );
 
-        /* Main task loop for receiving and processing data. */
-        while( 1 )
-        {
-            /* Wait for the socket event indicating data is ready to be received. */
-            xEventGroupWaitBits( listenSocket->socketEventGroupHandle,
-                                 SOCKET_DATA_RECEIVED_CALLBACK_BIT,
-                                 ( BaseType_t ) pdTRUE,  /* Clear the bit when it is set */
-                                 ( BaseType_t ) pdFALSE, /* Do not wait for all bits */
-                                 portMAX_DELAY );        /* Wait indefinitely */
-            /* Call the UDP service callback to handle the received data. */
-            UdpServiceDataReadyCallback( listenSocket );
-
-            /* Introduce a delay before the next iteration to prevent excessive CPU usage. */
-            vTaskDelay( DEFAULT_TASK_DELAY_MS );
-            IotLogInfo( "Waiting for incoming messages" );
-        }
+        /* Run the data ready callback on the platform work pool. */
+        SOCKETS_SetSockOpt( listenSocket, 0, SOCKETS_SO_WAKEUP_CALLBACK, ( void * ) UdpServiceDataReadyCallback, sizeof( void * ) );
     }
 
     /**
      * @brief Demo function to initialize and manage UDP communication tasks.
      *
-     * This function sets up a FreeRTOS queue and two tasks for UDP communication:
-     * one for sending UDP messages (`SendUDPData`) and another for listening
-     * and receiving UDP messages (`ListenUDPData`). The function creates the
-     * necessary queue and tasks, handles error checks, and logs status updates.
-     * Once tasks are created successfully, it enters an infinite loop to keep
-     * the tasks running.
+     * This function sets up a FreeRTOS queue, a task for sending UDP messages
+     * (`SendUDPData`) and a listening socket whose data ready callback runs on the
+     * platform work pool (`ListenUDPData`). Once set up, it blocks forever to keep
+     * the demo running.
      */
     void UdpDemo()
     {
@@ -319,30 +304,14 @@
         /* Log message indicating successful task creation. */
         IotLogDebug( "SendUDPData task created successfully.\r\n" );
 
-        /* Create the task for listening and receiving UDP messages. */
-        xTaskCreateStatus = xTaskCreate(
-            ListenUDPData,            /* Task function. */
-            "ListenUDPData",          /* Task name. */
-            THREAD_STACK_SIZE,        /* Stack size in bytes. */
-            NULL,                     /* Task parameter (none in this case). */
-            configMAX_PRIORITIES - 1, /* Task priority: highest priority. */
-            NULL                      /* Task handle (not used). */
-            );
+        /* Listen for incoming UDP messages; the socket callback runs on a worker. */
+        ListenUDPData();
 
-        /* Check if the task was created successfully. */
-        if( xTaskCreateStatus != pdPASS )
-        {
-            IotLogError( "Failed to create the ListenUDPData task.\r\n" );
-            return; /* Exit the function if task creation fails. */
-        }
-
-        /* Log message indicating successful task creation. */
-        IotLogDebug( "ListenUDPData task created successfully.\r\n" );
-
-        /* Infinite loop to keep the demo running and tasks active. */
-        while( 1 )
+        /* The function does not exit, keeping the tasks running. Block instead of
+         * spinning so lower priority tasks get the CPU. */
+        for( ; ; )
         {
-            /* The function does not exit, keeping the tasks running. */
+            vTaskDelay( portMAX_DELAY );
         }
     }
 #endif /* ifdef CONFIG_UDP_DEMO_ENABLED */
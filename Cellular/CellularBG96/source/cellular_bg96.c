@@ -27,28 +27,91 @@
 
 
 #include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
 #include "cellular_platform.h"
 #include "cellular_config.h"
 #include "cellular_config_defaults.h"
 #include "cellular_common.h"
 #include "cellular_common_portable.h"
 #include "cellular_bg96.h"
+#include "cellular_bg96_api.h"
 #include "nce_demo_config.h"
 /*-----------------------------------------------------------*/
 
 #define ENBABLE_MODULE_UE_RETRY_COUNT      ( 3U )
 #define ENBABLE_MODULE_UE_RETRY_TIMEOUT    ( 5000U )
 #define BG96_NWSCANSEQ_CMD_MAX_SIZE        ( 29U ) /* The length of AT+QCFG="nwscanseq",020301,1\0. */
+#define BG96_CONFIG_CMD_MAX_SIZE           ( 64U ) /* Longest configuration command including the apply suffix. */
+#define BG96_CONFIG_VALUE_MAX_SIZE         ( 64U ) /* Longest normalized configuration value. */
+#define BG96_CONFIG_PREFIX_MAX_SIZE        ( 12U ) /* Longest response prefix, e.g. "+QURCCFG". */
+
+#define BG96_FNV_OFFSET_BASIS              ( 2166136261UL )
+#define BG96_FNV_PRIME                     ( 16777619UL )
+
+/**
+ * @brief Macro that is called to read the configuration fingerprint kept in
+ * non-volatile memory, so the module settings are not queried again after an
+ * MCU reset.
+ *
+ * <b>Default value</b>: Nothing is stored and the macro evaluates to 0.
+ */
+#ifndef CellularBG96_LoadConfigFingerprint
+    #define CellularBG96_LoadConfigFingerprint()    ( 0U )
+#endif
+
+/**
+ * @brief Macro that is called to keep the fingerprint of the configuration
+ * verified on the module in non-volatile memory.
+ *
+ * <b>Default value</b>: No code is generated for calls to the macro.
+ */
+#ifndef CellularBG96_StoreConfigFingerprint
+    #define CellularBG96_StoreConfigFingerprint( fingerprint )    ( ( void ) ( fingerprint ) )
+#endif
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief One module setting applied by Cellular_ModuleEnableUE.
+ *
+ * The query command and the response prefix are derived from pSetCmd, e.g.
+ * AT+QCFG="band",F,80004,80 is read back with AT+QCFG="band" and +QCFG.
+ */
+typedef struct bg96ConfigItem
+{
+    const char * pSetCmd;      /* Command that writes the desired value. */
+    const char * pApplySuffix; /* Appended to pSetCmd when writing, but not part of the value. */
+    bool networkSetting;       /* Changing the setting requires a network rescan. */
+} bg96ConfigItem_t;
 
 /*-----------------------------------------------------------*/
 
 static CellularError_t sendAtCommandWithRetryTimeout( CellularContext_t * pContext,
                                                       const CellularAtReq_t * pAtReq );
+static CellularPktStatus_t _Cellular_RecvFuncGetConfig( CellularContext_t * pContext,
+                                                        const CellularATCommandResponse_t * pAtResp,
+                                                        void * pData,
+                                                        uint16_t dataLen );
+static CellularPktStatus_t _Cellular_RecvFuncGetImei( CellularContext_t * pContext,
+                                                      const CellularATCommandResponse_t * pAtResp,
+                                                      void * pData,
+                                                      uint16_t dataLen );
+static CellularError_t applyModuleConfig( CellularContext_t * pContext,
+                                          const bg96ConfigItem_t * pItems,
+                                          uint32_t itemCount );
 
 /*-----------------------------------------------------------*/
 
 static cellularModuleContext_t cellularBg96Context = { 0 };
 
+/* Fingerprint of the configuration last verified on the module. It is kept
+ * outside the module context so it survives Cellular_Cleanup/Cellular_Init,
+ * and loaded from CellularBG96_LoadConfigFingerprint after a reset. */
+static uint32_t appliedConfigFingerprint = 0U;
+static bool appliedConfigLoaded = false;
+
 const char * CellularSrcTokenErrorTable[] =
 { "ERROR", "BUSY", "NO CARRIER", "NO ANSWER", "NO DIALTONE", "ABORTED", "+CMS ERROR", "+CME ERROR", "SEND FAIL" };
 uint32_t CellularSrcTokenErrorTableSize = sizeof( CellularSrcTokenErrorTable ) / sizeof( char * );
@@ -124,6 +187,417 @@ static bool appendRatList( char * pRatList,
 
 /*-----------------------------------------------------------*/
 
+static void normalizeConfigValue( char * pDst,
+                                  uint32_t dstSize,
+                                  const char * pSrc )
+{
+    uint32_t i = 0U;
+    bool quoted = false;
+
+    /* White spaces outside of quoted strings are not significant when
+     * comparing values. The quotes are kept to tell strings from numbers. */
+    while( ( *pSrc != '\0' ) && ( ( i + 1U ) < dstSize ) )
+    {
+        if( *pSrc == '"' )
+        {
+            quoted = !quoted;
+        }
+
+        if( ( quoted == true ) || ( isspace( ( unsigned char ) *pSrc ) == 0 ) )
+        {
+            pDst[ i ] = *pSrc;
+            i++;
+        }
+
+        pSrc++;
+    }
+
+    pDst[ i ] = '\0';
+}
+
+/*-----------------------------------------------------------*/
+
+static bool parseHexField( const char * pField,
+                           uint32_t fieldLen,
+                           uint64_t * pValue )
+{
+    uint64_t value = 0U;
+    uint32_t i = 0U;
+    int digit = 0;
+
+    if( ( fieldLen > 2U ) && ( pField[ 0 ] == '0' ) && ( ( pField[ 1 ] == 'x' ) || ( pField[ 1 ] == 'X' ) ) )
+    {
+        i = 2U;
+    }
+
+    if( ( i == fieldLen ) || ( ( fieldLen - i ) > 16U ) )
+    {
+        return false;
+    }
+
+    for( ; i < fieldLen; i++ )
+    {
+        digit = tolower( ( unsigned char ) pField[ i ] );
+
+        if( ( digit >= '0' ) && ( digit <= '9' ) )
+        {
+            value = ( value << 4 ) | ( uint64_t ) ( digit - '0' );
+        }
+        else if( ( digit >= 'a' ) && ( digit <= 'f' ) )
+        {
+            value = ( value << 4 ) | ( uint64_t ) ( digit - 'a' + 10 );
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    *pValue = value;
+
+    return true;
+}
+
+/*-----------------------------------------------------------*/
+
+static uint32_t configFieldLength( const char * pField )
+{
+    uint32_t fieldLen = 0U;
+    bool quoted = false;
+
+    /* Commas inside a quoted string do not end the field. */
+    while( ( pField[ fieldLen ] != '\0' ) && ( ( quoted == true ) || ( pField[ fieldLen ] != ',' ) ) )
+    {
+        if( pField[ fieldLen ] == '"' )
+        {
+            quoted = !quoted;
+        }
+
+        fieldLen++;
+    }
+
+    return fieldLen;
+}
+
+/*-----------------------------------------------------------*/
+
+static bool configFieldMatch( const char * pActual,
+                              uint32_t actualLen,
+                              const char * pDesired,
+                              uint32_t desiredLen )
+{
+    bool match = ( actualLen == desiredLen );
+    bool quoted = ( ( actualLen > 0U ) && ( pActual[ 0 ] == '"' ) ) ||
+                  ( ( desiredLen > 0U ) && ( pDesired[ 0 ] == '"' ) );
+    uint64_t actualValue = 0U, desiredValue = 0U;
+    uint32_t i = 0U;
+
+    /* Strings like the APN or the credentials must be equal. Keywords and
+     * numbers are compared without case. */
+    if( quoted == true )
+    {
+        match = ( match == true ) && ( memcmp( pActual, pDesired, actualLen ) == 0 );
+    }
+
+    for( i = 0U; ( quoted == false ) && ( match == true ) && ( i < actualLen ); i++ )
+    {
+        match = ( tolower( ( unsigned char ) pActual[ i ] ) == tolower( ( unsigned char ) pDesired[ i ] ) );
+    }
+
+    /* The module reports bit masks as 0x-prefixed hex, e.g. 0xf for F. */
+    if( ( match == false ) && ( quoted == false ) &&
+        ( parseHexField( pActual, actualLen, &actualValue ) == true ) &&
+        ( parseHexField( pDesired, desiredLen, &desiredValue ) == true ) )
+    {
+        match = ( actualValue == desiredValue );
+    }
+
+    return match;
+}
+
+/*-----------------------------------------------------------*/
+
+bool Cellular_BG96ConfigValuesMatch( const char * pActual,
+                                     const char * pDesired )
+{
+    bool match = ( pActual != NULL ) && ( pDesired != NULL );
+    uint32_t actualLen = 0U, desiredLen = 0U;
+
+    /* Compare the comma separated fields of two normalized values. */
+    while( match == true )
+    {
+        actualLen = configFieldLength( pActual );
+        desiredLen = configFieldLength( pDesired );
+        match = configFieldMatch( pActual, actualLen, pDesired, desiredLen );
+
+        if( ( match == false ) || ( ( pActual[ actualLen ] == '\0' ) && ( pDesired[ desiredLen ] == '\0' ) ) )
+        {
+            break;
+        }
+
+        /* Both values must have the same number of fields. */
+        match = ( pActual[ actualLen ] == ',' ) && ( pDesired[ desiredLen ] == ',' );
+        pActual = &pActual[ actualLen + 1U ];
+        pDesired = &pDesired[ desiredLen + 1U ];
+    }
+
+    return match;
+}
+
+/*-----------------------------------------------------------*/
+
+static CellularPktStatus_t _Cellular_RecvFuncGetConfig( CellularContext_t * pContext,
+                                                        const CellularATCommandResponse_t * pAtResp,
+                                                        void * pData,
+                                                        uint16_t dataLen )
+{
+    CellularPktStatus_t pktStatus = CELLULAR_PKT_STATUS_OK;
+    CellularATError_t atCoreStatus = CELLULAR_AT_SUCCESS;
+    char * pRespLine = NULL;
+
+    if( pContext == NULL )
+    {
+        pktStatus = CELLULAR_PKT_STATUS_INVALID_HANDLE;
+    }
+    else if( ( pAtResp == NULL ) || ( pAtResp->pItm == NULL ) ||
+             ( pAtResp->pItm->pLine == NULL ) || ( pData == NULL ) || ( dataLen == 0U ) )
+    {
+        LogError( "getConfig: Response is invalid" );
+        pktStatus = CELLULAR_PKT_STATUS_BAD_PARAM;
+    }
+    else
+    {
+        pRespLine = pAtResp->pItm->pLine;
+        atCoreStatus = Cellular_ATRemovePrefix( &pRespLine );
+
+        if( atCoreStatus == CELLULAR_AT_SUCCESS )
+        {
+            normalizeConfigValue( ( char * ) pData, dataLen, pRespLine );
+        }
+
+        pktStatus = _Cellular_TranslateAtCoreStatus( atCoreStatus );
+    }
+
+    return pktStatus;
+}
+
+/*-----------------------------------------------------------*/
+
+static CellularPktStatus_t _Cellular_RecvFuncGetImei( CellularContext_t * pContext,
+                                                      const CellularATCommandResponse_t * pAtResp,
+                                                      void * pData,
+                                                      uint16_t dataLen )
+{
+    CellularPktStatus_t pktStatus = CELLULAR_PKT_STATUS_OK;
+
+    if( pContext == NULL )
+    {
+        pktStatus = CELLULAR_PKT_STATUS_INVALID_HANDLE;
+    }
+    else if( ( pAtResp == NULL ) || ( pAtResp->pItm == NULL ) ||
+             ( pAtResp->pItm->pLine == NULL ) || ( pData == NULL ) || ( dataLen == 0U ) )
+    {
+        LogError( "getImei: Response is invalid" );
+        pktStatus = CELLULAR_PKT_STATUS_BAD_PARAM;
+    }
+    else
+    {
+        normalizeConfigValue( ( char * ) pData, dataLen, pAtResp->pItm->pLine );
+    }
+
+    return pktStatus;
+}
+
+/*-----------------------------------------------------------*/
+
+CellularError_t Cellular_BG96QueryConfig( CellularContext_t * pContext,
+                                          const char * pQueryCmd,
+                                          const char * pRespPrefix,
+                                          char * pValue,
+                                          uint16_t valueSize )
+{
+    CellularPktStatus_t pktStatus = CELLULAR_PKT_STATUS_OK;
+    CellularAtReq_t atReqGetConfig =
+    {
+        pQueryCmd,
+        CELLULAR_AT_WITH_PREFIX,
+        pRespPrefix,
+        _Cellular_RecvFuncGetConfig,
+        pValue,
+        valueSize,
+    };
+
+    if( ( pValue == NULL ) || ( valueSize == 0U ) )
+    {
+        pktStatus = CELLULAR_PKT_STATUS_BAD_PARAM;
+    }
+    else
+    {
+        pValue[ 0 ] = '\0';
+        pktStatus = _Cellular_AtcmdRequestWithCallback( pContext, atReqGetConfig );
+    }
+
+    return _Cellular_TranslatePktStatus( pktStatus );
+}
+
+/*-----------------------------------------------------------*/
+
+static uint32_t configFingerprint( const bg96ConfigItem_t * pItems,
+                                   uint32_t itemCount,
+                                   const char * pImei )
+{
+    uint32_t fingerprint = BG96_FNV_OFFSET_BASIS;
+    const char * pChar = NULL;
+    uint32_t i = 0U;
+
+    /* FNV-1a over the module IMEI, so a replaced module is checked again,
+     * and the commands and suffixes of all items. */
+    for( pChar = pImei; *pChar != '\0'; pChar++ )
+    {
+        fingerprint = ( fingerprint ^ ( uint8_t ) *pChar ) * BG96_FNV_PRIME;
+    }
+
+    for( i = 0U; i < itemCount; i++ )
+    {
+        for( pChar = pItems[ i ].pSetCmd; *pChar != '\0'; pChar++ )
+        {
+            fingerprint = ( fingerprint ^ ( uint8_t ) *pChar ) * BG96_FNV_PRIME;
+        }
+
+        for( pChar = pItems[ i ].pApplySuffix; *pChar != '\0'; pChar++ )
+        {
+            fingerprint = ( fingerprint ^ ( uint8_t ) *pChar ) * BG96_FNV_PRIME;
+        }
+
+        fingerprint = ( fingerprint ^ ( uint8_t ) '\n' ) * BG96_FNV_PRIME;
+    }
+
+    return fingerprint;
+}
+
+/*-----------------------------------------------------------*/
+
+static CellularError_t applyModuleConfig( CellularContext_t * pContext,
+                                          const bg96ConfigItem_t * pItems,
+                                          uint32_t itemCount )
+{
+    CellularError_t cellularStatus = CELLULAR_SUCCESS;
+    CellularAtReq_t atReqSetConfig =
+    {
+        NULL,
+        CELLULAR_AT_NO_RESULT,
+        NULL,
+        NULL,
+        NULL,
+        0
+    };
+    char cmdBuf[ BG96_CONFIG_CMD_MAX_SIZE ] = { '\0' };
+    char respPrefix[ BG96_CONFIG_PREFIX_MAX_SIZE ] = { '\0' };
+    char desiredValue[ BG96_CONFIG_VALUE_MAX_SIZE ] = { '\0' };
+    char currentValue[ BG96_CONFIG_VALUE_MAX_SIZE ] = { '\0' };
+    char imei[ CELLULAR_IMEI_MAX_SIZE + 1U ] = { '\0' };
+    CellularAtReq_t atReqGetImei =
+    {
+        "AT+CGSN",
+        CELLULAR_AT_WO_PREFIX,
+        NULL,
+        _Cellular_RecvFuncGetImei,
+        imei,
+        sizeof( imei )
+    };
+    const char * pValue = NULL;
+    uint32_t fingerprint = 0U;
+    uint32_t prefixLen = 0U;
+    uint32_t i = 0U;
+
+    cellularBg96Context.networkConfigChanged = false;
+
+    if( sendAtCommandWithRetryTimeout( pContext, &atReqGetImei ) != CELLULAR_SUCCESS )
+    {
+        /* Without the IMEI the fingerprint can't match a stored one. */
+        imei[ 0 ] = '\0';
+    }
+
+    fingerprint = configFingerprint( pItems, itemCount, imei );
+
+    if( appliedConfigLoaded == false )
+    {
+        appliedConfigFingerprint = CellularBG96_LoadConfigFingerprint();
+        appliedConfigLoaded = true;
+    }
+
+    if( ( imei[ 0 ] != '\0' ) && ( fingerprint == appliedConfigFingerprint ) )
+    {
+        /* Already verified on this module. */
+        LogDebug( "Module configuration unchanged, fingerprint 0x%08lx", ( unsigned long ) fingerprint );
+    }
+    else
+    {
+        for( i = 0U; ( i < itemCount ) && ( cellularStatus == CELLULAR_SUCCESS ); i++ )
+        {
+            /* AT+QCFG="band",F,80004,80 : query AT+QCFG="band", prefix +QCFG,
+             * value band,F,80004,80. */
+            pValue = strchr( pItems[ i ].pSetCmd, '=' );
+            configASSERT( ( pValue != NULL ) && ( strncmp( pItems[ i ].pSetCmd, "AT", 2 ) == 0 ) );
+
+            prefixLen = ( uint32_t ) ( pValue - &pItems[ i ].pSetCmd[ 2 ] );
+            configASSERT( prefixLen < sizeof( respPrefix ) );
+            ( void ) memcpy( respPrefix, &pItems[ i ].pSetCmd[ 2 ], prefixLen );
+            respPrefix[ prefixLen ] = '\0';
+
+            ( void ) snprintf( cmdBuf, sizeof( cmdBuf ), "%.*s",
+                               ( int ) strcspn( pItems[ i ].pSetCmd, "," ), pItems[ i ].pSetCmd );
+            normalizeConfigValue( desiredValue, sizeof( desiredValue ), &pValue[ 1 ] );
+
+            if( ( Cellular_BG96QueryConfig( pContext, cmdBuf, respPrefix, currentValue, sizeof( currentValue ) ) == CELLULAR_SUCCESS ) &&
+                ( Cellular_BG96ConfigValuesMatch( currentValue, desiredValue ) == true ) )
+            {
+                LogDebug( "Module setting %s already applied", desiredValue );
+            }
+            else
+            {
+                LogInfo( "Module setting %s differs from %s, applying", currentValue, desiredValue );
+                ( void ) snprintf( cmdBuf, sizeof( cmdBuf ), "%s%s", pItems[ i ].pSetCmd, pItems[ i ].pApplySuffix );
+                atReqSetConfig.pAtCmd = cmdBuf;
+                cellularStatus = sendAtCommandWithRetryTimeout( pContext, &atReqSetConfig );
+
+                if( pItems[ i ].networkSetting == true )
+                {
+                    cellularBg96Context.networkConfigChanged = true;
+                }
+            }
+        }
+
+        if( ( cellularStatus == CELLULAR_SUCCESS ) && ( imei[ 0 ] != '\0' ) )
+        {
+            appliedConfigFingerprint = fingerprint;
+            CellularBG96_StoreConfigFingerprint( fingerprint );
+        }
+    }
+
+    return cellularStatus;
+}
+
+/*-----------------------------------------------------------*/
+
+bool Cellular_BG96IsRescanRequired( CellularHandle_t cellularHandle )
+{
+    const CellularContext_t * pContext = ( const CellularContext_t * ) cellularHandle;
+    cellularModuleContext_t * pModuleContext = NULL;
+    bool rescanRequired = true;
+
+    if( ( pContext != NULL ) &&
+        ( _Cellular_GetModuleContext( pContext, ( void ** ) &pModuleContext ) == CELLULAR_SUCCESS ) &&
+        ( pModuleContext != NULL ) )
+    {
+        rescanRequired = pModuleContext->networkConfigChanged;
+    }
+
+    return rescanRequired;
+}
+
+/*-----------------------------------------------------------*/
+
 CellularError_t Cellular_ModuleInit( const CellularContext_t * pContext,
                                      void ** ppModuleContext )
 {
@@ -227,6 +701,27 @@ CellularError_t Cellular_ModuleEnableUE( CellularContext_t * pContext )
     };
     char ratSelectCmd[ BG96_NWSCANSEQ_CMD_MAX_SIZE ] = "AT+QCFG=\"nwscanseq\",";
     bool retAppendRat = true;
+    const bg96ConfigItem_t configItems[] =
+    {
+        /* Setting URC output port. */
+        #if defined( CELLULAR_BG96_URC_PORT_USBAT ) || defined( BG96_URC_PORT_USBAT )
+            { "AT+QURCCFG=\"urcport\",\"usbat\"", "", false },
+        #else
+            { "AT+QURCCFG=\"urcport\",\"uart1\"", "", false },
+        #endif
+        /* Configure Band configuration to all bands. */
+        #ifndef CUSTOM_BAND_BG96
+            { "AT+QCFG=\"band\",F,400a0e189f,a0e189f ", "", true },
+        #else
+            { CUSTOM_BAND_BG96, "", true },
+        #endif
+        /* Configure RAT(s) to be Searched to Automatic. */
+        { "AT+QCFG=\"nwscanmode\",0", ",1", true },
+        /* Configure Network Category to be Searched under LTE RAT to LTE Cat M1 and Cat NB1. */
+        { "AT+QCFG=\"iotopmode\",2", ",1", true },
+        /* Configure RAT Searching Sequence, take effect immediately. */
+        { ratSelectCmd, ",1", true }
+    };
 
     if( pContext != NULL )
     {
@@ -250,42 +745,6 @@ CellularError_t Cellular_ModuleEnableUE( CellularContext_t * pContext )
             }
         #endif
 
-        if( cellularStatus == CELLULAR_SUCCESS )
-        {
-            /* Setting URC output port. */
-            #if defined( CELLULAR_BG96_URC_PORT_USBAT ) || defined( BG96_URC_PORT_USBAT )
-                atReqGetNoResult.pAtCmd = "AT+QURCCFG=\"urcport\",\"usbat\"";
-            #else
-                atReqGetNoResult.pAtCmd = "AT+QURCCFG=\"urcport\",\"uart1\"";
-            #endif
-            cellularStatus = sendAtCommandWithRetryTimeout( pContext, &atReqGetNoResult );
-        }
-
-        if( cellularStatus == CELLULAR_SUCCESS )
-        {
-            /* Configure Band configuration to all bands. */
-            #ifndef CUSTOM_BAND_BG96
-                atReqGetNoResult.pAtCmd = "AT+QCFG=\"band\",F,400a0e189f,a0e189f ";
-            #else
-                atReqGetNoResult.pAtCmd = CUSTOM_BAND_BG96;
-            #endif
-            cellularStatus = sendAtCommandWithRetryTimeout( pContext, &atReqGetNoResult );
-        }
-
-        if( cellularStatus == CELLULAR_SUCCESS )
-        {
-            /* Configure RAT(s) to be Searched to Automatic. */
-            atReqGetNoResult.pAtCmd = "AT+QCFG=\"nwscanmode\",0,1";
-            cellularStatus = sendAtCommandWithRetryTimeout( pContext, &atReqGetNoResult );
-        }
-
-        if( cellularStatus == CELLULAR_SUCCESS )
-        {
-            /* Configure Network Category to be Searched under LTE RAT to LTE Cat M1 and Cat NB1. */
-            atReqGetNoResult.pAtCmd = "AT+QCFG=\"iotopmode\",2,1";
-            cellularStatus = sendAtCommandWithRetryTimeout( pContext, &atReqGetNoResult );
-        }
-
         if( cellularStatus == CELLULAR_SUCCESS )
         {
             retAppendRat = appendRatList( ratSelectCmd, CELLULAR_CONFIG_DEFAULT_RAT );
@@ -301,9 +760,10 @@ CellularError_t Cellular_ModuleEnableUE( CellularContext_t * pContext )
                 configASSERT( retAppendRat == true );
             #endif
 
-            strcat( ratSelectCmd, ",1" ); /* Take effect immediately. */
-            atReqGetNoResult.pAtCmd = ratSelectCmd;
-            cellularStatus = sendAtCommandWithRetryTimeout( pContext, &atReqGetNoResult );
+            /* Only write the settings the module does not have yet. Some of them
+             * are stored in the module NVM and trigger a reconfiguration. */
+            cellularStatus = applyModuleConfig( pContext, configItems,
+                                                sizeof( configItems ) / sizeof( configItems[ 0 ] ) );
         }
 
         if( cellularStatus == CELLULAR_SUCCESS )
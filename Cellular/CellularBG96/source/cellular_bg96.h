@@ -95,6 +95,9 @@ typedef struct cellularModuleContext
     #endif /* CELLULAR_BG96_SUPPPORT_DIRECT_PUSH_SOCKET. */
 
     CellularDnsResultEventCallback_t dnsEventCallback;
+
+    /* Module configuration. */
+    bool networkConfigChanged; /* A network setting or the PDN config was written since Cellular_Init. */
 } cellularModuleContext_t;
 
 /*-----------------------------------------------------------*/
@@ -107,6 +110,18 @@ CellularPktStatus_t Cellular_BG96InputBufferCallback( void * pInputBufferCallbac
                                                       uint32_t bufferLength,
                                                       uint32_t * pBufferLengthHandled );
 
+/* Read a module setting, normalized without white spaces outside of quotes. */
+CellularError_t Cellular_BG96QueryConfig( CellularContext_t * pContext,
+                                          const char * pQueryCmd,
+                                          const char * pRespPrefix,
+                                          char * pValue,
+                                          uint16_t valueSize );
+
+/* Compare normalized setting values field by field. Quoted strings must be
+ * equal, hex numbers are compared by value. */
+bool Cellular_BG96ConfigValuesMatch( const char * pActual,
+                                     const char * pDesired );
+
 /*-----------------------------------------------------------*/
 
 extern CellularAtParseTokenMap_t CellularUrcHandlerTable[];
@@ -120,7 +135,11 @@ extern uint32_t CellularSrcTokenSuccessTableSize;
 
 extern const char * CellularUrcTokenWoPrefixTable[];
 extern uint32_t CellularUrcTokenWoPrefixTableSize;
-
+
+/* Response schemas, see cellular_bg96_schema.c. */
+extern const CellularATSchema_t CellularQpsmsSchema;
+extern const CellularATSchema_t CellularQiactSchema;
+
 /*-----------------------------------------------------------*/
 
 /* *INDENT-OFF* */
@@ -81,15 +81,7 @@
 #define PRINTF_BYTE_TO_BINARY_INT8( i ) \
         PRINTF_BYTE_TO_BINARY_INT4( ( i ) >> 4 ), PRINTF_BYTE_TO_BINARY_INT4( i )
 
-#define QPSMS_POS_MODE                           ( 0U )
-#define QPSMS_POS_RAU                            ( 1U )
-#define QPSMS_POS_RDY_TIMER                      ( 2U )
-#define QPSMS_POS_TAU                            ( 3U )
-#define QPSMS_POS_ACTIVE_TIME                    ( 4U )
-
-#define CELLULAR_PDN_STATUS_POS_CONTEXT_ID       ( 0U )
-#define CELLULAR_PDN_STATUS_POS_CONTEXT_STATE    ( 1U )
-#define CELLULAR_PDN_STATUS_POS_CONTEXT_TYPE     ( 2U )
+/* Parameter of the IP address in CellularQiactSchema. */
 #define CELLULAR_PDN_STATUS_POS_IP_ADDRESS       ( 3U )
 
 #define RAT_PRIOIRTY_STRING_LENGTH               ( 2U )
@@ -163,15 +155,6 @@ static CellularPktStatus_t _Cellular_RecvFuncGetSimLockStatus( CellularContext_t
                                                                const CellularATCommandResponse_t * pAtResp,
                                                                void * pData,
                                                                uint16_t dataLen );
-static CellularATError_t parsePdnStatusContextId( char * pToken,
-                                                  CellularPdnStatus_t * pPdnStatusBuffers );
-static CellularATError_t parsePdnStatusContextState( char * pToken,
-                                                     CellularPdnStatus_t * pPdnStatusBuffers );
-static CellularATError_t parsePdnStatusContextType( char * pToken,
-                                                    CellularPdnStatus_t * pPdnStatusBuffers );
-static CellularATError_t getPdnStatusParseToken( char * pToken,
-                                                 uint8_t tokenIndex,
-                                                 CellularPdnStatus_t * pPdnStatusBuffers );
 static CellularATError_t getPdnStatusParseLine( char * pRespLine,
                                                 CellularPdnStatus_t * pPdnStatusBuffers );
 static CellularPktStatus_t _Cellular_RecvFuncGetPdnStatus( CellularContext_t * pContext,
@@ -187,19 +170,6 @@ static CellularPktStatus_t _Cellular_RecvFuncData( CellularContext_t * pContext,
                                                    const CellularATCommandResponse_t * pAtResp,
                                                    void * pData,
                                                    uint16_t dataLen );
-static CellularATError_t parseQpsmsMode( char * pToken,
-                                         CellularPsmSettings_t * pPsmSettings );
-static CellularATError_t parseQpsmsRau( char * pToken,
-                                        CellularPsmSettings_t * pPsmSettings );
-static CellularATError_t parseQpsmsRdyTimer( char * pToken,
-                                             CellularPsmSettings_t * pPsmSettings );
-static CellularATError_t parseQpsmsTau( char * pToken,
-                                        CellularPsmSettings_t * pPsmSettings );
-static CellularATError_t parseQpsmsActiveTime( char * pToken,
-                                               CellularPsmSettings_t * pPsmSettings );
-static CellularATError_t parseGetPsmToken( char * pToken,
-                                           uint8_t tokenIndex,
-                                           CellularPsmSettings_t * pPsmSettings );
 static CellularRat_t convertRatPriority( char * pRatString );
 static CellularPktStatus_t _Cellular_RecvFuncGetRatPriority( CellularContext_t * pContext,
                                                              const CellularATCommandResponse_t * pAtResp,
@@ -275,7 +245,8 @@ static qcsqServiceMode_t _parseQcsqServiceMode( char * pSysmode )
 static bool _parseSignalQuality( char * pQcsqPayload,
                                  CellularSignalInfo_t * pSignalInfo )
 {
-    char * pToken = NULL, * pTmpQcsqPayload = pQcsqPayload;
+    CellularATTokenizer_t tokenizer = { 0 };
+    CellularATToken_t token = { 0 };
     int32_t tempValue = 0;
     bool parseStatus = true;
     CellularATError_t atCoreStatus = CELLULAR_AT_SUCCESS;
@@ -287,13 +258,15 @@ static bool _parseSignalQuality( char * pQcsqPayload,
         parseStatus = false;
     }
 
-    if( ( parseStatus == true ) && ( Cellular_ATGetNextTok( &pTmpQcsqPayload, &pToken ) == CELLULAR_AT_SUCCESS ) )
+    if( ( parseStatus == true ) &&
+        ( Cellular_ATTokenizerInit( &tokenizer, pQcsqPayload ) == CELLULAR_AT_SUCCESS ) &&
+        ( Cellular_ATTokenizerNext( &tokenizer, ',', &token ) == CELLULAR_AT_SUCCESS ) )
     {
-        eQcsqSysmode = _parseQcsqServiceMode( pToken );
+        eQcsqSysmode = _parseQcsqServiceMode( token.pToken );
 
         if( eQcsqSysmode == QCSQ_SYSMODE_INVALID )
         {
-            LogError( "_parseSignalQuality: Invalide service mode in QCSQ Response %s.", pToken );
+            LogError( "_parseSignalQuality: Invalide service mode in QCSQ Response %s.", token.pToken );
             parseStatus = false;
         }
     }
@@ -312,9 +285,9 @@ static bool _parseSignalQuality( char * pQcsqPayload,
         else
         {
             /* Parse value1( gsm_rssi or lte_rssi ) for GSM, CAT-M1 and CAT-NB1. */
-            if( Cellular_ATGetNextTok( &pTmpQcsqPayload, &pToken ) == CELLULAR_AT_SUCCESS )
+            if( Cellular_ATTokenizerNext( &tokenizer, ',', &token ) == CELLULAR_AT_SUCCESS )
             {
-                atCoreStatus = Cellular_ATStrtoi( pToken, 10, &tempValue );
+                atCoreStatus = Cellular_ATStrtoi( token.pToken, 10, &tempValue );
 
                 if( atCoreStatus == CELLULAR_AT_SUCCESS )
                 {
@@ -322,7 +295,7 @@ static bool _parseSignalQuality( char * pQcsqPayload,
                 }
                 else
                 {
-                    LogError( "_parseSignalQuality: Error in processing RSSI. Token %s", pToken );
+                    LogError( "_parseSignalQuality: Error in processing RSSI. Token %s", token.pToken );
                     parseStatus = false;
                 }
             }
@@ -346,11 +319,11 @@ static bool _parseSignalQuality( char * pQcsqPayload,
         else
         {
             /* Get the token for value 2. */
-            atCoreStatus = Cellular_ATGetNextTok( &pTmpQcsqPayload, &pToken );
+            atCoreStatus = Cellular_ATTokenizerNext( &tokenizer, ',', &token );
 
             if( atCoreStatus == CELLULAR_AT_SUCCESS )
             {
-                atCoreStatus = Cellular_ATStrtoi( pToken, 10, &tempValue );
+                atCoreStatus = Cellular_ATStrtoi( token.pToken, 10, &tempValue );
             }
 
             /* Parse the lte_rsrp value. */
@@ -360,19 +333,19 @@ static bool _parseSignalQuality( char * pQcsqPayload,
             }
             else
             {
-                LogError( "_parseSignalQuality: Error in processing RSRP. Token %s", pToken );
+                LogError( "_parseSignalQuality: Error in processing RSRP. Token %s", token.pToken );
             }
 
             /* Get the token for value 3. */
             if( atCoreStatus == CELLULAR_AT_SUCCESS )
             {
-                atCoreStatus = Cellular_ATGetNextTok( &pTmpQcsqPayload, &pToken );
+                atCoreStatus = Cellular_ATTokenizerNext( &tokenizer, ',', &token );
             }
 
             /* Parse the lte_sinr value. */
             if( atCoreStatus == CELLULAR_AT_SUCCESS )
             {
-                atCoreStatus = Cellular_ATStrtoi( pToken, 10, &tempValue );
+                atCoreStatus = Cellular_ATStrtoi( token.pToken, 10, &tempValue );
 
                 if( atCoreStatus == CELLULAR_AT_SUCCESS )
                 {
@@ -382,20 +355,20 @@ static bool _parseSignalQuality( char * pQcsqPayload,
                 }
                 else
                 {
-                    LogError( "_parseSignalQuality: Error in processing SINR. pToken %s", pToken );
+                    LogError( "_parseSignalQuality: Error in processing SINR. pToken %s", token.pToken );
                 }
             }
 
             /* Get the token for value 4. */
             if( atCoreStatus == CELLULAR_AT_SUCCESS )
             {
-                atCoreStatus = Cellular_ATGetNextTok( &pTmpQcsqPayload, &pToken );
+                atCoreStatus = Cellular_ATTokenizerNext( &tokenizer, ',', &token );
             }
 
             /* Parse the lte_rsrq value. */
             if( atCoreStatus == CELLULAR_AT_SUCCESS )
             {
-                atCoreStatus = Cellular_ATStrtoi( pToken, 10, &tempValue );
+                atCoreStatus = Cellular_ATStrtoi( token.pToken, 10, &tempValue );
 
                 if( atCoreStatus == CELLULAR_AT_SUCCESS )
                 {
@@ -403,7 +376,7 @@ static bool _parseSignalQuality( char * pQcsqPayload,
                 }
                 else
                 {
-                    LogError( "_parseSignalQuality: Error in processing RSRQ. Token %s", pToken );
+                    LogError( "_parseSignalQuality: Error in processing RSRQ. Token %s", token.pToken );
                 }
             }
 
@@ -448,11 +421,7 @@ static CellularPktStatus_t _Cellular_RecvFuncGetSignalInfo( CellularContext_t *
         pInputLine = pAtResp->pItm->pLine;
         atCoreStatus = Cellular_ATRemovePrefix( &pInputLine );
 
-        if( atCoreStatus == CELLULAR_AT_SUCCESS )
-        {
-            atCoreStatus = Cellular_ATRemoveAllDoubleQuote( pInputLine );
-        }
-
+        /* The quotes around <sysmode> are removed by the tokenizer. */
         if( atCoreStatus == CELLULAR_AT_SUCCESS )
         {
             atCoreStatus = Cellular_ATRemoveAllWhiteSpaces( pInputLine );
@@ -1002,179 +971,33 @@ static CellularPktStatus_t _Cellular_RecvFuncGetSimLockStatus( CellularContext_t
 
 /*-----------------------------------------------------------*/
 
-static CellularATError_t parsePdnStatusContextId( char * pToken,
-                                                  CellularPdnStatus_t * pPdnStatusBuffers )
-{
-    int32_t tempValue = 0;
-    CellularATError_t atCoreStatus = Cellular_ATStrtoi( pToken, 10, &tempValue );
-
-    if( atCoreStatus == CELLULAR_AT_SUCCESS )
-    {
-        if( ( tempValue >= ( int32_t ) CELLULAR_PDN_CONTEXT_ID_MIN ) &&
-            ( tempValue <= ( int32_t ) CELLULAR_PDN_CONTEXT_ID_MAX ) )
-        {
-            pPdnStatusBuffers->contextId = ( uint8_t ) tempValue;
-        }
-        else
-        {
-            LogError( "Error in Processing Context Id. Token %s", pToken );
-            atCoreStatus = CELLULAR_AT_ERROR;
-        }
-    }
-
-    return atCoreStatus;
-}
-
-/*-----------------------------------------------------------*/
-
-static CellularATError_t parsePdnStatusContextState( char * pToken,
-                                                     CellularPdnStatus_t * pPdnStatusBuffers )
-{
-    int32_t tempValue = 0;
-    CellularATError_t atCoreStatus = Cellular_ATStrtoi( pToken, 10, &tempValue );
-
-    if( atCoreStatus == CELLULAR_AT_SUCCESS )
-    {
-        if( ( tempValue >= 0 ) &&
-            ( tempValue <= ( int32_t ) UINT8_MAX ) )
-        {
-            pPdnStatusBuffers->state = ( uint8_t ) tempValue;
-        }
-        else
-        {
-            LogError( "Error in processing PDN Status Buffer state. Token %s", pToken );
-            atCoreStatus = CELLULAR_AT_ERROR;
-        }
-    }
-
-    return atCoreStatus;
-}
-
-/*-----------------------------------------------------------*/
-
-static CellularATError_t parsePdnStatusContextType( char * pToken,
-                                                    CellularPdnStatus_t * pPdnStatusBuffers )
+static CellularATError_t getPdnStatusParseLine( char * pRespLine,
+                                                CellularPdnStatus_t * pPdnStatusBuffers )
 {
-    int32_t tempValue = 0;
-    CellularATError_t atCoreStatus = Cellular_ATStrtoi( pToken, 10, &tempValue );
+    uint32_t present = 0U;
+    CellularATError_t atCoreStatus = Cellular_ATParseResponse( pRespLine, &CellularQiactSchema,
+                                                               pPdnStatusBuffers, &present );
 
-    if( atCoreStatus == CELLULAR_AT_SUCCESS )
+    if( atCoreStatus != CELLULAR_AT_SUCCESS )
     {
-        if( ( tempValue >= 0 ) && ( tempValue < ( int32_t ) CELLULAR_PDN_CONTEXT_TYPE_MAX ) )
-        {
-            /* Variable "tempValue" is ensured that it is valid and within
-             * a valid range. Hence, assigning the value of the variable to
-             * pdnContextType with a enum cast. */
-            pPdnStatusBuffers->pdnContextType = ( CellularPdnContextType_t ) tempValue;
-        }
-        else
-        {
-            LogError( "Error in processing PDN State Buffer Status. Token %s", pToken );
-            atCoreStatus = CELLULAR_AT_ERROR;
-        }
+        LogInfo( "getPdnStatusParseLine: invalid +QIACT response" );
     }
-
-    return atCoreStatus;
-}
-
-/*-----------------------------------------------------------*/
-
-static CellularATError_t getPdnStatusParseToken( char * pToken,
-                                                 uint8_t tokenIndex,
-                                                 CellularPdnStatus_t * pPdnStatusBuffers )
-{
-    CellularATError_t atCoreStatus = CELLULAR_AT_SUCCESS;
-
-    switch( tokenIndex )
+    else if( ( present & ( 1UL << CELLULAR_PDN_STATUS_POS_IP_ADDRESS ) ) == 0U )
     {
-        case ( CELLULAR_PDN_STATUS_POS_CONTEXT_ID ):
-            LogDebug( "Context Id: %s", pToken );
-            atCoreStatus = parsePdnStatusContextId( pToken, pPdnStatusBuffers );
-            break;
-
-        case ( CELLULAR_PDN_STATUS_POS_CONTEXT_STATE ):
-            LogDebug( "Context State: %s", pToken );
-            atCoreStatus = parsePdnStatusContextState( pToken, pPdnStatusBuffers );
-            break;
-
-        case ( CELLULAR_PDN_STATUS_POS_CONTEXT_TYPE ):
-            LogDebug( "Context Type: %s", pToken );
-            atCoreStatus = parsePdnStatusContextType( pToken, pPdnStatusBuffers );
-            break;
-
-        case ( CELLULAR_PDN_STATUS_POS_IP_ADDRESS ):
-            LogDebug( "IP address: %s", pToken );
-            ( void ) memcpy( ( void * ) pPdnStatusBuffers->ipAddress.ipAddress,
-                             ( void * ) pToken, CELLULAR_IP_ADDRESS_MAX_SIZE + 1U );
-
-            if( pPdnStatusBuffers->pdnContextType == CELLULAR_PDN_CONTEXT_IPV4 )
-            {
-                pPdnStatusBuffers->ipAddress.ipAddressType = CELLULAR_IP_ADDRESS_V4;
-            }
-            else if( pPdnStatusBuffers->pdnContextType == CELLULAR_PDN_CONTEXT_IPV6 )
-            {
-                pPdnStatusBuffers->ipAddress.ipAddressType = CELLULAR_IP_ADDRESS_V6;
-            }
-            else
-            {
-                LogError( "Unknown pdnContextType %d", pPdnStatusBuffers->pdnContextType );
-                atCoreStatus = CELLULAR_AT_ERROR;
-            }
-
-            break;
-
-        default:
-            LogError( "Unknown token in getPdnStatusParseToken %s %d",
-                      pToken, tokenIndex );
-            atCoreStatus = CELLULAR_AT_ERROR;
-            break;
+        /* No IP address. */
     }
-
-    return atCoreStatus;
-}
-
-/*-----------------------------------------------------------*/
-
-static CellularATError_t getPdnStatusParseLine( char * pRespLine,
-                                                CellularPdnStatus_t * pPdnStatusBuffers )
-{
-    char * pToken = NULL;
-    char * pLocalRespLine = pRespLine;
-    CellularATError_t atCoreStatus = CELLULAR_AT_SUCCESS;
-    uint8_t tokenIndex = 0;
-
-    atCoreStatus = Cellular_ATRemovePrefix( &pLocalRespLine );
-
-    if( atCoreStatus == CELLULAR_AT_SUCCESS )
+    else if( pPdnStatusBuffers->pdnContextType == CELLULAR_PDN_CONTEXT_IPV4 )
     {
-        atCoreStatus = Cellular_ATRemoveAllDoubleQuote( pLocalRespLine );
+        pPdnStatusBuffers->ipAddress.ipAddressType = CELLULAR_IP_ADDRESS_V4;
     }
-
-    if( atCoreStatus == CELLULAR_AT_SUCCESS )
+    else if( pPdnStatusBuffers->pdnContextType == CELLULAR_PDN_CONTEXT_IPV6 )
     {
-        atCoreStatus = Cellular_ATGetNextTok( &pLocalRespLine, &pToken );
+        pPdnStatusBuffers->ipAddress.ipAddressType = CELLULAR_IP_ADDRESS_V6;
     }
-
-    if( atCoreStatus == CELLULAR_AT_SUCCESS )
+    else
     {
-        tokenIndex = 0;
-
-        while( ( pToken != NULL ) && ( atCoreStatus == CELLULAR_AT_SUCCESS ) )
-        {
-            atCoreStatus = getPdnStatusParseToken( pToken, tokenIndex, pPdnStatusBuffers );
-
-            if( atCoreStatus != CELLULAR_AT_SUCCESS )
-            {
-                LogInfo( "getPdnStatusParseToken %s index %d failed", pToken, tokenIndex );
-            }
-
-            tokenIndex++;
-
-            if( Cellular_ATGetNextTok( &pLocalRespLine, &pToken ) != CELLULAR_AT_SUCCESS )
-            {
-                break;
-            }
-        }
+        LogError( "Unknown pdnContextType %d", pPdnStatusBuffers->pdnContextType );
+        atCoreStatus = CELLULAR_AT_ERROR;
     }
 
     return atCoreStatus;
@@ -1437,165 +1260,6 @@ static CellularPktStatus_t _Cellular_RecvFuncData( CellularContext_t * pContext,
 
 /*-----------------------------------------------------------*/
 
-static CellularATError_t parseQpsmsMode( char * pToken,
-                                         CellularPsmSettings_t * pPsmSettings )
-{
-    int32_t tempValue = 0;
-    CellularATError_t atCoreStatus = Cellular_ATStrtoi( pToken, 10, &tempValue );
-
-    if( atCoreStatus == CELLULAR_AT_SUCCESS )
-    {
-        if( ( tempValue >= 0 ) && ( tempValue <= ( int32_t ) UINT8_MAX ) )
-        {
-            pPsmSettings->mode = ( uint8_t ) tempValue;
-        }
-        else
-        {
-            LogError( "Error in processing mode. Token %s", pToken );
-            atCoreStatus = CELLULAR_AT_ERROR;
-        }
-    }
-
-    return atCoreStatus;
-}
-
-/*-----------------------------------------------------------*/
-
-static CellularATError_t parseQpsmsRau( char * pToken,
-                                        CellularPsmSettings_t * pPsmSettings )
-{
-    int32_t tempValue = 0;
-    CellularATError_t atCoreStatus = Cellular_ATStrtoi( pToken, 10, &tempValue );
-
-    if( atCoreStatus == CELLULAR_AT_SUCCESS )
-    {
-        if( tempValue >= 0 )
-        {
-            pPsmSettings->periodicRauValue = ( uint32_t ) tempValue;
-        }
-        else
-        {
-            LogError( "Error in processing Periodic Processing RAU value. Token %s", pToken );
-            atCoreStatus = CELLULAR_AT_ERROR;
-        }
-    }
-
-    return atCoreStatus;
-}
-
-/*-----------------------------------------------------------*/
-
-static CellularATError_t parseQpsmsRdyTimer( char * pToken,
-                                             CellularPsmSettings_t * pPsmSettings )
-{
-    int32_t tempValue = 0;
-    CellularATError_t atCoreStatus = Cellular_ATStrtoi( pToken, 10, &tempValue );
-
-    if( atCoreStatus == CELLULAR_AT_SUCCESS )
-    {
-        if( tempValue >= 0 )
-        {
-            pPsmSettings->gprsReadyTimer = ( uint32_t ) tempValue;
-        }
-        else
-        {
-            LogError( "Error in processing Periodic Processing GPRS Ready Timer value. Token %s", pToken );
-            atCoreStatus = CELLULAR_AT_ERROR;
-        }
-    }
-
-    return atCoreStatus;
-}
-
-/*-----------------------------------------------------------*/
-
-static CellularATError_t parseQpsmsTau( char * pToken,
-                                        CellularPsmSettings_t * pPsmSettings )
-{
-    int32_t tempValue = 0;
-    CellularATError_t atCoreStatus = Cellular_ATStrtoi( pToken, 10, &tempValue );
-
-    if( atCoreStatus == CELLULAR_AT_SUCCESS )
-    {
-        if( tempValue >= 0 )
-        {
-            pPsmSettings->periodicTauValue = ( uint32_t ) tempValue;
-        }
-        else
-        {
-            LogError( "Error in processing Periodic TAU value value. Token %s", pToken );
-            atCoreStatus = CELLULAR_AT_ERROR;
-        }
-    }
-
-    return atCoreStatus;
-}
-
-/*-----------------------------------------------------------*/
-
-static CellularATError_t parseQpsmsActiveTime( char * pToken,
-                                               CellularPsmSettings_t * pPsmSettings )
-{
-    int32_t tempValue = 0;
-    CellularATError_t atCoreStatus = Cellular_ATStrtoi( pToken, 10, &tempValue );
-
-    if( atCoreStatus == CELLULAR_AT_SUCCESS )
-    {
-        if( tempValue >= 0 )
-        {
-            pPsmSettings->activeTimeValue = ( uint32_t ) tempValue;
-        }
-        else
-        {
-            LogError( "Error in processing Periodic Processing Active time value. Token %s", pToken );
-            atCoreStatus = CELLULAR_AT_ERROR;
-        }
-    }
-
-    return atCoreStatus;
-}
-
-/*-----------------------------------------------------------*/
-
-static CellularATError_t parseGetPsmToken( char * pToken,
-                                           uint8_t tokenIndex,
-                                           CellularPsmSettings_t * pPsmSettings )
-{
-    CellularATError_t atCoreStatus = CELLULAR_AT_SUCCESS;
-
-    switch( tokenIndex )
-    {
-        case QPSMS_POS_MODE:
-            atCoreStatus = parseQpsmsMode( pToken, pPsmSettings );
-            break;
-
-        case QPSMS_POS_RAU:
-            atCoreStatus = parseQpsmsRau( pToken, pPsmSettings );
-            break;
-
-        case QPSMS_POS_RDY_TIMER:
-            atCoreStatus = parseQpsmsRdyTimer( pToken, pPsmSettings );
-            break;
-
-        case QPSMS_POS_TAU:
-            atCoreStatus = parseQpsmsTau( pToken, pPsmSettings );
-            break;
-
-        case QPSMS_POS_ACTIVE_TIME:
-            atCoreStatus = parseQpsmsActiveTime( pToken, pPsmSettings );
-            break;
-
-        default:
-            LogDebug( "Unknown Parameter Position in AT+QPSMS Response" );
-            atCoreStatus = CELLULAR_AT_ERROR;
-            break;
-    }
-
-    return atCoreStatus;
-}
-
-/*-----------------------------------------------------------*/
-
 static CellularRat_t convertRatPriority( char * pRatString )
 {
     CellularRat_t retRat = CELLULAR_RAT_INVALID;
@@ -1695,8 +1359,6 @@ static CellularPktStatus_t _Cellular_RecvFuncGetPsmSettings( CellularContext_t *
                                                              void * pData,
                                                              uint16_t dataLen )
 {
-    char * pInputLine = NULL, * pToken = NULL;
-    uint8_t tokenIndex = 0;
     CellularPktStatus_t pktStatus = CELLULAR_PKT_STATUS_OK;
     CellularATError_t atCoreStatus = CELLULAR_AT_SUCCESS;
     CellularPsmSettings_t * pPsmSettings = NULL;
@@ -1714,61 +1376,8 @@ static CellularPktStatus_t _Cellular_RecvFuncGetPsmSettings( CellularContext_t *
     }
     else
     {
-        pInputLine = pAtResp->pItm->pLine;
         pPsmSettings = ( CellularPsmSettings_t * ) pData;
-        atCoreStatus = Cellular_ATRemovePrefix( &pInputLine );
-
-        if( atCoreStatus == CELLULAR_AT_SUCCESS )
-        {
-            atCoreStatus = Cellular_ATRemoveAllDoubleQuote( pInputLine );
-        }
-
-        if( atCoreStatus == CELLULAR_AT_SUCCESS )
-        {
-            atCoreStatus = Cellular_ATGetNextTok( &pInputLine, &pToken );
-        }
-
-        if( atCoreStatus == CELLULAR_AT_SUCCESS )
-        {
-            tokenIndex = 0;
-
-            while( pToken != NULL )
-            {
-                if( tokenIndex == 0 )
-                {
-                    atCoreStatus = parseGetPsmToken( pToken, tokenIndex, pPsmSettings );
-                }
-                else
-                {
-                    parseGetPsmToken( pToken, tokenIndex, pPsmSettings );
-                }
-
-                tokenIndex++;
-
-                if( *pInputLine == ',' )
-                {
-                    *pInputLine = '\0';
-                    pToken = pInputLine;
-                    *pToken = '\0';
-                    pInputLine = &pInputLine[ 1 ];
-                }
-                else if( Cellular_ATGetNextTok( &pInputLine, &pToken ) != CELLULAR_AT_SUCCESS )
-                {
-                    break;
-                }
-                else
-                {
-                    /* Empty Else MISRA 15.7 */
-                }
-            }
-        }
-
-        /* LogDebug( ( "PSM setting: mode: %d, RAU: %d, RDY_Timer: %d, TAU: %d, Active_time: %d", */
-        /* pPsmSettings->mode, */
-        /* pPsmSettings->periodicRauValue, */
-        /* pPsmSettings->gprsReadyTimer, */
-        /* pPsmSettings->periodicTauValue, */
-        /* pPsmSettings->activeTimeValue ) ); */
+        atCoreStatus = Cellular_ATParseResponse( pAtResp->pItm->pLine, &CellularQpsmsSchema, pPsmSettings, NULL );
         pktStatus = _Cellular_TranslateAtCoreStatus( atCoreStatus );
     }
 
@@ -1823,7 +1432,7 @@ static CellularPktStatus_t socketRecvDataPrefix( void * pCallbackContext,
     char pLocalLine[ 36 ]; /* Maximum size needed. */
     uint8_t pMaxQirdPrefixString;
     int32_t receivedDataLength = 0;
-    CellularPktStatus_t pktStatus;
+    CellularPktStatus_t pktStatus = CELLULAR_PKT_STATUS_OK;
 
     if( pCountCommas( pLine ) > 1 )
     {
@@ -2538,7 +2147,10 @@ CellularError_t Cellular_SetPdnConfig( CellularHandle_t cellularHandle,
     CellularContext_t * pContext = ( CellularContext_t * ) cellularHandle;
     CellularError_t cellularStatus = CELLULAR_SUCCESS;
     CellularPktStatus_t pktStatus = CELLULAR_PKT_STATUS_OK;
+    cellularModuleContext_t * pModuleContext = NULL;
     char cmdBuf[ CELLULAR_AT_CMD_MAX_SIZE ] = { '\0' };
+    char currentConfig[ CELLULAR_AT_CMD_MAX_SIZE ] = { '\0' };
+    bool configMatch = false;
     CellularAtReq_t atReqSetPdn =
     {
         cmdBuf,
@@ -2567,6 +2179,25 @@ CellularError_t Cellular_SetPdnConfig( CellularHandle_t cellularHandle,
     }
 
     if( cellularStatus == CELLULAR_SUCCESS )
+    {
+        /* The module stores the PDN config in NVM. Skip the write if the module
+         * already reports the same <context_type>,<APN>,<username>,<password>,<auth>. */
+        ( void ) snprintf( cmdBuf, CELLULAR_AT_CMD_MAX_SIZE, "%s%d", "AT+QICSGP=", contextId );
+
+        if( Cellular_BG96QueryConfig( pContext, cmdBuf, "+QICSGP", currentConfig, sizeof( currentConfig ) ) == CELLULAR_SUCCESS )
+        {
+            /* Build the desired value the way the module reports it. */
+            ( void ) snprintf( cmdBuf, CELLULAR_AT_CMD_MAX_SIZE, "%d,\"%s\",\"%s\",\"%s\",%d",
+                               pPdnConfig->pdnContextType,
+                               pPdnConfig->apnName,
+                               pPdnConfig->username,
+                               pPdnConfig->password,
+                               pPdnConfig->pdnAuthType );
+            configMatch = Cellular_BG96ConfigValuesMatch( currentConfig, cmdBuf );
+        }
+    }
+
+    if( ( cellularStatus == CELLULAR_SUCCESS ) && ( configMatch == false ) )
     {
         /* Form the AT command. */
 
@@ -2582,6 +2213,13 @@ CellularError_t Cellular_SetPdnConfig( CellularHandle_t cellularHandle,
                            pPdnConfig->pdnAuthType );
         pktStatus = _Cellular_AtcmdRequestWithCallback( pContext, atReqSetPdn );
 
+        /* The attach APN may have changed, so the module has to rescan. */
+        if( ( _Cellular_GetModuleContext( pContext, ( void ** ) &pModuleContext ) == CELLULAR_SUCCESS ) &&
+            ( pModuleContext != NULL ) )
+        {
+            pModuleContext->networkConfigChanged = true;
+        }
+
         if( pktStatus != CELLULAR_PKT_STATUS_OK )
         {
             LogError( "Cellular_SetPdnConfig: can't set PDN, cmdBuf:%s, PktRet: %d", cmdBuf, pktStatus );
@@ -2790,6 +2428,11 @@ CellularError_t Cellular_SocketRecv( CellularHandle_t cellularHandle,
                       socketHandle->dataMode );
             cellularStatus = CELLULAR_UNSUPPORTED;
         }
+
+        if( cellularStatus == CELLULAR_SUCCESS )
+        {
+            CellularMetrics_Socket( *pReceivedDataLength, 0U );
+        }
     }
 
     return cellularStatus;
@@ -2895,6 +2538,10 @@ CellularError_t Cellular_SocketSend( CellularHandle_t cellularHandle,
             LogError( "Cellular_SocketSend: Data send fail, PktRet: %d", pktStatus );
             cellularStatus = _Cellular_TranslatePktStatus( pktStatus );
         }
+        else
+        {
+            CellularMetrics_Socket( 0U, *pSentDataLength );
+        }
     }
 
     return cellularStatus;
@@ -0,0 +1,32 @@
+/*
+ * cellular_bg96_api.h
+ *
+ *  BG96 specific functions for the application, on top of cellular_api.h.
+ *
+ *  1NCE GmbH
+ */
+
+#ifndef __CELLULAR_BG96_API_H__
+#define __CELLULAR_BG96_API_H__
+
+/* *INDENT-OFF* */
+#ifdef __cplusplus
+    extern "C" {
+#endif
+/* *INDENT-ON* */
+
+#include <stdbool.h>
+
+#include "cellular_types.h"
+
+/* Whether Cellular_Init or Cellular_SetPdnConfig changed the network configuration,
+ * so the module has to rescan before registering. */
+bool Cellular_BG96IsRescanRequired( CellularHandle_t cellularHandle );
+
+/* *INDENT-OFF* */
+#ifdef __cplusplus
+    }
+#endif
+/* *INDENT-ON* */
+
+#endif /* __CELLULAR_BG96_API_H__ */
@@ -0,0 +1,61 @@
+/*
+ * cellular_bg96_schema.c
+ *
+ *  Schemas of the BG96 responses parsed with Cellular_ATParseResponse().
+ *  Tools/at_conformance checks them against recorded responses.
+ *
+ *  1NCE GmbH
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "cellular_platform.h"
+#include "cellular_config.h"
+#include "cellular_config_defaults.h"
+#include "cellular_common.h"
+#include "cellular_at_core.h"
+#include "cellular_bg96.h"
+
+/*-----------------------------------------------------------*/
+
+/* +QPSMS: <mode>[,<Periodic-RAU>][,<GPRS-READY-timer>][,<Periodic-TAU>][,<Active-Time>]
+ * The timers are in seconds. */
+static const CellularATField_t qpsmsFields[] =
+{
+    CELLULAR_AT_SCHEMA_INTEGER( CellularPsmSettings_t, mode, 10U, false, 0, ( int32_t ) UINT8_MAX ),
+    CELLULAR_AT_SCHEMA_INTEGER( CellularPsmSettings_t, periodicRauValue, 10U, true, 0, INT32_MAX ),
+    CELLULAR_AT_SCHEMA_INTEGER( CellularPsmSettings_t, gprsReadyTimer, 10U, true, 0, INT32_MAX ),
+    CELLULAR_AT_SCHEMA_INTEGER( CellularPsmSettings_t, periodicTauValue, 10U, true, 0, INT32_MAX ),
+    CELLULAR_AT_SCHEMA_INTEGER( CellularPsmSettings_t, activeTimeValue, 10U, true, 0, INT32_MAX )
+};
+
+const CellularATSchema_t CellularQpsmsSchema =
+{
+    "+QPSMS",
+    qpsmsFields,
+    ( uint8_t ) ARRAY_SIZE( qpsmsFields )
+};
+
+/*-----------------------------------------------------------*/
+
+/* +QIACT: <contextID>,<context_state>,<context_type>[,<IP_address>]
+ * One line per active context. */
+static const CellularATField_t qiactFields[] =
+{
+    CELLULAR_AT_SCHEMA_INTEGER( CellularPdnStatus_t, contextId, 10U, false,
+                                ( int32_t ) CELLULAR_PDN_CONTEXT_ID_MIN, ( int32_t ) CELLULAR_PDN_CONTEXT_ID_MAX ),
+    CELLULAR_AT_SCHEMA_INTEGER( CellularPdnStatus_t, state, 10U, false, 0, ( int32_t ) UINT8_MAX ),
+    CELLULAR_AT_SCHEMA_INTEGER( CellularPdnStatus_t, pdnContextType, 10U, false,
+                                0, ( int32_t ) CELLULAR_PDN_CONTEXT_TYPE_MAX - 1 ),
+    CELLULAR_AT_SCHEMA_STRING( CellularPdnStatus_t, ipAddress.ipAddress, true )
+};
+
+const CellularATSchema_t CellularQiactSchema =
+{
+    "+QIACT",
+    qiactFields,
+    ( uint8_t ) ARRAY_SIZE( qiactFields )
+};
+
+/*-----------------------------------------------------------*/
@@ -48,14 +48,19 @@
 #ifndef LIBRARY_LOG_NAME
     #define LIBRARY_LOG_NAME    "CellularLib"
 #endif
+#ifndef LIBRARY_LOG_MODULE
+    #define LIBRARY_LOG_MODULE    IOT_LOG_MODULE_CELLULAR_LIB
+#endif
 
-#ifdef IOT_LOG_LEVEL_CELLULAR_LIB
-    #define LIBRARY_LOG_LEVEL        IOT_LOG_LEVEL_CELLULAR_LIB
-#else
-    #ifdef IOT_LOG_LEVEL_GLOBAL
-        #define LIBRARY_LOG_LEVEL    IOT_LOG_LEVEL_GLOBAL
+#ifndef LIBRARY_LOG_LEVEL
+    #ifdef IOT_LOG_LEVEL_CELLULAR_LIB
+        #define LIBRARY_LOG_LEVEL        IOT_LOG_LEVEL_CELLULAR_LIB
     #else
-        #define LIBRARY_LOG_LEVEL    IOT_LOG_NONE
+        #ifdef IOT_LOG_LEVEL_GLOBAL
+            #define LIBRARY_LOG_LEVEL    IOT_LOG_LEVEL_GLOBAL
+        #else
+            #define LIBRARY_LOG_LEVEL    IOT_LOG_NONE
+        #endif
     #endif
 #endif
 
@@ -143,4 +148,23 @@
         #define CELLULAR_NUM_SOCKET_MAX    ( 4U )
     #endif
 #endif /* if ( CELLULAR_CONFIG_STATIC_ALLOCATION_SOCKET_CONTEXT == 1U ) */
+
+/* Feed the cellular performance counters of platform/iot_metrics.h. */
+#if ( IOT_METRICS_CELLULAR_ENABLED == 1 )
+    #include "platform/iot_clock.h"
+    #include "platform/iot_metrics.h"
+
+    #define CellularMetrics_GetTimeMs()                                    ( ( uint32_t ) IotClock_GetTimeMs() )
+    #define CellularMetrics_AtCommand( atCmdType, latencyMs, timedOut )    IotMetrics_CellularAtCommand( ( uint32_t ) ( atCmdType ), ( latencyMs ), ( timedOut ) )
+    #define CellularMetrics_Urc( pUrcLine )                                IotMetrics_CellularUrc( pUrcLine )
+    #define CellularMetrics_Socket( bytesIn, bytesOut )                    IotMetrics_CellularSocket( ( bytesIn ), ( bytesOut ) )
+#endif
+
+/* Keep the fingerprint of the verified module configuration next to the cached
+ * DTLS credentials in flash, see nce_psk_cache.h. */
+uint32_t NcePskCache_LoadModemConfig( void );
+bool NcePskCache_StoreModemConfig( uint32_t fingerprint );
+
+#define CellularBG96_LoadConfigFingerprint()                  NcePskCache_LoadModemConfig()
+#define CellularBG96_StoreConfigFingerprint( fingerprint )    ( ( void ) NcePskCache_StoreModemConfig( fingerprint ) )
 #endif /* __CELLULAR_CONFIG_H__ */
@@ -0,0 +1,282 @@
+/*
+ * cellular_pdn.c
+ *
+ *  PDN manager. Activates the PDN context of the sockets on the platform work
+ *  pool and keeps it active: when the module reports +QIURC: "pdpdeact", only
+ *  the context is activated again, without a new network registration. Failed
+ *  activations are retried with exponential backoff.
+ *
+ *  The local IP address is taken from the context list (AT+QIACT?) that
+ *  confirms the activation, so no separate address query is needed. The
+ *  sockets of a deactivated context are closed by the BG96 URC handler, which
+ *  reports them to their owners through the socket closed callback.
+ *
+ *  1NCE GmbH
+ */
+
+/* FreeRTOS include. */
+#include <FreeRTOS.h>
+#include "task.h"
+#include "event_groups.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+/* FreeRTOS Cellular Library include. */
+#include "cellular_config.h"
+#include "cellular_config_defaults.h"
+#include "cellular_types.h"
+#include "cellular_api.h"
+
+#include "cellular_platform.h"
+#include "cellular_pdn.h"
+
+/*-----------------------------------------------------------*/
+
+/* Delay before the first retry of a failed activation, doubled up to the
+ * maximum by every further failure. */
+#ifndef CELLULAR_PDN_BACKOFF_MIN_MS
+    #define CELLULAR_PDN_BACKOFF_MIN_MS    ( 2000UL )
+#endif
+#ifndef CELLULAR_PDN_BACKOFF_MAX_MS
+    #define CELLULAR_PDN_BACKOFF_MAX_MS    ( 120000UL )
+#endif
+
+#define CELLULAR_PDN_CONTEXT_NUM           ( CELLULAR_PDN_CONTEXT_ID_MAX - CELLULAR_PDN_CONTEXT_ID_MIN + 1U )
+
+#define CELLULAR_PDN_UP_EVENT_BIT          ( 0x01UL )
+
+/*-----------------------------------------------------------*/
+
+static CellularHandle_t pdnCellularHandle = NULL;
+static uint8_t pdnContextId = 0U;
+
+/* Written by the activation work and by the URC callback. */
+static volatile CellularPdnState_t pdnState = CELLULAR_PDN_STATE_DOWN;
+static volatile uint32_t pdnDeactivations = 0U;
+
+/* Only touched by the activation work, and read while the context is up. */
+static uint32_t pdnBackoffMs = CELLULAR_PDN_BACKOFF_MIN_MS;
+static char pdnIpAddress[ CELLULAR_IP_ADDRESS_MAX_SIZE + 1U ] = { '\0' };
+
+static PlatformWork_t pdnActivateWork;
+
+static StaticEventGroup_t pdnEventGroupBuffer;
+static EventGroupHandle_t pdnEventGroup = NULL;
+
+/*-----------------------------------------------------------*/
+
+static bool prvGetActiveContext( char * pIpAddress,
+                                 size_t ipAddressLength )
+{
+    CellularPdnStatus_t pdnStatusBuffers[ CELLULAR_PDN_CONTEXT_NUM ] = { 0 };
+    uint8_t numStatus = 0U;
+    bool active = false;
+    uint8_t i = 0U;
+
+    if( Cellular_GetPdnStatus( pdnCellularHandle, pdnStatusBuffers, CELLULAR_PDN_CONTEXT_NUM, &numStatus ) == CELLULAR_SUCCESS )
+    {
+        for( i = 0U; ( i < numStatus ) && ( i < CELLULAR_PDN_CONTEXT_NUM ); i++ )
+        {
+            if( ( pdnStatusBuffers[ i ].contextId == pdnContextId ) && ( pdnStatusBuffers[ i ].state == 1U ) )
+            {
+                ( void ) strncpy( pIpAddress, pdnStatusBuffers[ i ].ipAddress.ipAddress, ipAddressLength - 1U );
+                pIpAddress[ ipAddressLength - 1U ] = '\0';
+                active = true;
+                break;
+            }
+        }
+    }
+
+    return active;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvActivateWork( void * pArgument )
+{
+    CellularError_t cellularStatus = CELLULAR_SUCCESS;
+    char ipAddress[ CELLULAR_IP_ADDRESS_MAX_SIZE + 1U ] = { '\0' };
+    uint32_t deactivations = pdnDeactivations;
+    bool active = false;
+    bool up = false;
+
+    ( void ) pArgument;
+
+    /* The context may have survived, e.g. when setup is retried. */
+    active = prvGetActiveContext( ipAddress, sizeof( ipAddress ) );
+
+    if( active == false )
+    {
+        cellularStatus = Cellular_ActivatePdn( pdnCellularHandle, pdnContextId );
+
+        if( cellularStatus == CELLULAR_SUCCESS )
+        {
+            active = prvGetActiveContext( ipAddress, sizeof( ipAddress ) );
+        }
+        else
+        {
+            configPRINTF( ( ">>>  Cellular_ActivatePdn failure %d  <<<\r\n", cellularStatus ) );
+        }
+    }
+
+    taskENTER_CRITICAL();
+    {
+        /* A deactivation reported while the work ran queued another run. */
+        if( ( active == true ) && ( deactivations == pdnDeactivations ) )
+        {
+            ( void ) memcpy( pdnIpAddress, ipAddress, sizeof( pdnIpAddress ) );
+            pdnState = CELLULAR_PDN_STATE_UP;
+            up = true;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    if( up == true )
+    {
+        pdnBackoffMs = CELLULAR_PDN_BACKOFF_MIN_MS;
+        configPRINTF( ( ">>>  Cellular PDN %u active, IP address %s  <<<\r\n", pdnContextId, ipAddress ) );
+        ( void ) xEventGroupSetBits( pdnEventGroup, CELLULAR_PDN_UP_EVENT_BIT );
+
+        /* The URC callback counts a deactivation before it clears the bit. If
+         * it counted one since the state was set, its clear may have come
+         * before the set above, so clear the bit again. The next run sets it. */
+        taskENTER_CRITICAL();
+        {
+            up = ( deactivations == pdnDeactivations );
+        }
+        taskEXIT_CRITICAL();
+
+        if( up == false )
+        {
+            ( void ) xEventGroupClearBits( pdnEventGroup, CELLULAR_PDN_UP_EVENT_BIT );
+        }
+    }
+    else if( active == false )
+    {
+        configPRINTF( ( ">>>  Cellular PDN %u activation failed, retry in %lu ms  <<<\r\n",
+                        pdnContextId, ( unsigned long ) pdnBackoffMs ) );
+        ( void ) Platform_WorkSubmitDelayed( &pdnActivateWork, pdnBackoffMs );
+
+        if( pdnBackoffMs < ( CELLULAR_PDN_BACKOFF_MAX_MS / 2UL ) )
+        {
+            pdnBackoffMs = pdnBackoffMs * 2UL;
+        }
+        else
+        {
+            pdnBackoffMs = CELLULAR_PDN_BACKOFF_MAX_MS;
+        }
+    }
+    else
+    {
+        /* Deactivated again, the next run is queued. */
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvPdnEventCallback( CellularUrcEvent_t urcEvent,
+                                 uint8_t contextId,
+                                 void * pCallbackContext )
+{
+    ( void ) pCallbackContext;
+
+    /* Called from the cellular library receive thread. Only queue the work. */
+    if( ( urcEvent == CELLULAR_URC_EVENT_PDN_DEACTIVATED ) && ( contextId == pdnContextId ) )
+    {
+        /* Counted before the bit is cleared, see prvActivateWork(). */
+        taskENTER_CRITICAL();
+        {
+            pdnDeactivations++;
+            pdnState = CELLULAR_PDN_STATE_ACTIVATING;
+        }
+        taskEXIT_CRITICAL();
+
+        ( void ) xEventGroupClearBits( pdnEventGroup, CELLULAR_PDN_UP_EVENT_BIT );
+
+        configPRINTF( ( ">>>  Cellular PDN %u deactivated by the network, reactivating  <<<\r\n", contextId ) );
+        ( void ) Platform_WorkSubmit( &pdnActivateWork );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+bool CellularPdn_Start( CellularHandle_t cellularHandle,
+                        uint8_t contextId )
+{
+    bool started = false;
+
+    if( pdnEventGroup == NULL )
+    {
+        pdnEventGroup = xEventGroupCreateStatic( &pdnEventGroupBuffer );
+        Platform_WorkInit( &pdnActivateWork, prvActivateWork, NULL );
+    }
+
+    pdnCellularHandle = cellularHandle;
+    pdnContextId = contextId;
+
+    if( Cellular_RegisterUrcPdnEventCallback( cellularHandle, prvPdnEventCallback, NULL ) != CELLULAR_SUCCESS )
+    {
+        configPRINTF( ( ">>>  Cellular_RegisterUrcPdnEventCallback failure  <<<\r\n" ) );
+    }
+    else if( pdnState == CELLULAR_PDN_STATE_UP )
+    {
+        started = true;
+    }
+    else
+    {
+        /* A new start skips the backoff of the previous attempts. */
+        pdnState = CELLULAR_PDN_STATE_ACTIVATING;
+        pdnBackoffMs = CELLULAR_PDN_BACKOFF_MIN_MS;
+        started = Platform_WorkSubmit( &pdnActivateWork );
+    }
+
+    return started;
+}
+
+/*-----------------------------------------------------------*/
+
+bool CellularPdn_WaitUp( uint32_t timeoutMs )
+{
+    EventBits_t eventBits = 0;
+
+    configASSERT( pdnEventGroup != NULL );
+
+    eventBits = xEventGroupWaitBits( pdnEventGroup, CELLULAR_PDN_UP_EVENT_BIT,
+                                     pdFALSE, pdFALSE, pdMS_TO_TICKS( timeoutMs ) );
+
+    return ( eventBits & CELLULAR_PDN_UP_EVENT_BIT ) != 0U;
+}
+
+/*-----------------------------------------------------------*/
+
+CellularPdnState_t CellularPdn_GetState( void )
+{
+    return pdnState;
+}
+
+/*-----------------------------------------------------------*/
+
+bool CellularPdn_GetIPAddress( char * pIpAddress,
+                               size_t ipAddressLength )
+{
+    bool copied = false;
+
+    if( ( pIpAddress != NULL ) && ( ipAddressLength > 0U ) )
+    {
+        taskENTER_CRITICAL();
+        {
+            if( pdnState == CELLULAR_PDN_STATE_UP )
+            {
+                ( void ) strncpy( pIpAddress, pdnIpAddress, ipAddressLength - 1U );
+                pIpAddress[ ipAddressLength - 1U ] = '\0';
+                copied = true;
+            }
+        }
+        taskEXIT_CRITICAL();
+    }
+
+    return copied;
+}
+
+/*-----------------------------------------------------------*/
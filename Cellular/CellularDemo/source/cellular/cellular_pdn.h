@@ -0,0 +1,71 @@
+/*
+ * cellular_pdn.h
+ *
+ *  Keeps the PDN context of the sockets active (cellular_pdn.c).
+ *
+ *  1NCE GmbH
+ */
+
+#ifndef __CELLULAR_PDN_H__
+#define __CELLULAR_PDN_H__
+
+#include "FreeRTOS.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "cellular_types.h"
+
+/**
+ * @brief States of the managed PDN context.
+ */
+typedef enum CellularPdnState
+{
+    CELLULAR_PDN_STATE_DOWN = 0,   /**< Not active, no activation queued. */
+    CELLULAR_PDN_STATE_ACTIVATING, /**< Activation queued or running, possibly after a backoff. */
+    CELLULAR_PDN_STATE_UP          /**< Active, the IP address is known. */
+} CellularPdnState_t;
+
+/**
+ * @brief Start managing a PDN context of a registered module.
+ *
+ * Queues the activation on the platform work pool and returns. From then on a
+ * deactivation of the context reported by the module re-activates it, with
+ * exponential backoff between failed attempts. Calling it again with the same
+ * context restarts a pending backoff.
+ *
+ * @param[in] cellularHandle: Handle returned by Cellular_Init().
+ * @param[in] contextId: PDN context to keep active, configured already.
+ *
+ * @return true if the activation is queued.
+ */
+bool CellularPdn_Start( CellularHandle_t cellularHandle,
+                        uint8_t contextId );
+
+/**
+ * @brief Wait until the managed context is active.
+ *
+ * @param[in] timeoutMs: Time to wait for.
+ *
+ * @return true if the context is active.
+ */
+bool CellularPdn_WaitUp( uint32_t timeoutMs );
+
+/**
+ * @brief Get the state of the managed context.
+ */
+CellularPdnState_t CellularPdn_GetState( void );
+
+/**
+ * @brief Copy the local IP address of the active context.
+ *
+ * @param[out] pIpAddress: Buffer for the NULL terminated address.
+ * @param[in] ipAddressLength: Size of the buffer.
+ *
+ * @return true if the context is active and the address was copied.
+ */
+bool CellularPdn_GetIPAddress( char * pIpAddress,
+                               size_t ipAddressLength );
+
+#endif /* __CELLULAR_PDN_H__ */
@@ -38,6 +38,12 @@ typedef QueueHandle_t SemaphoreHandle_t;
 //     void ( *threadRoutine )( void * ); /**< @brief Thread function to run. */
 // } threadInfo_t;
 
+/* Work item states. */
+#define PLATFORM_WORK_IDLE       ( 0U ) /* Not queued. */
+#define PLATFORM_WORK_READY      ( 1U ) /* In the ready list. */
+#define PLATFORM_WORK_DELAYED    ( 2U ) /* In the delayed list. */
+#define PLATFORM_WORK_RERUN      ( 3U ) /* Submitted while running; queued again when the run returns. */
+
 /*-----------------------------------------------------------*/
 
 /**
@@ -59,6 +65,42 @@ static void prvThreadRoutineWrapper( void * pArgument );
 static bool prIotMutexTimedLock( PlatformMutex_t * pMutex,
                                  TickType_t timeout );
 
+/**
+ * @brief Worker task of the work pool.
+ *
+ * @param[in] pvParameters Index of the worker.
+ */
+static void prvWorkerTask( void * pvParameters );
+
+/**
+ * @brief Append a work item to the ready list. Called in a critical section.
+ */
+static void prvPushReady( PlatformWork_t * pWork );
+
+/**
+ * @brief Unlink a work item from the list it is queued in. Called in a
+ * critical section.
+ */
+static void prvUnlink( PlatformWork_t * pWork );
+
+/**
+ * @brief Move the delayed items that are due to the ready list and return the
+ * ticks until the next one is due. Called in a critical section.
+ */
+static TickType_t prvPromoteDueWork( void );
+
+/*-----------------------------------------------------------*/
+
+/* Work pool state, protected by critical sections. */
+static StaticTask_t xWorkerTcbs[ PLATFORM_WORKPOOL_WORKERS ];
+static StackType_t xWorkerStacks[ PLATFORM_WORKPOOL_WORKERS ][ PLATFORM_WORKPOOL_STACK_SIZE ];
+static StaticSemaphore_t xWorkSignalBuffer;
+static SemaphoreHandle_t xWorkSignal = NULL;
+static PlatformWork_t * pReadyHead = NULL;
+static PlatformWork_t * pReadyTail = NULL;
+static PlatformWork_t * pDelayedHead = NULL;
+static PlatformWork_t * pRunningWork[ PLATFORM_WORKPOOL_WORKERS ];
+
 /*-----------------------------------------------------------*/
 
 static void prvThreadRoutineWrapper( void * pArgument )
@@ -74,6 +116,152 @@ static void prvThreadRoutineWrapper( void * pArgument )
 
 /*-----------------------------------------------------------*/
 
+static void prvPushReady( PlatformWork_t * pWork )
+{
+    pWork->pNext = NULL;
+    pWork->state = PLATFORM_WORK_READY;
+
+    if( pReadyTail == NULL )
+    {
+        pReadyHead = pWork;
+    }
+    else
+    {
+        pReadyTail->pNext = pWork;
+    }
+
+    pReadyTail = pWork;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvUnlink( PlatformWork_t * pWork )
+{
+    PlatformWork_t ** ppLink = ( pWork->state == PLATFORM_WORK_READY ) ? &pReadyHead : &pDelayedHead;
+    PlatformWork_t * pPrevious = NULL;
+
+    while( ( *ppLink != NULL ) && ( *ppLink != pWork ) )
+    {
+        pPrevious = *ppLink;
+        ppLink = &( *ppLink )->pNext;
+    }
+
+    if( *ppLink == pWork )
+    {
+        *ppLink = pWork->pNext;
+
+        if( pWork->state == PLATFORM_WORK_READY )
+        {
+            if( pReadyTail == pWork )
+            {
+                pReadyTail = pPrevious;
+            }
+        }
+    }
+
+    pWork->pNext = NULL;
+    pWork->state = PLATFORM_WORK_IDLE;
+}
+
+/*-----------------------------------------------------------*/
+
+static TickType_t prvPromoteDueWork( void )
+{
+    TickType_t xNow = xTaskGetTickCount();
+    TickType_t xWait = portMAX_DELAY;
+    PlatformWork_t * pWork = NULL;
+
+    /* The delayed list is sorted by due time. */
+    while( pDelayedHead != NULL )
+    {
+        pWork = pDelayedHead;
+
+        if( ( TickType_t ) ( xNow - pWork->xDueTime ) < ( portMAX_DELAY / 2U ) )
+        {
+            pDelayedHead = pWork->pNext;
+            prvPushReady( pWork );
+        }
+        else
+        {
+            xWait = pWork->xDueTime - xNow;
+            break;
+        }
+    }
+
+    return xWait;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvWorkerTask( void * pvParameters )
+{
+    PlatformWork_t * pWork = NULL;
+    TickType_t xWait = portMAX_DELAY;
+    TaskHandle_t xSelf = xTaskGetCurrentTaskHandle();
+    UBaseType_t uxWorker = ( UBaseType_t ) ( uintptr_t ) pvParameters;
+
+    for( ; ; )
+    {
+        taskENTER_CRITICAL();
+        {
+            xWait = prvPromoteDueWork();
+            pWork = pReadyHead;
+
+            while( pWork != NULL )
+            {
+                pReadyHead = pWork->pNext;
+
+                if( pReadyHead == NULL )
+                {
+                    pReadyTail = NULL;
+                }
+
+                if( pWork->xRunner == NULL )
+                {
+                    pWork->pNext = NULL;
+                    pWork->state = PLATFORM_WORK_IDLE;
+                    pWork->xRunner = xSelf;
+                    pRunningWork[ uxWorker ] = pWork;
+                    break;
+                }
+
+                /* Running on another worker; that worker queues it again. */
+                pWork->pNext = NULL;
+                pWork->state = PLATFORM_WORK_RERUN;
+                pWork = pReadyHead;
+            }
+        }
+        taskEXIT_CRITICAL();
+
+        if( pWork == NULL )
+        {
+            ( void ) xSemaphoreTake( xWorkSignal, xWait );
+        }
+        else
+        {
+            pWork->workRoutine( pWork->pArgument );
+
+            taskENTER_CRITICAL();
+            {
+                /* The routine may have cancelled, and freed, its own item. */
+                if( pRunningWork[ uxWorker ] == pWork )
+                {
+                    pRunningWork[ uxWorker ] = NULL;
+                    pWork->xRunner = NULL;
+
+                    if( pWork->state == PLATFORM_WORK_RERUN )
+                    {
+                        prvPushReady( pWork );
+                    }
+                }
+            }
+            taskEXIT_CRITICAL();
+        }
+    }
+}
+
+/*-----------------------------------------------------------*/
+
 static bool prIotMutexTimedLock( PlatformMutex_t * pMutex,
                                  TickType_t timeout )
 {
@@ -98,6 +286,202 @@ static bool prIotMutexTimedLock( PlatformMutex_t * pMutex,
 
 /*-----------------------------------------------------------*/
 
+bool Platform_WorkPoolInit( void )
+{
+    bool status = true;
+    UBaseType_t uxWorker = 0;
+
+    configASSERT( xWorkSignal == NULL );
+
+    /* Every submit gives the signal once; workers recheck the queues on each
+     * take, so a saturated count only costs spurious wake ups. */
+    xWorkSignal = xSemaphoreCreateCountingStatic( 0xFFU, 0U, &xWorkSignalBuffer );
+
+    for( uxWorker = 0; uxWorker < PLATFORM_WORKPOOL_WORKERS; uxWorker++ )
+    {
+        if( xTaskCreateStatic( prvWorkerTask,
+                               "Worker",
+                               PLATFORM_WORKPOOL_STACK_SIZE,
+                               ( void * ) ( uintptr_t ) uxWorker,
+                               PLATFORM_WORKPOOL_PRIORITY,
+                               xWorkerStacks[ uxWorker ],
+                               &xWorkerTcbs[ uxWorker ] ) == NULL )
+        {
+            status = false;
+            break;
+        }
+    }
+
+    return status;
+}
+
+/*-----------------------------------------------------------*/
+
+void Platform_WorkInit( PlatformWork_t * pWork,
+                        void ( * workRoutine )( void * ),
+                        void * pArgument )
+{
+    configASSERT( ( pWork != NULL ) && ( workRoutine != NULL ) );
+
+    pWork->workRoutine = workRoutine;
+    pWork->pArgument = pArgument;
+    pWork->pNext = NULL;
+    pWork->xDueTime = 0;
+    pWork->xRunner = NULL;
+    pWork->state = PLATFORM_WORK_IDLE;
+}
+
+/*-----------------------------------------------------------*/
+
+bool Platform_WorkSubmit( PlatformWork_t * pWork )
+{
+    bool signal = false;
+
+    configASSERT( ( pWork != NULL ) && ( xWorkSignal != NULL ) );
+
+    taskENTER_CRITICAL();
+    {
+        if( pWork->state == PLATFORM_WORK_DELAYED )
+        {
+            prvUnlink( pWork );
+        }
+
+        if( pWork->state == PLATFORM_WORK_IDLE )
+        {
+            if( pWork->xRunner != NULL )
+            {
+                pWork->state = PLATFORM_WORK_RERUN;
+            }
+            else
+            {
+                prvPushReady( pWork );
+                signal = true;
+            }
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    if( signal == true )
+    {
+        ( void ) xSemaphoreGive( xWorkSignal );
+    }
+
+    return true;
+}
+
+/*-----------------------------------------------------------*/
+
+bool Platform_WorkSubmitDelayed( PlatformWork_t * pWork,
+                                 uint32_t delayMs )
+{
+    PlatformWork_t ** ppLink = &pDelayedHead;
+    bool signal = false;
+
+    configASSERT( ( pWork != NULL ) && ( xWorkSignal != NULL ) );
+
+    if( delayMs == 0U )
+    {
+        return Platform_WorkSubmit( pWork );
+    }
+
+    taskENTER_CRITICAL();
+    {
+        if( pWork->state == PLATFORM_WORK_DELAYED )
+        {
+            prvUnlink( pWork );
+        }
+
+        if( pWork->state == PLATFORM_WORK_IDLE )
+        {
+            pWork->state = PLATFORM_WORK_DELAYED;
+            pWork->xDueTime = xTaskGetTickCount() + pdMS_TO_TICKS( delayMs );
+
+            /* Keep the list sorted by due time. */
+            while( ( *ppLink != NULL ) &&
+                   ( ( TickType_t ) ( pWork->xDueTime - ( *ppLink )->xDueTime ) < ( portMAX_DELAY / 2U ) ) )
+            {
+                ppLink = &( *ppLink )->pNext;
+            }
+
+            pWork->pNext = *ppLink;
+            *ppLink = pWork;
+
+            /* A new earliest item shortens the wait of the workers. */
+            signal = ( pDelayedHead == pWork );
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    if( signal == true )
+    {
+        ( void ) xSemaphoreGive( xWorkSignal );
+    }
+
+    return true;
+}
+
+/*-----------------------------------------------------------*/
+
+bool Platform_WorkCancel( PlatformWork_t * pWork )
+{
+    bool cancelled = false;
+    bool running = false;
+    TaskHandle_t xSelf = xTaskGetCurrentTaskHandle();
+    UBaseType_t uxWorker = 0;
+
+    configASSERT( pWork != NULL );
+
+    taskENTER_CRITICAL();
+    {
+        if( ( pWork->state == PLATFORM_WORK_READY ) || ( pWork->state == PLATFORM_WORK_DELAYED ) )
+        {
+            prvUnlink( pWork );
+            cancelled = true;
+        }
+        else if( pWork->state == PLATFORM_WORK_RERUN )
+        {
+            pWork->state = PLATFORM_WORK_IDLE;
+            cancelled = true;
+        }
+        else
+        {
+            /* Not queued. */
+        }
+
+        running = ( pWork->xRunner != NULL ) && ( pWork->xRunner != xSelf );
+
+        /* Cancelled by its own routine: release it now so the worker does
+         * not touch it after the routine returns. */
+        if( pWork->xRunner == xSelf )
+        {
+            for( uxWorker = 0; uxWorker < PLATFORM_WORKPOOL_WORKERS; uxWorker++ )
+            {
+                if( pRunningWork[ uxWorker ] == pWork )
+                {
+                    pRunningWork[ uxWorker ] = NULL;
+                }
+            }
+
+            pWork->xRunner = NULL;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    /* The item may be freed by the caller once this returns. */
+    while( running == true )
+    {
+        vTaskDelay( 1 );
+
+        taskENTER_CRITICAL();
+        running = ( pWork->xRunner != NULL );
+        taskEXIT_CRITICAL();
+    }
+
+    return cancelled;
+}
+
+/*-----------------------------------------------------------*/
+
 bool Platform_CreateDetachedThread( void ( *threadRoutine )( void * ),
                                     void * pArgument,
                                     int32_t priority,
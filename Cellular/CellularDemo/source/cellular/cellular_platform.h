@@ -27,6 +27,7 @@
 #define __CELLULAR_PLATFORM_H__
 
 #include "FreeRTOS.h"
+#include "task.h"
 #include "queue.h"
 #include "semphr.h"
 #include "event_groups.h"
@@ -81,6 +82,83 @@ bool Platform_CreateDetachedThread( void ( * threadRoutine )( void * ),
 
 /*-----------------------------------------------------------*/
 
+/**
+ * @brief Platform work pool.
+ *
+ * A fixed number of worker tasks with static stacks that run work items from a
+ * shared queue. Work items are owned by the caller, so submitting work never
+ * allocates memory or creates a task. Platform_CreateDetachedThread() still
+ * creates a task: its routine, the pktio reader, runs as long as the modem is
+ * open and would take a worker away from the socket callbacks.
+ *
+ * A work item runs on one worker at a time. Submitting an item that is already
+ * pending does nothing, so events that arrive faster than they are handled are
+ * coalesced into one run.
+ *
+ * PLATFORM_WORKPOOL_WORKERS, PLATFORM_WORKPOOL_STACK_SIZE (in words) and
+ * PLATFORM_WORKPOOL_PRIORITY define the workers.
+ */
+
+#ifndef PLATFORM_WORKPOOL_WORKERS
+    #define PLATFORM_WORKPOOL_WORKERS       ( 2U )
+#endif
+#ifndef PLATFORM_WORKPOOL_STACK_SIZE
+    #define PLATFORM_WORKPOOL_STACK_SIZE    PLATFORM_THREAD_DEFAULT_STACK_SIZE
+#endif
+#ifndef PLATFORM_WORKPOOL_PRIORITY
+    #define PLATFORM_WORKPOOL_PRIORITY      PLATFORM_THREAD_DEFAULT_PRIORITY
+#endif
+
+typedef struct PlatformWork
+{
+    void ( * workRoutine )( void * pArgument ); /**< Function run by a worker. */
+    void * pArgument;                           /**< Argument of workRoutine. */
+
+    /* Private to the work pool. */
+    struct PlatformWork * pNext; /**< Next item in the ready or delayed list. */
+    TickType_t xDueTime;         /**< Tick count at which a delayed item becomes ready. */
+    TaskHandle_t xRunner;        /**< Worker running the item, NULL if not running. */
+    uint8_t state;               /**< Where the item is queued. */
+} PlatformWork_t;
+
+/**
+ * @brief Create the workers. Call once before the other Platform_Work functions.
+ */
+bool Platform_WorkPoolInit( void );
+
+/**
+ * @brief Set the routine and argument of a work item that is not queued.
+ */
+void Platform_WorkInit( PlatformWork_t * pWork,
+                        void ( * workRoutine )( void * ),
+                        void * pArgument );
+
+/**
+ * @brief Queue a work item to run as soon as a worker is free.
+ *
+ * A delayed item is moved to the ready queue.
+ */
+bool Platform_WorkSubmit( PlatformWork_t * pWork );
+
+/**
+ * @brief Queue a work item to run after delayMs.
+ *
+ * A delayed item is rescheduled; an item that is ready to run stays ready.
+ */
+bool Platform_WorkSubmitDelayed( PlatformWork_t * pWork,
+                                 uint32_t delayMs );
+
+/**
+ * @brief Remove a work item from the queues.
+ *
+ * If the item is running on another task, wait until that run returns.
+ *
+ * @return true if the item was queued and will not run.
+ */
+bool Platform_WorkCancel( PlatformWork_t * pWork );
+
+/*-----------------------------------------------------------*/
+
 /**
  * @brief Cellular library platform mutex APIs.
  *
@@ -0,0 +1,422 @@
+/*
+ * comm_if_posix.c
+ *
+ *  Cellular communication interface for the POSIX host build. The BG96 UART
+ *  is replaced by a TCP connection to the modem simulator in Tools/bg96_sim.py.
+ *
+ *  1NCE GmbH
+ */
+
+/* The config header is always included first. */
+#include "iot_config.h"
+
+/* Standard includes. */
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <poll.h>
+#include <netdb.h>
+#include <sys/socket.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Cellular includes. */
+#include "cellular_config.h"
+#include "cellular_config_defaults.h"
+#include "cellular_comm_interface.h"
+
+/* Modem traffic keeps the MCU out of STOP 2. */
+#include "low_power.h"
+
+#if ( IOT_METRICS_CELLULAR_ENABLED == 1 )
+    #include "platform/iot_metrics.h"
+#endif
+
+/* Configure logs for the functions in this file, in place of the cellular
+ * library settings from cellular_config.h. */
+#undef LIBRARY_LOG_LEVEL
+#undef LIBRARY_LOG_NAME
+
+#ifdef IOT_LOG_LEVEL_GLOBAL
+    #define LIBRARY_LOG_LEVEL    IOT_LOG_LEVEL_GLOBAL
+#else
+    #define LIBRARY_LOG_LEVEL    IOT_LOG_NONE
+#endif
+
+#define LIBRARY_LOG_NAME         ( "COMM_IF_POSIX" )
+#include "iot_logging_setup.h"
+
+/*-----------------------------------------------------------*/
+
+/* Environment variables selecting the simulator endpoint. */
+#define COMM_IF_POSIX_HOST_ENV        "BG96_SIM_HOST"
+#define COMM_IF_POSIX_PORT_ENV        "BG96_SIM_PORT"
+#define COMM_IF_POSIX_DEFAULT_HOST    "127.0.0.1"
+#define COMM_IF_POSIX_DEFAULT_PORT    "5555"
+
+/* The socket is polled, blocking system calls would stall the scheduler. */
+#define COMM_IF_POSIX_POLL_INTERVAL_MS    ( 2UL )
+#define COMM_IF_POSIX_RX_TASK_STACK       ( configMINIMAL_STACK_SIZE * 2 )
+#define COMM_IF_POSIX_RX_TASK_PRIORITY    ( configMAX_PRIORITIES - 1 )
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief A context of the communication interface.
+ */
+typedef struct CellularCommInterfaceContextStruct
+{
+    int socketFd;                                   /**< Connection to the modem simulator. */
+    TaskHandle_t rxTask;                            /**< Task notifying the library of received data. */
+    CellularCommInterfaceReceiveCallback_t pRecvCB; /**< Callback function of notify RX data. */
+    void * pUserData;                               /**< Userdata to be provided in the callback. */
+    volatile uint8_t rxReadingFlag;                 /**< Flag for whether the receiver is currently reading the socket. */
+    volatile bool ifOpen;                           /**< Communicate interface open status. */
+} CellularCommInterfaceContext;
+
+/*-----------------------------------------------------------*/
+
+static CellularCommInterfaceError_t prvCellularOpen( CellularCommInterfaceReceiveCallback_t receiveCallback,
+                                                     void * pUserData,
+                                                     CellularCommInterfaceHandle_t * pCommInterfaceHandle );
+static CellularCommInterfaceError_t prvCellularClose( CellularCommInterfaceHandle_t commInterfaceHandle );
+static CellularCommInterfaceError_t prvCellularReceive( CellularCommInterfaceHandle_t commInterfaceHandle,
+                                                        uint8_t * pBuffer,
+                                                        uint32_t bufferLength,
+                                                        uint32_t timeoutMilliseconds,
+                                                        uint32_t * pDataReceivedLength );
+static CellularCommInterfaceError_t prvCellularSend( CellularCommInterfaceHandle_t commInterfaceHandle,
+                                                     const uint8_t * pData,
+                                                     uint32_t dataLength,
+                                                     uint32_t timeoutMilliseconds,
+                                                     uint32_t * pDataSentLength );
+
+/*-----------------------------------------------------------*/
+
+/* Static Linked communication interface. */
+/* This variable is defined as communication interface. */
+CellularCommInterface_t CellularCommInterface =
+{
+    .open  = prvCellularOpen,
+    .send  = prvCellularSend,
+    .recv  = prvCellularReceive,
+    .close = prvCellularClose
+};
+
+/*-----------------------------------------------------------*/
+
+static CellularCommInterfaceContext _iotCommIntfCtx = { .socketFd = -1 };
+
+/*-----------------------------------------------------------*/
+
+/* Non-blocking readability check of the simulator connection. */
+static bool prvSocketReadable( int socketFd )
+{
+    struct pollfd pollFd = { 0 };
+
+    pollFd.fd = socketFd;
+    pollFd.events = POLLIN;
+
+    return ( poll( &pollFd, 1, 0 ) > 0 ) && ( ( pollFd.revents & ( POLLIN | POLLHUP | POLLERR ) ) != 0 );
+}
+
+/*-----------------------------------------------------------*/
+
+/* Stands in for the UART RX interrupt of comm_if_st.c. */
+static void prvCommRxTask( void * pvParameters )
+{
+    CellularCommInterfaceContext * pIotCommIntfCtx = ( CellularCommInterfaceContext * ) pvParameters;
+
+    for( ; ; )
+    {
+        if( ( pIotCommIntfCtx->ifOpen == true ) &&
+            ( pIotCommIntfCtx->rxReadingFlag == 0U ) &&
+            ( pIotCommIntfCtx->pRecvCB != NULL ) &&
+            ( prvSocketReadable( pIotCommIntfCtx->socketFd ) == true ) )
+        {
+            ( void ) pIotCommIntfCtx->pRecvCB( pIotCommIntfCtx->pUserData,
+                                               ( CellularCommInterfaceHandle_t ) pIotCommIntfCtx );
+        }
+
+        vTaskDelay( pdMS_TO_TICKS( COMM_IF_POSIX_POLL_INTERVAL_MS ) );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static int prvConnectSimulator( void )
+{
+    const char * pHost = getenv( COMM_IF_POSIX_HOST_ENV );
+    const char * pPort = getenv( COMM_IF_POSIX_PORT_ENV );
+    struct addrinfo hints = { 0 };
+    struct addrinfo * pResult = NULL;
+    struct addrinfo * pAddr = NULL;
+    int socketFd = -1;
+
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+
+    if( pHost == NULL )
+    {
+        pHost = COMM_IF_POSIX_DEFAULT_HOST;
+    }
+
+    if( pPort == NULL )
+    {
+        pPort = COMM_IF_POSIX_DEFAULT_PORT;
+    }
+
+    if( getaddrinfo( pHost, pPort, &hints, &pResult ) == 0 )
+    {
+        for( pAddr = pResult; ( pAddr != NULL ) && ( socketFd < 0 ); pAddr = pAddr->ai_next )
+        {
+            socketFd = socket( pAddr->ai_family, pAddr->ai_socktype, pAddr->ai_protocol );
+
+            if( ( socketFd >= 0 ) && ( connect( socketFd, pAddr->ai_addr, pAddr->ai_addrlen ) != 0 ) )
+            {
+                ( void ) close( socketFd );
+                socketFd = -1;
+            }
+        }
+
+        freeaddrinfo( pResult );
+    }
+
+    if( socketFd < 0 )
+    {
+        IotLogError( "Cannot reach the modem simulator at %s:%s", pHost, pPort );
+    }
+    else
+    {
+        IotLogInfo( "Connected to the modem simulator at %s:%s", pHost, pPort );
+    }
+
+    return socketFd;
+}
+
+/*-----------------------------------------------------------*/
+
+static CellularCommInterfaceError_t prvCellularOpen( CellularCommInterfaceReceiveCallback_t receiveCallback,
+                                                     void * pUserData,
+                                                     CellularCommInterfaceHandle_t * pCommInterfaceHandle )
+{
+    CellularCommInterfaceError_t ret = IOT_COMM_INTERFACE_SUCCESS;
+    CellularCommInterfaceContext * pIotCommIntfCtx = &_iotCommIntfCtx;
+
+    /* check input parameter. */
+    if( ( pCommInterfaceHandle == NULL ) || ( receiveCallback == NULL ) )
+    {
+        ret = IOT_COMM_INTERFACE_BAD_PARAMETER;
+    }
+    else if( pIotCommIntfCtx->ifOpen == true )
+    {
+        ret = IOT_COMM_INTERFACE_FAILURE;
+    }
+    else
+    {
+        pIotCommIntfCtx->socketFd = prvConnectSimulator();
+
+        if( pIotCommIntfCtx->socketFd < 0 )
+        {
+            ret = IOT_COMM_INTERFACE_DRIVER_ERROR;
+        }
+    }
+
+    /* The RX task outlives close so that the interface can be reopened. */
+    if( ( ret == IOT_COMM_INTERFACE_SUCCESS ) && ( pIotCommIntfCtx->rxTask == NULL ) )
+    {
+        if( xTaskCreate( prvCommRxTask, "CommRx", COMM_IF_POSIX_RX_TASK_STACK, pIotCommIntfCtx,
+                         COMM_IF_POSIX_RX_TASK_PRIORITY, &pIotCommIntfCtx->rxTask ) != pdPASS )
+        {
+            IotLogError( "Comm RX task create failed" );
+            ( void ) close( pIotCommIntfCtx->socketFd );
+            pIotCommIntfCtx->socketFd = -1;
+            ret = IOT_COMM_INTERFACE_NO_MEMORY;
+        }
+    }
+
+    /* setup callback function and userdata. */
+    if( ret == IOT_COMM_INTERFACE_SUCCESS )
+    {
+        pIotCommIntfCtx->pRecvCB = receiveCallback;
+        pIotCommIntfCtx->pUserData = pUserData;
+        pIotCommIntfCtx->rxReadingFlag = 0U;
+        *pCommInterfaceHandle = ( CellularCommInterfaceHandle_t ) pIotCommIntfCtx;
+        pIotCommIntfCtx->ifOpen = true;
+    }
+
+    return ret;
+}
+
+/*-----------------------------------------------------------*/
+
+static CellularCommInterfaceError_t prvCellularClose( CellularCommInterfaceHandle_t commInterfaceHandle )
+{
+    CellularCommInterfaceError_t ret = IOT_COMM_INTERFACE_BAD_PARAMETER;
+    CellularCommInterfaceContext * pIotCommIntfCtx = ( CellularCommInterfaceContext * ) commInterfaceHandle;
+
+    if( pIotCommIntfCtx == NULL )
+    {
+        ret = IOT_COMM_INTERFACE_BAD_PARAMETER;
+    }
+    else if( pIotCommIntfCtx->ifOpen == false )
+    {
+        ret = IOT_COMM_INTERFACE_FAILURE;
+    }
+    else
+    {
+        pIotCommIntfCtx->ifOpen = false;
+        pIotCommIntfCtx->pRecvCB = NULL;
+        pIotCommIntfCtx->pUserData = NULL;
+
+        ( void ) close( pIotCommIntfCtx->socketFd );
+        pIotCommIntfCtx->socketFd = -1;
+
+        ret = IOT_COMM_INTERFACE_SUCCESS;
+    }
+
+    return ret;
+}
+
+/*-----------------------------------------------------------*/
+
+static CellularCommInterfaceError_t prvCellularSend( CellularCommInterfaceHandle_t commInterfaceHandle,
+                                                     const uint8_t * pData,
+                                                     uint32_t dataLength,
+                                                     uint32_t timeoutMilliseconds,
+                                                     uint32_t * pDataSentLength )
+{
+    CellularCommInterfaceError_t ret = IOT_COMM_INTERFACE_SUCCESS;
+    CellularCommInterfaceContext * pIotCommIntfCtx = ( CellularCommInterfaceContext * ) commInterfaceHandle;
+    TickType_t startTick = xTaskGetTickCount();
+    uint32_t sentLength = 0;
+    ssize_t result = 0;
+
+    if( ( pIotCommIntfCtx == NULL ) || ( pData == NULL ) || ( dataLength == 0 ) )
+    {
+        ret = IOT_COMM_INTERFACE_BAD_PARAMETER;
+    }
+    else if( pIotCommIntfCtx->ifOpen == false )
+    {
+        ret = IOT_COMM_INTERFACE_FAILURE;
+    }
+    else
+    {
+        while( ( sentLength < dataLength ) && ( ret == IOT_COMM_INTERFACE_SUCCESS ) )
+        {
+            result = send( pIotCommIntfCtx->socketFd, &pData[ sentLength ], dataLength - sentLength,
+                           MSG_DONTWAIT | MSG_NOSIGNAL );
+
+            if( result > 0 )
+            {
+                sentLength += ( uint32_t ) result;
+            }
+            else if( ( result < 0 ) && ( errno != EAGAIN ) && ( errno != EWOULDBLOCK ) && ( errno != EINTR ) )
+            {
+                IotLogError( "Send to the modem simulator failed, errno %d", errno );
+                ret = IOT_COMM_INTERFACE_DRIVER_ERROR;
+            }
+            else if( ( xTaskGetTickCount() - startTick ) >= pdMS_TO_TICKS( timeoutMilliseconds ) )
+            {
+                ret = IOT_COMM_INTERFACE_TIMEOUT;
+            }
+            else
+            {
+                vTaskDelay( pdMS_TO_TICKS( COMM_IF_POSIX_POLL_INTERVAL_MS ) );
+            }
+        }
+
+        if( pDataSentLength != NULL )
+        {
+            *pDataSentLength = sentLength;
+        }
+
+        #if ( IOT_METRICS_CELLULAR_ENABLED == 1 )
+            IotMetrics_CellularComm( 0U, sentLength, ( ret == IOT_COMM_INTERFACE_TIMEOUT ) );
+        #endif
+
+        vLowPowerNotifyModemActivity();
+    }
+
+    return ret;
+}
+
+/*-----------------------------------------------------------*/
+
+static CellularCommInterfaceError_t prvCellularReceive( CellularCommInterfaceHandle_t commInterfaceHandle,
+                                                        uint8_t * pBuffer,
+                                                        uint32_t bufferLength,
+                                                        uint32_t timeoutMilliseconds,
+                                                        uint32_t * pDataReceivedLength )
+{
+    CellularCommInterfaceError_t ret = IOT_COMM_INTERFACE_SUCCESS;
+    CellularCommInterfaceContext * pIotCommIntfCtx = ( CellularCommInterfaceContext * ) commInterfaceHandle;
+    TickType_t startTick = xTaskGetTickCount();
+    uint32_t rxCount = 0;
+    ssize_t result = 0;
+
+    if( ( pIotCommIntfCtx == NULL ) || ( pBuffer == NULL ) || ( bufferLength == 0 ) )
+    {
+        ret = IOT_COMM_INTERFACE_BAD_PARAMETER;
+    }
+    else if( pIotCommIntfCtx->ifOpen == false )
+    {
+        ret = IOT_COMM_INTERFACE_FAILURE;
+    }
+    else
+    {
+        /* Set this flag to inform the RX task to stop calling the callback function. */
+        pIotCommIntfCtx->rxReadingFlag = 1U;
+
+        /* Return what is available once the first bytes arrived, like the UART
+         * driver does after its inter-character gap. */
+        while( ( rxCount == 0U ) && ( ret == IOT_COMM_INTERFACE_SUCCESS ) )
+        {
+            result = recv( pIotCommIntfCtx->socketFd, pBuffer, bufferLength, MSG_DONTWAIT );
+
+            if( result > 0 )
+            {
+                rxCount = ( uint32_t ) result;
+            }
+            else if( result == 0 )
+            {
+                IotLogError( "Modem simulator closed the connection" );
+                ret = IOT_COMM_INTERFACE_DRIVER_ERROR;
+            }
+            else if( ( errno != EAGAIN ) && ( errno != EWOULDBLOCK ) && ( errno != EINTR ) )
+            {
+                ret = IOT_COMM_INTERFACE_DRIVER_ERROR;
+            }
+            else if( ( xTaskGetTickCount() - startTick ) >= pdMS_TO_TICKS( timeoutMilliseconds ) )
+            {
+                ret = IOT_COMM_INTERFACE_TIMEOUT;
+            }
+            else
+            {
+                vTaskDelay( pdMS_TO_TICKS( COMM_IF_POSIX_POLL_INTERVAL_MS ) );
+            }
+        }
+
+        pIotCommIntfCtx->rxReadingFlag = 0U;
+
+        if( pDataReceivedLength != NULL )
+        {
+            *pDataReceivedLength = rxCount;
+        }
+
+        #if ( IOT_METRICS_CELLULAR_ENABLED == 1 )
+            IotMetrics_CellularComm( rxCount, 0U, ( ret == IOT_COMM_INTERFACE_TIMEOUT ) );
+        #endif
+
+        if( rxCount > 0U )
+        {
+            vLowPowerNotifyModemActivity();
+        }
+    }
+
+    return ret;
+}
+
+/*-----------------------------------------------------------*/
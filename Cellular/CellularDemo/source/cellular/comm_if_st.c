@@ -40,6 +40,13 @@
 
 #include "stm32l4xx.h"
 
+/* Modem traffic keeps the MCU out of STOP 2. */
+#include "low_power.h"
+
+#if ( IOT_METRICS_CELLULAR_ENABLED == 1 )
+    #include "platform/iot_metrics.h"
+#endif
+
 /* Configure logs for the functions in this file. */
 #ifdef IOT_LOG_LEVEL_GLOBAL
     #define LIBRARY_LOG_LEVEL    IOT_LOG_LEVEL_GLOBAL
@@ -89,6 +96,9 @@ typedef struct CellularCommInterfaceContextStruct
     uint8_t fifoBuffer[ COMM_IF_FIFO_BUFFER_SIZE ]; /**< Buffer for ring buffer. */
     uint8_t rxFifoReadingFlag;                      /**< Flag for whether the receiver is currently reading the buffer. */
     bool ifOpen;                                    /**< Communicate interface open status. */
+    #if ( IOT_METRICS_CELLULAR_ENABLED == 1 )
+        uint32_t rxFifoHighWater;                   /**< Highest FIFO level since the reader last reported it. */
+    #endif
 } CellularCommInterfaceContext;
 
 /*-----------------------------------------------------------*/
@@ -134,6 +144,23 @@ static UART_HandleTypeDef _iotCommIntfPhy = { 0 };
 
 /*-----------------------------------------------------------*/
 
+#if ( IOT_METRICS_CELLULAR_ENABLED == 1 )
+
+/* Number of items waiting in the FIFO. Head and tail are byte offsets. */
+    static uint32_t prvFifoLevel( const IotFifo_t * pFifo )
+    {
+        uint32_t ulBytes = pFifo->ulLength * pFifo->ulItemSize;
+        uint32_t ulUsed = ( pFifo->ulHead >= pFifo->ulTail ) ?
+                          ( pFifo->ulHead - pFifo->ulTail ) :
+                          ( ulBytes - pFifo->ulTail + pFifo->ulHead );
+
+        return ( pFifo->ulItemSize > 0UL ) ? ( ulUsed / pFifo->ulItemSize ) : 0UL;
+    }
+
+/*-----------------------------------------------------------*/
+
+#endif /* if ( IOT_METRICS_CELLULAR_ENABLED == 1 ) */
+
 /* Override HAL_UART_MspInit() */
 /* void HAL_UART_MspInit( UART_HandleTypeDef * hUart ) */
 /* { */
@@ -186,10 +213,24 @@ void HAL_UART_RxCpltCallback( UART_HandleTypeDef * hUart )
     CellularCommInterfaceContext * pIotCommIntfCtx = &_iotCommIntfCtx;
     CellularCommInterfaceError_t retComm = IOT_COMM_INTERFACE_SUCCESS;
 
+    #if ( IOT_METRICS_CELLULAR_ENABLED == 1 )
+        uint32_t fifoLevel = 0;
+    #endif
+
     if( hUart != NULL )
     {
         if( IotFifo_Put( &pIotCommIntfCtx->rxFifo, &pIotCommIntfCtx->uartRxChar[ 0 ] ) == true )
         {
+            #if ( IOT_METRICS_CELLULAR_ENABLED == 1 )
+                /* Only track the level per byte, prvCellularReceive reports it. */
+                fifoLevel = prvFifoLevel( &pIotCommIntfCtx->rxFifo );
+
+                if( fifoLevel > pIotCommIntfCtx->rxFifoHighWater )
+                {
+                    pIotCommIntfCtx->rxFifoHighWater = fifoLevel;
+                }
+            #endif
+
             /* rxFifoReadingFlag indicate the reader is reading the FIFO in recv function.
              * Don't call the callback function until the reader finish read. */
             if( pIotCommIntfCtx->rxFifoReadingFlag == 0U )
@@ -568,6 +609,12 @@ static CellularCommInterfaceError_t prvCellularSend( CellularCommInterfaceHandle
                     *pDataSentLength = transferSize;
                 }
 
+                #if ( IOT_METRICS_CELLULAR_ENABLED == 1 )
+                    IotMetrics_CellularComm( 0U, transferSize, ( ret == IOT_COMM_INTERFACE_TIMEOUT ) );
+                #endif
+
+                vLowPowerNotifyModemActivity();
+
                 break;
             }
             else
@@ -619,6 +666,10 @@ static CellularCommInterfaceError_t prvCellularReceive( CellularCommInterfaceHan
     uint32_t remainTimeMs = timeoutMilliseconds;
     uint32_t startTimeMs = TICKS_TO_MS( xTaskGetTickCount() );
 
+    #if ( IOT_METRICS_CELLULAR_ENABLED == 1 )
+        uint32_t fifoHighWater = 0;
+    #endif
+
     if( ( pIotCommIntfCtx == NULL ) || ( pBuffer == NULL ) || ( bufferLength == 0 ) )
     {
         ret = IOT_COMM_INTERFACE_BAD_PARAMETER;
@@ -705,9 +756,20 @@ static CellularCommInterfaceError_t prvCellularReceive( CellularCommInterfaceHan
 
         *pDataReceivedLength = rxCount;
 
+        #if ( IOT_METRICS_CELLULAR_ENABLED == 1 )
+            taskENTER_CRITICAL();
+            fifoHighWater = pIotCommIntfCtx->rxFifoHighWater;
+            pIotCommIntfCtx->rxFifoHighWater = 0U;
+            taskEXIT_CRITICAL();
+
+            IotMetrics_CellularComm( rxCount, 0U, ( ret == IOT_COMM_INTERFACE_TIMEOUT ) );
+            IotMetrics_CellularFifoLevel( fifoHighWater );
+        #endif
+
         /* Return success if bytes received. Even if timeout or RX error. */
         if( rxCount > 0 )
         {
+            vLowPowerNotifyModemActivity();
             ret = IOT_COMM_INTERFACE_SUCCESS;
         }
     }
@@ -194,8 +194,9 @@ static const CellularGpioInitStruct_t _cellularGpioInitStruct[] = {
     {.Port = CELLULAR_PWR_EN_GPIO_Port,
      .Init = {CELLULAR_PWR_EN_Pin, GPIO_MODE_OUTPUT_PP, GPIO_NOPULL,
               GPIO_SPEED_FREQ_LOW, 0}},
+    /* The RI pulse of a URC wakes the MCU from STOP 2. */
     {.Port = CELLULAR_RI_GPIO_Port,
-     .Init = {CELLULAR_RI_Pin, GPIO_MODE_INPUT, GPIO_PULLDOWN,
+     .Init = {CELLULAR_RI_Pin, GPIO_MODE_IT_FALLING, GPIO_PULLDOWN,
               GPIO_SPEED_FREQ_HIGH, 0}},
     {.Port = CELLULAR_SIM_SELECT_0_GPIO_Port,
      .Init = {CELLULAR_SIM_SELECT_0_Pin, GPIO_MODE_OUTPUT_PP, GPIO_NOPULL,
@@ -310,6 +311,9 @@ static void prvDevicePinInit(void) {
                   (GPIO_InitTypeDef *)&pCellularGpioInitStruct->Init);
     pCellularGpioInitStruct++;
   }
+
+  /* EXTI2 is configured by MX_GPIO_Init(), but left disabled. */
+  HAL_NVIC_EnableIRQ(EXTI2_IRQn);
 }
 
 /*-----------------------------------------------------------*/
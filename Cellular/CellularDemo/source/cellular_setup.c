@@ -31,6 +31,7 @@
 /* FreeRTOS include. */
 #include <FreeRTOS.h>
 #include "task.h"
+#include "event_groups.h"
 
 #include <stdbool.h>
 #include <stdlib.h>
@@ -42,6 +43,13 @@
 #include "cellular_types.h"
 #include "cellular_api.h"
 #include "cellular_comm_interface.h"
+#include "cellular_bg96_api.h"
+
+/* PDN manager. */
+#include "cellular_pdn.h"
+
+/* Tickless idle policy. */
+#include "low_power.h"
 
 /*-----------------------------------------------------------*/
 
@@ -52,9 +60,14 @@
 #define CELLULAR_SIM_CARD_WAIT_INTERVAL_MS       ( 500UL )
 #define CELLULAR_MAX_SIM_RETRY                   ( 5U )
 
-#define CELLULAR_PDN_CONNECT_WAIT_INTERVAL_MS    ( 1000UL )
+/* Registration is reported by +CEREG/+CGREG URCs. The service status is only
+ * polled when no URC arrived for this long. */
+#define CELLULAR_REGISTRATION_POLL_FALLBACK_MS   ( 10000UL )
 
-#define CELLULAR_PDN_CONTEXT_NUM                 ( CELLULAR_PDN_CONTEXT_ID_MAX - CELLULAR_PDN_CONTEXT_ID_MIN + 1U )
+#define CELLULAR_REGISTRATION_EVENT_BIT          ( 0x01UL )
+
+/* Shortest e-I-DRX cycle, 5.12 s. */
+#define CELLULAR_EDRX_CYCLE_UNIT_MS              ( 5120UL )
 
 /*-----------------------------------------------------------*/
 
@@ -70,6 +83,148 @@ CellularHandle_t CellularHandle = NULL;
 /* User of secure sockets cellular should provide this variable. */
 uint8_t CellularSocketPdnContextId = CELLULAR_PDN_CONTEXT_ID;
 
+/* Set after the first setup attempt. Retries always rescan the network. */
+static bool setupAttempted = false;
+
+/* Signalled by the registration URC callback. Created once, reused by retries. */
+static EventGroupHandle_t registrationEventGroup = NULL;
+
+/*-----------------------------------------------------------*/
+
+static bool prvIsRegistered( const CellularServiceStatus_t * pServiceStatus )
+{
+    return ( pServiceStatus->psRegistrationStatus == REGISTRATION_STATUS_REGISTERED_HOME ) ||
+           ( pServiceStatus->psRegistrationStatus == REGISTRATION_STATUS_ROAMING_REGISTERED );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvNetworkRegistrationCallback( CellularUrcEvent_t urcEvent,
+                                            const CellularServiceStatus_t * pServiceStatus,
+                                            void * pCallbackContext )
+{
+    EventGroupHandle_t eventGroup = ( EventGroupHandle_t ) pCallbackContext;
+
+    /* Called from the cellular library receive thread. Only record the state. */
+    if( ( urcEvent == CELLULAR_URC_EVENT_NETWORK_PS_REGISTRATION ) && ( pServiceStatus != NULL ) )
+    {
+        if( prvIsRegistered( pServiceStatus ) == true )
+        {
+            ( void ) xEventGroupSetBits( eventGroup, CELLULAR_REGISTRATION_EVENT_BIT );
+        }
+        else
+        {
+            ( void ) xEventGroupClearBits( eventGroup, CELLULAR_REGISTRATION_EVENT_BIT );
+        }
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static CellularError_t prvWaitForRegistration( uint32_t timeoutMs )
+{
+    CellularError_t cellularStatus = CELLULAR_SUCCESS;
+    CellularServiceStatus_t serviceStatus = { 0 };
+    TickType_t startTicks = xTaskGetTickCount();
+    TickType_t elapsedTicks = 0;
+    TickType_t waitTicks = 0;
+    bool registered = false;
+
+    for( ; ; )
+    {
+        /* Query once up front, after every URC and after every fallback period. */
+        cellularStatus = Cellular_GetServiceStatus( CellularHandle, &serviceStatus );
+
+        if( ( cellularStatus == CELLULAR_SUCCESS ) && ( prvIsRegistered( &serviceStatus ) == true ) )
+        {
+            configPRINTF( ( ">>>  Cellular module registered  <<<\r\n" ) );
+            registered = true;
+            break;
+        }
+
+        configPRINTF( ( ">>>  Cellular GetServiceStatus %d, ps registration status %d  <<<\r\n",
+                        cellularStatus, serviceStatus.psRegistrationStatus ) );
+
+        elapsedTicks = xTaskGetTickCount() - startTicks;
+
+        if( elapsedTicks >= pdMS_TO_TICKS( timeoutMs ) )
+        {
+            break;
+        }
+
+        waitTicks = pdMS_TO_TICKS( timeoutMs ) - elapsedTicks;
+
+        if( waitTicks > pdMS_TO_TICKS( CELLULAR_REGISTRATION_POLL_FALLBACK_MS ) )
+        {
+            waitTicks = pdMS_TO_TICKS( CELLULAR_REGISTRATION_POLL_FALLBACK_MS );
+        }
+
+        /* Sleep until a registration URC arrives. The modem and UART stay idle. */
+        ( void ) xEventGroupWaitBits( registrationEventGroup, CELLULAR_REGISTRATION_EVENT_BIT,
+                                      pdTRUE, pdFALSE, waitTicks );
+    }
+
+    if( registered == false )
+    {
+        configPRINTF( ( ">>>  Cellular module can't be registered  <<<\r\n" ) );
+        cellularStatus = CELLULAR_TIMEOUT;
+    }
+
+    return cellularStatus;
+}
+
+/*-----------------------------------------------------------*/
+
+static uint32_t prvEdrxCycleMs( uint8_t edrxValue )
+{
+    /* E-UTRAN cycle lengths of 3GPP TS 27.007, in units of 5.12 s. */
+    static const uint16_t cycleUnits[ 16 ] =
+    {
+        1U, 2U, 4U, 8U, 12U, 16U, 20U, 24U, 28U, 32U, 64U, 128U, 256U, 512U, 1024U, 2048U
+    };
+
+    return CELLULAR_EDRX_CYCLE_UNIT_MS * cycleUnits[ edrxValue & 0x0FU ];
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvPublishPowerSavingTimers( void )
+{
+    CellularPsmSettings_t psmSettings = { 0 };
+    CellularEidrxSettingsList_t eidrxSettingsList = { 0 };
+    uint32_t tauSeconds = 0U;
+    uint32_t activeSeconds = 0U;
+    uint32_t edrxCycleMs = 0U;
+    uint8_t i = 0U;
+
+    /* AT+QPSMS? of the BG96 reports both timers in seconds. */
+    if( ( Cellular_GetPsmSettings( CellularHandle, &psmSettings ) == CELLULAR_SUCCESS ) &&
+        ( psmSettings.mode == 1U ) )
+    {
+        tauSeconds = psmSettings.periodicTauValue;
+        activeSeconds = psmSettings.activeTimeValue;
+    }
+
+    if( Cellular_GetEidrxSettings( CellularHandle, &eidrxSettingsList ) == CELLULAR_SUCCESS )
+    {
+        /* AT+CEDRXS? lists the RATs eDRX is requested for, Cat M1 and NB1 are
+         * the E-UTRAN ones. */
+        for( i = 0U; ( i < eidrxSettingsList.count ) && ( i < CELLULAR_EDRX_LIST_MAX_SIZE ); i++ )
+        {
+            if( ( eidrxSettingsList.eidrxList[ i ].rat == 4U ) || ( eidrxSettingsList.eidrxList[ i ].rat == 5U ) )
+            {
+                edrxCycleMs = prvEdrxCycleMs( eidrxSettingsList.eidrxList[ i ].requestedEdrxValue );
+                break;
+            }
+        }
+    }
+
+    configPRINTF( ( ">>>  PSM TAU %lu s, active time %lu s, eDRX cycle %lu ms  <<<\r\n",
+                    ( unsigned long ) tauSeconds, ( unsigned long ) activeSeconds, ( unsigned long ) edrxCycleMs ) );
+
+    vLowPowerSetModemTimers( tauSeconds, activeSeconds );
+}
+
 /*-----------------------------------------------------------*/
 
 bool setupCellular( void )
@@ -77,20 +232,17 @@ bool setupCellular( void )
     bool cellularRet = true;
     CellularError_t cellularStatus = CELLULAR_SUCCESS;
     CellularSimCardStatus_t simStatus = { 0 };
-    CellularServiceStatus_t serviceStatus = { 0 };
     CellularCommInterface_t * pCommIntf = &CellularCommInterface;
     uint8_t tries = 0;
     CellularPdnConfig_t pdnConfig = { CELLULAR_PDN_CONTEXT_IPV4, CELLULAR_PDN_AUTH_NONE, CELLULAR_APN, "", "" };
-    CellularPdnStatus_t PdnStatusBuffers[ CELLULAR_PDN_CONTEXT_NUM ] = { 0 };
-    char localIP[ CELLULAR_IP_ADDRESS_MAX_SIZE ] = { '\0' };
-    uint32_t timeoutCountLimit = ( CELLULAR_PDN_CONNECT_TIMEOUT / CELLULAR_PDN_CONNECT_WAIT_INTERVAL_MS ) + 1U;
-    uint32_t timeoutCount = 0;
-    uint8_t NumStatus = 0;
-    bool pdnStatus = false;
-    uint32_t i = 0U;
+    char localIP[ CELLULAR_IP_ADDRESS_MAX_SIZE + 1U ] = { '\0' };
+    bool rescanRequired = true;
 
-    /* Initialize Cellular Comm Interface. */
-    cellularStatus = Cellular_Init( &CellularHandle, pCommIntf );
+    /* Initialize Cellular Comm Interface. Retries reuse the open interface. */
+    if( CellularHandle == NULL )
+    {
+        cellularStatus = Cellular_Init( &CellularHandle, pCommIntf );
+    }
 
     if( cellularStatus != CELLULAR_SUCCESS )
     {
@@ -137,108 +289,100 @@ bool setupCellular( void )
         }
     }
 
-    /* Rescan network. */
+    /* Follow the registration URCs from before the rescan on. */
     if( cellularStatus == CELLULAR_SUCCESS )
     {
-        cellularStatus = Cellular_RfOff( CellularHandle );
-
-        if( cellularStatus != CELLULAR_SUCCESS )
+        if( registrationEventGroup == NULL )
         {
-            configPRINTF( ( ">>>  Cellular_RfOff failure %d  <<<\r\n", cellularStatus ) );
+            registrationEventGroup = xEventGroupCreate();
         }
-    }
-
-    if( cellularStatus == CELLULAR_SUCCESS )
-    {
-        cellularStatus = Cellular_RfOn( CellularHandle );
 
-        if( cellularStatus != CELLULAR_SUCCESS )
+        if( registrationEventGroup == NULL )
         {
-            configPRINTF( ( ">>>  Cellular_RfOn failure %d  <<<\r\n", cellularStatus ) );
+            configPRINTF( ( ">>>  Cellular registration event group creation failure  <<<\r\n" ) );
+            cellularStatus = CELLULAR_NO_MEMORY;
         }
-    }
-
-    /* Get service status. */
-    if( cellularStatus == CELLULAR_SUCCESS )
-    {
-        while( timeoutCount < timeoutCountLimit )
+        else
         {
-            cellularStatus = Cellular_GetServiceStatus( CellularHandle, &serviceStatus );
+            ( void ) xEventGroupClearBits( registrationEventGroup, CELLULAR_REGISTRATION_EVENT_BIT );
+            cellularStatus = Cellular_RegisterUrcNetworkRegistrationEventCallback( CellularHandle,
+                                                                                   prvNetworkRegistrationCallback,
+                                                                                   registrationEventGroup );
 
-            if( ( cellularStatus == CELLULAR_SUCCESS ) &&
-                ( ( serviceStatus.psRegistrationStatus == REGISTRATION_STATUS_REGISTERED_HOME ) ||
-                  ( serviceStatus.psRegistrationStatus == REGISTRATION_STATUS_ROAMING_REGISTERED ) ) )
+            if( cellularStatus != CELLULAR_SUCCESS )
             {
-                configPRINTF( ( ">>>  Cellular module registered  <<<\r\n" ) );
-                break;
-            }
-            else
-            {
-                configPRINTF( ( ">>>  Cellular GetServiceStatus failed %d, ps registration status %d  <<<\r\n",
-                                cellularStatus, serviceStatus.psRegistrationStatus ) );
-            }
-
-            timeoutCount++;
-
-            if( timeoutCount >= timeoutCountLimit )
-            {
-                configPRINTF( ( ">>>  Cellular module can't be registered  <<<\r\n" ) );
+                configPRINTF( ( ">>>  Cellular_RegisterUrcNetworkRegistrationEventCallback failure %d  <<<\r\n", cellularStatus ) );
             }
-
-            vTaskDelay( pdMS_TO_TICKS( CELLULAR_PDN_CONNECT_WAIT_INTERVAL_MS ) );
         }
     }
 
+    /* Rescan network, unless the module already runs with the desired configuration. */
     if( cellularStatus == CELLULAR_SUCCESS )
     {
-        cellularStatus = Cellular_ActivatePdn( CellularHandle, CellularSocketPdnContextId );
+        rescanRequired = ( setupAttempted == true ) || ( Cellular_BG96IsRescanRequired( CellularHandle ) == true );
+        setupAttempted = true;
 
-        if( cellularStatus != CELLULAR_SUCCESS )
+        if( rescanRequired == false )
         {
-            configPRINTF( ( ">>>  Cellular_ActivatePdn failure %d  <<<\r\n", cellularStatus ) );
+            configPRINTF( ( ">>>  Cellular network configuration unchanged, skip rescan  <<<\r\n" ) );
         }
     }
 
-    if( cellularStatus == CELLULAR_SUCCESS )
+    if( ( cellularStatus == CELLULAR_SUCCESS ) && ( rescanRequired == true ) )
     {
-        cellularStatus = Cellular_GetIPAddress( CellularHandle, CellularSocketPdnContextId, localIP, sizeof( localIP ) );
+        cellularStatus = Cellular_RfOff( CellularHandle );
 
         if( cellularStatus != CELLULAR_SUCCESS )
         {
-            configPRINTF( ( ">>>  Cellular_GetIPAddress failure %d  <<<\r\n", cellularStatus ) );
+            configPRINTF( ( ">>>  Cellular_RfOff failure %d  <<<\r\n", cellularStatus ) );
         }
     }
 
-    if( cellularStatus == CELLULAR_SUCCESS )
+    if( ( cellularStatus == CELLULAR_SUCCESS ) && ( rescanRequired == true ) )
     {
-        cellularStatus = Cellular_GetPdnStatus( CellularHandle, PdnStatusBuffers, CELLULAR_PDN_CONTEXT_NUM, &NumStatus );
+        cellularStatus = Cellular_RfOn( CellularHandle );
 
         if( cellularStatus != CELLULAR_SUCCESS )
         {
-            configPRINTF( ( ">>>  Cellular_GetPdnStatus failure %d  <<<\r\n", cellularStatus ) );
+            configPRINTF( ( ">>>  Cellular_RfOn failure %d  <<<\r\n", cellularStatus ) );
         }
     }
 
+    /* Wait for the network registration. */
+    if( cellularStatus == CELLULAR_SUCCESS )
+    {
+        cellularStatus = prvWaitForRegistration( CELLULAR_PDN_CONNECT_TIMEOUT );
+    }
+
+    if( CellularHandle != NULL )
+    {
+        ( void ) Cellular_RegisterUrcNetworkRegistrationEventCallback( CellularHandle, NULL, NULL );
+    }
+
+    /* The PDN manager activates the context and keeps it active from now on,
+     * also through deactivations by the network. */
     if( cellularStatus == CELLULAR_SUCCESS )
     {
-        for( i = 0U; i < NumStatus; i++ )
+        if( CellularPdn_Start( CellularHandle, CellularSocketPdnContextId ) == false )
         {
-            if( ( PdnStatusBuffers[ i ].contextId == CellularSocketPdnContextId ) && ( PdnStatusBuffers[ i ].state == 1 ) )
-            {
-                pdnStatus = true;
-                break;
-            }
+            cellularStatus = CELLULAR_INTERNAL_FAILURE;
         }
+    }
 
-        if( pdnStatus == false )
+    if( cellularStatus == CELLULAR_SUCCESS )
+    {
+        if( ( CellularPdn_WaitUp( CELLULAR_PDN_CONNECT_TIMEOUT ) == false ) ||
+            ( CellularPdn_GetIPAddress( localIP, sizeof( localIP ) ) == false ) )
         {
-            configPRINTF( ( ">>>  Cellular PDN is not activated <<<" ) );
+            configPRINTF( ( ">>>  Cellular PDN is not activated <<<\r\n" ) );
+            cellularStatus = CELLULAR_TIMEOUT;
         }
     }
 
-    if( ( cellularStatus == CELLULAR_SUCCESS ) && ( pdnStatus == true ) )
+    if( cellularStatus == CELLULAR_SUCCESS )
     {
         configPRINTF( ( ">>>  Cellular module registered, IP address %s  <<<\r\n", localIP ) );
+        prvPublishPowerSavingTimers();
         cellularRet = true;
     }
     else
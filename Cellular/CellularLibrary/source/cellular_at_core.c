@@ -60,12 +60,35 @@ typedef enum CellularATStringValidationResult
 
 static void validateString( const char * pString,
                             CellularATStringValidationResult_t * pStringValidationResult );
+static const char * validateStringEnd( const char * pString,
+                                       CellularATStringValidationResult_t * pStringValidationResult );
+static bool isDelimiter( char c,
+                         const char * pDelimiter );
 static uint8_t _charToNibble( char c );
+static CellularATError_t parseSchemaInteger( const CellularATToken_t * pToken,
+                                             uint8_t base,
+                                             int32_t * pValue );
+static void storeSchemaInteger( uint8_t * pFieldOutput,
+                                uint16_t size,
+                                int32_t value );
+static CellularATError_t parseSchemaField( const CellularATToken_t * pToken,
+                                           const CellularATField_t * pField,
+                                           uint8_t * pFieldOutput );
 
 /*-----------------------------------------------------------*/
 
 static void validateString( const char * pString,
                             CellularATStringValidationResult_t * pStringValidationResult )
+{
+    ( void ) validateStringEnd( pString, pStringValidationResult );
+}
+
+/*-----------------------------------------------------------*/
+
+/* Same as validateString(), but also returns the location of the terminating
+ * '\0' so that callers do not need another strlen(). */
+static const char * validateStringEnd( const char * pString,
+                                       CellularATStringValidationResult_t * pStringValidationResult )
 {
     const char * pNullCharacterLocation = NULL;
 
@@ -89,6 +112,30 @@ static void validateString( const char * pString,
     {
         *pStringValidationResult = CELLULAR_AT_STRING_VALID;
     }
+
+    return pNullCharacterLocation;
+}
+
+/*-----------------------------------------------------------*/
+
+static bool isDelimiter( char c,
+                         const char * pDelimiter )
+{
+    const char * pTempDelimiter = pDelimiter;
+    bool result = false;
+
+    while( *pTempDelimiter != '\0' )
+    {
+        if( *pTempDelimiter == c )
+        {
+            result = true;
+            break;
+        }
+
+        pTempDelimiter++;
+    }
+
+    return result;
 }
 
 /*-----------------------------------------------------------*/
@@ -531,8 +578,9 @@ CellularATError_t Cellular_ATGetSpecificNextTok( char ** ppString,
 {
     CellularATError_t atStatus = CELLULAR_AT_SUCCESS;
     CellularATStringValidationResult_t stringValidationResult = CELLULAR_AT_STRING_UNKNOWN;
-    uint16_t tokStrLen = 0, dataStrlen = 0;
+    const char * pEnd = NULL;
     char * tok = NULL;
+    char * pTokEnd = NULL;
 
     if( ( ppString == NULL ) || ( pDelimiter == NULL ) ||
         ( ppTokOutput == NULL ) || ( *ppString == NULL ) )
@@ -542,7 +590,7 @@ CellularATError_t Cellular_ATGetSpecificNextTok( char ** ppString,
 
     if( atStatus == CELLULAR_AT_SUCCESS )
     {
-        validateString( *ppString, &stringValidationResult );
+        pEnd = validateStringEnd( *ppString, &stringValidationResult );
 
         if( stringValidationResult != CELLULAR_AT_STRING_VALID )
         {
@@ -552,32 +600,51 @@ CellularATError_t Cellular_ATGetSpecificNextTok( char ** ppString,
 
     if( atStatus == CELLULAR_AT_SUCCESS )
     {
-        dataStrlen = ( uint16_t ) strlen( *ppString );
+        tok = *ppString;
 
-        if( ( **ppString ) == ( *pDelimiter ) )
+        if( ( *tok ) == ( *pDelimiter ) )
         {
-            **ppString = '\0';
-            tok = *ppString;
+            /* An empty token. */
+            pTokEnd = tok;
         }
         else
         {
-            tok = strtok( *ppString, pDelimiter );
+            /* Like strtok(), skip leading delimiters and end the token at the
+             * next one, but without keeping any state between calls. */
+            while( ( tok < pEnd ) && ( isDelimiter( *tok, pDelimiter ) == true ) )
+            {
+                tok++;
+            }
+
+            if( tok == pEnd )
+            {
+                /* Nothing but delimiters left. */
+                atStatus = CELLULAR_AT_BAD_PARAMETER;
+            }
+
+            pTokEnd = tok;
+
+            while( ( pTokEnd < pEnd ) && ( isDelimiter( *pTokEnd, pDelimiter ) == false ) )
+            {
+                pTokEnd++;
+            }
         }
     }
 
     if( atStatus == CELLULAR_AT_SUCCESS )
     {
-        tokStrLen = ( uint16_t ) strlen( tok );
-
-        if( ( tokStrLen < dataStrlen ) && ( ( *ppString )[ tokStrLen + 1U ] != '\0' ) )
+        if( ( pTokEnd < pEnd ) && ( &( pTokEnd[ 1 ] ) < pEnd ) )
         {
-            *ppString = &( tok[ strlen( tok ) + 1U ] );
+            /* Continue after the delimiter. */
+            *ppString = &( pTokEnd[ 1 ] );
         }
         else
         {
-            *ppString = &( tok[ strlen( tok ) ] );
+            /* Last token, the next call returns an error. */
+            *ppString = pTokEnd;
         }
 
+        *pTokEnd = '\0';
         *ppTokOutput = tok;
     }
 
@@ -586,6 +653,124 @@ CellularATError_t Cellular_ATGetSpecificNextTok( char ** ppString,
 
 /*-----------------------------------------------------------*/
 
+CellularATError_t Cellular_ATTokenizerInit( CellularATTokenizer_t * pTokenizer,
+                                            char * pString )
+{
+    CellularATError_t atStatus = CELLULAR_AT_SUCCESS;
+    CellularATStringValidationResult_t stringValidationResult = CELLULAR_AT_STRING_UNKNOWN;
+    const char * pEnd = NULL;
+
+    if( ( pTokenizer == NULL ) || ( pString == NULL ) )
+    {
+        atStatus = CELLULAR_AT_BAD_PARAMETER;
+    }
+
+    if( atStatus == CELLULAR_AT_SUCCESS )
+    {
+        pEnd = validateStringEnd( pString, &stringValidationResult );
+
+        if( stringValidationResult != CELLULAR_AT_STRING_VALID )
+        {
+            atStatus = CELLULAR_AT_BAD_PARAMETER;
+        }
+    }
+
+    if( atStatus == CELLULAR_AT_SUCCESS )
+    {
+        pTokenizer->pNext = pString;
+        pTokenizer->pEnd = pEnd;
+    }
+
+    return atStatus;
+}
+
+/*-----------------------------------------------------------*/
+
+CellularATError_t Cellular_ATTokenizerNext( CellularATTokenizer_t * pTokenizer,
+                                            char delimiter,
+                                            CellularATToken_t * pToken )
+{
+    CellularATError_t atStatus = CELLULAR_AT_SUCCESS;
+    char * pCurrent = NULL;
+    char * pTokStart = NULL;
+    char * pTokEnd = NULL;
+    bool quoted = false;
+
+    if( ( pTokenizer == NULL ) || ( pToken == NULL ) || ( delimiter == '\0' ) )
+    {
+        atStatus = CELLULAR_AT_BAD_PARAMETER;
+    }
+    else if( pTokenizer->pNext == NULL )
+    {
+        /* All tokens were returned. */
+        atStatus = CELLULAR_AT_ERROR;
+    }
+    else
+    {
+        pCurrent = pTokenizer->pNext;
+
+        if( *pCurrent == '\"' )
+        {
+            quoted = true;
+            pCurrent++;
+            pTokStart = pCurrent;
+
+            while( ( pCurrent < pTokenizer->pEnd ) && ( *pCurrent != '\"' ) )
+            {
+                pCurrent++;
+            }
+
+            if( pCurrent == pTokenizer->pEnd )
+            {
+                /* The closing quote is missing. */
+                atStatus = CELLULAR_AT_ERROR;
+            }
+            else
+            {
+                pTokEnd = pCurrent;
+                pCurrent++;
+            }
+        }
+        else
+        {
+            pTokStart = pCurrent;
+        }
+    }
+
+    if( atStatus == CELLULAR_AT_SUCCESS )
+    {
+        /* Find the delimiter. Characters between a closing quote and the
+         * delimiter are not part of the token. */
+        while( ( pCurrent < pTokenizer->pEnd ) && ( *pCurrent != delimiter ) )
+        {
+            pCurrent++;
+        }
+
+        if( pTokEnd == NULL )
+        {
+            pTokEnd = pCurrent;
+        }
+
+        if( pCurrent < pTokenizer->pEnd )
+        {
+            pTokenizer->pNext = &( pCurrent[ 1 ] );
+        }
+        else
+        {
+            pTokenizer->pNext = NULL;
+        }
+
+        *pTokEnd = '\0';
+        pToken->pToken = pTokStart;
+        pToken->tokenLength = ( uint16_t ) ( pTokEnd - pTokStart );
+        pToken->quoted = quoted;
+    }
+
+    return atStatus;
+}
+
+/*-----------------------------------------------------------*/
+
 static uint8_t _charToNibble( char c )
 {
     uint8_t ret = 0xFF;
@@ -858,3 +1043,271 @@ CellularATError_t Cellular_ATStrtoi( const char * pStr,
 }
 
 /*-----------------------------------------------------------*/
+
+static CellularATError_t parseSchemaInteger( const CellularATToken_t * pToken,
+                                             uint8_t base,
+                                             int32_t * pValue )
+{
+    CellularATError_t atStatus = CELLULAR_AT_SUCCESS;
+    const char * pCurrent = pToken->pToken;
+    const char * pEnd = &( pToken->pToken[ pToken->tokenLength ] );
+    uint32_t magnitude = 0U;
+    uint32_t limit = ( uint32_t ) INT32_MAX;
+    uint16_t digitCount = 0U;
+    uint8_t digit = 0U;
+    bool negative = false;
+
+    while( ( pCurrent < pEnd ) && ( *pCurrent == ' ' ) )
+    {
+        pCurrent++;
+    }
+
+    if( ( pCurrent < pEnd ) && ( *pCurrent == '-' ) )
+    {
+        negative = true;
+        limit = ( uint32_t ) INT32_MAX + 1U;
+        pCurrent++;
+    }
+    else if( ( pCurrent < pEnd ) && ( *pCurrent == '+' ) )
+    {
+        pCurrent++;
+    }
+    else
+    {
+        /* Empty else MISRA 15.7 */
+    }
+
+    if( ( base == 16U ) && ( ( pEnd - pCurrent ) > 2 ) && ( pCurrent[ 0 ] == '0' ) &&
+        ( ( pCurrent[ 1 ] == 'x' ) || ( pCurrent[ 1 ] == 'X' ) ) )
+    {
+        pCurrent = &( pCurrent[ 2 ] );
+    }
+
+    while( ( pCurrent < pEnd ) && ( atStatus == CELLULAR_AT_SUCCESS ) )
+    {
+        digit = _charToNibble( *pCurrent );
+
+        if( digit >= base )
+        {
+            break;
+        }
+        else if( magnitude > ( ( limit - digit ) / base ) )
+        {
+            /* Out of the range of int32_t. */
+            atStatus = CELLULAR_AT_ERROR;
+        }
+        else
+        {
+            magnitude = ( magnitude * base ) + digit;
+            digitCount++;
+            pCurrent++;
+        }
+    }
+
+    while( ( pCurrent < pEnd ) && ( *pCurrent == ' ' ) )
+    {
+        pCurrent++;
+    }
+
+    if( ( atStatus == CELLULAR_AT_SUCCESS ) && ( ( digitCount == 0U ) || ( pCurrent != pEnd ) ) )
+    {
+        atStatus = CELLULAR_AT_ERROR;
+    }
+
+    if( atStatus == CELLULAR_AT_SUCCESS )
+    {
+        if( negative == false )
+        {
+            *pValue = ( int32_t ) magnitude;
+        }
+        else if( magnitude == limit )
+        {
+            *pValue = INT32_MIN;
+        }
+        else
+        {
+            *pValue = -( int32_t ) magnitude;
+        }
+    }
+
+    return atStatus;
+}
+
+/*-----------------------------------------------------------*/
+
+static void storeSchemaInteger( uint8_t * pFieldOutput,
+                                uint16_t size,
+                                int32_t value )
+{
+    uint8_t value8 = 0U;
+    uint16_t value16 = 0U;
+    uint32_t value32 = 0U;
+
+    /* The field may not be aligned for its size, e.g. in a packed structure. */
+    if( size == sizeof( value8 ) )
+    {
+        value8 = ( uint8_t ) value;
+        ( void ) memcpy( pFieldOutput, &value8, sizeof( value8 ) );
+    }
+    else if( size == sizeof( value16 ) )
+    {
+        value16 = ( uint16_t ) value;
+        ( void ) memcpy( pFieldOutput, &value16, sizeof( value16 ) );
+    }
+    else
+    {
+        value32 = ( uint32_t ) value;
+        ( void ) memcpy( pFieldOutput, &value32, sizeof( value32 ) );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static CellularATError_t parseSchemaField( const CellularATToken_t * pToken,
+                                           const CellularATField_t * pField,
+                                           uint8_t * pFieldOutput )
+{
+    CellularATError_t atStatus = CELLULAR_AT_SUCCESS;
+    int32_t value = 0;
+
+    switch( pField->type )
+    {
+        case CELLULAR_AT_FIELD_SKIP:
+            break;
+
+        case CELLULAR_AT_FIELD_INTEGER:
+
+            if( ( pField->base < 2U ) || ( pField->base > 16U ) ||
+                ( ( pField->size != 1U ) && ( pField->size != 2U ) && ( pField->size != 4U ) ) )
+            {
+                atStatus = CELLULAR_AT_BAD_PARAMETER;
+            }
+            else
+            {
+                atStatus = parseSchemaInteger( pToken, pField->base, &value );
+            }
+
+            if( atStatus != CELLULAR_AT_SUCCESS )
+            {
+                /* Empty else MISRA 15.7 */
+            }
+            else if( ( value < pField->minValue ) || ( value > pField->maxValue ) )
+            {
+                atStatus = CELLULAR_AT_ERROR;
+            }
+            else
+            {
+                storeSchemaInteger( pFieldOutput, pField->size, value );
+            }
+
+            break;
+
+        case CELLULAR_AT_FIELD_STRING:
+
+            /* The token is terminated in place, copy it with its terminator. */
+            if( pToken->tokenLength >= pField->size )
+            {
+                atStatus = CELLULAR_AT_ERROR;
+            }
+            else
+            {
+                ( void ) memcpy( pFieldOutput, pToken->pToken, ( size_t ) pToken->tokenLength + 1U );
+            }
+
+            break;
+
+        default:
+            atStatus = CELLULAR_AT_BAD_PARAMETER;
+            break;
+    }
+
+    return atStatus;
+}
+
+/*-----------------------------------------------------------*/
+
+CellularATError_t Cellular_ATParseResponse( char * pLine,
+                                            const CellularATSchema_t * pSchema,
+                                            void * pOutput,
+                                            uint32_t * pPresent )
+{
+    CellularATError_t atStatus = CELLULAR_AT_SUCCESS;
+    CellularATTokenizer_t tokenizer = { 0 };
+    CellularATToken_t token = { 0 };
+    const CellularATField_t * pField = NULL;
+    uint8_t * pOutputBytes = ( uint8_t * ) pOutput;
+    size_t prefixLength = 0U;
+    uint32_t present = 0U;
+    uint8_t fieldIndex = 0U;
+
+    if( ( pLine == NULL ) || ( pSchema == NULL ) || ( pSchema->pFields == NULL ) || ( pOutput == NULL ) ||
+        ( pSchema->fieldCount > CELLULAR_AT_SCHEMA_MAX_FIELDS ) )
+    {
+        atStatus = CELLULAR_AT_BAD_PARAMETER;
+    }
+    else
+    {
+        atStatus = Cellular_ATTokenizerInit( &tokenizer, pLine );
+    }
+
+    if( ( atStatus == CELLULAR_AT_SUCCESS ) && ( pSchema->pPrefix != NULL ) )
+    {
+        prefixLength = strlen( pSchema->pPrefix );
+
+        if( ( strncmp( pLine, pSchema->pPrefix, prefixLength ) != 0 ) || ( pLine[ prefixLength ] != ':' ) )
+        {
+            atStatus = CELLULAR_AT_ERROR;
+        }
+        else
+        {
+            tokenizer.pNext = &( pLine[ prefixLength + 1U ] );
+
+            while( *tokenizer.pNext == ' ' )
+            {
+                tokenizer.pNext++;
+            }
+        }
+    }
+
+    for( fieldIndex = 0U; ( atStatus == CELLULAR_AT_SUCCESS ) && ( fieldIndex < pSchema->fieldCount ); fieldIndex++ )
+    {
+        pField = &( pSchema->pFields[ fieldIndex ] );
+
+        if( tokenizer.pNext == NULL )
+        {
+            /* The response ends before this parameter. */
+            token.pToken = NULL;
+            token.tokenLength = 0U;
+        }
+        else
+        {
+            atStatus = Cellular_ATTokenizerNext( &tokenizer, ',', &token );
+        }
+
+        if( atStatus != CELLULAR_AT_SUCCESS )
+        {
+            /* Empty else MISRA 15.7 */
+        }
+        else if( token.tokenLength == 0U )
+        {
+            if( pField->optional == false )
+            {
+                atStatus = CELLULAR_AT_ERROR;
+            }
+        }
+        else
+        {
+            atStatus = parseSchemaField( &token, pField, &( pOutputBytes[ pField->offset ] ) );
+            present = present | ( 1UL << fieldIndex );
+        }
+    }
+
+    if( ( atStatus == CELLULAR_AT_SUCCESS ) && ( pPresent != NULL ) )
+    {
+        *pPresent = present;
+    }
+
+    return atStatus;
+}
+
+/*-----------------------------------------------------------*/
@@ -848,6 +848,30 @@ void _Cellular_PdnEventCallback( const CellularContext_t * pContext,
                                  CellularUrcEvent_t urcEvent,
                                  uint8_t contextId )
 {
+    uint32_t sockIndex = 0;
+    CellularSocketContext_t * pSocketData = NULL;
+
+    if( ( pContext != NULL ) && ( urcEvent == CELLULAR_URC_EVENT_PDN_DEACTIVATED ) )
+    {
+        for( sockIndex = 0; sockIndex < CELLULAR_NUM_SOCKET_MAX; sockIndex++ )
+        {
+            pSocketData = pContext->pSocketData[ sockIndex ];
+
+            if( ( pSocketData != NULL ) && ( pSocketData->contextId == contextId ) &&
+                ( ( pSocketData->socketState == SOCKETSTATE_CONNECTING ) ||
+                  ( pSocketData->socketState == SOCKETSTATE_CONNECTED ) ) )
+            {
+                pSocketData->socketState = SOCKETSTATE_DISCONNECTED;
+                LogDebug( "Socket closed by PDN deactivation. Conn Id %u", ( unsigned int ) sockIndex );
+
+                if( pSocketData->closedCallback != NULL )
+                {
+                    pSocketData->closedCallback( pSocketData, pSocketData->pClosedCallbackContext );
+                }
+            }
+        }
+    }
+
     if( ( pContext != NULL ) && ( pContext->cbEvents.pdnEventCallback != NULL ) )
     {
         pContext->cbEvents.pdnEventCallback( urcEvent, contextId, pContext->cbEvents.pPdnEventCallbackContext );
@@ -216,6 +216,7 @@ static CellularPktStatus_t _Cellular_AtcmdRequestTimeoutWithCallbackRaw( Cellula
     CellularPktStatus_t respCode = CELLULAR_PKT_STATUS_OK;
     CellularPktStatus_t pktStatus = CELLULAR_PKT_STATUS_OK;
     PlatformBaseType_t qRet = platformFALSE;
+    uint32_t startTimeMs = 0U;
 
     if( atReq.pAtCmd == NULL )
     {
@@ -234,6 +235,7 @@ static CellularPktStatus_t _Cellular_AtcmdRequestTimeoutWithCallbackRaw( Cellula
         pContext->pCurrentCmd = atReq.pAtCmd;
         PlatformMutex_Unlock( &( pContext->PktRespMutex ) );
 
+        startTimeMs = CellularMetrics_GetTimeMs();
         pktStatus = _Cellular_PktioSendAtCmd( pContext, atReq.pAtCmd, atReq.atCmdType, atReq.pAtRspPrefix );
 
         if( pktStatus != CELLULAR_PKT_STATUS_OK )
@@ -260,6 +262,9 @@ static CellularPktStatus_t _Cellular_AtcmdRequestTimeoutWithCallbackRaw( Cellula
                 pktStatus = CELLULAR_PKT_STATUS_TIMED_OUT;
                 LogError("pkt_recv status=%d, AT cmd %s timed out", pktStatus, atReq.pAtCmd);
             }
+
+            CellularMetrics_AtCommand( atReq.atCmdType, CellularMetrics_GetTimeMs() - startTimeMs,
+                                       ( pktStatus == CELLULAR_PKT_STATUS_TIMED_OUT ) );
         }
 
         /* No command is waiting response. */
@@ -552,6 +557,7 @@ CellularPktStatus_t _Cellular_HandlePacket( CellularContext_t * pContext,
                 break;
 
             case AT_UNSOLICITED:
+                CellularMetrics_Urc( ( const char * ) pBuf );
                 pktStatus = _processUrcPacket( pContext, pBuf );
                 break;
 
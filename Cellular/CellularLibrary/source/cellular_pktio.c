@@ -38,6 +38,9 @@
     #ifndef LIBRARY_LOG_NAME
         #define LIBRARY_LOG_NAME    "PKtio"
     #endif
+    #ifndef LIBRARY_LOG_MODULE
+        #define LIBRARY_LOG_MODULE    IOT_LOG_MODULE_PKTIO
+    #endif
 
     #ifdef IOT_LOG_LEVEL_PKTIO
         #define LIBRARY_LOG_LEVEL        IOT_LOG_LEVEL_PKTIO
@@ -50,6 +53,9 @@
     #endif
 
     #include "logging_stack.h"
+
+    /* The port config overrides the defaults, so it comes first. */
+    #include "cellular_config.h"
 #endif /* ifndef CELLULAR_DO_NOT_USE_CUSTOM_CONFIG */
 #include "cellular_config_defaults.h"
 
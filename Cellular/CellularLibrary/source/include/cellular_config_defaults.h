@@ -588,6 +588,51 @@
     #define LogDebug( message )
 #endif
 
+/**
+ * @brief Macro that is called in the cellular library to read a millisecond
+ * timestamp for the AT command latency metrics.
+ *
+ * To collect performance metrics, this macro and the CellularMetrics_* macros
+ * below should be mapped to the application-specific metrics implementation.
+ *
+ * <b>Default value</b>: Metrics are turned off and the macro evaluates to 0.
+ */
+#ifndef CellularMetrics_GetTimeMs
+    #define CellularMetrics_GetTimeMs()    ( 0U )
+#endif
+
+/**
+ * @brief Macro that is called in the cellular library when an AT command got
+ * its response or timed out.
+ *
+ * <b>Default value</b>: Metrics are turned off, and no code is generated for calls
+ * to the macro in the cellular library on compilation.
+ */
+#ifndef CellularMetrics_AtCommand
+    #define CellularMetrics_AtCommand( atCmdType, latencyMs, timedOut )    ( ( void ) ( latencyMs ) )
+#endif
+
+/**
+ * @brief Macro that is called in the cellular library for every URC received.
+ *
+ * <b>Default value</b>: Metrics are turned off, and no code is generated for calls
+ * to the macro in the cellular library on compilation.
+ */
+#ifndef CellularMetrics_Urc
+    #define CellularMetrics_Urc( pUrcLine )
+#endif
+
+/**
+ * @brief Macro that is called in the cellular library after socket data was
+ * sent or received.
+ *
+ * <b>Default value</b>: Metrics are turned off, and no code is generated for calls
+ * to the macro in the cellular library on compilation.
+ */
+#ifndef CellularMetrics_Socket
+    #define CellularMetrics_Socket( bytesIn, bytesOut )
+#endif
+
 /* *INDENT-OFF* */
 #ifdef __cplusplus
     }
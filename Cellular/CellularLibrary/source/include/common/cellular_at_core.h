@@ -40,6 +40,7 @@
 
 /* Standard includes */
 #include <stdbool.h>
+#include <stddef.h>
 #include <string.h>
 
 /* Standard includes. */
@@ -75,6 +76,99 @@ typedef enum CellularATError
     CELLULAR_AT_UNKNOWN        /**< Any other error other than the above mentioned ones. */
 } CellularATError_t;
 
+/**
+ * @brief Cursor over the comma separated parameters of an AT response.
+ *
+ * Initialised by Cellular_ATTokenizerInit() and advanced by
+ * Cellular_ATTokenizerNext(). All state is kept here, so responses can be
+ * tokenized concurrently from different tasks.
+ */
+typedef struct CellularATTokenizer
+{
+    char * pNext;       /**< Start of the next token, NULL when all tokens were returned. */
+    const char * pEnd;  /**< Terminating '\0' of the response. */
+} CellularATTokenizer_t;
+
+/**
+ * @brief A token returned by Cellular_ATTokenizerNext().
+ */
+typedef struct CellularATToken
+{
+    char * pToken;         /**< First character of the token, '\0' terminated in place. */
+    uint16_t tokenLength;  /**< Length of the token, without the terminator. */
+    bool quoted;           /**< The parameter was enclosed in double quotes, which are not part of the token. */
+} CellularATToken_t;
+
+/**
+ * @brief Maximum number of parameters described by a CellularATSchema_t.
+ */
+#define CELLULAR_AT_SCHEMA_MAX_FIELDS    ( 32U )
+
+/**
+ * @brief How a parameter of an AT response is stored by Cellular_ATParseResponse().
+ */
+typedef enum CellularATFieldType
+{
+    CELLULAR_AT_FIELD_SKIP = 0, /**< The parameter is not stored. */
+    CELLULAR_AT_FIELD_INTEGER,  /**< Integer in the range of the field, stored in 1, 2 or 4 bytes. */
+    CELLULAR_AT_FIELD_STRING    /**< String copied with its terminator, without quotes. */
+} CellularATFieldType_t;
+
+/**
+ * @brief Description of one parameter of an AT response.
+ *
+ * Use the CELLULAR_AT_SCHEMA_* macros to fill it in.
+ */
+typedef struct CellularATField
+{
+    CellularATFieldType_t type; /**< How the parameter is stored. */
+    uint8_t base;               /**< Base of an integer, 2, 10 or 16. */
+    bool optional;              /**< The parameter may be empty or missing. */
+    uint16_t offset;            /**< Offset of the field in the output structure. */
+    uint16_t size;              /**< Size of the field, the buffer size for strings. */
+    int32_t minValue;           /**< Smallest valid integer. */
+    int32_t maxValue;           /**< Largest valid integer. */
+} CellularATField_t;
+
+/**
+ * @brief Description of an AT response, parsed by Cellular_ATParseResponse().
+ */
+typedef struct CellularATSchema
+{
+    const char * pPrefix;             /**< Prefix of the response, e.g. "+QPSMS", or NULL if the response has none. */
+    const CellularATField_t * pFields; /**< The parameters, in the order of the response. */
+    uint8_t fieldCount;               /**< Number of parameters, up to CELLULAR_AT_SCHEMA_MAX_FIELDS. */
+} CellularATSchema_t;
+
+/**
+ * @brief An integer parameter stored in the member of the output structure.
+ *
+ * The member is an integer or enumeration of 1, 2 or 4 bytes.
+ */
+#define CELLULAR_AT_SCHEMA_INTEGER( structType, member, intBase, isOptional, minimum, maximum ) \
+    {                                                                                          \
+        CELLULAR_AT_FIELD_INTEGER, ( intBase ), ( isOptional ),                                \
+        ( uint16_t ) offsetof( structType, member ),                                           \
+        ( uint16_t ) sizeof( ( ( structType * ) NULL )->member ),                              \
+        ( minimum ), ( maximum )                                                               \
+    }
+
+/**
+ * @brief A string parameter copied into the char array member of the output structure.
+ */
+#define CELLULAR_AT_SCHEMA_STRING( structType, member, isOptional )   \
+    {                                                                \
+        CELLULAR_AT_FIELD_STRING, 0U, ( isOptional ),                \
+        ( uint16_t ) offsetof( structType, member ),                 \
+        ( uint16_t ) sizeof( ( ( structType * ) NULL )->member ),    \
+        0, 0                                                         \
+    }
+
+/**
+ * @brief A parameter that is not stored.
+ */
+#define CELLULAR_AT_SCHEMA_SKIP    { CELLULAR_AT_FIELD_SKIP, 0U, true, 0U, 0U, 0, 0 }
+
 /*-----------------------------------------------------------*/
 
 /**
@@ -281,6 +375,46 @@ CellularATError_t Cellular_ATGetSpecificNextTok( char ** ppString,
                                                  const char * pDelimiter,
                                                  char ** ppTokOutput );
 
+/**
+ * @brief Start tokenizing the parameters of an AT response.
+ *
+ * The length of the response is validated once here; the tokens are then
+ * returned by Cellular_ATTokenizerNext() in a single pass over the response.
+ *
+ * @param[out] pTokenizer The cursor to initialise.
+ * @param[in] pString The AT response, usually after Cellular_ATRemovePrefix().
+ * The tokens are terminated in place, so the response is modified.
+ *
+ * @return CELLULAR_AT_SUCCESS if the operation is successful, otherwise an
+ * error code indicating the cause of the error.
+ */
+CellularATError_t Cellular_ATTokenizerInit( CellularATTokenizer_t * pTokenizer,
+                                            char * pString );
+
+/**
+ * @brief Return the next parameter of an AT response.
+ *
+ * Unlike Cellular_ATGetSpecificNextTok(), every delimiter separates two
+ * parameters: empty parameters are returned as empty tokens, and a response
+ * ending with a delimiter ends with an empty token. A parameter that starts
+ * with a double quote extends to the closing double quote, so it may contain
+ * the delimiter; the quotes are not part of the token. For example:
+ *
+ * "CAT-M1",-65,,"a,b" returns CAT-M1 (quoted), -65, an empty token and a,b
+ * (quoted).
+ *
+ * @param[in,out] pTokenizer The cursor initialised by Cellular_ATTokenizerInit().
+ * @param[in] delimiter The character separating the parameters.
+ * @param[out] pToken The token.
+ *
+ * @return CELLULAR_AT_SUCCESS if a token is returned, CELLULAR_AT_ERROR if all
+ * tokens were returned or a double quote is not closed, otherwise an error code
+ * indicating the cause of the error.
+ */
+CellularATError_t Cellular_ATTokenizerNext( CellularATTokenizer_t * pTokenizer,
+                                            char delimiter,
+                                            CellularATToken_t * pToken );
+
 /**
  * @brief Convert HEX string to HEX.
  *
@@ -401,6 +535,38 @@ CellularATError_t Cellular_ATStrtoi( const char * pStr,
                                      int32_t base,
                                      int32_t * pResult );
 
+/**
+ * @brief Parse an AT response into a structure as described by a schema.
+ *
+ * The response is tokenized like Cellular_ATTokenizerNext() in a single pass,
+ * and every parameter is converted and stored in the output structure
+ * directly. Quotes are removed, integers are checked against the range of
+ * their field and strings against the size of their buffer. Parameters after
+ * the last one of the schema are ignored, so newer modem firmware may add
+ * some. For example, with the schema
+ *
+ * { "+QPSMS", { mode: integer 0..255, 2 x skipped, TAU: optional integer } }
+ *
+ * +QPSMS: 1,,,"4320","60" stores 1 and 4320 and sets bits 0 and 3 of
+ * pPresent.
+ *
+ * @param[in] pLine The AT response. It is modified in place.
+ * @param[in] pSchema The description of the response.
+ * @param[out] pOutput The structure the fields of the schema refer to. Fields
+ * of parameters that are empty or missing are not written, and on an error
+ * the fields before the failing parameter are written already.
+ * @param[out] pPresent Optional, may be NULL. Bit n is set if parameter n of
+ * the schema had a value.
+ *
+ * @return CELLULAR_AT_SUCCESS if the operation is successful, CELLULAR_AT_ERROR
+ * if the response does not match the schema, otherwise an error code
+ * indicating the cause of the error.
+ */
+CellularATError_t Cellular_ATParseResponse( char * pLine,
+                                            const CellularATSchema_t * pSchema,
+                                            void * pOutput,
+                                            uint32_t * pPresent );
+
 /* *INDENT-OFF* */
 #ifdef __cplusplus
     }
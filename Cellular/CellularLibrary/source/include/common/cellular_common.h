@@ -291,6 +291,10 @@ void _Cellular_NetworkRegistrationCallback( const CellularContext_t * pContext,
  * @brief Call the network registration callback if the callback is previously set by
  * Cellular_RegisterUrcPdnEventCallback.
  *
+ * On CELLULAR_URC_EVENT_PDN_DEACTIVATED the sockets of the context are marked
+ * disconnected and their closed callbacks are called first. The modem closes
+ * them together with the context, usually without a socket closed URC.
+ *
  * @param[in] pContext The opaque cellular context pointer created by Cellular_Init.
  * @param[in] urcEvent URC Event that happened.
  * @param[in] contextId Context ID of the PDN context.
@@ -117,6 +117,16 @@
  */
 #define CELLULAR_SAMPLE_WRONG_STRING_DELIMITER_FIRST               "TEST_TOKENTOKEN1TOKEN2"
 
+/**
+ * @brief Cellular sample string with empty and quoted parameters.
+ */
+#define CELLULAR_SAMPLE_TOKENIZER_STRING_INPUT                     "\"CAT-M1\",-65,,\"a,b\",7,"
+
+/**
+ * @brief Cellular sample string with a quoted parameter that is not closed.
+ */
+#define CELLULAR_SAMPLE_TOKENIZER_UNTERMINATED_QUOTE               "1,\"10.0.0.1"
+
 /**
  * @brief Cellular sample hex string in capital.
  */
@@ -172,6 +182,36 @@
  */
 #define CELLULAR_SAMPLE_PREFIX_STRING_INVALID_PREFIX_CHAR          "+*CPIN:READY"
 
+/**
+ * @brief Output structure of the sample schema.
+ */
+typedef struct SchemaSampleOutput
+{
+    uint8_t mode;
+    int16_t rsrp;
+    uint32_t tau;
+    char apn[ 8 ];
+} SchemaSampleOutput_t;
+
+/**
+ * @brief +TEST: <mode>[,<rsrp>][,<ignored>][,<hex tau>][,<apn>]
+ */
+static const CellularATField_t schemaSampleFields[] =
+{
+    CELLULAR_AT_SCHEMA_INTEGER( SchemaSampleOutput_t, mode, 10U, false, 0, 255 ),
+    CELLULAR_AT_SCHEMA_INTEGER( SchemaSampleOutput_t, rsrp, 10U, true, -140, -44 ),
+    CELLULAR_AT_SCHEMA_SKIP,
+    CELLULAR_AT_SCHEMA_INTEGER( SchemaSampleOutput_t, tau, 16U, true, 0, INT32_MAX ),
+    CELLULAR_AT_SCHEMA_STRING( SchemaSampleOutput_t, apn, true )
+};
+
+static const CellularATSchema_t schemaSample =
+{
+    "+TEST",
+    schemaSampleFields,
+    ( uint8_t ) ARRAY_SIZE( schemaSampleFields )
+};
+
 static int mallocAllocFail = 0;
 
 /* ============================   UNITY FIXTURES ============================ */
@@ -639,6 +679,118 @@ void test_Cellular_ATGetSpecificNextTok_Error_Path( void )
     TEST_ASSERT_EQUAL( CELLULAR_AT_BAD_PARAMETER, cellularStatus );
 }
 
+/**
+ * @brief Test that Cellular_ATGetSpecificNextTok walks all tokens like strtok and skips leading delimiters other than the first one.
+ */
+void test_Cellular_ATGetSpecificNextTok_All_Tokens( void )
+{
+    CellularATError_t cellularStatus = CELLULAR_AT_SUCCESS;
+    char pStringSource[] = ";a,b;;c";
+    char * pString = pStringSource;
+    const char * pDelimiter = ",;";
+    char * pTokOutput;
+
+    cellularStatus = Cellular_ATGetSpecificNextTok( &pString, pDelimiter, &pTokOutput );
+    TEST_ASSERT_EQUAL( CELLULAR_AT_SUCCESS, cellularStatus );
+    TEST_ASSERT_EQUAL_STRING( "a", pTokOutput );
+
+    cellularStatus = Cellular_ATGetSpecificNextTok( &pString, pDelimiter, &pTokOutput );
+    TEST_ASSERT_EQUAL( CELLULAR_AT_SUCCESS, cellularStatus );
+    TEST_ASSERT_EQUAL_STRING( "b", pTokOutput );
+
+    cellularStatus = Cellular_ATGetSpecificNextTok( &pString, pDelimiter, &pTokOutput );
+    TEST_ASSERT_EQUAL( CELLULAR_AT_SUCCESS, cellularStatus );
+    TEST_ASSERT_EQUAL_STRING( "c", pTokOutput );
+
+    cellularStatus = Cellular_ATGetSpecificNextTok( &pString, pDelimiter, &pTokOutput );
+    TEST_ASSERT_EQUAL( CELLULAR_AT_BAD_PARAMETER, cellularStatus );
+}
+
+/**
+ * @brief Test that any NULL parameter causes the tokenizer to return CELLULAR_AT_BAD_PARAMETER.
+ */
+void test_Cellular_ATTokenizer_Invalid_Param( void )
+{
+    CellularATError_t cellularStatus = CELLULAR_AT_SUCCESS;
+    CellularATTokenizer_t tokenizer;
+    CellularATToken_t token;
+    char pString[] = "1,2";
+
+    cellularStatus = Cellular_ATTokenizerInit( NULL, pString );
+    TEST_ASSERT_EQUAL( CELLULAR_AT_BAD_PARAMETER, cellularStatus );
+
+    cellularStatus = Cellular_ATTokenizerInit( &tokenizer, NULL );
+    TEST_ASSERT_EQUAL( CELLULAR_AT_BAD_PARAMETER, cellularStatus );
+
+    cellularStatus = Cellular_ATTokenizerInit( &tokenizer, "" );
+    TEST_ASSERT_EQUAL( CELLULAR_AT_BAD_PARAMETER, cellularStatus );
+
+    cellularStatus = Cellular_ATTokenizerInit( &tokenizer, CELLULAR_SAMPLE_PREFIX_STRING_LARGE_INPUT );
+    TEST_ASSERT_EQUAL( CELLULAR_AT_BAD_PARAMETER, cellularStatus );
+
+    cellularStatus = Cellular_ATTokenizerInit( &tokenizer, pString );
+    TEST_ASSERT_EQUAL( CELLULAR_AT_SUCCESS, cellularStatus );
+
+    cellularStatus = Cellular_ATTokenizerNext( NULL, ',', &token );
+    TEST_ASSERT_EQUAL( CELLULAR_AT_BAD_PARAMETER, cellularStatus );
+
+    cellularStatus = Cellular_ATTokenizerNext( &tokenizer, ',', NULL );
+    TEST_ASSERT_EQUAL( CELLULAR_AT_BAD_PARAMETER, cellularStatus );
+
+    cellularStatus = Cellular_ATTokenizerNext( &tokenizer, '\0', &token );
+    TEST_ASSERT_EQUAL( CELLULAR_AT_BAD_PARAMETER, cellularStatus );
+}
+
+/**
+ * @brief Test that the tokenizer returns empty and quoted parameters and the empty parameter after a trailing delimiter.
+ */
+void test_Cellular_ATTokenizer_Happy_Path( void )
+{
+    CellularATError_t cellularStatus = CELLULAR_AT_SUCCESS;
+    CellularATTokenizer_t tokenizer;
+    CellularATToken_t token;
+    char pString[] = CELLULAR_SAMPLE_TOKENIZER_STRING_INPUT;
+    const char * pExpected[] = { "CAT-M1", "-65", "", "a,b", "7", "" };
+    const bool expectedQuoted[] = { true, false, false, true, false, false };
+    uint32_t i = 0;
+
+    cellularStatus = Cellular_ATTokenizerInit( &tokenizer, pString );
+    TEST_ASSERT_EQUAL( CELLULAR_AT_SUCCESS, cellularStatus );
+
+    for( i = 0; i < ARRAY_SIZE( pExpected ); i++ )
+    {
+        cellularStatus = Cellular_ATTokenizerNext( &tokenizer, ',', &token );
+        TEST_ASSERT_EQUAL( CELLULAR_AT_SUCCESS, cellularStatus );
+        TEST_ASSERT_EQUAL_STRING( pExpected[ i ], token.pToken );
+        TEST_ASSERT_EQUAL( strlen( pExpected[ i ] ), token.tokenLength );
+        TEST_ASSERT_EQUAL( expectedQuoted[ i ], token.quoted );
+    }
+
+    cellularStatus = Cellular_ATTokenizerNext( &tokenizer, ',', &token );
+    TEST_ASSERT_EQUAL( CELLULAR_AT_ERROR, cellularStatus );
+}
+
+/**
+ * @brief Test that the tokenizer returns CELLULAR_AT_ERROR for a quoted parameter without closing quote.
+ */
+void test_Cellular_ATTokenizer_Unterminated_Quote( void )
+{
+    CellularATError_t cellularStatus = CELLULAR_AT_SUCCESS;
+    CellularATTokenizer_t tokenizer;
+    CellularATToken_t token;
+    char pString[] = CELLULAR_SAMPLE_TOKENIZER_UNTERMINATED_QUOTE;
+
+    cellularStatus = Cellular_ATTokenizerInit( &tokenizer, pString );
+    TEST_ASSERT_EQUAL( CELLULAR_AT_SUCCESS, cellularStatus );
+
+    cellularStatus = Cellular_ATTokenizerNext( &tokenizer, ',', &token );
+    TEST_ASSERT_EQUAL( CELLULAR_AT_SUCCESS, cellularStatus );
+    TEST_ASSERT_EQUAL_STRING( "1", token.pToken );
+
+    cellularStatus = Cellular_ATTokenizerNext( &tokenizer, ',', &token );
+    TEST_ASSERT_EQUAL( CELLULAR_AT_ERROR, cellularStatus );
+}
+
 /**
  * @brief Test that any NULL parameter causes Cellular_ATHexStrToHex to return CELLULAR_AT_BAD_PARAMETER.
  */
@@ -1088,3 +1240,110 @@ void test_Cellular_ATIsPrefixPresent_Invalid_Prefix_Char( void )
     TEST_ASSERT_EQUAL( CELLULAR_AT_SUCCESS, cellularStatus );
     TEST_ASSERT_EQUAL( false, Result );
 }
+
+/**
+ * @brief Test that any NULL parameter or a too large schema causes Cellular_ATParseResponse to return CELLULAR_AT_BAD_PARAMETER.
+ */
+void test_Cellular_ATParseResponse_Invalid_Param( void )
+{
+    CellularATError_t cellularStatus = CELLULAR_AT_SUCCESS;
+    SchemaSampleOutput_t output = { 0 };
+    CellularATSchema_t schema = schemaSample;
+    char pString[] = "+TEST: 1";
+
+    cellularStatus = Cellular_ATParseResponse( NULL, &schemaSample, &output, NULL );
+    TEST_ASSERT_EQUAL( CELLULAR_AT_BAD_PARAMETER, cellularStatus );
+
+    cellularStatus = Cellular_ATParseResponse( pString, NULL, &output, NULL );
+    TEST_ASSERT_EQUAL( CELLULAR_AT_BAD_PARAMETER, cellularStatus );
+
+    cellularStatus = Cellular_ATParseResponse( pString, &schemaSample, NULL, NULL );
+    TEST_ASSERT_EQUAL( CELLULAR_AT_BAD_PARAMETER, cellularStatus );
+
+    schema.fieldCount = CELLULAR_AT_SCHEMA_MAX_FIELDS + 1U;
+    cellularStatus = Cellular_ATParseResponse( pString, &schema, &output, NULL );
+    TEST_ASSERT_EQUAL( CELLULAR_AT_BAD_PARAMETER, cellularStatus );
+
+    cellularStatus = Cellular_ATParseResponse( CELLULAR_SAMPLE_PREFIX_STRING_LARGE_INPUT, &schemaSample, &output, NULL );
+    TEST_ASSERT_EQUAL( CELLULAR_AT_BAD_PARAMETER, cellularStatus );
+}
+
+/**
+ * @brief Test that Cellular_ATParseResponse stores all parameters of a response and ignores extra parameters.
+ */
+void test_Cellular_ATParseResponse_Happy_Path( void )
+{
+    CellularATError_t cellularStatus = CELLULAR_AT_SUCCESS;
+    SchemaSampleOutput_t output = { 0 };
+    char pString[] = "+TEST: 1,-65,ignored,\"0x1F\",\"iot\",extra";
+    uint32_t present = 0;
+
+    cellularStatus = Cellular_ATParseResponse( pString, &schemaSample, &output, &present );
+    TEST_ASSERT_EQUAL( CELLULAR_AT_SUCCESS, cellularStatus );
+    TEST_ASSERT_EQUAL( 1, output.mode );
+    TEST_ASSERT_EQUAL( -65, output.rsrp );
+    TEST_ASSERT_EQUAL( 31, output.tau );
+    TEST_ASSERT_EQUAL_STRING( "iot", output.apn );
+    TEST_ASSERT_EQUAL( 0x1F, present );
+}
+
+/**
+ * @brief Test that Cellular_ATParseResponse leaves the fields of empty and missing optional parameters unchanged.
+ */
+void test_Cellular_ATParseResponse_Optional_Parameters( void )
+{
+    CellularATError_t cellularStatus = CELLULAR_AT_SUCCESS;
+    SchemaSampleOutput_t output = { 0 };
+    char pEmpty[] = "+TEST: 0,,,\"A0\"";
+    char pShort[] = "+TEST:7";
+    uint32_t present = 0;
+
+    output.rsrp = -1;
+    output.tau = 5;
+    ( void ) strcpy( output.apn, "apn" );
+
+    cellularStatus = Cellular_ATParseResponse( pEmpty, &schemaSample, &output, &present );
+    TEST_ASSERT_EQUAL( CELLULAR_AT_SUCCESS, cellularStatus );
+    TEST_ASSERT_EQUAL( 0, output.mode );
+    TEST_ASSERT_EQUAL( -1, output.rsrp );
+    TEST_ASSERT_EQUAL( 160, output.tau );
+    TEST_ASSERT_EQUAL_STRING( "apn", output.apn );
+    TEST_ASSERT_EQUAL( 0x09, present );
+
+    cellularStatus = Cellular_ATParseResponse( pShort, &schemaSample, &output, &present );
+    TEST_ASSERT_EQUAL( CELLULAR_AT_SUCCESS, cellularStatus );
+    TEST_ASSERT_EQUAL( 7, output.mode );
+    TEST_ASSERT_EQUAL( 160, output.tau );
+    TEST_ASSERT_EQUAL( 0x01, present );
+}
+
+/**
+ * @brief Test that Cellular_ATParseResponse returns CELLULAR_AT_ERROR for responses that do not match the schema.
+ */
+void test_Cellular_ATParseResponse_Mismatch( void )
+{
+    CellularATError_t cellularStatus = CELLULAR_AT_SUCCESS;
+    SchemaSampleOutput_t output = { 0 };
+    const char * pResponses[] =
+    {
+        "+TEST: ,1",                   /* Required parameter empty. */
+        "+TEST: 256",                  /* Out of the range of the field. */
+        "+TEST: 1,-30",                /* Out of the range of the field. */
+        "+TEST: 1a",                   /* Not a number. */
+        "+TEST: -",                    /* No digits. */
+        "+TEST: 1,,,100000000",        /* Out of the range of int32_t. */
+        "+TEST: 1,,,,\"abcdefgh\"",    /* Longer than the buffer. */
+        "+TEST: 1,,,,\"iot",           /* Closing quote missing. */
+        "+TESTX: 1",                   /* Other prefix. */
+        "1"                            /* No prefix. */
+    };
+    char pString[ 32 ];
+    uint32_t i = 0;
+
+    for( i = 0; i < ARRAY_SIZE( pResponses ); i++ )
+    {
+        ( void ) strcpy( pString, pResponses[ i ] );
+        cellularStatus = Cellular_ATParseResponse( pString, &schemaSample, &output, NULL );
+        TEST_ASSERT_EQUAL_MESSAGE( CELLULAR_AT_ERROR, cellularStatus, pResponses[ i ] );
+    }
+}
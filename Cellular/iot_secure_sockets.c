@@ -30,6 +30,23 @@
 #include <string.h>
 #include <stdlib.h>
 
+/* Configure logs for the functions in this file. This comes before the
+ * cellular headers, which only fill in the settings not defined yet. */
+#ifdef IOT_LOG_LEVEL_NETWORK
+    #define LIBRARY_LOG_LEVEL        IOT_LOG_LEVEL_NETWORK
+#else
+    #ifdef IOT_LOG_LEVEL_GLOBAL
+        #define LIBRARY_LOG_LEVEL    IOT_LOG_LEVEL_GLOBAL
+    #else
+        #define LIBRARY_LOG_LEVEL    IOT_LOG_ERROR
+    #endif
+#endif
+#define LIBRARY_LOG_NAME             "SECURE_SOCKETS_CELLULAR"
+#define LIBRARY_LOG_MODULE           IOT_LOG_MODULE_NETWORK
+
+/* logging includes. */
+#include "iot_logging_setup.h"
+
 
 
 /* Define _SECURE_SOCKETS_WRAPPER_NOT_REDEFINE to prevent secure sockets functions
@@ -41,6 +58,7 @@
 
 /* FreeRTOS includes. */
 #include "FreeRTOS.h"
+#include "task.h"
 #include "event_groups.h"
 
 /* Cellular HAL api includes. */
@@ -53,23 +71,8 @@
 
 /* Clock includes. */
 #include "platform/iot_clock.h"
-
-
-
-/* Configure logs for the functions in this file. */
-#ifdef IOT_LOG_LEVEL_NETWORK
-    #define LIBRARY_LOG_LEVEL        IOT_LOG_LEVEL_NETWORK
-#else
-    #ifdef IOT_LOG_LEVEL_GLOBAL
-        #define LIBRARY_LOG_LEVEL    IOT_LOG_LEVEL_GLOBAL
-    #else
-        #define LIBRARY_LOG_LEVEL    IOT_LOG_ERROR
-    #endif
-#endif
-#define LIBRARY_LOG_NAME             "SECURE_SOCKETS_CELLULAR"
-
-/* logging includes. */
-#include "iot_logging_setup.h"
+/* Platform work pool, used for the socket wake up callbacks. */
+#include "cellular_platform.h"
 
 /*-----------------------------------------------------------*/
 
@@ -138,11 +141,13 @@ typedef struct xSOCKET
     uint32_t ulServerCertificateLength;
 
     EventGroupHandle_t socketEventGroupHandle;
+
+    void ( * pxWakeupCallback )( Socket_t xSocket ); /* SOCKETS_SO_WAKEUP_CALLBACK. */
+    PlatformWork_t xWakeupWork;                      /* Runs pxWakeupCallback on the work pool. */
+    TaskHandle_t xPollTask;                          /* Task waiting in SOCKETS_Poll(), notified on data and close. */
 } _cellularSecureSocket_t;
 
 /*-----------------------------------------------------------*/
-extern void UdpServiceDataReadyCallback( CellularSocketHandle_t socketHandle,
-                                         void * pCallbackContext );
 static BaseType_t prvNetworkSend( void * ctx,
                                   const uint8_t * buf,
                                   size_t len );
@@ -160,6 +165,12 @@ static void prvCellularSocketDataReadyCallback( CellularSocketHandle_t socketHan
 static void prvCellularSocketClosedCallback( CellularSocketHandle_t socketHandle,
                                              void * pCallbackContext );
 static int32_t prvSetupSocketNonblock( _cellularSecureSocket_t * pCellularSocketContext );
+static void prvSetupSocketWakeupCallback( _cellularSecureSocket_t * pCellularSocketContext,
+                                          const void * pvOptionValue );
+static void prvSocketWakeupWork( void * pArgument );
+static void prvNotifyPollTask( const _cellularSecureSocket_t * pCellularSocketContext );
+static uint32_t prvPollEvents( const _cellularSecureSocket_t * pCellularSocketContext,
+                               uint32_t ulEvents );
 static int32_t prvSetupSocketRecvTimeout( _cellularSecureSocket_t * pCellularSocketContext,
                                           TickType_t receiveTimeout );
 static int32_t prvSetupSocketSendTimeout( _cellularSecureSocket_t * pCellularSocketContext,
@@ -361,6 +372,15 @@ static BaseType_t prvNetworkRecvCellular( const _cellularSecureSocket_t * pCellu
     if( socketStatus == CELLULAR_SUCCESS )
     {
         retRecvLength = ( BaseType_t ) recvLength;
+
+        /* The modem reports new data only after its buffer was read empty.
+         * Keep the socket readable for SOCKETS_Poll() until a read comes back
+         * without data. */
+        if( recvLength > 0U )
+        {
+            ( void ) xEventGroupSetBits( pCellularSocketContext->socketEventGroupHandle,
+                                         SOCKET_DATA_RECEIVED_CALLBACK_BIT );
+        }
     }
     else
     {
@@ -458,6 +478,13 @@ static void prvCellularSocketDataReadyCallback( CellularSocketHandle_t socketHan
         IotLogDebug( "Data ready on Socket %p", pCellularSocketContext );
         ( void ) xEventGroupSetBits( pCellularSocketContext->socketEventGroupHandle,
                                      SOCKET_DATA_RECEIVED_CALLBACK_BIT );
+        prvNotifyPollTask( pCellularSocketContext );
+
+        /* Runs in the modem reader thread; hand the user callback to a worker. */
+        if( pCellularSocketContext->pxWakeupCallback != NULL )
+        {
+            ( void ) Platform_WorkSubmit( &pCellularSocketContext->xWakeupWork );
+        }
     }
     else
     {
@@ -482,6 +509,14 @@ static void prvCellularSocketClosedCallback( CellularSocketHandle_t socketHandle
         pCellularSocketContext->ulFlags = pCellularSocketContext->ulFlags & ( ~CELLULAR_SOCKET_CONNECT_FLAG );
         ( void ) xEventGroupSetBits( pCellularSocketContext->socketEventGroupHandle,
                                      SOCKET_CLOSE_CALLBACK_BIT );
+        prvNotifyPollTask( pCellularSocketContext );
+
+        /* Let the owner learn about the close, e.g. on a PDN deactivation,
+         * without waiting for its next send to fail. */
+        if( pCellularSocketContext->pxWakeupCallback != NULL )
+        {
+            ( void ) Platform_WorkSubmit( &pCellularSocketContext->xWakeupWork );
+        }
     }
     else
     {
@@ -491,6 +526,72 @@ static void prvCellularSocketClosedCallback( CellularSocketHandle_t socketHandle
 
 /*-----------------------------------------------------------*/
 
+static void prvNotifyPollTask( const _cellularSecureSocket_t * pCellularSocketContext )
+{
+    TaskHandle_t xPollTask = pCellularSocketContext->xPollTask;
+
+    /* Set after the event bits, so a poller that checks the bits before it
+     * blocks either sees them or gets the notification. */
+    if( xPollTask != NULL )
+    {
+        ( void ) xTaskNotifyGive( xPollTask );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static uint32_t prvPollEvents( const _cellularSecureSocket_t * pCellularSocketContext,
+                               uint32_t ulEvents )
+{
+    uint32_t ulREvents = 0U;
+    EventBits_t waitEventBits = xEventGroupGetBits( pCellularSocketContext->socketEventGroupHandle );
+
+    if( ( ( ulEvents & SOCKETS_POLLHUP ) != 0U ) &&
+        ( ( ( pCellularSocketContext->ulFlags & CELLULAR_SOCKET_CONNECT_FLAG ) == 0U ) ||
+          ( ( pCellularSocketContext->ulFlags & CELLULAR_SOCKET_READ_CLOSED_FLAG ) != 0U ) ||
+          ( ( waitEventBits & SOCKET_CLOSE_CALLBACK_BIT ) != 0U ) ) )
+    {
+        ulREvents |= SOCKETS_POLLHUP;
+    }
+
+    if( ( ( ulEvents & SOCKETS_POLLIN ) != 0U ) &&
+        ( ( waitEventBits & SOCKET_DATA_RECEIVED_CALLBACK_BIT ) != 0U ) )
+    {
+        ulREvents |= SOCKETS_POLLIN;
+    }
+
+    return ulREvents;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvSocketWakeupWork( void * pArgument )
+{
+    _cellularSecureSocket_t * pCellularSocketContext = ( _cellularSecureSocket_t * ) pArgument;
+
+    if( pCellularSocketContext->pxWakeupCallback != NULL )
+    {
+        pCellularSocketContext->pxWakeupCallback( ( Socket_t ) pCellularSocketContext );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvSetupSocketWakeupCallback( _cellularSecureSocket_t * pCellularSocketContext,
+                                          const void * pvOptionValue )
+{
+    /* A NULL option value removes the callback. */
+    ( void ) Platform_WorkCancel( &pCellularSocketContext->xWakeupWork );
+    pCellularSocketContext->pxWakeupCallback = ( void ( * )( Socket_t ) ) pvOptionValue;
+
+    if( pCellularSocketContext->pxWakeupCallback != NULL )
+    {
+        Platform_WorkInit( &pCellularSocketContext->xWakeupWork, prvSocketWakeupWork, pCellularSocketContext );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
 static int32_t prvSetupSocketNonblock( _cellularSecureSocket_t * pCellularSocketContext )
 {
     CellularError_t socketStatus = CELLULAR_SUCCESS;
@@ -1444,6 +1545,100 @@ int32_t SOCKETS_Recv( Socket_t xSocket,
 
 /*-----------------------------------------------------------*/
 
+/* Standard secure socket api implementation. */
+int32_t SOCKETS_Poll( SocketsPollFd_t * pxFds,
+                      size_t xNumFds,
+                      uint32_t ulTimeoutMs )
+{
+    _cellularSecureSocket_t * pCellularSocketContext = NULL;
+    TaskHandle_t xSelf = xTaskGetCurrentTaskHandle();
+    TickType_t xStartTime = xTaskGetTickCount();
+    TickType_t xTimeout = portMAX_DELAY;
+    TickType_t xElapsed = 0;
+    int32_t retPoll = SOCKETS_ERROR_NONE;
+    size_t i = 0;
+
+    if( ( pxFds == NULL ) && ( xNumFds > 0U ) )
+    {
+        retPoll = SOCKETS_EINVAL;
+    }
+
+    for( i = 0; ( i < xNumFds ) && ( retPoll == SOCKETS_ERROR_NONE ); i++ )
+    {
+        pCellularSocketContext = ( _cellularSecureSocket_t * ) pxFds[ i ].xSocket;
+        pxFds[ i ].ulREvents = 0U;
+
+        /* coverity[misra_c_2012_rule_11_4_violation] */
+        if( ( pxFds[ i ].xSocket != SOCKETS_INVALID_SOCKET ) &&
+            ( ( pCellularSocketContext == NULL ) ||
+              ( ( pCellularSocketContext->ulFlags & CELLULAR_SOCKET_OPEN_FLAG ) == 0U ) ) )
+        {
+            IotLogDebug( "Cellular poll Invalid xSocket %p", pCellularSocketContext );
+            retPoll = SOCKETS_EINVAL;
+        }
+    }
+
+    if( retPoll == SOCKETS_ERROR_NONE )
+    {
+        if( ulTimeoutMs != SOCKETS_POLL_WAIT_FOREVER )
+        {
+            xTimeout = ( ulTimeoutMs < UINT32_MAX_MS_TICKS ) ? pdMS_TO_TICKS( ulTimeoutMs ) : ( portMAX_DELAY - 1U );
+        }
+
+        for( i = 0; i < xNumFds; i++ )
+        {
+            /* coverity[misra_c_2012_rule_11_4_violation] */
+            if( pxFds[ i ].xSocket != SOCKETS_INVALID_SOCKET )
+            {
+                ( ( _cellularSecureSocket_t * ) pxFds[ i ].xSocket )->xPollTask = xSelf;
+            }
+        }
+
+        for( ; ; )
+        {
+            /* Drop notifications of earlier polls before looking at the sockets. */
+            ( void ) ulTaskNotifyTake( pdTRUE, 0 );
+
+            for( i = 0; i < xNumFds; i++ )
+            {
+                /* coverity[misra_c_2012_rule_11_4_violation] */
+                if( pxFds[ i ].xSocket != SOCKETS_INVALID_SOCKET )
+                {
+                    pxFds[ i ].ulREvents = prvPollEvents( ( _cellularSecureSocket_t * ) pxFds[ i ].xSocket,
+                                                          pxFds[ i ].ulEvents );
+
+                    if( pxFds[ i ].ulREvents != 0U )
+                    {
+                        retPoll++;
+                    }
+                }
+            }
+
+            xElapsed = xTaskGetTickCount() - xStartTime;
+
+            if( ( retPoll > 0 ) || ( ( xTimeout != portMAX_DELAY ) && ( xElapsed >= xTimeout ) ) )
+            {
+                break;
+            }
+
+            ( void ) ulTaskNotifyTake( pdTRUE, ( xTimeout == portMAX_DELAY ) ? portMAX_DELAY : ( xTimeout - xElapsed ) );
+        }
+
+        for( i = 0; i < xNumFds; i++ )
+        {
+            /* coverity[misra_c_2012_rule_11_4_violation] */
+            if( pxFds[ i ].xSocket != SOCKETS_INVALID_SOCKET )
+            {
+                ( ( _cellularSecureSocket_t * ) pxFds[ i ].xSocket )->xPollTask = NULL;
+            }
+        }
+    }
+
+    return retPoll;
+}
+
+/*-----------------------------------------------------------*/
+
 /* Standard secure socket api implementation. */
 /* coverity[misra_c_2012_rule_8_7_violation] */
 int32_t SOCKETS_Send( Socket_t xSocket,
@@ -1604,6 +1799,13 @@ int32_t SOCKETS_Close( Socket_t xSocket )
             pCellularSocketContext->cellularSocketHandle = NULL;
         }
 
+        /* No data ready events arrive any more; drop a pending wake up callback. */
+        if( pCellularSocketContext->pxWakeupCallback != NULL )
+        {
+            pCellularSocketContext->pxWakeupCallback = NULL;
+            ( void ) Platform_WorkCancel( &pCellularSocketContext->xWakeupWork );
+        }
+
         if( pCellularSocketContext->pcDestination != NULL )
         {
             vPortFree( pCellularSocketContext->pcDestination );
@@ -1684,6 +1886,10 @@ int32_t SOCKETS_SetSockOpt( Socket_t xSocket,
                 prvSetupSocketUdpService( pCellularSocketContext, pvOptionValue );
                 break;
 
+            case SOCKETS_SO_WAKEUP_CALLBACK:
+                prvSetupSocketWakeupCallback( pCellularSocketContext, pvOptionValue );
+                break;
+
             default:
                 retSetSockOpt = SOCKETS_ENOPROTOOPT;
                 break;
@@ -97,7 +97,7 @@
 #define configUSE_PREEMPTION                         1
 #define configUSE_IDLE_HOOK                          1
 #define configUSE_TICK_HOOK                          0
-#define configUSE_TICKLESS_IDLE                      0
+#define configUSE_TICKLESS_IDLE                      1
 #define configUSE_DAEMON_TASK_STARTUP_HOOK           1
 #define configCPU_CLOCK_HZ                           ( SystemCoreClock )
 #define configTICK_RATE_HZ                           ( ( TickType_t ) 1000 )
@@ -121,6 +121,26 @@
 #define configUSE_POSIX_ERRNO                        1
 #define configSUPPORT_DYNAMIC_ALLOCATION             1
 
+/* Heap (Core/Src/heap_pool.c): size classes as { largest request in bytes,
+ * number of blocks } served from dedicated pools, and log2 of the largest
+ * block of the general region. */
+#define configHEAP_POOL_CLASSES                      { { 16, 48 }, { 32, 32 }, { 64, 16 }, { 128, 8 } }
+#define configHEAP_POOL_MAX_BLOCK_LOG2               ( 16U )
+
+/* Tickless idle (Core/Src/low_power.c). The SysTick runs from HCLK / 8 so that
+ * one SLEEP can suppress up to 1.6 s of ticks instead of 200 ms. While the
+ * modem is in PSM, STOP 2 suppresses the tick with the RTC wakeup timer
+ * instead, up to about 18.6 h (Core/Src/low_power_stm32l4.c). */
+#define configSYSTICK_CLOCK_HZ                       ( SystemCoreClock / 8UL )
+#if defined( __ICCARM__ ) || defined( __CC_ARM ) || defined( __GNUC__ )
+    void vLowPowerSuppressTicksAndSleep( uint32_t xExpectedIdleTime );
+    void vLowPowerPreSleepProcessing( uint32_t * pulIdleTime );
+    void vLowPowerPostSleepProcessing( uint32_t ulExpectedIdleTime );
+#endif
+#define portSUPPRESS_TICKS_AND_SLEEP( x )            vLowPowerSuppressTicksAndSleep( x )
+#define configPRE_SLEEP_PROCESSING( x )              vLowPowerPreSleepProcessing( &( x ) )
+#define configPOST_SLEEP_PROCESSING( x )             vLowPowerPostSleepProcessing( x )
+
 
 
 /* Co-routine definitions. */
@@ -201,6 +221,10 @@ extern void vLoggingPrint( const char * pcMessage );
  * also defines the maximum length of each log message. */
 #define configLOGGING_MAX_MESSAGE_LENGTH            128
 
+/* Number of statically allocated message slots shared with the logging task.
+ * Messages logged while every slot is in use are dropped and counted. */
+#define configLOGGING_MAX_QUEUE_LENGTH              16
+
 /* Set to 1 to prepend each log message with a message number, the task name,
  * and a time stamp. */
 #define configLOGGING_INCLUDE_TIME_AND_TASK_NAME    1
@@ -56,10 +56,10 @@
 /**
  * @brief Stack depth for the task that runs the receive callback function
  *
- * When SOCKETS_SetSockOpt() is called with SOCKETS_SO_WAKEUP_CALLBACK and
- * a function pointer, a task is created to run the callback each time the
- * socket becomes ready.  This is the number of words (not bytes!) to allocate
- * for use as the task�s stack.
+ * Not used by the cellular secure sockets. The callback set with
+ * SOCKETS_SetSockOpt() and SOCKETS_SO_WAKEUP_CALLBACK runs on the platform
+ * work pool (see PLATFORM_WORKPOOL_STACK_SIZE in cellular_platform.h) each
+ * time the socket becomes ready, without creating a task.
  */
 #define socketsconfigRECEIVE_CALLBACK_TASK_STACK_DEPTH    ( 1024U )
 
@@ -0,0 +1,57 @@
+/*
+ * heap_pool.h
+ *
+ *  Statistics of the FreeRTOS heap implementation in Core/Src/heap_pool.c.
+ *
+ *  1NCE GmbH
+ */
+
+#ifndef HEAP_POOL_H
+#define HEAP_POOL_H
+
+#include <stddef.h>
+
+/**
+ * @brief Maximum number of size classes in configHEAP_POOL_CLASSES.
+ */
+#define heapPOOL_MAX_CLASSES    ( 8 )
+
+/**
+ * @brief Usage of one size class pool.
+ */
+typedef struct HeapPoolClassStats
+{
+    size_t xBlockSize;     /**< Largest request served by the class, in bytes. */
+    size_t xBlockCount;    /**< Number of blocks reserved for the class. */
+    size_t xBlocksInUse;   /**< Blocks currently allocated. */
+    size_t xHighWaterMark; /**< Most blocks ever allocated at the same time. */
+    size_t xSpills;        /**< Requests served by the general region because the pool was empty. */
+    size_t xFailures;      /**< Requests of this class that could not be served at all. */
+} HeapPoolClassStats_t;
+
+/**
+ * @brief Usage of the whole heap.
+ */
+typedef struct HeapPoolStats
+{
+    HeapPoolClassStats_t xClasses[ heapPOOL_MAX_CLASSES ];
+    size_t xClassCount;               /**< Valid entries in xClasses. */
+    size_t xRegionFreeBytes;          /**< Free bytes in the general region. */
+    size_t xRegionLargestFreeBlock;   /**< Largest free block of the general region, without its header. */
+    size_t xRegionFreeBlocks;         /**< Number of free blocks in the general region. */
+    size_t xRegionFragmentation;      /**< 100 - largest free block * 100 / free bytes, in percent. */
+    size_t xRegionFailures;           /**< Requests larger than every class that could not be served. */
+    size_t xMinimumEverFreeBytes;     /**< Lowest free heap size since boot, pools included. */
+} HeapPoolStats_t;
+
+/**
+ * @brief Read the usage of the size class pools and of the general region.
+ *
+ * Walks the free lists of the general region, so it is meant for diagnostics
+ * and not for the allocation path.
+ *
+ * @param[out] pxStats: Filled with the current statistics.
+ */
+void vPortGetHeapPoolStats( HeapPoolStats_t * pxStats );
+
+#endif /* HEAP_POOL_H */
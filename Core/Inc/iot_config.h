@@ -41,6 +41,10 @@
 #define IOT_LOG_LEVEL_LwM2M           IOT_LOG_INFO
 #define IOT_LOG_LEVEL_TASKPOOL        IOT_LOG_NONE
 
+/* Format IotLog messages in a low priority task instead of the calling task.
+ * Keeps UART time out of the cellular and network paths. */
+#define IOT_LOG_DEFERRED              ( 1 )
+
 
 /* Platform thread stack size and priority. */
 #define IOT_THREAD_DEFAULT_STACK_SIZE    500  /* at least for aws_tests. Otherwise, 1500? */
@@ -52,6 +52,39 @@
 /* Logging puts function. */
 #define IotLogging_Puts( str )    configPRINTF( ( "%s\r\n", str ) )
 
+/* Log messages are formatted once, straight into a message slot of the logging
+ * task (iot_logging_task_dynamic_buffers.c), instead of into a heap buffer. */
+extern char * pcLoggingReserveMessage( size_t * pxLength,
+                                       size_t * pxSize );
+extern void vLoggingSendMessage( char * pcMessage );
+#define IotLogging_ReserveLine( pLength, pSize )    pcLoggingReserveMessage( pLength, pSize )
+#define IotLogging_SendLine( pLine )                vLoggingSendMessage( pLine )
+
+/* Deferred logging ring configuration. Only used when IOT_LOG_DEFERRED is 1. */
+#ifndef IOT_LOG_DEFERRED_QUEUE_LENGTH
+    #define IOT_LOG_DEFERRED_QUEUE_LENGTH       ( 16 )  /* Records; must be a power of 2. */
+#endif
+#ifndef IOT_LOG_DEFERRED_MAX_ARGS
+    #define IOT_LOG_DEFERRED_MAX_ARGS           ( 8 )   /* Arguments captured per record. */
+#endif
+#ifndef IOT_LOG_DEFERRED_STRING_BYTES
+    #define IOT_LOG_DEFERRED_STRING_BYTES       ( 64 )  /* Bytes for copies of %s arguments per record. */
+#endif
+#ifndef IOT_LOG_DEFERRED_LINE_LENGTH
+    #define IOT_LOG_DEFERRED_LINE_LENGTH        ( 160 ) /* Longest printed line without a logging task. */
+#endif
+
+/* Cellular performance counters (platform/iot_metrics.h). */
+#ifndef IOT_METRICS_CELLULAR_ENABLED
+    #define IOT_METRICS_CELLULAR_ENABLED         ( 1 )
+#endif
+#ifndef IOT_METRICS_CELLULAR_URC_TOKENS
+    #define IOT_METRICS_CELLULAR_URC_TOKENS      ( 12 ) /* Distinct URC tokens counted; the rest go to "other". */
+#endif
+#ifndef IOT_METRICS_CELLULAR_LWM2M_OBJECT
+    #define IOT_METRICS_CELLULAR_LWM2M_OBJECT    ( 0 )  /* Register the counters as an LwM2M object in the demo. */
+#endif
+
 /* Enable asserts in libraries. */
 #define IOT_METRICS_ENABLE_ASSERTS       ( 1 )
 #define IOT_CONTAINERS_ENABLE_ASSERTS    ( 1 )
@@ -51,6 +51,9 @@
 
 /* Set the library name to print with the demos. */
 #define LIBRARY_LOG_NAME    ( "DEMO" )
+#ifndef LIBRARY_LOG_MODULE
+    #define LIBRARY_LOG_MODULE    IOT_LOG_MODULE_DEMO
+#endif
 
 /* Include the logging setup header. This enables the logs. */
 #include "iot_logging_setup.h"
@@ -0,0 +1,138 @@
+/*
+ * low_power.h
+ *
+ *  Low power policy of the tickless idle mode (Core/Src/low_power.c). It
+ *  decides how deep the MCU may sleep from what it knows about the modem.
+ *
+ *  1NCE GmbH
+ */
+
+#ifndef LOW_POWER_H
+#define LOW_POWER_H
+
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+
+/* Time the network keeps the connection after the last traffic before it
+ * releases the modem to idle mode (RRC inactivity timer). */
+#ifndef configLOW_POWER_RELEASE_MS
+    #define configLOW_POWER_RELEASE_MS     ( 20000UL )
+#endif
+
+/* STOP 2 is not worth its clock restart for shorter idle periods. */
+#ifndef configLOW_POWER_STOP_MIN_MS
+    #define configLOW_POWER_STOP_MIN_MS    ( 10UL )
+#endif
+
+/**
+ * @brief Sleep modes the policy chooses from.
+ */
+typedef enum LowPowerMode
+{
+    eLowPowerSleep = 0, /**< CPU clock stopped, every interrupt (modem UART included) wakes up. */
+    eLowPowerStop       /**< STOP 2, only the RTC and the modem RI line wake up. */
+} LowPowerMode_t;
+
+/**
+ * @brief Phases of the modem between two periods of traffic.
+ */
+typedef enum LowPowerModemState
+{
+    eLowPowerModemConnected = 0, /**< Connected, a transfer needs no extra signalling. */
+    eLowPowerModemIdle,          /**< Reachable in idle mode, a transfer sets up a connection. */
+    eLowPowerModemPsm            /**< In PSM, a transfer wakes the radio up. */
+} LowPowerModemState_t;
+
+/**
+ * @brief Called when traffic finds the modem outside the connected phase.
+ */
+typedef void ( * LowPowerModemWakeCallback_t )( void );
+
+/**
+ * @brief Time spent in the low power modes since boot.
+ */
+typedef struct LowPowerStats
+{
+    uint32_t ulWakeups;       /**< Number of tickless sleeps, in any mode. */
+    uint32_t ulStopEntries;   /**< Number of those spent in STOP 2. */
+    uint32_t ulSleepTicks;    /**< Ticks spent in SLEEP. */
+    uint32_t ulStopTicks;     /**< Ticks spent in STOP 2. */
+} LowPowerStats_t;
+
+/**
+ * @brief Publish the power saving timers granted by the network.
+ *
+ * @param[in] ulTauSeconds: Periodic TAU (T3412), 0 when PSM is not in use.
+ * @param[in] ulActiveSeconds: Active time (T3324) spent reachable in idle mode
+ * before the modem enters PSM.
+ */
+void vLowPowerSetModemTimers( uint32_t ulTauSeconds,
+                              uint32_t ulActiveSeconds );
+
+/**
+ * @brief Record traffic on the modem interface.
+ *
+ * The modem is reachable, and may send URCs, from the last traffic until it
+ * has released the connection and the active time has run out. Called by the
+ * comm interface for every transfer. Must not be called from an interrupt.
+ */
+void vLowPowerNotifyModemActivity( void );
+
+/**
+ * @brief Estimate the phase the modem is in.
+ *
+ * Every periodic TAU is taken as a wake up of the modem, like traffic.
+ *
+ * @param[in] xNow: Current tick count.
+ * @param[out] pxTimeLeft: Ticks until the phase ends, portMAX_DELAY when it
+ * only ends with traffic. May be NULL.
+ *
+ * @return The phase of the modem.
+ */
+LowPowerModemState_t eLowPowerGetModemState( TickType_t xNow,
+                                             TickType_t * pxTimeLeft );
+
+/**
+ * @brief Register the function called when traffic wakes the modem up.
+ *
+ * The callback runs in the task that reported the traffic through
+ * vLowPowerNotifyModemActivity() and must not block.
+ *
+ * @param[in] xCallback: Function to call, NULL to remove it.
+ */
+void vLowPowerSetModemWakeCallback( LowPowerModemWakeCallback_t xCallback );
+
+/**
+ * @brief Choose the sleep mode for an idle period.
+ *
+ * STOP 2 is only chosen while the modem is in PSM. The sleep is then cut
+ * short at the next periodic TAU, so the MCU is back in SLEEP, where the
+ * modem UART wakes it up, whenever the modem can talk.
+ *
+ * @param[in] xNow: Current tick count.
+ * @param[in,out] pxIdleTime: Ticks the kernel expects to stay idle. Reduced
+ * to the end of the PSM window when STOP 2 is chosen.
+ *
+ * @return The mode to sleep in.
+ */
+LowPowerMode_t eLowPowerSelectMode( TickType_t xNow,
+                                    TickType_t * pxIdleTime );
+
+/**
+ * @brief Account one tickless sleep in the statistics.
+ *
+ * @param[in] eMode: Mode that was used.
+ * @param[in] xSleptTicks: Ticks the MCU actually slept.
+ */
+void vLowPowerRecordSleep( LowPowerMode_t eMode,
+                           TickType_t xSleptTicks );
+
+/**
+ * @brief Read the low power statistics.
+ *
+ * @param[out] pxStats: Filled with the statistics since boot.
+ */
+void vLowPowerGetStats( LowPowerStats_t * pxStats );
+
+#endif /* LOW_POWER_H */
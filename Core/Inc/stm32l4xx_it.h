@@ -58,6 +58,7 @@ void USART2_IRQHandler( void );
 void TIM6_DAC_IRQHandler( void );
 /* USER CODE BEGIN EFP */
 void EXTI2_IRQHandler( void );
+void RTC_WKUP_IRQHandler( void );
 /* USER CODE END EFP */
 
 #ifdef __cplusplus
@@ -0,0 +1,45 @@
+/*
+ * uplink_scheduler.h
+ *
+ *  Periodic uplinks timed to the wake ups of the modem (Core/Src/
+ *  uplink_scheduler.c).
+ *
+ *  1NCE GmbH
+ */
+
+#ifndef UPLINK_SCHEDULER_H
+#define UPLINK_SCHEDULER_H
+
+#include "FreeRTOS.h"
+
+/**
+ * @brief Set up the scheduler. Call once before the scheduler starts.
+ */
+void vUplinkSchedulerInit( void );
+
+/**
+ * @brief Wait for the next periodic uplink, like vTaskDelayUntil().
+ *
+ * The uplink is due xPeriod after *pxPreviousWakeTime but may go out up to
+ * xSlack earlier or later. Within that window it is released as soon as the
+ * modem is connected anyway, because of other traffic or a periodic TAU, so
+ * that it does not wake the radio on its own. Without such a wake it goes
+ * out when due, unless the modem is in PSM and its next TAU falls within the
+ * window.
+ *
+ * A task that falls behind by more than the slack, e.g. after a failed
+ * send, starts counting the period again from now.
+ *
+ * @param[in,out] pxPreviousWakeTime: Due time of the previous uplink, updated
+ * to the due time of this one. Initialise with xTaskGetTickCount().
+ * @param[in] xPeriod: Period of the uplink in ticks.
+ * @param[in] xSlack: Ticks the uplink may move, at most half the period.
+ *
+ * @return pdTRUE if the modem was connected when the uplink was released,
+ * pdFALSE if the uplink wakes it up.
+ */
+BaseType_t xUplinkSchedulerDelayUntil( TickType_t * pxPreviousWakeTime,
+                                       TickType_t xPeriod,
+                                       TickType_t xSlack );
+
+#endif /* UPLINK_SCHEDULER_H */
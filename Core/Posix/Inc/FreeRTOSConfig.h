@@ -0,0 +1,128 @@
+/*
+ * FreeRTOSConfig.h
+ *
+ *  Kernel configuration of the POSIX host build. It mirrors
+ *  Core/Inc/FreeRTOSConfig.h where the application depends on it and drops the
+ *  Cortex-M specific settings.
+ *
+ *  1NCE GmbH
+ */
+
+#ifndef FREERTOS_CONFIG_H
+#define FREERTOS_CONFIG_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define configSUPPORT_STATIC_ALLOCATION              1
+#define configKERNEL_PROVIDED_STATIC_MEMORY          1
+
+#define configUSE_PREEMPTION                         1
+#define configUSE_IDLE_HOOK                          1
+#define configUSE_TICK_HOOK                          0
+#define configUSE_TICKLESS_IDLE                      0
+#define configUSE_DAEMON_TASK_STARTUP_HOOK           1
+#define configTICK_RATE_HZ                           ( ( TickType_t ) 1000 )
+#define configMAX_PRIORITIES                         ( 7 )
+#define configTOTAL_HEAP_SIZE                        ( ( size_t ) ( 2 * 1024 * 1024 ) )
+#define configMAX_TASK_NAME_LEN                      ( 16 )
+#define configUSE_TRACE_FACILITY                     1
+#define configUSE_16_BIT_TICKS                       0
+#define configIDLE_SHOULD_YIELD                      1
+#define configUSE_MUTEXES                            1
+#define configQUEUE_REGISTRY_SIZE                    8
+#define configCHECK_FOR_STACK_OVERFLOW               0
+#define configUSE_RECURSIVE_MUTEXES                  1
+#define configUSE_MALLOC_FAILED_HOOK                 1
+#define configUSE_APPLICATION_TASK_TAG               1
+#define configUSE_COUNTING_SEMAPHORES                1
+#define configGENERATE_RUN_TIME_STATS                0
+#define configRECORD_STACK_HIGH_ADDRESS              1
+#define configUSE_POSIX_ERRNO                        1
+#define configSUPPORT_DYNAMIC_ALLOCATION             1
+
+/* Same size classes as the firmware (Core/Src/heap_pool.c). The single host
+ * heap region needs larger blocks than the on-chip RAM. */
+#define configHEAP_POOL_CLASSES                      { { 16, 48 }, { 32, 32 }, { 64, 16 }, { 128, 8 } }
+#define configHEAP_POOL_MAX_BLOCK_LOG2               ( 22U )
+
+/* Stack depths are in words. The application scales configMINIMAL_STACK_SIZE
+ * and passes the result through uint16_t parameters, so it stays well below
+ * 64K words while still covering PTHREAD_STACK_MIN on 64-bit hosts. */
+#define configMINIMAL_STACK_SIZE                     ( ( uint16_t ) 4096 )
+
+/* Co-routine definitions. */
+#define configUSE_CO_ROUTINES                        0
+#define configMAX_CO_ROUTINE_PRIORITIES              ( 2 )
+
+/* Software timer definitions. */
+#define configUSE_TIMERS                             1
+#define configTIMER_TASK_PRIORITY                    ( configMAX_PRIORITIES - 2 )
+#define configTIMER_QUEUE_LENGTH                     10
+#define configTIMER_TASK_STACK_DEPTH                 ( configMINIMAL_STACK_SIZE * 2 )
+
+/* Set the following definitions to 1 to include the API function, or zero
+ * to exclude the API function. */
+#define INCLUDE_vTaskPrioritySet                     1
+#define INCLUDE_uxTaskPriorityGet                    1
+#define INCLUDE_vTaskDelete                          1
+#define INCLUDE_vTaskCleanUpResources                0
+#define INCLUDE_vTaskSuspend                         1
+#define INCLUDE_vTaskDelayUntil                      1
+#define INCLUDE_vTaskDelay                           1
+#define INCLUDE_xTaskGetSchedulerState               1
+#define INCLUDE_xSemaphoreGetMutexHolder             1
+#define INCLUDE_xTimerPendFunctionCall               1
+
+/* Stop on the first failed assertion, the host build is meant for debugging. */
+extern void vAssertCalled( const char * pcFile,
+                           unsigned long ulLine );
+#define configASSERT( x )    if( ( x ) == 0 ) vAssertCalled( __FILE__, __LINE__ )
+
+/* Allocation trace replayed by Tools/heap_bench, written to the file named by
+ * the NCE_HEAP_TRACE environment variable (Core/Posix/Src/heap_trace.c). */
+extern void vHeapTraceMalloc( void * pvAddress,
+                              size_t xSize );
+extern void vHeapTraceFree( void * pvAddress,
+                            size_t xSize );
+#define traceMALLOC( pvAddress, uiSize )    vHeapTraceMalloc( pvAddress, uiSize )
+#define traceFREE( pvAddress, uiSize )      vHeapTraceFree( pvAddress, uiSize )
+
+/* The function that implements FreeRTOS printf style output, and the macro
+ * that maps the configPRINTF() macros to that function. */
+void vLoggingPrintf( const char * pcFormat,
+                     ... );
+
+/* Logging task definitions. */
+extern void vMainUARTPrintString( char * pcString );
+
+/* Map the FreeRTOS printf() to the logging task printf. */
+#define configPRINTF( X )    vLoggingPrintf X
+
+/* Non-format version print. */
+extern void vLoggingPrint( const char * pcMessage );
+#define configPRINT( X )           vLoggingPrint( X )
+
+/* Map the logging task's printf to standard output. */
+#define configPRINT_STRING( x )    vMainUARTPrintString( x );
+
+/* Sets the length of the buffers into which logging messages are written. */
+#define configLOGGING_MAX_MESSAGE_LENGTH            128
+
+/* Number of statically allocated message slots shared with the logging task.
+ * Messages logged while every slot is in use are dropped and counted. */
+#define configLOGGING_MAX_QUEUE_LENGTH              16
+
+/* Set to 1 to prepend each log message with a message number, the task name,
+ * and a time stamp. */
+#define configLOGGING_INCLUDE_TIME_AND_TASK_NAME    1
+
+/* Pseudo random number generator, just used by demos so does not have to be
+ * secure. */
+extern int iMainRand32( void );
+#define configRAND32()    iMainRand32()
+
+/* The platform FreeRTOS is running on. */
+#define configPLATFORM_NAME    "POSIX"
+
+#endif /* FREERTOS_CONFIG_H */
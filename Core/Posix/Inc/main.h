@@ -0,0 +1,56 @@
+/*
+ * main.h
+ *
+ *  Host replacement of Core/Inc/main.h. Only the HAL flash calls used by
+ *  nce_psk_cache.c are provided; they operate on a RAM page that main_posix.c
+ *  loads from and saves to a file.
+ *
+ *  1NCE GmbH
+ */
+
+#ifndef __MAIN_H
+#define __MAIN_H
+
+#include <stdint.h>
+
+/* Simulated flash page backing the DTLS credential cache. */
+#define POSIX_FLASH_PAGE_SIZE           ( 2048U )
+extern uint8_t ucPosixFlashPage[ POSIX_FLASH_PAGE_SIZE ];
+
+#define FLASH_BASE                      ( ( uintptr_t ) ucPosixFlashPage )
+#define FLASH_BANK_SIZE                 ( POSIX_FLASH_PAGE_SIZE )
+#define FLASH_PAGE_SIZE                 ( POSIX_FLASH_PAGE_SIZE )
+#define NCE_PSK_CACHE_FLASH_ADDRESS     FLASH_BASE
+
+#define FLASH_BANK_1                    ( 1U )
+#define FLASH_BANK_2                    ( 2U )
+#define FLASH_TYPEERASE_PAGES           ( 0U )
+#define FLASH_TYPEPROGRAM_DOUBLEWORD    ( 0U )
+#define FLASH_FLAG_ALL_ERRORS           ( 0U )
+#define __HAL_FLASH_CLEAR_FLAG( flag )    ( ( void ) ( flag ) )
+
+typedef enum
+{
+    HAL_OK = 0x00U,
+    HAL_ERROR = 0x01U,
+    HAL_BUSY = 0x02U,
+    HAL_TIMEOUT = 0x03U
+} HAL_StatusTypeDef;
+
+typedef struct
+{
+    uint32_t TypeErase;
+    uint32_t Banks;
+    uint32_t Page;
+    uint32_t NbPages;
+} FLASH_EraseInitTypeDef;
+
+HAL_StatusTypeDef HAL_FLASH_Unlock( void );
+HAL_StatusTypeDef HAL_FLASH_Lock( void );
+HAL_StatusTypeDef HAL_FLASH_Program( uint32_t TypeProgram,
+                                     uintptr_t Address,
+                                     uint64_t Data );
+HAL_StatusTypeDef HAL_FLASHEx_Erase( FLASH_EraseInitTypeDef * pEraseInit,
+                                     uint32_t * PageError );
+
+#endif /* __MAIN_H */
@@ -0,0 +1,78 @@
+/*
+ * heap_trace.c
+ *
+ *  Records every pvPortMalloc() and vPortFree() of the host build to the file
+ *  named by NCE_HEAP_TRACE, one "m <address> <size>" or "f <address>" line per
+ *  call. Tools/heap_bench replays such a trace against the heap
+ *  implementations. Nothing is written when the variable is not set.
+ *
+ *  1NCE GmbH
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "FreeRTOS.h"
+
+#define heapTRACE_FILE_ENV    "NCE_HEAP_TRACE"
+
+static FILE * pxTraceFile = NULL;
+static BaseType_t xTraceOpened = pdFALSE;
+
+/*-----------------------------------------------------------*/
+
+static FILE * prvTraceFile( void )
+{
+    const char * pcFile;
+
+    /* Both hooks run with the scheduler suspended, so no locking is needed. */
+    if( xTraceOpened == pdFALSE )
+    {
+        xTraceOpened = pdTRUE;
+        pcFile = getenv( heapTRACE_FILE_ENV );
+
+        if( pcFile != NULL )
+        {
+            pxTraceFile = fopen( pcFile, "w" );
+
+            /* The host build is usually stopped with a signal, keep the
+             * trace complete up to that point. */
+            if( pxTraceFile != NULL )
+            {
+                ( void ) setvbuf( pxTraceFile, NULL, _IOLBF, 0 );
+            }
+        }
+    }
+
+    return pxTraceFile;
+}
+
+/*-----------------------------------------------------------*/
+
+void vHeapTraceMalloc( void * pvAddress,
+                       size_t xSize )
+{
+    FILE * pxFile = prvTraceFile();
+
+    if( pxFile != NULL )
+    {
+        ( void ) fprintf( pxFile, "m %p %lu\n", pvAddress, ( unsigned long ) xSize );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+void vHeapTraceFree( void * pvAddress,
+                     size_t xSize )
+{
+    FILE * pxFile = prvTraceFile();
+
+    ( void ) xSize;
+
+    if( pxFile != NULL )
+    {
+        ( void ) fprintf( pxFile, "f %p\n", pvAddress );
+    }
+}
+
+/*-----------------------------------------------------------*/
@@ -0,0 +1,317 @@
+/*
+ * main_posix.c
+ *
+ *  Entry point of the POSIX host build. It replaces Core/Src/main.c, the
+ *  CubeMX peripheral setup and the console UART with their host equivalents
+ *  and then starts the same cellular demo as the firmware.
+ *
+ *  1NCE GmbH
+ */
+
+#include "iot_config.h"
+
+/* Standard includes. */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "main.h"
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+/* Demo Includes*/
+#include "cellular_app.h"
+#include "cellular_platform.h"
+#include "uplink_scheduler.h"
+
+#if ( IOT_LOG_DEFERRED == 1 )
+    #include "iot_logging_deferred.h"
+#endif
+
+#define MAX_RETRY_ATTEMPTS                      5     /* Maximum number of retries */
+#define RETRY_DELAY_MS                          10000 /* Delay between retry attempts in milliseconds */
+
+#define mainLOGGING_TASK_PRIORITY               ( configMAX_PRIORITIES - 1 )
+#define mainLOGGING_TASK_STACK_SIZE             ( configMINIMAL_STACK_SIZE * 4 )
+#define mainLOGGING_MESSAGE_QUEUE_LENGTH        ( 15 )
+#define main_RUNNER_TASK_STACK_SIZE             ( configMINIMAL_STACK_SIZE * 8 )
+
+#define mainLOGGING_DEFERRED_TASK_PRIORITY      ( tskIDLE_PRIORITY + 1 )
+#define mainLOGGING_DEFERRED_TASK_STACK_SIZE    ( configMINIMAL_STACK_SIZE * 4 )
+
+/* File the simulated flash page is persisted in, so that cached DTLS
+ * credentials survive a restart like they do on the board. */
+#define mainFLASH_FILE_ENV                      "NCE_FLASH_FILE"
+#define mainFLASH_FILE_DEFAULT                  "nce_flash.bin"
+
+/* The idle task would otherwise keep one host core busy. */
+#define mainIDLE_SLEEP_US                       ( 1000 )
+
+void vApplicationDaemonTaskStartupHook( void );
+extern void RunDemoTask( void );
+extern int setupCellular( void );
+
+/**********************
+* Global Variables
+**********************/
+uint8_t payload_selector;
+
+int32_t delay_publish = 60 * 1000;
+
+uint8_t ucPosixFlashPage[ POSIX_FLASH_PAGE_SIZE ];
+
+
+/*-----------------------------------------------------------*/
+
+static const char * prvFlashFile( void )
+{
+    const char * pcFile = getenv( mainFLASH_FILE_ENV );
+
+    return ( pcFile != NULL ) ? pcFile : mainFLASH_FILE_DEFAULT;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvLoadFlash( void )
+{
+    FILE * pxFile = fopen( prvFlashFile(), "rb" );
+
+    /* Erased flash reads as 0xFF. */
+    ( void ) memset( ucPosixFlashPage, 0xFF, sizeof( ucPosixFlashPage ) );
+
+    if( pxFile != NULL )
+    {
+        ( void ) fread( ucPosixFlashPage, 1, sizeof( ucPosixFlashPage ), pxFile );
+        ( void ) fclose( pxFile );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static HAL_StatusTypeDef prvSaveFlash( void )
+{
+    HAL_StatusTypeDef xStatus = HAL_ERROR;
+    FILE * pxFile = fopen( prvFlashFile(), "wb" );
+
+    if( pxFile != NULL )
+    {
+        if( fwrite( ucPosixFlashPage, 1, sizeof( ucPosixFlashPage ), pxFile ) == sizeof( ucPosixFlashPage ) )
+        {
+            xStatus = HAL_OK;
+        }
+
+        ( void ) fclose( pxFile );
+    }
+
+    return xStatus;
+}
+
+/*-----------------------------------------------------------*/
+
+HAL_StatusTypeDef HAL_FLASH_Unlock( void )
+{
+    return HAL_OK;
+}
+
+/*-----------------------------------------------------------*/
+
+HAL_StatusTypeDef HAL_FLASH_Lock( void )
+{
+    return HAL_OK;
+}
+
+/*-----------------------------------------------------------*/
+
+HAL_StatusTypeDef HAL_FLASH_Program( uint32_t TypeProgram,
+                                     uintptr_t Address,
+                                     uint64_t Data )
+{
+    uintptr_t offset = Address - FLASH_BASE;
+    uint8_t * pucTarget = &ucPosixFlashPage[ offset ];
+    uint64_t ullCurrent;
+
+    ( void ) TypeProgram;
+
+    if( ( offset > ( sizeof( ucPosixFlashPage ) - sizeof( Data ) ) ) || ( ( offset % sizeof( Data ) ) != 0U ) )
+    {
+        return HAL_ERROR;
+    }
+
+    /* Like the STM32L4, refuse to program a double word that is not erased. */
+    ( void ) memcpy( &ullCurrent, pucTarget, sizeof( ullCurrent ) );
+
+    if( ullCurrent != UINT64_MAX )
+    {
+        return HAL_ERROR;
+    }
+
+    ( void ) memcpy( pucTarget, &Data, sizeof( Data ) );
+
+    return prvSaveFlash();
+}
+
+/*-----------------------------------------------------------*/
+
+HAL_StatusTypeDef HAL_FLASHEx_Erase( FLASH_EraseInitTypeDef * pEraseInit,
+                                     uint32_t * PageError )
+{
+    if( ( pEraseInit == NULL ) || ( pEraseInit->Page != 0U ) || ( pEraseInit->NbPages != 1U ) )
+    {
+        return HAL_ERROR;
+    }
+
+    *PageError = UINT32_MAX;
+    ( void ) memset( ucPosixFlashPage, 0xFF, sizeof( ucPosixFlashPage ) );
+
+    return prvSaveFlash();
+}
+
+/*-----------------------------------------------------------*/
+
+/* Same heap implementation as the firmware (Core/Src/heap_pool.c), over a
+ * single region. */
+static void prvInitializeHeap( void )
+{
+    static uint8_t ucHeap[ configTOTAL_HEAP_SIZE ];
+
+    HeapRegion_t xHeapRegions[] =
+    {
+        { ucHeap, sizeof( ucHeap ) },
+        { NULL,   0                }
+    };
+
+    vPortDefineHeapRegions( xHeapRegions );
+}
+
+/*-----------------------------------------------------------*/
+
+static void CellularDemoTask( void * pvParameters )
+{
+    bool retCellular = true;
+    int retries = 0;
+
+    ( void ) pvParameters;
+
+    /* Setup cellular. */
+    retCellular = setupCellular();
+
+    /* Retry cellular setup with a maximum number of attempts */
+    while( ( retries < MAX_RETRY_ATTEMPTS ) && ( !retCellular ) )
+    {
+        vTaskDelay( pdMS_TO_TICKS( RETRY_DELAY_MS ) );
+        retCellular = setupCellular();
+        retries++;
+    }
+
+    /* There is no reset to recover from here, stop the process instead. */
+    if( !retCellular )
+    {
+        LogError( "Cellular setup failed, is the modem simulator running?\r\n" );
+        exit( EXIT_FAILURE );
+    }
+
+    LogInfo( "---- START DEMO : ----- .\r\n" );
+
+    RunDemoTask();
+
+    vTaskDelete( NULL );
+}
+
+/*-----------------------------------------------------------*/
+
+int main( void )
+{
+    /* Unbuffered so log lines interleave correctly with the simulator. */
+    ( void ) setvbuf( stdout, NULL, _IONBF, 0 );
+
+    prvLoadFlash();
+    prvInitializeHeap();
+
+    /* Create tasks that are not dependent on the Cellular being initialized. */
+    xLoggingTaskInitialize( mainLOGGING_TASK_STACK_SIZE,
+                            mainLOGGING_TASK_PRIORITY,
+                            mainLOGGING_MESSAGE_QUEUE_LENGTH );
+
+    #if ( IOT_LOG_DEFERRED == 1 )
+        xLoggingDeferredInitialize( mainLOGGING_DEFERRED_TASK_STACK_SIZE,
+                                    mainLOGGING_DEFERRED_TASK_PRIORITY );
+    #endif
+
+    /* Workers for the cellular library and the socket callbacks. */
+    ( void ) Platform_WorkPoolInit();
+
+    /* Periodic uplinks wait for the modem to wake up. */
+    vUplinkSchedulerInit();
+
+    vTaskStartScheduler();
+
+    return 0;
+}
+
+/*-----------------------------------------------------------*/
+
+void vApplicationDaemonTaskStartupHook( void )
+{
+    if( SYSTEM_Init() == pdPASS )
+    {
+        xTaskCreate( CellularDemoTask,            /* Function that implements the task. */
+                     "CellularDemo",              /* Text name for the task - only used for debugging. */
+                     main_RUNNER_TASK_STACK_SIZE, /* Size of stack (in words, not bytes) to allocate for the task. */
+                     NULL,                        /* Task parameter - not used in this case. */
+                     configMAX_PRIORITIES - 2,    /* Task priority, must be between 0 and configMAX_PRIORITIES - 1. */
+                     NULL );                      /* Used to pass out a handle to the created task - not used in this case. */
+    }
+    else
+    {
+        IotLogError( "System failed to initialize.\r\n" );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/* Psuedo random number generator.  Just used by demos so does not need to be
+ * secure. */
+int iMainRand32( void )
+{
+    static UBaseType_t uxlNextRand;
+    const uint32_t ulMultiplier = 0x015a4e35UL, ulIncrement = 1UL;
+
+    uxlNextRand = ( ulMultiplier * uxlNextRand ) + ulIncrement;
+
+    return( ( int ) ( uxlNextRand >> 16UL ) & 0x7fffUL );
+}
+
+/*-----------------------------------------------------------*/
+
+void vMainUARTPrintString( char * pcString )
+{
+    ( void ) fputs( pcString, stdout );
+}
+
+/*-----------------------------------------------------------*/
+
+void vAssertCalled( const char * pcFile,
+                    unsigned long ulLine )
+{
+    ( void ) fprintf( stderr, "ASSERT: %s:%lu\n", pcFile, ulLine );
+    abort();
+}
+
+/*-----------------------------------------------------------*/
+
+void vApplicationMallocFailedHook( void )
+{
+    ( void ) fputs( "ASSERT: FreeRTOS heap exhausted\n", stderr );
+    abort();
+}
+
+/*-----------------------------------------------------------*/
+
+void vApplicationIdleHook( void )
+{
+    ( void ) usleep( mainIDLE_SLEEP_US );
+}
+
+/*-----------------------------------------------------------*/
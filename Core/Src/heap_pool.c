@@ -0,0 +1,821 @@
+/*
+ * heap_pool.c
+ *
+ *  FreeRTOS heap implementation used in place of heap_5.c. It keeps the
+ *  heap_5 interface (vPortDefineHeapRegions() over non contiguous RAM) but
+ *  serves requests from two kinds of storage:
+ *
+ *  - Size class pools. Small requests (AT response lines, CoAP options, log
+ *    records, list nodes, ...) are taken from fixed size blocks carved out at
+ *    start up. A pool is a singly linked list of free blocks, so allocation
+ *    and release are a pointer swap and the blocks carry no header. Short
+ *    lived small objects therefore never punch holes in the memory used by
+ *    large ones. When a pool runs empty the request spills to the general
+ *    region.
+ *
+ *  - A general region for everything else (TLS contexts, stacks, transaction
+ *    buffers). Free blocks are kept in segregated lists indexed by a two level
+ *    bitmap (TLSF), which finds a fitting block with two bit scans instead of
+ *    the first fit walk of heap_5. Only when that fails is a single list
+ *    searched, so that the heap can still be filled up to its largest block. Blocks record their physical neighbour, so
+ *    freed blocks are merged with both neighbours in constant time.
+ *
+ *  vPortGetHeapPoolStats() reports per class usage, high water marks, spill
+ *  and failure counters and the fragmentation of the general region.
+ *
+ *  1NCE GmbH
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/* Defining MPU_WRAPPERS_INCLUDED_FROM_API_FILE prevents task.h from redefining
+ * all the API functions to use the MPU wrappers.  That should only be done when
+ * task.h is included from an application file. */
+#define MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#include "heap_pool.h"
+
+#if ( configSUPPORT_DYNAMIC_ALLOCATION == 0 )
+    #error This file must not be used if configSUPPORT_DYNAMIC_ALLOCATION is 0
+#endif
+
+#ifndef configHEAP_CLEAR_MEMORY_ON_FREE
+    #define configHEAP_CLEAR_MEMORY_ON_FREE    0
+#endif
+
+/* Size classes as { largest request in bytes, number of blocks }, smallest
+ * class first. */
+#ifndef configHEAP_POOL_CLASSES
+    #define configHEAP_POOL_CLASSES    { { 16, 48 }, { 32, 32 }, { 64, 16 }, { 128, 8 } }
+#endif
+
+/* Log2 of the largest block the general region can hold. Every heap region
+ * must be smaller than twice this size. */
+#ifndef configHEAP_POOL_MAX_BLOCK_LOG2
+    #define configHEAP_POOL_MAX_BLOCK_LOG2    ( 16U )
+#endif
+
+#if ( portBYTE_ALIGNMENT != 8 )
+    #error heap_pool.c expects portBYTE_ALIGNMENT to be 8
+#endif
+
+/* Largest size class supported by the size to class lookup table. */
+#define heapPOOL_MAX_CLASS_SIZE    ( ( size_t ) 256 )
+
+/* Marks sizes that no pool serves in ucPoolForSize. */
+#define heapNO_POOL                ( ( uint8_t ) 0xFF )
+
+/* Max value that fits in a size_t type. */
+#define heapSIZE_MAX               ( ~( ( size_t ) 0 ) )
+
+/* Check if multiplying a and b will result in overflow. */
+#define heapMULTIPLY_WILL_OVERFLOW( a, b )    ( ( ( a ) > 0 ) && ( ( b ) > ( heapSIZE_MAX / ( a ) ) ) )
+
+/* Check if adding a and b will result in overflow. */
+#define heapADD_WILL_OVERFLOW( a, b )         ( ( a ) > ( heapSIZE_MAX - ( b ) ) )
+
+#define heapALIGN_UP( x )                     ( ( ( x ) + portBYTE_ALIGNMENT_MASK ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK ) )
+
+/* Bit 0 of xBlockSize is set while the block belongs to the application. Block
+ * sizes are multiples of portBYTE_ALIGNMENT, so the bit is otherwise unused. */
+#define heapBLOCK_ALLOCATED_BIT               ( ( size_t ) 1 )
+#define heapBLOCK_SIZE( pxBlock )             ( ( pxBlock )->xBlockSize & ~heapBLOCK_ALLOCATED_BIT )
+#define heapBLOCK_IS_ALLOCATED( pxBlock )     ( ( ( pxBlock )->xBlockSize & heapBLOCK_ALLOCATED_BIT ) != 0U )
+#define heapNEXT_PHYSICAL_BLOCK( pxBlock )    ( ( HeapBlock_t * ) ( ( ( uint8_t * ) ( pxBlock ) ) + heapBLOCK_SIZE( pxBlock ) ) )
+
+/* The free lists of the general region are indexed by the position of the
+ * most significant bit of the block size (first level) and by the next
+ * heapSL_LOG2 bits (second level). Blocks smaller than heapSMALL_BLOCK_SIZE
+ * all share the first level 0, split in steps of portBYTE_ALIGNMENT. */
+#define heapSL_LOG2                           ( 3U )
+#define heapSL_COUNT                          ( 1U << heapSL_LOG2 )
+#define heapFL_SHIFT                          ( heapSL_LOG2 + 3U )
+#define heapSMALL_BLOCK_SIZE                  ( ( size_t ) 1 << heapFL_SHIFT )
+#define heapFL_COUNT                          ( configHEAP_POOL_MAX_BLOCK_LOG2 - heapFL_SHIFT + 2U )
+
+#if ( heapFL_COUNT > 32U )
+    #error configHEAP_POOL_MAX_BLOCK_LOG2 is too large for the first level bitmap
+#endif
+
+/*-----------------------------------------------------------*/
+
+/* Header of a block of the general region. Only the first two members are
+ * present while the block is allocated, the free list links overlay the
+ * application data once it is freed. */
+typedef struct HeapBlock
+{
+    size_t xBlockSize;                   /**< Size including the header, bit 0 set while allocated. */
+    struct HeapBlock * pxPrevPhysBlock;  /**< Block just below this one, NULL for the first block of a region. */
+    struct HeapBlock * pxNextFreeBlock;  /**< Next block in the same free list. */
+    struct HeapBlock * pxPrevFreeBlock;  /**< Previous block in the same free list. */
+} HeapBlock_t;
+
+typedef struct HeapPoolClassConfig
+{
+    size_t xBlockSize;
+    size_t xBlockCount;
+} HeapPoolClassConfig_t;
+
+typedef struct HeapPool
+{
+    uint8_t * pucStart;          /**< First block of the pool. */
+    uint8_t * pucEnd;            /**< End of the last block of the pool. */
+    void * pvFreeList;           /**< Free blocks, linked through their first word. */
+    HeapPoolClassStats_t xStats; /**< Usage reported by vPortGetHeapPoolStats(). */
+} HeapPool_t;
+
+/*-----------------------------------------------------------*/
+
+static void prvMapSize( size_t xSize,
+                        UBaseType_t * puxFirstLevel,
+                        UBaseType_t * puxSecondLevel ) PRIVILEGED_FUNCTION;
+static HeapBlock_t * prvFindFreeBlock( size_t xBlockSize ) PRIVILEGED_FUNCTION;
+static void prvInsertFreeBlock( HeapBlock_t * pxBlock ) PRIVILEGED_FUNCTION;
+static void prvRemoveFreeBlock( HeapBlock_t * pxBlock ) PRIVILEGED_FUNCTION;
+static void * prvRegionAllocate( size_t xWantedSize ) PRIVILEGED_FUNCTION;
+static size_t prvRegionFree( void * pv ) PRIVILEGED_FUNCTION;
+static void prvInitialisePools( void ) PRIVILEGED_FUNCTION;
+void vPortDefineHeapRegions( const HeapRegion_t * const pxHeapRegions ) PRIVILEGED_FUNCTION;
+
+/*-----------------------------------------------------------*/
+
+/* Size of the part of HeapBlock_t that stays in front of allocated memory. */
+static const size_t xHeapHeaderSize = heapALIGN_UP( offsetof( HeapBlock_t, pxNextFreeBlock ) );
+
+/* A free block must be able to hold the complete HeapBlock_t. */
+static const size_t xHeapMinimumBlockSize = heapALIGN_UP( sizeof( HeapBlock_t ) );
+
+static const HeapPoolClassConfig_t xPoolConfig[] = configHEAP_POOL_CLASSES;
+
+#define heapPOOL_CLASS_COUNT    ( sizeof( xPoolConfig ) / sizeof( xPoolConfig[ 0 ] ) )
+
+PRIVILEGED_DATA static HeapBlock_t * pxFreeLists[ heapFL_COUNT ][ heapSL_COUNT ];
+PRIVILEGED_DATA static uint32_t ulFirstLevelBitmap = 0U;
+PRIVILEGED_DATA static uint8_t ucSecondLevelBitmap[ heapFL_COUNT ];
+
+PRIVILEGED_DATA static HeapPool_t xPools[ heapPOOL_CLASS_COUNT ];
+PRIVILEGED_DATA static uint8_t ucPoolForSize[ heapPOOL_MAX_CLASS_SIZE / portBYTE_ALIGNMENT ];
+PRIVILEGED_DATA static uint8_t * pucPoolsStart = NULL;
+PRIVILEGED_DATA static uint8_t * pucPoolsEnd = NULL;
+
+/* Keeps track of the number of calls to allocate and free memory as well as the
+ * number of free bytes remaining, but says nothing about fragmentation. */
+PRIVILEGED_DATA static size_t xRegionFreeBytes = ( size_t ) 0U;
+PRIVILEGED_DATA static size_t xRegionFailures = ( size_t ) 0U;
+PRIVILEGED_DATA static size_t xFreeBytesRemaining = ( size_t ) 0U;
+PRIVILEGED_DATA static size_t xMinimumEverFreeBytesRemaining = ( size_t ) 0U;
+PRIVILEGED_DATA static size_t xNumberOfSuccessfulAllocations = ( size_t ) 0U;
+PRIVILEGED_DATA static size_t xNumberOfSuccessfulFrees = ( size_t ) 0U;
+PRIVILEGED_DATA static BaseType_t xHeapInitialised = pdFALSE;
+
+/*-----------------------------------------------------------*/
+
+/* Index of the most significant set bit. Compiles to CLZ on the Cortex-M4,
+ * block sizes never exceed 32 bits. */
+static UBaseType_t prvMostSignificantBit( size_t xValue )
+{
+    return ( UBaseType_t ) ( 31 - __builtin_clz( ( uint32_t ) xValue ) );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvMapSize( size_t xSize,
+                        UBaseType_t * puxFirstLevel,
+                        UBaseType_t * puxSecondLevel )
+{
+    UBaseType_t uxMsb;
+
+    if( xSize < heapSMALL_BLOCK_SIZE )
+    {
+        *puxFirstLevel = 0U;
+        *puxSecondLevel = ( UBaseType_t ) ( xSize / ( heapSMALL_BLOCK_SIZE / heapSL_COUNT ) );
+    }
+    else
+    {
+        uxMsb = prvMostSignificantBit( xSize );
+        *puxFirstLevel = uxMsb - heapFL_SHIFT + 1U;
+        *puxSecondLevel = ( UBaseType_t ) ( ( xSize >> ( uxMsb - heapSL_LOG2 ) ) ^ heapSL_COUNT );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static HeapBlock_t * prvFindFreeBlock( size_t xBlockSize )
+{
+    UBaseType_t uxFirstLevel;
+    UBaseType_t uxSecondLevel;
+    uint32_t ulFirstLevelMap;
+    uint32_t ulSecondLevelMap;
+    HeapBlock_t * pxBlock = NULL;
+    size_t xRoundedSize = xBlockSize;
+
+    /* Round up to the next list boundary, so that every block of the list
+     * found below is large enough. */
+    if( xBlockSize >= heapSMALL_BLOCK_SIZE )
+    {
+        xRoundedSize += ( ( size_t ) 1 << ( prvMostSignificantBit( xBlockSize ) - heapSL_LOG2 ) ) - 1U;
+    }
+
+    prvMapSize( xRoundedSize, &uxFirstLevel, &uxSecondLevel );
+
+    if( uxFirstLevel < heapFL_COUNT )
+    {
+        ulSecondLevelMap = ( uint32_t ) ucSecondLevelBitmap[ uxFirstLevel ] & ( ~0UL << uxSecondLevel );
+
+        if( ulSecondLevelMap == 0U )
+        {
+            /* Nothing left in this range, take the smallest larger range. */
+            ulFirstLevelMap = ( uxFirstLevel + 1U < 32U ) ? ( ulFirstLevelBitmap & ( ~0UL << ( uxFirstLevel + 1U ) ) ) : 0U;
+
+            if( ulFirstLevelMap != 0U )
+            {
+                uxFirstLevel = ( UBaseType_t ) __builtin_ctz( ulFirstLevelMap );
+                ulSecondLevelMap = ucSecondLevelBitmap[ uxFirstLevel ];
+            }
+        }
+
+        if( ulSecondLevelMap != 0U )
+        {
+            uxSecondLevel = ( UBaseType_t ) __builtin_ctz( ulSecondLevelMap );
+            pxBlock = pxFreeLists[ uxFirstLevel ][ uxSecondLevel ];
+        }
+    }
+
+    /* Rounding up skips the list the request itself maps to. Before giving up,
+     * look there for a block that is large enough, otherwise a request close
+     * to the largest free block would fail. */
+    if( pxBlock == NULL )
+    {
+        prvMapSize( xBlockSize, &uxFirstLevel, &uxSecondLevel );
+
+        if( uxFirstLevel < heapFL_COUNT )
+        {
+            for( pxBlock = pxFreeLists[ uxFirstLevel ][ uxSecondLevel ]; pxBlock != NULL; pxBlock = pxBlock->pxNextFreeBlock )
+            {
+                if( pxBlock->xBlockSize >= xBlockSize )
+                {
+                    break;
+                }
+            }
+        }
+    }
+
+    return pxBlock;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvInsertFreeBlock( HeapBlock_t * pxBlock )
+{
+    UBaseType_t uxFirstLevel;
+    UBaseType_t uxSecondLevel;
+    HeapBlock_t * pxHead;
+
+    prvMapSize( pxBlock->xBlockSize, &uxFirstLevel, &uxSecondLevel );
+
+    pxHead = pxFreeLists[ uxFirstLevel ][ uxSecondLevel ];
+    pxBlock->pxNextFreeBlock = pxHead;
+    pxBlock->pxPrevFreeBlock = NULL;
+
+    if( pxHead != NULL )
+    {
+        pxHead->pxPrevFreeBlock = pxBlock;
+    }
+
+    pxFreeLists[ uxFirstLevel ][ uxSecondLevel ] = pxBlock;
+    ulFirstLevelBitmap |= ( 1UL << uxFirstLevel );
+    ucSecondLevelBitmap[ uxFirstLevel ] |= ( uint8_t ) ( 1U << uxSecondLevel );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvRemoveFreeBlock( HeapBlock_t * pxBlock )
+{
+    UBaseType_t uxFirstLevel;
+    UBaseType_t uxSecondLevel;
+
+    prvMapSize( pxBlock->xBlockSize, &uxFirstLevel, &uxSecondLevel );
+
+    if( pxBlock->pxNextFreeBlock != NULL )
+    {
+        pxBlock->pxNextFreeBlock->pxPrevFreeBlock = pxBlock->pxPrevFreeBlock;
+    }
+
+    if( pxBlock->pxPrevFreeBlock != NULL )
+    {
+        pxBlock->pxPrevFreeBlock->pxNextFreeBlock = pxBlock->pxNextFreeBlock;
+    }
+    else
+    {
+        pxFreeLists[ uxFirstLevel ][ uxSecondLevel ] = pxBlock->pxNextFreeBlock;
+
+        if( pxBlock->pxNextFreeBlock == NULL )
+        {
+            ucSecondLevelBitmap[ uxFirstLevel ] &= ( uint8_t ) ~( 1U << uxSecondLevel );
+
+            if( ucSecondLevelBitmap[ uxFirstLevel ] == 0U )
+            {
+                ulFirstLevelBitmap &= ~( 1UL << uxFirstLevel );
+            }
+        }
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void * prvRegionAllocate( size_t xWantedSize )
+{
+    HeapBlock_t * pxBlock;
+    HeapBlock_t * pxRemainder;
+    size_t xBlockSize;
+
+    if( heapADD_WILL_OVERFLOW( xWantedSize, xHeapHeaderSize + portBYTE_ALIGNMENT_MASK ) != 0 )
+    {
+        return NULL;
+    }
+
+    xBlockSize = heapALIGN_UP( xWantedSize + xHeapHeaderSize );
+
+    if( xBlockSize < xHeapMinimumBlockSize )
+    {
+        xBlockSize = xHeapMinimumBlockSize;
+    }
+
+    pxBlock = prvFindFreeBlock( xBlockSize );
+
+    if( pxBlock == NULL )
+    {
+        return NULL;
+    }
+
+    prvRemoveFreeBlock( pxBlock );
+
+    /* Return the tail of the block to the free lists if it is large enough to
+     * be a block of its own. */
+    if( ( pxBlock->xBlockSize - xBlockSize ) >= xHeapMinimumBlockSize )
+    {
+        pxRemainder = ( HeapBlock_t * ) ( ( ( uint8_t * ) pxBlock ) + xBlockSize );
+        pxRemainder->xBlockSize = pxBlock->xBlockSize - xBlockSize;
+        pxRemainder->pxPrevPhysBlock = pxBlock;
+        heapNEXT_PHYSICAL_BLOCK( pxRemainder )->pxPrevPhysBlock = pxRemainder;
+        prvInsertFreeBlock( pxRemainder );
+    }
+    else
+    {
+        xBlockSize = pxBlock->xBlockSize;
+    }
+
+    pxBlock->xBlockSize = xBlockSize | heapBLOCK_ALLOCATED_BIT;
+    xRegionFreeBytes -= xBlockSize;
+
+    return ( ( uint8_t * ) pxBlock ) + xHeapHeaderSize;
+}
+
+/*-----------------------------------------------------------*/
+
+static size_t prvRegionFree( void * pv )
+{
+    HeapBlock_t * pxBlock = ( HeapBlock_t * ) ( ( ( uint8_t * ) pv ) - xHeapHeaderSize );
+    HeapBlock_t * pxNeighbour;
+    size_t xBlockSize;
+
+    configASSERT( heapBLOCK_IS_ALLOCATED( pxBlock ) );
+
+    xBlockSize = heapBLOCK_SIZE( pxBlock );
+    pxBlock->xBlockSize = xBlockSize;
+    xRegionFreeBytes += xBlockSize;
+
+    #if ( configHEAP_CLEAR_MEMORY_ON_FREE == 1 )
+    {
+        ( void ) memset( pv, 0, xBlockSize - xHeapHeaderSize );
+    }
+    #endif
+
+    /* Merge with the following block. The end marker of each region is
+     * allocated, so this never runs past the region. */
+    pxNeighbour = heapNEXT_PHYSICAL_BLOCK( pxBlock );
+
+    if( !heapBLOCK_IS_ALLOCATED( pxNeighbour ) )
+    {
+        prvRemoveFreeBlock( pxNeighbour );
+        pxBlock->xBlockSize += pxNeighbour->xBlockSize;
+    }
+
+    /* Merge with the preceding block. */
+    pxNeighbour = pxBlock->pxPrevPhysBlock;
+
+    if( ( pxNeighbour != NULL ) && !heapBLOCK_IS_ALLOCATED( pxNeighbour ) )
+    {
+        prvRemoveFreeBlock( pxNeighbour );
+        pxNeighbour->xBlockSize += pxBlock->xBlockSize;
+        pxBlock = pxNeighbour;
+    }
+
+    heapNEXT_PHYSICAL_BLOCK( pxBlock )->pxPrevPhysBlock = pxBlock;
+    prvInsertFreeBlock( pxBlock );
+
+    return xBlockSize;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvInitialisePools( void )
+{
+    size_t xTotalSize = 0U;
+    size_t xClass;
+    size_t xBlock;
+    size_t xIndex;
+    uint8_t * pucBlock;
+
+    for( xClass = 0U; xClass < heapPOOL_CLASS_COUNT; xClass++ )
+    {
+        configASSERT( ( xPoolConfig[ xClass ].xBlockSize % portBYTE_ALIGNMENT ) == 0U );
+        configASSERT( xPoolConfig[ xClass ].xBlockSize >= sizeof( void * ) );
+        configASSERT( xPoolConfig[ xClass ].xBlockSize <= heapPOOL_MAX_CLASS_SIZE );
+        configASSERT( ( xClass == 0U ) || ( xPoolConfig[ xClass ].xBlockSize > xPoolConfig[ xClass - 1U ].xBlockSize ) );
+
+        xTotalSize += xPoolConfig[ xClass ].xBlockSize * xPoolConfig[ xClass ].xBlockCount;
+    }
+
+    /* All pools share one block of the general region, so a single range check
+     * tells pool memory apart in vPortFree(). */
+    pucPoolsStart = ( xTotalSize > 0U ) ? prvRegionAllocate( xTotalSize ) : NULL;
+    configASSERT( ( xTotalSize == 0U ) || ( pucPoolsStart != NULL ) );
+    pucBlock = pucPoolsStart;
+
+    for( xClass = 0U; xClass < heapPOOL_CLASS_COUNT; xClass++ )
+    {
+        xPools[ xClass ].pucStart = pucBlock;
+        xPools[ xClass ].pvFreeList = NULL;
+        xPools[ xClass ].xStats.xBlockSize = xPoolConfig[ xClass ].xBlockSize;
+        xPools[ xClass ].xStats.xBlockCount = xPoolConfig[ xClass ].xBlockCount;
+
+        for( xBlock = 0U; ( pucBlock != NULL ) && ( xBlock < xPoolConfig[ xClass ].xBlockCount ); xBlock++ )
+        {
+            *( void ** ) pucBlock = xPools[ xClass ].pvFreeList;
+            xPools[ xClass ].pvFreeList = pucBlock;
+            pucBlock += xPoolConfig[ xClass ].xBlockSize;
+        }
+
+        xPools[ xClass ].pucEnd = pucBlock;
+    }
+
+    pucPoolsEnd = pucBlock;
+
+    /* Map every request size up to heapPOOL_MAX_CLASS_SIZE to the smallest
+     * class that holds it. */
+    xClass = 0U;
+
+    for( xIndex = 0U; xIndex < sizeof( ucPoolForSize ); xIndex++ )
+    {
+        while( ( xClass < heapPOOL_CLASS_COUNT ) && ( xPoolConfig[ xClass ].xBlockSize < ( ( xIndex + 1U ) * portBYTE_ALIGNMENT ) ) )
+        {
+            xClass++;
+        }
+
+        ucPoolForSize[ xIndex ] = ( xClass < heapPOOL_CLASS_COUNT ) ? ( uint8_t ) xClass : heapNO_POOL;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+void * pvPortMalloc( size_t xWantedSize )
+{
+    void * pvReturn = NULL;
+    HeapPool_t * pxPool = NULL;
+    size_t xAllocatedSize = 0U;
+    size_t xRegionFreeBefore;
+
+    /* The heap must be initialised before the first call to pvPortMalloc(). */
+    configASSERT( xHeapInitialised != pdFALSE );
+
+    vTaskSuspendAll();
+    {
+        if( xWantedSize > 0U )
+        {
+            if( ( xWantedSize <= heapPOOL_MAX_CLASS_SIZE ) &&
+                ( ucPoolForSize[ ( xWantedSize - 1U ) / portBYTE_ALIGNMENT ] != heapNO_POOL ) )
+            {
+                pxPool = &( xPools[ ucPoolForSize[ ( xWantedSize - 1U ) / portBYTE_ALIGNMENT ] ] );
+            }
+
+            if( ( pxPool != NULL ) && ( pxPool->pvFreeList != NULL ) )
+            {
+                pvReturn = pxPool->pvFreeList;
+                pxPool->pvFreeList = *( void ** ) pvReturn;
+                xAllocatedSize = pxPool->xStats.xBlockSize;
+                pxPool->xStats.xBlocksInUse++;
+
+                if( pxPool->xStats.xBlocksInUse > pxPool->xStats.xHighWaterMark )
+                {
+                    pxPool->xStats.xHighWaterMark = pxPool->xStats.xBlocksInUse;
+                }
+            }
+            else
+            {
+                if( pxPool != NULL )
+                {
+                    pxPool->xStats.xSpills++;
+                }
+
+                xRegionFreeBefore = xRegionFreeBytes;
+                pvReturn = prvRegionAllocate( xWantedSize );
+                xAllocatedSize = xRegionFreeBefore - xRegionFreeBytes;
+
+                if( pvReturn == NULL )
+                {
+                    if( pxPool != NULL )
+                    {
+                        pxPool->xStats.xFailures++;
+                    }
+                    else
+                    {
+                        xRegionFailures++;
+                    }
+                }
+            }
+
+            if( pvReturn != NULL )
+            {
+                xFreeBytesRemaining -= xAllocatedSize;
+
+                if( xFreeBytesRemaining < xMinimumEverFreeBytesRemaining )
+                {
+                    xMinimumEverFreeBytesRemaining = xFreeBytesRemaining;
+                }
+
+                xNumberOfSuccessfulAllocations++;
+            }
+        }
+
+        traceMALLOC( pvReturn, xWantedSize );
+    }
+    ( void ) xTaskResumeAll();
+
+    #if ( configUSE_MALLOC_FAILED_HOOK == 1 )
+    {
+        if( pvReturn == NULL )
+        {
+            vApplicationMallocFailedHook();
+        }
+    }
+    #endif
+
+    configASSERT( ( ( ( size_t ) pvReturn ) & ( size_t ) portBYTE_ALIGNMENT_MASK ) == 0 );
+    return pvReturn;
+}
+
+/*-----------------------------------------------------------*/
+
+void vPortFree( void * pv )
+{
+    uint8_t * puc = ( uint8_t * ) pv;
+    HeapPool_t * pxPool;
+    size_t xFreedSize;
+
+    if( pv != NULL )
+    {
+        vTaskSuspendAll();
+        {
+            if( ( puc >= pucPoolsStart ) && ( puc < pucPoolsEnd ) )
+            {
+                pxPool = &( xPools[ 0 ] );
+
+                while( puc >= pxPool->pucEnd )
+                {
+                    pxPool++;
+                }
+
+                configASSERT( ( ( size_t ) ( puc - pxPool->pucStart ) % pxPool->xStats.xBlockSize ) == 0U );
+                configASSERT( pxPool->xStats.xBlocksInUse > 0U );
+
+                xFreedSize = pxPool->xStats.xBlockSize;
+
+                #if ( configHEAP_CLEAR_MEMORY_ON_FREE == 1 )
+                {
+                    ( void ) memset( pv, 0, xFreedSize );
+                }
+                #endif
+
+                *( void ** ) pv = pxPool->pvFreeList;
+                pxPool->pvFreeList = pv;
+                pxPool->xStats.xBlocksInUse--;
+            }
+            else
+            {
+                xFreedSize = prvRegionFree( pv );
+            }
+
+            xFreeBytesRemaining += xFreedSize;
+            traceFREE( pv, xFreedSize );
+            xNumberOfSuccessfulFrees++;
+        }
+        ( void ) xTaskResumeAll();
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+size_t xPortGetFreeHeapSize( void )
+{
+    return xFreeBytesRemaining;
+}
+
+/*-----------------------------------------------------------*/
+
+size_t xPortGetMinimumEverFreeHeapSize( void )
+{
+    return xMinimumEverFreeBytesRemaining;
+}
+
+/*-----------------------------------------------------------*/
+
+void * pvPortCalloc( size_t xNum,
+                     size_t xSize )
+{
+    void * pv = NULL;
+
+    if( heapMULTIPLY_WILL_OVERFLOW( xNum, xSize ) == 0 )
+    {
+        pv = pvPortMalloc( xNum * xSize );
+
+        if( pv != NULL )
+        {
+            ( void ) memset( pv, 0, xNum * xSize );
+        }
+    }
+
+    return pv;
+}
+
+/*-----------------------------------------------------------*/
+
+void vPortDefineHeapRegions( const HeapRegion_t * const pxHeapRegions )
+{
+    const HeapRegion_t * pxHeapRegion;
+    HeapBlock_t * pxFirstBlock;
+    HeapBlock_t * pxEndMarker;
+    size_t xAddress;
+    size_t xSize;
+
+    /* Can only call once! */
+    configASSERT( xHeapInitialised == pdFALSE );
+
+    for( pxHeapRegion = pxHeapRegions; pxHeapRegion->xSizeInBytes > 0U; pxHeapRegion++ )
+    {
+        /* Ensure the heap region starts on a correctly aligned boundary. */
+        xAddress = heapALIGN_UP( ( size_t ) pxHeapRegion->pucStartAddress );
+        xSize = pxHeapRegion->xSizeInBytes - ( xAddress - ( size_t ) pxHeapRegion->pucStartAddress );
+        xSize &= ~( ( size_t ) portBYTE_ALIGNMENT_MASK );
+
+        if( xSize < ( xHeapMinimumBlockSize + xHeapHeaderSize ) )
+        {
+            continue;
+        }
+
+        /* The region is one free block followed by an allocated end marker
+         * that consists of the header only. */
+        pxFirstBlock = ( HeapBlock_t * ) xAddress;
+        pxFirstBlock->xBlockSize = xSize - xHeapHeaderSize;
+        pxFirstBlock->pxPrevPhysBlock = NULL;
+
+        configASSERT( ( pxFirstBlock->xBlockSize >> ( configHEAP_POOL_MAX_BLOCK_LOG2 + 1U ) ) == 0U );
+
+        pxEndMarker = heapNEXT_PHYSICAL_BLOCK( pxFirstBlock );
+        pxEndMarker->xBlockSize = heapBLOCK_ALLOCATED_BIT;
+        pxEndMarker->pxPrevPhysBlock = pxFirstBlock;
+
+        prvInsertFreeBlock( pxFirstBlock );
+        xRegionFreeBytes += pxFirstBlock->xBlockSize;
+    }
+
+    /* Check something was actually defined before it is accessed. */
+    configASSERT( xRegionFreeBytes );
+
+    prvInitialisePools();
+
+    /* Blocks in the pools are free until handed out. */
+    xFreeBytesRemaining = xRegionFreeBytes + ( size_t ) ( pucPoolsEnd - pucPoolsStart );
+    xMinimumEverFreeBytesRemaining = xFreeBytesRemaining;
+    xHeapInitialised = pdTRUE;
+}
+
+/*-----------------------------------------------------------*/
+
+void vPortGetHeapStats( HeapStats_t * pxHeapStats )
+{
+    HeapBlock_t * pxBlock;
+    size_t xBlocks = 0, xMaxSize = 0, xMinSize = portMAX_DELAY; /* portMAX_DELAY used as a portable way of getting the maximum value. */
+    UBaseType_t uxFirstLevel;
+    UBaseType_t uxSecondLevel;
+
+    vTaskSuspendAll();
+    {
+        for( uxFirstLevel = 0U; uxFirstLevel < heapFL_COUNT; uxFirstLevel++ )
+        {
+            for( uxSecondLevel = 0U; uxSecondLevel < heapSL_COUNT; uxSecondLevel++ )
+            {
+                for( pxBlock = pxFreeLists[ uxFirstLevel ][ uxSecondLevel ]; pxBlock != NULL; pxBlock = pxBlock->pxNextFreeBlock )
+                {
+                    xBlocks++;
+
+                    if( pxBlock->xBlockSize > xMaxSize )
+                    {
+                        xMaxSize = pxBlock->xBlockSize;
+                    }
+
+                    if( pxBlock->xBlockSize < xMinSize )
+                    {
+                        xMinSize = pxBlock->xBlockSize;
+                    }
+                }
+            }
+        }
+    }
+    ( void ) xTaskResumeAll();
+
+    pxHeapStats->xSizeOfLargestFreeBlockInBytes = xMaxSize;
+    pxHeapStats->xSizeOfSmallestFreeBlockInBytes = xMinSize;
+    pxHeapStats->xNumberOfFreeBlocks = xBlocks;
+
+    taskENTER_CRITICAL();
+    {
+        pxHeapStats->xAvailableHeapSpaceInBytes = xFreeBytesRemaining;
+        pxHeapStats->xNumberOfSuccessfulAllocations = xNumberOfSuccessfulAllocations;
+        pxHeapStats->xNumberOfSuccessfulFrees = xNumberOfSuccessfulFrees;
+        pxHeapStats->xMinimumEverFreeBytesRemaining = xMinimumEverFreeBytesRemaining;
+    }
+    taskEXIT_CRITICAL();
+}
+
+/*-----------------------------------------------------------*/
+
+void vPortGetHeapPoolStats( HeapPoolStats_t * pxStats )
+{
+    HeapStats_t xHeapStats;
+    size_t xClass;
+
+    vPortGetHeapStats( &xHeapStats );
+
+    ( void ) memset( pxStats, 0, sizeof( *pxStats ) );
+
+    vTaskSuspendAll();
+    {
+        for( xClass = 0U; ( xClass < heapPOOL_CLASS_COUNT ) && ( xClass < heapPOOL_MAX_CLASSES ); xClass++ )
+        {
+            pxStats->xClasses[ xClass ] = xPools[ xClass ].xStats;
+        }
+
+        pxStats->xClassCount = xClass;
+        pxStats->xRegionFreeBytes = xRegionFreeBytes;
+        pxStats->xRegionFailures = xRegionFailures;
+    }
+    ( void ) xTaskResumeAll();
+
+    pxStats->xRegionFreeBlocks = xHeapStats.xNumberOfFreeBlocks;
+    pxStats->xMinimumEverFreeBytes = xHeapStats.xMinimumEverFreeBytesRemaining;
+
+    if( xHeapStats.xSizeOfLargestFreeBlockInBytes > xHeapHeaderSize )
+    {
+        pxStats->xRegionLargestFreeBlock = xHeapStats.xSizeOfLargestFreeBlockInBytes - xHeapHeaderSize;
+    }
+
+    if( pxStats->xRegionFreeBytes > 0U )
+    {
+        pxStats->xRegionFragmentation = 100U - ( ( xHeapStats.xSizeOfLargestFreeBlockInBytes * 100U ) / pxStats->xRegionFreeBytes );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Reset the state in this file. This state is normally initialized at start up.
+ * This function must be called by the application before restarting the
+ * scheduler.
+ */
+void vPortHeapResetState( void )
+{
+    ( void ) memset( pxFreeLists, 0, sizeof( pxFreeLists ) );
+    ( void ) memset( ucSecondLevelBitmap, 0, sizeof( ucSecondLevelBitmap ) );
+    ( void ) memset( xPools, 0, sizeof( xPools ) );
+    ulFirstLevelBitmap = 0U;
+    pucPoolsStart = NULL;
+    pucPoolsEnd = NULL;
+
+    xRegionFreeBytes = ( size_t ) 0U;
+    xRegionFailures = ( size_t ) 0U;
+    xFreeBytesRemaining = ( size_t ) 0U;
+    xMinimumEverFreeBytesRemaining = ( size_t ) 0U;
+    xNumberOfSuccessfulAllocations = ( size_t ) 0U;
+    xNumberOfSuccessfulFrees = ( size_t ) 0U;
+    xHeapInitialised = pdFALSE;
+}
+
+/*-----------------------------------------------------------*/
@@ -0,0 +1,217 @@
+/*
+ * low_power.c
+ *
+ *  Low power policy of the tickless idle mode. The kernel suppresses the tick
+ *  whenever all tasks are blocked (configUSE_TICKLESS_IDLE); this file decides
+ *  whether the MCU may go beyond SLEEP into STOP 2 for that time.
+ *
+ *  In STOP 2 the modem UART is not clocked, so a URC or a downlink datagram
+ *  arriving while the MCU stops would be lost. STOP 2 is therefore only used
+ *  while the modem itself is in PSM: after its last traffic the modem stays
+ *  connected until the network releases it, then reachable in idle mode for
+ *  the active time (T3324), and only then unreachable until the next periodic
+ *  TAU (T3412), where the same sequence starts again. The timers come from
+ *  Cellular_GetPsmSettings() through vLowPowerSetModemTimers(). eDRX only
+ *  stretches the reachable phase; without PSM the modem may report a page at
+ *  any eDRX cycle, so the MCU stays in SLEEP.
+ *
+ *  The file has no hardware dependency; the sleep itself is entered by
+ *  Core/Src/low_power_stm32l4.c, and Tools/lowpower_sim drives the same
+ *  policy on the host. Core/Src/uplink_scheduler.c times uplinks with the
+ *  same model of the modem phases.
+ *
+ *  1NCE GmbH
+ */
+
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "low_power.h"
+
+/* Timers longer than this are treated as this long, so that the window
+ * arithmetic stays within half the tick counter range. */
+#define lowpowerMAX_WINDOW_MS               ( 0x7FFFFFFFUL / 2UL )
+
+/*-----------------------------------------------------------*/
+
+/* Written by tasks and by eLowPowerSelectMode(), which the idle task calls
+ * with interrupts disabled. Every field is a single word. */
+static volatile TickType_t xLastModemActivity = 0;
+static volatile uint32_t ulTauMs = 0;
+static volatile uint32_t ulAwakeMs = 0;
+
+static LowPowerModemWakeCallback_t xModemWakeCallback = NULL;
+
+static LowPowerStats_t xStats = { 0 };
+
+/*-----------------------------------------------------------*/
+
+static uint32_t prvSecondsToMs( uint32_t ulSeconds )
+{
+    uint32_t ulMs = lowpowerMAX_WINDOW_MS;
+
+    if( ulSeconds < ( lowpowerMAX_WINDOW_MS / 1000UL ) )
+    {
+        ulMs = ulSeconds * 1000UL;
+    }
+
+    return ulMs;
+}
+
+/*-----------------------------------------------------------*/
+
+void vLowPowerSetModemTimers( uint32_t ulTauSeconds,
+                              uint32_t ulActiveSeconds )
+{
+    uint32_t ulTau = prvSecondsToMs( ulTauSeconds );
+    uint32_t ulAwake = prvSecondsToMs( ulActiveSeconds ) + configLOW_POWER_RELEASE_MS;
+
+    taskENTER_CRITICAL();
+    {
+        /* Without a TAU longer than the awake time there is no PSM window. */
+        ulTauMs = ( ( ulTauSeconds != 0UL ) && ( ulTau > ulAwake ) ) ? ulTau : 0UL;
+        ulAwakeMs = ulAwake;
+        xLastModemActivity = xTaskGetTickCount();
+    }
+    taskEXIT_CRITICAL();
+}
+
+/*-----------------------------------------------------------*/
+
+void vLowPowerNotifyModemActivity( void )
+{
+    TickType_t xNow = xTaskGetTickCount();
+    LowPowerModemState_t eState = eLowPowerGetModemState( xNow, NULL );
+    LowPowerModemWakeCallback_t xCallback = xModemWakeCallback;
+
+    xLastModemActivity = xNow;
+
+    if( ( eState != eLowPowerModemConnected ) && ( xCallback != NULL ) )
+    {
+        xCallback();
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+LowPowerModemState_t eLowPowerGetModemState( TickType_t xNow,
+                                             TickType_t * pxTimeLeft )
+{
+    LowPowerModemState_t eState;
+    TickType_t xSinceActivity = xNow - xLastModemActivity;
+    TickType_t xTau = pdMS_TO_TICKS( ulTauMs );
+    TickType_t xAwake = pdMS_TO_TICKS( ulAwakeMs );
+    TickType_t xRelease = pdMS_TO_TICKS( configLOW_POWER_RELEASE_MS );
+    TickType_t xTimeLeft;
+
+    if( ( xTau != 0U ) && ( xSinceActivity >= xTau ) )
+    {
+        xSinceActivity %= xTau;
+    }
+
+    if( xSinceActivity < xRelease )
+    {
+        eState = eLowPowerModemConnected;
+        xTimeLeft = xRelease - xSinceActivity;
+    }
+    else if( xTau == 0U )
+    {
+        eState = eLowPowerModemIdle;
+        xTimeLeft = portMAX_DELAY;
+    }
+    else if( xSinceActivity < xAwake )
+    {
+        eState = eLowPowerModemIdle;
+        xTimeLeft = xAwake - xSinceActivity;
+    }
+    else
+    {
+        eState = eLowPowerModemPsm;
+        xTimeLeft = xTau - xSinceActivity;
+    }
+
+    if( pxTimeLeft != NULL )
+    {
+        *pxTimeLeft = xTimeLeft;
+    }
+
+    return eState;
+}
+
+/*-----------------------------------------------------------*/
+
+void vLowPowerSetModemWakeCallback( LowPowerModemWakeCallback_t xCallback )
+{
+    xModemWakeCallback = xCallback;
+}
+
+/*-----------------------------------------------------------*/
+
+LowPowerMode_t eLowPowerSelectMode( TickType_t xNow,
+                                    TickType_t * pxIdleTime )
+{
+    LowPowerMode_t eMode = eLowPowerSleep;
+    TickType_t xSinceActivity = xNow - xLastModemActivity;
+    TickType_t xTau = pdMS_TO_TICKS( ulTauMs );
+    TickType_t xWindowLeft = 0;
+
+    if( xTau != 0U )
+    {
+        /* Every TAU restarts the connected and reachable phase. Keep the
+         * reference within the current cycle so that the tick counter does
+         * not wrap between it and now. */
+        if( xSinceActivity >= xTau )
+        {
+            xLastModemActivity += ( xSinceActivity / xTau ) * xTau;
+            xSinceActivity %= xTau;
+        }
+
+        if( xSinceActivity >= pdMS_TO_TICKS( ulAwakeMs ) )
+        {
+            xWindowLeft = xTau - xSinceActivity;
+
+            if( *pxIdleTime > xWindowLeft )
+            {
+                *pxIdleTime = xWindowLeft;
+            }
+
+            if( *pxIdleTime >= pdMS_TO_TICKS( configLOW_POWER_STOP_MIN_MS ) )
+            {
+                eMode = eLowPowerStop;
+            }
+        }
+    }
+
+    return eMode;
+}
+
+/*-----------------------------------------------------------*/
+
+void vLowPowerRecordSleep( LowPowerMode_t eMode,
+                           TickType_t xSleptTicks )
+{
+    xStats.ulWakeups++;
+
+    if( eMode == eLowPowerStop )
+    {
+        xStats.ulStopEntries++;
+        xStats.ulStopTicks += ( uint32_t ) xSleptTicks;
+    }
+    else
+    {
+        xStats.ulSleepTicks += ( uint32_t ) xSleptTicks;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+void vLowPowerGetStats( LowPowerStats_t * pxStats )
+{
+    taskENTER_CRITICAL();
+    {
+        *pxStats = xStats;
+    }
+    taskEXIT_CRITICAL();
+}
@@ -0,0 +1,318 @@
+/*
+ * low_power_stm32l4.c
+ *
+ *  Sleep entry of the tickless idle mode. FreeRTOSConfig.h routes
+ *  portSUPPRESS_TICKS_AND_SLEEP() to vLowPowerSuppressTicksAndSleep(), which
+ *  asks eLowPowerSelectMode() how deep the MCU may sleep:
+ *
+ *  - SLEEP: the Cortex-M4 port suppresses the tick with the SysTick, up to
+ *    0xFFFFFF counts of HCLK / 8, about 1.6 s per sleep. Its sleep hooks below
+ *    suspend the HAL time base (TIM3), so that only the SysTick or a
+ *    peripheral interrupt (modem UART, console, RI) end the sleep.
+ *  - STOP 2, while the modem is in PSM: the SysTick is not clocked, so the
+ *    tick is suppressed here without the port's limit. The RTC wakeup timer
+ *    ends the sleep, on RTCCLK / 16 up to 32 s and on ck_spre (1.024 s) up to
+ *    about 18.6 h, and the RTC sub-second counter measures it.
+ *
+ *  The HAL time base is stopped during both, so the RTC is driven here with
+ *  bounded polling loops instead of the HAL functions, whose timeouts count
+ *  HAL_GetTick() and would never expire.
+ *
+ *  1NCE GmbH
+ */
+
+#include "main.h"
+#include "rtc.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "low_power.h"
+
+#if ( configUSE_TICKLESS_IDLE == 1 )
+
+/* The SLEEP path of the port, which portmacro.h only declares when
+ * portSUPPRESS_TICKS_AND_SLEEP() is not overridden. */
+    extern void vPortSuppressTicksAndSleep( TickType_t xExpectedIdleTime );
+
+/* Short sleeps: the wakeup timer counts RTCCLK (LSI) / 16, with a 16 bit
+ * reload, 0.5 ms steps up to 32.8 s. */
+    #define lowpowerWAKEUP_SHORT_CLOCK     RTC_WAKEUPCLOCK_RTCCLK_DIV16
+    #define lowpowerWAKEUP_SHORT_HZ        ( LSI_VALUE / 16UL )
+
+/* Long sleeps: the wakeup timer counts ck_spre, the 1 Hz calendar clock,
+ * 1.024 s with the prescalers of MX_RTC_Init(). */
+    #define lowpowerWAKEUP_LONG_CLOCK      RTC_WAKEUPCLOCK_CK_SPRE_16BITS
+    #define lowpowerWAKEUP_LONG_MS         ( ( ( hrtc.Init.AsynchPrediv + 1UL ) * ( hrtc.Init.SynchPrediv + 1UL ) * 1000UL ) / LSI_VALUE )
+
+    #define lowpowerWAKEUP_MAX_COUNTS      ( 0x10000UL )
+
+/* Longest wait for the RTC, which answers within two RTCCLK periods. One
+ * iteration takes a few CPU cycles, so this is well above a millisecond. */
+    #define lowpowerRTC_WAIT_LOOPS         ( configCPU_CLOCK_HZ / 1000UL )
+
+/* SysTick counts per tick, see configSYSTICK_CLOCK_HZ. */
+    #define lowpowerSYSTICK_COUNTS_PER_TICK    ( configSYSTICK_CLOCK_HZ / configTICK_RATE_HZ )
+
+/* Length of a day in RTC sub-second units. */
+    #define lowpowerRTC_UNITS_PER_DAY      ( 86400UL * ( hrtc.Init.SynchPrediv + 1UL ) )
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Wait until the bits of the RTC ISR register are set.
+ *
+ * @return pdTRUE if they were set in time.
+ */
+    static BaseType_t prvRtcWait( uint32_t ulMask )
+    {
+        uint32_t ulLoops = lowpowerRTC_WAIT_LOOPS;
+
+        while( ( hrtc.Instance->ISR & ulMask ) != ulMask )
+        {
+            if( ulLoops == 0UL )
+            {
+                return pdFALSE;
+            }
+
+            ulLoops--;
+        }
+
+        return pdTRUE;
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Stop the wakeup timer, like HAL_RTCEx_DeactivateWakeUpTimer().
+ */
+    static BaseType_t prvWakeupTimerStop( void )
+    {
+        BaseType_t xResult;
+
+        __HAL_RTC_WRITEPROTECTION_DISABLE( &hrtc );
+        __HAL_RTC_WAKEUPTIMER_DISABLE( &hrtc );
+        __HAL_RTC_WAKEUPTIMER_DISABLE_IT( &hrtc, RTC_IT_WUT );
+        xResult = prvRtcWait( RTC_ISR_WUTWF );
+        __HAL_RTC_WRITEPROTECTION_ENABLE( &hrtc );
+
+        return xResult;
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Start the wakeup timer, like HAL_RTCEx_SetWakeUpTimer_IT().
+ */
+    static BaseType_t prvWakeupTimerStart( uint32_t ulCounts,
+                                           uint32_t ulClock )
+    {
+        BaseType_t xResult;
+
+        __HAL_RTC_WRITEPROTECTION_DISABLE( &hrtc );
+        __HAL_RTC_WAKEUPTIMER_DISABLE( &hrtc );
+        __HAL_RTC_WAKEUPTIMER_CLEAR_FLAG( &hrtc, RTC_FLAG_WUTF );
+        xResult = prvRtcWait( RTC_ISR_WUTWF );
+
+        if( xResult == pdTRUE )
+        {
+            hrtc.Instance->WUTR = ulCounts - 1UL;
+            MODIFY_REG( hrtc.Instance->CR, RTC_CR_WUCKSEL, ulClock );
+
+            __HAL_RTC_WAKEUPTIMER_EXTI_ENABLE_IT();
+            __HAL_RTC_WAKEUPTIMER_EXTI_ENABLE_RISING_EDGE();
+            __HAL_RTC_WAKEUPTIMER_ENABLE_IT( &hrtc, RTC_IT_WUT );
+            __HAL_RTC_WAKEUPTIMER_ENABLE( &hrtc );
+        }
+
+        __HAL_RTC_WRITEPROTECTION_ENABLE( &hrtc );
+
+        return xResult;
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Read the RTC time of day in sub-second units.
+ *
+ * A unit is ( AsynchPrediv + 1 ) / LSI_VALUE seconds, 4 ms with the settings
+ * of MX_RTC_Init().
+ */
+    static uint32_t prvRtcUnitsOfDay( void )
+    {
+        RTC_TimeTypeDef xTime = { 0 };
+        RTC_DateTypeDef xDate = { 0 };
+        uint32_t ulSeconds;
+
+        ( void ) HAL_RTC_GetTime( &hrtc, &xTime, RTC_FORMAT_BIN );
+        /* Reading the date unlocks the shadow registers again. */
+        ( void ) HAL_RTC_GetDate( &hrtc, &xDate, RTC_FORMAT_BIN );
+
+        ulSeconds = ( ( uint32_t ) xTime.Hours * 3600UL ) + ( ( uint32_t ) xTime.Minutes * 60UL ) + xTime.Seconds;
+
+        return ( ulSeconds * ( xTime.SecondFraction + 1UL ) ) + ( xTime.SecondFraction - xTime.SubSeconds );
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Sleep in STOP 2 for up to xSleepTicks.
+ *
+ * @return The ticks actually spent, measured with the RTC.
+ */
+    static TickType_t prvStop( TickType_t xSleepTicks )
+    {
+        uint32_t ulMs = ( uint32_t ) xSleepTicks * portTICK_PERIOD_MS;
+        uint32_t ulCounts;
+        uint32_t ulClock;
+        uint32_t ulStart;
+        uint32_t ulUnits;
+
+        if( ulMs <= ( ( lowpowerWAKEUP_MAX_COUNTS * 1000UL ) / lowpowerWAKEUP_SHORT_HZ ) )
+        {
+            ulCounts = ( ulMs * lowpowerWAKEUP_SHORT_HZ ) / 1000UL;
+            ulClock = lowpowerWAKEUP_SHORT_CLOCK;
+        }
+        else
+        {
+            /* Rounded down, the rest is slept on the short clock. */
+            ulCounts = ulMs / lowpowerWAKEUP_LONG_MS;
+            ulClock = lowpowerWAKEUP_LONG_CLOCK;
+
+            if( ulCounts > lowpowerWAKEUP_MAX_COUNTS )
+            {
+                ulCounts = lowpowerWAKEUP_MAX_COUNTS;
+            }
+        }
+
+        ulStart = prvRtcUnitsOfDay();
+
+        if( prvWakeupTimerStart( ulCounts, ulClock ) != pdTRUE )
+        {
+            /* Nothing would end the sleep. */
+            ( void ) prvWakeupTimerStop();
+
+            return 0U;
+        }
+
+        vMainPreStopProcessing();
+        HAL_PWREx_EnterSTOP2Mode( PWR_STOPENTRY_WFI );
+        vMainPostStopProcessing();
+
+        ( void ) prvWakeupTimerStop();
+
+        /* The calendar shadow registers are stale after STOP, see
+         * HAL_RTC_WaitForSynchro(). */
+        __HAL_RTC_WRITEPROTECTION_DISABLE( &hrtc );
+        hrtc.Instance->ISR &= ( uint32_t ) RTC_RSF_MASK;
+        ( void ) prvRtcWait( RTC_ISR_RSF );
+        __HAL_RTC_WRITEPROTECTION_ENABLE( &hrtc );
+
+        ulUnits = ( prvRtcUnitsOfDay() + lowpowerRTC_UNITS_PER_DAY - ulStart ) % lowpowerRTC_UNITS_PER_DAY;
+
+        return pdMS_TO_TICKS( ( uint32_t ) ( ( ( uint64_t ) ulUnits * ( hrtc.Init.AsynchPrediv + 1UL ) * 1000UL ) / LSI_VALUE ) );
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Suppress the tick for a STOP 2 sleep of up to xSleepTicks.
+ *
+ * Follows vPortSuppressTicksAndSleep(), with the RTC in place of the SysTick.
+ * Called with interrupts disabled.
+ */
+    static void prvStopSuppressTicks( TickType_t xSleepTicks,
+                                      TickType_t xExpectedIdleTime )
+    {
+        TickType_t xSlept = 0U;
+
+        /* Stop the SysTick, it is restarted for a full tick period below. A
+         * pending tick would end the sleep at once, it is counted instead. */
+        SysTick->CTRL &= ~SysTick_CTRL_ENABLE_Msk;
+
+        if( ( SCB->ICSR & SCB_ICSR_PENDSTSET_Msk ) != 0UL )
+        {
+            SCB->ICSR = SCB_ICSR_PENDSTCLR_Msk;
+            xSlept = 1U;
+        }
+
+        HAL_SuspendTick();
+
+        xSlept += prvStop( xSleepTicks );
+
+        /* The tick must not pass the next task unblock time, the restarted
+         * SysTick adds the last tick. */
+        if( xSlept >= xExpectedIdleTime )
+        {
+            xSlept = xExpectedIdleTime - 1U;
+        }
+
+        SysTick->VAL = 0UL;
+        SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+        HAL_ResumeTick();
+
+        vTaskStepTick( xSlept );
+        vLowPowerRecordSleep( eLowPowerStop, xSlept );
+    }
+
+/*-----------------------------------------------------------*/
+
+    void vLowPowerSuppressTicksAndSleep( TickType_t xExpectedIdleTime )
+    {
+        TickType_t xSleepTicks = xExpectedIdleTime;
+        LowPowerMode_t eMode = eLowPowerSleep;
+
+        /* Enter a critical section without masking the interrupts that end
+         * the sleep, like the port. */
+        __asm volatile ( "cpsid i" ::: "memory" );
+        __asm volatile ( "dsb" );
+        __asm volatile ( "isb" );
+
+        if( eTaskConfirmSleepModeStatus() != eAbortSleep )
+        {
+            eMode = eLowPowerSelectMode( xTaskGetTickCount(), &xSleepTicks );
+
+            if( eMode == eLowPowerStop )
+            {
+                prvStopSuppressTicks( xSleepTicks, xExpectedIdleTime );
+            }
+        }
+
+        __asm volatile ( "cpsie i" ::: "memory" );
+
+        if( eMode == eLowPowerSleep )
+        {
+            /* Checks for a pending context switch again. */
+            vPortSuppressTicksAndSleep( xExpectedIdleTime );
+        }
+    }
+
+/*-----------------------------------------------------------*/
+
+    void vLowPowerPreSleepProcessing( uint32_t * pulIdleTime )
+    {
+        ( void ) pulIdleTime;
+
+        HAL_SuspendTick();
+    }
+
+/*-----------------------------------------------------------*/
+
+    void vLowPowerPostSleepProcessing( uint32_t ulExpectedIdleTime )
+    {
+        TickType_t xSlept = ( TickType_t ) ulExpectedIdleTime;
+
+        /* The port reads the SysTick COUNTFLAG afterwards, so the control
+         * register is left alone. A pending SysTick means the full time has
+         * passed. */
+        if( ( SCB->ICSR & SCB_ICSR_PENDSTSET_Msk ) == 0UL )
+        {
+            xSlept = ( TickType_t ) ( ( SysTick->LOAD - SysTick->VAL ) / lowpowerSYSTICK_COUNTS_PER_TICK );
+        }
+
+        vLowPowerRecordSleep( eLowPowerSleep, xSlept );
+
+        HAL_ResumeTick();
+    }
+
+#endif /* configUSE_TICKLESS_IDLE == 1 */
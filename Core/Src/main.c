@@ -30,6 +30,13 @@
 #include "task.h"
 /* Demo Includes*/
 #include "cellular_app.h"
+#include "cellular_platform.h"
+#include "low_power.h"
+#include "uplink_scheduler.h"
+
+#if ( IOT_LOG_DEFERRED == 1 )
+    #include "iot_logging_deferred.h"
+#endif
 
 #ifdef IOT_LOG_LEVEL_MAIN
 #else
@@ -58,6 +65,11 @@
 #define mainLOGGING_MESSAGE_QUEUE_LENGTH    ( 15 )
 #define main_RUNNER_TASK_STACK_SIZE         ( configMINIMAL_STACK_SIZE * 8 )
 
+/* The deferred logging task formats IotLog records in the background, so it
+ * runs just above idle. */
+#define mainLOGGING_DEFERRED_TASK_PRIORITY      ( tskIDLE_PRIORITY + 1 )
+#define mainLOGGING_DEFERRED_TASK_STACK_SIZE    ( configMINIMAL_STACK_SIZE * 4 )
+
 
 /* Heap 2 size for malloc. */
 #define HEAP2_SIZE    ( 27 * 1024 )
@@ -87,8 +99,9 @@ static void prvMiscInitialization( void );
 /**
  * @brief Initializes the FreeRTOS heap.
  *
- * Heap_5 is being used because the RAM is not contiguous, therefore the heap
- * needs to be initialized.  See http://www.freertos.org/a00111.html
+ * The heap (Core/Src/heap_pool.c) spans two RAM areas that are not
+ * contiguous, therefore the heap regions need to be defined. The size class
+ * pools are carved out of them at the same time.
  */
 static void prvInitializeHeap( void );
 
@@ -120,8 +133,8 @@ static void CellularDemoTask()
             /* Set pin PD3 to high, signaling the attempt */
             HAL_GPIO_WritePin( GPIOD, GPIO_PIN_3, GPIO_PIN_SET );
 
-            /* Delay between retries */
-            HAL_Delay( RETRY_DELAY_MS );
+            /* Delay between retries, blocked so that the MCU can sleep */
+            vTaskDelay( pdMS_TO_TICKS( RETRY_DELAY_MS ) );
 
             /* Attempt to set up the cellular connection */
             retCellular = setupCellular();
@@ -172,6 +185,17 @@ int main( void )
                             mainLOGGING_TASK_PRIORITY,
                             mainLOGGING_MESSAGE_QUEUE_LENGTH );
 
+    #if ( IOT_LOG_DEFERRED == 1 )
+        xLoggingDeferredInitialize( mainLOGGING_DEFERRED_TASK_STACK_SIZE,
+                                    mainLOGGING_DEFERRED_TASK_PRIORITY );
+    #endif
+
+    /* Workers for the cellular library and the socket callbacks. */
+    ( void ) Platform_WorkPoolInit();
+
+    /* Periodic uplinks wait for the modem to wake up. */
+    vUplinkSchedulerInit();
+
     /* Start the scheduler.  Initialization that requires the OS to be running,
      */
     vTaskStartScheduler();
@@ -212,8 +236,8 @@ static void prvMiscInitialization( void )
     /* Configure the system clock. */
     SystemClock_Config();
 
-    /* Heap_5 is being used because the RAM is not contiguous in memory, so the
-     * heap must be initialized. */
+    /* The heap spans RAM areas that are not contiguous in memory, so the heap
+     * must be initialized. */
     prvInitializeHeap();
 
     /* Initialize all configured peripherals */
@@ -352,17 +376,57 @@ void SystemClock_Config( void )
 
 /*-----------------------------------------------------------*/
 
+void vMainPreStopProcessing( void )
+{
+    /* Wake up on MSI, which needs no start up time. */
+    __HAL_RCC_WAKEUPSTOP_CLK_CONFIG( RCC_STOP_WAKEUPCLOCK_MSI );
+}
+
+/*-----------------------------------------------------------*/
+
+void vMainPostStopProcessing( void )
+{
+    /* STOP 2 switches the PLLs off and leaves the system on MSI. Restart them
+     * with the configuration of SystemClock_Config(), which is kept in the RCC
+     * registers, without touching the SysTick that belongs to the kernel. */
+    __HAL_RCC_PLL_ENABLE();
+
+    while( __HAL_RCC_GET_FLAG( RCC_FLAG_PLLRDY ) == 0U )
+    {
+    }
+
+    __HAL_RCC_PLLSAI1_ENABLE();
+
+    while( __HAL_RCC_GET_FLAG( RCC_FLAG_PLLSAI1RDY ) == 0U )
+    {
+    }
+
+    __HAL_RCC_SYSCLK_CONFIG( RCC_SYSCLKSOURCE_PLLCLK );
+
+    while( __HAL_RCC_GET_SYSCLK_SOURCE() != RCC_SYSCLKSOURCE_STATUS_PLLCLK )
+    {
+    }
+}
+
+/*-----------------------------------------------------------*/
+
 void vApplicationIdleHook( void )
 {
     static TickType_t xLastPrint = 0;
     TickType_t xTimeNow;
     const TickType_t xPrintFrequency = pdMS_TO_TICKS( 30000 );
+    LowPowerStats_t xStats;
 
     xTimeNow = xTaskGetTickCount();
 
     if( ( xTimeNow - xLastPrint ) > xPrintFrequency )
     {
-        IotLogInfo( "." );
+        vLowPowerGetStats( &xStats );
+        IotLogInfo( "Idle: %lu sleeps, %lu ms in SLEEP, %lu ms in STOP 2 (%lu entries)",
+                    ( unsigned long ) xStats.ulWakeups,
+                    ( unsigned long ) ( xStats.ulSleepTicks * portTICK_PERIOD_MS ),
+                    ( unsigned long ) ( xStats.ulStopTicks * portTICK_PERIOD_MS ),
+                    ( unsigned long ) xStats.ulStopEntries );
         xLastPrint = xTimeNow;
     }
 }
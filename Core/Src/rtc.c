@@ -83,6 +83,10 @@ void HAL_RTC_MspInit( RTC_HandleTypeDef * rtcHandle )
         __HAL_RCC_RTC_ENABLE();
         /* USER CODE BEGIN RTC_MspInit 1 */
 
+        /* The wakeup timer ends STOP 2 sleeps of the tickless idle mode. */
+        HAL_NVIC_SetPriority( RTC_WKUP_IRQn, 15, 0 );
+        HAL_NVIC_EnableIRQ( RTC_WKUP_IRQn );
+
         /* USER CODE END RTC_MspInit 1 */
     }
 }
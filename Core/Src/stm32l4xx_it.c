@@ -28,6 +28,7 @@
 
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
+#include "rtc.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -263,5 +264,13 @@ void LPUART1_IRQHandler( void )
 
 /* USER CODE BEGIN 1 */
 
+/**
+ * @brief This function handles RTC wake-up interrupt through EXTI line 20.
+ */
+void RTC_WKUP_IRQHandler( void )
+{
+    HAL_RTCEx_WakeUpTimerIRQHandler( &hrtc );
+}
+
 /* USER CODE END 1 */
 /************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
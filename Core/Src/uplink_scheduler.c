@@ -0,0 +1,160 @@
+/*
+ * uplink_scheduler.c
+ *
+ *  Releases periodic uplinks when the modem is awake anyway. Every uplink
+ *  that finds the modem in idle mode or in PSM costs a connection setup or a
+ *  resume of the radio, and keeps the modem connected and reachable for the
+ *  release and active times afterwards (see Core/Src/low_power.c). Tasks that
+ *  can tolerate a few seconds of jitter wait here instead of in vTaskDelay()
+ *  and go out together with other traffic or with the periodic TAU.
+ *
+ *  The wake ups caused by traffic are reported by vLowPowerNotifyModemActivity()
+ *  through an event group; the TAU is predicted from the PSM timers.
+ *
+ *  1NCE GmbH
+ */
+
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "event_groups.h"
+
+#include "low_power.h"
+#include "uplink_scheduler.h"
+
+/* Set when traffic wakes the modem up, cleared by waiters that find the modem
+ * outside the connected phase again. */
+#define uplinkMODEM_AWAKE_BIT    ( ( EventBits_t ) 0x01U )
+
+/*-----------------------------------------------------------*/
+
+static StaticEventGroup_t xModemEventsBuffer;
+static EventGroupHandle_t xModemEvents = NULL;
+
+/*-----------------------------------------------------------*/
+
+static void prvModemWake( void )
+{
+    ( void ) xEventGroupSetBits( xModemEvents, uplinkMODEM_AWAKE_BIT );
+}
+
+/*-----------------------------------------------------------*/
+
+void vUplinkSchedulerInit( void )
+{
+    xModemEvents = xEventGroupCreateStatic( &xModemEventsBuffer );
+    vLowPowerSetModemWakeCallback( prvModemWake );
+}
+
+/*-----------------------------------------------------------*/
+
+BaseType_t xUplinkSchedulerDelayUntil( TickType_t * pxPreviousWakeTime,
+                                       TickType_t xPeriod,
+                                       TickType_t xSlack )
+{
+    TickType_t xStart = xTaskGetTickCount();
+    TickType_t xSincePrevious = xStart - *pxPreviousWakeTime;
+    TickType_t xAhead = *pxPreviousWakeTime - xStart;
+    TickType_t xToDue = 0;
+    TickType_t xOpen;
+    TickType_t xClose;
+    TickType_t xElapsed;
+    TickType_t xTimeLeft;
+    TickType_t xWait;
+    LowPowerModemState_t eState;
+
+    configASSERT( xModemEvents != NULL );
+
+    if( xSlack > ( xPeriod / 2U ) )
+    {
+        xSlack = xPeriod / 2U;
+    }
+
+    if( xAhead <= ( xPeriod / 2U ) )
+    {
+        /* The previous uplink went out before it was due. */
+        xToDue = xAhead + xPeriod;
+    }
+    else if( xSincePrevious < xPeriod )
+    {
+        xToDue = xPeriod - xSincePrevious;
+    }
+    else if( ( xSincePrevious - xPeriod ) < xSlack )
+    {
+        /* Late, but still within the window of this uplink. */
+        xSlack -= xSincePrevious - xPeriod;
+    }
+    else
+    {
+        *pxPreviousWakeTime = xStart - xPeriod;
+    }
+
+    *pxPreviousWakeTime += xPeriod;
+
+    /* The window, relative to xStart. */
+    xOpen = ( xToDue > xSlack ) ? ( xToDue - xSlack ) : 0U;
+    xClose = xToDue + xSlack;
+
+    for( ; ; )
+    {
+        xElapsed = xTaskGetTickCount() - xStart;
+        eState = eLowPowerGetModemState( xStart + xElapsed, &xTimeLeft );
+
+        if( ( xElapsed >= xOpen ) && ( eState == eLowPowerModemConnected ) )
+        {
+            break;
+        }
+
+        if( xElapsed >= xClose )
+        {
+            break;
+        }
+
+        if( xElapsed < xOpen )
+        {
+            xWait = xOpen - xElapsed;
+        }
+        else if( xElapsed < xToDue )
+        {
+            xWait = xToDue - xElapsed;
+        }
+        else if( ( eState == eLowPowerModemPsm ) && ( xTimeLeft < ( xClose - xElapsed ) ) )
+        {
+            /* The modem wakes up for its TAU before the window closes. */
+            xWait = xTimeLeft;
+        }
+        else
+        {
+            /* Due, and no wake up to wait for. */
+            break;
+        }
+
+        if( eState == eLowPowerModemConnected )
+        {
+            /* Before the window; traffic cannot release the uplink yet. */
+            vTaskDelay( xWait );
+        }
+        else
+        {
+            /* Look again when the modem changes phase, e.g. wakes up for its
+             * TAU, which is not reported by any traffic. */
+            if( xWait > xTimeLeft )
+            {
+                xWait = xTimeLeft;
+            }
+
+            ( void ) xEventGroupClearBits( xModemEvents, uplinkMODEM_AWAKE_BIT );
+
+            /* Traffic between the state check and the clear is not lost. */
+            if( eLowPowerGetModemState( xTaskGetTickCount(), NULL ) != eLowPowerModemConnected )
+            {
+                ( void ) xEventGroupWaitBits( xModemEvents, uplinkMODEM_AWAKE_BIT, pdFALSE, pdFALSE, xWait );
+            }
+        }
+    }
+
+    return ( eState == eLowPowerModemConnected ) ? pdTRUE : pdFALSE;
+}
+
+/*-----------------------------------------------------------*/
@@ -36,6 +36,8 @@
 #include <string.h>
 #include <stdbool.h>
 #include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
 #include "udp_interface.h"
 
 /**
@@ -105,6 +107,23 @@ static const OSEndPoint_t NceOnboard =
 };
 
 
+/**
+ * @brief Largest encoded onboarding request.
+ */
+#define NCE_SDK_ONBOARD_REQUEST_SIZE    48
+
+/**
+ * @brief State of an onboarding exchange between os_auth_start and os_auth_finish.
+ */
+typedef struct NceAuthRequest
+{
+    uint8_t request[ NCE_SDK_ONBOARD_REQUEST_SIZE ]; /**< Encoded confirmable CoAP request, kept for retransmissions. */
+    size_t requestLength;                           /**< Length of the encoded request. */
+    uint16_t messageId;                             /**< CoAP message ID of the request. */
+    bool acknowledged;                              /**< An empty ACK was received, the response follows separately. */
+    bool pending;                                   /**< The request was sent and the socket is open. */
+} NceAuthRequest_t;
+
 /**
  * @brief Communicate with 1NCE Device Authenticator to get DTLS credentials
  *
@@ -116,6 +135,34 @@ static const OSEndPoint_t NceOnboard =
 int os_auth( os_network_ops_t * osNetwork,
              DtlsKey_t * nceKey );
 
+/**
+ * @brief Start onboarding: connect and send the confirmable CoAP request.
+ *
+ * The response is collected by os_auth_finish, the caller may do other work
+ * in between while the request is in flight.
+ *
+ * @param[in] osNetwork: UDP interface object.
+ * @param[out] pRequest: Exchange state, passed to os_auth_finish.
+ *
+ * @return NCE_SDK_SUCCESS if the request was sent.
+ */
+int os_auth_start( os_network_ops_t * osNetwork,
+                   NceAuthRequest_t * pRequest );
+
+/**
+ * @brief Finish onboarding: wait for the response, retransmitting the request on
+ * receive timeouts, parse the credentials and close the socket.
+ *
+ * @param[in] osNetwork: UDP interface object.
+ * @param[in] pRequest: Exchange state from os_auth_start.
+ * @param[out] nceKey: new DTLS credential required.
+ *
+ * @return The status of the onboarding.
+ */
+int os_auth_finish( os_network_ops_t * osNetwork,
+                    NceAuthRequest_t * pRequest,
+                    DtlsKey_t * nceKey );
+
 
 #endif /* ifdef NCE_DEVICE_AUTHENTICATOR */
 
@@ -182,6 +229,145 @@ int os_energy_save( char * packet,
                     int num_args,
                     ... );
 
+/**
+ * @brief Wire types of a translation template field.
+ */
+typedef enum NceFieldType
+{
+    NCE_FIELD_UINT,   /**< Unsigned integer record member sent as an unsigned integer. */
+    NCE_FIELD_INT,    /**< Signed integer record member sent as a two's complement integer. */
+    NCE_FIELD_SCALED, /**< float record member multiplied by the field scale and sent as a signed integer. */
+    NCE_FIELD_FLOAT,  /**< float record member sent as a 4 byte IEEE 754 value. */
+    NCE_FIELD_STRING  /**< char array record member sent zero padded to the field length. */
+} NceFieldType_t;
+
+/**
+ * @brief Byte order of a multi-byte template field.
+ */
+typedef enum NceEndianness
+{
+    NCE_BIG_ENDIAN,
+    NCE_LITTLE_ENDIAN
+} NceEndianness_t;
+
+/**
+ * @brief One field of a translation template, bound to a member of a C record.
+ *
+ * @note Declare fields with the NCE_TEMPLATE_* macros, which check the member
+ * and field sizes at compile time.
+ */
+typedef struct NceTemplateField
+{
+    NceFieldType_t type;        /**< Wire type of the field. */
+    NceEndianness_t endianness; /**< Byte order of the field in the payload. */
+    uint16_t offset;            /**< Offset of the member in the record. */
+    uint8_t memberSize;         /**< Size of the member in the record. */
+    uint8_t length;             /**< Length of the field in bytes, as configured in the 1NCE portal. */
+    float scale;                /**< Multiplier of NCE_FIELD_SCALED fields. */
+} NceTemplateField_t;
+
+/**
+ * @brief Static translation template: the selector byte followed by the fields in payload order.
+ */
+typedef struct NceTemplate
+{
+    uint8_t selector;                  /**< First payload byte, selects the template in the 1NCE portal. */
+    const NceTemplateField_t * pFields; /**< Fields in payload order. */
+    size_t fieldCount;                 /**< Number of fields. */
+} NceTemplate_t;
+
+/**
+ * @brief Size of a record member.
+ */
+#define NCE_MEMBER_SIZE( record, member )                     sizeof( ( ( record * ) 0 )->member )
+
+/**
+ * @brief Evaluates to 0, fails to compile if @p cond is false.
+ */
+#define NCE_TEMPLATE_CHECK( cond )                            ( 0U * sizeof( char[ ( cond ) ? 1 : -1 ] ) )
+
+/**
+ * @brief Template field for an unsigned integer member of 1, 2 or 4 bytes sent in @p length bytes.
+ */
+#define NCE_TEMPLATE_UINT( record, member, length, endianness ) \
+    { NCE_FIELD_UINT, ( endianness ), ( uint16_t ) offsetof( record, member ),                       \
+      ( uint8_t ) ( NCE_MEMBER_SIZE( record, member ) +                                            \
+                    NCE_TEMPLATE_CHECK( ( NCE_MEMBER_SIZE( record, member ) <= 4U ) &&             \
+                                        ( ( length ) >= 1U ) && ( ( length ) <= 4U ) ) ),          \
+      ( uint8_t ) ( length ), 1.0f }
+
+/**
+ * @brief Template field for a signed integer member of 1, 2 or 4 bytes sent in @p length bytes.
+ */
+#define NCE_TEMPLATE_INT( record, member, length, endianness ) \
+    { NCE_FIELD_INT, ( endianness ), ( uint16_t ) offsetof( record, member ),                        \
+      ( uint8_t ) ( NCE_MEMBER_SIZE( record, member ) +                                            \
+                    NCE_TEMPLATE_CHECK( ( NCE_MEMBER_SIZE( record, member ) <= 4U ) &&             \
+                                        ( ( length ) >= 1U ) && ( ( length ) <= 4U ) ) ),          \
+      ( uint8_t ) ( length ), 1.0f }
+
+/**
+ * @brief Template field for a float member sent as round( value * @p scale ) in @p length bytes.
+ */
+#define NCE_TEMPLATE_SCALED( record, member, length, endianness, scale ) \
+    { NCE_FIELD_SCALED, ( endianness ), ( uint16_t ) offsetof( record, member ),                     \
+      ( uint8_t ) ( NCE_MEMBER_SIZE( record, member ) +                                            \
+                    NCE_TEMPLATE_CHECK( ( NCE_MEMBER_SIZE( record, member ) == sizeof( float ) ) && \
+                                        ( ( length ) >= 1U ) && ( ( length ) <= 4U ) ) ),          \
+      ( uint8_t ) ( length ), ( scale ) }
+
+/**
+ * @brief Template field for a float member sent as a 4 byte IEEE 754 value.
+ */
+#define NCE_TEMPLATE_FLOAT( record, member, endianness ) \
+    { NCE_FIELD_FLOAT, ( endianness ), ( uint16_t ) offsetof( record, member ),                      \
+      ( uint8_t ) ( NCE_MEMBER_SIZE( record, member ) +                                            \
+                    NCE_TEMPLATE_CHECK( NCE_MEMBER_SIZE( record, member ) == sizeof( float ) ) ),  \
+      4U, 1.0f }
+
+/**
+ * @brief Template field for a char array member sent in @p length bytes, zero padded.
+ */
+#define NCE_TEMPLATE_STRING( record, member, length ) \
+    { NCE_FIELD_STRING, NCE_BIG_ENDIAN, ( uint16_t ) offsetof( record, member ),                     \
+      ( uint8_t ) ( NCE_MEMBER_SIZE( record, member ) +                                            \
+                    NCE_TEMPLATE_CHECK( ( ( length ) >= 1U ) &&                                    \
+                                        ( ( length ) <= NCE_MEMBER_SIZE( record, member ) ) ) ),   \
+      ( uint8_t ) ( length ), 1.0f }
+
+/**
+ * @brief Initializer of an NceTemplate_t from a selector and a field array.
+ */
+#define NCE_TEMPLATE( templateSelector, fieldArray ) \
+    { ( templateSelector ), ( fieldArray ), sizeof( fieldArray ) / sizeof( ( fieldArray )[ 0 ] ) }
+
+/**
+ * @brief Payload length of a template: the selector byte plus all field lengths.
+ *
+ * @param[in] pTemplate: Translation template.
+ *
+ * @return Length in bytes.
+ */
+size_t os_energy_save_length( const NceTemplate_t * pTemplate );
+
+/**
+ * @brief Translation service feature: encodes a fixed-layout record with a static template.
+ *
+ * The payload is binary and may contain zero bytes, send it with the returned length.
+ *
+ * @param[out] pBuffer: Payload buffer.
+ * @param[in] bufferSize: Size of the payload buffer.
+ * @param[in] pTemplate: Translation template matching the one in the 1NCE portal.
+ * @param[in] pRecord: Record the template fields refer to.
+ *
+ * @return Payload length, or NCE_SDK_BINARY_PAYLOAD_ERROR if the buffer is too small
+ * or a value does not fit its field.
+ */
+int os_energy_save_record( uint8_t * pBuffer,
+                           size_t bufferSize,
+                           const NceTemplate_t * pTemplate,
+                           const void * pRecord );
+
 #endif /* ifdef NCE_ENERGY_SAVER */
 
 
@@ -43,6 +43,36 @@ LOG_MODULE_REGISTER( NCE_SDK, CONFIG_NCE_SDK_LOG_LEVEL );
 
 static uint16_t message_id = 1000;
 
+/* CoAP message types and codes used by the onboarding exchange (RFC 7252). */
+#define COAP_VERSION                 1U
+#define COAP_TYPE_CON                0U
+#define COAP_TYPE_NON                1U
+#define COAP_TYPE_ACK                2U
+#define COAP_TYPE_RST                3U
+#define COAP_CODE_EMPTY              0x00U
+#define COAP_CODE_GET                0x01U
+#define COAP_CODE_CONTENT            0x45U
+#define COAP_OPTION_URI_HOST         3U
+#define COAP_OPTION_URI_PATH         11U
+#define COAP_PAYLOAD_MARKER          0xFFU
+#define COAP_HEADER_SIZE             4U
+
+/* Receive buffer of the onboarding response. */
+#define NCE_ONBOARD_RESPONSE_SIZE    150U
+
+/**
+ * @brief Decoded view of a received CoAP message.
+ */
+typedef struct NceCoapMessage
+{
+    uint8_t type;
+    uint8_t code;
+    uint16_t messageId;
+    uint8_t tokenLength;
+    const uint8_t * pPayload;
+    size_t payloadLength;
+} NceCoapMessage_t;
+
 /**
  * @brief Create Incremental Message ID for CoAP onboarding
  *
@@ -53,53 +83,253 @@ static uint16_t _getNextMessageID()
     return message_id;
 }
 
+/*-----------------------------------------------------------*/
+
 /**
- * @brief Process the DTLS credential to match the requirement
+ * @brief Append one CoAP option, using the extended delta and length forms when needed.
  *
- * @param[in] packet: the target packet to be processed.
- * @param[in] nceKey: the new DTLS credential required.
+ * @return false if the option does not fit the buffer.
+ */
+static bool _coap_put_option( uint8_t * pBuffer,
+                              size_t bufferSize,
+                              size_t * pLength,
+                              uint16_t delta,
+                              const char * pValue,
+                              size_t valueLength )
+{
+    uint8_t header[ 5 ];
+    size_t headerLength = 1U;
+    uint8_t nibble;
+
+    if( delta < 13U )
+    {
+        nibble = ( uint8_t ) delta;
+    }
+    else
+    {
+        nibble = 13U;
+        header[ headerLength++ ] = ( uint8_t ) ( delta - 13U );
+    }
+
+    header[ 0 ] = ( uint8_t ) ( nibble << 4 );
+
+    if( valueLength < 13U )
+    {
+        header[ 0 ] |= ( uint8_t ) valueLength;
+    }
+    else if( valueLength < 269U )
+    {
+        header[ 0 ] |= 13U;
+        header[ headerLength++ ] = ( uint8_t ) ( valueLength - 13U );
+    }
+    else
+    {
+        return false;
+    }
+
+    if( ( bufferSize - *pLength ) < ( headerLength + valueLength ) )
+    {
+        return false;
+    }
+
+    memcpy( pBuffer + *pLength, header, headerLength );
+    memcpy( pBuffer + *pLength + headerLength, pValue, valueLength );
+    *pLength += headerLength + valueLength;
+
+    return true;
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Encode the confirmable GET coap://coap.os.1nce.com/bootstrap request.
+ */
+static bool _coap_encode_onboard_request( NceAuthRequest_t * pRequest )
+{
+    size_t length = COAP_HEADER_SIZE;
+    bool status;
+
+    pRequest->messageId = _getNextMessageID();
+
+    /* Version 1, confirmable, no token. */
+    pRequest->request[ 0 ] = ( uint8_t ) ( ( COAP_VERSION << 6 ) | ( COAP_TYPE_CON << 4 ) );
+    pRequest->request[ 1 ] = COAP_CODE_GET;
+    pRequest->request[ 2 ] = ( uint8_t ) ( pRequest->messageId >> 8 );
+    pRequest->request[ 3 ] = ( uint8_t ) ( pRequest->messageId & 0xFFU );
+
+    status = _coap_put_option( pRequest->request, sizeof( pRequest->request ), &length,
+                               COAP_OPTION_URI_HOST, NceOnboard.host, strlen( NceOnboard.host ) );
+
+    if( status == true )
+    {
+        status = _coap_put_option( pRequest->request, sizeof( pRequest->request ), &length,
+                                   COAP_OPTION_URI_PATH - COAP_OPTION_URI_HOST, "bootstrap", 9U );
+    }
+
+    pRequest->requestLength = length;
+
+    return status;
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Read an extended option delta or length field.
  *
+ * @return false if the field is reserved or truncated.
  */
-static int _get_psk( char * packet,
-                     DtlsKey_t * nceKey )
+static bool _coap_read_extended( const uint8_t * pMessage,
+                                 size_t length,
+                                 size_t * pIndex,
+                                 uint8_t nibble,
+                                 size_t * pValue )
 {
-    int status = NCE_SDK_PARSING_ERROR;
-    char * resp = strstr( packet, "89" );
+    bool status = true;
 
-    if( resp == NULL )
+    if( nibble < 13U )
     {
-        NceOSLogError( "ERROR: Packet can't be NULL\n" );
-        return status;
+        *pValue = nibble;
+    }
+    else if( ( nibble == 13U ) && ( *pIndex < length ) )
+    {
+        *pValue = ( size_t ) pMessage[ *pIndex ] + 13U;
+        *pIndex += 1U;
+    }
+    else if( ( nibble == 14U ) && ( ( length - *pIndex ) >= 2U ) )
+    {
+        *pValue = ( ( ( size_t ) pMessage[ *pIndex ] << 8 ) | pMessage[ *pIndex + 1U ] ) + 269U;
+        *pIndex += 2U;
     }
     else
     {
-        char * p = strtok( resp, "," );
+        status = false;
+    }
 
-        if( p == NULL )
-        {
-            NceOSLogError( "ERROR: Parsing Error\n" );
-            return status;
-        }
-        else
-        {
-            strcpy( nceKey->PskIdentity, p );
-        }
+    return status;
+}
 
-        p = strtok( NULL, "," );
+/*-----------------------------------------------------------*/
 
-        if( p == NULL )
+/**
+ * @brief Parse a CoAP message, checking every length against the received size.
+ *
+ * Options are skipped, only the header, token length and payload are kept.
+ */
+static bool _coap_parse( const uint8_t * pMessage,
+                         size_t length,
+                         NceCoapMessage_t * pParsed )
+{
+    size_t index;
+    size_t delta;
+    size_t optionLength;
+    uint8_t optionHeader;
+
+    if( ( length < COAP_HEADER_SIZE ) || ( ( pMessage[ 0 ] >> 6 ) != COAP_VERSION ) )
+    {
+        return false;
+    }
+
+    pParsed->type = ( uint8_t ) ( ( pMessage[ 0 ] >> 4 ) & 0x03U );
+    pParsed->tokenLength = ( uint8_t ) ( pMessage[ 0 ] & 0x0FU );
+    pParsed->code = pMessage[ 1 ];
+    pParsed->messageId = ( uint16_t ) ( ( pMessage[ 2 ] << 8 ) | pMessage[ 3 ] );
+    pParsed->pPayload = NULL;
+    pParsed->payloadLength = 0U;
+
+    index = COAP_HEADER_SIZE + pParsed->tokenLength;
+
+    if( ( pParsed->tokenLength > 8U ) || ( index > length ) )
+    {
+        return false;
+    }
+
+    while( index < length )
+    {
+        if( pMessage[ index ] == COAP_PAYLOAD_MARKER )
         {
-            NceOSLogError( "ERROR: Parsing Error\n" );
-            return status;
+            /* A marker must be followed by a payload. */
+            index++;
+
+            if( index == length )
+            {
+                return false;
+            }
+
+            pParsed->pPayload = pMessage + index;
+            pParsed->payloadLength = length - index;
+            break;
         }
-        else
+
+        optionHeader = pMessage[ index ];
+        index++;
+
+        if( ( _coap_read_extended( pMessage, length, &index, ( uint8_t ) ( optionHeader >> 4 ), &delta ) == false ) ||
+            ( _coap_read_extended( pMessage, length, &index, ( uint8_t ) ( optionHeader & 0x0FU ), &optionLength ) == false ) ||
+            ( optionLength > ( length - index ) ) )
         {
-            strcpy( nceKey->Psk, p );
+            return false;
         }
 
-        NceOSLogInfo( "DTLS Credentials Recieved.\n" );
-        return NCE_SDK_SUCCESS;
+        index += optionLength;
+    }
+
+    return true;
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Extract the DTLS credentials from the onboarding response payload.
+ *
+ * The payload holds the identity (the ICCID, starting with "89") and the PSK
+ * separated by commas. Fields that do not fit DtlsKey_t are rejected.
+ *
+ * @param[in] pPayload: Response payload, not terminated.
+ * @param[in] payloadLength: Payload length.
+ * @param[out] nceKey: the new DTLS credential required.
+ */
+static int _get_psk( const uint8_t * pPayload,
+                     size_t payloadLength,
+                     DtlsKey_t * nceKey )
+{
+    size_t start = 0U;
+    size_t end;
+    size_t pskEnd;
+
+    while( ( ( start + 1U ) < payloadLength ) && ( ( pPayload[ start ] != '8' ) || ( pPayload[ start + 1U ] != '9' ) ) )
+    {
+        start++;
+    }
+
+    if( ( start + 1U ) >= payloadLength )
+    {
+        NceOSLogError( "ERROR: Identity not found in response.\n" );
+        return NCE_SDK_PARSING_ERROR;
     }
+
+    for( end = start; ( end < payloadLength ) && ( pPayload[ end ] != ',' ); end++ )
+    {
+    }
+
+    for( pskEnd = end + 1U; ( pskEnd < payloadLength ) && ( pPayload[ pskEnd ] != ',' ) &&
+         ( pPayload[ pskEnd ] != '\r' ) && ( pPayload[ pskEnd ] != '\n' ); pskEnd++ )
+    {
+    }
+
+    if( ( end >= payloadLength ) || ( pskEnd == ( end + 1U ) ) ||
+        ( ( end - start ) >= sizeof( nceKey->PskIdentity ) ) ||
+        ( ( pskEnd - end - 1U ) >= sizeof( nceKey->Psk ) ) )
+    {
+        NceOSLogError( "ERROR: Parsing Error\n" );
+        return NCE_SDK_PARSING_ERROR;
+    }
+
+    memset( nceKey, 0, sizeof( *nceKey ) );
+    memcpy( nceKey->PskIdentity, pPayload + start, end - start );
+    memcpy( nceKey->Psk, pPayload + end + 1U, pskEnd - end - 1U );
+
+    NceOSLogInfo( "DTLS Credentials Recieved.\n" );
+    return NCE_SDK_SUCCESS;
 }
 
 /*-----------------------------------------------------------*/
@@ -150,114 +380,203 @@ static int _os_udp_connect( os_network_ops_t * osNetwork )
 /*-----------------------------------------------------------*/
 
 /**
- * @brief Send CoAP GET request to 1NCE.
+ * @brief Acknowledge a confirmable separate response.
+ */
+static void _os_coap_ack( os_network_ops_t * osNetwork,
+                          uint16_t messageId )
+{
+    uint8_t ack[ COAP_HEADER_SIZE ];
+
+    ack[ 0 ] = ( uint8_t ) ( ( COAP_VERSION << 6 ) | ( COAP_TYPE_ACK << 4 ) );
+    ack[ 1 ] = COAP_CODE_EMPTY;
+    ack[ 2 ] = ( uint8_t ) ( messageId >> 8 );
+    ack[ 3 ] = ( uint8_t ) ( messageId & 0xFFU );
+
+    ( void ) osNetwork->nce_os_udp_send( osNetwork->os_socket, ack, sizeof( ack ) );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Wait for the response to the onboarding request.
  *
+ * The request is retransmitted with the same message ID each time the receive
+ * times out, until it is acknowledged or NCE_SDK_ATTEMPTS transmissions were
+ * made. Messages that don't belong to the exchange are dropped.
  *
- * @param[in] osNetwork: udp interface object.
- * @param[in] pBuffer: Buffer to be used by the interface.
- * @param[in] bufferSize: allocated size for the interface buffer.
- *
- * @return The amount of bytes received.
+ * @return The status of the onboarding.
  */
-static int _os_coap_onboard( os_network_ops_t * osNetwork,
-                             void * pBuffer,
-                             size_t bufferSize )
+static int _os_coap_onboard_response( os_network_ops_t * osNetwork,
+                                      NceAuthRequest_t * pRequest,
+                                      DtlsKey_t * nceKey )
 {
-    int status = NCE_SDK_SEND_ERROR;
+    uint8_t packet[ NCE_ONBOARD_RESPONSE_SIZE ];
+    NceCoapMessage_t response;
+    int received;
+    int transmissions = 1;
+    int dropped = 0;
 
-    /*  0x50 : 01 -> CoAP Version
-     *          01 -> Non-Confirmable CoAP message
-     *          0000 -> 0 Token length
-     *  0x01 : GET REQUEST
-     */
-    static const unsigned char coap_header[] = { 0x50, 0x01 };
+    for( ; ; )
+    {
+        received = osNetwork->nce_os_udp_recv( osNetwork->os_socket, packet, sizeof( packet ) );
 
-    /*  0x3d : 0011 -> Opt. delta (3)
-     *          1101 -> Opt. Length (13)
-     *  0x03 : Opt. Length Extended (3) for a total length of 16 "coap.os.1nce.com"
-     */
-    static const unsigned char uri_host_option[] = { 0x3d, 0x03 };
+        if( received < 0 )
+        {
+            NceOSLogError( "Failed to receive Device credential.\n" );
+            return NCE_SDK_RECEIVE_ERROR;
+        }
 
-    /*0x89 : 1000 -> Opt. delta (8)
-     *          1001 -> Opt. Length (9) "bootstrap"
-     */
-    static const unsigned char uri_path_option[] = { 0x89 };
+        if( received == 0 )
+        {
+            if( transmissions >= NCE_SDK_ATTEMPTS )
+            {
+                NceOSLogError( "Device Authenticator did not respond.\n" );
+                return NCE_SDK_RECEIVE_ERROR;
+            }
 
-    /* Create Message ID */
-    uint16_t message_id = _getNextMessageID();
-    char message_id_str[ 2 ];
+            transmissions++;
+
+            /* Once acknowledged, the server owns the exchange and only the wait is repeated. */
+            if( ( pRequest->acknowledged == false ) &&
+                ( osNetwork->nce_os_udp_send( osNetwork->os_socket, pRequest->request, pRequest->requestLength ) < 0 ) )
+            {
+                NceOSLogError( "Failed to send Device Authenticator request.\n" );
+                return NCE_SDK_SEND_ERROR;
+            }
 
-    memcpy( message_id_str, &message_id, 2 );
+            continue;
+        }
 
+        if( _coap_parse( packet, ( size_t ) received, &response ) == false )
+        {
+            NceOSLogError( "Dropping malformed CoAP message.\n" );
+        }
+        else if( ( response.type == COAP_TYPE_ACK ) && ( response.messageId == pRequest->messageId ) )
+        {
+            if( response.code != COAP_CODE_EMPTY )
+            {
+                break;
+            }
 
-    NceOSLogInfo( "Start 1NCE device onboarding.\n" );
-    memset( pBuffer, '\0', bufferSize * sizeof( char ) );
-    sprintf( pBuffer, "%.2s%.2s%.2s%s%.1sbootstrap", coap_header, message_id_str, uri_host_option, NceOnboard.host, uri_path_option );
-    NceOSLogInfo( "Send Device Authenticator request.\n" );
-    status = osNetwork->nce_os_udp_send( osNetwork->os_socket, pBuffer, strlen( pBuffer ) );
+            /* Empty ACK: the response follows separately. */
+            pRequest->acknowledged = true;
+            continue;
+        }
+        else if( ( response.type == COAP_TYPE_RST ) && ( response.messageId == pRequest->messageId ) )
+        {
+            NceOSLogError( "Device Authenticator request was reset.\n" );
+            return NCE_SDK_PARSING_ERROR;
+        }
+        else if( ( ( response.type == COAP_TYPE_CON ) || ( response.type == COAP_TYPE_NON ) ) &&
+                 ( response.tokenLength == 0U ) && ( response.code >= 0x40U ) )
+        {
+            /* Separate response, matched by the (empty) token. */
+            if( response.type == COAP_TYPE_CON )
+            {
+                _os_coap_ack( osNetwork, response.messageId );
+            }
 
-    if( status < 0 )
-    {
-        NceOSLogError( "Failed to send Device Authenticator request.\n" );
-        status = NCE_SDK_SEND_ERROR;
-    }
-    else
-    {
-        memset( pBuffer, '\0', bufferSize * sizeof( char ) );
-        status = osNetwork->nce_os_udp_recv( osNetwork->os_socket, pBuffer, bufferSize );
+            break;
+        }
 
-        if( status < 0 )
+        if( ++dropped >= NCE_SDK_ATTEMPTS )
         {
-            NceOSLogError( "Failed to receive Device credential.\n" );
-            status = NCE_SDK_RECEIVE_ERROR;
+            NceOSLogError( "Too many unexpected CoAP messages.\n" );
+            return NCE_SDK_PARSING_ERROR;
         }
     }
 
-    return status;
+    if( response.code != COAP_CODE_CONTENT )
+    {
+        NceOSLogError( "Device Authenticator responded %u.%02u.\n", ( unsigned ) ( response.code >> 5 ), ( unsigned ) ( response.code & 0x1FU ) );
+        return NCE_SDK_PARSING_ERROR;
+    }
+
+    return _get_psk( response.pPayload, response.payloadLength, nceKey );
 }
 
 /*-----------------------------------------------------------*/
 
-int os_auth( os_network_ops_t * osNetwork,
-             DtlsKey_t * nceKey )
+int os_auth_start( os_network_ops_t * osNetwork,
+                   NceAuthRequest_t * pRequest )
 {
-    int status = NCE_SDK_CONNECT_ERROR;
-    int attempts = 1;
-    char packet[ 150 ];
-
-    status = _os_udp_connect( osNetwork );
+    int status = _os_udp_connect( osNetwork );
 
     if( status < 0 )
     {
         NceOSLogError( "Failed to Connect to 1NCE Endpoint\n" );
         return status;
     }
-    else
+
+    memset( pRequest, 0, sizeof( *pRequest ) );
+
+    if( _coap_encode_onboard_request( pRequest ) == false )
     {
-        do
-        {
-            status = _os_coap_onboard( osNetwork, packet, sizeof( packet ) );
-            attempts++;
-        } while( status <= 0 && attempts < NCE_SDK_ATTEMPTS );
+        ( void ) osNetwork->nce_os_udp_disconnect( osNetwork->os_socket );
+        return NCE_SDK_SEND_ERROR;
+    }
+
+    NceOSLogInfo( "Send Device Authenticator request.\n" );
+    status = osNetwork->nce_os_udp_send( osNetwork->os_socket, pRequest->request, pRequest->requestLength );
+
+    if( status < 0 )
+    {
+        NceOSLogError( "Failed to send Device Authenticator request.\n" );
+        ( void ) osNetwork->nce_os_udp_disconnect( osNetwork->os_socket );
+        return NCE_SDK_SEND_ERROR;
     }
 
-    if( status > 0 )
+    pRequest->pending = true;
+
+    return NCE_SDK_SUCCESS;
+}
+
+/*-----------------------------------------------------------*/
+
+int os_auth_finish( os_network_ops_t * osNetwork,
+                    NceAuthRequest_t * pRequest,
+                    DtlsKey_t * nceKey )
+{
+    int status;
+    int disconnectStatus;
+
+    if( pRequest->pending == false )
     {
-        status = _get_psk( packet, nceKey );
+        return NCE_SDK_SEND_ERROR;
+    }
 
-        if( status < 0 )
+    pRequest->pending = false;
+    status = _os_coap_onboard_response( osNetwork, pRequest, nceKey );
+
+    disconnectStatus = osNetwork->nce_os_udp_disconnect( osNetwork->os_socket );
+
+    if( disconnectStatus < 0 )
+    {
+        NceOSLogError( "Failed to close socket.\n" );
+
+        if( status == NCE_SDK_SUCCESS )
         {
-            NceOSLogError( "Failed to parse response.\n" );
-            return status;
+            status = disconnectStatus;
         }
     }
 
-    status = osNetwork->nce_os_udp_disconnect( osNetwork->os_socket );
+    return status;
+}
 
-    if( status < 0 )
+/*-----------------------------------------------------------*/
+
+int os_auth( os_network_ops_t * osNetwork,
+             DtlsKey_t * nceKey )
+{
+    NceAuthRequest_t request;
+    int status;
+
+    NceOSLogInfo( "Start 1NCE device onboarding.\n" );
+    status = os_auth_start( osNetwork, &request );
+
+    if( status == NCE_SDK_SUCCESS )
     {
-        NceOSLogError( "Failed to close socket.\n" );
-        return status;
+        status = os_auth_finish( osNetwork, &request, nceKey );
     }
 
     return status;
@@ -308,4 +627,226 @@ int os_energy_save( char * packet,
     return location;
 }
 
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Write the low @p length bytes of @p value in the given byte order.
+ */
+static void _writeField( uint8_t * pDest,
+                         uint32_t value,
+                         uint8_t length,
+                         NceEndianness_t endianness )
+{
+    uint8_t i;
+
+    for( i = 0U; i < length; i++ )
+    {
+        if( endianness == NCE_BIG_ENDIAN )
+        {
+            pDest[ length - 1U - i ] = ( uint8_t ) ( value >> ( 8U * i ) );
+        }
+        else
+        {
+            pDest[ i ] = ( uint8_t ) ( value >> ( 8U * i ) );
+        }
+    }
+}
+
+/**
+ * @brief Read an unsigned record member of 1, 2 or 4 bytes.
+ */
+static uint32_t _readUnsigned( const uint8_t * pMember,
+                               uint8_t memberSize )
+{
+    uint8_t u8;
+    uint16_t u16;
+    uint32_t u32 = 0U;
+
+    if( memberSize == sizeof( u8 ) )
+    {
+        memcpy( &u8, pMember, sizeof( u8 ) );
+        u32 = u8;
+    }
+    else if( memberSize == sizeof( u16 ) )
+    {
+        memcpy( &u16, pMember, sizeof( u16 ) );
+        u32 = u16;
+    }
+    else
+    {
+        memcpy( &u32, pMember, sizeof( u32 ) );
+    }
+
+    return u32;
+}
+
+/**
+ * @brief Read a signed record member of 1, 2 or 4 bytes.
+ */
+static int32_t _readSigned( const uint8_t * pMember,
+                            uint8_t memberSize )
+{
+    int8_t i8;
+    int16_t i16;
+    int32_t i32 = 0;
+
+    if( memberSize == sizeof( i8 ) )
+    {
+        memcpy( &i8, pMember, sizeof( i8 ) );
+        i32 = i8;
+    }
+    else if( memberSize == sizeof( i16 ) )
+    {
+        memcpy( &i16, pMember, sizeof( i16 ) );
+        i32 = i16;
+    }
+    else
+    {
+        memcpy( &i32, pMember, sizeof( i32 ) );
+    }
+
+    return i32;
+}
+
+/**
+ * @brief Check that a value truncated toward zero fits a two's complement field of @p length bytes.
+ */
+static bool _signedFits( double value,
+                         uint8_t length )
+{
+    double limit = ( double ) ( ( uint32_t ) 1U << ( ( 8U * length ) - 1U ) );
+
+    return ( value > ( -limit - 1.0 ) ) && ( value < limit );
+}
+
+/**
+ * @brief Encode one template field into @p pDest.
+ */
+static int _encodeField( uint8_t * pDest,
+                         const NceTemplateField_t * pField,
+                         const uint8_t * pRecord )
+{
+    const uint8_t * pMember = pRecord + pField->offset;
+    uint32_t raw = 0U;
+    int32_t signedValue;
+    float floatValue;
+    double scaled;
+    const uint8_t * pEnd;
+    size_t stringLength;
+    int status = NCE_SDK_SUCCESS;
+
+    switch( pField->type )
+    {
+        case NCE_FIELD_UINT:
+            raw = _readUnsigned( pMember, pField->memberSize );
+
+            if( ( pField->length < 4U ) && ( raw >= ( ( uint32_t ) 1U << ( 8U * pField->length ) ) ) )
+            {
+                status = NCE_SDK_BINARY_PAYLOAD_ERROR;
+            }
+
+            break;
+
+        case NCE_FIELD_INT:
+            signedValue = _readSigned( pMember, pField->memberSize );
+
+            if( _signedFits( ( double ) signedValue, pField->length ) == false )
+            {
+                status = NCE_SDK_BINARY_PAYLOAD_ERROR;
+            }
+
+            raw = ( uint32_t ) signedValue;
+            break;
+
+        case NCE_FIELD_SCALED:
+            memcpy( &floatValue, pMember, sizeof( floatValue ) );
+            scaled = ( double ) floatValue * ( double ) pField->scale;
+            scaled = ( scaled < 0.0 ) ? ( scaled - 0.5 ) : ( scaled + 0.5 );
+
+            /* NaN fails the range check as well. */
+            if( _signedFits( scaled, pField->length ) == false )
+            {
+                status = NCE_SDK_BINARY_PAYLOAD_ERROR;
+            }
+            else
+            {
+                raw = ( uint32_t ) ( int32_t ) scaled;
+            }
+
+            break;
+
+        case NCE_FIELD_FLOAT:
+            memcpy( &raw, pMember, sizeof( raw ) );
+            break;
+
+        case NCE_FIELD_STRING:
+            /* The member need not be terminated when it fills the field. */
+            pEnd = memchr( pMember, 0, pField->length );
+            stringLength = ( pEnd == NULL ) ? pField->length : ( size_t ) ( pEnd - pMember );
+
+            memcpy( pDest, pMember, stringLength );
+            memset( pDest + stringLength, 0, pField->length - stringLength );
+            break;
+
+        default:
+            status = NCE_SDK_BINARY_PAYLOAD_ERROR;
+            break;
+    }
+
+    if( ( status == NCE_SDK_SUCCESS ) && ( pField->type != NCE_FIELD_STRING ) )
+    {
+        _writeField( pDest, raw, pField->length, pField->endianness );
+    }
+
+    return status;
+}
+
+/*-----------------------------------------------------------*/
+
+size_t os_energy_save_length( const NceTemplate_t * pTemplate )
+{
+    size_t length = 1U;
+    size_t i;
+
+    for( i = 0U; i < pTemplate->fieldCount; i++ )
+    {
+        length += pTemplate->pFields[ i ].length;
+    }
+
+    return length;
+}
+
+/*-----------------------------------------------------------*/
+
+int os_energy_save_record( uint8_t * pBuffer,
+                           size_t bufferSize,
+                           const NceTemplate_t * pTemplate,
+                           const void * pRecord )
+{
+    size_t location = 1U;
+    size_t i;
+
+    if( ( pBuffer == NULL ) || ( pTemplate == NULL ) || ( pRecord == NULL ) ||
+        ( bufferSize < os_energy_save_length( pTemplate ) ) )
+    {
+        NceOSLogError( "Conversion Error, payload buffer too small.\n" );
+        return NCE_SDK_BINARY_PAYLOAD_ERROR;
+    }
+
+    pBuffer[ 0 ] = pTemplate->selector;
+
+    for( i = 0U; i < pTemplate->fieldCount; i++ )
+    {
+        if( _encodeField( pBuffer + location, &pTemplate->pFields[ i ], ( const uint8_t * ) pRecord ) != NCE_SDK_SUCCESS )
+        {
+            NceOSLogError( "Conversion Error, field %u does not fit its template length.\n", ( unsigned ) i );
+            return NCE_SDK_BINARY_PAYLOAD_ERROR;
+        }
+
+        location += pTemplate->pFields[ i ].length;
+    }
+
+    return ( int ) location;
+}
+
 #endif /* ifdef NCE_ENERGY_SAVER */
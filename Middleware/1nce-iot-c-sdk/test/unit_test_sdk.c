@@ -6,8 +6,47 @@
 #define SAMPLE_UDP_SOCKET    0
 
 /* Sample responses */
-char SAMPLE_RESPONSE_SUCCESS[] = "***89*****,ID,PSK";
-char SAMPLE_RESPONSE_FAILURE[] =  {0x50, 0x84, 0x8A, 0x8B};;
+char SAMPLE_RESPONSE_SUCCESS[] = "8988228066612345678,PSK";
+char SAMPLE_RESPONSE_FAILURE[] =  {0x50, 0x84, 0x8A, 0x8B};
+
+/* Last datagram sent by the SDK and number of datagrams sent. */
+uint8_t sentPacket[ 64 ];
+size_t sentLength = 0;
+int sendCount = 0;
+
+/* Message ID of the onboarding request. */
+uint16_t requestMessageId = 0;
+
+/* Number of receive calls. */
+int recvCount = 0;
+
+/**
+ * @brief Build a CoAP response to the onboarding request.
+ */
+static int build_coap_response( uint8_t * pBuffer,
+                                uint8_t type,
+                                uint8_t code,
+                                uint16_t messageId,
+                                const char * pPayload )
+{
+    size_t length = 4;
+
+    pBuffer[ 0 ] = ( uint8_t ) ( 0x40 | ( type << 4 ) );
+    pBuffer[ 1 ] = code;
+    pBuffer[ 2 ] = ( uint8_t ) ( messageId >> 8 );
+    pBuffer[ 3 ] = ( uint8_t ) messageId;
+
+    if( pPayload != NULL )
+    {
+        /* Content-Format: text/plain, then the payload. */
+        pBuffer[ length++ ] = 0xC0;
+        pBuffer[ length++ ] = 0xFF;
+        memcpy( &pBuffer[ length ], pPayload, strlen( pPayload ) );
+        length += strlen( pPayload );
+    }
+
+    return ( int ) length;
+}
 
 /* Sample Network definitions */
 struct OSNetwork
@@ -45,6 +84,16 @@ int udp_send_mock( OSNetwork_t osnetwork,
                    void * pBuffer,
                    size_t bytesToSend )
 {
+    memcpy( sentPacket, pBuffer, bytesToSend );
+    sentLength = bytesToSend;
+    sendCount++;
+
+    /* Confirmable request. */
+    if( ( sentPacket[ 0 ] & 0x30 ) == 0x00 )
+    {
+        requestMessageId = ( uint16_t ) ( ( sentPacket[ 2 ] << 8 ) | sentPacket[ 3 ] );
+    }
+
     return bytesToSend;
 }
 
@@ -55,9 +104,8 @@ int udp_recv_mock_success( OSNetwork_t osnetwork,
                            void * pBuffer,
                            size_t bytesToRecv )
 {
-    bytesToRecv = strlen( SAMPLE_RESPONSE_SUCCESS );
-    memcpy( pBuffer, SAMPLE_RESPONSE_SUCCESS, strlen( SAMPLE_RESPONSE_SUCCESS ) );
-    return bytesToRecv;
+    /* Piggybacked 2.05 Content response. */
+    return build_coap_response( pBuffer, 2, 0x45, requestMessageId, SAMPLE_RESPONSE_SUCCESS );
 }
 
 /**
@@ -67,11 +115,55 @@ int udp_recv_mock_failure( OSNetwork_t osnetwork,
                            void * pBuffer,
                            size_t bytesToRecv )
 {
-    bytesToRecv = strlen( SAMPLE_RESPONSE_FAILURE );
-    memcpy( pBuffer, SAMPLE_RESPONSE_FAILURE, strlen( SAMPLE_RESPONSE_FAILURE ) );
+    bytesToRecv = sizeof( SAMPLE_RESPONSE_FAILURE );
+    memcpy( pBuffer, SAMPLE_RESPONSE_FAILURE, sizeof( SAMPLE_RESPONSE_FAILURE ) );
     return bytesToRecv;
 }
 
+/**
+ * @brief Mocked udp recv timing out once before the server responds.
+ */
+int udp_recv_mock_timeout_once( OSNetwork_t osnetwork,
+                                void * pBuffer,
+                                size_t bytesToRecv )
+{
+    if( recvCount++ == 0 )
+    {
+        return 0;
+    }
+
+    return build_coap_response( pBuffer, 2, 0x45, requestMessageId, SAMPLE_RESPONSE_SUCCESS );
+}
+
+/**
+ * @brief Mocked udp recv returning an empty ACK followed by a confirmable separate response.
+ */
+int udp_recv_mock_separate( OSNetwork_t osnetwork,
+                            void * pBuffer,
+                            size_t bytesToRecv )
+{
+    if( recvCount++ == 0 )
+    {
+        return build_coap_response( pBuffer, 2, 0x00, requestMessageId, NULL );
+    }
+
+    return build_coap_response( pBuffer, 0, 0x45, 0x1234, SAMPLE_RESPONSE_SUCCESS );
+}
+
+/**
+ * @brief Mocked udp recv returning an option whose length exceeds the datagram.
+ */
+int udp_recv_mock_truncated( OSNetwork_t osnetwork,
+                             void * pBuffer,
+                             size_t bytesToRecv )
+{
+    int length = build_coap_response( pBuffer, 2, 0x45, requestMessageId, NULL );
+
+    ( ( uint8_t * ) pBuffer )[ length++ ] = 0xCD;
+    ( ( uint8_t * ) pBuffer )[ length++ ] = 0x40;
+    return length;
+}
+
 
 /**
  * @brief Mocked udp disconnect returning success.
@@ -83,6 +175,10 @@ int udp_disconnect_mock( OSNetwork_t osnetwork )
 
 void setUp( void )
 {
+    sentLength = 0;
+    sendCount = 0;
+    recvCount = 0;
+    memset( &nceKey, 0, sizeof( nceKey ) );
 }
 
 
@@ -106,6 +202,8 @@ void test_os_auth_success_response( void )
     };
 
     TEST_ASSERT_EQUAL_INT( os_auth( &osNetwork, &nceKey ), NCE_SDK_SUCCESS );
+    TEST_ASSERT_EQUAL_STRING( "8988228066612345678", nceKey.PskIdentity );
+    TEST_ASSERT_EQUAL_STRING( "PSK", nceKey.Psk );
 }
 
 /**
@@ -143,6 +241,67 @@ void test_os_auth_failure_response( void )
 }
 
 
+/**
+ * @brief Test 3a ( lost response, the confirmable request is retransmitted with the same message ID ).
+ */
+void test_os_auth_retransmission( void )
+{
+    os_network_ops_t osNetwork =
+    {
+        .os_socket             = &xOSNetwork,
+        .nce_os_udp_connect    = udp_connect_mock_success,
+        .nce_os_udp_send       = udp_send_mock,
+        .nce_os_udp_recv       = udp_recv_mock_timeout_once,
+        .nce_os_udp_disconnect = udp_disconnect_mock
+    };
+    NceAuthRequest_t request;
+
+    TEST_ASSERT_EQUAL_INT( NCE_SDK_SUCCESS, os_auth_start( &osNetwork, &request ) );
+    TEST_ASSERT_EQUAL_HEX8( 0x40, sentPacket[ 0 ] );
+    TEST_ASSERT_EQUAL_HEX8( 0x01, sentPacket[ 1 ] );
+    TEST_ASSERT_EQUAL_INT( NCE_SDK_SUCCESS, os_auth_finish( &osNetwork, &request, &nceKey ) );
+    TEST_ASSERT_EQUAL_INT( 2, sendCount );
+    TEST_ASSERT_EQUAL_MEMORY( request.request, sentPacket, request.requestLength );
+}
+
+/**
+ * @brief Test 3b ( empty ACK, then a confirmable separate response that gets acknowledged ).
+ */
+void test_os_auth_separate_response( void )
+{
+    os_network_ops_t osNetwork =
+    {
+        .os_socket             = &xOSNetwork,
+        .nce_os_udp_connect    = udp_connect_mock_success,
+        .nce_os_udp_send       = udp_send_mock,
+        .nce_os_udp_recv       = udp_recv_mock_separate,
+        .nce_os_udp_disconnect = udp_disconnect_mock
+    };
+    const uint8_t expectedAck[] = { 0x60, 0x00, 0x12, 0x34 };
+
+    TEST_ASSERT_EQUAL_INT( NCE_SDK_SUCCESS, os_auth( &osNetwork, &nceKey ) );
+    TEST_ASSERT_EQUAL_INT( sizeof( expectedAck ), sentLength );
+    TEST_ASSERT_EQUAL_MEMORY( expectedAck, sentPacket, sizeof( expectedAck ) );
+    TEST_ASSERT_EQUAL_STRING( "PSK", nceKey.Psk );
+}
+
+/**
+ * @brief Test 3c ( option length beyond the end of the datagram ).
+ */
+void test_os_auth_truncated_response( void )
+{
+    os_network_ops_t osNetwork =
+    {
+        .os_socket             = &xOSNetwork,
+        .nce_os_udp_connect    = udp_connect_mock_success,
+        .nce_os_udp_send       = udp_send_mock,
+        .nce_os_udp_recv       = udp_recv_mock_truncated,
+        .nce_os_udp_disconnect = udp_disconnect_mock
+    };
+
+    TEST_ASSERT_EQUAL_INT( NCE_SDK_PARSING_ERROR, os_auth( &osNetwork, &nceKey ) );
+}
+
 /**
  * @brief Test 4 ( successful binary conversion ).
  */
@@ -175,3 +334,90 @@ void test_os_energy_save_failure( void )
     TEST_ASSERT_EQUAL_INT( os_energy_save( pcTransmittedString, selector, 2, software_version ), NCE_SDK_BINARY_PAYLOAD_ERROR );
 }
 
+
+/* Sample record and template for the typed energy saver encoder. */
+typedef struct SampleTelemetry
+{
+    uint8_t batteryLevel;
+    int16_t rssi;
+    uint32_t uptime;
+    float temperature;
+    float pressure;
+    char version[ 8 ];
+} SampleTelemetry_t;
+
+static const NceTemplateField_t sampleFields[] =
+{
+    NCE_TEMPLATE_UINT( SampleTelemetry_t, batteryLevel, 1U, NCE_BIG_ENDIAN ),
+    NCE_TEMPLATE_INT( SampleTelemetry_t, rssi, 2U, NCE_LITTLE_ENDIAN ),
+    NCE_TEMPLATE_UINT( SampleTelemetry_t, uptime, 3U, NCE_BIG_ENDIAN ),
+    NCE_TEMPLATE_SCALED( SampleTelemetry_t, temperature, 2U, NCE_BIG_ENDIAN, 100.0f ),
+    NCE_TEMPLATE_FLOAT( SampleTelemetry_t, pressure, NCE_LITTLE_ENDIAN ),
+    NCE_TEMPLATE_STRING( SampleTelemetry_t, version, 5U )
+};
+
+static const NceTemplate_t sampleTemplate = NCE_TEMPLATE( 7U, sampleFields );
+
+/**
+ * @brief Reference decoder, translates a payload back the way the 1NCE service does.
+ */
+static void decode_sample_payload( const uint8_t * payload,
+                                   SampleTelemetry_t * record )
+{
+    uint32_t raw;
+    int16_t scaled;
+
+    record->batteryLevel = payload[ 1 ];
+    record->rssi = ( int16_t ) ( payload[ 2 ] | ( payload[ 3 ] << 8 ) );
+    record->uptime = ( ( uint32_t ) payload[ 4 ] << 16 ) | ( ( uint32_t ) payload[ 5 ] << 8 ) | payload[ 6 ];
+    scaled = ( int16_t ) ( ( payload[ 7 ] << 8 ) | payload[ 8 ] );
+    record->temperature = ( float ) scaled / 100.0f;
+    raw = ( uint32_t ) payload[ 9 ] | ( ( uint32_t ) payload[ 10 ] << 8 ) |
+          ( ( uint32_t ) payload[ 11 ] << 16 ) | ( ( uint32_t ) payload[ 12 ] << 24 );
+    memcpy( &record->pressure, &raw, sizeof( raw ) );
+    memset( record->version, 0, sizeof( record->version ) );
+    memcpy( record->version, &payload[ 13 ], 5 );
+}
+
+/**
+ * @brief Test 6 ( typed template encoding round trip, including zero bytes ).
+ */
+void test_os_energy_save_record_round_trip( void )
+{
+    SampleTelemetry_t sent = { 0, -97, 0x010203, -12.34f, 1013.25f, "2.2.1" };
+    SampleTelemetry_t received;
+    uint8_t payload[ 32 ];
+
+    TEST_ASSERT_EQUAL_INT( 18, os_energy_save_length( &sampleTemplate ) );
+    TEST_ASSERT_EQUAL_INT( 18, os_energy_save_record( payload, sizeof( payload ), &sampleTemplate, &sent ) );
+    TEST_ASSERT_EQUAL_HEX8( 7, payload[ 0 ] );
+    TEST_ASSERT_EQUAL_HEX8( 0, payload[ 1 ] );
+
+    decode_sample_payload( payload, &received );
+    TEST_ASSERT_EQUAL_UINT8( sent.batteryLevel, received.batteryLevel );
+    TEST_ASSERT_EQUAL_INT16( sent.rssi, received.rssi );
+    TEST_ASSERT_EQUAL_UINT32( sent.uptime, received.uptime );
+    TEST_ASSERT_FLOAT_WITHIN( 0.005f, sent.temperature, received.temperature );
+    TEST_ASSERT_EQUAL_FLOAT( sent.pressure, received.pressure );
+    TEST_ASSERT_EQUAL_STRING( sent.version, received.version );
+}
+
+/**
+ * @brief Test 7 ( typed template encoding - value out of field range or buffer too small - ).
+ */
+void test_os_energy_save_record_failure( void )
+{
+    SampleTelemetry_t sent = { 99, -97, 0x01000000, 21.5f, 1013.25f, "2.2.1" };
+    uint8_t payload[ 32 ];
+
+    /* uptime needs 4 bytes but the field has 3. */
+    TEST_ASSERT_EQUAL_INT( NCE_SDK_BINARY_PAYLOAD_ERROR, os_energy_save_record( payload, sizeof( payload ), &sampleTemplate, &sent ) );
+
+    sent.uptime = 1;
+    sent.temperature = 400.0f;
+    TEST_ASSERT_EQUAL_INT( NCE_SDK_BINARY_PAYLOAD_ERROR, os_energy_save_record( payload, sizeof( payload ), &sampleTemplate, &sent ) );
+
+    sent.temperature = 21.5f;
+    TEST_ASSERT_EQUAL_INT( NCE_SDK_BINARY_PAYLOAD_ERROR, os_energy_save_record( payload, 17, &sampleTemplate, &sent ) );
+    TEST_ASSERT_EQUAL_INT( 18, os_energy_save_record( payload, 18, &sampleTemplate, &sent ) );
+}
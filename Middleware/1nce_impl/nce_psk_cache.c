@@ -0,0 +1,351 @@
+/*
+ * nce_psk_cache.c
+ *
+ *  Flash cache of the DTLS credentials obtained from the 1NCE Device
+ *  Authenticator. Valid credentials survive a reset, so the device onboards
+ *  only when the DTLS handshake shows that the server rejected them. The same
+ *  flash page keeps the fingerprint of the modem configuration.
+ *
+ *  1NCE GmbH
+ */
+
+/* Standard includes. */
+#include <string.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* HAL includes. */
+#include "main.h"
+
+#include "nce_demo_config.h"
+#include "udp_impl.h"
+#include "nce_psk_cache.h"
+
+/* Record marker and layout version. */
+#define NCE_PSK_CACHE_MAGIC      ( 0x4B53504EUL ) /* "NPSK" */
+#define NCE_PSK_CACHE_VERSION    ( 1U )
+#define NCE_MODEM_CONFIG_MAGIC   ( 0x46434D4EUL ) /* "NMCF" */
+
+/* The modem configuration record sits behind the credentials in the same page. */
+#define NCE_MODEM_CONFIG_OFFSET  ( 0x400U )
+
+/**
+ * @brief Flash record, a multiple of the 8 byte programming unit.
+ */
+typedef struct NcePskCacheRecord
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t length;
+    DtlsKey_t key;
+    uint32_t crc;
+    uint32_t reserved;
+} NcePskCacheRecord_t;
+
+/* Fails to compile if the record can't be programmed in double words. */
+typedef char NcePskCacheRecordSizeCheck_t[ ( ( sizeof( NcePskCacheRecord_t ) % 8U ) == 0U ) ? 1 : -1 ];
+typedef char NcePskCacheRecordFitCheck_t[ ( sizeof( NcePskCacheRecord_t ) <= NCE_MODEM_CONFIG_OFFSET ) ? 1 : -1 ];
+
+/**
+ * @brief Fingerprint of the modem configuration, a single double word.
+ */
+typedef struct NceModemConfigRecord
+{
+    uint32_t magic;
+    uint32_t fingerprint;
+} NceModemConfigRecord_t;
+
+/* Onboarding exchange started by NcePskCache_Prefetch. */
+static NceAuthRequest_t onboardRequest = { 0 };
+
+/*-----------------------------------------------------------*/
+
+static uint32_t prvCrc32( const uint8_t * pData,
+                          size_t length )
+{
+    uint32_t crc = 0xFFFFFFFFUL;
+    size_t i;
+    uint8_t bit;
+
+    for( i = 0; i < length; i++ )
+    {
+        crc ^= pData[ i ];
+
+        for( bit = 0; bit < 8U; bit++ )
+        {
+            crc = ( crc >> 1 ) ^ ( 0xEDB88320UL & ( 0UL - ( crc & 1UL ) ) );
+        }
+    }
+
+    return ~crc;
+}
+
+/*-----------------------------------------------------------*/
+
+static uint32_t prvRecordCrc( const NcePskCacheRecord_t * pRecord )
+{
+    return prvCrc32( ( const uint8_t * ) pRecord, offsetof( NcePskCacheRecord_t, crc ) );
+}
+
+/*-----------------------------------------------------------*/
+
+static bool prvRecordValid( const NcePskCacheRecord_t * pRecord )
+{
+    return ( pRecord->magic == NCE_PSK_CACHE_MAGIC ) &&
+           ( pRecord->version == NCE_PSK_CACHE_VERSION ) &&
+           ( pRecord->length == sizeof( DtlsKey_t ) ) &&
+           ( pRecord->crc == prvRecordCrc( pRecord ) ) &&
+           ( memchr( pRecord->key.Psk, '\0', sizeof( pRecord->key.Psk ) ) != NULL ) &&
+           ( memchr( pRecord->key.PskIdentity, '\0', sizeof( pRecord->key.PskIdentity ) ) != NULL ) &&
+           ( pRecord->key.Psk[ 0 ] != '\0' ) &&
+           ( pRecord->key.PskIdentity[ 0 ] != '\0' );
+}
+
+/*-----------------------------------------------------------*/
+
+static bool prvErasePage( void )
+{
+    FLASH_EraseInitTypeDef erase = { 0 };
+    uint32_t pageError = 0;
+    uint32_t offset = NCE_PSK_CACHE_FLASH_ADDRESS - FLASH_BASE;
+
+    erase.TypeErase = FLASH_TYPEERASE_PAGES;
+    erase.Banks = ( offset < FLASH_BANK_SIZE ) ? FLASH_BANK_1 : FLASH_BANK_2;
+    erase.Page = ( offset % FLASH_BANK_SIZE ) / FLASH_PAGE_SIZE;
+    erase.NbPages = 1;
+
+    return HAL_FLASHEx_Erase( &erase, &pageError ) == HAL_OK;
+}
+
+/*-----------------------------------------------------------*/
+
+static bool prvProgram( uint32_t offset,
+                        const void * pData,
+                        size_t length )
+{
+    uint64_t doubleWord;
+    size_t i;
+    bool status = true;
+
+    for( i = 0; ( status == true ) && ( i < length ); i += sizeof( doubleWord ) )
+    {
+        memcpy( &doubleWord, ( const uint8_t * ) pData + i, sizeof( doubleWord ) );
+        status = HAL_FLASH_Program( FLASH_TYPEPROGRAM_DOUBLEWORD, NCE_PSK_CACHE_FLASH_ADDRESS + offset + i, doubleWord ) == HAL_OK;
+    }
+
+    return status;
+}
+
+/*-----------------------------------------------------------*/
+
+/* Erase the page and program the given records, NULL ones stay erased. Both
+ * must be in RAM, the page content is gone once it is erased. */
+static bool prvWritePage( const NcePskCacheRecord_t * pKeyRecord,
+                          const NceModemConfigRecord_t * pModemRecord )
+{
+    bool status;
+
+    ( void ) HAL_FLASH_Unlock();
+    __HAL_FLASH_CLEAR_FLAG( FLASH_FLAG_ALL_ERRORS );
+
+    status = prvErasePage();
+
+    if( ( status == true ) && ( pKeyRecord != NULL ) )
+    {
+        status = prvProgram( 0, pKeyRecord, sizeof( *pKeyRecord ) );
+    }
+
+    if( ( status == true ) && ( pModemRecord != NULL ) )
+    {
+        status = prvProgram( NCE_MODEM_CONFIG_OFFSET, pModemRecord, sizeof( *pModemRecord ) );
+    }
+
+    ( void ) HAL_FLASH_Lock();
+
+    return status;
+}
+
+/*-----------------------------------------------------------*/
+
+static const NceModemConfigRecord_t * prvModemRecord( void )
+{
+    const NceModemConfigRecord_t * pRecord = ( const NceModemConfigRecord_t * ) ( NCE_PSK_CACHE_FLASH_ADDRESS + NCE_MODEM_CONFIG_OFFSET );
+
+    return ( pRecord->magic == NCE_MODEM_CONFIG_MAGIC ) ? pRecord : NULL;
+}
+
+/*-----------------------------------------------------------*/
+
+bool NcePskCache_Load( DtlsKey_t * pKey )
+{
+    const NcePskCacheRecord_t * pRecord = ( const NcePskCacheRecord_t * ) NCE_PSK_CACHE_FLASH_ADDRESS;
+    bool valid = prvRecordValid( pRecord );
+
+    if( valid == true )
+    {
+        memcpy( pKey, &pRecord->key, sizeof( DtlsKey_t ) );
+        IotLogInfo( "Using cached DTLS credentials.\r\n" );
+    }
+
+    return valid;
+}
+
+/*-----------------------------------------------------------*/
+
+bool NcePskCache_Store( const DtlsKey_t * pKey )
+{
+    const NcePskCacheRecord_t * pStored = ( const NcePskCacheRecord_t * ) NCE_PSK_CACHE_FLASH_ADDRESS;
+    const NceModemConfigRecord_t * pModemStored = prvModemRecord();
+    NceModemConfigRecord_t modemRecord = { 0 };
+    NcePskCacheRecord_t record;
+    bool status = true;
+
+    ( void ) memset( &record, 0, sizeof( record ) );
+    record.magic = NCE_PSK_CACHE_MAGIC;
+    record.version = NCE_PSK_CACHE_VERSION;
+    record.length = sizeof( DtlsKey_t );
+    ( void ) strncpy( record.key.Psk, pKey->Psk, sizeof( record.key.Psk ) - 1U );
+    ( void ) strncpy( record.key.PskIdentity, pKey->PskIdentity, sizeof( record.key.PskIdentity ) - 1U );
+    record.crc = prvRecordCrc( &record );
+
+    /* Spare the flash if the same credentials are already stored. */
+    if( memcmp( pStored, &record, sizeof( record ) ) == 0 )
+    {
+        return true;
+    }
+
+    if( pModemStored != NULL )
+    {
+        modemRecord = *pModemStored;
+    }
+
+    status = prvWritePage( &record, ( pModemStored != NULL ) ? &modemRecord : NULL );
+
+    if( ( status == false ) || ( prvRecordValid( pStored ) == false ) )
+    {
+        IotLogError( "Failed to store DTLS credentials in flash.\r\n" );
+        status = false;
+    }
+
+    return status;
+}
+
+/*-----------------------------------------------------------*/
+
+void NcePskCache_Invalidate( void )
+{
+    const NcePskCacheRecord_t * pStored = ( const NcePskCacheRecord_t * ) NCE_PSK_CACHE_FLASH_ADDRESS;
+    const NceModemConfigRecord_t * pModemStored = prvModemRecord();
+    NceModemConfigRecord_t modemRecord = { 0 };
+
+    if( pStored->magic != 0xFFFFFFFFUL )
+    {
+        if( pModemStored != NULL )
+        {
+            modemRecord = *pModemStored;
+        }
+
+        if( prvWritePage( NULL, ( pModemStored != NULL ) ? &modemRecord : NULL ) == false )
+        {
+            IotLogError( "Failed to erase cached DTLS credentials.\r\n" );
+        }
+
+        IotLogInfo( "Cached DTLS credentials discarded.\r\n" );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+uint32_t NcePskCache_LoadModemConfig( void )
+{
+    const NceModemConfigRecord_t * pStored = prvModemRecord();
+
+    return ( pStored != NULL ) ? pStored->fingerprint : 0U;
+}
+
+/*-----------------------------------------------------------*/
+
+bool NcePskCache_StoreModemConfig( uint32_t fingerprint )
+{
+    const NceModemConfigRecord_t * pStored = ( const NceModemConfigRecord_t * ) ( NCE_PSK_CACHE_FLASH_ADDRESS + NCE_MODEM_CONFIG_OFFSET );
+    const NcePskCacheRecord_t * pKeyStored = ( const NcePskCacheRecord_t * ) NCE_PSK_CACHE_FLASH_ADDRESS;
+    NcePskCacheRecord_t keyRecord;
+    NceModemConfigRecord_t record = { NCE_MODEM_CONFIG_MAGIC, fingerprint };
+    bool status = true;
+
+    if( ( pStored->magic == record.magic ) && ( pStored->fingerprint == record.fingerprint ) )
+    {
+        return true;
+    }
+
+    if( ( pStored->magic == 0xFFFFFFFFUL ) && ( pStored->fingerprint == 0xFFFFFFFFUL ) )
+    {
+        /* Still erased, no need to touch the credentials. */
+        ( void ) HAL_FLASH_Unlock();
+        __HAL_FLASH_CLEAR_FLAG( FLASH_FLAG_ALL_ERRORS );
+        status = prvProgram( NCE_MODEM_CONFIG_OFFSET, &record, sizeof( record ) );
+        ( void ) HAL_FLASH_Lock();
+    }
+    else
+    {
+        memcpy( &keyRecord, pKeyStored, sizeof( keyRecord ) );
+        status = prvWritePage( ( prvRecordValid( &keyRecord ) == true ) ? &keyRecord : NULL, &record );
+    }
+
+    if( ( status == false ) || ( NcePskCache_LoadModemConfig() != fingerprint ) )
+    {
+        IotLogError( "Failed to store the modem configuration in flash.\r\n" );
+        status = false;
+    }
+
+    return status;
+}
+
+/*-----------------------------------------------------------*/
+
+void NcePskCache_Prefetch( void )
+{
+    #if defined( CONFIG_NCE_PSK_CACHE )
+        if( prvRecordValid( ( const NcePskCacheRecord_t * ) NCE_PSK_CACHE_FLASH_ADDRESS ) == true )
+        {
+            return;
+        }
+    #endif
+
+    if( onboardRequest.pending == false )
+    {
+        ( void ) os_auth_start( &osNetwork, &onboardRequest );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+int NcePskCache_GetKey( DtlsKey_t * pKey )
+{
+    int status;
+
+    #if defined( CONFIG_NCE_PSK_CACHE )
+        if( NcePskCache_Load( pKey ) == true )
+        {
+            return NCE_SDK_SUCCESS;
+        }
+    #endif
+
+    if( onboardRequest.pending == true )
+    {
+        status = os_auth_finish( &osNetwork, &onboardRequest, pKey );
+    }
+    else
+    {
+        status = os_auth( &osNetwork, pKey );
+    }
+
+    #if defined( CONFIG_NCE_PSK_CACHE )
+        if( status == NCE_SDK_SUCCESS )
+        {
+            ( void ) NcePskCache_Store( pKey );
+        }
+    #endif
+
+    return status;
+}
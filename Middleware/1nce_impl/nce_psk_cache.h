@@ -0,0 +1,93 @@
+/*
+ * nce_psk_cache.h
+ *
+ *  Flash cache of the DTLS credentials (Middleware/1nce_impl/nce_psk_cache.c).
+ *
+ *  1NCE GmbH
+ */
+
+#ifndef NCE_PSK_CACHE_H
+#define NCE_PSK_CACHE_H
+
+/* Standard includes. */
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "nce_iot_c_sdk.h"
+
+/**
+ * @brief Flash page holding the cached Device Authenticator credentials.
+ *
+ * The last 2 KB page of bank 2 by default. The linker script keeps it out of
+ * the FLASH region. The page also holds the fingerprint of the modem
+ * configuration, see NcePskCache_StoreModemConfig.
+ */
+#ifndef NCE_PSK_CACHE_FLASH_ADDRESS
+    #define NCE_PSK_CACHE_FLASH_ADDRESS    ( 0x080FF800UL )
+#endif
+
+/**
+ * @brief Load the cached DTLS credentials.
+ *
+ * @param[out] pKey: Credentials read from flash.
+ *
+ * @return true if a record with a valid integrity check was found.
+ */
+bool NcePskCache_Load( DtlsKey_t * pKey );
+
+/**
+ * @brief Store DTLS credentials obtained from the Device Authenticator.
+ *
+ * The page is only rewritten if the credentials differ from the stored ones.
+ *
+ * @param[in] pKey: Credentials to store.
+ *
+ * @return true on success.
+ */
+bool NcePskCache_Store( const DtlsKey_t * pKey );
+
+/**
+ * @brief Erase the cached credentials so the next connection onboards again.
+ */
+void NcePskCache_Invalidate( void );
+
+/**
+ * @brief Load the fingerprint of the configuration last verified on the modem.
+ *
+ * @return The stored fingerprint, or 0 if there is none.
+ */
+uint32_t NcePskCache_LoadModemConfig( void );
+
+/**
+ * @brief Store the fingerprint of the configuration verified on the modem.
+ *
+ * The cellular driver skips querying the module settings while it matches, also
+ * after a reset. Storing it keeps the cached credentials and vice versa.
+ *
+ * @param[in] fingerprint: Fingerprint to store.
+ *
+ * @return true on success.
+ */
+bool NcePskCache_StoreModemConfig( uint32_t fingerprint );
+
+/**
+ * @brief Send the onboarding request ahead of time, unless valid credentials are cached.
+ *
+ * The response is collected by NcePskCache_GetKey, so other connection setup
+ * can run while the request is in flight.
+ */
+void NcePskCache_Prefetch( void );
+
+/**
+ * @brief Get the DTLS credentials.
+ *
+ * Returns the cached credentials if valid. Otherwise it completes the exchange
+ * started by NcePskCache_Prefetch, or onboards now, and caches the result.
+ *
+ * @param[out] pKey: DTLS credentials.
+ *
+ * @return NCE_SDK_SUCCESS or the onboarding error.
+ */
+int NcePskCache_GetKey( DtlsKey_t * pKey );
+
+#endif /* ifndef NCE_PSK_CACHE_H */
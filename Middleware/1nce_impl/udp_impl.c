@@ -30,6 +30,9 @@ os_network_ops_t osNetwork =
     .nce_os_udp_disconnect = nce_os_udp_disconnect_impl
 };
 
+/* Receive timeout of the onboarding socket, after which the SDK retransmits the request. */
+#define NCE_ONBOARD_RETRANSMIT_TIMEOUT_MS    ( 10000U )
+
 struct OSNetwork
 {
     Socket_t udpSocket;
@@ -48,7 +51,8 @@ int nce_os_udp_connect_impl( OSNetwork_t osnetwork,
     IotLogInfo( "connect to onboarding hostname\r\n" );
     ServerAddress.usPort = SOCKETS_htons( NceOnboard.port );
     ServerAddress.ulAddress = SOCKETS_GetHostByName( &( NceOnboard.host ) );
-    uint32_t timeout = 30000;
+    /* Also the CoAP retransmission interval of the onboarding request. */
+    uint32_t timeout = NCE_ONBOARD_RETRANSMIT_TIMEOUT_MS;
     osnetwork->udpSocket = SOCKETS_Socket( SOCKETS_AF_INET, SOCKETS_SOCK_DGRAM, SOCKETS_IPPROTO_UDP );
 
     /* Set a time out so a missing reply does not cause the task to block
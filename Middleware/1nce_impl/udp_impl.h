@@ -18,6 +18,9 @@
 #ifndef LIBRARY_LOG_NAME
     #define LIBRARY_LOG_NAME    "SDK_IMPL"
 #endif
+#ifndef LIBRARY_LOG_MODULE
+    #define LIBRARY_LOG_MODULE    IOT_LOG_MODULE_NCE_SDK
+#endif
 
 #ifdef IOT_LOG_LEVEL_NCE_SDK
     #define LIBRARY_LOG_LEVEL        IOT_LOG_LEVEL_NCE_SDK
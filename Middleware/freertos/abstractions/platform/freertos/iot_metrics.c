@@ -228,3 +228,190 @@
     }
 
 #endif /* ifdef AWS_IOT_SECURE_SOCKETS_METRICS_ENABLED */
+
+/*-----------------------------------------------------------*/
+
+#if IOT_METRICS_CELLULAR_ENABLED == 1
+
+/* FreeRTOS includes for the critical sections guarding the counters. */
+    #include "FreeRTOS.h"
+    #include "task.h"
+
+/**
+ * @brief The cellular performance counters.
+ *
+ * Counters are updated from the cellular tasks and the UART receive interrupt,
+ * so every access is done in a critical section.
+ */
+    static IotMetricsCellular_t _cellularMetrics;
+
+/*-----------------------------------------------------------*/
+
+    static uint32_t _latencyBucket( uint32_t latencyMs )
+    {
+        uint32_t bucket = 0U;
+
+        /* Floor of log2, with 0 and 1 ms sharing the first bucket. */
+        while( ( latencyMs > 1U ) && ( bucket < ( IOT_METRICS_CELLULAR_LATENCY_BUCKETS - 1U ) ) )
+        {
+            latencyMs >>= 1;
+            bucket++;
+        }
+
+        return bucket;
+    }
+
+/*-----------------------------------------------------------*/
+
+    void IotMetrics_CellularAtCommand( uint32_t atCmdType,
+                                       uint32_t latencyMs,
+                                       bool timedOut )
+    {
+        IotMetricsCellularAtCommand_t * pCommand = NULL;
+        uint32_t bucket = _latencyBucket( latencyMs );
+
+        if( atCmdType < IOT_METRICS_CELLULAR_AT_TYPES )
+        {
+            pCommand = &( _cellularMetrics.atCommands[ atCmdType ] );
+
+            taskENTER_CRITICAL();
+
+            pCommand->count++;
+            pCommand->totalLatencyMs += latencyMs;
+            pCommand->latencyHistogram[ bucket ]++;
+
+            if( latencyMs > pCommand->maxLatencyMs )
+            {
+                pCommand->maxLatencyMs = latencyMs;
+            }
+
+            if( timedOut == true )
+            {
+                pCommand->timeouts++;
+            }
+
+            taskEXIT_CRITICAL();
+        }
+    }
+
+/*-----------------------------------------------------------*/
+
+    void IotMetrics_CellularUrc( const char * pUrcLine )
+    {
+        char token[ IOT_METRICS_CELLULAR_URC_TOKEN_LENGTH ] = { '\0' };
+        size_t tokenLength = 0U;
+        uint32_t i = 0U;
+
+        if( pUrcLine != NULL )
+        {
+            /* The token is the text between the leading '+' and the ':'. */
+            if( *pUrcLine == '+' )
+            {
+                pUrcLine++;
+            }
+
+            while( ( pUrcLine[ tokenLength ] != '\0' ) && ( pUrcLine[ tokenLength ] != ':' ) &&
+                   ( tokenLength < ( IOT_METRICS_CELLULAR_URC_TOKEN_LENGTH - 1U ) ) )
+            {
+                token[ tokenLength ] = pUrcLine[ tokenLength ];
+                tokenLength++;
+            }
+
+            taskENTER_CRITICAL();
+
+            /* Find the token, or claim the first unused entry for it. */
+            for( i = 0U; i < IOT_METRICS_CELLULAR_URC_TOKENS; i++ )
+            {
+                if( _cellularMetrics.urcs[ i ].token[ 0 ] == '\0' )
+                {
+                    ( void ) memcpy( _cellularMetrics.urcs[ i ].token, token, tokenLength + 1U );
+                    break;
+                }
+
+                if( strcmp( _cellularMetrics.urcs[ i ].token, token ) == 0 )
+                {
+                    break;
+                }
+            }
+
+            if( i < IOT_METRICS_CELLULAR_URC_TOKENS )
+            {
+                _cellularMetrics.urcs[ i ].count++;
+            }
+            else
+            {
+                _cellularMetrics.urcOther++;
+            }
+
+            taskEXIT_CRITICAL();
+        }
+    }
+
+/*-----------------------------------------------------------*/
+
+    void IotMetrics_CellularComm( uint32_t bytesIn,
+                                  uint32_t bytesOut,
+                                  bool timedOut )
+    {
+        taskENTER_CRITICAL();
+
+        _cellularMetrics.commBytesIn += bytesIn;
+        _cellularMetrics.commBytesOut += bytesOut;
+
+        if( timedOut == true )
+        {
+            _cellularMetrics.commTimeouts++;
+        }
+
+        taskEXIT_CRITICAL();
+    }
+
+/*-----------------------------------------------------------*/
+
+    void IotMetrics_CellularSocket( uint32_t bytesIn,
+                                    uint32_t bytesOut )
+    {
+        taskENTER_CRITICAL();
+
+        _cellularMetrics.socketBytesIn += bytesIn;
+        _cellularMetrics.socketBytesOut += bytesOut;
+
+        taskEXIT_CRITICAL();
+    }
+
+/*-----------------------------------------------------------*/
+
+    void IotMetrics_CellularFifoLevel( uint32_t level )
+    {
+        taskENTER_CRITICAL();
+
+        if( level > _cellularMetrics.fifoHighWater )
+        {
+            _cellularMetrics.fifoHighWater = level;
+        }
+
+        taskEXIT_CRITICAL();
+    }
+
+/*-----------------------------------------------------------*/
+
+    void IotMetrics_CellularGet( IotMetricsCellular_t * pMetrics )
+    {
+        if( pMetrics != NULL )
+        {
+            taskENTER_CRITICAL();
+            ( void ) memcpy( pMetrics, &_cellularMetrics, sizeof( IotMetricsCellular_t ) );
+            taskEXIT_CRITICAL();
+        }
+    }
+
+/*-----------------------------------------------------------*/
+
+    void IotMetrics_CellularReset( void )
+    {
+        taskENTER_CRITICAL();
+        ( void ) memset( &_cellularMetrics, 0x00, sizeof( IotMetricsCellular_t ) );
+        taskEXIT_CRITICAL();
+    }
+
+#endif /* if IOT_METRICS_CELLULAR_ENABLED == 1 */
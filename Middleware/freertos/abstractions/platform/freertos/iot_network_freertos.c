@@ -56,7 +56,8 @@
     #endif
 #endif
 
-#define LIBRARY_LOG_NAME    ( "NET" )
+#define LIBRARY_LOG_NAME      ( "NET" )
+#define LIBRARY_LOG_MODULE    IOT_LOG_MODULE_NETWORK
 #include "iot_logging_setup.h"
 
 /* Provide a default value for the number of milliseconds for a socket poll.
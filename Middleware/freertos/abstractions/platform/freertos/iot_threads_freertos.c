@@ -49,7 +49,8 @@
     #endif
 #endif
 
-#define LIBRARY_LOG_NAME    ( "THREAD" )
+#define LIBRARY_LOG_NAME      ( "THREAD" )
+#define LIBRARY_LOG_MODULE    IOT_LOG_MODULE_PLATFORM
 #include "iot_logging_setup.h"
 
 /*
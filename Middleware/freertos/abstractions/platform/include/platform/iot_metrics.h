@@ -39,6 +39,7 @@
 
 /* Standard includes. */
 #include <stdbool.h>
+#include <stdint.h>
 
 /* Linear containers (lists and queues) include. */
 #include "iot_linear_containers.h"
@@ -52,6 +53,10 @@
  * @function_brief{platform_metrics_function_cleanup}
  * - @function_name{platform_metrics_function_gettcpconnections}
  * @function_brief{platform_metrics_function_gettcpconnections}
+ * - @function_name{platform_metrics_function_cellularget}
+ * @function_brief{platform_metrics_function_cellularget}
+ * - @function_name{platform_metrics_function_cellularreset}
+ * @function_brief{platform_metrics_function_cellularreset}
  */
 
 /**
@@ -64,6 +69,12 @@
  * @function_page{IotMetrics_GetTcpConnections,platform_metrics,gettcpconnections}
  * @function_snippet{platform_metrics,gettcpconnections,this}
  * @copydoc IotMetrics_GetTcpConnections
+ * @function_page{IotMetrics_CellularGet,platform_metrics,cellularget}
+ * @function_snippet{platform_metrics,cellularget,this}
+ * @copydoc IotMetrics_CellularGet
+ * @function_page{IotMetrics_CellularReset,platform_metrics,cellularreset}
+ * @function_snippet{platform_metrics,cellularreset,this}
+ * @copydoc IotMetrics_CellularReset
  */
 
 /**
@@ -110,4 +121,142 @@ void IotMetrics_GetTcpConnections( void * pContext,
                                    void ( * metricsCallback )( void *, const IotListDouble_t * ) );
 /* @[declare_platform_metrics_gettcpconnections] */
 
+/**
+ * @brief Set to 1 to collect the cellular performance counters below.
+ */
+#ifndef IOT_METRICS_CELLULAR_ENABLED
+    #define IOT_METRICS_CELLULAR_ENABLED    ( 0 )
+#endif
+
+#if IOT_METRICS_CELLULAR_ENABLED == 1
+
+/**
+ * @brief Number of AT command types tracked, one per `CellularATCommandType_t`
+ * value including `CELLULAR_AT_NO_COMMAND`.
+ */
+    #define IOT_METRICS_CELLULAR_AT_TYPES           ( 9U )
+
+/**
+ * @brief Number of buckets in an AT command latency histogram.
+ *
+ * Bucket 0 counts latencies below 2 ms, bucket `n` counts latencies in
+ * [2^n, 2^(n+1)) ms and the last bucket counts everything above that.
+ */
+    #define IOT_METRICS_CELLULAR_LATENCY_BUCKETS    ( 16U )
+
+/**
+ * @brief Number of distinct URC tokens counted individually.
+ */
+    #ifndef IOT_METRICS_CELLULAR_URC_TOKENS
+        #define IOT_METRICS_CELLULAR_URC_TOKENS     ( 12U )
+    #endif
+
+/**
+ * @brief Longest URC token kept, including the terminating NULL.
+ */
+    #define IOT_METRICS_CELLULAR_URC_TOKEN_LENGTH   ( 12U )
+
+/**
+ * @brief Counters for one AT command type.
+ */
+    typedef struct IotMetricsCellularAtCommand
+    {
+        uint32_t count;                                                    /**< Commands that got a response or timed out. */
+        uint32_t timeouts;                                                 /**< Commands that timed out waiting for a response. */
+        uint32_t totalLatencyMs;                                           /**< Sum of all latencies, for averaging. */
+        uint32_t maxLatencyMs;                                             /**< Slowest command seen. */
+        uint32_t latencyHistogram[ IOT_METRICS_CELLULAR_LATENCY_BUCKETS ]; /**< Log2 latency histogram in ms. */
+    } IotMetricsCellularAtCommand_t;
+
+/**
+ * @brief Occurrences of one URC token, e.g. "QIURC" or "CEREG".
+ */
+    typedef struct IotMetricsCellularUrc
+    {
+        char token[ IOT_METRICS_CELLULAR_URC_TOKEN_LENGTH ]; /**< Token without the leading '+'; empty if unused. */
+        uint32_t count;                                      /**< Number of URCs with this token. */
+    } IotMetricsCellularUrc_t;
+
+/**
+ * @brief Snapshot of all cellular performance counters.
+ */
+    typedef struct IotMetricsCellular
+    {
+        IotMetricsCellularAtCommand_t atCommands[ IOT_METRICS_CELLULAR_AT_TYPES ]; /**< Indexed by `CellularATCommandType_t`. */
+        uint32_t commBytesIn;                                                      /**< Bytes read from the modem UART. */
+        uint32_t commBytesOut;                                                     /**< Bytes written to the modem UART. */
+        uint32_t commTimeouts;                                                     /**< UART reads or writes that timed out. */
+        uint32_t fifoHighWater;                                                    /**< Highest UART RX FIFO fill level in bytes. */
+        uint32_t socketBytesIn;                                                    /**< Payload bytes received on modem sockets. */
+        uint32_t socketBytesOut;                                                   /**< Payload bytes sent on modem sockets. */
+        IotMetricsCellularUrc_t urcs[ IOT_METRICS_CELLULAR_URC_TOKENS ];           /**< URC counts, in order of first appearance. */
+        uint32_t urcOther;                                                         /**< URCs that did not fit in #IotMetricsCellular_t.urcs. */
+    } IotMetricsCellular_t;
+
+/**
+ * @brief Record the outcome of one AT command.
+ *
+ * @param[in] atCmdType The `CellularATCommandType_t` of the command.
+ * @param[in] latencyMs Time from sending the command to its response or timeout.
+ * @param[in] timedOut `true` if no response arrived in time.
+ */
+    void IotMetrics_CellularAtCommand( uint32_t atCmdType,
+                                       uint32_t latencyMs,
+                                       bool timedOut );
+
+/**
+ * @brief Count one URC line.
+ *
+ * @param[in] pUrcLine The URC as received, e.g. "+QIURC: \"recv\",0".
+ */
+    void IotMetrics_CellularUrc( const char * pUrcLine );
+
+/**
+ * @brief Record one transfer on the modem communication interface.
+ *
+ * @param[in] bytesIn Bytes received.
+ * @param[in] bytesOut Bytes sent.
+ * @param[in] timedOut `true` if the transfer ended with a timeout.
+ */
+    void IotMetrics_CellularComm( uint32_t bytesIn,
+                                  uint32_t bytesOut,
+                                  bool timedOut );
+
+/**
+ * @brief Record socket payload sent to or received from the modem.
+ *
+ * @param[in] bytesIn Bytes received.
+ * @param[in] bytesOut Bytes sent.
+ */
+    void IotMetrics_CellularSocket( uint32_t bytesIn,
+                                    uint32_t bytesOut );
+
+/**
+ * @brief Update the UART RX FIFO high-water mark.
+ *
+ * @param[in] level Highest FIFO fill level in bytes seen by the caller since
+ * its last report.
+ *
+ * @note The RX interrupt tracks the level itself, the reader reports it.
+ */
+    void IotMetrics_CellularFifoLevel( uint32_t level );
+
+/**
+ * @brief Copy the current cellular performance counters.
+ *
+ * @param[out] pMetrics Receives a consistent snapshot of the counters.
+ */
+/* @[declare_platform_metrics_cellularget] */
+    void IotMetrics_CellularGet( IotMetricsCellular_t * pMetrics );
+/* @[declare_platform_metrics_cellularget] */
+
+/**
+ * @brief Clear all cellular performance counters.
+ */
+/* @[declare_platform_metrics_cellularreset] */
+    void IotMetrics_CellularReset( void );
+/* @[declare_platform_metrics_cellularreset] */
+
+#endif /* if IOT_METRICS_CELLULAR_ENABLED == 1 */
+
 #endif /* ifndef IOT_METRICS_H_ */
@@ -502,6 +502,59 @@ int32_t SOCKETS_SetSockOpt( Socket_t xSocket,
 uint32_t SOCKETS_GetHostByName( const char * pcHostName );
 /* @[declare_secure_sockets_gethostbyname] */
 
+/**
+ * @anchor SocketsPollEvents
+ * @name SocketsPollEvents
+ *
+ * @brief Events of SOCKETS_Poll().
+ */
+/**@{ */
+#define SOCKETS_POLLIN     ( 0x01U ) /**< Data may be received without blocking. */
+#define SOCKETS_POLLHUP    ( 0x02U ) /**< The socket was closed by the peer or the network. */
+/**@} */
+
+/**
+ * @brief Timeout of SOCKETS_Poll() that never expires.
+ */
+#define SOCKETS_POLL_WAIT_FOREVER    ( 0xFFFFFFFFUL )
+
+/**
+ * @brief A socket watched by SOCKETS_Poll().
+ */
+typedef struct SocketsPollFd
+{
+    Socket_t xSocket;   /**< Socket to watch, skipped if SOCKETS_INVALID_SOCKET. */
+    uint32_t ulEvents;  /**< Events to wait for, @ref SocketsPollEvents. */
+    uint32_t ulREvents; /**< Events that occurred, set by SOCKETS_Poll(). */
+} SocketsPollFd_t;
+
+/**
+ * @brief Wait until one of several sockets can be read.
+ *
+ * Like poll() of the [Berkeley Sockets API]
+ * (https://en.wikipedia.org/wiki/Berkeley_sockets#Socket_API_functions).
+ * The calling task blocks on its task notification, which the sockets signal
+ * when data arrives or they close, so it must not use the notification for
+ * anything else while it polls.
+ *
+ * A readable socket may turn out to have no data, e.g. after another task
+ * received it; receive with a short timeout (@ref SOCKETS_SO_RCVTIMEO). A
+ * closed socket stays closed, so a caller that waits for SOCKETS_POLLHUP has
+ * to stop polling the socket once it was reported.
+ *
+ * @param[in,out] pxFds The sockets to watch and their events.
+ * @param[in] xNumFds Number of entries in pxFds.
+ * @param[in] ulTimeoutMs Milliseconds to wait for, 0 to only check,
+ * @ref SOCKETS_POLL_WAIT_FOREVER to wait without a timeout.
+ *
+ * @return
+ * * The number of entries with events, 0 on timeout.
+ * * If an error occurred, a negative value is returned. @ref SocketsErrors
+ */
+int32_t SOCKETS_Poll( SocketsPollFd_t * pxFds,
+                      size_t xNumFds,
+                      uint32_t ulTimeoutMs );
+
 
 
 /**
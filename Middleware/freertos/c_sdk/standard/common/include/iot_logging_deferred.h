@@ -0,0 +1,53 @@
+/*
+ * FreeRTOS Common V1.1.1
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file iot_logging_deferred.h
+ * @brief Deferred logging task interface.
+ */
+
+#ifndef IOT_LOGGING_DEFERRED_H_
+#define IOT_LOGGING_DEFERRED_H_
+
+#ifndef INC_FREERTOS_H
+    #error "include FreeRTOS.h must appear in source files before include iot_logging_deferred.h"
+#endif
+
+/**
+ * @brief Create the task that formats and prints deferred log records.
+ *
+ * Only available when IOT_LOG_DEFERRED is 1. Records logged before this call
+ * are kept in the ring and printed once the task runs. The task should run
+ * at a low priority; it never delays the tasks that log.
+ */
+BaseType_t xLoggingDeferredInitialize( uint16_t usStackSize,
+                                       UBaseType_t uxPriority );
+
+/**
+ * @brief Number of log records dropped because the ring was full.
+ */
+uint32_t ulLoggingDeferredGetDropCount( void );
+
+#endif /* IOT_LOGGING_DEFERRED_H_ */
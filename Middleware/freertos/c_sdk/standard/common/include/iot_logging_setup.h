@@ -184,29 +184,59 @@
 #elif !defined( LIBRARY_LOG_NAME )
     #error "Please define LIBRARY_LOG_NAME."
 #else
-    /* Define IotLog if the log level is greater than "none". */
+    /* Libraries that don't pick a module share the default runtime filter. */
+    #ifndef LIBRARY_LOG_MODULE
+        #define LIBRARY_LOG_MODULE    IOT_LOG_MODULE_DEFAULT
+    #endif
+
+    /* Define IotLog if the log level is greater than "none". Levels above
+     * LIBRARY_LOG_LEVEL and levels disabled at runtime skip the call before
+     * any argument is evaluated. */
     #if LIBRARY_LOG_LEVEL > IOT_LOG_NONE
-        #define IotLog( messageLevel, pLogConfig, ... ) \
-    IotLog_Generic( LIBRARY_LOG_LEVEL,                  \
-                    LIBRARY_LOG_NAME,                   \
-                    messageLevel,                       \
-                    pLogConfig,                         \
-                    __VA_ARGS__ )
-
-/* Define the abbreviated logging macros. */
+        #define IotLog( messageLevel, pLogConfig, ... )                    \
+    do {                                                                   \
+        if( ( ( messageLevel ) <= LIBRARY_LOG_LEVEL ) &&                   \
+            IotLog_IsEnabled( LIBRARY_LOG_MODULE, messageLevel ) )         \
+        {                                                                  \
+            IotLog_Generic( LIBRARY_LOG_LEVEL,                             \
+                            LIBRARY_LOG_NAME,                              \
+                            messageLevel,                                  \
+                            pLogConfig,                                    \
+                            __VA_ARGS__ );                                 \
+        }                                                                  \
+    } while( 0 )
+
+/* Define the abbreviated logging macros. Levels above LIBRARY_LOG_LEVEL
+ * compile to nothing. */
         #define IotLogError( ... )    IotLog( IOT_LOG_ERROR, NULL, __VA_ARGS__ )
-        #define IotLogWarn( ... )     IotLog( IOT_LOG_WARN, NULL, __VA_ARGS__ )
-        #define IotLogInfo( ... )     IotLog( IOT_LOG_INFO, NULL, __VA_ARGS__ )
-        #define IotLogDebug( ... )    IotLog( IOT_LOG_DEBUG, NULL, __VA_ARGS__ )
+
+        #if LIBRARY_LOG_LEVEL >= IOT_LOG_WARN
+            #define IotLogWarn( ... )    IotLog( IOT_LOG_WARN, NULL, __VA_ARGS__ )
+        #else
+            #define IotLogWarn( ... )
+        #endif
+
+        #if LIBRARY_LOG_LEVEL >= IOT_LOG_INFO
+            #define IotLogInfo( ... )    IotLog( IOT_LOG_INFO, NULL, __VA_ARGS__ )
+        #else
+            #define IotLogInfo( ... )
+        #endif
 
 /* If log level is DEBUG, enable the function to print buffers. */
         #if LIBRARY_LOG_LEVEL >= IOT_LOG_DEBUG
-            #define IotLog_PrintBuffer( pHeader, pBuffer, bufferSize ) \
-    IotLog_GenericPrintBuffer( LIBRARY_LOG_NAME,                       \
-                               pHeader,                                \
-                               pBuffer,                                \
-                               bufferSize )
+            #define IotLogDebug( ... )    IotLog( IOT_LOG_DEBUG, NULL, __VA_ARGS__ )
+            #define IotLog_PrintBuffer( pHeader, pBuffer, bufferSize )  \
+    do {                                                                \
+        if( IotLog_IsEnabled( LIBRARY_LOG_MODULE, IOT_LOG_DEBUG ) )     \
+        {                                                               \
+            IotLog_GenericPrintBuffer( LIBRARY_LOG_NAME,                \
+                                       pHeader,                         \
+                                       pBuffer,                         \
+                                       bufferSize );                    \
+        }                                                               \
+    } while( 0 )
         #else
+            #define IotLogDebug( ... )
             #define IotLog_PrintBuffer( pHeader, pBuffer, bufferSize )
         #endif
         /* Remove references to IotLog from the source code if logging is disabled. */
@@ -39,7 +39,8 @@
  * @brief Initialization function for logging task.
  *
  * Called once to create the logging task and queue.  Must be called before any
- * calls to vLoggingPrintf().
+ * calls to vLoggingPrintf().  Messages are formatted into uxQueueLength
+ * static slots, capped to configLOGGING_MAX_QUEUE_LENGTH.
  */
 BaseType_t xLoggingTaskInitialize( uint16_t usStackSize,
                                    UBaseType_t uxPriority,
@@ -57,4 +58,38 @@ BaseType_t xLoggingTaskInitialize( uint16_t usStackSize,
 void vLoggingPrintf( const char * pcFormat,
                      ... );
 
+/**
+ * @brief Non-format version of vLoggingPrintf().
+ *
+ * The message is copied as is, without the message number, time and task
+ * name, and truncated to configLOGGING_MAX_MESSAGE_LENGTH.
+ */
+void vLoggingPrint( const char * pcMessage );
+
+/**
+ * @brief Take a message slot to format a log line into.
+ *
+ * The slot already holds the message number, time and task name when enabled.
+ * Every slot taken must be handed over with vLoggingSendMessage().  The call
+ * never blocks; when all slots are in use the message is counted as dropped.
+ *
+ * @param[out] pxLength Length of the text already in the slot.
+ * @param[out] pxSize Size of the slot, terminating NULL included.
+ *
+ * @return The slot, or NULL if every slot is in use.
+ */
+char * pcLoggingReserveMessage( size_t * pxLength,
+                                size_t * pxSize );
+
+/**
+ * @brief Pass a NULL terminated slot from pcLoggingReserveMessage() to the
+ * logging task for output.
+ */
+void vLoggingSendMessage( char * pcMessage );
+
+/**
+ * @brief Number of log messages dropped because every slot was in use.
+ */
+uint32_t ulLoggingGetDropCount( void );
+
 #endif /* AWS_LOGGING_TASK_H */
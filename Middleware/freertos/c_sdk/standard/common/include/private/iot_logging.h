@@ -41,10 +41,22 @@
 #include "iot_config.h"
 
 /* Standard includes. */
+#include <stdarg.h>
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
+/**
+ * @brief Set to 1 to defer formatting of log messages to a logging task.
+ *
+ * In deferred mode, @ref logging_function_generic only copies the format
+ * pointer and its arguments into a ring; see iot_logging_deferred.c. Format
+ * strings and library names must therefore be string literals.
+ */
+#ifndef IOT_LOG_DEFERRED
+    #define IOT_LOG_DEFERRED    ( 0 )
+#endif
+
 /**
  * @constants_page{logging}
  * @constants_brief{logging library}
@@ -112,6 +124,89 @@
  */
 #define IOT_LOG_DEBUG    4
 
+/**
+ * @section logging_constants_modules Log modules
+ * @brief Identifiers for the runtime log filter.
+ *
+ * Each library may set @ref LIBRARY_LOG_MODULE to one of these values. Libraries
+ * that do not set it share #IOT_LOG_MODULE_DEFAULT. See @ref IotLog_SetModuleLevel.
+ */
+#define IOT_LOG_MODULE_DEFAULT         0
+#define IOT_LOG_MODULE_MAIN            1
+#define IOT_LOG_MODULE_DEMO            2
+#define IOT_LOG_MODULE_PLATFORM        3
+#define IOT_LOG_MODULE_NETWORK         4
+#define IOT_LOG_MODULE_CELLULAR_LIB    5
+#define IOT_LOG_MODULE_PKTIO           6
+#define IOT_LOG_MODULE_NCE_SDK         7
+#define IOT_LOG_MODULE_COAP            8
+#define IOT_LOG_MODULE_LwM2M           9
+#define IOT_LOG_MODULE_TASKPOOL        10
+#define IOT_LOG_MODULE_COUNT           11 /**< @brief Number of modules. */
+
+/**
+ * @brief Set to 0 to remove the runtime per-module filter.
+ *
+ * When 1, every enabled log call first compares the module's entry of
+ * #IotLog_ModuleLevels inline, before any argument is evaluated. The
+ * compile-time level @ref LIBRARY_LOG_LEVEL is always the upper bound.
+ */
+#ifndef IOT_LOG_RUNTIME_FILTER
+    #define IOT_LOG_RUNTIME_FILTER    ( 1 )
+#endif
+
+/**
+ * @brief Runtime level of every module at boot.
+ *
+ * The default lets everything that was compiled in through. Set it lower and
+ * the compile-time levels higher to keep debug logs available on demand.
+ */
+#ifndef IOT_LOG_RUNTIME_LEVEL_DEFAULT
+    #define IOT_LOG_RUNTIME_LEVEL_DEFAULT    IOT_LOG_DEBUG
+#endif
+
+#if ( IOT_LOG_RUNTIME_FILTER == 1 )
+
+/**
+ * @brief Runtime level of each module.
+ *
+ * One byte per module, so changing the level of one module is a single store
+ * that can't race with changes to another. Do not write directly; use
+ * @ref IotLog_SetModuleLevel.
+ */
+    extern volatile uint8_t IotLog_ModuleLevels[ IOT_LOG_MODULE_COUNT ];
+
+/**
+ * @brief Check the runtime filter for a module and a constant level.
+ */
+    #define IotLog_IsEnabled( module, messageLevel ) \
+    ( IotLog_ModuleLevels[ ( module ) ] >= ( uint8_t ) ( messageLevel ) )
+#else
+    #define IotLog_IsEnabled( module, messageLevel )    ( true )
+#endif
+
+/**
+ * @brief Change the runtime log level of a module.
+ *
+ * Messages above `level` from `module` are discarded at the call site. Levels
+ * above the module's compile-time @ref LIBRARY_LOG_LEVEL have no effect, since
+ * those calls were not compiled in.
+ *
+ * @param[in] module One of the @ref logging_constants_modules.
+ * @param[in] level One of the @ref logging_constants_levels.
+ */
+void IotLog_SetModuleLevel( uint32_t module,
+                            int level );
+
+/**
+ * @brief Get the runtime log level of a module.
+ *
+ * @param[in] module One of the @ref logging_constants_modules.
+ *
+ * @return One of the @ref logging_constants_levels.
+ */
+int IotLog_GetModuleLevel( uint32_t module );
+
 /**
  * @paramstructs_group{logging}
  * @paramstructs_brief{logging,logging}
@@ -226,9 +321,9 @@ void IotLog_Generic( int libraryLogSetting,
  *
  * @return No return value. On errors, it prints nothing.
  *
- * @note To conserve memory, this function only allocates enough memory for a
- * single line of output. Therefore, in multithreaded systems, its output may
- * appear "fragmented" if other threads are logging simultaneously.
+ * @note Each line of output is formatted on the stack and printed with a single
+ * call, so no memory is allocated per byte. In multithreaded systems, lines of
+ * other threads may still appear between the lines of one buffer.
  */
 /* @[declare_logging_genericprintbuffer] */
 void IotLog_GenericPrintBuffer( const char * const pLibraryName,
@@ -237,4 +332,26 @@ void IotLog_GenericPrintBuffer( const char * const pLibraryName,
                                 size_t bufferSize );
 /* @[declare_logging_genericprintbuffer] */
 
+#if ( IOT_LOG_DEFERRED == 1 )
+
+/**
+ * @brief Queue a log message for the deferred logging task.
+ *
+ * Called by @ref logging_function_generic after the level check. It never
+ * blocks and never allocates memory; when the ring is full the message is
+ * dropped and counted.
+ *
+ * @param[in] pLibraryName The library name to print.
+ * @param[in] messageLevel The log level of the this message.
+ * @param[in] pLogConfig Pointer to a #IotLogConfig_t. Optional; pass `NULL` to ignore.
+ * @param[in] pFormat Format string for the log message.
+ * @param[in] args Arguments for format specification.
+ */
+    void IotLog_DeferredPush( const char * const pLibraryName,
+                              int messageLevel,
+                              const IotLogConfig_t * const pLogConfig,
+                              const char * const pFormat,
+                              va_list args );
+#endif
+
 #endif /* ifndef IOT_LOGGING_H_ */
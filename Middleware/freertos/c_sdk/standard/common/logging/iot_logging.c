@@ -74,6 +74,20 @@
     #define IotLogging_Puts    puts
 #endif
 
+/**
+ * @def IotLogging_ReserveLine( pLength, pSize )
+ * @brief Optional function that hands out a preallocated line buffer.
+ *
+ * When set together with @ref IotLogging_SendLine, log messages are formatted
+ * once, straight into the returned buffer, instead of into a buffer from
+ * @ref IotLogging_Malloc that is then passed to @ref IotLogging_Puts. The
+ * function returns NULL if no buffer is free, and otherwise sets `*pLength`
+ * to the length of the text already in the buffer and `*pSize` to its size.
+ *
+ * @def IotLogging_SendLine( pLine )
+ * @brief Print and release a buffer from @ref IotLogging_ReserveLine.
+ */
+
 /*
  * Provide default values for undefined memory allocation functions based on
  * the usage of dynamic memory allocation.
@@ -141,6 +155,12 @@
  */
 #define BYTES_PER_LINE           ( 16 )
 
+/**
+ * @brief Room kept at the end of a reserved line for "\r\n" and a
+ * null-terminator.
+ */
+#define LINE_END_LENGTH          ( 3 )
+
 /*-----------------------------------------------------------*/
 
 /**
@@ -148,18 +168,48 @@
  *
  * Converts one of the @ref logging_constants_levels to a string.
  */
-static const char * const _pLogLevelStrings[ 5 ] =
-{
-    "",      /* IOT_LOG_NONE */
-    "ERROR", /* IOT_LOG_ERROR */
-    "WARN ", /* IOT_LOG_WARN */
-    "INFO ", /* IOT_LOG_INFO */
-    "DEBUG"  /* IOT_LOG_DEBUG */
-};
+#if IOT_LOG_DEFERRED != 1
+    static const char * const _pLogLevelStrings[ 5 ] =
+    {
+        "",      /* IOT_LOG_NONE */
+        "ERROR", /* IOT_LOG_ERROR */
+        "WARN ", /* IOT_LOG_WARN */
+        "INFO ", /* IOT_LOG_INFO */
+        "DEBUG"  /* IOT_LOG_DEBUG */
+    };
+#endif
+
+/**
+ * @brief Runtime level of a module at boot.
+ */
+#define INITIAL_MODULE_LEVEL    ( ( uint8_t ) IOT_LOG_RUNTIME_LEVEL_DEFAULT )
+
+/*-----------------------------------------------------------*/
+
+#if ( IOT_LOG_RUNTIME_FILTER == 1 )
+    volatile uint8_t IotLog_ModuleLevels[] =
+    {
+        INITIAL_MODULE_LEVEL, /* IOT_LOG_MODULE_DEFAULT */
+        INITIAL_MODULE_LEVEL, /* IOT_LOG_MODULE_MAIN */
+        INITIAL_MODULE_LEVEL, /* IOT_LOG_MODULE_DEMO */
+        INITIAL_MODULE_LEVEL, /* IOT_LOG_MODULE_PLATFORM */
+        INITIAL_MODULE_LEVEL, /* IOT_LOG_MODULE_NETWORK */
+        INITIAL_MODULE_LEVEL, /* IOT_LOG_MODULE_CELLULAR_LIB */
+        INITIAL_MODULE_LEVEL, /* IOT_LOG_MODULE_PKTIO */
+        INITIAL_MODULE_LEVEL, /* IOT_LOG_MODULE_NCE_SDK */
+        INITIAL_MODULE_LEVEL, /* IOT_LOG_MODULE_COAP */
+        INITIAL_MODULE_LEVEL, /* IOT_LOG_MODULE_LwM2M */
+        INITIAL_MODULE_LEVEL  /* IOT_LOG_MODULE_TASKPOOL */
+    };
+
+/* Fails to compile if a module was added without an initial level. */
+    typedef char IotLogModuleLevelsCheck_t[ ( sizeof( IotLog_ModuleLevels ) == IOT_LOG_MODULE_COUNT ) ? 1 : -1 ];
+#endif
 
 /*-----------------------------------------------------------*/
 
-#if !defined( IOT_STATIC_MEMORY_ONLY ) || ( IOT_STATIC_MEMORY_ONLY == 0 )
+#if ( IOT_LOG_DEFERRED != 1 ) && !defined( IotLogging_ReserveLine ) && \
+    ( !defined( IOT_STATIC_MEMORY_ONLY ) || ( IOT_STATIC_MEMORY_ONLY == 0 ) )
     static bool _reallocLoggingBuffer( void ** pOldBuffer,
                                        size_t newSize,
                                        size_t oldSize )
@@ -184,7 +234,80 @@ static const char * const _pLogLevelStrings[ 5 ] =
 
         return status;
     }
-#endif /* if !defined( IOT_STATIC_MEMORY_ONLY ) || ( IOT_STATIC_MEMORY_ONLY == 0 ) */
+#endif /* if ( IOT_LOG_DEFERRED != 1 ) && !defined( IotLogging_ReserveLine ) && ... */
+
+/*-----------------------------------------------------------*/
+
+#if defined( IotLogging_ReserveLine ) && ( IOT_LOG_DEFERRED != 1 )
+
+/**
+ * @brief Format a log message into a line buffer from
+ * @ref IotLogging_ReserveLine and print it.
+ *
+ * Messages that do not fit are truncated; the line always ends in "\r\n".
+ */
+    static void _printLine( const char * const pLibraryName,
+                            int messageLevel,
+                            const IotLogConfig_t * const pLogConfig,
+                            const char * const pFormat,
+                            va_list args )
+    {
+        char * pLine = NULL;
+        size_t position = 0, lineSize = 0, limit = 0, headerStart = 0;
+        int written = 0;
+
+        pLine = IotLogging_ReserveLine( &position, &lineSize );
+
+        if( pLine == NULL )
+        {
+            return;
+        }
+
+        /* The reserved buffer is expected to hold far more than its prefix. */
+        limit = lineSize - LINE_END_LENGTH;
+
+        if( position > limit )
+        {
+            position = limit;
+        }
+
+        headerStart = position;
+
+        if( ( ( pLogConfig == NULL ) || ( pLogConfig->hideLogLevel == false ) ) &&
+            ( messageLevel >= IOT_LOG_NONE ) && ( messageLevel <= IOT_LOG_DEBUG ) )
+        {
+            written = snprintf( &pLine[ position ], limit - position, "[%s]",
+                                _pLogLevelStrings[ messageLevel ] );
+            position = ( written > 0 ) ? position + ( size_t ) written : position;
+            position = ( position > limit ) ? limit : position;
+        }
+
+        if( ( pLogConfig == NULL ) || ( pLogConfig->hideLibraryName == false ) )
+        {
+            written = snprintf( &pLine[ position ], limit - position, "[%s]", pLibraryName );
+            position = ( written > 0 ) ? position + ( size_t ) written : position;
+            position = ( position > limit ) ? limit : position;
+        }
+
+        /* Add a padding space between the last closing ']' and the message,
+         * unless no header was added. */
+        if( ( position > headerStart ) && ( position < limit ) )
+        {
+            pLine[ position ] = ' ';
+            position++;
+        }
+
+        written = vsnprintf( &pLine[ position ], limit - position + 1U, pFormat, args );
+        position = ( written > 0 ) ? position + ( size_t ) written : position;
+        position = ( position > limit ) ? limit : position;
+
+        pLine[ position ] = '\r';
+        pLine[ position + 1U ] = '\n';
+        pLine[ position + 2U ] = '\0';
+
+        IotLogging_SendLine( pLine );
+    }
+#endif /* if defined( IotLogging_ReserveLine ) && ( IOT_LOG_DEFERRED != 1 ) */
 
 /*-----------------------------------------------------------*/
 
@@ -195,12 +318,14 @@ void IotLog_Generic( int libraryLogSetting,
                      const char * const pFormat,
                      ... )
 {
-    int requiredMessageSize = 0;
-    size_t bufferSize = 0,
-    bufferPosition = 0, timestringLength = 0;
-    char * pLoggingBuffer = NULL;
     va_list args;
 
+    #if ( IOT_LOG_DEFERRED != 1 ) && !defined( IotLogging_ReserveLine )
+        int requiredMessageSize = 0;
+        size_t bufferSize = 0, bufferPosition = 0;
+        char * pLoggingBuffer = NULL;
+    #endif
+
     /* If the library's log level setting is lower than the message level,
      * return without doing anything. */
     if( ( messageLevel == 0 ) || ( messageLevel > libraryLogSetting ) )
@@ -208,61 +333,95 @@ void IotLog_Generic( int libraryLogSetting,
         return;
     }
 
-    if( ( pLogConfig == NULL ) || ( pLogConfig->hideLogLevel == false ) )
-    {
-        /* Add length of log level if requested. */
-        bufferSize += MAX_LOG_LEVEL_LENGTH;
-    }
+    #if IOT_LOG_DEFERRED == 1
+        /* Hand the raw arguments to the logging task; it does the formatting. */
+        va_start( args, pFormat );
+        IotLog_DeferredPush( pLibraryName, messageLevel, pLogConfig, pFormat, args );
+        va_end( args );
+    #elif defined( IotLogging_ReserveLine )
+        /* Format once, straight into the logging task's line buffer. */
+        va_start( args, pFormat );
+        _printLine( pLibraryName, messageLevel, pLogConfig, pFormat, args );
+        va_end( args );
+    #else
+
+        if( ( pLogConfig == NULL ) || ( pLogConfig->hideLogLevel == false ) )
+        {
+            /* Add length of log level if requested. */
+            bufferSize += MAX_LOG_LEVEL_LENGTH;
+        }
 
-    /* Estimate the amount of buffer needed for this log message. */
-    if( ( pLogConfig == NULL ) || ( pLogConfig->hideLibraryName == false ) )
-    {
-        /* Add size of library name if requested. Add 2 to accommodate "[]". */
-        bufferSize += strlen( pLibraryName ) + 2;
-    }
+        /* Estimate the amount of buffer needed for this log message. */
+        if( ( pLogConfig == NULL ) || ( pLogConfig->hideLibraryName == false ) )
+        {
+            /* Add size of library name if requested. Add 2 to accommodate "[]". */
+            bufferSize += strlen( pLibraryName ) + 2;
+        }
 
-    if( ( pLogConfig == NULL ) || ( pLogConfig->hideTimestring == false ) )
-    {
-        /* Add length of timestring if requested. */
-        bufferSize += MAX_TIMESTRING_LENGTH;
-    }
+        if( ( pLogConfig == NULL ) || ( pLogConfig->hideTimestring == false ) )
+        {
+            /* Add length of timestring if requested. */
+            bufferSize += MAX_TIMESTRING_LENGTH;
+        }
 
-    /* Add 64 as an initial (arbitrary) guess for the length of the message. */
-    bufferSize += 64;
+        /* Add 64 as an initial (arbitrary) guess for the length of the message. */
+        bufferSize += 64;
 
-    /* In static memory mode, check that the log message will fit in the a
-     * static buffer. */
-    #if IOT_STATIC_MEMORY_ONLY == 1
-        if( bufferSize >= IotLogging_StaticBufferSize() )
+        /* In static memory mode, check that the log message will fit in the a
+         * static buffer. */
+        #if IOT_STATIC_MEMORY_ONLY == 1
+            if( bufferSize >= IotLogging_StaticBufferSize() )
+            {
+                /* If the static buffers are likely too small to fit the log message,
+                 * return. */
+                return;
+            }
+
+            /* Otherwise, update the buffer size to the size of a static buffer. */
+            bufferSize = IotLogging_StaticBufferSize();
+        #endif
+
+        /* Allocate memory for the logging buffer. */
+        pLoggingBuffer = ( char * ) IotLogging_Malloc( bufferSize );
+
+        if( pLoggingBuffer == NULL )
         {
-            /* If the static buffers are likely too small to fit the log message,
-             * return. */
             return;
         }
 
-        /* Otherwise, update the buffer size to the size of a static buffer. */
-        bufferSize = IotLogging_StaticBufferSize();
-    #endif
-
-    /* Allocate memory for the logging buffer. */
-    pLoggingBuffer = ( char * ) IotLogging_Malloc( bufferSize );
-
-    if( pLoggingBuffer == NULL )
-    {
-        return;
-    }
+        /* Print the message log level if requested. */
+        if( ( pLogConfig == NULL ) || ( pLogConfig->hideLogLevel == false ) )
+        {
+            /* Ensure that message level is valid. */
+            if( ( messageLevel >= IOT_LOG_NONE ) && ( messageLevel <= IOT_LOG_DEBUG ) )
+            {
+                /* Add the log level string to the logging buffer. */
+                requiredMessageSize = snprintf( pLoggingBuffer + bufferPosition,
+                                                bufferSize - bufferPosition,
+                                                "[%s]",
+                                                _pLogLevelStrings[ messageLevel ] );
+
+                /* Check for encoding errors. */
+                if( requiredMessageSize <= 0 )
+                {
+                    IotLogging_Free( pLoggingBuffer );
+
+                    return;
+                }
+
+                /* Update the buffer position. */
+                bufferPosition += ( size_t ) requiredMessageSize;
+            }
+        }
 
-    /* Print the message log level if requested. */
-    if( ( pLogConfig == NULL ) || ( pLogConfig->hideLogLevel == false ) )
-    {
-        /* Ensure that message level is valid. */
-        if( ( messageLevel >= IOT_LOG_NONE ) && ( messageLevel <= IOT_LOG_DEBUG ) )
+        /* Print the library name if requested. */
+        if( ( pLogConfig == NULL ) || ( pLogConfig->hideLibraryName == false ) )
         {
-            /* Add the log level string to the logging buffer. */
+            /* Add the library name to the logging buffer. */
             requiredMessageSize = snprintf( pLoggingBuffer + bufferPosition,
                                             bufferSize - bufferPosition,
                                             "[%s]",
-                                            _pLogLevelStrings[ messageLevel ] );
+                                            pLibraryName );
 
             /* Check for encoding errors. */
             if( requiredMessageSize <= 0 )
@@ -275,96 +434,75 @@ void IotLog_Generic( int libraryLogSetting,
             /* Update the buffer position. */
             bufferPosition += ( size_t ) requiredMessageSize;
         }
-    }
 
-    /* Print the library name if requested. */
-    if( ( pLogConfig == NULL ) || ( pLogConfig->hideLibraryName == false ) )
-    {
-        /* Add the library name to the logging buffer. */
-        requiredMessageSize = snprintf( pLoggingBuffer + bufferPosition,
-                                        bufferSize - bufferPosition,
-                                        "[%s]",
-                                        pLibraryName );
-
-        /* Check for encoding errors. */
-        if( requiredMessageSize <= 0 )
+        /* Add a padding space between the last closing ']' and the message, unless
+         * the logging buffer is empty. */
+        if( bufferPosition > 0 )
         {
-            IotLogging_Free( pLoggingBuffer );
-
-            return;
+            pLoggingBuffer[ bufferPosition ] = ' ';
+            bufferPosition++;
         }
 
-        /* Update the buffer position. */
-        bufferPosition += ( size_t ) requiredMessageSize;
-    }
+        va_start( args, pFormat );
 
-    /* Add a padding space between the last closing ']' and the message, unless
-     * the logging buffer is empty. */
-    if( bufferPosition > 0 )
-    {
-        pLoggingBuffer[ bufferPosition ] = ' ';
-        bufferPosition++;
-    }
+        /* Add the log message to the logging buffer. */
+        requiredMessageSize = vsnprintf( pLoggingBuffer + bufferPosition,
+                                         bufferSize - bufferPosition,
+                                         pFormat,
+                                         args );
 
-    va_start( args, pFormat );
+        va_end( args );
 
-    /* Add the log message to the logging buffer. */
-    requiredMessageSize = vsnprintf( pLoggingBuffer + bufferPosition,
-                                     bufferSize - bufferPosition,
-                                     pFormat,
-                                     args );
+        /* If the logging buffer was too small to fit the log message, reallocate
+         * a larger logging buffer. */
+        if( ( size_t ) requiredMessageSize >= bufferSize - bufferPosition )
+        {
+            #if IOT_STATIC_MEMORY_ONLY == 1
 
-    va_end( args );
+                /* There's no point trying to allocate a larger static buffer. Return
+                 * immediately. */
+                IotLogging_Free( pLoggingBuffer );
 
-    /* If the logging buffer was too small to fit the log message, reallocate
-     * a larger logging buffer. */
-    if( ( size_t ) requiredMessageSize >= bufferSize - bufferPosition )
-    {
-        #if IOT_STATIC_MEMORY_ONLY == 1
+                return;
+            #else
+                if( _reallocLoggingBuffer( ( void ** ) &pLoggingBuffer,
+                                           ( size_t ) requiredMessageSize + bufferPosition + 1,
+                                           bufferSize ) == false )
+                {
+                    /* If buffer reallocation failed, return. */
+                    IotLogging_Free( pLoggingBuffer );
+
+                    return;
+                }
+
+                /* Reallocation successful, update buffer size. */
+                bufferSize = ( size_t ) requiredMessageSize + bufferPosition + 1;
+
+                /* Add the log message to the buffer. Now that the buffer has been
+                 * reallocated, this should succeed. */
+                va_start( args, pFormat );
+                requiredMessageSize = vsnprintf( pLoggingBuffer + bufferPosition,
+                                                 bufferSize - bufferPosition,
+                                                 pFormat,
+                                                 args );
+                va_end( args );
+            #endif /* if IOT_STATIC_MEMORY_ONLY == 1 */
+        }
 
-            /* There's no point trying to allocate a larger static buffer. Return
-             * immediately. */
+        /* Check for encoding errors. */
+        if( requiredMessageSize <= 0 )
+        {
             IotLogging_Free( pLoggingBuffer );
 
             return;
-        #else
-            if( _reallocLoggingBuffer( ( void ** ) &pLoggingBuffer,
-                                       ( size_t ) requiredMessageSize + bufferPosition + 1,
-                                       bufferSize ) == false )
-            {
-                /* If buffer reallocation failed, return. */
-                IotLogging_Free( pLoggingBuffer );
-
-                return;
-            }
+        }
 
-            /* Reallocation successful, update buffer size. */
-            bufferSize = ( size_t ) requiredMessageSize + bufferPosition + 1;
-
-            /* Add the log message to the buffer. Now that the buffer has been
-             * reallocated, this should succeed. */
-            va_start( args, pFormat );
-            requiredMessageSize = vsnprintf( pLoggingBuffer + bufferPosition,
-                                             bufferSize - bufferPosition,
-                                             pFormat,
-                                             args );
-            va_end( args );
-        #endif /* if IOT_STATIC_MEMORY_ONLY == 1 */
-    }
+        /* Print the logging buffer to stdout. */
+        IotLogging_Puts( pLoggingBuffer );
 
-    /* Check for encoding errors. */
-    if( requiredMessageSize <= 0 )
-    {
+        /* Free the logging buffer. */
         IotLogging_Free( pLoggingBuffer );
-
-        return;
-    }
-
-    /* Print the logging buffer to stdout. */
-    IotLogging_Puts( pLoggingBuffer );
-
-    /* Free the logging buffer. */
-    IotLogging_Free( pLoggingBuffer );
+    #endif /* if IOT_LOG_DEFERRED == 1 */
 }
 
 /*-----------------------------------------------------------*/
@@ -374,19 +512,13 @@ void IotLog_GenericPrintBuffer( const char * const pLibraryName,
                                 const uint8_t * const pBuffer,
                                 size_t bufferSize )
 {
+    /* Each byte is printed as 2 digits and a space; the line is formatted on
+     * the stack and handed over in one piece. */
+    static const char hexDigits[] = "0123456789abcdef";
+    static const IotLogConfig_t lineConfig = { .hideLogLevel = true, .hideLibraryName = true, .hideTimestring = true };
+    char lineBuffer[ ( 3 * BYTES_PER_LINE ) + 1 ];
     size_t i = 0, offset = 0;
 
-    /* Allocate memory to hold each line of the log message. Since each byte
-     * of pBuffer is printed in 4 characters (2 digits, a space, and a null-
-     * terminator), the size of each line is 4 * BYTES_PER_LINE. */
-    char * pMessageBuffer = IotLogging_Malloc( 4 * BYTES_PER_LINE );
-
-    /* Exit if no memory is available. */
-    if( pMessageBuffer == NULL )
-    {
-        return;
-    }
-
     /* Print pHeader before printing pBuffer. */
     if( pHeader != NULL )
     {
@@ -397,31 +529,80 @@ void IotLog_GenericPrintBuffer( const char * const pLibraryName,
                         pHeader );
     }
 
-    /* Print each byte in pBuffer. */
     for( i = 0; i < bufferSize; i++ )
     {
-        /* Print a line if BYTES_PER_LINE is reached. But don't print a line
-         * at the beginning (when i=0). */
-        if( ( i % BYTES_PER_LINE == 0 ) && ( i != 0 ) )
-        {
-            IotLogging_Puts( pMessageBuffer );
+        lineBuffer[ offset ] = hexDigits[ pBuffer[ i ] >> 4 ];
+        lineBuffer[ offset + 1 ] = hexDigits[ pBuffer[ i ] & 0x0fU ];
+        lineBuffer[ offset + 2 ] = ' ';
+        offset += 3;
 
-            /* Reset offset so that pMessageBuffer is filled from the beginning. */
+        /* Print a line once BYTES_PER_LINE is reached or the buffer ends. */
+        if( ( ( i + 1 ) % BYTES_PER_LINE == 0 ) || ( ( i + 1 ) == bufferSize ) )
+        {
+            lineBuffer[ offset ] = '\0';
+
+            #if ( IOT_LOG_DEFERRED == 1 ) || defined( IotLogging_ReserveLine )
+                IotLog_Generic( IOT_LOG_DEBUG,
+                                pLibraryName,
+                                IOT_LOG_DEBUG,
+                                &lineConfig,
+                                "%s",
+                                lineBuffer );
+            #else
+                ( void ) lineConfig;
+                IotLogging_Puts( lineBuffer );
+            #endif
+
+            /* Reset offset so that lineBuffer is filled from the beginning. */
             offset = 0;
         }
+    }
+}
 
-        /* Print a single byte into pMessageBuffer. */
-        ( void ) snprintf( pMessageBuffer + offset, 4, "%02x ", pBuffer[ i ] );
+/*-----------------------------------------------------------*/
 
-        /* Move the offset where the next character is printed. */
-        offset += 3;
-    }
+void IotLog_SetModuleLevel( uint32_t module,
+                            int level )
+{
+    #if ( IOT_LOG_RUNTIME_FILTER == 1 )
+        if( level < IOT_LOG_NONE )
+        {
+            level = IOT_LOG_NONE;
+        }
+        else if( level > IOT_LOG_DEBUG )
+        {
+            level = IOT_LOG_DEBUG;
+        }
+
+        if( module < IOT_LOG_MODULE_COUNT )
+        {
+            /* A single byte store, nothing to lose to a concurrent caller. */
+            IotLog_ModuleLevels[ module ] = ( uint8_t ) level;
+        }
+    #else
+        ( void ) module;
+        ( void ) level;
+    #endif
+}
+
+/*-----------------------------------------------------------*/
+
+int IotLog_GetModuleLevel( uint32_t module )
+{
+    int level = IOT_LOG_DEBUG;
 
-    /* Print the final line of bytes. This line isn't printed by the for-loop above. */
-    IotLogging_Puts( pMessageBuffer );
+    #if ( IOT_LOG_RUNTIME_FILTER == 1 )
+        level = IOT_LOG_NONE;
+
+        if( module < IOT_LOG_MODULE_COUNT )
+        {
+            level = ( int ) IotLog_ModuleLevels[ module ];
+        }
+    #else
+        ( void ) module;
+    #endif
 
-    /* Free memory used by this function. */
-    IotLogging_Free( pMessageBuffer );
+    return level;
 }
 
 /*-----------------------------------------------------------*/
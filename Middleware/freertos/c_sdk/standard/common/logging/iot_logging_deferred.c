@@ -0,0 +1,906 @@
+/*
+ * FreeRTOS Common V1.1.1
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file iot_logging_deferred.c
+ * @brief Deferred (binary) backend for @ref logging_function_generic.
+ *
+ * When #IOT_LOG_DEFERRED is 1, the calling task does not format anything.
+ * It copies the format pointer, the raw arguments, the tick count and the task
+ * name into a fixed size record of a lock-free ring and returns. A low priority
+ * task, woken when a record lands in the empty ring, drains it and formats each
+ * record into a message slot of the logging task, which alone writes to the
+ * output. No heap memory is used on either side.
+ */
+
+/* The config header is always included first. */
+#include "iot_config.h"
+
+/* Logging includes. */
+#include "private/iot_logging.h"
+
+#if ( IOT_LOG_DEFERRED == 1 )
+
+/* Standard includes. */
+    #include <stdarg.h>
+    #include <stdatomic.h>
+    #include <stdio.h>
+    #include <string.h>
+
+/* FreeRTOS includes. */
+    #include "FreeRTOS.h"
+    #include "task.h"
+
+/* Logging task includes. */
+    #include "iot_logging_deferred.h"
+
+    #if !defined( IotLogging_ReserveLine ) && !defined( configPRINT_STRING )
+        #error configPRINT_STRING( x ) must be defined in FreeRTOSConfig.h to use the deferred logging backend.
+    #endif
+
+    #if ( ( IOT_LOG_DEFERRED_QUEUE_LENGTH & ( IOT_LOG_DEFERRED_QUEUE_LENGTH - 1 ) ) != 0 )
+        #error "IOT_LOG_DEFERRED_QUEUE_LENGTH must be a power of 2."
+    #endif
+
+/**
+ * @brief Longest conversion specification copied out of a format string,
+ * including the terminating NULL (e.g. "%-08.3lld").
+ */
+    #define LOG_DEFERRED_MAX_SPEC_LENGTH    ( 24 )
+
+/**
+ * @brief Index mask for the ring.
+ */
+    #define LOG_DEFERRED_QUEUE_MASK         ( ( uint32_t ) IOT_LOG_DEFERRED_QUEUE_LENGTH - 1U )
+
+/* Record flags, mirroring #IotLogConfig_t. */
+    #define LOG_DEFERRED_HIDE_LEVEL         ( 0x01U )
+    #define LOG_DEFERRED_HIDE_NAME          ( 0x02U )
+    #define LOG_DEFERRED_TRUNCATED          ( 0x04U )
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief How a captured argument must be passed back to snprintf.
+ */
+    typedef enum LogDeferredArgType
+    {
+        LOG_ARG_INT = 0,   /**< int and everything promoted to int. */
+        LOG_ARG_LONG,      /**< long / unsigned long. */
+        LOG_ARG_LONG_LONG, /**< long long / unsigned long long. */
+        LOG_ARG_SIZE,      /**< size_t, ptrdiff_t. */
+        LOG_ARG_DOUBLE,    /**< double (float is promoted). */
+        LOG_ARG_POINTER,   /**< %p. */
+        LOG_ARG_STRING     /**< %s, copied into the record. */
+    } LogDeferredArgType_t;
+
+/**
+ * @brief One captured argument.
+ */
+    typedef struct LogDeferredArg
+    {
+        union
+        {
+            int intValue;
+            long longValue;
+            long long longLongValue;
+            size_t sizeValue;
+            double doubleValue;
+            const void * pPointer;
+            size_t stringOffset; /**< Offset into #LogDeferredRecord_t.strings. */
+        } u;
+        uint8_t type;            /**< One of #LogDeferredArgType_t. */
+    } LogDeferredArg_t;
+
+/**
+ * @brief A log message in binary form.
+ */
+    typedef struct LogDeferredRecord
+    {
+        atomic_uint_least32_t sequence;                      /**< Slot state for the ring. */
+        const char * pFormat;                                /**< Format string; must be in read-only memory. */
+        const char * pLibraryName;                           /**< Library name; must be in read-only memory. */
+        TickType_t timestamp;                                /**< Tick count when the message was logged. */
+        char taskName[ configMAX_TASK_NAME_LEN ];            /**< Name of the logging task. */
+        uint8_t level;                                       /**< Message level. */
+        uint8_t flags;                                       /**< LOG_DEFERRED_* flags. */
+        uint8_t argCount;                                    /**< Number of valid entries in args. */
+        LogDeferredArg_t args[ IOT_LOG_DEFERRED_MAX_ARGS ];  /**< Captured arguments. */
+        char strings[ IOT_LOG_DEFERRED_STRING_BYTES ];       /**< Copies of %s arguments. */
+    } LogDeferredRecord_t;
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Lookup table for log levels, as printed by iot_logging.c.
+ */
+    static const char * const _pLogLevelStrings[ 5 ] =
+    {
+        "",      /* IOT_LOG_NONE */
+        "ERROR", /* IOT_LOG_ERROR */
+        "WARN ", /* IOT_LOG_WARN */
+        "INFO ", /* IOT_LOG_INFO */
+        "DEBUG"  /* IOT_LOG_DEBUG */
+    };
+
+/**
+ * @brief The ring of records.
+ *
+ * Bounded multi-producer, single-consumer queue. Each slot carries a sequence
+ * number: a producer owns slot (pos & mask) once it has advanced _head from pos,
+ * and publishes it by setting the sequence to pos + 1. The consumer releases the
+ * slot back by setting it to pos + IOT_LOG_DEFERRED_QUEUE_LENGTH.
+ *
+ * Sequences are stored relative to the slot index so that the zero-initialized
+ * ring is already valid and records can be queued before the logging task runs.
+ */
+    static LogDeferredRecord_t _records[ IOT_LOG_DEFERRED_QUEUE_LENGTH ];
+
+/**
+ * @brief Next position to be reserved by a producer.
+ */
+    static atomic_uint_least32_t _head = 0;
+
+/**
+ * @brief Next position to be drained. Only touched by the logging task.
+ */
+    static uint32_t _tail = 0;
+
+/**
+ * @brief Number of records dropped because the ring was full.
+ */
+    static atomic_uint_least32_t _droppedRecords = 0;
+
+/**
+ * @brief Set by the drain task before it blocks on an empty ring, cleared by
+ * the producer that wakes it up.
+ */
+    static atomic_bool _drainWaiting = false;
+
+/**
+ * @brief The drain task, notified by producers.
+ */
+    static TaskHandle_t _drainTask = NULL;
+
+    #if !defined( IotLogging_ReserveLine )
+
+/**
+ * @brief Line buffer of the drain task, when there is no logging task to
+ * hand the lines to.
+ */
+        static char _lineBuffer[ IOT_LOG_DEFERRED_LINE_LENGTH ];
+    #endif
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Read the sequence of a slot.
+ */
+    static inline uint32_t _loadSequence( LogDeferredRecord_t * pRecord,
+                                          uint32_t index )
+    {
+        return ( uint32_t ) atomic_load_explicit( &pRecord->sequence, memory_order_acquire ) + index;
+    }
+
+/**
+ * @brief Publish a new sequence for a slot.
+ */
+    static inline void _storeSequence( LogDeferredRecord_t * pRecord,
+                                       uint32_t index,
+                                       uint32_t sequence )
+    {
+        atomic_store_explicit( &pRecord->sequence, sequence - index, memory_order_release );
+    }
+
+/**
+ * @brief Advance a line position by a snprintf result without passing limit.
+ */
+    static size_t _advance( size_t position,
+                            int written,
+                            size_t limit )
+    {
+        size_t newPosition = position;
+
+        if( written > 0 )
+        {
+            newPosition += ( size_t ) written;
+        }
+
+        if( newPosition >= limit )
+        {
+            newPosition = limit - 1U;
+        }
+
+        return newPosition;
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Parse one conversion specification.
+ *
+ * @param[in] pSpec Points at the character after '%'.
+ * @param[out] pConversion The conversion character.
+ * @param[out] pLength Length modifier: 0, 'h', 'l', 'L' ("ll"), 'z' or 'j'.
+ * @param[out] pStarCount Number of '*' (width / precision) arguments.
+ * @param[out] pPrecision Literal precision, or -1 if absent or '*'.
+ *
+ * @return Pointer to the conversion character, or NULL if the specification
+ * is malformed.
+ */
+    static const char * _parseSpec( const char * pSpec,
+                                    char * pConversion,
+                                    char * pLength,
+                                    uint8_t * pStarCount,
+                                    int * pPrecision )
+    {
+        const char * p = pSpec;
+
+        *pLength = 0;
+        *pStarCount = 0;
+        *pPrecision = -1;
+
+        /* Flags. */
+        while( ( *p == '-' ) || ( *p == '+' ) || ( *p == ' ' ) || ( *p == '#' ) || ( *p == '0' ) )
+        {
+            p++;
+        }
+
+        /* Width. */
+        if( *p == '*' )
+        {
+            ( *pStarCount )++;
+            p++;
+        }
+        else
+        {
+            while( ( *p >= '0' ) && ( *p <= '9' ) )
+            {
+                p++;
+            }
+        }
+
+        /* Precision. */
+        if( *p == '.' )
+        {
+            p++;
+
+            if( *p == '*' )
+            {
+                ( *pStarCount )++;
+                p++;
+            }
+            else
+            {
+                *pPrecision = 0;
+
+                while( ( *p >= '0' ) && ( *p <= '9' ) )
+                {
+                    *pPrecision = ( *pPrecision * 10 ) + ( *p - '0' );
+                    p++;
+                }
+            }
+        }
+
+        /* Length modifier. */
+        if( ( *p == 'h' ) || ( *p == 'l' ) || ( *p == 'z' ) || ( *p == 'j' ) || ( *p == 't' ) || ( *p == 'L' ) )
+        {
+            *pLength = *p;
+            p++;
+
+            if( ( *pLength == 'h' ) && ( *p == 'h' ) )
+            {
+                p++;
+            }
+            else if( ( *pLength == 'l' ) && ( *p == 'l' ) )
+            {
+                *pLength = 'L';
+                p++;
+            }
+            else
+            {
+                /* Empty else MISRA 15.7 */
+            }
+        }
+
+        *pConversion = *p;
+
+        return ( *p == '\0' ) ? NULL : p;
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Copy the variadic arguments of pFormat into a record.
+ *
+ * Only the format string is scanned; nothing is formatted. Strings are copied
+ * since the caller's buffer may be gone by the time the record is printed.
+ */
+    static void _captureArgs( LogDeferredRecord_t * pRecord,
+                              va_list args )
+    {
+        const char * p = pRecord->pFormat;
+        size_t stringsUsed = 0;
+        char conversion = 0, length = 0;
+        uint8_t starCount = 0;
+        int precision = -1, starPrecision = -1;
+        LogDeferredArg_t * pArg = NULL;
+        const char * pString = NULL;
+        const char * pStringEnd = NULL;
+        size_t copyLength = 0;
+
+        pRecord->argCount = 0;
+
+        while( ( p != NULL ) && ( *p != '\0' ) )
+        {
+            if( *p != '%' )
+            {
+                p++;
+                continue;
+            }
+
+            p++;
+
+            if( *p == '%' )
+            {
+                p++;
+                continue;
+            }
+
+            p = _parseSpec( p, &conversion, &length, &starCount, &precision );
+
+            if( ( p == NULL ) || ( ( pRecord->argCount + starCount + 1U ) > IOT_LOG_DEFERRED_MAX_ARGS ) )
+            {
+                pRecord->flags |= LOG_DEFERRED_TRUNCATED;
+                break;
+            }
+
+            /* '*' width and precision are passed as int before the value. */
+            starPrecision = -1;
+
+            while( starCount > 0U )
+            {
+                pArg = &pRecord->args[ pRecord->argCount ];
+                pArg->type = LOG_ARG_INT;
+                pArg->u.intValue = va_arg( args, int );
+                starPrecision = pArg->u.intValue;
+                pRecord->argCount++;
+                starCount--;
+            }
+
+            if( precision < 0 )
+            {
+                precision = starPrecision;
+            }
+
+            pArg = &pRecord->args[ pRecord->argCount ];
+
+            switch( conversion )
+            {
+                case 'd':
+                case 'i':
+                case 'u':
+                case 'x':
+                case 'X':
+                case 'o':
+                case 'c':
+
+                    if( length == 'l' )
+                    {
+                        pArg->type = LOG_ARG_LONG;
+                        pArg->u.longValue = va_arg( args, long );
+                    }
+                    else if( ( length == 'L' ) || ( length == 'j' ) )
+                    {
+                        pArg->type = LOG_ARG_LONG_LONG;
+                        pArg->u.longLongValue = va_arg( args, long long );
+                    }
+                    else if( ( length == 'z' ) || ( length == 't' ) )
+                    {
+                        pArg->type = LOG_ARG_SIZE;
+                        pArg->u.sizeValue = va_arg( args, size_t );
+                    }
+                    else
+                    {
+                        pArg->type = LOG_ARG_INT;
+                        pArg->u.intValue = va_arg( args, int );
+                    }
+
+                    break;
+
+                case 'f':
+                case 'F':
+                case 'e':
+                case 'E':
+                case 'g':
+                case 'G':
+                    pArg->type = LOG_ARG_DOUBLE;
+                    pArg->u.doubleValue = va_arg( args, double );
+                    break;
+
+                case 'p':
+                    pArg->type = LOG_ARG_POINTER;
+                    pArg->u.pPointer = va_arg( args, const void * );
+                    break;
+
+                case 's':
+                    pString = va_arg( args, const char * );
+
+                    if( pString == NULL )
+                    {
+                        pString = "(null)";
+                    }
+
+                    /* Respect the precision: the argument need not be terminated. */
+                    if( precision >= 0 )
+                    {
+                        pStringEnd = memchr( pString, '\0', ( size_t ) precision );
+                        copyLength = ( pStringEnd != NULL ) ? ( size_t ) ( pStringEnd - pString ) : ( size_t ) precision;
+                    }
+                    else
+                    {
+                        copyLength = strlen( pString );
+                    }
+
+                    if( copyLength >= ( IOT_LOG_DEFERRED_STRING_BYTES - stringsUsed ) )
+                    {
+                        copyLength = IOT_LOG_DEFERRED_STRING_BYTES - stringsUsed - 1U;
+                        pRecord->flags |= LOG_DEFERRED_TRUNCATED;
+                    }
+
+                    pArg->type = LOG_ARG_STRING;
+                    pArg->u.stringOffset = stringsUsed;
+                    ( void ) memcpy( &pRecord->strings[ stringsUsed ], pString, copyLength );
+                    pRecord->strings[ stringsUsed + copyLength ] = '\0';
+
+                    /* Once full, later strings share the terminating NULL. */
+                    if( ( stringsUsed + copyLength + 1U ) < IOT_LOG_DEFERRED_STRING_BYTES )
+                    {
+                        stringsUsed += copyLength + 1U;
+                    }
+                    else
+                    {
+                        stringsUsed += copyLength;
+                    }
+
+                    break;
+
+                default:
+                    /* %n and unknown conversions are not supported. */
+                    pRecord->flags |= LOG_DEFERRED_TRUNCATED;
+                    p = NULL;
+                    break;
+            }
+
+            if( p != NULL )
+            {
+                pRecord->argCount++;
+                p++;
+            }
+        }
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Format a single conversion specification with its captured argument.
+ *
+ * '*' in the specification are replaced with the captured width and precision
+ * so that a single snprintf call per argument type is enough.
+ */
+    static int _formatSpec( const LogDeferredRecord_t * pRecord,
+                            const char * pSpecStart,
+                            const char * pSpecEnd,
+                            uint8_t * pArgIndex,
+                            char * pBuffer,
+                            size_t bufferSize )
+    {
+        char spec[ LOG_DEFERRED_MAX_SPEC_LENGTH ] = { 0 };
+        size_t specLength = 0;
+        const char * p = pSpecStart;
+        const LogDeferredArg_t * pArg = NULL;
+        int written = -1;
+
+        while( ( p <= pSpecEnd ) && ( specLength < ( sizeof( spec ) - 1U ) ) )
+        {
+            if( *p == '*' )
+            {
+                written = snprintf( &spec[ specLength ], sizeof( spec ) - specLength, "%d",
+                                    pRecord->args[ *pArgIndex ].u.intValue );
+
+                if( ( written < 0 ) || ( ( size_t ) written >= ( sizeof( spec ) - specLength ) ) )
+                {
+                    return -1;
+                }
+
+                specLength += ( size_t ) written;
+                ( *pArgIndex )++;
+            }
+            else
+            {
+                spec[ specLength ] = *p;
+                specLength++;
+            }
+
+            p++;
+        }
+
+        if( p <= pSpecEnd )
+        {
+            return -1;
+        }
+
+        pArg = &pRecord->args[ *pArgIndex ];
+        ( *pArgIndex )++;
+
+        switch( pArg->type )
+        {
+            case LOG_ARG_INT:
+                written = snprintf( pBuffer, bufferSize, spec, pArg->u.intValue );
+                break;
+
+            case LOG_ARG_LONG:
+                written = snprintf( pBuffer, bufferSize, spec, pArg->u.longValue );
+                break;
+
+            case LOG_ARG_LONG_LONG:
+                written = snprintf( pBuffer, bufferSize, spec, pArg->u.longLongValue );
+                break;
+
+            case LOG_ARG_SIZE:
+                written = snprintf( pBuffer, bufferSize, spec, pArg->u.sizeValue );
+                break;
+
+            case LOG_ARG_DOUBLE:
+                written = snprintf( pBuffer, bufferSize, spec, pArg->u.doubleValue );
+                break;
+
+            case LOG_ARG_POINTER:
+                written = snprintf( pBuffer, bufferSize, spec, pArg->u.pPointer );
+                break;
+
+            case LOG_ARG_STRING:
+                written = snprintf( pBuffer, bufferSize, spec, &pRecord->strings[ pArg->u.stringOffset ] );
+                break;
+
+            default:
+                written = -1;
+                break;
+        }
+
+        return written;
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Render a record into pLine, in the same layout as vLoggingPrintf
+ * followed by @ref logging_function_generic.
+ *
+ * @return Number of characters in the line, excluding the NULL.
+ */
+    static size_t _formatRecord( const LogDeferredRecord_t * pRecord,
+                                 uint32_t messageNumber,
+                                 char * pLine,
+                                 size_t lineSize )
+    {
+        /* Keep room for "\r\n" and the terminating NULL. */
+        const size_t lineLimit = lineSize - 3U;
+        size_t position = 0;
+        int written = 0;
+        const char * p = pRecord->pFormat;
+        const char * pSpecStart = NULL;
+        char conversion = 0, length = 0;
+        uint8_t starCount = 0, argIndex = 0;
+        int precision = -1;
+
+        written = snprintf( pLine, lineLimit, "%lu %lu [%s] ",
+                            ( unsigned long ) messageNumber,
+                            ( unsigned long ) pRecord->timestamp,
+                            pRecord->taskName );
+        position = _advance( 0, written, lineLimit );
+
+        if( ( pRecord->flags & LOG_DEFERRED_HIDE_LEVEL ) == 0U )
+        {
+            written = snprintf( &pLine[ position ], lineLimit - position, "[%s]",
+                                _pLogLevelStrings[ pRecord->level ] );
+            position = _advance( position, written, lineLimit );
+        }
+
+        if( ( pRecord->flags & LOG_DEFERRED_HIDE_NAME ) == 0U )
+        {
+            written = snprintf( &pLine[ position ], lineLimit - position, "[%s]",
+                                pRecord->pLibraryName );
+            position = _advance( position, written, lineLimit );
+        }
+
+        pLine[ position ] = ' ';
+        position++;
+
+        while( ( *p != '\0' ) && ( position < lineLimit ) )
+        {
+            if( ( *p != '%' ) || ( p[ 1 ] == '%' ) )
+            {
+                pLine[ position ] = *p;
+                position++;
+                p += ( *p == '%' ) ? 2 : 1;
+                continue;
+            }
+
+            pSpecStart = p;
+            p = _parseSpec( p + 1, &conversion, &length, &starCount, &precision );
+
+            /* Stop where capture stopped. */
+            if( ( p == NULL ) || ( ( argIndex + starCount ) >= pRecord->argCount ) )
+            {
+                break;
+            }
+
+            written = _formatSpec( pRecord, pSpecStart, p, &argIndex,
+                                   &pLine[ position ], lineLimit - position );
+
+            if( written < 0 )
+            {
+                break;
+            }
+
+            position = _advance( position, written, lineLimit );
+            p++;
+        }
+
+        if( ( ( pRecord->flags & LOG_DEFERRED_TRUNCATED ) != 0U ) && ( position >= 3U ) )
+        {
+            ( void ) memcpy( &pLine[ position - 3U ], "...", 3U );
+        }
+
+        pLine[ position ] = '\r';
+        pLine[ position + 1U ] = '\n';
+        pLine[ position + 2U ] = '\0';
+
+        return position + 2U;
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Take the buffer a line is formatted into.
+ *
+ * Lines go to the logging task, the only writer of the output port. Its slot
+ * prefix is overwritten: the record carries the time and task of the caller.
+ *
+ * @return The buffer, or NULL if the logging task has no free slot.
+ */
+    static char * _reserveLine( size_t * pLineSize )
+    {
+        #if defined( IotLogging_ReserveLine )
+            size_t prefixLength = 0;
+
+            return IotLogging_ReserveLine( &prefixLength, pLineSize );
+        #else
+            *pLineSize = sizeof( _lineBuffer );
+
+            return _lineBuffer;
+        #endif
+    }
+
+/**
+ * @brief Print a line from _reserveLine().
+ */
+    static void _sendLine( char * pLine )
+    {
+        #if defined( IotLogging_SendLine )
+            IotLogging_SendLine( pLine );
+        #else
+            configPRINT_STRING( pLine );
+        #endif
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Low priority task that formats and prints queued records.
+ */
+    static void _loggingDeferredTask( void * pvParameters )
+    {
+        LogDeferredRecord_t * pRecord = NULL;
+        uint32_t index = 0, sequence = 0, droppedRecords = 0, reportedDrops = 0;
+        char * pLine = NULL;
+        size_t lineSize = 0;
+
+        ( void ) pvParameters;
+
+        for( ; ; )
+        {
+            index = _tail & LOG_DEFERRED_QUEUE_MASK;
+            pRecord = &_records[ index ];
+            sequence = _loadSequence( pRecord, index );
+
+            if( sequence == ( _tail + 1U ) )
+            {
+                /* A record without a free line is counted as dropped by the
+                 * logging task. */
+                pLine = _reserveLine( &lineSize );
+
+                if( pLine != NULL )
+                {
+                    ( void ) _formatRecord( pRecord, _tail, pLine, lineSize );
+                }
+
+                /* Hand the slot back to producers before the slow output. */
+                _storeSequence( pRecord, index, _tail + ( uint32_t ) IOT_LOG_DEFERRED_QUEUE_LENGTH );
+                _tail++;
+
+                if( pLine != NULL )
+                {
+                    _sendLine( pLine );
+                }
+
+                continue;
+            }
+
+            droppedRecords = atomic_load_explicit( &_droppedRecords, memory_order_relaxed );
+
+            if( droppedRecords != reportedDrops )
+            {
+                pLine = _reserveLine( &lineSize );
+
+                if( pLine != NULL )
+                {
+                    ( void ) snprintf( pLine, lineSize,
+                                       "[WARN ][LOGGING] %lu log records dropped\r\n",
+                                       ( unsigned long ) ( droppedRecords - reportedDrops ) );
+                    reportedDrops = droppedRecords;
+                    _sendLine( pLine );
+                }
+            }
+
+            /* Sleep until a producer publishes into the empty ring. The ring is
+             * checked again once the flag is visible, so a record published in
+             * between is either seen here or followed by a notification. */
+            atomic_store_explicit( &_drainWaiting, true, memory_order_relaxed );
+            atomic_thread_fence( memory_order_seq_cst );
+
+            if( _loadSequence( pRecord, index ) != ( _tail + 1U ) )
+            {
+                ( void ) ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+            }
+
+            atomic_store_explicit( &_drainWaiting, false, memory_order_relaxed );
+        }
+    }
+
+/*-----------------------------------------------------------*/
+
+    void IotLog_DeferredPush( const char * const pLibraryName,
+                              int messageLevel,
+                              const IotLogConfig_t * const pLogConfig,
+                              const char * const pFormat,
+                              va_list args )
+    {
+        LogDeferredRecord_t * pRecord = NULL;
+        uint32_t position = atomic_load_explicit( &_head, memory_order_relaxed );
+        uint32_t index = 0, sequence = 0;
+        int32_t difference = 0;
+        const char * pTaskName = "None";
+
+        /* Reserve a slot. */
+        for( ; ; )
+        {
+            index = position & LOG_DEFERRED_QUEUE_MASK;
+            pRecord = &_records[ index ];
+            sequence = _loadSequence( pRecord, index );
+            difference = ( int32_t ) ( sequence - position );
+
+            if( difference == 0 )
+            {
+                if( atomic_compare_exchange_weak_explicit( &_head, &position, position + 1U,
+                                                           memory_order_relaxed,
+                                                           memory_order_relaxed ) )
+                {
+                    break;
+                }
+            }
+            else if( difference < 0 )
+            {
+                /* Ring is full. Never block the caller. */
+                ( void ) atomic_fetch_add_explicit( &_droppedRecords, 1U, memory_order_relaxed );
+
+                return;
+            }
+            else
+            {
+                position = atomic_load_explicit( &_head, memory_order_relaxed );
+            }
+        }
+
+        pRecord->pFormat = pFormat;
+        pRecord->pLibraryName = pLibraryName;
+        pRecord->level = ( uint8_t ) messageLevel;
+        pRecord->flags = 0;
+
+        if( ( pLogConfig != NULL ) && ( pLogConfig->hideLogLevel == true ) )
+        {
+            pRecord->flags |= LOG_DEFERRED_HIDE_LEVEL;
+        }
+
+        if( ( pLogConfig != NULL ) && ( pLogConfig->hideLibraryName == true ) )
+        {
+            pRecord->flags |= LOG_DEFERRED_HIDE_NAME;
+        }
+
+        if( xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED )
+        {
+            pTaskName = pcTaskGetName( NULL );
+        }
+
+        pRecord->timestamp = xTaskGetTickCount();
+        ( void ) strncpy( pRecord->taskName, pTaskName, sizeof( pRecord->taskName ) - 1U );
+        pRecord->taskName[ sizeof( pRecord->taskName ) - 1U ] = '\0';
+
+        _captureArgs( pRecord, args );
+
+        /* Publish the record. */
+        _storeSequence( pRecord, index, position + 1U );
+
+        /* Wake the drain task up if it went to sleep on the empty ring. */
+        atomic_thread_fence( memory_order_seq_cst );
+
+        if( ( atomic_exchange_explicit( &_drainWaiting, false, memory_order_relaxed ) == true ) &&
+            ( _drainTask != NULL ) )
+        {
+            ( void ) xTaskNotifyGive( _drainTask );
+        }
+    }
+
+/*-----------------------------------------------------------*/
+
+    BaseType_t xLoggingDeferredInitialize( uint16_t usStackSize,
+                                           UBaseType_t uxPriority )
+    {
+        static BaseType_t xInitialized = pdFALSE;
+        BaseType_t xReturn = pdFAIL;
+
+        if( xInitialized == pdFALSE )
+        {
+            if( xTaskCreate( _loggingDeferredTask, "LogDefer", usStackSize, NULL, uxPriority, &_drainTask ) == pdPASS )
+            {
+                xInitialized = pdTRUE;
+                xReturn = pdPASS;
+            }
+        }
+
+        return xReturn;
+    }
+
+/*-----------------------------------------------------------*/
+
+    uint32_t ulLoggingDeferredGetDropCount( void )
+    {
+        return ( uint32_t ) atomic_load_explicit( &_droppedRecords, memory_order_relaxed );
+    }
+
+/*-----------------------------------------------------------*/
+
+#endif /* if ( IOT_LOG_DEFERRED == 1 ) */
@@ -27,6 +27,7 @@
 #include "FreeRTOS.h"
 #include "task.h"
 #include "queue.h"
+#include "atomic.h"
 
 /* Logging includes. */
 #include "iot_logging_task.h"
@@ -49,6 +50,20 @@
     #error configLOGGING_INCLUDE_TIME_AND_TASK_NAME must be defined in FreeRTOSConfig.h to use this logging file.  Set configLOGGING_INCLUDE_TIME_AND_TASK_NAME to 1 to prepend a time stamp, message number and the name of the calling task to each logged message.  Otherwise set to 0.
 #endif
 
+#if ( configSUPPORT_STATIC_ALLOCATION != 1 )
+    #error configSUPPORT_STATIC_ALLOCATION must be 1 to use this logging file.  The message slots and the queues that pass them around are statically allocated.
+#endif
+
+/* Number of message slots reserved at build time.  The queue length passed to
+ * xLoggingTaskInitialize() is capped to this value. */
+#ifndef configLOGGING_MAX_QUEUE_LENGTH
+    #define configLOGGING_MAX_QUEUE_LENGTH    16
+#endif
+
+#if ( configLOGGING_MAX_QUEUE_LENGTH > 255 )
+    #error configLOGGING_MAX_QUEUE_LENGTH must fit the 8-bit slot index.
+#endif
+
 /* A block time of 0 just means don't block. */
 #define loggingDONT_BLOCK    0
 
@@ -61,20 +76,41 @@
  * written.  Using a separate task also serializes access to the output port.
  *
  * The structure of this task is very simple; it blocks on a queue to wait for
- * a pointer to a string, sending any received strings to a macro that performs
- * the actual output.  The macro is port specific, so implemented outside of
- * this file.  This version uses dynamic memory, so the buffer that contained
- * the log message is freed after it has been output.
+ * the index of a filled message slot, sends the slot to a macro that performs
+ * the actual output, then hands the slot back to the writers.  The macro is
+ * port specific, so implemented outside of this file.
  */
 static void prvLoggingTask( void * pvParameters );
 
+/*
+ * Take a free slot and, if xAddPrefix is pdTRUE, write the message number,
+ * time and task name into it.  Returns NULL, and counts a dropped message, if
+ * every slot is in use.
+ */
+static char * prvTakeSlot( BaseType_t xAddPrefix,
+                           size_t * pxLength );
+
 /*-----------------------------------------------------------*/
 
 /*
- * The queue used to pass pointers to log messages from the task that created
- * the message to the task that will performs the output.
+ * Messages are formatted exactly once, straight into one of these slots, so
+ * logging never competes with the rest of the application for the heap.
+ */
+static char cMessageSlots[ configLOGGING_MAX_QUEUE_LENGTH ][ configLOGGING_MAX_MESSAGE_LENGTH ];
+
+/*
+ * xQueue passes the indexes of filled slots to the logging task, xFreeSlots
+ * holds the indexes of the slots that can be written.
  */
 static QueueHandle_t xQueue = NULL;
+static QueueHandle_t xFreeSlots = NULL;
+static StaticQueue_t xQueueBuffer;
+static StaticQueue_t xFreeSlotsBuffer;
+static uint8_t ucQueueStorage[ configLOGGING_MAX_QUEUE_LENGTH ];
+static uint8_t ucFreeSlotsStorage[ configLOGGING_MAX_QUEUE_LENGTH ];
+
+/* Messages lost because every slot was in use. */
+static volatile uint32_t ulDroppedMessages = 0;
 
 /*-----------------------------------------------------------*/
 
@@ -83,24 +119,36 @@ BaseType_t xLoggingTaskInitialize( uint16_t usStackSize,
                                    UBaseType_t uxQueueLength )
 {
     BaseType_t xReturn = pdFAIL;
+    uint8_t ucSlot = 0;
+
+    if( uxQueueLength > ( UBaseType_t ) configLOGGING_MAX_QUEUE_LENGTH )
+    {
+        uxQueueLength = configLOGGING_MAX_QUEUE_LENGTH;
+    }
 
     /* Ensure the logging task has not been created already. */
-    if( xQueue == NULL )
+    if( ( xQueue == NULL ) && ( uxQueueLength > 0U ) )
     {
-        /* Create the queue used to pass pointers to strings to the logging task. */
-        xQueue = xQueueCreate( uxQueueLength, sizeof( char ** ) );
+        /* Create the queues used to pass slot indexes to and from the logging task. */
+        xQueue = xQueueCreateStatic( uxQueueLength, sizeof( uint8_t ), ucQueueStorage, &xQueueBuffer );
+        xFreeSlots = xQueueCreateStatic( uxQueueLength, sizeof( uint8_t ), ucFreeSlotsStorage, &xFreeSlotsBuffer );
 
-        if( xQueue != NULL )
+        for( ucSlot = 0; ucSlot < ( uint8_t ) uxQueueLength; ucSlot++ )
         {
-            if( xTaskCreate( prvLoggingTask, "Logging", usStackSize, NULL, uxPriority, NULL ) == pdPASS )
-            {
-                xReturn = pdPASS;
-            }
-            else
-            {
-                /* Could not create the task, so delete the queue again. */
-                vQueueDelete( xQueue );
-            }
+            ( void ) xQueueSend( xFreeSlots, &ucSlot, loggingDONT_BLOCK );
+        }
+
+        if( xTaskCreate( prvLoggingTask, "Logging", usStackSize, NULL, uxPriority, NULL ) == pdPASS )
+        {
+            xReturn = pdPASS;
+        }
+        else
+        {
+            /* Could not create the task, so delete the queues again. */
+            vQueueDelete( xFreeSlots );
+            vQueueDelete( xQueue );
+            xFreeSlots = NULL;
+            xQueue = NULL;
         }
     }
 
@@ -110,20 +158,132 @@ BaseType_t xLoggingTaskInitialize( uint16_t usStackSize,
 
 static void prvLoggingTask( void * pvParameters )
 {
-    char * pcReceivedString = NULL;
+    uint8_t ucSlot = 0;
+    uint32_t ulDropped = 0, ulReportedDrops = 0;
+
+    ( void ) pvParameters;
 
     for( ; ; )
     {
-        /* Block to wait for the next string to print. */
-        if( xQueueReceive( xQueue, &pcReceivedString, portMAX_DELAY ) == pdPASS )
+        /* Block to wait for the next slot to print. */
+        if( xQueueReceive( xQueue, &ucSlot, portMAX_DELAY ) == pdPASS )
         {
-            configPRINT_STRING( pcReceivedString );
-            vPortFree( ( void * ) pcReceivedString );
+            configPRINT_STRING( cMessageSlots[ ucSlot ] );
+
+            /* Report lost messages from the slot that was just printed, so the
+             * report itself can never be dropped. */
+            ulDropped = ulDroppedMessages;
+
+            if( ulDropped != ulReportedDrops )
+            {
+                ( void ) snprintf( cMessageSlots[ ucSlot ], configLOGGING_MAX_MESSAGE_LENGTH,
+                                   "[WARN ][LOGGING] %lu log messages dropped\r\n",
+                                   ( unsigned long ) ( ulDropped - ulReportedDrops ) );
+                ulReportedDrops = ulDropped;
+                configPRINT_STRING( cMessageSlots[ ucSlot ] );
+            }
+
+            ( void ) xQueueSend( xFreeSlots, &ucSlot, loggingDONT_BLOCK );
         }
     }
 }
 /*-----------------------------------------------------------*/
 
+static char * prvTakeSlot( BaseType_t xAddPrefix,
+                           size_t * pxLength )
+{
+    uint8_t ucSlot = 0;
+    char * pcSlot = NULL;
+
+    /* The queues are created by xLoggingTaskInitialize().  Check
+     * xLoggingTaskInitialize() has been called. */
+    configASSERT( xQueue );
+
+    if( xQueueReceive( xFreeSlots, &ucSlot, loggingDONT_BLOCK ) != pdPASS )
+    {
+        ( void ) Atomic_Increment_u32( &ulDroppedMessages );
+    }
+    else
+    {
+        pcSlot = cMessageSlots[ ucSlot ];
+        *pxLength = 0;
+
+        #if ( configLOGGING_INCLUDE_TIME_AND_TASK_NAME == 1 )
+            if( xAddPrefix != pdFALSE )
+            {
+                const char * pcTaskName;
+                const char * pcNoTask = "None";
+                static uint32_t ulMessageNumber = 0;
+                int32_t xLength = 0;
+
+                /* Add a time stamp and the name of the calling task to the
+                 * start of the log. */
+                if( xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED )
+                {
+                    pcTaskName = pcTaskGetName( NULL );
+                }
+                else
+                {
+                    pcTaskName = pcNoTask;
+                }
+
+                xLength = snprintf( pcSlot, configLOGGING_MAX_MESSAGE_LENGTH, "%lu %lu [%s] ",
+                                    ( unsigned long ) Atomic_Increment_u32( &ulMessageNumber ),
+                                    ( unsigned long ) xTaskGetTickCount(),
+                                    pcTaskName );
+
+                if( xLength > 0 )
+                {
+                    *pxLength = ( size_t ) xLength;
+                }
+
+                if( *pxLength >= configLOGGING_MAX_MESSAGE_LENGTH )
+                {
+                    *pxLength = configLOGGING_MAX_MESSAGE_LENGTH - 1U;
+                }
+            }
+        #else /* if ( configLOGGING_INCLUDE_TIME_AND_TASK_NAME == 1 ) */
+            ( void ) xAddPrefix;
+        #endif /* if ( configLOGGING_INCLUDE_TIME_AND_TASK_NAME == 1 ) */
+
+        pcSlot[ *pxLength ] = '\0';
+    }
+
+    return pcSlot;
+}
+/*-----------------------------------------------------------*/
+
+char * pcLoggingReserveMessage( size_t * pxLength,
+                                size_t * pxSize )
+{
+    char * pcSlot = prvTakeSlot( pdTRUE, pxLength );
+
+    if( pcSlot != NULL )
+    {
+        *pxSize = configLOGGING_MAX_MESSAGE_LENGTH;
+    }
+
+    return pcSlot;
+}
+/*-----------------------------------------------------------*/
+
+void vLoggingSendMessage( char * pcMessage )
+{
+    uint8_t ucSlot = ( uint8_t ) ( ( pcMessage - cMessageSlots[ 0 ] ) / configLOGGING_MAX_MESSAGE_LENGTH );
+
+    configASSERT( pcMessage == cMessageSlots[ ucSlot ] );
+
+    /* There is a free entry in xQueue for every slot, so this cannot fail. */
+    ( void ) xQueueSend( xQueue, &ucSlot, loggingDONT_BLOCK );
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulLoggingGetDropCount( void )
+{
+    return ulDroppedMessages;
+}
+/*-----------------------------------------------------------*/
+
 /*!
  * \brief Formats a string to be printed and sends it
  * to the print queue.
@@ -137,89 +297,30 @@ void vLoggingPrintf( const char * pcFormat,
                      ... )
 {
     size_t xLength = 0;
-    int32_t xLength2 = 0;
+    int32_t xWritten = 0;
     va_list args;
     char * pcPrintString = NULL;
 
-    /* The queue is created by xLoggingTaskInitialize().  Check
-     * xLoggingTaskInitialize() has been called. */
-    configASSERT( xQueue );
-
-    /* Allocate a buffer to hold the log message. */
-    pcPrintString = pvPortMalloc( configLOGGING_MAX_MESSAGE_LENGTH );
+    /* A lone newline is printed without the prefix. */
+    pcPrintString = prvTakeSlot( ( strcmp( pcFormat, "\n" ) != 0 ) ? pdTRUE : pdFALSE, &xLength );
 
     if( pcPrintString != NULL )
     {
         /* There are a variable number of parameters. */
         va_start( args, pcFormat );
+        xWritten = vsnprintf( pcPrintString + xLength, configLOGGING_MAX_MESSAGE_LENGTH - xLength, pcFormat, args );
+        va_end( args );
 
-        if( strcmp( pcFormat, "\n" ) != 0 )
-        {
-            #if ( configLOGGING_INCLUDE_TIME_AND_TASK_NAME == 1 )
-                {
-                    const char * pcTaskName;
-                    const char * pcNoTask = "None";
-                    static BaseType_t xMessageNumber = 0;
-
-                    /* Add a time stamp and the name of the calling task to the
-                     * start of the log. */
-                    if( xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED )
-                    {
-                        pcTaskName = pcTaskGetName( NULL );
-                    }
-                    else
-                    {
-                        pcTaskName = pcNoTask;
-                    }
-
-                    xLength = snprintf( pcPrintString, configLOGGING_MAX_MESSAGE_LENGTH, "%lu %lu [%s] ",
-                                        ( unsigned long ) xMessageNumber++,
-                                        ( unsigned long ) xTaskGetTickCount(),
-                                        pcTaskName );
-                }
-            #else /* if ( configLOGGING_INCLUDE_TIME_AND_TASK_NAME == 1 ) */
-                {
-                    xLength = 0;
-                }
-            #endif /* if ( configLOGGING_INCLUDE_TIME_AND_TASK_NAME == 1 ) */
-        }
-
-        xLength2 = vsnprintf( pcPrintString + xLength, configLOGGING_MAX_MESSAGE_LENGTH - xLength, pcFormat, args );
-
-        if( xLength2 < 0 )
+        if( xWritten < 0 )
         {
             /* vsnprintf() failed. Restore the terminating NULL
-             * character of the first part. Note that the first
-             * part of the buffer may be empty if the value of
-             * configLOGGING_INCLUDE_TIME_AND_TASK_NAME is not
-             * 1 and as a result, the whole buffer may be empty.
-             * That's the reason we have a check for xLength > 0
-             * before sending the buffer to the logging task.
-             */
-            xLength2 = 0;
+             * character of the first part. */
             pcPrintString[ xLength ] = '\0';
         }
 
-        xLength += ( size_t ) xLength2;
-        va_end( args );
-
-        /* Only send the buffer to the logging task if it is
-         * not empty. */
-        if( xLength > 0 )
-        {
-            /* Send the string to the logging task for IO. */
-            if( xQueueSend( xQueue, &pcPrintString, loggingDONT_BLOCK ) != pdPASS )
-            {
-                /* The buffer was not sent so must be freed again. */
-                vPortFree( ( void * ) pcPrintString );
-            }
-        }
-        else
-        {
-            /* The buffer was not sent, so it must be
-             * freed. */
-            vPortFree( ( void * ) pcPrintString );
-        }
+        /* The slot goes to the logging task even if it is empty, which is
+         * the only way to hand it back. */
+        vLoggingSendMessage( pcPrintString );
     }
 }
 /*-----------------------------------------------------------*/
@@ -229,22 +330,15 @@ void vLoggingPrint( const char * pcMessage )
     char * pcPrintString = NULL;
     size_t xLength = 0;
 
-    /* The queue is created by xLoggingTaskInitialize().  Check
-     * xLoggingTaskInitialize() has been called. */
-    configASSERT( xQueue );
-
-    xLength = strlen( pcMessage ) + 1;
-    pcPrintString = pvPortMalloc( xLength );
+    pcPrintString = prvTakeSlot( pdFALSE, &xLength );
 
     if( pcPrintString != NULL )
     {
-        strncpy( pcPrintString, pcMessage, xLength );
+        /* Copy, truncating to the slot size. */
+        ( void ) strncpy( pcPrintString, pcMessage, configLOGGING_MAX_MESSAGE_LENGTH - 1U );
+        pcPrintString[ configLOGGING_MAX_MESSAGE_LENGTH - 1U ] = '\0';
 
         /* Send the string to the logging task for IO. */
-        if( xQueueSend( xQueue, &pcPrintString, loggingDONT_BLOCK ) != pdPASS )
-        {
-            /* The buffer was not sent so must be freed again. */
-            vPortFree( ( void * ) pcPrintString );
-        }
+        vLoggingSendMessage( pcPrintString );
     }
 }
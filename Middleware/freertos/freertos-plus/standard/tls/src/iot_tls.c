@@ -29,6 +29,9 @@
 #include "task.h"
 #include "nce_demo_config.h"
 #include "nce_iot_c_sdk.h"
+#if defined( CONFIG_COAP_DEMO_ENABLED )
+    #include "nce_psk_cache.h"
+#endif
 extern OSNetwork_t xOSNetwork;
 extern os_network_ops_t osNetwork;
 
@@ -167,6 +170,52 @@ static void prvFreeContext( TLSContext_t * pxCtx )
 
 /*-----------------------------------------------------------*/
 
+#if ( defined( CONFIG_COAP_DEMO_ENABLED ) && defined( CONFIG_NCE_PSK_CACHE ) )
+
+/**
+ * @brief Tell a handshake failure caused by the PSK from other failures.
+ *
+ * Must be called before the context is freed, a fatal alert is only
+ * classified by the record mbedTLS leaves in its input buffer.
+ *
+ * @param[in] pxCtx Context of the failed handshake.
+ * @param[in] xResult Error returned by mbedtls_ssl_handshake().
+ *
+ * @return pdTRUE if the server does not know the identity or the key.
+ */
+    static BaseType_t prvPskRejected( const TLSContext_t * pxCtx,
+                                      BaseType_t xResult )
+    {
+        BaseType_t xRejected = pdFALSE;
+        uint8_t ucAlert = 0;
+
+        if( MBEDTLS_ERR_SSL_FATAL_ALERT_MESSAGE == xResult )
+        {
+            /* in_msg still holds the alert: level, then description. Alerts
+             * unrelated to the key, e.g. internal_error, keep the cache. */
+            if( NULL != pxCtx->xMbedSslCtx.in_msg )
+            {
+                ucAlert = pxCtx->xMbedSslCtx.in_msg[ 1 ];
+            }
+
+            xRejected = ( ( MBEDTLS_SSL_ALERT_MSG_BAD_RECORD_MAC == ucAlert ) ||
+                          ( MBEDTLS_SSL_ALERT_MSG_DECRYPT_ERROR == ucAlert ) ||
+                          ( MBEDTLS_SSL_ALERT_MSG_UNKNOWN_PSK_IDENTITY == ucAlert ) ) ? pdTRUE : pdFALSE;
+        }
+        else
+        {
+            xRejected = ( ( MBEDTLS_ERR_SSL_BAD_HS_FINISHED == xResult ) ||
+                          ( MBEDTLS_ERR_SSL_INVALID_MAC == xResult ) ||
+                          ( MBEDTLS_ERR_SSL_UNKNOWN_IDENTITY == xResult ) ) ? pdTRUE : pdFALSE;
+        }
+
+        return xRejected;
+    }
+
+/*-----------------------------------------------------------*/
+
+#endif /* if ( defined( CONFIG_COAP_DEMO_ENABLED ) && defined( CONFIG_NCE_PSK_CACHE ) ) */
+
 /**
  * @brief Network send callback shim.
  *
@@ -253,7 +302,13 @@ static int prvGenerateRandomBytes( void * pvCtx,
 
         #if ( defined( ENABLE_DTLS ) && defined( CONFIG_COAP_DEMO_ENABLED ) )
             DtlsKey_t nceKey = { 0 };
-            int result = os_auth( &osNetwork, &nceKey );
+            int result = NcePskCache_GetKey( &nceKey );
+
+            if( result != NCE_SDK_SUCCESS )
+            {
+                TLS_PRINT( ( "ERROR: Device Authenticator onboarding failed %d \r\n", result ) );
+                xResult = CKR_FUNCTION_FAILED;
+            }
 
             /* Attach the client PSK the DTLS configuration. */
             if( 0 == xResult )
@@ -480,6 +535,14 @@ BaseType_t TLS_Init( void ** ppvContext,
                 if( ( MBEDTLS_ERR_SSL_WANT_READ != xResult ) &&
                     ( MBEDTLS_ERR_SSL_WANT_WRITE != xResult ) )
                 {
+                    #if ( defined( CONFIG_COAP_DEMO_ENABLED ) && defined( CONFIG_NCE_PSK_CACHE ) )
+                        /* The server rejected the PSK, fetch new credentials on the next connect. */
+                        if( prvPskRejected( pxCtx, xResult ) == pdTRUE )
+                        {
+                            NcePskCache_Invalidate();
+                        }
+                    #endif
+
                     /* There was an unexpected error. Per mbedTLS API documentation,
                      * ensure that upstream clean-up code doesn't accidentally use
                      * a context that failed the handshake. */
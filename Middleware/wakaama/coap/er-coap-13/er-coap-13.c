@@ -1112,8 +1112,11 @@ coap_status_t coap_parse_message( void * packet,
         current_option += option_length;
     } /* for */
 
-    /* Add a null terminator to the payload */
-    coap_pkt->payload[ coap_pkt->payload_len ] = '\0';
+    /* Add a null terminator to the payload, if there is one */
+    if( coap_pkt->payload != NULL )
+    {
+        coap_pkt->payload[ coap_pkt->payload_len ] = '\0';
+    }
 
 
     /* Print the payload */
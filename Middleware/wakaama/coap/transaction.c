@@ -115,6 +115,104 @@ Contains code snippets which are:
 #define COAP_RESPONSE_TIMEOUT_TICKS         (CLOCK_SECOND * COAP_RESPONSE_TIMEOUT)
 #define COAP_RESPONSE_TIMEOUT_BACKOFF_MASK  ((CLOCK_SECOND * COAP_RESPONSE_TIMEOUT * (COAP_RESPONSE_RANDOM_FACTOR - 1)) + 1.5)
 
+// A pooled transaction comes with its CoAP message and a buffer holding the
+// serialized message when it fits, the heap takes over otherwise.
+typedef struct
+{
+    lwm2m_transaction_t transaction;
+    coap_packet_t message;
+    uint8_t buffer[LWM2M_TRANSACTION_BUFFER_SIZE];
+    bool used;
+} transaction_slot_t;
+
+#if LWM2M_TRANSACTION_POOL_SIZE > 0
+static transaction_slot_t prv_slots[LWM2M_TRANSACTION_POOL_SIZE];
+#endif
+
+static transaction_slot_t * prv_findSlot(lwm2m_transaction_t * transacP)
+{
+#if LWM2M_TRANSACTION_POOL_SIZE > 0
+    size_t i;
+
+    for (i = 0; i < LWM2M_TRANSACTION_POOL_SIZE; i++)
+    {
+        if (&prv_slots[i].transaction == transacP) return prv_slots + i;
+    }
+#else
+    (void)transacP;
+#endif
+
+    return NULL;
+}
+
+static lwm2m_transaction_t * prv_allocate(void)
+{
+    lwm2m_transaction_t * transacP;
+
+#if LWM2M_TRANSACTION_POOL_SIZE > 0
+    size_t i;
+
+    for (i = 0; i < LWM2M_TRANSACTION_POOL_SIZE; i++)
+    {
+        if (!prv_slots[i].used)
+        {
+            prv_slots[i].used = true;
+            transacP = &prv_slots[i].transaction;
+            memset(transacP, 0, sizeof(lwm2m_transaction_t));
+            transacP->message = &prv_slots[i].message;
+            return transacP;
+        }
+    }
+    LOG("transaction pool exhausted");
+#endif
+
+    transacP = (lwm2m_transaction_t *)lwm2m_malloc(sizeof(lwm2m_transaction_t));
+    if (NULL == transacP) return NULL;
+    memset(transacP, 0, sizeof(lwm2m_transaction_t));
+
+    transacP->message = lwm2m_malloc(sizeof(coap_packet_t));
+    if (NULL == transacP->message)
+    {
+        lwm2m_free(transacP);
+        return NULL;
+    }
+
+    return transacP;
+}
+
+// Pending transactions are kept in contextP->transactionTimers sorted by
+// retrans_time, transactions due at the same time in the order they were
+// queued.
+static void prv_timerInsert(lwm2m_context_t * contextP,
+                            lwm2m_transaction_t * transacP)
+{
+    lwm2m_transaction_t ** nextP = &contextP->transactionTimers;
+
+    while (*nextP != NULL && (*nextP)->retrans_time <= transacP->retrans_time)
+    {
+        nextP = &(*nextP)->timerNext;
+    }
+    transacP->timerNext = *nextP;
+    *nextP = transacP;
+}
+
+static void prv_timerRemove(lwm2m_context_t * contextP,
+                            lwm2m_transaction_t * transacP)
+{
+    lwm2m_transaction_t ** nextP = &contextP->transactionTimers;
+
+    while (*nextP != NULL)
+    {
+        if (*nextP == transacP)
+        {
+            *nextP = transacP->timerNext;
+            break;
+        }
+        nextP = &(*nextP)->timerNext;
+    }
+    transacP->timerNext = NULL;
+}
+
 static int prv_checkFinished(lwm2m_transaction_t * transacP,
                              coap_packet_t * receivedMessage)
 {
@@ -164,13 +262,8 @@ lwm2m_transaction_t * transaction_new(void * sessionH,
     // no transactions without peer
     if (NULL == sessionH) return NULL;
 
-    transacP = (lwm2m_transaction_t *)lwm2m_malloc(sizeof(lwm2m_transaction_t));
-
+    transacP = prv_allocate();
     if (NULL == transacP) return NULL;
-    memset(transacP, 0, sizeof(lwm2m_transaction_t));
-
-    transacP->message = lwm2m_malloc(sizeof(coap_packet_t));
-    if (NULL == transacP->message) goto error;
 
     coap_init_message(transacP->message, COAP_TYPE_CON, method, mID);
 
@@ -244,22 +337,20 @@ lwm2m_transaction_t * transaction_new(void * sessionH,
 
 error:
     LOG("Exiting on failure");
-    if(transacP->message)
-    {
-        coap_free_header(transacP->message);
-        lwm2m_free(transacP->message);
-    }
-    lwm2m_free(transacP);
+    transaction_free(transacP);
     return NULL;
 }
 
 void transaction_free(lwm2m_transaction_t * transacP)
 {
+    transaction_slot_t * slotP;
+
     LOG_ARG("Entering. transaction=%p", transacP);
+    slotP = prv_findSlot(transacP);
     if (transacP->message)
     {
        coap_free_header(transacP->message);
-       lwm2m_free(transacP->message);
+       if (slotP == NULL) lwm2m_free(transacP->message);
        transacP->message = NULL;
     }
 
@@ -269,11 +360,18 @@ void transaction_free(lwm2m_transaction_t * transacP)
     }
 
     if (transacP->buffer) {
-        lwm2m_free(transacP->buffer);
+        if (slotP == NULL || transacP->buffer != slotP->buffer) lwm2m_free(transacP->buffer);
         transacP->buffer = NULL;
     }
 
-    lwm2m_free(transacP);
+    if (slotP != NULL)
+    {
+        slotP->used = false;
+    }
+    else
+    {
+        lwm2m_free(transacP);
+    }
 }
 
 void transaction_remove(lwm2m_context_t * contextP,
@@ -281,6 +379,7 @@ void transaction_remove(lwm2m_context_t * contextP,
 {
     LOG_ARG("Entering. transaction=%p", transacP);
     contextP->transactionList = (lwm2m_transaction_t *) LWM2M_LIST_RM(contextP->transactionList, transacP->mID, NULL);
+    prv_timerRemove(contextP, transacP);
     transaction_free(transacP);
 }
 
@@ -330,6 +429,8 @@ bool transaction_handleResponse(lwm2m_context_t * contextP,
                     {
                         transacP->ack_received = false;
                         transacP->retrans_time += COAP_RESPONSE_TIMEOUT;
+                        prv_timerRemove(contextP, transacP);
+                        prv_timerInsert(contextP, transacP);
                         return true;
                     }
                 }
@@ -356,6 +457,8 @@ bool transaction_handleResponse(lwm2m_context_t * contextP,
                 {
                     transacP->retrans_time += COAP_RESPONSE_TIMEOUT * transacP->retrans_counter;
                 }
+                prv_timerRemove(contextP, transacP);
+                prv_timerInsert(contextP, transacP);
                 return true;
             }
         }
@@ -373,6 +476,8 @@ int transaction_send(lwm2m_context_t * contextP,
     LOG_ARG("Entering: transaction=%p", transacP);
     if (transacP->buffer == NULL)
     {
+        transaction_slot_t * slotP;
+
         transacP->buffer_len = coap_serialize_get_size(transacP->message);
         if (transacP->buffer_len == 0)
         {
@@ -380,7 +485,15 @@ int transaction_send(lwm2m_context_t * contextP,
            return COAP_500_INTERNAL_SERVER_ERROR;
         }
 
-        transacP->buffer = (uint8_t*)lwm2m_malloc(transacP->buffer_len);
+        slotP = prv_findSlot(transacP);
+        if (slotP != NULL && transacP->buffer_len <= sizeof(slotP->buffer))
+        {
+            transacP->buffer = slotP->buffer;
+        }
+        else
+        {
+            transacP->buffer = (uint8_t*)lwm2m_malloc(transacP->buffer_len);
+        }
         if (transacP->buffer == NULL)
         {
            transaction_remove(contextP, transacP);
@@ -390,8 +503,6 @@ int transaction_send(lwm2m_context_t * contextP,
         transacP->buffer_len = coap_serialize_message(transacP->message, transacP->buffer);
         if (transacP->buffer_len == 0)
         {
-            lwm2m_free(transacP->buffer);
-            transacP->buffer = NULL;
             transaction_remove(contextP, transacP);
             return COAP_500_INTERNAL_SERVER_ERROR;
         }
@@ -422,6 +533,9 @@ int transaction_send(lwm2m_context_t * contextP,
         if (COAP_MAX_RETRANSMIT + 1 >= transacP->retrans_counter)
         {
             (void)lwm2m_buffer_send(transacP->peerH, transacP->buffer, transacP->buffer_len, contextP->userData);
+#ifdef LWM2M_CLIENT_QUEUE_MODE
+            queue_mode_exchange(contextP);
+#endif
 
             transacP->retrans_time += timeout;
             transacP->retrans_counter += 1;
@@ -440,6 +554,7 @@ int transaction_send(lwm2m_context_t * contextP,
         goto error;
     }
 
+    prv_timerInsert(contextP, transacP);
     return 0;
 error:
     if (transacP->callback)
@@ -455,45 +570,51 @@ void transaction_step(lwm2m_context_t * contextP,
                       time_t currentTime,
                       time_t * timeoutP)
 {
-    lwm2m_transaction_t * transacP;
+    lwm2m_transaction_t * dueP = NULL;
+    lwm2m_transaction_t ** lastP = &dueP;
 
     LOG("Entering");
-    transacP = contextP->transactionList;
-    while (transacP != NULL)
+    // detach the due transactions first, the ones sent again are queued back
+    // and must wait for the next step
+    while (contextP->transactionTimers != NULL
+        && contextP->transactionTimers->retrans_time <= currentTime)
+    {
+        *lastP = contextP->transactionTimers;
+        lastP = &(*lastP)->timerNext;
+        contextP->transactionTimers = *lastP;
+    }
+    *lastP = NULL;
+
+    while (dueP != NULL)
     {
         // transaction_send() may remove transaction from the linked list
-        lwm2m_transaction_t * nextP = transacP->next;
-        int removed = 0;
+        lwm2m_transaction_t * nextP = dueP->timerNext;
 
-        if (transacP->retrans_time <= currentTime)
+        dueP->timerNext = NULL;
+        if (0 != transaction_send(contextP, dueP))
         {
-            removed = transaction_send(contextP, transacP);
+            *timeoutP = 1;
         }
+        dueP = nextP;
+    }
 
-        if (0 == removed)
-        {
-            time_t interval;
-
-            if (transacP->retrans_time > currentTime)
-            {
-                interval = transacP->retrans_time - currentTime;
-            }
-            else
-            {
-                interval = 1;
-            }
+    if (contextP->transactionTimers != NULL)
+    {
+        time_t interval;
 
-            if (*timeoutP > interval)
-            {
-                *timeoutP = interval;
-            }
+        if (contextP->transactionTimers->retrans_time > currentTime)
+        {
+            interval = contextP->transactionTimers->retrans_time - currentTime;
         }
         else
         {
-            *timeoutP = 1;
+            interval = 1;
         }
 
-        transacP = nextP;
+        if (*timeoutP > interval)
+        {
+            *timeoutP = interval;
+        }
     }
 }
 
@@ -513,7 +634,33 @@ bool transaction_set_payload(lwm2m_transaction_t *transaction, uint8_t *buffer,
         coap_set_header_block1(transaction->message, 0, true, lwm2m_coap_block_size);
     }
 
-    coap_set_payload(transaction->message, buffer, MIN(length, lwm2m_coap_block_size));
+    coap_set_payload(transaction->message, transaction_payload, MIN(length, lwm2m_coap_block_size));
+    return true;
+}
+
+bool transaction_set_payload_source(lwm2m_transaction_t *transaction, lwm2m_payload_source_t source, void *sourceData,
+                                    size_t length) {
+    // only the first block is held, the following ones are generated when the server asks for them
+    const uint16_t lwm2m_coap_block_size = lwm2m_get_coap_block_size();
+    const size_t block_length = MIN(length, lwm2m_coap_block_size);
+    uint8_t *transaction_payload = (uint8_t *)lwm2m_malloc(block_length);
+    if (transaction_payload == NULL) {
+        return false;
+    }
+    if (source(sourceData, 0, transaction_payload, block_length) != block_length) {
+        lwm2m_free(transaction_payload);
+        return false;
+    }
+
+    transaction->payload = transaction_payload;
+    transaction->payload_len = length;
+    transaction->payloadSource = source;
+    transaction->payloadSourceData = sourceData;
+    if (length > lwm2m_coap_block_size) {
+        coap_set_header_block1(transaction->message, 0, true, lwm2m_coap_block_size);
+    }
+
+    coap_set_payload(transaction->message, transaction_payload, block_length);
     return true;
 }
 
@@ -18,17 +18,6 @@
 
 #include "internals.h"
 
-#define PRV_LINK_BUFFER_SIZE  1024
-
-
-#define PRV_CONCAT_STR(buf, len, index, str, str_len)    \
-    {                                                    \
-        if ((len)-(index) < (str_len)) return -1;        \
-        memcpy((buf)+(index), (str), (str_len));         \
-        (index) += (str_len);                            \
-    }
-
-
 #ifdef LWM2M_CLIENT_MODE
 
 static lwm2m_attributes_t * prv_findAttributes(lwm2m_context_t * contextP,
@@ -58,102 +47,67 @@ static lwm2m_attributes_t * prv_findAttributes(lwm2m_context_t * contextP,
     return paramP;
 }
 
+static int prv_writeAttribute(link_writer_t * writerP,
+                              const char * name,
+                              int64_t value)
+{
+    utils_linkWriteString(writerP, LINK_ATTR_SEPARATOR);
+    utils_linkWriteString(writerP, name);
+    return utils_linkWriteInt(writerP, value);
+}
+
+static int prv_writeFloatAttribute(link_writer_t * writerP,
+                                   const char * name,
+                                   double value)
+{
+    utils_linkWriteString(writerP, LINK_ATTR_SEPARATOR);
+    utils_linkWriteString(writerP, name);
+    return utils_linkWriteFloat(writerP, value);
+}
+
+// Write the attributes of an item between its closing '>' and its ','.
 static int prv_serializeAttributes(lwm2m_context_t * contextP,
                                    lwm2m_uri_t * uriP,
                                    lwm2m_server_t * serverP,
                                    lwm2m_attributes_t * objectParamP,
-                                   uint8_t * buffer,
-                                   size_t uriLen,
-                                   size_t bufferLen)
+                                   link_writer_t * writerP)
 {
-    int head;
-    int res;
     lwm2m_attributes_t * paramP;
 
-    head = 0;
-
     paramP = prv_findAttributes(contextP, uriP, serverP);
     if (paramP == NULL) paramP = objectParamP;
+    if (paramP == NULL) return 0;
 
-    if (paramP != NULL)
+    if (paramP->toSet & LWM2M_ATTR_FLAG_MIN_PERIOD)
     {
-        head = uriLen;
-
-        if (paramP->toSet & LWM2M_ATTR_FLAG_MIN_PERIOD)
-        {
-            PRV_CONCAT_STR(buffer, bufferLen, head, LINK_ATTR_SEPARATOR, LINK_ATTR_SEPARATOR_SIZE);
-            PRV_CONCAT_STR(buffer, bufferLen, head, ATTR_MIN_PERIOD_STR, ATTR_MIN_PERIOD_LEN);
-
-            res = utils_intToText(paramP->minPeriod, buffer + head, bufferLen - head);
-            if (res <= 0) return -1;
-            head += res;
-        }
-        else if (objectParamP != NULL)
-        {
-            if (objectParamP->toSet & LWM2M_ATTR_FLAG_MIN_PERIOD)
-            {
-                PRV_CONCAT_STR(buffer, bufferLen, head, LINK_ATTR_SEPARATOR, LINK_ATTR_SEPARATOR_SIZE);
-                PRV_CONCAT_STR(buffer, bufferLen, head, ATTR_MIN_PERIOD_STR, ATTR_MIN_PERIOD_LEN);
-
-                res = utils_intToText(objectParamP->minPeriod, buffer + head, bufferLen - head);
-                if (res <= 0) return -1;
-                head += res;
-            }
-        }
-        if (paramP->toSet & LWM2M_ATTR_FLAG_MAX_PERIOD)
-        {
-            PRV_CONCAT_STR(buffer, bufferLen, head, LINK_ATTR_SEPARATOR, LINK_ATTR_SEPARATOR_SIZE);
-            PRV_CONCAT_STR(buffer, bufferLen, head, ATTR_MAX_PERIOD_STR, ATTR_MAX_PERIOD_LEN);
-
-            res = utils_intToText(paramP->maxPeriod, buffer + head, bufferLen - head);
-            if (res <= 0) return -1;
-            head += res;
-        }
-        else if (objectParamP != NULL)
-        {
-            if (objectParamP->toSet & LWM2M_ATTR_FLAG_MAX_PERIOD)
-            {
-                PRV_CONCAT_STR(buffer, bufferLen, head, LINK_ATTR_SEPARATOR, LINK_ATTR_SEPARATOR_SIZE);
-                PRV_CONCAT_STR(buffer, bufferLen, head, ATTR_MAX_PERIOD_STR, ATTR_MAX_PERIOD_LEN);
-
-                res = utils_intToText(objectParamP->maxPeriod, buffer + head, bufferLen - head);
-                if (res <= 0) return -1;
-                head += res;
-            }
-        }
-        if (paramP->toSet & LWM2M_ATTR_FLAG_GREATER_THAN)
-        {
-            PRV_CONCAT_STR(buffer, bufferLen, head, LINK_ATTR_SEPARATOR, LINK_ATTR_SEPARATOR_SIZE);
-            PRV_CONCAT_STR(buffer, bufferLen, head, ATTR_GREATER_THAN_STR, ATTR_GREATER_THAN_LEN);
-
-            res = utils_floatToText(paramP->greaterThan, buffer + head, bufferLen - head, false);
-            if (res <= 0) return -1;
-            head += res;
-        }
-        if (paramP->toSet & LWM2M_ATTR_FLAG_LESS_THAN)
-        {
-            PRV_CONCAT_STR(buffer, bufferLen, head, LINK_ATTR_SEPARATOR, LINK_ATTR_SEPARATOR_SIZE);
-            PRV_CONCAT_STR(buffer, bufferLen, head, ATTR_LESS_THAN_STR, ATTR_LESS_THAN_LEN);
-
-            res = utils_floatToText(paramP->lessThan, buffer + head, bufferLen - head, false);
-            if (res <= 0) return -1;
-            head += res;
-        }
-        if (paramP->toSet & LWM2M_ATTR_FLAG_STEP)
-        {
-            PRV_CONCAT_STR(buffer, bufferLen, head, LINK_ATTR_SEPARATOR, LINK_ATTR_SEPARATOR_SIZE);
-            PRV_CONCAT_STR(buffer, bufferLen, head, ATTR_STEP_STR, ATTR_STEP_LEN);
-
-            res = utils_floatToText(paramP->step, buffer + head, bufferLen - head, false);
-            if (res <= 0) return -1;
-            head += res;
-        }
-        PRV_CONCAT_STR(buffer, bufferLen, head, LINK_ITEM_ATTR_END, LINK_ITEM_ATTR_END_SIZE);
+        if (prv_writeAttribute(writerP, ATTR_MIN_PERIOD_STR, paramP->minPeriod) < 0) return -1;
+    }
+    else if (objectParamP != NULL && (objectParamP->toSet & LWM2M_ATTR_FLAG_MIN_PERIOD))
+    {
+        if (prv_writeAttribute(writerP, ATTR_MIN_PERIOD_STR, objectParamP->minPeriod) < 0) return -1;
+    }
+    if (paramP->toSet & LWM2M_ATTR_FLAG_MAX_PERIOD)
+    {
+        if (prv_writeAttribute(writerP, ATTR_MAX_PERIOD_STR, paramP->maxPeriod) < 0) return -1;
+    }
+    else if (objectParamP != NULL && (objectParamP->toSet & LWM2M_ATTR_FLAG_MAX_PERIOD))
+    {
+        if (prv_writeAttribute(writerP, ATTR_MAX_PERIOD_STR, objectParamP->maxPeriod) < 0) return -1;
+    }
+    if (paramP->toSet & LWM2M_ATTR_FLAG_GREATER_THAN)
+    {
+        if (prv_writeFloatAttribute(writerP, ATTR_GREATER_THAN_STR, paramP->greaterThan) < 0) return -1;
+    }
+    if (paramP->toSet & LWM2M_ATTR_FLAG_LESS_THAN)
+    {
+        if (prv_writeFloatAttribute(writerP, ATTR_LESS_THAN_STR, paramP->lessThan) < 0) return -1;
+    }
+    if (paramP->toSet & LWM2M_ATTR_FLAG_STEP)
+    {
+        if (prv_writeFloatAttribute(writerP, ATTR_STEP_STR, paramP->step) < 0) return -1;
     }
 
-    if (head > 0) head -= uriLen + 1;
-
-    return head;
+    return 0;
 }
 
 static int prv_serializeLinkData(lwm2m_context_t * contextP,
@@ -163,15 +117,11 @@ static int prv_serializeLinkData(lwm2m_context_t * contextP,
                                  lwm2m_uri_t * parentUriP,
                                  uint8_t * parentUriStr,
                                  size_t parentUriLen,
-                                 uint8_t * buffer,
-                                 size_t bufferLen)
+                                 link_writer_t * writerP)
 {
-    int head;
     int res;
     lwm2m_uri_t uri;
 
-    head = 0;
-
     switch (tlvP->type)
     {
     case LWM2M_TYPE_UNDEFINED:
@@ -184,54 +134,28 @@ static int prv_serializeLinkData(lwm2m_context_t * contextP,
     case LWM2M_TYPE_OBJECT_LINK:
     case LWM2M_TYPE_CORE_LINK:
     case LWM2M_TYPE_MULTIPLE_RESOURCE:
-        if (bufferLen < LINK_ITEM_START_SIZE) return -1;
-        memcpy(buffer + head, LINK_ITEM_START, LINK_ITEM_START_SIZE);
-        head = LINK_ITEM_START_SIZE;
-
-        if (parentUriLen > 0)
-        {
-            if (bufferLen - head < parentUriLen) return -1;
-            memcpy(buffer + head, parentUriStr, parentUriLen);
-            head += parentUriLen;
-        }
-
-        if (bufferLen - head < LINK_URI_SEPARATOR_SIZE) return -1;
-        memcpy(buffer + head, LINK_URI_SEPARATOR, LINK_URI_SEPARATOR_SIZE);
-        head += LINK_URI_SEPARATOR_SIZE;
-
-        res = utils_intToText(tlvP->id, buffer + head, bufferLen - head);
-        if (res <= 0) return -1;
-        head += res;
+        utils_linkWriteString(writerP, LINK_ITEM_START);
+        utils_linkWrite(writerP, parentUriStr, parentUriLen);
+        utils_linkWriteString(writerP, LINK_URI_SEPARATOR);
+        if (utils_linkWriteInt(writerP, tlvP->id) < 0) return -1;
 
         if (tlvP->type == LWM2M_TYPE_MULTIPLE_RESOURCE)
         {
-            if (bufferLen - head < LINK_ITEM_DIM_START_SIZE) return -1;
-            memcpy(buffer + head, LINK_ITEM_DIM_START, LINK_ITEM_DIM_START_SIZE);
-            head += LINK_ITEM_DIM_START_SIZE;
-
-            res = utils_intToText(tlvP->value.asChildren.count, buffer + head, bufferLen - head);
-            if (res <= 0) return -1;
-            head += res;
-
-            if (bufferLen - head < LINK_ITEM_ATTR_END_SIZE) return -1;
-            memcpy(buffer + head, LINK_ITEM_ATTR_END, LINK_ITEM_ATTR_END_SIZE);
-            head += LINK_ITEM_ATTR_END_SIZE;
+            utils_linkWriteString(writerP, LINK_ITEM_DIM_START);
+            if (utils_linkWriteInt(writerP, tlvP->value.asChildren.count) < 0) return -1;
         }
         else
         {
-            if (bufferLen - head < LINK_ITEM_END_SIZE) return -1;
-            memcpy(buffer + head, LINK_ITEM_END, LINK_ITEM_END_SIZE);
-            head += LINK_ITEM_END_SIZE;
+            utils_linkWriteString(writerP, LINK_ITEM_URI_END);
         }
 
         if (serverP != NULL)
         {
             memcpy(&uri, parentUriP, sizeof(lwm2m_uri_t));
             uri.resourceId = tlvP->id;
-            res = prv_serializeAttributes(contextP, &uri, serverP, objectParamP, buffer, head - 1, bufferLen);
-            if (res < 0) return -1;    // careful, 0 is valid
-            if (res > 0) head += res;
+            if (prv_serializeAttributes(contextP, &uri, serverP, objectParamP, writerP) < 0) return -1;
         }
+        utils_linkWriteString(writerP, LINK_ITEM_ATTR_END);
         break;
 
     case LWM2M_TYPE_OBJECT_INSTANCE:
@@ -240,18 +164,9 @@ static int prv_serializeLinkData(lwm2m_context_t * contextP,
         size_t uriLen;
         size_t index;
 
-        if (parentUriLen > 0)
-        {
-            if (URI_MAX_STRING_LEN < parentUriLen) return -1;
-            memcpy(uriStr, parentUriStr, parentUriLen);
-            uriLen = parentUriLen;
-        }
-        else
-        {
-            uriLen = 0;
-        }
-
-        if (URI_MAX_STRING_LEN - uriLen < LINK_URI_SEPARATOR_SIZE) return -1;
+        if (URI_MAX_STRING_LEN < parentUriLen + LINK_URI_SEPARATOR_SIZE) return -1;
+        memcpy(uriStr, parentUriStr, parentUriLen);
+        uriLen = parentUriLen;
         memcpy(uriStr + uriLen, LINK_URI_SEPARATOR, LINK_URI_SEPARATOR_SIZE);
         uriLen += LINK_URI_SEPARATOR_SIZE;
 
@@ -262,22 +177,23 @@ static int prv_serializeLinkData(lwm2m_context_t * contextP,
         memcpy(&uri, parentUriP, sizeof(lwm2m_uri_t));
         uri.instanceId = tlvP->id;
 
-        head = 0;
-        PRV_CONCAT_STR(buffer, bufferLen, head, LINK_ITEM_START, LINK_ITEM_START_SIZE);
-        PRV_CONCAT_STR(buffer, bufferLen, head, uriStr, uriLen);
-        PRV_CONCAT_STR(buffer, bufferLen, head, LINK_ITEM_END, LINK_ITEM_END_SIZE);
-        if (serverP != NULL)
+        // When answering a server, the instance is only listed if it has
+        // attributes of its own.
+        if (serverP == NULL || prv_findAttributes(contextP, &uri, serverP) != NULL)
         {
-            res = prv_serializeAttributes(contextP, &uri, serverP, NULL, buffer, head - 1, bufferLen);
-            if (res < 0) return -1;    // careful, 0 is valid
-            if (res == 0) head = 0;    // rewind
-            else head += res;
+            utils_linkWriteString(writerP, LINK_ITEM_START);
+            utils_linkWrite(writerP, uriStr, uriLen);
+            utils_linkWriteString(writerP, LINK_ITEM_URI_END);
+            if (serverP != NULL)
+            {
+                if (prv_serializeAttributes(contextP, &uri, serverP, NULL, writerP) < 0) return -1;
+            }
+            utils_linkWriteString(writerP, LINK_ITEM_ATTR_END);
         }
         for (index = 0; index < tlvP->value.asChildren.count; index++)
         {
-            res = prv_serializeLinkData(contextP, tlvP->value.asChildren.array + index, serverP, objectParamP, &uri, uriStr, uriLen, buffer + head, bufferLen - head);
+            res = prv_serializeLinkData(contextP, tlvP->value.asChildren.array + index, serverP, objectParamP, &uri, uriStr, uriLen, writerP);
             if (res < 0) return -1;
-            head += res;
         }
     }
     break;
@@ -287,31 +203,28 @@ static int prv_serializeLinkData(lwm2m_context_t * contextP,
         return -1;
     }
 
-    return head;
+    return 0;
 }
 
-int discover_serialize(lwm2m_context_t * contextP,
-                       lwm2m_uri_t * uriP,
-                       lwm2m_server_t * serverP,
-                       int size,
-                       lwm2m_data_t * dataP,
-                       uint8_t ** bufferP)
+// Generate the whole payload through writerP. Every call produces the same
+// bytes as long as the data and the attributes do not change, which is what
+// lets a block be produced without the blocks before it.
+static int prv_serialize(lwm2m_context_t * contextP,
+                         lwm2m_uri_t * uriP,
+                         lwm2m_server_t * serverP,
+                         int size,
+                         lwm2m_data_t * dataP,
+                         link_writer_t * writerP)
 {
-    uint8_t bufferLink[PRV_LINK_BUFFER_SIZE];
     uint8_t baseUriStr[URI_MAX_STRING_LEN];
     int baseUriLen;
     int index;
-    size_t head;
     int res;
     lwm2m_uri_t parentUri;
     lwm2m_uri_t baseUri;
     lwm2m_attributes_t * paramP;
     lwm2m_attributes_t mergedParam;
 
-    LOG_ARG("size: %d", size);
-    LOG_URI(uriP);
-
-    head = 0;
     LWM2M_URI_RESET(&parentUri);
     parentUri.objectId = uriP->objectId;
 
@@ -379,67 +292,88 @@ int discover_serialize(lwm2m_context_t * contextP,
     {
         paramP = NULL;
 
+        utils_linkWriteString(writerP, LINK_ITEM_START);
+        utils_linkWriteString(writerP, LINK_URI_SEPARATOR);
+        if (utils_linkWriteInt(writerP, uriP->objectId) < 0) return -1;
         if (LWM2M_URI_IS_SET_INSTANCE(uriP))
         {
-            PRV_CONCAT_STR(bufferLink, PRV_LINK_BUFFER_SIZE, head, LINK_ITEM_START, LINK_ITEM_START_SIZE);
-            PRV_CONCAT_STR(bufferLink, PRV_LINK_BUFFER_SIZE, head, LINK_URI_SEPARATOR, LINK_URI_SEPARATOR_SIZE);
-            res = utils_intToText(uriP->objectId, bufferLink + head, PRV_LINK_BUFFER_SIZE - head);
-            if (res <= 0) return -1;
-            head += res;
-            PRV_CONCAT_STR(bufferLink, PRV_LINK_BUFFER_SIZE, head, LINK_URI_SEPARATOR, LINK_URI_SEPARATOR_SIZE);
-            res = utils_intToText(uriP->instanceId, bufferLink + head, PRV_LINK_BUFFER_SIZE - head);
-            if (res <= 0) return -1;
-            head += res;
-            PRV_CONCAT_STR(bufferLink, PRV_LINK_BUFFER_SIZE, head, LINK_ITEM_END, LINK_ITEM_END_SIZE);
+            utils_linkWriteString(writerP, LINK_URI_SEPARATOR);
+            if (utils_linkWriteInt(writerP, uriP->instanceId) < 0) return -1;
             parentUri.instanceId = uriP->instanceId;
-            if (serverP != NULL)
-            {
-                res = prv_serializeAttributes(contextP, &parentUri, serverP, NULL, bufferLink, head - 1, PRV_LINK_BUFFER_SIZE);
-                if (res < 0) return -1;    // careful, 0 is valid
-            }
-            else
-            {
-                res = 0;
-            }
-            head += res;
         }
-        else
+        utils_linkWriteString(writerP, LINK_ITEM_URI_END);
+        if (serverP != NULL)
         {
-            PRV_CONCAT_STR(bufferLink, PRV_LINK_BUFFER_SIZE, head, LINK_ITEM_START, LINK_ITEM_START_SIZE);
-            PRV_CONCAT_STR(bufferLink, PRV_LINK_BUFFER_SIZE, head, LINK_URI_SEPARATOR, LINK_URI_SEPARATOR_SIZE);
-            res = utils_intToText(uriP->objectId, bufferLink + head, PRV_LINK_BUFFER_SIZE - head);
-            if (res <= 0) return -1;
-            head += res;
-            PRV_CONCAT_STR(bufferLink, PRV_LINK_BUFFER_SIZE, head, LINK_ITEM_END, LINK_ITEM_END_SIZE);
-
-            if (serverP != NULL)
-            {
-                res = prv_serializeAttributes(contextP, &parentUri, serverP, NULL, bufferLink, head - 1, PRV_LINK_BUFFER_SIZE);
-                if (res < 0) return -1;    // careful, 0 is valid
-                head += res;
-            }
+            if (prv_serializeAttributes(contextP, &parentUri, serverP, NULL, writerP) < 0) return -1;
         }
+        utils_linkWriteString(writerP, LINK_ITEM_ATTR_END);
     }
 
     baseUriLen = uri_toString(uriP, baseUriStr, URI_MAX_STRING_LEN, NULL);
     if (baseUriLen < 0) return -1;
 
-    for (index = 0; index < size && head < PRV_LINK_BUFFER_SIZE; index++)
+    for (index = 0; index < size; index++)
     {
-        res = prv_serializeLinkData(contextP, dataP + index, serverP, paramP, uriP, baseUriStr, baseUriLen, bufferLink + head, PRV_LINK_BUFFER_SIZE - head);
+        res = prv_serializeLinkData(contextP, dataP + index, serverP, paramP, uriP, baseUriStr, baseUriLen, writerP);
         if (res < 0) return -1;
-        head += res;
     }
 
-    if (head > 0)
-    {
-        head -= 1;
+    return 0;
+}
+
+int discover_serialize(lwm2m_context_t * contextP,
+                       lwm2m_uri_t * uriP,
+                       lwm2m_server_t * serverP,
+                       int size,
+                       lwm2m_data_t * dataP,
+                       uint8_t ** bufferP)
+{
+    link_writer_t writer;
+    size_t length;
 
-        *bufferP = (uint8_t *)lwm2m_malloc(head);
-        if (*bufferP == NULL) return 0;
-        memcpy(*bufferP, bufferLink, head);
+    LOG_ARG("size: %d", size);
+    LOG_URI(uriP);
+
+    // measure first so that exactly the payload gets allocated
+    utils_linkWriterInit(&writer, NULL, 0, 0);
+    if (prv_serialize(contextP, uriP, serverP, size, dataP, &writer) < 0) return -1;
+    length = utils_linkWriterTotal(&writer);
+    if (length == 0) return 0;
+
+    *bufferP = (uint8_t *)lwm2m_malloc(length);
+    if (*bufferP == NULL) return 0;
+
+    utils_linkWriterInit(&writer, *bufferP, 0, length);
+    if (prv_serialize(contextP, uriP, serverP, size, dataP, &writer) < 0
+     || utils_linkWriterTotal(&writer) != length)
+    {
+        lwm2m_free(*bufferP);
+        *bufferP = NULL;
+        return -1;
     }
 
-    return (int)head;
+    return (int)length;
+}
+
+int discover_serializeBlock(lwm2m_context_t * contextP,
+                            lwm2m_uri_t * uriP,
+                            lwm2m_server_t * serverP,
+                            int size,
+                            lwm2m_data_t * dataP,
+                            size_t offset,
+                            uint8_t * buffer,
+                            size_t length,
+                            size_t * totalP)
+{
+    link_writer_t writer;
+
+    LOG_ARG("size: %d, offset: %d", size, (int)offset);
+    LOG_URI(uriP);
+
+    utils_linkWriterInit(&writer, buffer, offset, length);
+    if (prv_serialize(contextP, uriP, serverP, size, dataP, &writer) < 0) return -1;
+    *totalP = utils_linkWriterTotal(&writer);
+
+    return (int)utils_linkWriterWindow(&writer);
 }
 #endif
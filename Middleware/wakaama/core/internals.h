@@ -241,6 +241,8 @@
 #define LINK_ITEM_START_SIZE        1
 #define LINK_ITEM_END               ">,"
 #define LINK_ITEM_END_SIZE          2
+#define LINK_ITEM_URI_END           ">"
+#define LINK_ITEM_URI_END_SIZE      1
 #define LINK_ITEM_DIM_START         ">;dim="
 #define LINK_ITEM_DIM_START_SIZE    6
 #define LINK_ITEM_ATTR_END          ","
@@ -279,6 +281,19 @@ typedef enum
     URI_DEPTH_RESOURCE_INSTANCE
 } uri_depth_t;
 
+// Cursor over a link-format payload generated on the fly. Only the bytes in
+// [offset, offset + length) are stored in buffer, everything is counted in
+// head and hashed in digest so that the payload can be measured, compared and
+// cut into blocks without ever being held entirely in memory.
+typedef struct
+{
+    uint8_t * buffer;   // NULL to only measure the payload
+    size_t    offset;
+    size_t    length;
+    size_t    head;
+    uint32_t  digest;   // FNV-1a of all the bytes written
+} link_writer_t;
+
 #ifdef LWM2M_BOOTSTRAP_SERVER_MODE
 typedef struct
 {
@@ -314,11 +329,10 @@ uint8_t object_raw_block1_create(lwm2m_context_t * contextP, lwm2m_uri_t * uriP,
 uint8_t object_raw_block1_execute(lwm2m_context_t * contextP, lwm2m_uri_t * uriP, uint8_t * buffer, size_t length, uint32_t block_num, uint8_t block_more);
 #endif
 uint8_t object_delete(lwm2m_context_t * contextP, lwm2m_uri_t * uriP);
-uint8_t object_discover(lwm2m_context_t * contextP, lwm2m_uri_t * uriP, lwm2m_server_t * serverP, uint8_t ** bufferP, size_t * lengthP);
+uint8_t object_discover(lwm2m_context_t * contextP, lwm2m_uri_t * uriP, lwm2m_server_t * serverP, size_t offset, size_t blockSize, uint8_t ** bufferP, size_t * lengthP, size_t * totalP);
 uint8_t object_checkReadable(lwm2m_context_t * contextP, lwm2m_uri_t * uriP, lwm2m_attributes_t * attrP);
 bool object_isInstanceNew(lwm2m_context_t * contextP, uint16_t objectId, uint16_t instanceId);
-int object_getRegisterPayloadBufferLength(lwm2m_context_t * contextP);
-int object_getRegisterPayload(lwm2m_context_t * contextP, uint8_t * buffer, size_t length);
+int object_writeRegisterPayload(lwm2m_context_t * contextP, link_writer_t * writerP);
 int object_getServers(lwm2m_context_t * contextP, bool checkOnly);
 uint8_t object_createInstance(lwm2m_context_t * contextP, lwm2m_uri_t * uriP, lwm2m_data_t * dataP);
 uint8_t object_writeInstance(lwm2m_context_t * contextP, lwm2m_uri_t * uriP, lwm2m_data_t * dataP);
@@ -332,6 +346,7 @@ bool transaction_handleResponse(lwm2m_context_t * contextP, void * fromSessionH,
 void transaction_step(lwm2m_context_t * contextP, time_t currentTime, time_t * timeoutP);
 bool transaction_free_userData(lwm2m_context_t * context, lwm2m_transaction_t * transaction);
 bool transaction_set_payload(lwm2m_transaction_t *transaction, uint8_t *buffer, size_t length);
+bool transaction_set_payload_source(lwm2m_transaction_t *transaction, lwm2m_payload_source_t source, void *sourceData, size_t length);
 
 // defined in management.c
 uint8_t dm_handleRequest(lwm2m_context_t * contextP, lwm2m_uri_t * uriP, lwm2m_server_t * serverP, coap_packet_t * message, coap_packet_t * response);
@@ -353,9 +368,27 @@ void registration_freeClient(lwm2m_client_t * clientP);
 uint8_t registration_start(lwm2m_context_t * contextP, bool restartFailed);
 void registration_step(lwm2m_context_t * contextP, time_t currentTime, time_t * timeoutP);
 lwm2m_status_t registration_getStatus(lwm2m_context_t * contextP);
+void registration_resetPayload(lwm2m_context_t * contextP);
 
 // defined in packet.c
 uint8_t message_send(lwm2m_context_t * contextP, coap_packet_t * message, void * sessionH);
+#if LWM2M_COAP_DEDUP_CACHE_SIZE > 0
+void packet_dedupStore(void * sessionH, coap_packet_t * message, uint8_t * buffer, size_t length, time_t now);
+bool packet_dedupReplay(lwm2m_context_t * contextP, void * sessionH, coap_packet_t * message, time_t now);
+#endif
+
+// defined in liblwm2m.c
+int send_data(lwm2m_context_t * contextP, void * sessionH, lwm2m_uri_t * uriP, lwm2m_media_type_t format, uint8_t * buffer, size_t length);
+
+// defined in queue_mode.c
+#ifdef LWM2M_CLIENT_QUEUE_MODE
+void queue_mode_exchange(lwm2m_context_t * contextP);
+bool queue_mode_isSleeping(lwm2m_context_t * contextP);
+uint8_t queue_mode_keepNotification(lwm2m_context_t * contextP, coap_packet_t * message, void * sessionH);
+uint8_t queue_mode_keepSend(lwm2m_context_t * contextP, void * sessionH, lwm2m_uri_t * uriP, lwm2m_media_type_t format, uint8_t * buffer, size_t length);
+void queue_mode_step(lwm2m_context_t * contextP, time_t currentTime, time_t * timeoutP);
+void queue_mode_clear(lwm2m_context_t * contextP);
+#endif
 
 // defined in bootstrap.c
 void bootstrap_step(lwm2m_context_t * contextP, time_t currentTime, time_t* timeoutP);
@@ -366,6 +399,12 @@ uint8_t bootstrap_handleRequest(lwm2m_context_t * contextP, lwm2m_uri_t * uriP,
 void bootstrap_start(lwm2m_context_t * contextP);
 lwm2m_status_t bootstrap_getStatus(lwm2m_context_t * contextP);
 
+// defined in data.c
+void data_arenaBegin(void);
+void data_arenaEnd(void);
+void * data_allocate(size_t size);
+void data_release(void * memP);
+
 #ifdef LWM2M_SUPPORT_TLV
 // defined in tlv.c
 int tlv_parse(const uint8_t * buffer, size_t bufferLen, lwm2m_data_t ** dataP);
@@ -403,6 +442,7 @@ int json_findAndCheckData(const lwm2m_uri_t * uriP, uri_depth_t baseLevel, size_
 
 // defined in discover.c
 int discover_serialize(lwm2m_context_t * contextP, lwm2m_uri_t * uriP, lwm2m_server_t * serverP, int size, lwm2m_data_t * dataP, uint8_t ** bufferP);
+int discover_serializeBlock(lwm2m_context_t * contextP, lwm2m_uri_t * uriP, lwm2m_server_t * serverP, int size, lwm2m_data_t * dataP, size_t offset, uint8_t * buffer, size_t length, size_t * totalP);
 
 // defined in block.c
 #ifdef LWM2M_RAW_BLOCK1_REQUESTS
@@ -432,6 +472,13 @@ int utils_stringCopy(char * buffer, size_t length, const char * str);
 size_t utils_intToText(int64_t data, uint8_t * string, size_t length);
 size_t utils_uintToText(uint64_t data, uint8_t * string, size_t length);
 size_t utils_floatToText(double data, uint8_t * string, size_t length, bool allowExponential);
+void utils_linkWriterInit(link_writer_t * writerP, uint8_t * buffer, size_t offset, size_t length);
+void utils_linkWrite(link_writer_t * writerP, const uint8_t * data, size_t length);
+void utils_linkWriteString(link_writer_t * writerP, const char * str);
+int utils_linkWriteInt(link_writer_t * writerP, int64_t value);
+int utils_linkWriteFloat(link_writer_t * writerP, double value);
+size_t utils_linkWriterTotal(const link_writer_t * writerP);
+size_t utils_linkWriterWindow(const link_writer_t * writerP);
 size_t utils_objLinkToText(uint16_t objectId,
                            uint16_t objectInstanceId,
                            uint8_t * string,
@@ -107,6 +107,11 @@
                 lwm2m_free( serverP->location );
             }
 
+            if( NULL != serverP->query )
+            {
+                lwm2m_free( serverP->query );
+            }
+
             while( serverP->blockData != NULL )
             {
                 lwm2m_block_data_t * targetP;
@@ -188,6 +193,8 @@
             context->transactionList = context->transactionList->next;
             transaction_free( transaction );
         }
+
+        context->transactionTimers = NULL;
     }
 
     void lwm2m_close( lwm2m_context_t * contextP )
@@ -198,6 +205,9 @@
             prv_deleteServerList( contextP );
             prv_deleteBootstrapServerList( contextP );
             prv_deleteObservedList( contextP );
+            #ifdef LWM2M_CLIENT_QUEUE_MODE
+                queue_mode_clear( contextP );
+            #endif
             lwm2m_free( contextP->endpointName );
 
             if( contextP->msisdn != NULL )
@@ -402,6 +412,7 @@
             objectP->next = NULL;
 
             contextP->objectList = ( lwm2m_object_t * ) LWM2M_LIST_ADD( contextP->objectList, objectP );
+            registration_resetPayload( contextP );
 
             if( contextP->state == STATE_READY )
             {
@@ -424,6 +435,8 @@
                 return COAP_404_NOT_FOUND;
             }
 
+            registration_resetPayload( contextP );
+
             if( contextP->state == STATE_READY )
             {
                 return lwm2m_update_registration( contextP, 0, true );
@@ -479,6 +492,8 @@ next_step:
                     #ifdef LWM2M_BOOTSTRAP
                         if( contextP->bootstrapServerList != NULL )
                         {
+                            /* The bootstrap server may rewrite any instance. */
+                            registration_resetPayload( contextP );
                             bootstrap_start( contextP );
                             contextP->state = STATE_BOOTSTRAPPING;
                             bootstrap_step( contextP, tv_sec, timeoutP );
@@ -583,10 +598,16 @@ next_step:
                     /* do nothing */
                     break;
             }
+            /* The values read for notifications only live during this step. */
+            data_arenaBegin();
             observe_step( contextP, tv_sec, timeoutP );
+            data_arenaEnd();
         #endif /* ifdef LWM2M_CLIENT_MODE */
 
         registration_step( contextP, tv_sec, timeoutP );
+        #ifdef LWM2M_CLIENT_QUEUE_MODE
+            queue_mode_step( contextP, tv_sec, timeoutP );
+        #endif
         transaction_step( contextP, tv_sec, timeoutP );
 
         LOG_ARG( "Final timeoutP: %d", ( int ) *timeoutP );
@@ -595,28 +616,29 @@ next_step:
         #endif
         return 0;
     }
-    int lwm2m_send( lwm2m_context_t * contextP,
-                    char * uri_buffer,
-                    size_t uri_buffer_len )
+
+/* Post buffer to the Send path of the server. The payload is serialized when */
+/* the transaction is first sent, the caller keeps the buffer. */
+    int send_data( lwm2m_context_t * contextP,
+                   void * sessionH,
+                   lwm2m_uri_t * uriP,
+                   lwm2m_media_type_t format,
+                   uint8_t * buffer,
+                   size_t length )
     {
         int result;
-        lwm2m_data_t * dataP = NULL;
-        int size = 0;
-        int res;
         lwm2m_transaction_t * transactionP;
-        uint8_t * data_buffer = NULL;
-        size_t data_buffer_length = 0;
-        lwm2m_media_type_t format = LWM2M_CONTENT_SENML_JSON;
-        lwm2m_uri_t uri;
 
-        lwm2m_stringToUri( uri_buffer, uri_buffer_len, &uri );
-        result = object_read( contextP, &uri, NULL, 0, &format, &data_buffer, &data_buffer_length );
-        /*result = lwm2m_data_serialize(&uri, size, dataP, &format, &data_buffer); */
-        IotLogInfo( "************** U P D A T I N G  ************** \r\n" );
-        transactionP = transaction_new( contextP->serverList->sessionH, COAP_POST, NULL, &uri, contextP->nextMID++, 0, NULL );
+        transactionP = transaction_new( sessionH, COAP_POST, NULL, uriP, contextP->nextMID++, 0, NULL );
+
+        if( transactionP == NULL )
+        {
+            return COAP_500_INTERNAL_SERVER_ERROR;
+        }
+
         coap_set_header_uri_path( transactionP->message, "/"URI_SEND_SEGMENT );
         coap_set_header_content_type( transactionP->message, format );
-        coap_set_payload( transactionP->message, data_buffer, data_buffer_length );
+        coap_set_payload( transactionP->message, buffer, length );
 
         contextP->transactionList = ( lwm2m_transaction_t * ) LWM2M_LIST_ADD( contextP->transactionList, transactionP );
         /* Sending the device and connectivity monitoring objects to the LwM2M server */
@@ -633,4 +655,42 @@ next_step:
 
         return result;
     }
+
+    int lwm2m_send( lwm2m_context_t * contextP,
+                    char * uri_buffer,
+                    size_t uri_buffer_len )
+    {
+        int result;
+        uint8_t * data_buffer = NULL;
+        size_t data_buffer_length = 0;
+        lwm2m_media_type_t format = LWM2M_CONTENT_SENML_JSON;
+        lwm2m_uri_t uri;
+
+        lwm2m_stringToUri( uri_buffer, uri_buffer_len, &uri );
+        data_arenaBegin();
+        result = object_read( contextP, &uri, NULL, 0, &format, &data_buffer, &data_buffer_length );
+        data_arenaEnd();
+
+        if( result != COAP_205_CONTENT )
+        {
+            IotLogError( "Send Failed!" );
+            return result;
+        }
+
+        IotLogInfo( "************** U P D A T I N G  ************** \r\n" );
+
+        #ifdef LWM2M_CLIENT_QUEUE_MODE
+            if( queue_mode_isSleeping( contextP ) )
+            {
+                /* Keeps the payload as read now and takes the buffer. */
+                return queue_mode_keepSend( contextP, contextP->serverList->sessionH, &uri, format,
+                                            data_buffer, data_buffer_length );
+            }
+        #endif
+
+        result = send_data( contextP, contextP->serverList->sessionH, &uri, format, data_buffer, data_buffer_length );
+        lwm2m_free( data_buffer );
+
+        return result;
+    }
 #endif /* if defined( CONFIG_LwM2M_DEMO_ENABLED ) */
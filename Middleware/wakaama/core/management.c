@@ -254,8 +254,26 @@ uint8_t dm_handleRequest(lwm2m_context_t * contextP,
                   && message->accept_num == 1
                   && message->accept[0] == APPLICATION_LINK_FORMAT)
             {
+                uint32_t block_num = 0;
+                uint16_t block_size = lwm2m_get_coap_block_size();
+                uint32_t block_offset = 0;
+                size_t total = 0;
+
                 format = LWM2M_CONTENT_LINK;
-                result = object_discover(contextP, uriP, serverP, &buffer, &length);
+                if (IS_OPTION(message, COAP_OPTION_BLOCK2))
+                {
+                    coap_get_header_block2(message, &block_num, NULL, &block_size, &block_offset);
+                    block_size = MIN(block_size, lwm2m_get_coap_block_size());
+                }
+
+                // only the requested block is generated, lwm2m_handle_packet
+                // sends it as it is
+                result = object_discover(contextP, uriP, serverP, block_offset, block_size, &buffer, &length, &total);
+                if (COAP_205_CONTENT == result
+                 && (IS_OPTION(message, COAP_OPTION_BLOCK2) || total > block_size))
+                {
+                    coap_set_header_block2(response, block_num, total - block_offset > length, block_size);
+                }
             }
             else
             {
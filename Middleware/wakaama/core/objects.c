@@ -356,6 +356,12 @@ static void prv_updateServerInfo(lwm2m_context_t * contextP, lwm2m_object_t *ser
     }
     if(serverP)
     {
+        // the registration query depends on the lifetime and the binding
+        if (serverP->query != NULL)
+        {
+            lwm2m_free(serverP->query);
+            serverP->query = NULL;
+        }
         prv_getMandatoryInfo(contextP, serverObjectP, instanceId, serverP);
     }
 }
@@ -656,11 +662,16 @@ uint8_t object_delete(lwm2m_context_t * contextP,
     return result;
 }
 
+// Only the block of blockSize bytes at offset is generated, *totalP receives
+// the length of the whole payload.
 uint8_t object_discover(lwm2m_context_t * contextP,
                         lwm2m_uri_t * uriP,
                         lwm2m_server_t * serverP,
+                        size_t offset,
+                        size_t blockSize,
                         uint8_t ** bufferP,
-                        size_t * lengthP)
+                        size_t * lengthP,
+                        size_t * totalP)
 {
     uint8_t result;
     lwm2m_object_t * targetP;
@@ -724,9 +735,24 @@ uint8_t object_discover(lwm2m_context_t * contextP,
     {
         int len;
 
-        len = discover_serialize(contextP, uriP, serverP, size, dataP, bufferP);
-        if (len <= 0) result = COAP_500_INTERNAL_SERVER_ERROR;
-        else *lengthP = len;
+        *bufferP = (uint8_t *)lwm2m_malloc(blockSize);
+        if (*bufferP == NULL)
+        {
+            result = COAP_500_INTERNAL_SERVER_ERROR;
+        }
+        else
+        {
+            len = discover_serializeBlock(contextP, uriP, serverP, size, dataP, offset, *bufferP, blockSize, totalP);
+            if (len < 0 || *totalP == 0) result = COAP_500_INTERNAL_SERVER_ERROR;
+            else if (len == 0) result = COAP_402_BAD_OPTION;
+            else *lengthP = len;
+
+            if (result != COAP_205_CONTENT)
+            {
+                lwm2m_free(*bufferP);
+                *bufferP = NULL;
+            }
+        }
     }
     lwm2m_data_free(size, dataP);
 
@@ -754,241 +780,67 @@ bool object_isInstanceNew(lwm2m_context_t * contextP,
     return true;
 }
 
-static int prv_getObjectTemplate(uint8_t * buffer,
-                                 size_t length,
-                                 uint16_t id)
+static int prv_writeObjectPath(link_writer_t * writerP,
+                               uint16_t id)
 {
-    int index;
-    int result;
-
-    if (length < REG_OBJECT_MIN_LEN) return -1;
-
-    buffer[0] = '<';
-    buffer[1] = '/';
-    index = 2;
-
-    result = utils_intToText(id, buffer + index, length - index);
-    if (result == 0) return -1;
-    index += result;
-
-    if (length - index < REG_OBJECT_MIN_LEN - 3) return -1;
-    buffer[index] = '/';
-    index++;
-
-    return index;
+    utils_linkWriteString(writerP, REG_START);
+    utils_linkWriteString(writerP, LINK_URI_SEPARATOR);
+    return utils_linkWriteInt(writerP, id);
 }
 
-int object_getRegisterPayloadBufferLength(lwm2m_context_t * contextP)
+// Generate the object list sent with registrations through writerP. Security
+// objects, and OSCORE ones from LwM2M 1.1 on, are never listed.
+int object_writeRegisterPayload(lwm2m_context_t * contextP,
+                                link_writer_t * writerP)
 {
-    size_t index;
-    int result;
     lwm2m_object_t * objectP;
-    uint8_t buffer[REG_OBJECT_MIN_LEN + 5];
+    lwm2m_list_t * instanceP;
 
     LOG("Entering");
-    index = strlen(REG_START);
-
+    utils_linkWriteString(writerP, REG_START);
     if ((contextP->altPath != NULL)
      && (contextP->altPath[0] != 0))
     {
-        index += strlen(contextP->altPath);
+        utils_linkWriteString(writerP, contextP->altPath);
     }
     else
     {
-        index += strlen(REG_DEFAULT_PATH);
+        utils_linkWriteString(writerP, REG_DEFAULT_PATH);
     }
-
-    index += strlen(REG_LWM2M_RESOURCE_TYPE);
+    utils_linkWriteString(writerP, REG_LWM2M_RESOURCE_TYPE);
 
     for (objectP = contextP->objectList; objectP != NULL; objectP = objectP->next)
     {
-        size_t start;
-        size_t length;
-
         if (objectP->objID == LWM2M_SECURITY_OBJECT_ID) continue;
 #ifndef LWM2M_VERSION_1_0
         if (objectP->objID == LWM2M_OSCORE_OBJECT_ID) continue;
 #endif
 
-        start = index;
-        result = prv_getObjectTemplate(buffer, sizeof(buffer), objectP->objID);
-        if (result < 0) return 0;
-        length = result;
-        index += length;
-
-        if (objectP->versionMajor != 0 || objectP->versionMinor != 0)
-        {
-            index -= 1;
-            index += strlen(REG_VERSION_START);
-
-            result = utils_uintToText(objectP->versionMajor, buffer, sizeof(buffer));
-            if (result < 0) return 0;
-            index += result;
-
-            index += 1;
-
-            result = utils_uintToText(objectP->versionMinor, buffer, sizeof(buffer));
-            if (result < 0) return 0;
-            index += result;
-
-            index += 1;
-
-            if(objectP->instanceList != NULL)
-            {
-                start = index;
-                index += length;
-            }
-        }
-        else if(objectP->instanceList == NULL)
-        {
-            index -= 1;
-            index += strlen(REG_PATH_END);
-        }
-
-        if (objectP->instanceList != NULL)
-        {
-            lwm2m_list_t * targetP;
-            for (targetP = objectP->instanceList ; targetP != NULL ; targetP = targetP->next)
-            {
-                if (index != start + length)
-                {
-                    index += length;
-                }
-
-                result = utils_intToText(targetP->id, buffer, sizeof(buffer));
-                if (result == 0) return 0;
-                index += result;
-
-                index += strlen(REG_PATH_END);
-            }
-        }
-    }
-
-    index += 1;  // account for trailing null
-
-    // Note that object_getRegisterPayload() has REG_PATH_END added after each
-    // object or instance, and then the trailing comma is replaced by null. The
-    // trailing nulls are not counted as part of the payload length, so this
-    // will return a size two bytes greater than what
-    // object_getRegisterPayload() returns.
-
-    return index;
-}
-
-int object_getRegisterPayload(lwm2m_context_t * contextP,
-                           uint8_t * buffer,
-                           size_t bufferLen)
-{
-    size_t index;
-    int result;
-    lwm2m_object_t * objectP;
-
-    LOG("Entering");
-    // index can not be greater than bufferLen
-    index = 0;
-
-    result = utils_stringCopy((char *)buffer, bufferLen, REG_START);
-    if (result < 0) return 0;
-    index += result;
-
-    if ((contextP->altPath != NULL)
-     && (contextP->altPath[0] != 0))
-    {
-        result = utils_stringCopy((char *)buffer + index, bufferLen - index, contextP->altPath);
-    }
-    else
-    {
-        result = utils_stringCopy((char *)buffer + index, bufferLen - index, REG_DEFAULT_PATH);
-    }
-    if (result < 0) return 0;
-    index += result;
-
-    result = utils_stringCopy((char *)buffer + index, bufferLen - index, REG_LWM2M_RESOURCE_TYPE);
-    if (result < 0) return 0;
-    index += result;
-
-    for (objectP = contextP->objectList; objectP != NULL; objectP = objectP->next)
-    {
-        size_t start;
-        size_t length;
-
-        if (objectP->objID == LWM2M_SECURITY_OBJECT_ID) continue;
-
-        start = index;
-        result = prv_getObjectTemplate(buffer + index, bufferLen - index, objectP->objID);
-        if (result < 0) return 0;
-        length = result;
-        index += length;
-
         if (objectP->versionMajor != 0 || objectP->versionMinor != 0)
         {
-            index--;
-            result = utils_stringCopy((char *)buffer + index, bufferLen - index, REG_VERSION_START);
-            if (result < 0) return 0;
-            index += result;
-
-            result = utils_uintToText(objectP->versionMajor, buffer + index, bufferLen - index);
-            if (result < 0) return 0;
-            index += result;
-
-            if( index >= bufferLen) return 0;
-            buffer[index++] = '.';
-
-            result = utils_uintToText(objectP->versionMinor, buffer + index, bufferLen - index);
-            if (result < 0) return 0;
-            index += result;
-
-            if( index >= bufferLen) return 0;
-            buffer[index++] = REG_DELIMITER;
-
-            if(objectP->instanceList != NULL)
-            {
-                start = index;
-                result = prv_getObjectTemplate(buffer + index, bufferLen - index, objectP->objID);
-                if (result < 0) return 0;
-                length = result;
-                index += length;
-            }
+            if (prv_writeObjectPath(writerP, objectP->objID) < 0) return -1;
+            utils_linkWriteString(writerP, REG_VERSION_START);
+            if (utils_linkWriteInt(writerP, objectP->versionMajor) < 0) return -1;
+            utils_linkWriteString(writerP, ".");
+            if (utils_linkWriteInt(writerP, objectP->versionMinor) < 0) return -1;
+            utils_linkWriteString(writerP, LINK_ITEM_ATTR_END);
         }
-        else if(objectP->instanceList == NULL)
+        else if (objectP->instanceList == NULL)
         {
-            index--;
-            result = utils_stringCopy((char *)buffer + index, bufferLen - index, REG_PATH_END);
-            if (result < 0) return 0;
-            index += result;
+            if (prv_writeObjectPath(writerP, objectP->objID) < 0) return -1;
+            utils_linkWriteString(writerP, REG_PATH_END);
         }
 
-        if (objectP->instanceList != NULL)
+        for (instanceP = objectP->instanceList; instanceP != NULL; instanceP = instanceP->next)
         {
-            lwm2m_list_t * targetP;
-            for (targetP = objectP->instanceList ; targetP != NULL ; targetP = targetP->next)
-            {
-                if (index != start + length)
-                {
-                    if (bufferLen - index <= length) return 0;
-                    memcpy(buffer + index, buffer + start, length);
-                    index += length;
-                }
-
-                result = utils_intToText(targetP->id, buffer + index, bufferLen - index);
-                if (result == 0) return 0;
-                index += result;
-
-                result = utils_stringCopy((char *)buffer + index, bufferLen - index, REG_PATH_END);
-                if (result < 0) return 0;
-                index += result;
-            }
+            if (prv_writeObjectPath(writerP, objectP->objID) < 0) return -1;
+            utils_linkWriteString(writerP, LINK_URI_SEPARATOR);
+            if (utils_linkWriteInt(writerP, instanceP->id) < 0) return -1;
+            utils_linkWriteString(writerP, REG_PATH_END);
         }
     }
 
-    if (index > 0)
-    {
-        index = index - 1;  // remove trailing ','
-    }
-
-    buffer[index] = 0;
-
-    return index;
+    return 0;
 }
 
 static lwm2m_list_t * prv_findServerInstance(lwm2m_context_t *contextP,
@@ -811,7 +811,16 @@ void observe_step(lwm2m_context_t * contextP,
                     message->mid = watcherP->lastMid;
                     coap_set_header_token(message, watcherP->token, watcherP->tokenLen);
                     coap_set_header_observe(message, watcherP->counter++);
-                    (void)message_send(contextP, message, watcherP->server->sessionH);
+#ifdef LWM2M_CLIENT_QUEUE_MODE
+                    if (queue_mode_isSleeping(contextP))
+                    {
+                        (void)queue_mode_keepNotification(contextP, message, watcherP->server->sessionH);
+                    }
+                    else
+#endif
+                    {
+                        (void)message_send(contextP, message, watcherP->server->sessionH);
+                    }
                     watcherP->update = false;
                 }
 
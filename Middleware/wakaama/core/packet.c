@@ -126,6 +126,109 @@ bool lwm2m_set_coap_block_size(const uint16_t coap_block_size_arg) {
 
 uint16_t lwm2m_get_coap_block_size() { return coap_block_size; }
 
+#if LWM2M_COAP_DEDUP_CACHE_SIZE > 0
+// Piggybacked responses sent in the last EXCHANGE_LIFETIME, replayed when the
+// server retransmits a CON request because our ACK got lost instead of
+// handling the request again. Each entry is followed by the serialized
+// response. Entries are stored in the order they were sent, so the oldest
+// ones, expired or evicted first, are always at the front.
+typedef struct
+{
+    void *   sessionH;
+    time_t   expiry;
+    uint16_t mid;
+    uint16_t length;
+    uint8_t  token_len;
+    uint8_t  token[COAP_TOKEN_LEN];
+} dedup_entry_t;
+
+static uint8_t prv_dedupCache[LWM2M_COAP_DEDUP_CACHE_SIZE];
+static size_t prv_dedupUsed;
+
+static void prv_dedupDrop(size_t length)
+{
+    memmove(prv_dedupCache, prv_dedupCache + length, prv_dedupUsed - length);
+    prv_dedupUsed -= length;
+}
+
+static void prv_dedupExpire(time_t now)
+{
+    dedup_entry_t entry;
+    size_t length = 0;
+
+    while (length < prv_dedupUsed)
+    {
+        memcpy(&entry, prv_dedupCache + length, sizeof(entry));
+        if (entry.expiry > now) break;
+        length += sizeof(entry) + entry.length;
+    }
+    if (length != 0) prv_dedupDrop(length);
+}
+
+void packet_dedupStore(void * sessionH,
+                       coap_packet_t * message,
+                       uint8_t * buffer,
+                       size_t length,
+                       time_t now)
+{
+    dedup_entry_t entry;
+
+    if (now < 0 || sizeof(entry) + length > sizeof(prv_dedupCache)) return;
+
+    prv_dedupExpire(now);
+    while (prv_dedupUsed + sizeof(entry) + length > sizeof(prv_dedupCache))
+    {
+        dedup_entry_t oldest;
+
+        memcpy(&oldest, prv_dedupCache, sizeof(oldest));
+        prv_dedupDrop(sizeof(oldest) + oldest.length);
+    }
+
+    memset(&entry, 0, sizeof(entry));
+    entry.sessionH = sessionH;
+    entry.expiry = now + (time_t)COAP_EXCHANGE_LIFETIME;
+    entry.mid = message->mid;
+    entry.length = (uint16_t)length;
+    entry.token_len = message->token_len;
+    memcpy(entry.token, message->token, message->token_len);
+
+    memcpy(prv_dedupCache + prv_dedupUsed, &entry, sizeof(entry));
+    memcpy(prv_dedupCache + prv_dedupUsed + sizeof(entry), buffer, length);
+    prv_dedupUsed += sizeof(entry) + length;
+}
+
+bool packet_dedupReplay(lwm2m_context_t * contextP,
+                        void * sessionH,
+                        coap_packet_t * message,
+                        time_t now)
+{
+    dedup_entry_t entry;
+    size_t offset;
+
+    if (now < 0) return false;
+
+    prv_dedupExpire(now);
+    for (offset = 0; offset < prv_dedupUsed; offset += sizeof(entry) + entry.length)
+    {
+        memcpy(&entry, prv_dedupCache + offset, sizeof(entry));
+        if (entry.mid == message->mid
+         && entry.token_len == message->token_len
+         && memcmp(entry.token, message->token, entry.token_len) == 0
+         && lwm2m_session_is_equal(entry.sessionH, sessionH, contextP->userData))
+        {
+            LOG_ARG("duplicate of request %u, replaying the response", message->mid);
+            (void)lwm2m_buffer_send(sessionH, prv_dedupCache + offset + sizeof(entry), entry.length, contextP->userData);
+#ifdef LWM2M_CLIENT_QUEUE_MODE
+            queue_mode_exchange(contextP);
+#endif
+            return true;
+        }
+    }
+
+    return false;
+}
+#endif
+
 static void handle_reset(lwm2m_context_t * contextP,
                          void * fromSessionH,
                          coap_packet_t * message)
@@ -327,13 +430,19 @@ static lwm2m_transaction_t * prv_create_next_block_transaction(lwm2m_transaction
         coap_set_header_if_none_match(clone->message);
     }
 
-    uint8_t *cloned_transaction_payload = (uint8_t *)lwm2m_malloc(transaction->payload_len);
-    if (cloned_transaction_payload == NULL) {
-        return NULL;
+    if (transaction->payloadSource != NULL) {
+        // the block to send is generated by prv_send_new_block1()
+        clone->payloadSource = transaction->payloadSource;
+        clone->payloadSourceData = transaction->payloadSourceData;
+    } else {
+        uint8_t *cloned_transaction_payload = (uint8_t *)lwm2m_malloc(transaction->payload_len);
+        if (cloned_transaction_payload == NULL) {
+            return NULL;
+        }
+        memcpy(cloned_transaction_payload, transaction->payload, transaction->payload_len);
+        clone->payload = cloned_transaction_payload;
     }
-    memcpy(cloned_transaction_payload, transaction->payload, transaction->payload_len);
 
-    clone->payload = cloned_transaction_payload;
     clone->payload_len = transaction->payload_len;
     clone->callback = transaction->callback;
     clone->userData = transaction->userData;
@@ -350,7 +459,22 @@ static int prv_send_new_block1(lwm2m_context_t * contextP, lwm2m_transaction_t *
     if (next == NULL) return COAP_500_INTERNAL_SERVER_ERROR;
 
     size_t remaining_payload_length = next->payload_len - block_num * (size_t)block_size;
-    uint8_t *new_block_start = next->payload + block_num * block_size;
+    uint8_t *new_block_start;
+
+    if (next->payloadSource != NULL) {
+        size_t block_length = MIN(block_size, remaining_payload_length);
+
+        next->payload = (uint8_t *)lwm2m_malloc(block_length);
+        if (next->payload == NULL ||
+            next->payloadSource(next->payloadSourceData, block_num * (size_t)block_size, next->payload, block_length) !=
+                block_length) {
+            transaction_free(next);
+            return COAP_500_INTERNAL_SERVER_ERROR;
+        }
+        new_block_start = next->payload;
+    } else {
+        new_block_start = next->payload + block_num * block_size;
+    }
 
     coap_set_header_block1(next->message, block_num, remaining_payload_length > block_size, block_size);
     coap_set_payload(next->message, new_block_start, MIN(block_size, remaining_payload_length));
@@ -484,6 +608,10 @@ void lwm2m_handle_packet(lwm2m_context_t *contextP, uint8_t *buffer, size_t leng
     static coap_packet_t response[1];
 
     LOG("Entering");
+#ifdef LWM2M_CLIENT_QUEUE_MODE
+    queue_mode_exchange(contextP);
+#endif
+    data_arenaBegin();
     /* The buffer length is uint16_t here, as UDP packet length field is 16 bit.
      * This might change in the future e.g. for supporting TCP or other transport.
      */
@@ -493,6 +621,15 @@ void lwm2m_handle_packet(lwm2m_context_t *contextP, uint8_t *buffer, size_t leng
     	IotLogInfo("Parsed: ver %u, type %u, tkl %u, code %u.%.2u, mid %u, Content type: %d",
                 message->version, message->type, message->token_len, message->code >> 5, message->code & 0x1F, message->mid, message->content_type);
     	IotLogInfo("%d Payload: %.*s", message->payload_len, message->payload);
+#if LWM2M_COAP_DEDUP_CACHE_SIZE > 0
+        if (message->code >= COAP_GET && message->code <= COAP_DELETE
+         && message->type == COAP_TYPE_CON
+         && packet_dedupReplay(contextP, fromSessionH, message, lwm2m_gettime()))
+        {
+            /* already handled, the response went out again */
+        }
+        else
+#endif
         if (message->code >= COAP_GET && message->code <= COAP_DELETE)
         {
             uint32_t block_num = 0;
@@ -612,7 +749,11 @@ void lwm2m_handle_packet(lwm2m_context_t *contextP, uint8_t *buffer, size_t leng
             {
                 /* Save original payload pointer for later freeing. Payload in response may be updated. */
                 uint8_t *payload = response->payload;
-                if ( IS_OPTION(message, COAP_OPTION_BLOCK2) )
+                if ( IS_OPTION(response, COAP_OPTION_BLOCK2) )
+                {
+                    /* the handler generated the requested block only */
+                }
+                else if ( IS_OPTION(message, COAP_OPTION_BLOCK2) )
                 {
                     /* get offset for blockwise transfers */
                     if (coap_get_header_block2(message, &block_num, NULL, &block_size, &block_offset))
@@ -757,9 +898,14 @@ void lwm2m_handle_packet(lwm2m_context_t *contextP, uint8_t *buffer, size_t leng
                     switch (message->code) {
                         case COAP_201_CREATED:
                         case COAP_204_CHANGED:
-                        case COAP_231_CONTINUE:
                             prv_send_next_block1(contextP, fromSessionH, message->mid, block_size);
                             break;
+                        case COAP_231_CONTINUE:
+                            if (prv_send_next_block1(contextP, fromSessionH, message->mid, block_size) != 0) {
+                                // the next block can not be sent, let the callback see the transfer fail
+                                message->code = COAP_500_INTERNAL_SERVER_ERROR;
+                            }
+                            break;
                         case COAP_413_ENTITY_TOO_LARGE:
                             // resend with smaller block size as specified in the block 1 option
                             if (block_num > 0) break;
@@ -857,6 +1003,8 @@ void lwm2m_handle_packet(lwm2m_context_t *contextP, uint8_t *buffer, size_t leng
         coap_set_payload(message, coap_error_message, strlen(coap_error_message));
         message_send(contextP, message, fromSessionH);
     }
+
+    data_arenaEnd();
 }
 
 uint8_t message_send(lwm2m_context_t * contextP,
@@ -881,6 +1029,16 @@ uint8_t message_send(lwm2m_context_t * contextP,
         if (0 != pktBufferLen)
         {
             result = lwm2m_buffer_send(sessionH, pktBuffer, pktBufferLen, contextP->userData);
+#ifdef LWM2M_CLIENT_QUEUE_MODE
+            queue_mode_exchange(contextP);
+#endif
+#if LWM2M_COAP_DEDUP_CACHE_SIZE > 0
+            if (message->type == COAP_TYPE_ACK && message->code != 0)
+            {
+                // piggybacked response, keep it for retransmissions of the request
+                packet_dedupStore(sessionH, message, pktBuffer, pktBufferLen, lwm2m_gettime());
+            }
+#endif
         }
         lwm2m_free(pktBuffer);
     }
@@ -0,0 +1,275 @@
+/*******************************************************************************
+ *
+ * Queue Mode of the client (LwM2M 1.1 Core, 6.5).
+ *
+ * When every server has the Q binding, the client sleeps once it exchanged
+ * nothing with them for LWM2M_QUEUE_MODE_AWAKE_TIME seconds. While it sleeps,
+ * notifications and Send operations are kept in a bounded queue instead of
+ * waking the radio. The client announces the next wake up with a registration
+ * update and sends the kept messages in order once the update is acknowledged,
+ * so that the server knows the client is reachable again before they arrive.
+ *
+ * 1NCE GmbH
+ *
+ *******************************************************************************/
+
+#include "internals.h"
+
+#ifdef LWM2M_CLIENT_QUEUE_MODE
+
+static bool prv_isQueueModeBound(lwm2m_context_t * contextP)
+{
+    lwm2m_server_t * serverP;
+
+    if (contextP->serverList == NULL) return false;
+
+    for (serverP = contextP->serverList; serverP != NULL; serverP = serverP->next)
+    {
+        if ((serverP->binding & BINDING_Q) == 0) return false;
+    }
+
+    return true;
+}
+
+static bool prv_isRegistered(lwm2m_context_t * contextP)
+{
+    lwm2m_server_t * serverP;
+
+    for (serverP = contextP->serverList; serverP != NULL; serverP = serverP->next)
+    {
+        if (serverP->status != STATE_REGISTERED) return false;
+    }
+
+    return true;
+}
+
+static bool prv_isUpdating(lwm2m_context_t * contextP)
+{
+    lwm2m_server_t * serverP;
+
+    for (serverP = contextP->serverList; serverP != NULL; serverP = serverP->next)
+    {
+        if (serverP->status == STATE_REG_UPDATE_NEEDED
+         || serverP->status == STATE_REG_FULL_UPDATE_NEEDED
+         || serverP->status == STATE_REG_UPDATE_PENDING)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Return the entry at the tail of the queue. When the queue is full, the
+// oldest message is dropped to make room.
+static lwm2m_queued_message_t * prv_reserve(lwm2m_context_t * contextP)
+{
+    lwm2m_queued_message_t * entryP;
+
+    if (contextP->queueCount == LWM2M_QUEUE_MODE_LENGTH)
+    {
+        LOG("Queue full, dropping the oldest message");
+        entryP = &contextP->queue[contextP->queueHead];
+        lwm2m_free(entryP->buffer);
+        entryP->buffer = NULL;
+        contextP->queueHead = (uint8_t)((contextP->queueHead + 1) % LWM2M_QUEUE_MODE_LENGTH);
+        contextP->queueCount--;
+    }
+
+    entryP = &contextP->queue[(contextP->queueHead + contextP->queueCount) % LWM2M_QUEUE_MODE_LENGTH];
+    memset(entryP, 0, sizeof(lwm2m_queued_message_t));
+    entryP->time = lwm2m_gettime();
+    contextP->queueCount++;
+
+    return entryP;
+}
+
+static void prv_flush(lwm2m_context_t * contextP)
+{
+    lwm2m_queued_message_t * entryP;
+
+    LOG_ARG("Sending %d kept messages", contextP->queueCount);
+    while (contextP->queueCount > 0)
+    {
+        entryP = &contextP->queue[contextP->queueHead];
+
+        if (entryP->isSend)
+        {
+            (void)send_data(contextP, entryP->sessionH, &entryP->uri, entryP->format, entryP->buffer, entryP->length);
+        }
+        else
+        {
+            (void)lwm2m_buffer_send(entryP->sessionH, entryP->buffer, entryP->length, contextP->userData);
+        }
+
+        lwm2m_free(entryP->buffer);
+        entryP->buffer = NULL;
+        contextP->queueHead = (uint8_t)((contextP->queueHead + 1) % LWM2M_QUEUE_MODE_LENGTH);
+        contextP->queueCount--;
+    }
+
+    queue_mode_exchange(contextP);
+}
+
+void queue_mode_exchange(lwm2m_context_t * contextP)
+{
+    time_t tv_sec = lwm2m_gettime();
+
+    if (tv_sec >= 0) contextP->lastExchange = tv_sec;
+}
+
+bool queue_mode_isSleeping(lwm2m_context_t * contextP)
+{
+    return contextP->queueState != QUEUE_MODE_AWAKE;
+}
+
+uint8_t queue_mode_keepNotification(lwm2m_context_t * contextP,
+                                    coap_packet_t * message,
+                                    void * sessionH)
+{
+    lwm2m_queued_message_t * entryP;
+    uint8_t * buffer;
+    size_t length;
+
+    length = coap_serialize_get_size(message);
+    if (length == 0) return COAP_500_INTERNAL_SERVER_ERROR;
+
+    buffer = (uint8_t *)lwm2m_malloc(length);
+    if (buffer == NULL) return COAP_500_INTERNAL_SERVER_ERROR;
+
+    length = coap_serialize_message(message, buffer);
+    if (length == 0)
+    {
+        lwm2m_free(buffer);
+        return COAP_500_INTERNAL_SERVER_ERROR;
+    }
+
+    entryP = prv_reserve(contextP);
+    entryP->isSend = false;
+    entryP->sessionH = sessionH;
+    entryP->buffer = buffer;
+    entryP->length = length;
+    LOG_ARG("Kept notification, %d messages kept", contextP->queueCount);
+
+    return COAP_NO_ERROR;
+}
+
+uint8_t queue_mode_keepSend(lwm2m_context_t * contextP,
+                            void * sessionH,
+                            lwm2m_uri_t * uriP,
+                            lwm2m_media_type_t format,
+                            uint8_t * buffer,
+                            size_t length)
+{
+    lwm2m_queued_message_t * entryP;
+
+    entryP = prv_reserve(contextP);
+    entryP->isSend = true;
+    entryP->sessionH = sessionH;
+    entryP->uri = *uriP;
+    entryP->format = format;
+    entryP->buffer = buffer;
+    entryP->length = length;
+    LOG_ARG("Kept Send operation, %d messages kept", contextP->queueCount);
+
+    return COAP_NO_ERROR;
+}
+
+void queue_mode_step(lwm2m_context_t * contextP,
+                     time_t currentTime,
+                     time_t * timeoutP)
+{
+    time_t interval;
+
+    if (contextP->state != STATE_READY || !prv_isQueueModeBound(contextP))
+    {
+        // The kept messages belong to a registration that is gone.
+        queue_mode_clear(contextP);
+        return;
+    }
+
+    switch (contextP->queueState)
+    {
+    case QUEUE_MODE_AWAKE:
+        if (contextP->transactionList != NULL || !prv_isRegistered(contextP))
+        {
+            // Stay reachable until the server answered.
+            contextP->lastExchange = currentTime;
+            break;
+        }
+
+        interval = contextP->lastExchange + LWM2M_QUEUE_MODE_AWAKE_TIME - currentTime;
+        if (interval <= 0)
+        {
+            LOG("Sleeping");
+            contextP->queueState = QUEUE_MODE_SLEEPING;
+        }
+        else if (*timeoutP > interval)
+        {
+            *timeoutP = interval;
+        }
+        break;
+
+    case QUEUE_MODE_SLEEPING:
+        // A registration update due to the lifetime wakes the client up as well.
+        if (prv_isUpdating(contextP))
+        {
+            contextP->queueState = QUEUE_MODE_WAKING;
+        }
+        break;
+
+    case QUEUE_MODE_WAKING:
+        if (prv_isRegistered(contextP))
+        {
+            LOG("Awake");
+            prv_flush(contextP);
+            contextP->queueState = QUEUE_MODE_AWAKE;
+        }
+        break;
+
+    default:
+        break;
+    }
+}
+
+void queue_mode_clear(lwm2m_context_t * contextP)
+{
+    while (contextP->queueCount > 0)
+    {
+        lwm2m_free(contextP->queue[contextP->queueHead].buffer);
+        contextP->queue[contextP->queueHead].buffer = NULL;
+        contextP->queueHead = (uint8_t)((contextP->queueHead + 1) % LWM2M_QUEUE_MODE_LENGTH);
+        contextP->queueCount--;
+    }
+
+    contextP->queueState = QUEUE_MODE_AWAKE;
+}
+
+int lwm2m_queue_mode_wake(lwm2m_context_t * contextP)
+{
+    int result;
+
+    if (contextP->queueState != QUEUE_MODE_SLEEPING) return COAP_NO_ERROR;
+
+    LOG("Waking up");
+    result = lwm2m_update_registration(contextP, 0, false);
+    if (result == COAP_NO_ERROR)
+    {
+        contextP->queueState = QUEUE_MODE_WAKING;
+    }
+
+    return result;
+}
+
+size_t lwm2m_queue_mode_pending(lwm2m_context_t * contextP,
+                                time_t * oldestP)
+{
+    if (oldestP != NULL && contextP->queueCount > 0)
+    {
+        *oldestP = contextP->queue[contextP->queueHead].time;
+    }
+
+    return contextP->queueCount;
+}
+
+#endif
@@ -252,6 +252,86 @@ static int prv_getRegistrationQuery(lwm2m_context_t * contextP,
     return index;
 }
 
+// Return the registration query of the server, built once and kept until
+// its lifetime or binding change.
+static char * prv_getQuery(lwm2m_context_t * contextP,
+                           lwm2m_server_t * server)
+{
+    char * query;
+    int query_length;
+
+    if (server->query != NULL) return server->query;
+
+    query_length = prv_getRegistrationQueryLength(contextP, server);
+    if (query_length == 0) return NULL;
+
+    query = (char *)lwm2m_malloc(query_length);
+    if (query == NULL) return NULL;
+
+    if (prv_getRegistrationQuery(contextP, server, query, query_length) != query_length)
+    {
+        lwm2m_free(query);
+        return NULL;
+    }
+
+    server->query = query;
+    return query;
+}
+
+// Measure the object list sent with registrations again if objects or
+// instances changed since it was measured. Only its length and digest are
+// kept, the blocks are generated when sent. Its version only changes with its
+// content so that updates can tell whether the server already knows it.
+static int prv_refreshPayload(lwm2m_context_t * contextP)
+{
+    link_writer_t writer;
+
+    if (contextP->registerPayloadLength != 0 && !contextP->registerPayloadStale) return 0;
+
+    utils_linkWriterInit(&writer, NULL, 0, 0);
+    if (object_writeRegisterPayload(contextP, &writer) != 0) return -1;
+
+    if (contextP->registerPayloadLength != utils_linkWriterTotal(&writer)
+     || contextP->registerPayloadDigest != writer.digest)
+    {
+        contextP->registerPayloadVersion++;
+    }
+
+    contextP->registerPayloadLength = utils_linkWriterTotal(&writer);
+    contextP->registerPayloadDigest = writer.digest;
+    contextP->registerPayloadStale = false;
+
+    return 0;
+}
+
+// lwm2m_payload_source_t of the object list. The transfer is abandoned if
+// the list changed since it started, the server would get a mix of both.
+static size_t prv_writePayloadBlock(void * sourceData,
+                                    size_t offset,
+                                    uint8_t * buffer,
+                                    size_t length)
+{
+    lwm2m_context_t * contextP = (lwm2m_context_t *)sourceData;
+    link_writer_t writer;
+
+    utils_linkWriterInit(&writer, buffer, offset, length);
+    if (object_writeRegisterPayload(contextP, &writer) != 0) return 0;
+
+    if (utils_linkWriterTotal(&writer) != contextP->registerPayloadLength
+     || writer.digest != contextP->registerPayloadDigest)
+    {
+        LOG("Object list changed during the transfer");
+        return 0;
+    }
+
+    return utils_linkWriterWindow(&writer);
+}
+
+void registration_resetPayload(lwm2m_context_t * contextP)
+{
+    contextP->registerPayloadStale = true;
+}
+
 #ifndef LWM2M_VERSION_1_0
 static uint8_t prv_readUint(lwm2m_context_t *contextP,
                             lwm2m_object_t *objP,
@@ -631,8 +711,7 @@ static void prv_handleRegistrationAttemptFailure(lwm2m_context_t *contextP, lwm2
 typedef struct
 {
     lwm2m_server_t * server;
-    char * query;
-    uint8_t * payload;
+    uint32_t payloadVersion;    // version of the object list known by the server once acknowledged
 } registration_data_t;
 
 static void prv_handleRegistrationReply(lwm2m_context_t * contextP,
@@ -661,6 +740,7 @@ static void prv_handleRegistrationReply(lwm2m_context_t * contextP,
         if (packet != NULL && packet->code == COAP_201_CREATED)
         {
             dataP->server->status = STATE_REGISTERED;
+            dataP->server->payloadVersion = dataP->payloadVersion;
             if (NULL != dataP->server->location)
             {
                 lwm2m_free(dataP->server->location);
@@ -712,13 +792,7 @@ static void prv_handleRegistrationReply(lwm2m_context_t * contextP,
 #endif
         }
     }
-    char * query = dataP->query;
-    uint8_t * payload = dataP->payload;
-    if (transaction_free_userData(contextP, transacP))
-    {
-            lwm2m_free(query);
-            lwm2m_free(payload);
-    }
+    transaction_free_userData(contextP, transacP);
 }
 
 // send the registration for a single server
@@ -726,40 +800,12 @@ static uint8_t prv_register(lwm2m_context_t * contextP,
                             lwm2m_server_t * server)
 {
     char * query;
-    int query_length;
-    uint8_t * payload;
-    int payload_length;
     lwm2m_transaction_t * transaction;
 
-    payload_length = object_getRegisterPayloadBufferLength(contextP);
-    if(payload_length == 0) return COAP_500_INTERNAL_SERVER_ERROR;
-    payload = (uint8_t*) lwm2m_malloc(payload_length);
-    if(!payload) return COAP_500_INTERNAL_SERVER_ERROR;
-    payload_length = object_getRegisterPayload(contextP, payload, payload_length);
-    if(payload_length == 0)
-    {
-        lwm2m_free(payload);
-        return COAP_500_INTERNAL_SERVER_ERROR;
-    }
+    if (prv_refreshPayload(contextP) != 0) return COAP_500_INTERNAL_SERVER_ERROR;
 
-    query_length = prv_getRegistrationQueryLength(contextP, server);
-    if(query_length == 0)
-    {
-        lwm2m_free(payload);
-        return COAP_500_INTERNAL_SERVER_ERROR;
-    }
-    query = (char*) lwm2m_malloc(query_length);
-    if(!query)
-    {
-        lwm2m_free(payload);
-        return COAP_500_INTERNAL_SERVER_ERROR;
-    }
-    if(prv_getRegistrationQuery(contextP, server, query, query_length) != query_length)
-    {
-        lwm2m_free(payload);
-        lwm2m_free(query);
-        return COAP_500_INTERNAL_SERVER_ERROR;
-    }
+    query = prv_getQuery(contextP, server);
+    if (query == NULL) return COAP_500_INTERNAL_SERVER_ERROR;
 
     if (server->sessionH == NULL)
     {
@@ -769,16 +815,12 @@ static uint8_t prv_register(lwm2m_context_t * contextP,
 
     if (NULL == server->sessionH)
     {
-        lwm2m_free(payload);
-        lwm2m_free(query);
         return COAP_503_SERVICE_UNAVAILABLE;
     }
 
     transaction = transaction_new(server->sessionH, COAP_POST, NULL, NULL, contextP->nextMID++, 4, NULL);
     if (transaction == NULL)
     {
-        lwm2m_free(payload);
-        lwm2m_free(query);
         return COAP_503_SERVICE_UNAVAILABLE;
     }
 
@@ -786,23 +828,18 @@ static uint8_t prv_register(lwm2m_context_t * contextP,
     coap_set_header_uri_query(transaction->message, query);
     coap_set_header_content_type(transaction->message, LWM2M_CONTENT_LINK);
 
-    if (!transaction_set_payload(transaction, payload, (size_t)payload_length)) {
-        lwm2m_free(payload);
-        lwm2m_free(query);
+    if (!transaction_set_payload_source(transaction, prv_writePayloadBlock, contextP, contextP->registerPayloadLength)) {
         transaction_free(transaction);
         return COAP_503_SERVICE_UNAVAILABLE;
     }
 
     registration_data_t * dataP = (registration_data_t *) lwm2m_malloc(sizeof(registration_data_t));
     if (dataP == NULL){
-        lwm2m_free(payload);
-        lwm2m_free(query);
         transaction_free(transaction);
         return COAP_503_SERVICE_UNAVAILABLE;
     }
 
-    dataP->payload = payload;
-    dataP->query = query;
+    dataP->payloadVersion = contextP->registerPayloadVersion;
     dataP->server = server;
     
     transaction->callback = prv_handleRegistrationReply;
@@ -850,6 +887,7 @@ static void prv_handleRegistrationUpdateReply(lwm2m_context_t * contextP,
         if (packet != NULL && packet->code == COAP_204_CHANGED)
         {
             dataP->server->status = STATE_REGISTERED;
+            dataP->server->payloadVersion = dataP->payloadVersion;
             LOG_ARG("%d Registration update successful", dataP->server->shortID);
         }
         else
@@ -860,7 +898,6 @@ static void prv_handleRegistrationUpdateReply(lwm2m_context_t * contextP,
     }
     if (packet != NULL && packet->code != COAP_231_CONTINUE)
     {
-        lwm2m_free(dataP->payload);
         transaction_free_userData(contextP, transacP);
     }
 }
@@ -870,41 +907,28 @@ static int prv_updateRegistration(lwm2m_context_t * contextP,
                                   bool withObjects)
 {
     lwm2m_transaction_t * transaction;
-    uint8_t * payload = NULL;
-    int payload_length;
-
-    transaction = transaction_new(server->sessionH, COAP_POST, NULL, NULL, contextP->nextMID++, 4, NULL);
-    if (transaction == NULL) return COAP_500_INTERNAL_SERVER_ERROR;
-
-    coap_set_header_uri_path(transaction->message, server->location);
 
     if (withObjects == true)
     {
-        payload_length = object_getRegisterPayloadBufferLength(contextP);
-        if(payload_length == 0)
-        {
-            transaction_free(transaction);
-            return COAP_500_INTERNAL_SERVER_ERROR;
-        }
+        if (prv_refreshPayload(contextP) != 0) return COAP_500_INTERNAL_SERVER_ERROR;
 
-        payload = (uint8_t*) lwm2m_malloc(payload_length);
-        if(!payload)
+        if (server->payloadVersion == contextP->registerPayloadVersion)
         {
-            transaction_free(transaction);
-            return COAP_500_INTERNAL_SERVER_ERROR;
+            // the server already knows this object list
+            LOG_ARG("%d Object list unchanged", server->shortID);
+            withObjects = false;
         }
+    }
 
-        payload_length = object_getRegisterPayload(contextP, payload, payload_length);
-        if(payload_length == 0)
-        {
-            transaction_free(transaction);
-            lwm2m_free(payload);
-            return COAP_500_INTERNAL_SERVER_ERROR;
-        }
+    transaction = transaction_new(server->sessionH, COAP_POST, NULL, NULL, contextP->nextMID++, 4, NULL);
+    if (transaction == NULL) return COAP_500_INTERNAL_SERVER_ERROR;
 
-        if (!transaction_set_payload(transaction, payload, (size_t)payload_length)) {
+    coap_set_header_uri_path(transaction->message, server->location);
+
+    if (withObjects == true)
+    {
+        if (!transaction_set_payload_source(transaction, prv_writePayloadBlock, contextP, contextP->registerPayloadLength)) {
             transaction_free(transaction);
-            lwm2m_free(payload);
             return COAP_500_INTERNAL_SERVER_ERROR;
         }
     }
@@ -912,11 +936,10 @@ static int prv_updateRegistration(lwm2m_context_t * contextP,
     registration_data_t * dataP = (registration_data_t *) lwm2m_malloc(sizeof(registration_data_t));
     if (dataP == NULL){
         transaction_free(transaction);
-        lwm2m_free(payload);
         return COAP_500_INTERNAL_SERVER_ERROR;
     }
 
-    dataP->payload = payload;
+    dataP->payloadVersion = withObjects ? contextP->registerPayloadVersion : server->payloadVersion;
     dataP->server = server;
 
     transaction->callback = prv_handleRegistrationUpdateReply;
@@ -943,6 +966,12 @@ int lwm2m_update_registration(lwm2m_context_t * contextP,
 
     result = COAP_NO_ERROR;
 
+    if (withObjects == true)
+    {
+        // objects or instances changed
+        registration_resetPayload(contextP);
+    }
+
     targetP = contextP->serverList;
     if (targetP == NULL)
     {
@@ -194,6 +194,42 @@ int utils_textToObjLink(const uint8_t * buffer,
     return 1;
 }
 
+/* "00" to "99", so that integers are converted two digits at a time. */
+static const char prv_digitPairs[200] =
+{
+    '0','0','0','1','0','2','0','3','0','4','0','5','0','6','0','7','0','8','0','9',
+    '1','0','1','1','1','2','1','3','1','4','1','5','1','6','1','7','1','8','1','9',
+    '2','0','2','1','2','2','2','3','2','4','2','5','2','6','2','7','2','8','2','9',
+    '3','0','3','1','3','2','3','3','3','4','3','5','3','6','3','7','3','8','3','9',
+    '4','0','4','1','4','2','4','3','4','4','4','5','4','6','4','7','4','8','4','9',
+    '5','0','5','1','5','2','5','3','5','4','5','5','5','6','5','7','5','8','5','9',
+    '6','0','6','1','6','2','6','3','6','4','6','5','6','6','6','7','6','8','6','9',
+    '7','0','7','1','7','2','7','3','7','4','7','5','7','6','7','7','7','8','7','9',
+    '8','0','8','1','8','2','8','3','8','4','8','5','8','6','8','7','8','8','8','9',
+    '9','0','9','1','9','2','9','3','9','4','9','5','9','6','9','7','9','8','9','9'
+};
+
+static const uint64_t prv_pow10[20] =
+{
+    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL,
+    100000000ULL, 1000000000ULL, 10000000000ULL, 100000000000ULL,
+    1000000000000ULL, 10000000000000ULL, 100000000000000ULL,
+    1000000000000000ULL, 10000000000000000ULL, 100000000000000000ULL,
+    1000000000000000000ULL, 10000000000000000000ULL
+};
+
+static size_t prv_countDigits(uint64_t data)
+{
+    size_t digits = 1;
+
+    while (digits < 20 && data >= prv_pow10[digits])
+    {
+        digits++;
+    }
+
+    return digits;
+}
+
 size_t utils_intToText(int64_t data,
                        uint8_t * string,
                        size_t length)
@@ -204,21 +240,8 @@ size_t utils_intToText(int64_t data,
     {
         if (length == 0) return 0;
         string[0] = '-';
-        /*
-         * Hack around the fact that -1 * INT64_MIN can not be represented as
-         * int64_t.
-         */
-        if (data == INT64_MIN) {
-            const char *const int64_min_str = "-9223372036854775808";
-            const size_t int64_min_strlen = strlen(int64_min_str);
-            if (int64_min_strlen >= length) {
-                return 0;
-            }
-            memcpy(string, "-9223372036854775808", int64_min_strlen);
-            string[int64_min_strlen] = '\0';
-            return int64_min_strlen;
-        }
-        result = utils_uintToText((uint64_t)labs(data), string + 1, length - 1);
+        /* Negate as unsigned, which also holds -INT64_MIN. */
+        result = utils_uintToText((uint64_t)0 - (uint64_t)data, string + 1, length - 1);
         if(result != 0)
         {
             result += 1;
@@ -236,312 +259,475 @@ size_t utils_uintToText(uint64_t data,
                         uint8_t * string,
                         size_t length)
 {
-    int index;
     size_t result;
+    size_t index;
+    uint32_t small;
+    uint32_t pair;
 
-    if (length == 0) return 0;
+    result = prv_countDigits(data);
+    if (result > length) return 0;
 
-    index = length - 1;
-    do
+    index = result;
+    /* 64 bit divisions are library calls on 32 bit targets, leave them as
+     * soon as the rest fits in 32 bits. */
+    while (data > UINT32_MAX)
+    {
+        pair = (uint32_t)(data % 100);
+        data /= 100;
+        index -= 2;
+        memcpy(string + index, prv_digitPairs + pair * 2, 2);
+    }
+    small = (uint32_t)data;
+    while (small >= 100)
+    {
+        pair = small % 100;
+        small /= 100;
+        index -= 2;
+        memcpy(string + index, prv_digitPairs + pair * 2, 2);
+    }
+    if (small >= 10)
     {
-        string[index] = '0' + data%10;
-        data /= 10;
-        index --;
-    } while (index >= 0 && data > 0);
+        memcpy(string, prv_digitPairs + small * 2, 2);
+    }
+    else
+    {
+        string[0] = (uint8_t)('0' + small);
+    }
+
+    if (result < length) string[result] = '\0';
+
+    return result;
+}
 
-    if (data > 0) return 0;
+/*
+ * Shortest digits of a double with Grisu2 (Florian Loitsch, "Printing
+ * Floating-Point Numbers Quickly and Accurately with Integers", PLDI 2010).
+ * Only 64 bit integer arithmetic is used, the digits always convert back to
+ * the same double and are the shortest ones in all but rare cases, where one
+ * more digit is produced.
+ */
+
+typedef struct
+{
+    uint64_t f;
+    int e;
+} utils_diyFp_t;
 
-    index++;
+/* Normalized 10^k for k from -348 to 340 in steps of 8, as significand and
+ * binary exponent. */
+static const struct
+{
+    uint64_t f;
+    int16_t e;
+} prv_cachedPowers[87] =
+{
+    { 0xfa8fd5a0081c0288, -1220 }, { 0xbaaee17fa23ebf76, -1193 }, { 0x8b16fb203055ac76, -1166 },
+    { 0xcf42894a5dce35ea, -1140 }, { 0x9a6bb0aa55653b2d, -1113 }, { 0xe61acf033d1a45df, -1087 },
+    { 0xab70fe17c79ac6ca, -1060 }, { 0xff77b1fcbebcdc4f, -1034 }, { 0xbe5691ef416bd60c, -1007 },
+    { 0x8dd01fad907ffc3c,  -980 }, { 0xd3515c2831559a83,  -954 }, { 0x9d71ac8fada6c9b5,  -927 },
+    { 0xea9c227723ee8bcb,  -901 }, { 0xaecc49914078536d,  -874 }, { 0x823c12795db6ce57,  -847 },
+    { 0xc21094364dfb5637,  -821 }, { 0x9096ea6f3848984f,  -794 }, { 0xd77485cb25823ac7,  -768 },
+    { 0xa086cfcd97bf97f4,  -741 }, { 0xef340a98172aace5,  -715 }, { 0xb23867fb2a35b28e,  -688 },
+    { 0x84c8d4dfd2c63f3b,  -661 }, { 0xc5dd44271ad3cdba,  -635 }, { 0x936b9fcebb25c996,  -608 },
+    { 0xdbac6c247d62a584,  -582 }, { 0xa3ab66580d5fdaf6,  -555 }, { 0xf3e2f893dec3f126,  -529 },
+    { 0xb5b5ada8aaff80b8,  -502 }, { 0x87625f056c7c4a8b,  -475 }, { 0xc9bcff6034c13053,  -449 },
+    { 0x964e858c91ba2655,  -422 }, { 0xdff9772470297ebd,  -396 }, { 0xa6dfbd9fb8e5b88f,  -369 },
+    { 0xf8a95fcf88747d94,  -343 }, { 0xb94470938fa89bcf,  -316 }, { 0x8a08f0f8bf0f156b,  -289 },
+    { 0xcdb02555653131b6,  -263 }, { 0x993fe2c6d07b7fac,  -236 }, { 0xe45c10c42a2b3b06,  -210 },
+    { 0xaa242499697392d3,  -183 }, { 0xfd87b5f28300ca0e,  -157 }, { 0xbce5086492111aeb,  -130 },
+    { 0x8cbccc096f5088cc,  -103 }, { 0xd1b71758e219652c,   -77 }, { 0x9c40000000000000,   -50 },
+    { 0xe8d4a51000000000,   -24 }, { 0xad78ebc5ac620000,     3 }, { 0x813f3978f8940984,    30 },
+    { 0xc097ce7bc90715b3,    56 }, { 0x8f7e32ce7bea5c70,    83 }, { 0xd5d238a4abe98068,   109 },
+    { 0x9f4f2726179a2245,   136 }, { 0xed63a231d4c4fb27,   162 }, { 0xb0de65388cc8ada8,   189 },
+    { 0x83c7088e1aab65db,   216 }, { 0xc45d1df942711d9a,   242 }, { 0x924d692ca61be758,   269 },
+    { 0xda01ee641a708dea,   295 }, { 0xa26da3999aef774a,   322 }, { 0xf209787bb47d6b85,   348 },
+    { 0xb454e4a179dd1877,   375 }, { 0x865b86925b9bc5c2,   402 }, { 0xc83553c5c8965d3d,   428 },
+    { 0x952ab45cfa97a0b3,   455 }, { 0xde469fbd99a05fe3,   481 }, { 0xa59bc234db398c25,   508 },
+    { 0xf6c69a72a3989f5c,   534 }, { 0xb7dcbf5354e9bece,   561 }, { 0x88fcf317f22241e2,   588 },
+    { 0xcc20ce9bd35c78a5,   614 }, { 0x98165af37b2153df,   641 }, { 0xe2a0b5dc971f303a,   667 },
+    { 0xa8d9d1535ce3b396,   694 }, { 0xfb9b7cd9a4a7443c,   720 }, { 0xbb764c4ca7a44410,   747 },
+    { 0x8bab8eefb6409c1a,   774 }, { 0xd01fef10a657842c,   800 }, { 0x9b10a4e5e9913129,   827 },
+    { 0xe7109bfba19c0c9d,   853 }, { 0xac2820d9623bf429,   880 }, { 0x80444b5e7aa7cf85,   907 },
+    { 0xbf21e44003acdd2d,   933 }, { 0x8e679c2f5e44ff8f,   960 }, { 0xd433179d9c8cb841,   986 },
+    { 0x9e19db92b4e31ba9,  1013 }, { 0xeb96bf6ebadf77d9,  1039 }, { 0xaf87023b9bf0ee6b,  1066 }
+};
 
-    result = length - index;
+#define DIY_FP_HIDDEN_BIT   0x0010000000000000ULL
+#define DIY_FP_FRACTION     0x000FFFFFFFFFFFFFULL
 
-    if (result < length)
-    {
-        memmove(string, string + index, result);
-        string[result] = '\0';
-    }
+/* Up to 17 digits plus the one Grisu2 may add. */
+#define FLOAT_DIGITS_MAX    18
+
+static utils_diyFp_t prv_diyFpMultiply(utils_diyFp_t x,
+                                       utils_diyFp_t y)
+{
+    utils_diyFp_t result;
+    uint64_t a = x.f >> 32;
+    uint64_t b = x.f & 0xFFFFFFFF;
+    uint64_t c = y.f >> 32;
+    uint64_t d = y.f & 0xFFFFFFFF;
+    uint64_t bd = b * d;
+    uint64_t ad = a * d;
+    uint64_t bc = b * c;
+    uint64_t middle;
+
+    /* Upper 64 bits of the 128 bit product, rounded. */
+    middle = (bd >> 32) + (ad & 0xFFFFFFFF) + (bc & 0xFFFFFFFF) + (1ULL << 31);
+    result.f = a * c + (ad >> 32) + (bc >> 32) + (middle >> 32);
+    result.e = x.e + y.e + 64;
 
     return result;
 }
 
-size_t utils_floatToText(double data,
-                         uint8_t * string,
-                         size_t length,
-                         bool allowExponential)
+static utils_diyFp_t prv_diyFpNormalize(utils_diyFp_t x)
 {
-    uint64_t intPart;
-    double decPart;
-    double noiseFloor;
-    double roundCheck;
-    size_t res;
-    size_t head = 0;
-    int zeros = 0; /* positive for trailing, negative for leading */
-    uint8_t expLen = 0;
-    int precisionFactor = 1; /* Adjusts for inaccuracies caused by power of 10 operations. */
-    unsigned digits;
-
-    if (!length || !string) return 0;
+    int shift;
 
-    if (data < 0)
+    for (shift = 32; shift > 0; shift >>= 1)
     {
-        string[head++] = '-';
-        data = -data;
+        if ((x.f >> (64 - shift)) == 0)
+        {
+            x.f <<= shift;
+            x.e -= shift;
+        }
     }
 
-    /* Handle special cases */
-    if (data < DBL_MIN)
+    return x;
+}
+
+static void prv_grisuRound(char * digits,
+                           int length,
+                           uint64_t delta,
+                           uint64_t rest,
+                           uint64_t tenKappa,
+                           uint64_t distance)
+{
+    /* Move the last digit down as long as this brings the result closer to
+     * the exact value while staying inside the boundaries. */
+    while (rest < distance
+        && delta - rest >= tenKappa
+        && (rest + tenKappa < distance || distance - rest > rest + tenKappa - distance))
     {
-        /* Intentionally not distinguishing between +0.0 and -0.0. */
-        if (length < 3) return 0;
-        string[0] = '0';
-        string[1] = '.';
-        string[2] = '0';
-        if (length > 3) string[3] = '\0';
-        return 3;
+        digits[length - 1]--;
+        rest += tenKappa;
     }
-    else if (data > DBL_MAX )
+}
+
+/* Digits of data, which must be positive and finite. The value is
+ * digits * 10^(*exponentP). */
+static int prv_grisu2(double data,
+                      char * digits,
+                      int * exponentP)
+{
+    uint64_t bits;
+    utils_diyFp_t v;
+    utils_diyFp_t plus;
+    utils_diyFp_t minus;
+    utils_diyFp_t power;
+    utils_diyFp_t w;
+    utils_diyFp_t upper;
+    utils_diyFp_t lower;
+    uint64_t delta;
+    uint64_t distance;
+    uint64_t oneMask;
+    uint64_t rest;
+    uint64_t fraction;
+    uint32_t integer;
+    uint32_t digit;
+    int shift;
+    int kappa;
+    int index;
+    int length = 0;
+
+    memcpy(&bits, &data, sizeof(bits));
+    if ((bits >> 52) & 0x7FF)
     {
-        /* Note that this is not valid for JSON. */
-        if (length < 3 + head) return 0;
-        string[head++] = 'i';
-        string[head++] = 'n';
-        string[head++] = 'f';
-        if (length > head) string[head] = '\0';
-        return head;
+        v.f = (bits & DIY_FP_FRACTION) + DIY_FP_HIDDEN_BIT;
+        v.e = (int)((bits >> 52) & 0x7FF) - 1075;
     }
-    else if (isnan(data))
+    else
     {
-        /* NaN */
-        /* Note that this is not valid for JSON. */
-        if (length < 3 + head) return 0;
-        string[head++] = 'n';
-        string[head++] = 'a';
-        string[head++] = 'n';
-        if (length > head) string[head] = '\0';
-        return head;
+        v.f = bits & DIY_FP_FRACTION;
+        v.e = -1074;
     }
 
-    /* Scale to usable range. Assumes DBL_DIG is 15 (IEEE 754 double) */
-    if (data > 1e15)
+    /* Boundaries half way to the neighbouring doubles. */
+    plus.f = (v.f << 1) + 1;
+    plus.e = v.e - 1;
+    plus = prv_diyFpNormalize(plus);
+    if (v.f == DIY_FP_HIDDEN_BIT)
     {
-        while (data > 1e100)
-        {
-            data *= 1e-100;
-            zeros += 100;
-            precisionFactor++;
-        }
-        if (allowExponential)
-        {
-            /* Take data down below 10 so only 1 digit before the decimal point */
-            while (data > 1e10)
-            {
-                data *= 1e-10;
-                zeros += 10;
-                precisionFactor++;
-            }
-            while (data > 10)
-            {
-                data *= 0.1;
-                zeros += 1;
-                precisionFactor++;
-            }
-            if (zeros >= 100)
-            {
-                expLen = 4;
-            }
-            else if(zeros >= 10)
-            {
-                expLen = 3;
-            }
-            else
-            {
-                expLen = 2;
-            }
-        }
-        else
-        {
-            /* Take data down to 15 significant digits before 0s. */
-            while (data >= 1e25)
-            {
-                data *= 1e-10;
-                zeros += 10;
-                precisionFactor++;
-            }
-            while (data > 1e15)
-            {
-                data *= 0.1;
-                zeros += 1;
-                precisionFactor++;
-            }
-            /* Account for lost digits of precision */
-            if (precisionFactor >= 19)
-            {
-                data *= 0.01;
-                zeros += 2;
-                precisionFactor++;
-            }
-            else if (precisionFactor >= 10)
-            {
-                data *= 0.1;
-                zeros += 1;
-                precisionFactor++;
-            }
-        }
+        minus.f = (v.f << 2) - 1;
+        minus.e = v.e - 2;
+    }
+    else
+    {
+        minus.f = (v.f << 1) - 1;
+        minus.e = v.e - 1;
     }
-    /* Exponential notation will add at least 3 characters. Make sure we save
-     * at least that many 0s. */
-    else if (data < (allowExponential ? 1e-3 : 0.1))
+    minus.f <<= minus.e - plus.e;
+    minus.e = plus.e;
+
+    /* Scale by a cached 10^-k so that the binary exponent lands in
+     * [-60, -32] and the integer part of the product fits in 32 bits. */
+    index = ((1110 - plus.e) * 40) / 1063;
+    if (index < 0) index = 0;
+    if (index > 86) index = 86;
+    while (index > 0 && plus.e + prv_cachedPowers[index].e + 64 > -32) index--;
+    while (index < 86 && plus.e + prv_cachedPowers[index].e + 64 < -60) index++;
+    power.f = prv_cachedPowers[index].f;
+    power.e = prv_cachedPowers[index].e;
+    *exponentP = 348 - index * 8;
+
+    w = prv_diyFpMultiply(prv_diyFpNormalize(v), power);
+    upper = prv_diyFpMultiply(plus, power);
+    lower = prv_diyFpMultiply(minus, power);
+    upper.f--;
+    lower.f++;
+    delta = upper.f - lower.f;
+    distance = upper.f - w.f;
+
+    shift = -upper.e;
+    oneMask = (1ULL << shift) - 1;
+    integer = (uint32_t)(upper.f >> shift);
+    fraction = upper.f & oneMask;
+
+    kappa = (int)prv_countDigits(integer);
+    while (kappa > 0)
     {
-        /* For exponential notation take data to between 1 and 10, excluding 10.
-         * Otherwise take data to between 0.1 and 1, excluding 1. */
-        while (data < 1e-100)
+        digit = integer / (uint32_t)prv_pow10[kappa - 1];
+        integer %= (uint32_t)prv_pow10[kappa - 1];
+        if (digit != 0 || length != 0) digits[length++] = (char)('0' + digit);
+        kappa--;
+        rest = ((uint64_t)integer << shift) + fraction;
+        if (rest <= delta)
         {
-            data *= 1e100;
-            zeros -= 100;
-            precisionFactor++;
+            *exponentP += kappa;
+            prv_grisuRound(digits, length, delta, rest, prv_pow10[kappa] << shift, distance);
+            return length;
         }
-        while (data < 1e-10)
+    }
+
+    for (;;)
+    {
+        fraction *= 10;
+        delta *= 10;
+        digit = (uint32_t)(fraction >> shift);
+        if (digit != 0 || length != 0) digits[length++] = (char)('0' + digit);
+        fraction &= oneMask;
+        kappa--;
+        if (fraction < delta)
         {
-            data *= 1e10;
-            zeros -= 10;
-            precisionFactor++;
+            *exponentP += kappa;
+            prv_grisuRound(digits, length, delta, fraction, oneMask + 1, distance * prv_pow10[-kappa]);
+            return length;
         }
-        while (data < (allowExponential ? 1 : 0.1))
+    }
+}
+
+/* Keep the first keep digits, rounding half up. A carry out of the first
+ * digit moves the decimal point. Trailing zeros are dropped. */
+static int prv_roundDigits(char * digits,
+                           int length,
+                           int keep,
+                           int * pointP)
+{
+    int i;
+
+    if (keep >= length) return length;
+    if (keep < 0) keep = 0;
+
+    if (digits[keep] >= '5')
+    {
+        i = keep - 1;
+        while (i >= 0 && digits[i] == '9') i--;
+        if (i < 0)
         {
-            data *= 10;
-            zeros -= 1;
-            precisionFactor++;
-        }
-        if (allowExponential)
-        {
-            if (zeros <= -100)
-            {
-                expLen = 5;
-            }
-            else if(zeros <= -10)
-            {
-                expLen = 4;
-            }
-            else
-            {
-                expLen = 3;
-            }
+            digits[0] = '1';
+            (*pointP)++;
+            return 1;
         }
+        digits[i]++;
+        keep = i + 1;
     }
 
-    noiseFloor = DBL_EPSILON * precisionFactor;
-    /* Adjust the noise floor to account for digits left of the decimal point. */
-    intPart = (uint64_t)data;
-    if (!intPart)
+    while (keep > 0 && digits[keep - 1] == '0') keep--;
+
+    return keep;
+}
+
+/* Characters of the exponent after the 'e'. */
+static size_t prv_exponentLength(int exponent)
+{
+    size_t result = 1;
+
+    if (exponent < 0)
     {
-        /* Leading 0 and decimal point */
-        digits = 2;
+        result++;
+        exponent = -exponent;
     }
-    else
+    while (exponent >= 10)
     {
-        /* Decimal point */
-        digits = 1;
+        result++;
+        exponent /= 10;
     }
-    while (intPart > 0)
+
+    return result;
+}
+
+static size_t prv_zeroToText(uint8_t * string,
+                             size_t length)
+{
+    /* Intentionally not distinguishing between +0.0 and -0.0. */
+    if (length < 3) return 0;
+    string[0] = '0';
+    string[1] = '.';
+    string[2] = '0';
+    if (length > 3) string[3] = '\0';
+    return 3;
+}
+
+size_t utils_floatToText(double data,
+                         uint8_t * string,
+                         size_t length,
+                         bool allowExponential)
+{
+    char digits[FLOAT_DIGITS_MAX];
+    int count;
+    int exponent;
+    int point; /* digits left of the decimal point, can be negative */
+    int keep;
+    bool useExponent;
+    size_t head = 0;
+    size_t needed;
+    size_t i;
+
+    if (!length || !string) return 0;
+
+    if (isnan(data))
     {
-        noiseFloor *= 10;
-        intPart /= 10;
-        digits++;
+        /* Note that this is not valid for JSON. */
+        if (length < 3) return 0;
+        memcpy(string, "nan", 3);
+        if (length > 3) string[3] = '\0';
+        return 3;
     }
 
-    intPart = (uint64_t)data;
-    decPart = data - intPart;
-    if (!allowExponential && zeros > 0)
+    if (data < 0)
     {
-        /* Ensure all significant digits are left of the zeros */
-        while (zeros > 0 && noiseFloor < 1)
-        {
-            decPart *= 10;
-            intPart = intPart * 10 + (unsigned)decPart;
-            decPart -= (unsigned)decPart;
-            zeros--;
-            noiseFloor *= 10;
-            digits++;
-        }
-        decPart = 0;
+        string[head++] = '-';
+        data = -data;
+    }
+
+    if (fpclassify(data) == FP_ZERO) return prv_zeroToText(string, length);
+
+    if (data > DBL_MAX)
+    {
+        /* Note that this is not valid for JSON. */
+        if (length < 3 + head) return 0;
+        memcpy(string + head, "inf", 3);
+        head += 3;
+        if (length > head) string[head] = '\0';
+        return head;
+    }
+
+    count = prv_grisu2(data, digits, &exponent);
+    while (count > 1 && digits[count - 1] == '0')
+    {
+        count--;
+        exponent++;
     }
+    point = count + exponent;
+    useExponent = allowExponential && (data > 1e15 || data < 1e-3);
 
-    if (decPart > noiseFloor)
+    /* Drop digits until the text fits in the buffer. Rounding may carry into
+     * a new leading digit, hence the loop. */
+    for (;;)
     {
-        /* Add 1 to the decimal part so we don't lose leading 0s. */
-        decPart += 1;
+        if (count == 0) return prv_zeroToText(string, length);
 
-        /* Limit the number of digits to space in the buffer and round. */
-        roundCheck = 2;
-        do
+        if (useExponent)
         {
-            digits++;
-            if (head + expLen + digits > length) break;
-            decPart *= 10;
-            roundCheck *= 10;
-            noiseFloor *= 10;
-        } while (decPart - (uint64_t)decPart > noiseFloor);
-        decPart += 0.5;
-        if (decPart >= roundCheck)
+            /* d.d...e-x, with at least one digit after the point */
+            needed = 1 + prv_exponentLength(point - 1);
+            if (head + (count > 1 ? (size_t)count + 1 : 3) + needed <= length) break;
+            keep = (int)length - (int)head - (int)needed - 1;
+            if (keep < 1 || keep >= count)
+            {
+                if (point <= 0) return prv_zeroToText(string, length);
+                return 0;
+            }
+        }
+        else if (point <= 0)
         {
-            intPart += 1;
+            /* 0.00ddd */
+            needed = head + 2 + (size_t)(-point) + count;
+            if (needed <= length) break;
+            keep = (int)length - (int)head - 2 + point;
+        }
+        else
+        {
+            /* ddd.ddd or ddd00.0, the integer part has to fit */
+            if (head + (size_t)point > length) return 0;
+            if (count <= point) break;
+            needed = head + count + 1;
+            if (needed <= length) break;
+            keep = (int)length - (int)head - 1;
+            if (keep < point) keep = point;
         }
-    }
 
-    /* Put out the significant digits left of the decimal point or zeros. */
-    res = utils_uintToText(intPart, string + head, length - head);
-    if (res == 0) return 0;
-    head += res;
+        count = prv_roundDigits(digits, count, keep, &point);
+    }
 
-    if (decPart <= noiseFloor
-     || (!allowExponential && -zeros >= (int)(length - head)))
+    if (useExponent)
     {
-        /* Only 0s right of the significant digits */
-        if (!allowExponential && zeros > 0)
+        string[head++] = (uint8_t)digits[0];
+        string[head++] = '.';
+        if (count > 1)
         {
-            if (head + zeros > length) return 0;
-            memset(string + head, '0', zeros);
-            head += zeros;
+            memcpy(string + head, digits + 1, count - 1);
+            head += count - 1;
         }
-        /* Add as much of ".0" as space permits */
-        if (head < length) string[head++] = '.';
-        if (head < length) string[head++] = '0';
-        if (head < length) string[head] = '\0';
-        return head;
+        else
+        {
+            string[head++] = '0';
+        }
+        string[head++] = 'e';
+        head += utils_intToText(point - 1, string + head, length - head);
     }
-
-    if (!allowExponential && zeros < 0)
+    else if (point <= 0)
     {
-        /* Add "." plus leading 0s. Leaving one off to be added back later. */
-        if (head - zeros > length) return 0;
-        string[head] = '.';
-        if (zeros < -1) memset(string + head + 1, '0', -(zeros) - 1);
-        head -= zeros;
+        string[head++] = '0';
+        string[head++] = '.';
+        memset(string + head, '0', -point);
+        head += -point;
+        memcpy(string + head, digits, count);
+        head += count;
     }
-
-    /* Digits for the fractional part. */
-    res = utils_uintToText((uint64_t)decPart, string + head, length - head);
-    if (!res) return 0;
-
-    // replace the leading 1 with a decimal point or 0
-    if (!allowExponential && zeros < 0)
+    else if (count > point)
     {
-        string[head] = '0';
+        memcpy(string + head, digits, point);
+        head += point;
+        string[head++] = '.';
+        memcpy(string + head, digits + point, count - point);
+        head += count - point;
     }
     else
     {
-        string[head] = '.';
+        memcpy(string + head, digits, count);
+        head += count;
+        for (i = count; i < (size_t)point; i++)
+        {
+            string[head++] = '0';
+        }
+        if (head + 2 <= length)
+        {
+            string[head++] = '.';
+            string[head++] = '0';
+        }
     }
-    head += res;
 
-    if (allowExponential && zeros)
-    {
-        if (head + expLen > length) return 0;
-        string[head++] = 'e';
-        res = utils_intToText(zeros, string + head, length - head);
-        if (res == 0) return 0;
-        head += res;
-    }
+    if (head < length) string[head] = '\0';
 
     return head;
 }
@@ -565,6 +751,94 @@ size_t utils_objLinkToText(uint16_t objectId,
     return head + res;
 }
 
+#define PRV_LINK_DIGEST_BASIS  2166136261u
+#define PRV_LINK_DIGEST_PRIME  16777619u
+#define PRV_LINK_NUMBER_SIZE   64
+
+void utils_linkWriterInit(link_writer_t * writerP,
+                          uint8_t * buffer,
+                          size_t offset,
+                          size_t length)
+{
+    writerP->buffer = buffer;
+    writerP->offset = offset;
+    writerP->length = buffer != NULL ? length : 0;
+    writerP->head = 0;
+    writerP->digest = PRV_LINK_DIGEST_BASIS;
+}
+
+void utils_linkWrite(link_writer_t * writerP,
+                     const uint8_t * data,
+                     size_t length)
+{
+    size_t start;
+    size_t end;
+    size_t i;
+
+    for (i = 0; i < length; i++)
+    {
+        writerP->digest = (writerP->digest ^ data[i]) * PRV_LINK_DIGEST_PRIME;
+    }
+
+    // copy the part of data falling into the window
+    start = MAX(writerP->head, writerP->offset);
+    end = MIN(writerP->head + length, writerP->offset + writerP->length);
+    if (start < end)
+    {
+        memcpy(writerP->buffer + (start - writerP->offset), data + (start - writerP->head), end - start);
+    }
+
+    writerP->head += length;
+}
+
+void utils_linkWriteString(link_writer_t * writerP,
+                           const char * str)
+{
+    utils_linkWrite(writerP, (const uint8_t *)str, strlen(str));
+}
+
+int utils_linkWriteInt(link_writer_t * writerP,
+                       int64_t value)
+{
+    uint8_t string[PRV_LINK_NUMBER_SIZE];
+    size_t res;
+
+    res = utils_intToText(value, string, sizeof(string));
+    if (res == 0) return -1;
+    utils_linkWrite(writerP, string, res);
+
+    return 0;
+}
+
+int utils_linkWriteFloat(link_writer_t * writerP,
+                         double value)
+{
+    uint8_t string[PRV_LINK_NUMBER_SIZE];
+    size_t res;
+
+    res = utils_floatToText(value, string, sizeof(string), false);
+    if (res == 0) return -1;
+    utils_linkWrite(writerP, string, res);
+
+    return 0;
+}
+
+// Link-format items all end with a ',' which is not part of the payload.
+size_t utils_linkWriterTotal(const link_writer_t * writerP)
+{
+    return writerP->head > 0 ? writerP->head - 1 : 0;
+}
+
+size_t utils_linkWriterWindow(const link_writer_t * writerP)
+{
+    size_t total;
+
+    total = utils_linkWriterTotal(writerP);
+    if (total <= writerP->offset) return 0;
+
+    return MIN(total - writerP->offset, writerP->length);
+}
+
 lwm2m_version_t utils_stringToVersion(uint8_t * buffer,
                                       size_t length)
 {
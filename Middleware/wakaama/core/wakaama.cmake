@@ -25,6 +25,7 @@ set(WAKAAMA_SOURCES
     ${WAKAAMA_SOURCES_DIR}/management.c
     ${WAKAAMA_SOURCES_DIR}/observe.c
     ${WAKAAMA_SOURCES_DIR}/discover.c
+    ${WAKAAMA_SOURCES_DIR}/queue_mode.c
     ${WAKAAMA_SOURCES_DIR}/internals.h
 )
 
@@ -23,6 +23,80 @@
 
 #define _PRV_STR_LENGTH 32
 
+#if LWM2M_DATA_ARENA_SIZE > 0
+// Bump allocator for the lwm2m_data_t trees of one request or step. Between
+// data_arenaBegin() and the matching data_arenaEnd() the arrays and values
+// are carved from it and lwm2m_data_free() leaves them in place, the
+// outermost data_arenaEnd() releases them all at once. The heap takes over
+// when the arena is exhausted and outside of these scopes.
+#define _PRV_ARENA_ALIGN sizeof(int64_t)
+
+static union
+{
+    uint8_t bytes[LWM2M_DATA_ARENA_SIZE];
+    int64_t asInteger;
+    double asFloat;
+    void * asPointer;
+} prv_arena;
+static size_t prv_arenaUsed;
+static uint8_t prv_arenaDepth;
+#endif
+
+void data_arenaBegin(void)
+{
+#if LWM2M_DATA_ARENA_SIZE > 0
+    prv_arenaDepth++;
+#endif
+}
+
+void data_arenaEnd(void)
+{
+#if LWM2M_DATA_ARENA_SIZE > 0
+    if (prv_arenaDepth == 0) return;
+
+    prv_arenaDepth--;
+    if (prv_arenaDepth == 0)
+    {
+        LOG_ARG("arena high water: %d", prv_arenaUsed);
+        prv_arenaUsed = 0;
+    }
+#endif
+}
+
+void * data_allocate(size_t size)
+{
+#if LWM2M_DATA_ARENA_SIZE > 0
+    if (prv_arenaDepth != 0 && size != 0)
+    {
+        size_t length = (size + _PRV_ARENA_ALIGN - 1) & ~(_PRV_ARENA_ALIGN - 1);
+
+        if (length <= sizeof(prv_arena.bytes) - prv_arenaUsed)
+        {
+            void * memP = prv_arena.bytes + prv_arenaUsed;
+
+            prv_arenaUsed += length;
+            return memP;
+        }
+    }
+#endif
+
+    return lwm2m_malloc(size);
+}
+
+void data_release(void * memP)
+{
+#if LWM2M_DATA_ARENA_SIZE > 0
+    if ((uintptr_t)memP >= (uintptr_t)prv_arena.bytes
+     && (uintptr_t)memP < (uintptr_t)(prv_arena.bytes + sizeof(prv_arena.bytes)))
+    {
+        // released with the arena
+        return;
+    }
+#endif
+
+    lwm2m_free(memP);
+}
+
 // dataP array length is assumed to be 1.
 static int prv_textSerialize(lwm2m_data_t * dataP,
                              uint8_t ** bufferP)
@@ -142,7 +216,8 @@ static int prv_setBuffer(lwm2m_data_t * dataP,
                          const uint8_t * buffer,
                          size_t bufferLen)
 {
-    dataP->value.asBuffer.buffer = (uint8_t *)lwm2m_malloc(bufferLen);
+    dataP->isReference = false;
+    dataP->value.asBuffer.buffer = (uint8_t *)data_allocate(bufferLen);
     if (dataP->value.asBuffer.buffer == NULL)
     {
         return 0;
@@ -160,7 +235,7 @@ lwm2m_data_t * lwm2m_data_new(int size)
     LOG_ARG("size: %d", size);
     if (size <= 0) return NULL;
 
-    dataP = (lwm2m_data_t *)lwm2m_malloc(size * sizeof(lwm2m_data_t));
+    dataP = (lwm2m_data_t *)data_allocate(size * sizeof(lwm2m_data_t));
 
     if (dataP != NULL)
     {
@@ -191,9 +266,9 @@ void lwm2m_data_free(int size,
         case LWM2M_TYPE_STRING:
         case LWM2M_TYPE_OPAQUE:
         case LWM2M_TYPE_CORE_LINK:
-            if (dataP[i].value.asBuffer.buffer != NULL)
+            if (dataP[i].value.asBuffer.buffer != NULL && !dataP[i].isReference)
             {
-                lwm2m_free(dataP[i].value.asBuffer.buffer);
+                data_release(dataP[i].value.asBuffer.buffer);
             }
             break;
 
@@ -202,7 +277,7 @@ void lwm2m_data_free(int size,
             break;
         }
     }
-    lwm2m_free(dataP);
+    data_release(dataP);
 }
 
 void lwm2m_data_encode_string(const char * string,
@@ -223,6 +298,7 @@ void lwm2m_data_encode_string(const char * string,
 
     if (len == 0)
     {
+        dataP->isReference = false;
         dataP->value.asBuffer.length = 0;
         dataP->value.asBuffer.buffer = NULL;
         res = 1;
@@ -251,6 +327,7 @@ void lwm2m_data_encode_opaque(const uint8_t * buffer,
     LOG_ARG("length: %d", length);
     if (length == 0)
     {
+        dataP->isReference = false;
         dataP->value.asBuffer.length = 0;
         dataP->value.asBuffer.buffer = NULL;
         res = 1;
@@ -270,6 +347,25 @@ void lwm2m_data_encode_opaque(const uint8_t * buffer,
     }
 }
 
+void lwm2m_data_reference_string(const char * string,
+                                 lwm2m_data_t * dataP)
+{
+    LOG_ARG("\"%s\"", STR_NULL2EMPTY(string));
+    lwm2m_data_reference_opaque((const uint8_t *)string, string == NULL ? 0 : strlen(string), dataP);
+    dataP->type = LWM2M_TYPE_STRING;
+}
+
+void lwm2m_data_reference_opaque(const uint8_t * buffer,
+                                 size_t length,
+                                 lwm2m_data_t * dataP)
+{
+    LOG_ARG("length: %d", length);
+    dataP->type = LWM2M_TYPE_OPAQUE;
+    dataP->isReference = (length != 0);
+    dataP->value.asBuffer.length = length;
+    dataP->value.asBuffer.buffer = (length != 0) ? (uint8_t *)buffer : NULL;
+}
+
 void lwm2m_data_encode_nstring(const char * string,
                                size_t length,
                                lwm2m_data_t * dataP)
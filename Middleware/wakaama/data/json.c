@@ -466,7 +466,7 @@ static int prv_convertRecord(lwm2m_uri_t * uriP,
             parentP->value.asChildren.array = newRootP;
             parentP->value.asChildren.count = freeIndex;
         }
-        lwm2m_free(rootP);     /* do not use lwm2m_data_free() to keep pointed values */
+        data_release(rootP);     /* do not use lwm2m_data_free() to keep pointed values */
     }
 
     return size;
@@ -580,7 +580,7 @@ static int prv_convertRecord(const _record_t * recordArray,
         *dataP = lwm2m_data_new(freeIndex);
         if (*dataP == NULL) goto error;
         memcpy(*dataP, rootP, freeIndex * sizeof(lwm2m_data_t));
-        lwm2m_free(rootP);     /* do not use lwm2m_data_free() to keep pointed values */
+        data_release(rootP);     /* do not use lwm2m_data_free() to keep pointed values */
     }
     else
     {
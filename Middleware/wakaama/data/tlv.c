@@ -373,7 +373,7 @@ int tlv_parse(const uint8_t * buffer,
             else
             {
                 memcpy(newTlvP, *dataP, size * sizeof(lwm2m_data_t));
-                lwm2m_free(*dataP);
+                data_release(*dataP);
             }
         }
         *dataP = newTlvP;
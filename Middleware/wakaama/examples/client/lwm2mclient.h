@@ -85,6 +85,13 @@ void free_object_conn_s(lwm2m_object_t * objectP);
 extern void conn_s_updateTxStatistic(lwm2m_object_t * objectP, uint16_t txDataByte, bool smsBased);
 extern void conn_s_updateRxStatistic(lwm2m_object_t * objectP, uint16_t rxDataByte, bool smsBased);
 
+/*
+ * object_cellular_metrics.c
+ */
+#define LWM2M_CELLULAR_METRICS_OBJECT_ID    32001
+lwm2m_object_t * get_object_cellular_metrics(void);
+void free_object_cellular_metrics(lwm2m_object_t * objectP);
+
 /*
  * object_access_control.c
  */
@@ -0,0 +1,349 @@
+/*
+ *  object_cellular_metrics.c
+ *
+ *  1NCE GmbH
+ */
+
+/*
+ * This cellular metrics object is optional and single instance only.
+ * It reports the counters of platform/iot_metrics.h and uses an object ID
+ * from the private range.
+ *
+ *  Resources:
+ *
+ *          Name          | ID | Oper. | Inst. | Mand.|  Type   | Range | Units | Description                        |
+ *  AT Commands           |  0 |   R   | Multi |  No  | Integer |       |       | Per CellularATCommandType_t        |
+ *  AT Timeouts           |  1 |   R   | Single|  No  | Integer |       |       |                                    |
+ *  AT Average Latency    |  2 |   R   | Single|  No  | Integer |       |  ms   |                                    |
+ *  AT Max Latency        |  3 |   R   | Single|  No  | Integer |       |  ms   |                                    |
+ *  AT Latency Histogram  |  4 |   R   | Multi |  No  | Integer |       |       | Instance n counts [2^n, 2^(n+1)) ms |
+ *  Comm Bytes In         |  5 |   R   | Single|  No  | Integer |       | Byte  |                                    |
+ *  Comm Bytes Out        |  6 |   R   | Single|  No  | Integer |       | Byte  |                                    |
+ *  Comm Timeouts         |  7 |   R   | Single|  No  | Integer |       |       |                                    |
+ *  FIFO High Water       |  8 |   R   | Single|  No  | Integer |       | Byte  |                                    |
+ *  Socket Bytes In       |  9 |   R   | Single|  No  | Integer |       | Byte  |                                    |
+ *  Socket Bytes Out      | 10 |   R   | Single|  No  | Integer |       | Byte  |                                    |
+ *  URC Tokens            | 11 |   R   | Multi |  No  | String  |       |       |                                    |
+ *  URC Counts            | 12 |   R   | Multi |  No  | Integer |       |       | Same instance IDs as URC Tokens    |
+ *  URC Other             | 13 |   R   | Single|  No  | Integer |       |       |                                    |
+ *  Reset                 | 14 |   E   | Single|  No  |         |       |       |                                    |
+ */
+#include "nce_demo_config.h"
+#include "iot_config.h"
+#if defined( CONFIG_LwM2M_DEMO_ENABLED ) && ( IOT_METRICS_CELLULAR_ENABLED == 1 )
+
+#include "liblwm2m.h"
+#include "lwm2mclient.h"
+#include "platform/iot_metrics.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Resource Id's:
+#define RES_O_AT_COMMANDS               0
+#define RES_O_AT_TIMEOUTS               1
+#define RES_O_AT_AVERAGE_LATENCY        2
+#define RES_O_AT_MAX_LATENCY            3
+#define RES_O_AT_LATENCY_HISTOGRAM      4
+#define RES_O_COMM_BYTES_IN             5
+#define RES_O_COMM_BYTES_OUT            6
+#define RES_O_COMM_TIMEOUTS             7
+#define RES_O_FIFO_HIGH_WATER           8
+#define RES_O_SOCKET_BYTES_IN           9
+#define RES_O_SOCKET_BYTES_OUT          10
+#define RES_O_URC_TOKENS                11
+#define RES_O_URC_COUNTS                12
+#define RES_O_URC_OTHER                 13
+#define RES_E_RESET                     14
+
+// Kind of value in a multiple resource instance.
+#define MULTI_AT_COUNT                  0
+#define MULTI_HISTOGRAM                 1
+#define MULTI_URC_TOKEN                 2
+#define MULTI_URC_COUNT                 3
+
+static int64_t prv_multiValue(const IotMetricsCellular_t * metricsP, int kind, uint16_t id)
+{
+    int64_t value = 0;
+    uint32_t t;
+
+    switch (kind)
+    {
+    case MULTI_AT_COUNT:
+        value = metricsP->atCommands[id].count;
+        break;
+    case MULTI_HISTOGRAM:
+        for (t = 0; t < IOT_METRICS_CELLULAR_AT_TYPES; t++)
+        {
+            value += metricsP->atCommands[t].latencyHistogram[id];
+        }
+        break;
+    case MULTI_URC_COUNT:
+        value = metricsP->urcs[id].count;
+        break;
+    default:
+        break;
+    }
+
+    return value;
+}
+
+static uint8_t prv_encodeMulti(lwm2m_data_t * dataP, const IotMetricsCellular_t * metricsP, int kind, uint16_t maxCount)
+{
+    lwm2m_data_t * subTlvP;
+    uint16_t ids[IOT_METRICS_CELLULAR_LATENCY_BUCKETS + IOT_METRICS_CELLULAR_AT_TYPES + IOT_METRICS_CELLULAR_URC_TOKENS];
+    size_t count = 0;
+    size_t i;
+
+    if (dataP->type == LWM2M_TYPE_MULTIPLE_RESOURCE)
+    {
+        count = dataP->value.asChildren.count;
+        subTlvP = dataP->value.asChildren.array;
+        for (i = 0; i < count; i++)
+        {
+            if (subTlvP[i].id >= maxCount) return COAP_404_NOT_FOUND;
+        }
+    }
+    else
+    {
+        // Only report the URC entries in use.
+        for (i = 0; i < maxCount; i++)
+        {
+            if ((kind != MULTI_URC_TOKEN && kind != MULTI_URC_COUNT)
+             || metricsP->urcs[i].token[0] != '\0')
+            {
+                ids[count++] = (uint16_t)i;
+            }
+        }
+        subTlvP = lwm2m_data_new(count);
+        if (subTlvP == NULL) return COAP_500_INTERNAL_SERVER_ERROR;
+        for (i = 0; i < count; i++) subTlvP[i].id = ids[i];
+        lwm2m_data_encode_instances(subTlvP, count, dataP);
+    }
+
+    for (i = 0; i < count; i++)
+    {
+        if (kind == MULTI_URC_TOKEN)
+        {
+            lwm2m_data_encode_string(metricsP->urcs[subTlvP[i].id].token, subTlvP + i);
+        }
+        else
+        {
+            lwm2m_data_encode_int(prv_multiValue(metricsP, kind, subTlvP[i].id), subTlvP + i);
+        }
+    }
+
+    return COAP_205_CONTENT;
+}
+
+static uint8_t prv_set_value(lwm2m_data_t * dataP, const IotMetricsCellular_t * metricsP)
+{
+    int64_t total = 0;
+    int64_t value = 0;
+    uint32_t t;
+
+    switch (dataP->id)
+    {
+    case RES_O_AT_COMMANDS:
+        return prv_encodeMulti(dataP, metricsP, MULTI_AT_COUNT, IOT_METRICS_CELLULAR_AT_TYPES);
+    case RES_O_AT_LATENCY_HISTOGRAM:
+        return prv_encodeMulti(dataP, metricsP, MULTI_HISTOGRAM, IOT_METRICS_CELLULAR_LATENCY_BUCKETS);
+    case RES_O_URC_TOKENS:
+        return prv_encodeMulti(dataP, metricsP, MULTI_URC_TOKEN, IOT_METRICS_CELLULAR_URC_TOKENS);
+    case RES_O_URC_COUNTS:
+        return prv_encodeMulti(dataP, metricsP, MULTI_URC_COUNT, IOT_METRICS_CELLULAR_URC_TOKENS);
+    default:
+        break;
+    }
+
+    if (dataP->type == LWM2M_TYPE_MULTIPLE_RESOURCE) return COAP_404_NOT_FOUND;
+
+    switch (dataP->id)
+    {
+    case RES_O_AT_TIMEOUTS:
+        for (t = 0; t < IOT_METRICS_CELLULAR_AT_TYPES; t++) value += metricsP->atCommands[t].timeouts;
+        break;
+    case RES_O_AT_AVERAGE_LATENCY:
+        for (t = 0; t < IOT_METRICS_CELLULAR_AT_TYPES; t++)
+        {
+            value += metricsP->atCommands[t].totalLatencyMs;
+            total += metricsP->atCommands[t].count;
+        }
+        value = (total > 0) ? (value / total) : 0;
+        break;
+    case RES_O_AT_MAX_LATENCY:
+        for (t = 0; t < IOT_METRICS_CELLULAR_AT_TYPES; t++)
+        {
+            if (metricsP->atCommands[t].maxLatencyMs > value) value = metricsP->atCommands[t].maxLatencyMs;
+        }
+        break;
+    case RES_O_COMM_BYTES_IN:
+        value = metricsP->commBytesIn;
+        break;
+    case RES_O_COMM_BYTES_OUT:
+        value = metricsP->commBytesOut;
+        break;
+    case RES_O_COMM_TIMEOUTS:
+        value = metricsP->commTimeouts;
+        break;
+    case RES_O_FIFO_HIGH_WATER:
+        value = metricsP->fifoHighWater;
+        break;
+    case RES_O_SOCKET_BYTES_IN:
+        value = metricsP->socketBytesIn;
+        break;
+    case RES_O_SOCKET_BYTES_OUT:
+        value = metricsP->socketBytesOut;
+        break;
+    case RES_O_URC_OTHER:
+        value = metricsP->urcOther;
+        break;
+    case RES_E_RESET:
+        return COAP_405_METHOD_NOT_ALLOWED;
+    default:
+        return COAP_404_NOT_FOUND;
+    }
+
+    lwm2m_data_encode_int(value, dataP);
+    return COAP_205_CONTENT;
+}
+
+static uint8_t prv_read(lwm2m_context_t *contextP,
+                        uint16_t instanceId,
+                        int * numDataP,
+                        lwm2m_data_t** dataArrayP,
+                        lwm2m_object_t * objectP)
+{
+    IotMetricsCellular_t * metricsP = (IotMetricsCellular_t *) objectP->userData;
+    uint8_t result;
+    int i;
+
+    /* unused parameter */
+    (void)contextP;
+
+    // this is a single instance object
+    if (instanceId != 0)
+    {
+        return COAP_404_NOT_FOUND ;
+    }
+
+    // is the server asking for the full object ?
+    if (*numDataP == 0)
+    {
+        uint16_t resList[] = {
+                RES_O_AT_COMMANDS,
+                RES_O_AT_TIMEOUTS,
+                RES_O_AT_AVERAGE_LATENCY,
+                RES_O_AT_MAX_LATENCY,
+                RES_O_AT_LATENCY_HISTOGRAM,
+                RES_O_COMM_BYTES_IN,
+                RES_O_COMM_BYTES_OUT,
+                RES_O_COMM_TIMEOUTS,
+                RES_O_FIFO_HIGH_WATER,
+                RES_O_SOCKET_BYTES_IN,
+                RES_O_SOCKET_BYTES_OUT,
+                RES_O_URC_TOKENS,
+                RES_O_URC_COUNTS,
+                RES_O_URC_OTHER
+        };
+        int nbRes = sizeof(resList) / sizeof(uint16_t);
+
+        *dataArrayP = lwm2m_data_new(nbRes);
+        if (*dataArrayP == NULL)
+            return COAP_500_INTERNAL_SERVER_ERROR ;
+        *numDataP = nbRes;
+        for (i = 0; i < nbRes; i++)
+        {
+            (*dataArrayP)[i].id = resList[i];
+        }
+    }
+
+    // Take one snapshot so all resources of a read are consistent.
+    IotMetrics_CellularGet(metricsP);
+
+    i = 0;
+    do
+    {
+        result = prv_set_value((*dataArrayP) + i, metricsP);
+        i++;
+    } while (i < *numDataP && result == COAP_205_CONTENT );
+
+    return result;
+}
+
+static uint8_t prv_exec(lwm2m_context_t *contextP,
+                        uint16_t instanceId,
+                        uint16_t resourceId,
+                        uint8_t * buffer,
+                        int length,
+                        lwm2m_object_t * objectP)
+{
+    /* unused parameter */
+    (void)contextP;
+    (void)buffer;
+    (void)objectP;
+
+    // this is a single instance object
+    if (instanceId != 0)
+    {
+        return COAP_404_NOT_FOUND;
+    }
+
+    if (length != 0) return COAP_400_BAD_REQUEST;
+
+    switch (resourceId)
+    {
+    case RES_E_RESET:
+        IotMetrics_CellularReset();
+        return COAP_204_CHANGED;
+    default:
+        return COAP_405_METHOD_NOT_ALLOWED;
+    }
+}
+
+lwm2m_object_t * get_object_cellular_metrics(void)
+{
+    lwm2m_object_t * metricsObj;
+
+    metricsObj = (lwm2m_object_t *) lwm2m_malloc(sizeof(lwm2m_object_t));
+
+    if (NULL != metricsObj)
+    {
+        memset(metricsObj, 0, sizeof(lwm2m_object_t));
+
+        metricsObj->objID = LWM2M_CELLULAR_METRICS_OBJECT_ID;
+        metricsObj->instanceList = lwm2m_malloc(sizeof(lwm2m_list_t));
+        if (NULL != metricsObj->instanceList)
+        {
+            memset(metricsObj->instanceList, 0, sizeof(lwm2m_list_t));
+        }
+        else {
+            lwm2m_free(metricsObj);
+            return NULL;
+        }
+
+        metricsObj->readFunc     = prv_read;
+        metricsObj->executeFunc  = prv_exec;
+
+        // The snapshot buffer is kept with the object rather than on the stack.
+        metricsObj->userData     = lwm2m_malloc(sizeof(IotMetricsCellular_t));
+
+        if (NULL == metricsObj->userData)
+        {
+            lwm2m_list_free(metricsObj->instanceList);
+            lwm2m_free(metricsObj);
+            metricsObj = NULL;
+        }
+    }
+    return metricsObj;
+}
+
+void free_object_cellular_metrics(lwm2m_object_t * objectP)
+{
+    lwm2m_free(objectP->userData);
+    lwm2m_list_free(objectP->instanceList);
+    lwm2m_free(objectP);
+}
+
+#endif
@@ -225,7 +225,7 @@ static uint8_t prv_set_value(lwm2m_data_t * dataP,
             switch (subTlvP[i].id)
             {
             case 0:
-                lwm2m_data_encode_string(VALUE_APN_1, subTlvP + i);
+                lwm2m_data_reference_string(VALUE_APN_1, subTlvP + i);
                 break;
             default:
                 return COAP_404_NOT_FOUND;
@@ -175,22 +175,22 @@ static uint8_t prv_set_value(lwm2m_data_t * dataP,
     {
     case RES_O_MANUFACTURER:
         if (dataP->type == LWM2M_TYPE_MULTIPLE_RESOURCE) return COAP_404_NOT_FOUND;
-        lwm2m_data_encode_string(PRV_MANUFACTURER, dataP);
+        lwm2m_data_reference_string(PRV_MANUFACTURER, dataP);
         return COAP_205_CONTENT;
 
     case RES_O_MODEL_NUMBER:
         if (dataP->type == LWM2M_TYPE_MULTIPLE_RESOURCE) return COAP_404_NOT_FOUND;
-        lwm2m_data_encode_string(PRV_MODEL_NUMBER, dataP);
+        lwm2m_data_reference_string(PRV_MODEL_NUMBER, dataP);
         return COAP_205_CONTENT;
 
     case RES_O_SERIAL_NUMBER:
         if (dataP->type == LWM2M_TYPE_MULTIPLE_RESOURCE) return COAP_404_NOT_FOUND;
-        lwm2m_data_encode_string(PRV_SERIAL_NUMBER, dataP);
+        lwm2m_data_reference_string(PRV_SERIAL_NUMBER, dataP);
         return COAP_205_CONTENT;
 
     case RES_O_FIRMWARE_VERSION:
         if (dataP->type == LWM2M_TYPE_MULTIPLE_RESOURCE) return COAP_404_NOT_FOUND;
-        lwm2m_data_encode_string(PRV_FIRMWARE_VERSION, dataP);
+        lwm2m_data_reference_string(PRV_FIRMWARE_VERSION, dataP);
         return COAP_205_CONTENT;
 
     case RES_M_REBOOT:
@@ -352,12 +352,12 @@ static uint8_t prv_set_value(lwm2m_data_t * dataP,
 
     case RES_O_TIMEZONE:
         if (dataP->type == LWM2M_TYPE_MULTIPLE_RESOURCE) return COAP_404_NOT_FOUND;
-        lwm2m_data_encode_string(PRV_TIME_ZONE, dataP);
+        lwm2m_data_reference_string(PRV_TIME_ZONE, dataP);
         return COAP_205_CONTENT;
       
     case RES_M_BINDING_MODES:
         if (dataP->type == LWM2M_TYPE_MULTIPLE_RESOURCE) return COAP_404_NOT_FOUND;
-        lwm2m_data_encode_string(PRV_BINDING_MODE, dataP);
+        lwm2m_data_reference_string(PRV_BINDING_MODE, dataP);
         return COAP_205_CONTENT;
 
     default:
@@ -116,6 +116,10 @@ connection_t * connection_create(connection_t * connList,
     {
          if ( SOCKETS_Connect( socket, &ServerAddress, sizeof( ServerAddress ) ) == 0 )
          {
+            /* The client receives once SOCKETS_Poll() reported data, a read
+             * that finds none should return right away. */
+            TickType_t recvTimeout = 1;
+            SOCKETS_SetSockOpt( socket, 0, SOCKETS_SO_RCVTIMEO, &recvTimeout, sizeof( recvTimeout ) );
           	connP = connection_new_incoming(connList, socket, sa, sizeof( ServerAddress ));
          }
     }
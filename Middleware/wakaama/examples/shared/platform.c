@@ -67,7 +67,8 @@ int lwm2m_strcasecmp(const char * str1, const char * str2) {
 
 time_t lwm2m_gettime(void)
 {
-    return xTaskGetTickCount();
+    // Seconds, the unit of every timer of the library.
+    return (time_t)(xTaskGetTickCount() / configTICK_RATE_HZ);
 }
 
 void lwm2m_printf(const char * format, ...)
@@ -88,10 +88,16 @@
 
 /* Set the library name to print with the demos. */
     #define LIBRARY_LOG_NAME        ( "LwM2M" )
+    #ifndef LIBRARY_LOG_MODULE
+        #define LIBRARY_LOG_MODULE    IOT_LOG_MODULE_LwM2M
+    #endif
 #else  /* if defined( CONFIG_LwM2M_DEMO_ENABLED ) */
     #ifndef LIBRARY_LOG_NAME
         #define LIBRARY_LOG_NAME    "COAP"
     #endif
+    #ifndef LIBRARY_LOG_MODULE
+        #define LIBRARY_LOG_MODULE    IOT_LOG_MODULE_COAP
+    #endif
 
     #ifdef IOT_LOG_LEVEL_COAP
         #define LIBRARY_LOG_LEVEL        IOT_LOG_LEVEL_COAP
@@ -416,12 +422,19 @@ typedef enum
     LWM2M_TYPE_CORE_LINK
 } lwm2m_data_type_t;
 
+/* Size in bytes of the arena the lwm2m_data_t trees of a request or a step are */
+/* allocated from, see data_arenaBegin(). 0 allocates them from the heap. */
+#ifndef LWM2M_DATA_ARENA_SIZE
+    #define LWM2M_DATA_ARENA_SIZE    1024
+#endif
+
 typedef struct _lwm2m_data_t lwm2m_data_t;
 
 struct _lwm2m_data_t
 {
     lwm2m_data_type_t type;
     uint16_t id;
+    bool isReference; /* value.asBuffer belongs to the caller and is not freed, see lwm2m_data_reference_string() */
     union
     {
         bool asBoolean;
@@ -484,6 +497,13 @@ void lwm2m_data_encode_nstring( const char * string,
 void lwm2m_data_encode_opaque( const uint8_t * buffer,
                                size_t length,
                                lwm2m_data_t * dataP );
+/* Same as lwm2m_data_encode_string() and lwm2m_data_encode_opaque() without copying the value. */
+/* The buffer must stay valid and unchanged until the data is freed, e.g. a constant or a buffer of the object. */
+void lwm2m_data_reference_string( const char * string,
+                                  lwm2m_data_t * dataP );
+void lwm2m_data_reference_opaque( const uint8_t * buffer,
+                                  size_t length,
+                                  lwm2m_data_t * dataP );
 void lwm2m_data_encode_int( int64_t value,
                             lwm2m_data_t * dataP );
 int lwm2m_data_decode_int( const lwm2m_data_t * dataP,
@@ -726,6 +746,8 @@ typedef struct _lwm2m_server_
     void * sessionH;
     lwm2m_status_t status;
     char * location;
+    char * query;                         /* registration query, built once and kept until lifetime or binding change */
+    uint32_t payloadVersion;              /* version of the registered object list acknowledged by the server */
     bool dirty;
     lwm2m_block_data_t * blockData;      /* list to handle temporary block data. */
     #ifndef LWM2M_VERSION_1_0
@@ -847,10 +869,40 @@ typedef struct _lwm2m_client_
 
 typedef struct _lwm2m_transaction_ lwm2m_transaction_t;
 
+/* Number of transactions taken from a static pool, see transaction_new(). */
+/* The heap takes over when they are all in use. 0 allocates them from the heap. */
+/* Each slot is a static lwm2m_transaction_t, coap_packet_t and message buffer. */
+#ifndef LWM2M_TRANSACTION_POOL_SIZE
+    #define LWM2M_TRANSACTION_POOL_SIZE    4
+#endif
+
+/* Size in bytes of the message buffer of a pooled transaction: one block of */
+/* payload and room for the CoAP header and options. */
+#ifndef LWM2M_TRANSACTION_BUFFER_SIZE
+    #ifdef LWM2M_COAP_DEFAULT_BLOCK_SIZE
+        #define LWM2M_TRANSACTION_BUFFER_SIZE    ( LWM2M_COAP_DEFAULT_BLOCK_SIZE + 128 )
+    #else
+        #define LWM2M_TRANSACTION_BUFFER_SIZE    ( 1024 + 128 )
+    #endif
+#endif
+
+/* Size in bytes of the cache replaying the responses to retransmitted requests */
+/* for EXCHANGE_LIFETIME, see lwm2m_handle_packet(). 0 disables it. */
+#ifndef LWM2M_COAP_DEDUP_CACHE_SIZE
+    #define LWM2M_COAP_DEDUP_CACHE_SIZE    512
+#endif
+
 typedef void (*lwm2m_transaction_callback_t) ( lwm2m_context_t * contextP,
                                                lwm2m_transaction_t * transacP,
                                                void * message );
 
+/* Copy the length bytes at offset of a payload generated on demand into buffer.
+ * Returns the number of bytes copied, less than length on failure. */
+typedef size_t (*lwm2m_payload_source_t) ( void * sourceData,
+                                           size_t offset,
+                                           uint8_t * buffer,
+                                           size_t length );
+
 struct _lwm2m_transaction_
 {
     lwm2m_transaction_t * next;  /* matches lwm2m_list_t::next */
@@ -860,12 +912,15 @@ struct _lwm2m_transaction_
     time_t response_timeout;     /* timeout to wait for response, if token is used. When 0, use calculated acknowledge timeout. */
     uint8_t retrans_counter;
     time_t retrans_time;
+    lwm2m_transaction_t * timerNext; /* next transaction to retransmit, sorted by retrans_time */
     void * message;
     uint16_t buffer_len;
     uint8_t * buffer;
     size_t
         payload_len;   /* the length of the entire payload, message payload might be smaller in case of a block1 transfer */
     uint8_t * payload; /* carries the entire payload across multiple transactions in case of a block 1 transfer */
+    lwm2m_payload_source_t payloadSource; /* when set, payload only holds the block being sent, the others are generated by it */
+    void * payloadSourceData;
     lwm2m_transaction_callback_t callback;
     void * userData;
 };
@@ -915,6 +970,41 @@ typedef struct _lwm2m_observed_
         STATE_READY
     } lwm2m_client_state_t;
 
+    #ifdef LWM2M_CLIENT_QUEUE_MODE
+
+/* Number of notifications and Send operations kept while the client sleeps. */
+        #ifndef LWM2M_QUEUE_MODE_LENGTH
+            #define LWM2M_QUEUE_MODE_LENGTH    8
+        #endif
+
+/* Seconds the client stays reachable after its last exchange with a server */
+/* before it sleeps. MAX_TRANSMIT_WAIT, the default of the Queue Mode spec. */
+        #ifndef LWM2M_QUEUE_MODE_AWAKE_TIME
+            #define LWM2M_QUEUE_MODE_AWAKE_TIME    93
+        #endif
+
+        typedef enum
+        {
+            QUEUE_MODE_AWAKE = 0, /* messages are sent right away */
+            QUEUE_MODE_SLEEPING,  /* notifications and Send operations are kept */
+            QUEUE_MODE_WAKING     /* registration update sent, kept messages follow */
+        } lwm2m_queue_mode_state_t;
+
+/* A notification or Send operation kept while sleeping. A notification is kept */
+/* as the serialized CoAP message, a Send operation as its payload. */
+        typedef struct
+        {
+            bool isSend;
+            void * sessionH;
+            lwm2m_uri_t uri;           /* Send operation only */
+            lwm2m_media_type_t format; /* Send operation only */
+            uint8_t * buffer;
+            size_t length;
+            time_t time; /* when it was kept */
+        } lwm2m_queued_message_t;
+
+    #endif /* ifdef LWM2M_CLIENT_QUEUE_MODE */
+
 #endif /* ifdef LWM2M_CLIENT_MODE */
 
 /*
@@ -952,6 +1042,17 @@ struct _lwm2m_context_
         lwm2m_server_t * serverList;
         lwm2m_object_t * objectList;
         lwm2m_observed_t * observedList;
+        size_t registerPayloadLength;    /* object list sent with registrations, generated block by block */
+        uint32_t registerPayloadDigest;  /* of the object list, to tell whether it changed */
+        uint32_t registerPayloadVersion; /* changes with the content of the object list */
+        bool registerPayloadStale;       /* objects or instances changed since the object list was measured */
+        #ifdef LWM2M_CLIENT_QUEUE_MODE
+            lwm2m_queue_mode_state_t queueState;
+            time_t lastExchange;
+            lwm2m_queued_message_t queue[ LWM2M_QUEUE_MODE_LENGTH ];
+            uint8_t queueHead;
+            uint8_t queueCount;
+        #endif
     #endif
     #if defined( LWM2M_SERVER_MODE ) || defined( LWM2M_BOOTSTRAP_SERVER_MODE )
         lwm2m_client_t * clientList;
@@ -966,6 +1067,7 @@ struct _lwm2m_context_
     #endif
     uint16_t nextMID;
     lwm2m_transaction_t * transactionList;
+    lwm2m_transaction_t * transactionTimers; /* sent transactions waiting for an ACK or a response, earliest retrans_time first */
     void * userData;
 };
 
@@ -1013,6 +1115,19 @@ void lwm2m_handle_packet( lwm2m_context_t * contextP,
     void lwm2m_deregister( lwm2m_context_t * context );
     void lwm2m_resource_value_changed( lwm2m_context_t * contextP,
                                        lwm2m_uri_t * uriP );
+
+    #ifdef LWM2M_CLIENT_QUEUE_MODE
+/* Queue Mode: when every server has the Q binding, the client sleeps once it exchanged */
+/* nothing for LWM2M_QUEUE_MODE_AWAKE_TIME seconds. While it sleeps, notifications and */
+/* Send operations are kept in order instead of being sent. */
+/* Wake up: announce it with a registration update to every server and send the kept */
+/* messages in order once the update is acknowledged. */
+        int lwm2m_queue_mode_wake( lwm2m_context_t * contextP );
+/* return the number of kept messages. If oldestP is not nil, it is set to the time the */
+/* oldest one was kept. */
+        size_t lwm2m_queue_mode_pending( lwm2m_context_t * contextP,
+                                         time_t * oldestP );
+    #endif
 #endif /* ifdef LWM2M_CLIENT_MODE */
 
 #ifdef LWM2M_SERVER_MODE
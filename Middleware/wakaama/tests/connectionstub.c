@@ -0,0 +1,43 @@
+/*******************************************************************************
+ *
+ * Stands in for the connection of examples/shared and records what is sent.
+ *
+ * 1NCE GmbH
+ *
+ *******************************************************************************/
+
+#include "tests.h"
+#include "internals.h"
+
+int test_sendCount;
+size_t test_sentLength;
+uint8_t test_sent[TEST_SENT_SIZE];
+uint16_t test_sentMid[TEST_SENT_COUNT];
+
+uint8_t lwm2m_buffer_send(void * sessionH,
+                          uint8_t * buffer,
+                          size_t length,
+                          void * userdata)
+{
+    (void)sessionH;
+    (void)userdata;
+
+    if (test_sendCount < TEST_SENT_COUNT && length >= 4)
+    {
+        test_sentMid[test_sendCount] = (uint16_t)((buffer[2] << 8) | buffer[3]);
+    }
+    test_sendCount++;
+    test_sentLength = length;
+    if (length <= sizeof(test_sent)) memcpy(test_sent, buffer, length);
+
+    return COAP_NO_ERROR;
+}
+
+bool lwm2m_session_is_equal(void * session1,
+                            void * session2,
+                            void * userData)
+{
+    (void)userData;
+
+    return (session1 == session2);
+}
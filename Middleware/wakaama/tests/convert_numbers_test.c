@@ -27,14 +27,15 @@
 #include <stdio.h>
 #include <inttypes.h>
 #include <float.h>
+#include <math.h>
 
-static const int64_t ints[]={12, -114 , 1 , 134 , 43243 , 0, -215025, INT64_MIN, INT64_MAX};
-static const char* ints_text[] = {"12","-114","1", "134", "43243","0","-215025", "-9223372036854775808", "9223372036854775807"};
-static const uint64_t uints[]={12, 1 , 134 , 43243 , 0, UINT64_MAX};
-static const char* uints_text[] = {"12","1", "134", "43243","0","18446744073709551615"};
+static const int64_t ints[]={12, -114 , 1 , 134 , 43243 , 0, -215025, -4294967296LL, INT64_MIN, INT64_MAX};
+static const char* ints_text[] = {"12","-114","1", "134", "43243","0","-215025", "-4294967296", "-9223372036854775808", "9223372036854775807"};
+static const uint64_t uints[]={12, 1 , 134 , 43243 , 0, 9, 10, 99, 100, UINT32_MAX, (uint64_t)UINT32_MAX + 1, UINT64_MAX};
+static const char* uints_text[] = {"12","1", "134", "43243","0", "9", "10", "99", "100", "4294967295", "4294967296", "18446744073709551615"};
 static const double floats[]={12, -114 , -30 , 1.02 , 134.000235 , 0.43243 , 0, -21.5025, -0.0925, 0.98765, 6.667e-11, 56.789, -52.0006, FLT_MIN, FLT_MAX, DBL_MIN, DBL_MAX};
 static const char* floats_text[] = {"12.0","-114.0","-30.0", "1.02", "134.000235","0.43243","0.0","-21.5025","-0.0925","0.98765", "0.00000000006667", "56.789", "-52.0006", "0.00000000000000000000000000000000000001175494", "340282346638528859811704183484516925440.0", "0.00000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000002225073858", "179769313486231570814527423731704356798070567525844996598917476803157260780028538760589558632766878171540458953514382464234321326889464182768467546703537516986049910576551282076245490090389328944075868508455133942304583236903222948165808559332123348274797826204144723168738177180919299881250404026184124858368.0"};
-static const char* floats_exponential[] = {"12.0","-114.0","-30.0", "1.02", "134.000235","0.43243","0.0","-21.5025","-0.0925","0.98765", "6.667e-11", "56.789", "-52.0006", "1.17549435082229e-38", "3.40282346638529e38", "2.2250738585072e-308", "1.7976931348623e308"};
+static const char* floats_exponential[] = {"12.0","-114.0","-30.0", "1.02", "134.000235","0.43243","0.0","-21.5025","-0.0925","0.98765", "6.667e-11", "56.789", "-52.0006", "1.1754943508222875e-38", "3.4028234663852886e38", "2.2250738585072014e-308", "1.7976931348623157e308"};
 
 static void test_utils_textToInt(void)
 {
@@ -382,6 +383,88 @@ static void test_utils_floatToTextExponential(void)
     {
         printf("%zu \"%g\" -> fail\n", i, val);
     }
+    i++;
+
+    /* Rounding shortens the exponent */
+    val = 9.99e-10;
+    len = utils_floatToText(val, (uint8_t*)res, 6, true);
+    CU_ASSERT(len == 6)
+    if(len)
+    {
+        CU_ASSERT_NSTRING_EQUAL(res, "1.0e-9", 6)
+        if (strncmp(res, "1.0e-9", 6))
+            printf("%zu \"%g\" -> fail (%.*s)\n", i, val, len, res);
+    }
+    else
+    {
+        printf("%zu \"%g\" -> fail\n", i, val);
+    }
+}
+
+static void test_utils_floatToTextRoundTrip_1(double val)
+{
+    char res[330];
+    double back;
+    int len;
+    int exponential;
+
+    for (exponential = 0; exponential < 2; exponential++)
+    {
+        len = utils_floatToText(val, (uint8_t*)res, sizeof(res), exponential);
+        CU_ASSERT(len)
+        if (!len)
+        {
+            printf("%.17g -> fail\n", val);
+            continue;
+        }
+        CU_ASSERT(utils_textToFloat((uint8_t*)res, len, &back, exponential))
+        /* -0.0 is written as 0.0, everything else has to come back bit
+         * for bit. */
+        if (fpclassify(back) == FP_ZERO && fpclassify(val) == FP_ZERO) back = val;
+        CU_ASSERT_EQUAL(memcmp(&back, &val, sizeof(val)), 0)
+        if (memcmp(&back, &val, sizeof(val)))
+            printf("%.17g -> fail (%.*s)\n", val, len, res);
+    }
+}
+
+static void test_utils_floatToTextRoundTrip(void)
+{
+    uint64_t state = 0x9E3779B97F4A7C15ULL;
+    uint64_t bits;
+    uint32_t floatBits;
+    float single;
+    double val;
+    int i;
+
+    /* Every binary exponent of a single, with a spread of significands */
+    for (floatBits = 0; floatBits < 0x7F800000; floatBits += 0x1FFF)
+    {
+        memcpy(&single, &floatBits, sizeof(single));
+        test_utils_floatToTextRoundTrip_1(single);
+    }
+
+    /* Random doubles, including subnormals */
+    for (i = 0; i < 100000; i++)
+    {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        bits = state;
+        memcpy(&val, &bits, sizeof(val));
+        if (isnan(val) || isinf(val)) continue;
+        test_utils_floatToTextRoundTrip_1(val);
+    }
+
+    /* Decimal fractions as sensors report them */
+    for (i = -10000; i <= 10000; i++)
+    {
+        test_utils_floatToTextRoundTrip_1(i / 100.0);
+        test_utils_floatToTextRoundTrip_1(i * 0.001);
+    }
+
+    test_utils_floatToTextRoundTrip_1(DBL_MIN / FLT_RADIX);
+    test_utils_floatToTextRoundTrip_1(DBL_MIN * DBL_EPSILON);
+    test_utils_floatToTextRoundTrip_1(DBL_MAX);
 }
 
 static void test_utils_objLinkToText(void)
@@ -440,6 +523,7 @@ static struct TestTable table[] = {
         { "test of utils_uintToText()", test_utils_uintToText },
         { "test of utils_floatToText()", test_utils_floatToText },
         { "test of utils_floatToText(exponential)", test_utils_floatToTextExponential },
+        { "test of utils_floatToText(round trip)", test_utils_floatToTextRoundTrip },
         { "test of utils_objLinkToText()", test_utils_objLinkToText },
         { "test of base64 functions", test_utils_base64 },
         { NULL, NULL },
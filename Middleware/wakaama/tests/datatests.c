@@ -0,0 +1,198 @@
+/*******************************************************************************
+ *
+ * Tests of the arena the lwm2m_data_t trees are allocated from (data.c).
+ *
+ * 1NCE GmbH
+ *
+ *******************************************************************************/
+
+#include "tests.h"
+#include "CUnit/Basic.h"
+#include "internals.h"
+#include "memtest.h"
+
+#if LWM2M_DATA_ARENA_SIZE > 0
+// The first allocation of a scope starts the arena.
+static bool prv_inArena(const void * arenaP,
+                        const void * memP)
+{
+    return (uintptr_t)memP >= (uintptr_t)arenaP
+        && (uintptr_t)memP < (uintptr_t)arenaP + LWM2M_DATA_ARENA_SIZE;
+}
+
+static void test_data_arenaScope(void)
+{
+    lwm2m_data_t * firstP;
+    lwm2m_data_t * dataP;
+    lwm2m_data_t * nextP;
+
+    data_arenaBegin();
+    firstP = lwm2m_data_new(2);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(firstP);
+    lwm2m_data_encode_string("arena", firstP);
+    lwm2m_data_encode_int(7, firstP + 1);
+    CU_ASSERT_TRUE(prv_inArena(firstP, firstP->value.asBuffer.buffer));
+
+    // freed values stay in place until the scope ends
+    lwm2m_data_free(2, firstP);
+    CU_ASSERT_EQUAL(firstP->type, LWM2M_TYPE_STRING);
+    CU_ASSERT_NSTRING_EQUAL(firstP->value.asBuffer.buffer, "arena", 5);
+    CU_ASSERT_EQUAL(firstP[1].value.asInteger, 7);
+
+    dataP = lwm2m_data_new(1);
+    CU_ASSERT_TRUE(prv_inArena(firstP, dataP));
+    CU_ASSERT_TRUE(dataP > firstP + 1);
+
+    // only the outermost scope releases the arena
+    data_arenaBegin();
+    data_arenaEnd();
+    nextP = lwm2m_data_new(1);
+    CU_ASSERT_TRUE(prv_inArena(firstP, nextP));
+    CU_ASSERT_TRUE(nextP > dataP);
+    lwm2m_data_free(1, nextP);
+    lwm2m_data_free(1, dataP);
+    data_arenaEnd();
+
+    data_arenaBegin();
+    dataP = lwm2m_data_new(1);
+    CU_ASSERT_PTR_EQUAL(dataP, firstP);
+    lwm2m_data_free(1, dataP);
+    data_arenaEnd();
+
+    // unbalanced ends are ignored
+    data_arenaEnd();
+    data_arenaBegin();
+    dataP = lwm2m_data_new(1);
+    CU_ASSERT_PTR_EQUAL(dataP, firstP);
+    data_arenaEnd();
+}
+
+static void test_data_arenaFallback(void)
+{
+    static const uint8_t bytes[LWM2M_DATA_ARENA_SIZE] = { 0 };
+    lwm2m_data_t * firstP;
+    lwm2m_data_t * bigP;
+    lwm2m_data_t * dataP;
+    int count;
+
+    MEMORY_TRACE_BEFORE;
+
+    data_arenaBegin();
+    firstP = lwm2m_data_new(1);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(firstP);
+
+    // too large for the arena
+    bigP = lwm2m_data_new(LWM2M_DATA_ARENA_SIZE / sizeof(lwm2m_data_t) + 1);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(bigP);
+    CU_ASSERT_FALSE(prv_inArena(firstP, bigP));
+    // its values still fit
+    lwm2m_data_encode_string("arena", bigP);
+    CU_ASSERT_TRUE(prv_inArena(firstP, bigP->value.asBuffer.buffer));
+
+    // the arena keeps serving what fits
+    dataP = lwm2m_data_new(1);
+    CU_ASSERT_TRUE(prv_inArena(firstP, dataP));
+
+    // until it is exhausted
+    for (count = 0; count < LWM2M_DATA_ARENA_SIZE && prv_inArena(firstP, dataP); count++)
+    {
+        dataP = lwm2m_data_new(1);
+        CU_ASSERT_PTR_NOT_NULL_FATAL(dataP);
+    }
+    CU_ASSERT_FALSE(prv_inArena(firstP, dataP));
+    lwm2m_data_encode_opaque(bytes, sizeof(bytes), dataP);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(dataP->value.asBuffer.buffer);
+    CU_ASSERT_FALSE(prv_inArena(firstP, dataP->value.asBuffer.buffer));
+
+    // heap blocks are freed right away
+    lwm2m_data_free(1, dataP);
+    lwm2m_data_free(LWM2M_DATA_ARENA_SIZE / sizeof(lwm2m_data_t) + 1, bigP);
+    data_arenaEnd();
+
+    // outside of a scope everything comes from the heap
+    dataP = lwm2m_data_new(1);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(dataP);
+    CU_ASSERT_FALSE(prv_inArena(firstP, dataP));
+    lwm2m_data_free(1, dataP);
+
+    MEMORY_TRACE_AFTER_EQ;
+}
+#endif
+
+static void test_data_reference(void)
+{
+    static const char text[] = "reference";
+    static const uint8_t bytes[] = { 1, 2, 3 };
+    lwm2m_data_t * dataP;
+    lwm2m_data_t * childP;
+    int i;
+
+    MEMORY_TRACE_BEFORE;
+
+    for (i = 0; i < 2; i++)
+    {
+        // from the heap, then from the arena
+        if (i == 1) data_arenaBegin();
+
+        dataP = lwm2m_data_new(2);
+        CU_ASSERT_PTR_NOT_NULL_FATAL(dataP);
+        childP = lwm2m_data_new(1);
+        CU_ASSERT_PTR_NOT_NULL_FATAL(childP);
+
+        lwm2m_data_reference_string(text, dataP);
+        CU_ASSERT_TRUE(dataP->isReference);
+        CU_ASSERT_EQUAL(dataP->type, LWM2M_TYPE_STRING);
+        CU_ASSERT_PTR_EQUAL(dataP->value.asBuffer.buffer, text);
+
+        lwm2m_data_reference_opaque(bytes, sizeof(bytes), childP);
+        lwm2m_data_include(childP, 1, dataP + 1);
+        CU_ASSERT_TRUE(childP->isReference);
+
+        // the referenced buffers are not freed, they are not even heap blocks
+        lwm2m_data_free(2, dataP);
+        CU_ASSERT_EQUAL(text[0], 'r');
+        CU_ASSERT_EQUAL(bytes[0], 1);
+
+        if (i == 1) data_arenaEnd();
+    }
+
+    // an encoded copy replaces the reference and is freed again
+    dataP = lwm2m_data_new(1);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(dataP);
+    lwm2m_data_reference_string(text, dataP);
+    lwm2m_data_encode_string(text, dataP);
+    CU_ASSERT_FALSE(dataP->isReference);
+    CU_ASSERT_PTR_NOT_EQUAL(dataP->value.asBuffer.buffer, text);
+    lwm2m_data_free(1, dataP);
+
+    // empty references point nowhere
+    dataP = lwm2m_data_new(1);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(dataP);
+    lwm2m_data_reference_string(NULL, dataP);
+    CU_ASSERT_FALSE(dataP->isReference);
+    CU_ASSERT_PTR_NULL(dataP->value.asBuffer.buffer);
+    lwm2m_data_free(1, dataP);
+
+    MEMORY_TRACE_AFTER_EQ;
+}
+
+static struct TestTable table[] = {
+#if LWM2M_DATA_ARENA_SIZE > 0
+        { "test of data_arenaBegin() scopes", test_data_arenaScope },
+        { "test of data_arenaBegin() heap fallback", test_data_arenaFallback },
+#endif
+        { "test of lwm2m_data_reference_string()", test_data_reference },
+        { NULL, NULL },
+};
+
+CU_ErrorCode create_data_suit()
+{
+   CU_pSuite pSuite = NULL;
+
+   pSuite = CU_add_suite("Suite_Data", NULL, NULL);
+   if (NULL == pSuite) {
+      return CU_get_error();
+   }
+
+   return add_tests(pSuite, table);
+}
@@ -0,0 +1,144 @@
+/*******************************************************************************
+ *
+ * Tests of the link-format writer (utils.c) and of the Discover payloads
+ * generated through it (discover.c).
+ *
+ * 1NCE GmbH
+ *
+ *******************************************************************************/
+
+#include "tests.h"
+#include "CUnit/Basic.h"
+#include "internals.h"
+#include "memtest.h"
+
+static const char * prv_items[] = { "</3/0>,", "</3/0/0>,", "</3/0/1>;pmin=10,", "</3/0/6>;dim=2," };
+static const char * prv_payload = "</3/0>,</3/0/0>,</3/0/1>;pmin=10,</3/0/6>;dim=2";
+
+static void prv_writeItems(link_writer_t * writerP)
+{
+    size_t i;
+
+    for (i = 0; i < sizeof(prv_items) / sizeof(prv_items[0]); i++)
+    {
+        utils_linkWriteString(writerP, prv_items[i]);
+    }
+}
+
+static void test_link_writer_measure(void)
+{
+    link_writer_t measure;
+    link_writer_t full;
+    uint8_t buffer[64];
+
+    utils_linkWriterInit(&measure, NULL, 0, 0);
+    prv_writeItems(&measure);
+    CU_ASSERT_EQUAL(utils_linkWriterTotal(&measure), strlen(prv_payload));
+    CU_ASSERT_EQUAL(utils_linkWriterWindow(&measure), 0);
+
+    utils_linkWriterInit(&full, buffer, 0, sizeof(buffer));
+    prv_writeItems(&full);
+    CU_ASSERT_EQUAL(utils_linkWriterWindow(&full), strlen(prv_payload));
+    CU_ASSERT_NSTRING_EQUAL(buffer, prv_payload, strlen(prv_payload));
+    CU_ASSERT_EQUAL(full.digest, measure.digest);
+}
+
+static void test_link_writer_blocks(void)
+{
+    link_writer_t writer;
+    uint8_t block[16];
+    uint8_t payload[64];
+    size_t offset;
+    size_t length;
+
+    // concatenating the blocks gives the whole payload back
+    offset = 0;
+    do
+    {
+        utils_linkWriterInit(&writer, block, offset, sizeof(block));
+        prv_writeItems(&writer);
+        length = utils_linkWriterWindow(&writer);
+        memcpy(payload + offset, block, length);
+        offset += length;
+    } while (length == sizeof(block));
+
+    CU_ASSERT_EQUAL(offset, strlen(prv_payload));
+    CU_ASSERT_NSTRING_EQUAL(payload, prv_payload, strlen(prv_payload));
+
+    utils_linkWriterInit(&writer, block, strlen(prv_payload), sizeof(block));
+    prv_writeItems(&writer);
+    CU_ASSERT_EQUAL(utils_linkWriterWindow(&writer), 0);
+}
+
+static void test_link_writer_digest(void)
+{
+    link_writer_t first;
+    link_writer_t second;
+
+    utils_linkWriterInit(&first, NULL, 0, 0);
+    prv_writeItems(&first);
+
+    utils_linkWriterInit(&second, NULL, 0, 0);
+    utils_linkWriteString(&second, "</3/0>,</3/0/0>,</3/0/1>;pmin=11,</3/0/6>;dim=2,");
+    CU_ASSERT_EQUAL(utils_linkWriterTotal(&second), utils_linkWriterTotal(&first));
+    CU_ASSERT_NOT_EQUAL(second.digest, first.digest);
+}
+
+static void test_discover_serialize(void)
+{
+    lwm2m_data_t * dataP;
+    lwm2m_data_t * childrenP;
+    lwm2m_uri_t uri;
+    uint8_t * buffer = NULL;
+    uint8_t block[8];
+    size_t total = 0;
+    int length;
+
+    MEMORY_TRACE_BEFORE;
+
+    LWM2M_URI_RESET(&uri);
+    uri.objectId = 3;
+    uri.instanceId = 0;
+
+    dataP = lwm2m_data_new(2);
+    dataP[0].id = 0;
+    dataP[1].id = 6;
+    childrenP = lwm2m_data_new(2);
+    childrenP[0].id = 0;
+    childrenP[1].id = 1;
+    lwm2m_data_encode_instances(childrenP, 2, dataP + 1);
+
+    length = discover_serialize(NULL, &uri, NULL, 2, dataP, &buffer);
+    CU_ASSERT_EQUAL(length, 30);
+    CU_ASSERT_NSTRING_EQUAL(buffer, "</3/0>,</3/0/0>,</3/0/6>;dim=2", length);
+    lwm2m_free(buffer);
+
+    length = discover_serializeBlock(NULL, &uri, NULL, 2, dataP, 16, block, sizeof(block), &total);
+    CU_ASSERT_EQUAL(length, 8);
+    CU_ASSERT_EQUAL(total, 30);
+    CU_ASSERT_NSTRING_EQUAL(block, "</3/0/6>", length);
+
+    lwm2m_data_free(2, dataP);
+
+    MEMORY_TRACE_AFTER_EQ;
+}
+
+static struct TestTable table[] = {
+        { "test of utils_linkWriterTotal()", test_link_writer_measure },
+        { "test of link writer windows", test_link_writer_blocks },
+        { "test of link writer digest", test_link_writer_digest },
+        { "test of discover_serialize()", test_discover_serialize },
+        { NULL, NULL },
+};
+
+CU_ErrorCode create_link_writer_suit()
+{
+   CU_pSuite pSuite = NULL;
+
+   pSuite = CU_add_suite("Suite_LinkWriter", NULL, NULL);
+   if (NULL == pSuite) {
+      return CU_get_error();
+   }
+
+   return add_tests(pSuite, table);
+}
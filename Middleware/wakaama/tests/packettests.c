@@ -0,0 +1,253 @@
+/*******************************************************************************
+ *
+ * Tests of the cache of piggybacked responses replayed to retransmitted CON
+ * requests (packet.c).
+ *
+ * 1NCE GmbH
+ *
+ *******************************************************************************/
+
+#include "tests.h"
+#include "CUnit/Basic.h"
+#include "internals.h"
+#include "memtest.h"
+
+#if LWM2M_COAP_DEDUP_CACHE_SIZE > 0
+#define TEST_OBJECT_ID      31024
+#define TEST_RESPONSE_SIZE  100
+
+static int prv_session;
+static int prv_otherSession;
+static time_t prv_now;
+static int prv_readCount;
+
+static uint8_t prv_read(lwm2m_context_t * contextP,
+                        uint16_t instanceId,
+                        int * numDataP,
+                        lwm2m_data_t ** dataArrayP,
+                        lwm2m_object_t * objectP)
+{
+    int i;
+
+    (void)contextP;
+    (void)instanceId;
+    (void)objectP;
+
+    prv_readCount++;
+    if (*numDataP == 0) return COAP_404_NOT_FOUND;
+    for (i = 0; i < *numDataP; i++)
+    {
+        lwm2m_data_encode_int(42, *dataArrayP + i);
+    }
+
+    return COAP_205_CONTENT;
+}
+
+// Everything stored so far, by message_send() too, expires.
+static void prv_clearCache(void)
+{
+    lwm2m_context_t context;
+    coap_packet_t message;
+
+    memset(&context, 0, sizeof(context));
+    coap_init_message(&message, COAP_TYPE_CON, COAP_GET, 0);
+    if (prv_now < lwm2m_gettime()) prv_now = lwm2m_gettime();
+    prv_now += COAP_EXCHANGE_LIFETIME;
+    CU_ASSERT_FALSE(packet_dedupReplay(&context, NULL, &message, prv_now));
+}
+
+static void prv_storeResponse(void * sessionH,
+                              uint16_t mid,
+                              uint8_t tokenByte,
+                              time_t now)
+{
+    coap_packet_t response;
+    uint8_t buffer[TEST_RESPONSE_SIZE];
+
+    coap_init_message(&response, COAP_TYPE_ACK, COAP_205_CONTENT, mid);
+    coap_set_header_token(&response, &tokenByte, 1);
+    memset(buffer, (int)(mid & 0xFF), sizeof(buffer));
+    packet_dedupStore(sessionH, &response, buffer, sizeof(buffer), now);
+}
+
+static bool prv_replay(void * sessionH,
+                       uint16_t mid,
+                       uint8_t tokenByte,
+                       time_t now)
+{
+    lwm2m_context_t context;
+    coap_packet_t request;
+
+    memset(&context, 0, sizeof(context));
+    coap_init_message(&request, COAP_TYPE_CON, COAP_GET, mid);
+    coap_set_header_token(&request, &tokenByte, 1);
+
+    return packet_dedupReplay(&context, sessionH, &request, now);
+}
+
+static size_t prv_buildRequest(uint8_t * buffer,
+                               uint16_t mid,
+                               uint8_t tokenByte)
+{
+    coap_packet_t request;
+    size_t length;
+
+    coap_init_message(&request, COAP_TYPE_CON, COAP_GET, mid);
+    coap_set_header_uri_path(&request, "/31024/0/1");
+    coap_set_header_token(&request, &tokenByte, 1);
+    length = coap_serialize_message(&request, buffer);
+    coap_free_header(&request);
+
+    return length;
+}
+
+static void test_packet_replay(void)
+{
+    lwm2m_context_t context;
+    lwm2m_server_t server;
+    lwm2m_object_t object;
+    lwm2m_list_t instance;
+    uint8_t request[64];
+    uint8_t response[sizeof(test_sent)];
+    size_t requestLength;
+    size_t responseLength;
+
+    memset(&context, 0, sizeof(context));
+    memset(&server, 0, sizeof(server));
+    memset(&object, 0, sizeof(object));
+    memset(&instance, 0, sizeof(instance));
+    server.sessionH = &prv_session;
+    server.status = STATE_REGISTERED;
+    object.objID = TEST_OBJECT_ID;
+    object.instanceList = &instance;
+    object.readFunc = prv_read;
+    context.serverList = &server;
+    context.objectList = &object;
+
+    prv_clearCache();
+    test_sendCount = 0;
+    prv_readCount = 0;
+
+    requestLength = prv_buildRequest(request, 0x5001, 0xA1);
+    CU_ASSERT_FATAL(requestLength > 0);
+    lwm2m_handle_packet(&context, request, requestLength, &prv_session);
+    CU_ASSERT_EQUAL(prv_readCount, 1);
+    CU_ASSERT_EQUAL_FATAL(test_sendCount, 1);
+    responseLength = test_sentLength;
+    memcpy(response, test_sent, responseLength);
+
+    // the server did not get our ACK and sends the request again
+    lwm2m_handle_packet(&context, request, requestLength, &prv_session);
+    CU_ASSERT_EQUAL(prv_readCount, 1);
+    CU_ASSERT_EQUAL_FATAL(test_sendCount, 2);
+    CU_ASSERT_EQUAL_FATAL(test_sentLength, responseLength);
+    CU_ASSERT_EQUAL(memcmp(test_sent, response, responseLength), 0);
+
+    // same message ID, other token: a new request
+    requestLength = prv_buildRequest(request, 0x5001, 0xA2);
+    lwm2m_handle_packet(&context, request, requestLength, &prv_session);
+    CU_ASSERT_EQUAL(prv_readCount, 2);
+    CU_ASSERT_EQUAL(test_sendCount, 3);
+
+    // same exchange from another endpoint
+    CU_ASSERT_FALSE(prv_replay(&prv_otherSession, 0x5001, 0xA1, lwm2m_gettime()));
+    CU_ASSERT_EQUAL(test_sendCount, 3);
+}
+
+static void test_packet_dedupExpiry(void)
+{
+    time_t stored;
+
+    MEMORY_TRACE_BEFORE;
+
+    prv_clearCache();
+    test_sendCount = 0;
+    stored = prv_now;
+
+    prv_storeResponse(&prv_session, 0x6001, 0xB1, stored);
+    CU_ASSERT_FALSE(prv_replay(&prv_session, 0x6001, 0xB2, stored));
+    CU_ASSERT_EQUAL(test_sendCount, 0);
+
+    CU_ASSERT_TRUE(prv_replay(&prv_session, 0x6001, 0xB1, stored + COAP_EXCHANGE_LIFETIME - 1));
+    CU_ASSERT_EQUAL(test_sendCount, 1);
+    CU_ASSERT_EQUAL(test_sentLength, TEST_RESPONSE_SIZE);
+    CU_ASSERT_EQUAL(test_sent[0], 0x01);
+
+    // the server gave up on the exchange
+    CU_ASSERT_FALSE(prv_replay(&prv_session, 0x6001, 0xB1, stored + COAP_EXCHANGE_LIFETIME));
+    CU_ASSERT_FALSE(prv_replay(&prv_session, 0x6001, 0xB1, stored + COAP_EXCHANGE_LIFETIME - 1));
+    CU_ASSERT_EQUAL(test_sendCount, 1);
+
+    MEMORY_TRACE_AFTER_EQ;
+}
+
+static void test_packet_dedupEviction(void)
+{
+    uint16_t count = LWM2M_COAP_DEDUP_CACHE_SIZE / TEST_RESPONSE_SIZE + 1;
+    uint16_t mid;
+
+    MEMORY_TRACE_BEFORE;
+
+    prv_clearCache();
+    test_sendCount = 0;
+
+    // the responses do not all fit, the oldest ones make room
+    for (mid = 1; mid <= count; mid++)
+    {
+        prv_storeResponse(&prv_session, mid, 0xC1, prv_now);
+    }
+
+    CU_ASSERT_FALSE(prv_replay(&prv_session, 1, 0xC1, prv_now));
+    CU_ASSERT_EQUAL(test_sendCount, 0);
+
+    CU_ASSERT_TRUE(prv_replay(&prv_session, count, 0xC1, prv_now));
+    CU_ASSERT_EQUAL(test_sent[0], count & 0xFF);
+    CU_ASSERT_TRUE(prv_replay(&prv_session, count - 1, 0xC1, prv_now));
+    CU_ASSERT_EQUAL(test_sent[0], (count - 1) & 0xFF);
+    CU_ASSERT_EQUAL(test_sendCount, 2);
+
+    MEMORY_TRACE_AFTER_EQ;
+}
+
+static void test_packet_dedupOversized(void)
+{
+    static uint8_t buffer[LWM2M_COAP_DEDUP_CACHE_SIZE];
+    coap_packet_t response;
+    uint8_t token = 0xD1;
+
+    prv_clearCache();
+    test_sendCount = 0;
+
+    // a response larger than the whole cache is not kept, the others stay
+    prv_storeResponse(&prv_session, 0x7001, token, prv_now);
+    coap_init_message(&response, COAP_TYPE_ACK, COAP_205_CONTENT, 0x7002);
+    coap_set_header_token(&response, &token, 1);
+    packet_dedupStore(&prv_session, &response, buffer, sizeof(buffer), prv_now);
+
+    CU_ASSERT_FALSE(prv_replay(&prv_session, 0x7002, token, prv_now));
+    CU_ASSERT_TRUE(prv_replay(&prv_session, 0x7001, token, prv_now));
+    CU_ASSERT_EQUAL(test_sendCount, 1);
+}
+#endif
+
+static struct TestTable table[] = {
+#if LWM2M_COAP_DEDUP_CACHE_SIZE > 0
+        { "test of lwm2m_handle_packet() replay", test_packet_replay },
+        { "test of packet_dedupReplay() expiry", test_packet_dedupExpiry },
+        { "test of packet_dedupStore() eviction", test_packet_dedupEviction },
+        { "test of packet_dedupStore() oversized response", test_packet_dedupOversized },
+#endif
+        { NULL, NULL },
+};
+
+CU_ErrorCode create_packet_suit()
+{
+   CU_pSuite pSuite = NULL;
+
+   pSuite = CU_add_suite("Suite_Packet", NULL, NULL);
+   if (NULL == pSuite) {
+      return CU_get_error();
+   }
+
+   return add_tests(pSuite, table);
+}
@@ -0,0 +1,216 @@
+/*******************************************************************************
+ *
+ * Tests of the messages kept while the client sleeps in Queue Mode
+ * (queue_mode.c).
+ *
+ * 1NCE GmbH
+ *
+ *******************************************************************************/
+
+#include "tests.h"
+#include "CUnit/Basic.h"
+#include "internals.h"
+#include "memtest.h"
+
+#ifdef LWM2M_CLIENT_QUEUE_MODE
+static int prv_session;
+
+static void prv_initContext(lwm2m_context_t * contextP,
+                            lwm2m_server_t * serverP)
+{
+    memset(contextP, 0, sizeof(lwm2m_context_t));
+    memset(serverP, 0, sizeof(lwm2m_server_t));
+    serverP->sessionH = &prv_session;
+    serverP->binding = BINDING_UQ;
+    serverP->status = STATE_REGISTERED;
+    contextP->state = STATE_READY;
+    contextP->serverList = serverP;
+
+    test_sendCount = 0;
+}
+
+static void prv_sleep(lwm2m_context_t * contextP,
+                      time_t now)
+{
+    time_t timeout = 60;
+
+    contextP->lastExchange = now - LWM2M_QUEUE_MODE_AWAKE_TIME;
+    queue_mode_step(contextP, now, &timeout);
+    CU_ASSERT_EQUAL(contextP->queueState, QUEUE_MODE_SLEEPING);
+}
+
+static void prv_keepNotification(lwm2m_context_t * contextP,
+                                 uint16_t mid)
+{
+    coap_packet_t message;
+    uint8_t token = 0xE1;
+
+    coap_init_message(&message, COAP_TYPE_NON, COAP_205_CONTENT, mid);
+    coap_set_header_token(&message, &token, 1);
+    coap_set_header_observe(&message, mid);
+    CU_ASSERT_EQUAL(queue_mode_keepNotification(contextP, &message, &prv_session), COAP_NO_ERROR);
+}
+
+static void test_queue_mode_flush(void)
+{
+    lwm2m_context_t context;
+    lwm2m_server_t server;
+    lwm2m_uri_t uri;
+    uint8_t * payload;
+    time_t now;
+    time_t timeout;
+
+    MEMORY_TRACE_BEFORE;
+
+    prv_initContext(&context, &server);
+    now = lwm2m_gettime();
+    context.lastExchange = now;
+
+    timeout = 1000;
+    queue_mode_step(&context, now, &timeout);
+    CU_ASSERT_EQUAL(context.queueState, QUEUE_MODE_AWAKE);
+    CU_ASSERT_EQUAL(timeout, LWM2M_QUEUE_MODE_AWAKE_TIME);
+
+    timeout = 60;
+    queue_mode_step(&context, now + LWM2M_QUEUE_MODE_AWAKE_TIME, &timeout);
+    CU_ASSERT_EQUAL(context.queueState, QUEUE_MODE_SLEEPING);
+    CU_ASSERT_TRUE(queue_mode_isSleeping(&context));
+
+    // a notification, a Send operation and another notification
+    prv_keepNotification(&context, 0x101);
+    payload = (uint8_t *)lwm2m_malloc(4);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(payload);
+    memcpy(payload, "1234", 4);
+    lwm2m_stringToUri("/3/0", 4, &uri);
+    CU_ASSERT_EQUAL(queue_mode_keepSend(&context, &prv_session, &uri, LWM2M_CONTENT_SENML_JSON, payload, 4), COAP_NO_ERROR);
+    prv_keepNotification(&context, 0x103);
+    context.nextMID = 0x102;
+    CU_ASSERT_EQUAL(lwm2m_queue_mode_pending(&context, NULL), 3);
+
+    // nothing goes out while sleeping
+    queue_mode_step(&context, now + 10 * LWM2M_QUEUE_MODE_AWAKE_TIME, &timeout);
+    CU_ASSERT_EQUAL(context.queueState, QUEUE_MODE_SLEEPING);
+    CU_ASSERT_EQUAL(test_sendCount, 0);
+
+    // a registration update wakes the client, the messages wait for its answer
+    server.status = STATE_REG_UPDATE_PENDING;
+    queue_mode_step(&context, now + 10 * LWM2M_QUEUE_MODE_AWAKE_TIME, &timeout);
+    CU_ASSERT_EQUAL(context.queueState, QUEUE_MODE_WAKING);
+    queue_mode_step(&context, now + 10 * LWM2M_QUEUE_MODE_AWAKE_TIME, &timeout);
+    CU_ASSERT_EQUAL(context.queueState, QUEUE_MODE_WAKING);
+    CU_ASSERT_EQUAL(test_sendCount, 0);
+
+    server.status = STATE_REGISTERED;
+    queue_mode_step(&context, now + 10 * LWM2M_QUEUE_MODE_AWAKE_TIME, &timeout);
+    CU_ASSERT_EQUAL(context.queueState, QUEUE_MODE_AWAKE);
+    CU_ASSERT_EQUAL(lwm2m_queue_mode_pending(&context, NULL), 0);
+    CU_ASSERT_EQUAL_FATAL(test_sendCount, 3);
+    CU_ASSERT_EQUAL(test_sentMid[0], 0x101);
+    CU_ASSERT_EQUAL(test_sentMid[1], 0x102);
+    CU_ASSERT_EQUAL(test_sentMid[2], 0x103);
+
+    // the Send operation waits for its acknowledgement
+    CU_ASSERT_PTR_NOT_NULL_FATAL(context.transactionList);
+    transaction_remove(&context, context.transactionList);
+    CU_ASSERT_PTR_NULL(context.transactionList);
+
+    MEMORY_TRACE_AFTER_EQ;
+}
+
+static void test_queue_mode_overflow(void)
+{
+    lwm2m_context_t context;
+    lwm2m_server_t server;
+    time_t now;
+    time_t oldest;
+    time_t timeout = 60;
+    uint16_t mid;
+    int i;
+
+    MEMORY_TRACE_BEFORE;
+
+    prv_initContext(&context, &server);
+    now = lwm2m_gettime();
+    prv_sleep(&context, now);
+
+    // the oldest messages make room
+    for (mid = 1; mid <= LWM2M_QUEUE_MODE_LENGTH + 2; mid++)
+    {
+        prv_keepNotification(&context, mid);
+    }
+    CU_ASSERT_EQUAL(lwm2m_queue_mode_pending(&context, &oldest), LWM2M_QUEUE_MODE_LENGTH);
+    CU_ASSERT_TRUE(oldest >= now);
+
+    CU_ASSERT_EQUAL(lwm2m_queue_mode_wake(&context), COAP_NO_ERROR);
+    CU_ASSERT_EQUAL(context.queueState, QUEUE_MODE_WAKING);
+    CU_ASSERT_EQUAL(server.status, STATE_REG_UPDATE_NEEDED);
+    queue_mode_step(&context, now, &timeout);
+    CU_ASSERT_EQUAL(test_sendCount, 0);
+
+    server.status = STATE_REGISTERED;
+    queue_mode_step(&context, now, &timeout);
+    CU_ASSERT_EQUAL(context.queueState, QUEUE_MODE_AWAKE);
+    CU_ASSERT_EQUAL_FATAL(test_sendCount, LWM2M_QUEUE_MODE_LENGTH);
+    for (i = 0; i < LWM2M_QUEUE_MODE_LENGTH && i < TEST_SENT_COUNT; i++)
+    {
+        CU_ASSERT_EQUAL(test_sentMid[i], i + 3);
+    }
+
+    // awake already
+    CU_ASSERT_EQUAL(lwm2m_queue_mode_wake(&context), COAP_NO_ERROR);
+    CU_ASSERT_EQUAL(context.queueState, QUEUE_MODE_AWAKE);
+
+    MEMORY_TRACE_AFTER_EQ;
+}
+
+static void test_queue_mode_clear(void)
+{
+    lwm2m_context_t context;
+    lwm2m_server_t server;
+    time_t now;
+    time_t timeout = 60;
+
+    MEMORY_TRACE_BEFORE;
+
+    prv_initContext(&context, &server);
+    now = lwm2m_gettime();
+    prv_sleep(&context, now);
+    prv_keepNotification(&context, 1);
+    prv_keepNotification(&context, 2);
+
+    // the kept messages are dropped with the Q binding
+    server.binding = BINDING_U;
+    queue_mode_step(&context, now, &timeout);
+    CU_ASSERT_EQUAL(context.queueState, QUEUE_MODE_AWAKE);
+    CU_ASSERT_EQUAL(lwm2m_queue_mode_pending(&context, NULL), 0);
+    CU_ASSERT_EQUAL(test_sendCount, 0);
+
+    // a client bound without Q never sleeps
+    context.lastExchange = now - LWM2M_QUEUE_MODE_AWAKE_TIME;
+    queue_mode_step(&context, now, &timeout);
+    CU_ASSERT_FALSE(queue_mode_isSleeping(&context));
+
+    MEMORY_TRACE_AFTER_EQ;
+}
+#endif
+
+static struct TestTable table[] = {
+#ifdef LWM2M_CLIENT_QUEUE_MODE
+        { "test of queue_mode_step() flush", test_queue_mode_flush },
+        { "test of queue_mode_keepNotification() overflow", test_queue_mode_overflow },
+        { "test of queue_mode_step() without Q binding", test_queue_mode_clear },
+#endif
+        { NULL, NULL },
+};
+
+CU_ErrorCode create_queue_mode_suit()
+{
+   CU_pSuite pSuite = NULL;
+
+   pSuite = CU_add_suite("Suite_QueueMode", NULL, NULL);
+   if (NULL == pSuite) {
+      return CU_get_error();
+   }
+
+   return add_tests(pSuite, table);
+}
@@ -0,0 +1,131 @@
+/*******************************************************************************
+ *
+ * Tests of the object list sent with registrations (registration.c).
+ *
+ * 1NCE GmbH
+ *
+ *******************************************************************************/
+
+#include "tests.h"
+#include "CUnit/Basic.h"
+#include "internals.h"
+#include "memtest.h"
+
+#define TEST_OBJECT_ID  31024
+
+static int prv_session;
+
+static uint8_t prv_read(lwm2m_context_t * contextP,
+                        uint16_t instanceId,
+                        int * numDataP,
+                        lwm2m_data_t ** dataArrayP,
+                        lwm2m_object_t * objectP)
+{
+    (void)contextP;
+    (void)instanceId;
+    (void)numDataP;
+    (void)dataArrayP;
+    (void)objectP;
+
+    // no registration order nor initial delay
+    return COAP_404_NOT_FOUND;
+}
+
+// Register with the server and return the object list that was sent.
+static void prv_register(lwm2m_context_t * contextP,
+                         lwm2m_server_t * serverP,
+                         char * payload,
+                         size_t size)
+{
+    coap_packet_t message;
+    time_t timeout = 60;
+
+    payload[0] = 0;
+    test_sendCount = 0;
+    serverP->status = STATE_DEREGISTERED;
+
+    CU_ASSERT_EQUAL(registration_start(contextP, false), COAP_NO_ERROR);
+    if (serverP->status == STATE_REG_HOLD_OFF)
+    {
+        registration_step(contextP, lwm2m_gettime(), &timeout);
+    }
+    CU_ASSERT_EQUAL(serverP->status, STATE_REG_PENDING);
+    CU_ASSERT_EQUAL_FATAL(test_sendCount, 1);
+
+    CU_ASSERT_EQUAL_FATAL(coap_parse_message(&message, test_sent, (uint16_t)test_sentLength), NO_ERROR);
+    CU_ASSERT_FATAL(message.payload_len < size);
+    memcpy(payload, message.payload, message.payload_len);
+    payload[message.payload_len] = 0;
+    coap_free_header(&message);
+
+    transaction_free_userData(contextP, contextP->transactionList);
+    transaction_remove(contextP, contextP->transactionList);
+}
+
+static void test_registration_objectAdded(void)
+{
+    lwm2m_context_t context;
+    lwm2m_server_t server;
+    lwm2m_object_t serverObject;
+    lwm2m_object_t object;
+    lwm2m_list_t serverInstance;
+    lwm2m_list_t instance;
+    char endpointName[] = "test";
+    char payload[TEST_SENT_SIZE];
+
+    MEMORY_TRACE_BEFORE;
+
+    memset(&context, 0, sizeof(context));
+    memset(&server, 0, sizeof(server));
+    memset(&serverObject, 0, sizeof(serverObject));
+    memset(&object, 0, sizeof(object));
+    memset(&serverInstance, 0, sizeof(serverInstance));
+    memset(&instance, 0, sizeof(instance));
+    serverObject.objID = LWM2M_SERVER_OBJECT_ID;
+    serverObject.instanceList = &serverInstance;
+    serverObject.readFunc = prv_read;
+    object.objID = TEST_OBJECT_ID;
+    object.instanceList = &instance;
+    server.sessionH = &prv_session;
+    server.binding = BINDING_U;
+    server.lifetime = 300;
+    context.endpointName = endpointName;
+    context.objectList = &serverObject;
+    context.serverList = &server;
+
+    prv_register(&context, &server, payload, sizeof(payload));
+    CU_ASSERT_PTR_NOT_NULL(strstr(payload, "</1/0>"));
+    CU_ASSERT_PTR_NULL(strstr(payload, "</31024/0>"));
+
+    // the registration failed, the client is not ready yet
+    CU_ASSERT_NOT_EQUAL(context.state, STATE_READY);
+    CU_ASSERT_EQUAL(lwm2m_add_object(&context, &object), COAP_NO_ERROR);
+    prv_register(&context, &server, payload, sizeof(payload));
+    CU_ASSERT_PTR_NOT_NULL(strstr(payload, "</1/0>"));
+    CU_ASSERT_PTR_NOT_NULL(strstr(payload, "</31024/0>"));
+
+    CU_ASSERT_EQUAL(lwm2m_remove_object(&context, TEST_OBJECT_ID), COAP_NO_ERROR);
+    prv_register(&context, &server, payload, sizeof(payload));
+    CU_ASSERT_PTR_NULL(strstr(payload, "</31024/0>"));
+
+    lwm2m_free(server.query);
+
+    MEMORY_TRACE_AFTER_EQ;
+}
+
+static struct TestTable table[] = {
+        { "test of lwm2m_add_object() before registration", test_registration_objectAdded },
+        { NULL, NULL },
+};
+
+CU_ErrorCode create_registration_suit()
+{
+   CU_pSuite pSuite = NULL;
+
+   pSuite = CU_add_suite("Suite_Registration", NULL, NULL);
+   if (NULL == pSuite) {
+      return CU_get_error();
+   }
+
+   return add_tests(pSuite, table);
+}
@@ -19,12 +19,23 @@
 #define TESTS_H_
 
 #include "CUnit/CUError.h"
+#include <stddef.h>
+#include <stdint.h>
 
 struct TestTable {
     const char* name;
     CU_TestFunc function;
 };
 
+// Recorded by the lwm2m_buffer_send() of connectionstub.c.
+#define TEST_SENT_SIZE  256
+#define TEST_SENT_COUNT 16
+
+extern int test_sendCount;
+extern size_t test_sentLength;
+extern uint8_t test_sent[TEST_SENT_SIZE];       // the last message
+extern uint16_t test_sentMid[TEST_SENT_COUNT];  // the message IDs in order
+
 CU_ErrorCode add_tests(CU_pSuite pSuite, struct TestTable* testTable);
 CU_ErrorCode create_uri_suit();
 CU_ErrorCode create_tlv_suit();
@@ -32,6 +43,12 @@ CU_ErrorCode create_object_read_suit();
 CU_ErrorCode create_convert_numbers_suit();
 CU_ErrorCode create_tlv_json_suit();
 CU_ErrorCode create_block1_suit();
+CU_ErrorCode create_link_writer_suit();
+CU_ErrorCode create_transaction_suit();
+CU_ErrorCode create_packet_suit();
+CU_ErrorCode create_data_suit();
+CU_ErrorCode create_queue_mode_suit();
+CU_ErrorCode create_registration_suit();
 #ifdef LWM2M_SUPPORT_SENML_JSON
 CU_ErrorCode create_senml_json_suit();
 #endif
@@ -0,0 +1,132 @@
+/*******************************************************************************
+ *
+ * Tests of the transaction pool and of the retransmission timers (transaction.c).
+ *
+ * 1NCE GmbH
+ *
+ *******************************************************************************/
+
+#include "tests.h"
+#include "CUnit/Basic.h"
+#include "internals.h"
+#include "memtest.h"
+
+static int prv_session;
+static uint16_t prv_expired[4];
+static int prv_expiredCount;
+
+static void prv_expiredCallback(lwm2m_context_t * contextP,
+                                lwm2m_transaction_t * transacP,
+                                void * message)
+{
+    (void)contextP;
+
+    CU_ASSERT_PTR_NULL(message);
+    if (prv_expiredCount < 4) prv_expired[prv_expiredCount] = transacP->mID;
+    prv_expiredCount++;
+}
+
+static void test_transaction_pool(void)
+{
+    lwm2m_transaction_t * transactions[LWM2M_TRANSACTION_POOL_SIZE + 1];
+    size_t i;
+
+    MEMORY_TRACE_BEFORE;
+
+    // the last one comes from the heap
+    for (i = 0; i < LWM2M_TRANSACTION_POOL_SIZE + 1; i++)
+    {
+        transactions[i] = transaction_new(&prv_session, COAP_GET, NULL, NULL, (uint16_t)i, 4, NULL);
+        CU_ASSERT_PTR_NOT_NULL_FATAL(transactions[i]);
+        CU_ASSERT_PTR_NOT_NULL(transactions[i]->message);
+    }
+    for (i = 0; i < LWM2M_TRANSACTION_POOL_SIZE + 1; i++)
+    {
+        transaction_free(transactions[i]);
+    }
+
+    // released slots are handed out again
+    transactions[0] = transaction_new(&prv_session, COAP_GET, NULL, NULL, 1, 4, NULL);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(transactions[0]);
+    transaction_free(transactions[0]);
+
+    CU_ASSERT_PTR_NULL(transaction_new(NULL, COAP_GET, NULL, NULL, 1, 4, NULL));
+
+    MEMORY_TRACE_AFTER_EQ;
+}
+
+static void test_transaction_timers(void)
+{
+    static const time_t timeouts[3] = { 30, 10, 20 };
+    lwm2m_context_t context;
+    coap_packet_t ack;
+    time_t now;
+    time_t timeout;
+    uint16_t i;
+
+    MEMORY_TRACE_BEFORE;
+
+    memset(&context, 0, sizeof(context));
+    prv_expiredCount = 0;
+
+    // acknowledged requests wait for their response until response_timeout
+    for (i = 0; i < 3; i++)
+    {
+        lwm2m_transaction_t * transacP;
+
+        transacP = transaction_new(&prv_session, COAP_GET, NULL, NULL, i, 4, NULL);
+        CU_ASSERT_PTR_NOT_NULL_FATAL(transacP);
+        transacP->response_timeout = timeouts[i];
+        transacP->callback = prv_expiredCallback;
+        context.transactionList = (lwm2m_transaction_t *)LWM2M_LIST_ADD(context.transactionList, transacP);
+
+        coap_init_message(&ack, COAP_TYPE_ACK, 0, i);
+        CU_ASSERT_TRUE(transaction_handleResponse(&context, &prv_session, &ack, NULL));
+    }
+    now = lwm2m_gettime();
+
+    CU_ASSERT_PTR_NOT_NULL_FATAL(context.transactionTimers);
+    CU_ASSERT_EQUAL(context.transactionTimers->mID, 1);
+    CU_ASSERT_EQUAL(context.transactionTimers->timerNext->mID, 2);
+    CU_ASSERT_EQUAL(context.transactionTimers->timerNext->timerNext->mID, 0);
+
+    timeout = 60;
+    transaction_step(&context, now, &timeout);
+    CU_ASSERT_EQUAL(prv_expiredCount, 0);
+    CU_ASSERT_EQUAL(timeout, context.transactionTimers->retrans_time - now);
+
+    timeout = 60;
+    transaction_step(&context, context.transactionTimers->timerNext->retrans_time, &timeout);
+    CU_ASSERT_EQUAL(prv_expiredCount, 2);
+    CU_ASSERT_EQUAL(prv_expired[0], 1);
+    CU_ASSERT_EQUAL(prv_expired[1], 2);
+    CU_ASSERT_EQUAL(timeout, 1);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(context.transactionTimers);
+    CU_ASSERT_EQUAL(context.transactionTimers->mID, 0);
+    CU_ASSERT_PTR_NULL(context.transactionTimers->timerNext);
+
+    transaction_remove(&context, context.transactionList);
+    CU_ASSERT_PTR_NULL(context.transactionList);
+    CU_ASSERT_PTR_NULL(context.transactionTimers);
+    CU_ASSERT_EQUAL(prv_expiredCount, 2);
+
+    MEMORY_TRACE_AFTER_EQ;
+}
+
+static struct TestTable table[] = {
+        { "test of transaction_new() pool", test_transaction_pool },
+        { "test of transaction_step() timers", test_transaction_timers },
+        { NULL, NULL },
+};
+
+CU_ErrorCode create_transaction_suit()
+{
+   CU_pSuite pSuite = NULL;
+
+   pSuite = CU_add_suite("Suite_Transaction", NULL, NULL);
+   if (NULL == pSuite) {
+      return CU_get_error();
+   }
+
+   return add_tests(pSuite, table);
+}
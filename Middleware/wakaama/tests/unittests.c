@@ -62,6 +62,24 @@ int main()
    if (CUE_SUCCESS != create_convert_numbers_suit())
       goto exit;
 
+   if (CUE_SUCCESS != create_link_writer_suit())
+      goto exit;
+
+   if (CUE_SUCCESS != create_transaction_suit())
+      goto exit;
+
+   if (CUE_SUCCESS != create_packet_suit())
+      goto exit;
+
+   if (CUE_SUCCESS != create_data_suit())
+      goto exit;
+
+   if (CUE_SUCCESS != create_queue_mode_suit())
+      goto exit;
+
+   if (CUE_SUCCESS != create_registration_suit())
+      goto exit;
+
    if (CUE_SUCCESS != create_tlv_json_suit())
       goto exit;
 
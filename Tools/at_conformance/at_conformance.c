@@ -0,0 +1,270 @@
+/*
+ * at_conformance.c
+ *
+ *  Checks the response schemas of the BG96 port
+ *  (Cellular/CellularBG96/source/cellular_bg96_schema.c) against recorded
+ *  responses. The file holds pairs of lines, a response and the expected
+ *  result of Cellular_ATParseResponse():
+ *
+ *  +QPSMS: 1,,,"4320","60"
+ *  = 1,-,-,4320,60
+ *
+ *  lists the stored value of every parameter of the schema, '-' for
+ *  parameters without value and for skipped ones, and
+ *
+ *  = ERROR
+ *
+ *  expects the response to be rejected. The schema is selected by the prefix
+ *  of the response. Lines starting with '#' are comments.
+ *
+ *  Usage: at_conformance <responses> [-v]
+ *
+ *  1NCE GmbH
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cellular_platform.h"
+#include "cellular_config.h"
+#include "cellular_config_defaults.h"
+#include "cellular_common.h"
+#include "cellular_at_core.h"
+#include "cellular_bg96.h"
+
+#define conformanceMAX_LINE    ( 512U )
+
+typedef struct ConformanceSchema
+{
+    const char * pcPrefix;
+    const CellularATSchema_t * pxSchema;
+} ConformanceSchema_t;
+
+static const ConformanceSchema_t xSchemas[] =
+{
+    { "+QPSMS", &CellularQpsmsSchema },
+    { "+QIACT", &CellularQiactSchema },
+};
+
+/* Large enough and aligned for every output structure of the schemas. */
+typedef union ConformanceOutput
+{
+    CellularPsmSettings_t xPsmSettings;
+    CellularPdnStatus_t xPdnStatus;
+    uint8_t ucBytes[ 256 ];
+} ConformanceOutput_t;
+
+/*-----------------------------------------------------------*/
+
+/* Cellular_ATStrDup() allocates from the FreeRTOS heap. */
+void * pvPortMalloc( size_t xWantedSize )
+{
+    return malloc( xWantedSize );
+}
+
+/*-----------------------------------------------------------*/
+
+static const CellularATSchema_t * prvFindSchema( const char * pcResponse )
+{
+    const CellularATSchema_t * pxSchema = NULL;
+    size_t xLength;
+    size_t i;
+
+    for( i = 0U; i < ( sizeof( xSchemas ) / sizeof( xSchemas[ 0 ] ) ); i++ )
+    {
+        xLength = strlen( xSchemas[ i ].pcPrefix );
+
+        if( ( strncmp( pcResponse, xSchemas[ i ].pcPrefix, xLength ) == 0 ) && ( pcResponse[ xLength ] == ':' ) )
+        {
+            pxSchema = xSchemas[ i ].pxSchema;
+            break;
+        }
+    }
+
+    return pxSchema;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvFormatField( const CellularATField_t * pxField,
+                            const uint8_t * pucField,
+                            char * pcOut,
+                            size_t xOutSize )
+{
+    uint8_t ucValue;
+    uint16_t usValue;
+    uint32_t ulValue;
+    int32_t lValue;
+
+    if( pxField->type == CELLULAR_AT_FIELD_STRING )
+    {
+        ( void ) snprintf( pcOut, xOutSize, "%s", ( const char * ) pucField );
+        return;
+    }
+
+    if( pxField->size == 1U )
+    {
+        ( void ) memcpy( &ucValue, pucField, sizeof( ucValue ) );
+        lValue = ( pxField->minValue < 0 ) ? ( int32_t ) ( int8_t ) ucValue : ( int32_t ) ucValue;
+    }
+    else if( pxField->size == 2U )
+    {
+        ( void ) memcpy( &usValue, pucField, sizeof( usValue ) );
+        lValue = ( pxField->minValue < 0 ) ? ( int32_t ) ( int16_t ) usValue : ( int32_t ) usValue;
+    }
+    else
+    {
+        ( void ) memcpy( &ulValue, pucField, sizeof( ulValue ) );
+        lValue = ( int32_t ) ulValue;
+    }
+
+    ( void ) snprintf( pcOut, xOutSize, "%ld", ( long ) lValue );
+}
+
+/*-----------------------------------------------------------*/
+
+/* Parse a response and describe the result in the format of the expected
+ * lines. */
+static void prvParse( const char * pcResponse,
+                      const CellularATSchema_t * pxSchema,
+                      char * pcResult,
+                      size_t xResultSize )
+{
+    static ConformanceOutput_t xOutput;
+    char cLine[ conformanceMAX_LINE ];
+    char cField[ CELLULAR_AT_MAX_STRING_SIZE + 1U ];
+    uint32_t ulPresent = 0U;
+    size_t xLength = 0U;
+    uint8_t i;
+
+    ( void ) memset( &xOutput, 0, sizeof( xOutput ) );
+    ( void ) snprintf( cLine, sizeof( cLine ), "%s", pcResponse );
+
+    if( Cellular_ATParseResponse( cLine, pxSchema, &xOutput, &ulPresent ) != CELLULAR_AT_SUCCESS )
+    {
+        ( void ) snprintf( pcResult, xResultSize, "ERROR" );
+        return;
+    }
+
+    pcResult[ 0 ] = '\0';
+
+    for( i = 0U; i < pxSchema->fieldCount; i++ )
+    {
+        if( ( pxSchema->pFields[ i ].type == CELLULAR_AT_FIELD_SKIP ) || ( ( ulPresent & ( 1UL << i ) ) == 0U ) )
+        {
+            ( void ) strcpy( cField, "-" );
+        }
+        else
+        {
+            prvFormatField( &pxSchema->pFields[ i ], &xOutput.ucBytes[ pxSchema->pFields[ i ].offset ],
+                            cField, sizeof( cField ) );
+        }
+
+        xLength += ( size_t ) snprintf( &pcResult[ xLength ], xResultSize - xLength, "%s%s",
+                                        ( i > 0U ) ? "," : "", cField );
+
+        if( xLength >= xResultSize )
+        {
+            break;
+        }
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+int main( int argc,
+          char ** argv )
+{
+    FILE * pxFile;
+    char cLine[ conformanceMAX_LINE ];
+    char cResponse[ conformanceMAX_LINE ] = { 0 };
+    char cResult[ conformanceMAX_LINE ];
+    const CellularATSchema_t * pxSchema = NULL;
+    unsigned long ulLineNumber = 0UL;
+    unsigned long ulRecords = 0UL;
+    unsigned long ulFailures = 0UL;
+    int lVerbose = 0;
+    int lArg;
+
+    if( argc < 2 )
+    {
+        ( void ) fprintf( stderr, "usage: %s <responses> [-v]\n", argv[ 0 ] );
+        return 2;
+    }
+
+    for( lArg = 2; lArg < argc; lArg++ )
+    {
+        if( strcmp( argv[ lArg ], "-v" ) == 0 )
+        {
+            lVerbose = 1;
+        }
+    }
+
+    pxFile = fopen( argv[ 1 ], "r" );
+
+    if( pxFile == NULL )
+    {
+        perror( argv[ 1 ] );
+        return 2;
+    }
+
+    while( fgets( cLine, sizeof( cLine ), pxFile ) != NULL )
+    {
+        ulLineNumber++;
+        cLine[ strcspn( cLine, "\r\n" ) ] = '\0';
+
+        if( ( cLine[ 0 ] == '\0' ) || ( cLine[ 0 ] == '#' ) )
+        {
+            continue;
+        }
+
+        if( ( cLine[ 0 ] != '=' ) || ( cLine[ 1 ] != ' ' ) )
+        {
+            /* A response, the expectation follows. */
+            ( void ) snprintf( cResponse, sizeof( cResponse ), "%s", cLine );
+            pxSchema = prvFindSchema( cResponse );
+
+            if( pxSchema == NULL )
+            {
+                ( void ) printf( "%lu: no schema for %s\n", ulLineNumber, cResponse );
+                ulFailures++;
+            }
+
+            continue;
+        }
+
+        if( ( cResponse[ 0 ] == '\0' ) || ( pxSchema == NULL ) )
+        {
+            ( void ) printf( "%lu: expectation without response\n", ulLineNumber );
+            ulFailures++;
+            continue;
+        }
+
+        prvParse( cResponse, pxSchema, cResult, sizeof( cResult ) );
+        ulRecords++;
+
+        if( strcmp( cResult, &cLine[ 2 ] ) != 0 )
+        {
+            ( void ) printf( "%lu: FAIL %s\n    expected %s\n    parsed   %s\n", ulLineNumber, cResponse,
+                             &cLine[ 2 ], cResult );
+            ulFailures++;
+        }
+        else if( lVerbose != 0 )
+        {
+            ( void ) printf( "%lu: ok   %s = %s\n", ulLineNumber, cResponse, cResult );
+        }
+        else
+        {
+            /* Passed. */
+        }
+
+        cResponse[ 0 ] = '\0';
+    }
+
+    ( void ) fclose( pxFile );
+    ( void ) printf( "%lu responses, %lu failures\n", ulRecords, ulFailures );
+
+    return ( ulFailures == 0UL ) ? 0 : 1;
+}
@@ -0,0 +1,369 @@
+/*
+ * at_tok_bench.c
+ *
+ *  Micro-benchmark of the AT response tokenizers in
+ *  Cellular/CellularLibrary/source/cellular_at_core.c over a file of modem
+ *  responses, one per line. Every response is copied into a work buffer, its
+ *  prefix removed and all parameters tokenized, the way the response parsers
+ *  do it:
+ *
+ *  strtok     the previous strtok() based Cellular_ATGetNextTok(), after
+ *             Cellular_ATRemoveAllDoubleQuote() like the parsers of quoted
+ *             responses
+ *  nexttok    the current Cellular_ATGetNextTok(), same preparation
+ *  tokenizer  Cellular_ATTokenizerInit() / Cellular_ATTokenizerNext(), which
+ *             handle the quotes themselves
+ *
+ *  The tokens of strtok and nexttok are compared, a difference is reported
+ *  and fails the run.
+ *
+ *  Usage: at_tok_bench <responses> [-n passes]
+ *
+ *  1NCE GmbH
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "cellular_at_core.h"
+
+#define benchMAX_RESPONSES       ( 256U )
+#define benchMAX_TOKENS          ( 32U )
+#define benchDEFAULT_PASSES      ( 20000UL )
+
+typedef struct BenchResponses
+{
+    char cLines[ benchMAX_RESPONSES ][ CELLULAR_AT_MAX_STRING_SIZE + 1U ];
+    size_t xCount;
+} BenchResponses_t;
+
+typedef size_t ( * BenchTokenize_t )( char * pcLine );
+
+/* Sum of the token lengths, so that the work cannot be optimised away. */
+static volatile size_t xTokenBytes = 0U;
+
+/*-----------------------------------------------------------*/
+
+/* Cellular_ATStrDup() allocates from the FreeRTOS heap. */
+void * pvPortMalloc( size_t xWantedSize )
+{
+    return malloc( xWantedSize );
+}
+
+/*-----------------------------------------------------------*/
+
+static uint64_t prvNow( void )
+{
+    struct timespec xTime;
+
+    ( void ) clock_gettime( CLOCK_MONOTONIC, &xTime );
+
+    return ( ( uint64_t ) xTime.tv_sec * 1000000000ULL ) + ( uint64_t ) xTime.tv_nsec;
+}
+
+/*-----------------------------------------------------------*/
+
+/* Cellular_ATGetSpecificNextTok() as it was before the tokenizer, kept here
+ * as the reference. */
+static CellularATError_t prvLegacyGetNextTok( char ** ppString,
+                                              char ** ppTokOutput )
+{
+    const char * pDelimiter = ",";
+    uint16_t tokStrLen = 0, dataStrlen = 0;
+    char * tok = NULL;
+
+    if( ( memchr( *ppString, '\0', CELLULAR_AT_MAX_STRING_SIZE + 1U ) == NULL ) || ( **ppString == '\0' ) )
+    {
+        return CELLULAR_AT_BAD_PARAMETER;
+    }
+
+    dataStrlen = ( uint16_t ) strlen( *ppString );
+
+    if( ( **ppString ) == ( *pDelimiter ) )
+    {
+        **ppString = '\0';
+        tok = *ppString;
+    }
+    else
+    {
+        tok = strtok( *ppString, pDelimiter );
+    }
+
+    tokStrLen = ( uint16_t ) strlen( tok );
+
+    if( ( tokStrLen < dataStrlen ) && ( ( *ppString )[ tokStrLen + 1U ] != '\0' ) )
+    {
+        *ppString = &( tok[ strlen( tok ) + 1U ] );
+    }
+    else
+    {
+        *ppString = &( tok[ strlen( tok ) ] );
+    }
+
+    *ppTokOutput = tok;
+
+    return CELLULAR_AT_SUCCESS;
+}
+
+/*-----------------------------------------------------------*/
+
+static size_t prvTokenizeStrtok( char * pcLine,
+                                 char ** ppcTokens )
+{
+    char * pcString = pcLine;
+    char * pcToken = NULL;
+    size_t xTokens = 0U;
+
+    if( ( Cellular_ATRemovePrefix( &pcString ) == CELLULAR_AT_SUCCESS ) &&
+        ( Cellular_ATRemoveAllDoubleQuote( pcString ) == CELLULAR_AT_SUCCESS ) )
+    {
+        while( prvLegacyGetNextTok( &pcString, &pcToken ) == CELLULAR_AT_SUCCESS )
+        {
+            xTokenBytes += strlen( pcToken );
+
+            if( ( ppcTokens != NULL ) && ( xTokens < benchMAX_TOKENS ) )
+            {
+                ppcTokens[ xTokens ] = pcToken;
+            }
+
+            xTokens++;
+        }
+    }
+
+    return xTokens;
+}
+
+/*-----------------------------------------------------------*/
+
+static size_t prvTokenizeNextTok( char * pcLine,
+                                  char ** ppcTokens )
+{
+    char * pcString = pcLine;
+    char * pcToken = NULL;
+    size_t xTokens = 0U;
+
+    if( ( Cellular_ATRemovePrefix( &pcString ) == CELLULAR_AT_SUCCESS ) &&
+        ( Cellular_ATRemoveAllDoubleQuote( pcString ) == CELLULAR_AT_SUCCESS ) )
+    {
+        while( Cellular_ATGetNextTok( &pcString, &pcToken ) == CELLULAR_AT_SUCCESS )
+        {
+            xTokenBytes += strlen( pcToken );
+
+            if( ( ppcTokens != NULL ) && ( xTokens < benchMAX_TOKENS ) )
+            {
+                ppcTokens[ xTokens ] = pcToken;
+            }
+
+            xTokens++;
+        }
+    }
+
+    return xTokens;
+}
+
+/*-----------------------------------------------------------*/
+
+static size_t prvStrtok( char * pcLine )
+{
+    return prvTokenizeStrtok( pcLine, NULL );
+}
+
+/*-----------------------------------------------------------*/
+
+static size_t prvNextTok( char * pcLine )
+{
+    return prvTokenizeNextTok( pcLine, NULL );
+}
+
+/*-----------------------------------------------------------*/
+
+static size_t prvTokenizer( char * pcLine )
+{
+    char * pcString = pcLine;
+    CellularATTokenizer_t xTokenizer;
+    CellularATToken_t xToken;
+    size_t xTokens = 0U;
+
+    if( ( Cellular_ATRemovePrefix( &pcString ) == CELLULAR_AT_SUCCESS ) &&
+        ( Cellular_ATTokenizerInit( &xTokenizer, pcString ) == CELLULAR_AT_SUCCESS ) )
+    {
+        while( Cellular_ATTokenizerNext( &xTokenizer, ',', &xToken ) == CELLULAR_AT_SUCCESS )
+        {
+            xTokenBytes += xToken.tokenLength;
+            xTokens++;
+        }
+    }
+
+    return xTokens;
+}
+
+/*-----------------------------------------------------------*/
+
+static int prvLoadResponses( const char * pcFile,
+                             BenchResponses_t * pxResponses )
+{
+    FILE * pxFile = fopen( pcFile, "r" );
+    char cLine[ 512 ];
+    size_t xLength;
+
+    if( pxFile == NULL )
+    {
+        perror( pcFile );
+        return -1;
+    }
+
+    pxResponses->xCount = 0U;
+
+    while( ( fgets( cLine, sizeof( cLine ), pxFile ) != NULL ) &&
+           ( pxResponses->xCount < benchMAX_RESPONSES ) )
+    {
+        xLength = strcspn( cLine, "\r\n" );
+        cLine[ xLength ] = '\0';
+
+        /* Skip comments, empty lines and responses the library rejects. */
+        if( ( xLength == 0U ) || ( cLine[ 0 ] == '#' ) || ( xLength > CELLULAR_AT_MAX_STRING_SIZE ) )
+        {
+            continue;
+        }
+
+        ( void ) memcpy( pxResponses->cLines[ pxResponses->xCount ], cLine, xLength + 1U );
+        pxResponses->xCount++;
+    }
+
+    ( void ) fclose( pxFile );
+
+    return ( pxResponses->xCount > 0U ) ? 0 : -1;
+}
+
+/*-----------------------------------------------------------*/
+
+/* The current Cellular_ATGetNextTok() must return what the strtok() version
+ * returned. */
+static int prvCompare( const BenchResponses_t * pxResponses )
+{
+    char cLegacy[ CELLULAR_AT_MAX_STRING_SIZE + 1U ];
+    char cCurrent[ CELLULAR_AT_MAX_STRING_SIZE + 1U ];
+    char * pcLegacyTokens[ benchMAX_TOKENS ];
+    char * pcCurrentTokens[ benchMAX_TOKENS ];
+    size_t xLegacyCount, xCurrentCount, xLine, xToken;
+    int lMismatches = 0;
+
+    for( xLine = 0U; xLine < pxResponses->xCount; xLine++ )
+    {
+        ( void ) strcpy( cLegacy, pxResponses->cLines[ xLine ] );
+        ( void ) strcpy( cCurrent, pxResponses->cLines[ xLine ] );
+        xLegacyCount = prvTokenizeStrtok( cLegacy, pcLegacyTokens );
+        xCurrentCount = prvTokenizeNextTok( cCurrent, pcCurrentTokens );
+
+        if( xLegacyCount != xCurrentCount )
+        {
+            ( void ) printf( "MISMATCH %s: %zu tokens, was %zu\n", pxResponses->cLines[ xLine ],
+                             xCurrentCount, xLegacyCount );
+            lMismatches++;
+            continue;
+        }
+
+        for( xToken = 0U; ( xToken < xLegacyCount ) && ( xToken < benchMAX_TOKENS ); xToken++ )
+        {
+            if( strcmp( pcLegacyTokens[ xToken ], pcCurrentTokens[ xToken ] ) != 0 )
+            {
+                ( void ) printf( "MISMATCH %s: token %zu '%s', was '%s'\n", pxResponses->cLines[ xLine ],
+                                 xToken, pcCurrentTokens[ xToken ], pcLegacyTokens[ xToken ] );
+                lMismatches++;
+                break;
+            }
+        }
+    }
+
+    return lMismatches;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvRun( const char * pcName,
+                    BenchTokenize_t xTokenize,
+                    const BenchResponses_t * pxResponses,
+                    unsigned long ulPasses )
+{
+    char cWork[ CELLULAR_AT_MAX_STRING_SIZE + 1U ];
+    uint64_t ullStart, ullCopyNs, ullTotalNs;
+    unsigned long ulPass;
+    size_t xLine, xTokens = 0U;
+
+    /* The copy into the work buffer is measured separately and subtracted. */
+    ullStart = prvNow();
+
+    for( ulPass = 0UL; ulPass < ulPasses; ulPass++ )
+    {
+        for( xLine = 0U; xLine < pxResponses->xCount; xLine++ )
+        {
+            ( void ) strcpy( cWork, pxResponses->cLines[ xLine ] );
+            xTokenBytes += ( size_t ) cWork[ 0 ];
+        }
+    }
+
+    ullCopyNs = prvNow() - ullStart;
+    ullStart = prvNow();
+
+    for( ulPass = 0UL; ulPass < ulPasses; ulPass++ )
+    {
+        for( xLine = 0U; xLine < pxResponses->xCount; xLine++ )
+        {
+            ( void ) strcpy( cWork, pxResponses->cLines[ xLine ] );
+            xTokens += xTokenize( cWork );
+        }
+    }
+
+    ullTotalNs = prvNow() - ullStart;
+    ullTotalNs = ( ullTotalNs > ullCopyNs ) ? ( ullTotalNs - ullCopyNs ) : 0U;
+
+    ( void ) printf( "%-10s %8.1f ns/response %6.1f ns/token %6zu tokens/pass\n", pcName,
+                     ( double ) ullTotalNs / ( double ) ( ( uint64_t ) ulPasses * pxResponses->xCount ),
+                     ( xTokens > 0U ) ? ( double ) ullTotalNs / ( double ) xTokens : 0.0,
+                     xTokens / ulPasses );
+}
+
+/*-----------------------------------------------------------*/
+
+int main( int argc,
+          char ** argv )
+{
+    static BenchResponses_t xResponses;
+    unsigned long ulPasses = benchDEFAULT_PASSES;
+    int lArg;
+
+    if( argc < 2 )
+    {
+        ( void ) fprintf( stderr, "usage: %s <responses> [-n passes]\n", argv[ 0 ] );
+        return 2;
+    }
+
+    for( lArg = 2; lArg < argc; lArg++ )
+    {
+        if( ( strcmp( argv[ lArg ], "-n" ) == 0 ) && ( ( lArg + 1 ) < argc ) )
+        {
+            ulPasses = strtoul( argv[ ++lArg ], NULL, 10 );
+        }
+    }
+
+    if( ( ulPasses == 0UL ) || ( prvLoadResponses( argv[ 1 ], &xResponses ) != 0 ) )
+    {
+        return 2;
+    }
+
+    ( void ) printf( "%zu responses, %lu passes\n", xResponses.xCount, ulPasses );
+
+    if( prvCompare( &xResponses ) != 0 )
+    {
+        return 1;
+    }
+
+    prvRun( "strtok", prvStrtok, &xResponses, ulPasses );
+    prvRun( "nexttok", prvNextTok, &xResponses, ulPasses );
+    prvRun( "tokenizer", prvTokenizer, &xResponses, ulPasses );
+
+    return 0;
+}
@@ -0,0 +1,503 @@
+#!/usr/bin/env python3
+"""BG96 modem simulator for the POSIX host build.
+
+Listens on a TCP port for the connection of comm_if_posix.c and answers the AT
+commands the BG96 port issues: module setup, SIM and registration queries, PDN
+activation, DNS and the socket service. Sockets opened with AT+QIOPEN are
+relayed to real host sockets, so a local CoAP/UDP/LwM2M server can stand in
+for the 1NCE endpoints (see --map-host).
+
+Usage:
+    python3 Tools/bg96_sim.py [--port 5555] [--map-host coap.os.1nce.com=127.0.0.1]
+                              [--latency-ms 0] [--drop-rate 0.0]
+                              [--psm TAU,ACTIVE] [--edrx VALUE] [--pdn-drop SECONDS]
+"""
+
+import argparse
+import heapq
+import random
+import re
+import selectors
+import socket
+import sys
+import time
+
+IMEI = "866425030000001"
+ICCID = "8988228066600000001"
+IMSI = "901405100000001"
+PDN_ADDRESS = "10.0.0.2"
+OPERATOR = "26201"
+TAC = "1A2B"
+CELL_ID = "01A2D101"
+ACT_EMTC = 8
+ACT_EDRX_CATM1 = 4
+REGISTRATION_DELAY_S = 1.0
+MAX_QIRD_LENGTH = 1500
+
+
+def log(message):
+    print("[bg96-sim] " + message, flush=True)
+
+
+class Modem:
+    """State of one simulated module, bound to one host connection."""
+
+    def __init__(self, conn, selector, options):
+        self.conn = conn
+        self.selector = selector
+        self.options = options
+        self.rx = b""
+        self.send_request = None  # (socket id, length, address) while in data mode.
+        self.settings = {}  # Last value written per AT+QCFG/AT+QURCCFG/AT+QICSGP key.
+        self.registered = False
+        self.pdn_active = False
+        self.pdn_activations = 0
+        self.sockets = {}  # socket id -> dict(sock, proto, peer, queue)
+        self.timers = []
+        self.sequence = 0
+
+    # -- Output -------------------------------------------------------------
+
+    def write(self, data):
+        if isinstance(data, str):
+            data = data.encode()
+        try:
+            self.conn.sendall(data)
+        except OSError:
+            pass
+
+    def line(self, text):
+        self.write("\r\n" + text + "\r\n")
+
+    def ok(self, *lines):
+        for text in lines:
+            self.line(text)
+        self.line("OK")
+
+    def error(self):
+        self.line("ERROR")
+
+    def later(self, delay, callback):
+        self.sequence += 1
+        heapq.heappush(self.timers, (time.monotonic() + delay, self.sequence, callback))
+
+    def run_timers(self):
+        now = time.monotonic()
+        while self.timers and self.timers[0][0] <= now:
+            _, _, callback = heapq.heappop(self.timers)
+            callback()
+
+    def next_timeout(self):
+        if not self.timers:
+            return None
+        return max(0.0, self.timers[0][0] - time.monotonic())
+
+    # -- Input --------------------------------------------------------------
+
+    def feed(self, data):
+        self.rx += data
+        while True:
+            if self.send_request is not None:
+                socket_id, length, address = self.send_request
+                if len(self.rx) < length:
+                    return
+                payload, self.rx = self.rx[:length], self.rx[length:]
+                self.send_request = None
+                self.socket_send(socket_id, payload, address)
+                continue
+
+            end = self.rx.find(b"\r")
+            if end < 0:
+                return
+            command = self.rx[:end].decode(errors="replace").strip()
+            self.rx = self.rx[end + 1:].lstrip(b"\n")
+            if command:
+                self.dispatch(command)
+
+    def dispatch(self, command):
+        log("<- " + command)
+        upper = command.upper()
+
+        for pattern, handler in COMMANDS:
+            match = re.fullmatch(pattern, command, re.IGNORECASE)
+            if match:
+                handler(self, *match.groups())
+                return
+
+        # Settings are remembered so that read-back queries report them.
+        match = re.fullmatch(r'AT\+(QCFG|QURCCFG)="([^"]+)"(?:,(.*))?', command, re.IGNORECASE)
+        if match:
+            self.config(match.group(1).upper(), match.group(2), match.group(3))
+            return
+
+        if upper.startswith("AT"):
+            self.ok()
+        else:
+            self.error()
+
+    # -- Module and network -------------------------------------------------
+
+    def config(self, family, key, value):
+        stored = self.settings.get((family, key))
+        if value is None:
+            if stored is None:
+                self.error()
+            else:
+                self.ok('+%s: "%s",%s' % (family, key, stored))
+        else:
+            # Apply suffixes like ",1" (take effect immediately) are not echoed back.
+            if family == "QCFG" and key in ("nwscanmode", "iotopmode", "nwscanseq"):
+                value = value.split(",")[0]
+            self.settings[(family, key)] = value
+            self.ok()
+
+    def cfun(self, mode):
+        self.ok()
+        if mode == "1":
+            self.later(REGISTRATION_DELAY_S, self.register)
+        else:
+            self.registered = False
+            self.pdn_active = False
+            self.line("+CEREG: 0")
+            self.line("+CGREG: 0")
+
+    def register(self):
+        self.registered = True
+        log("registered on %s" % OPERATOR)
+        self.line('+CREG: 5,"%s","%s",%d' % (TAC, CELL_ID, ACT_EMTC))
+        self.line('+CGREG: 5,"%s","%s",%d' % (TAC, CELL_ID, ACT_EMTC))
+        self.line('+CEREG: 5,"%s","%s",%d' % (TAC, CELL_ID, ACT_EMTC))
+
+    def registration(self, name):
+        if self.registered:
+            self.ok('+%s: 2,5,"%s","%s",%d' % (name.upper(), TAC, CELL_ID, ACT_EMTC))
+        else:
+            self.ok("+%s: 2,2" % name.upper())
+
+    def cops(self):
+        if self.registered:
+            self.ok('+COPS: 0,2,"%s",%d' % (OPERATOR, ACT_EMTC))
+        else:
+            self.ok("+COPS: 0")
+
+    def qicsgp_query(self, context_id):
+        stored = self.settings.get(("QICSGP", context_id), '1,"iot.1nce.net","","",0')
+        self.ok("+QICSGP: " + stored)
+
+    def qicsgp_set(self, context_id, value):
+        self.settings[("QICSGP", context_id)] = value
+        self.ok()
+
+    def qiact_query(self):
+        if self.pdn_active:
+            self.ok('+QIACT: 1,1,1,"%s"' % PDN_ADDRESS)
+        else:
+            self.ok()
+
+    def qiact(self, context_id):
+        if not self.registered:
+            self.error()
+            return
+        self.pdn_active = True
+        self.pdn_activations += 1
+        self.ok()
+        if self.options.pdn_drop is not None:
+            activation = self.pdn_activations
+            self.later(self.options.pdn_drop, lambda: self.drop_pdn(activation, context_id))
+
+    def qideact(self, context_id):
+        self.pdn_active = False
+        self.ok()
+
+    def drop_pdn(self, activation, context_id):
+        # Only the activation the timer was started for, and only once.
+        if not self.pdn_active or activation != self.pdn_activations:
+            return
+        log("PDN %s deactivated by the network" % context_id)
+        self.pdn_active = False
+        for socket_id in list(self.sockets):
+            self.close_socket(socket_id)
+        self.line('+QIURC: "pdpdeact",%s' % context_id)
+
+    def qpsms(self):
+        if self.options.psm is None:
+            self.ok("+QPSMS: 0")
+        else:
+            self.ok('+QPSMS: 1,,,"%d","%d"' % self.options.psm)
+
+    def cedrxs(self):
+        if self.options.edrx is None:
+            self.ok("+CEDRXS: 0")
+        else:
+            self.ok('+CEDRXS: %d,"%s"' % (ACT_EDRX_CATM1, format(self.options.edrx, "04b")))
+
+    def cgpaddr(self, context_id):
+        address = PDN_ADDRESS if self.pdn_active else "0.0.0.0"
+        self.ok("+CGPADDR: %s,%s" % (context_id, address))
+
+    def dns(self, context_id, host):
+        self.ok()
+        address = self.options.hosts.get(host.lower())
+        if address is None:
+            try:
+                address = socket.gethostbyname(host)
+            except OSError:
+                self.later(0.1, lambda: self.line('+QIURC: "dnsgip",565'))
+                return
+        log("dns %s -> %s" % (host, address))
+
+        def reply():
+            self.line('+QIURC: "dnsgip",0,1,600')
+            self.line('+QIURC: "dnsgip","%s"' % address)
+
+        self.later(0.1, reply)
+
+    # -- Socket service -----------------------------------------------------
+
+    def qiopen(self, context_id, socket_id, service, host, port_a, port_b, access_mode):
+        socket_id = int(socket_id)
+        service = service.upper()
+        self.ok()
+
+        result = 0
+        try:
+            if service == "TCP":
+                sock = socket.create_connection((host, int(port_a)), timeout=5)
+                peer = None
+            elif service == "UDP":
+                sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+                sock.connect((host, int(port_a)))
+                peer = (host, int(port_a))
+            elif service == "UDP SERVICE":
+                sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+                # The remote port is 0; the local port is the one to listen on.
+                sock.bind(("0.0.0.0", int(port_b)))
+                peer = None
+            else:
+                raise OSError("unsupported service " + service)
+            sock.setblocking(False)
+        except OSError as exc:
+            log("QIOPEN %d failed: %s" % (socket_id, exc))
+            result = 566
+        else:
+            self.sockets[socket_id] = {"sock": sock, "service": service, "peer": peer, "queue": []}
+            self.selector.register(sock, selectors.EVENT_READ, ("socket", socket_id))
+            log("socket %d open, %s %s:%s" % (socket_id, service, host, port_a))
+
+        self.later(0.05, lambda: self.line("+QIOPEN: %d,%d" % (socket_id, result)))
+
+    def qisend(self, socket_id, length, host=None, port=None):
+        socket_id = int(socket_id)
+        if socket_id not in self.sockets:
+            self.error()
+            return
+        address = (host, int(port)) if host is not None else None
+        self.send_request = (socket_id, int(length), address)
+        self.write("> ")
+
+    def socket_send(self, socket_id, payload, address):
+        entry = self.sockets.get(socket_id)
+        self.line("SEND OK")
+        if entry is None:
+            return
+
+        if random.random() < self.options.drop_rate:
+            log("socket %d dropped %d bytes uplink" % (socket_id, len(payload)))
+            return
+
+        def transmit():
+            try:
+                if address is not None:
+                    entry["sock"].sendto(payload, address)
+                else:
+                    entry["sock"].send(payload)
+                log("socket %d sent %d bytes" % (socket_id, len(payload)))
+            except OSError as exc:
+                log("socket %d send failed: %s" % (socket_id, exc))
+
+        self.later(self.options.latency, transmit)
+
+    def socket_readable(self, socket_id):
+        entry = self.sockets.get(socket_id)
+        if entry is None:
+            return
+        try:
+            if entry["service"] == "TCP":
+                data, source = entry["sock"].recv(MAX_QIRD_LENGTH), None
+                if not data:
+                    self.close_socket(socket_id)
+                    self.line('+QIURC: "closed",%d' % socket_id)
+                    return
+            else:
+                data, source = entry["sock"].recvfrom(MAX_QIRD_LENGTH)
+        except OSError:
+            return
+
+        if random.random() < self.options.drop_rate:
+            log("socket %d dropped %d bytes downlink" % (socket_id, len(data)))
+            return
+
+        def deliver():
+            if socket_id in self.sockets:
+                log("socket %d received %d bytes" % (socket_id, len(data)))
+                was_empty = not entry["queue"]
+                entry["queue"].append((data, source))
+                if was_empty:
+                    self.line('+QIURC: "recv",%d' % socket_id)
+
+        self.later(self.options.latency, deliver)
+
+    def qird(self, socket_id, length):
+        entry = self.sockets.get(int(socket_id))
+        if entry is None:
+            self.error()
+            return
+        if not entry["queue"]:
+            self.ok("+QIRD: 0")
+            return
+
+        data, source = entry["queue"][0]
+        chunk, rest = data[:int(length)], data[int(length):]
+        if rest and entry["service"] == "TCP":
+            entry["queue"][0] = (rest, source)
+        else:
+            entry["queue"].pop(0)
+
+        if entry["service"] == "UDP SERVICE":
+            header = '+QIRD: %d,"%s",%d' % (len(chunk), source[0], source[1])
+        else:
+            header = "+QIRD: %d" % len(chunk)
+        self.write(("\r\n" + header + "\r\n").encode() + chunk + b"\r\n\r\nOK\r\n")
+
+        if entry["queue"]:
+            self.line('+QIURC: "recv",%s' % socket_id)
+
+    def qiclose(self, socket_id):
+        self.close_socket(int(socket_id))
+        self.ok()
+
+    def close_socket(self, socket_id):
+        entry = self.sockets.pop(socket_id, None)
+        if entry is not None:
+            self.selector.unregister(entry["sock"])
+            entry["sock"].close()
+            log("socket %d closed" % socket_id)
+
+    def close(self):
+        for socket_id in list(self.sockets):
+            self.close_socket(socket_id)
+
+
+# Command table: full-match pattern and handler. Unknown AT commands answer OK.
+COMMANDS = [
+    (r"AT", lambda m: m.ok()),
+    (r"ATE0", lambda m: m.ok()),
+    (r"AT\+CGMI", lambda m: m.ok("Quectel")),
+    (r"AT\+CGMM", lambda m: m.ok("BG96")),
+    (r"AT\+CGMR", lambda m: m.ok("BG96MAR02A07M1G")),
+    (r"AT\+CGSN", lambda m: m.ok(IMEI)),
+    (r"AT\+CIMI", lambda m: m.ok(IMSI)),
+    (r"AT\+QCCID", lambda m: m.ok("+QCCID: " + ICCID)),
+    (r"AT\+CCID", lambda m: m.ok("+CCID: " + ICCID)),
+    (r"AT\+CPIN\?", lambda m: m.ok("+CPIN: READY")),
+    (r"AT\+QSIMSTAT\?", lambda m: m.ok("+QSIMSTAT: 0,1")),
+    (r"AT\+CRSM=176,28514,0,0,0", lambda m: m.ok('+CRSM: 144,0,"62F210FFFFFFFFFFFFFFFFFFFFFFFF"')),
+    (r"AT\+CSQ", lambda m: m.ok("+CSQ: 20,99")),
+    (r"AT\+QCSQ", lambda m: m.ok('+QCSQ: "eMTC",-80,-105,120,-8')),
+    (r"AT\+CCLK\?", lambda m: m.ok('+CCLK: "%s+00"' % time.strftime("%y/%m/%d,%H:%M:%S", time.gmtime()))),
+    (r"AT\+CFUN=(\d)", Modem.cfun),
+    (r"AT\+(CREG|CGREG|CEREG)\?", Modem.registration),
+    (r"AT\+COPS\?", Modem.cops),
+    (r"AT\+QICSGP=(\d+)", Modem.qicsgp_query),
+    (r"AT\+QICSGP=(\d+),(.+)", Modem.qicsgp_set),
+    (r"AT\+QIACT\?", Modem.qiact_query),
+    (r"AT\+QIACT=(\d+)", Modem.qiact),
+    (r"AT\+QIDEACT=(\d+)", Modem.qideact),
+    (r"AT\+CGPADDR=(\d+)", Modem.cgpaddr),
+    (r"AT\+QPSMS\?", Modem.qpsms),
+    (r"AT\+CEDRXS\?", Modem.cedrxs),
+    (r'AT\+QIDNSGIP=(\d+),"([^"]+)"', Modem.dns),
+    (r'AT\+QIOPEN=(\d+),(\d+),"([^"]+)","([^"]+)",(\d+),(\d+),(\d+)', Modem.qiopen),
+    (r'AT\+QISEND=(\d+),(\d+),"([^"]+)",(\d+)', Modem.qisend),
+    (r"AT\+QISEND=(\d+),(\d+)", Modem.qisend),
+    (r"AT\+QIRD=(\d+),(\d+)", Modem.qird),
+    (r"AT\+QICLOSE=(\d+)", Modem.qiclose),
+]
+
+
+def parse_args():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--port", type=int, default=5555, help="TCP port the host build connects to")
+    parser.add_argument("--map-host", action="append", default=[], metavar="NAME=ADDRESS",
+                        help="answer AT+QIDNSGIP for NAME with ADDRESS, e.g. coap.os.1nce.com=127.0.0.1")
+    parser.add_argument("--latency-ms", type=float, default=0.0, help="one-way delay added to relayed data")
+    parser.add_argument("--drop-rate", type=float, default=0.0, help="probability of dropping a relayed datagram")
+    parser.add_argument("--psm", metavar="TAU,ACTIVE",
+                        type=lambda value: tuple(int(part) for part in value.split(",")),
+                        help="report PSM with these periodic TAU and active time in seconds in AT+QPSMS?")
+    parser.add_argument("--edrx", type=int, metavar="VALUE",
+                        help="report this 4 bit e-I-DRX cycle value for Cat M1 in AT+CEDRXS?")
+    parser.add_argument("--pdn-drop", type=float, metavar="SECONDS",
+                        help='deactivate the PDN this long after every activation, with +QIURC: "pdpdeact"')
+    options = parser.parse_args()
+
+    options.latency = options.latency_ms / 1000.0
+    options.hosts = {}
+    for mapping in options.map_host:
+        name, _, address = mapping.partition("=")
+        if not address:
+            parser.error("--map-host expects NAME=ADDRESS")
+        options.hosts[name.lower()] = address
+    return options
+
+
+def main():
+    options = parse_args()
+    selector = selectors.DefaultSelector()
+    server = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+    server.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+    server.bind(("127.0.0.1", options.port))
+    server.listen(1)
+    selector.register(server, selectors.EVENT_READ, ("server", None))
+    log("listening on 127.0.0.1:%d" % options.port)
+
+    modem = None
+    while True:
+        timeout = modem.next_timeout() if modem is not None else None
+        for key, _ in selector.select(timeout):
+            kind, socket_id = key.data
+            if kind == "server":
+                conn, peer = server.accept()
+                if modem is not None:
+                    conn.close()
+                    continue
+                conn.setblocking(False)
+                selector.register(conn, selectors.EVENT_READ, ("uart", None))
+                modem = Modem(conn, selector, options)
+                log("host connected from %s:%d" % peer)
+                modem.line("RDY")
+            elif kind == "uart":
+                try:
+                    data = key.fileobj.recv(4096)
+                except OSError:
+                    data = b""
+                if not data:
+                    log("host disconnected")
+                    selector.unregister(key.fileobj)
+                    key.fileobj.close()
+                    modem.close()
+                    modem = None
+                    continue
+                modem.feed(data)
+            elif kind == "socket" and modem is not None:
+                modem.socket_readable(socket_id)
+
+        if modem is not None:
+            modem.run_timers()
+
+
+if __name__ == "__main__":
+    try:
+        main()
+    except KeyboardInterrupt:
+        sys.exit(0)
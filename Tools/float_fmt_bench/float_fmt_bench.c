@@ -0,0 +1,734 @@
+/*
+ * float_fmt_bench.c
+ *
+ *  Micro-benchmark of the number formatting of wakaama
+ *  (Middleware/wakaama/core/utils.c) used by the text, JSON and SenML JSON
+ *  serializers:
+ *
+ *  legacy     the previous digit by digit utils_floatToText() and
+ *             utils_uintToText(), kept here as the reference
+ *  utils      the current Grisu2 utils_floatToText() and table based
+ *             utils_intToText()
+ *  snprintf   "%.17g" and "%lld" of the C library
+ *
+ *  over three sets of values: decimal fractions as sensors report them,
+ *  random doubles over the whole range and 32 bit integers. Every value
+ *  formatted by utils_floatToText() has to convert back to the same double
+ *  with utils_textToFloat(), a difference fails the run.
+ *
+ *  The host has a double precision FPU, the Cortex-M4 of the board has not.
+ *  The legacy routine is built on double multiplications and divisions and
+ *  loses far more there than it does here.
+ *
+ *  Usage: float_fmt_bench [-n passes]
+ *
+ *  1NCE GmbH
+ */
+
+#include <float.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "liblwm2m.h"
+#include "internals.h"
+
+#define benchVALUES            ( 4096U )
+#define benchBUFFER_SIZE       ( 330U )
+#define benchDEFAULT_PASSES    ( 200UL )
+
+typedef size_t ( * BenchFormat_t )( double dValue,
+                                    uint8_t * pucBuffer,
+                                    size_t xLength );
+
+typedef struct BenchSet
+{
+    const char * pcName;
+    double dValues[ benchVALUES ];
+} BenchSet_t;
+
+/* Sum of the text lengths, so that the work cannot be optimised away. */
+static volatile size_t xTextBytes = 0U;
+
+/*-----------------------------------------------------------*/
+
+/* utils_textToFloat() allocates a work copy. */
+void * lwm2m_malloc( size_t s )
+{
+    return malloc( s );
+}
+
+void lwm2m_free( void * p )
+{
+    free( p );
+}
+
+#ifdef LWM2M_CLIENT_MODE
+
+/* Referenced by the server lookups of utils.c when the LwM2M demo is
+ * enabled, never called by the benchmark. */
+bool lwm2m_session_is_equal( void * session1,
+                             void * session2,
+                             void * userData )
+{
+    ( void ) userData;
+
+    return session1 == session2;
+}
+
+#endif
+
+/*-----------------------------------------------------------*/
+
+static uint64_t prvNow( void )
+{
+    struct timespec xTime;
+
+    ( void ) clock_gettime( CLOCK_MONOTONIC, &xTime );
+
+    return ( ( uint64_t ) xTime.tv_sec * 1000000000ULL ) + ( uint64_t ) xTime.tv_nsec;
+}
+
+/*-----------------------------------------------------------*/
+
+static uint64_t prvRandom( void )
+{
+    static uint64_t ullState = 0x9E3779B97F4A7C15ULL;
+
+    ullState ^= ullState << 13;
+    ullState ^= ullState >> 7;
+    ullState ^= ullState << 17;
+
+    return ullState;
+}
+
+/*-----------------------------------------------------------*/
+
+/* utils_uintToText() as it was before the digit pair table, kept here as the
+ * reference. */
+static size_t prvLegacyUintToText( uint64_t data,
+                                   uint8_t * string,
+                                   size_t length )
+{
+    int index;
+    size_t result;
+
+    if( length == 0 )
+    {
+        return 0;
+    }
+
+    index = length - 1;
+
+    do
+    {
+        string[ index ] = '0' + data % 10;
+        data /= 10;
+        index--;
+    } while( index >= 0 && data > 0 );
+
+    if( data > 0 )
+    {
+        return 0;
+    }
+
+    index++;
+
+    result = length - index;
+
+    if( result < length )
+    {
+        memmove( string, string + index, result );
+        string[ result ] = '\0';
+    }
+
+    return result;
+}
+
+/*-----------------------------------------------------------*/
+
+static size_t prvLegacyIntToText( int64_t data,
+                                  uint8_t * string,
+                                  size_t length )
+{
+    size_t result;
+
+    if( data < 0 )
+    {
+        if( length == 0 )
+        {
+            return 0;
+        }
+
+        string[ 0 ] = '-';
+        result = prvLegacyUintToText( ( uint64_t ) llabs( data ), string + 1, length - 1 );
+
+        if( result != 0 )
+        {
+            result += 1;
+        }
+    }
+    else
+    {
+        result = prvLegacyUintToText( ( uint64_t ) data, string, length );
+    }
+
+    return result;
+}
+
+/*-----------------------------------------------------------*/
+
+/* utils_floatToText() as it was before Grisu2, kept here as the reference. */
+static size_t prvLegacyFloatToText( double data,
+                                    uint8_t * string,
+                                    size_t length,
+                                    bool allowExponential )
+{
+    uint64_t intPart;
+    double decPart;
+    double noiseFloor;
+    double roundCheck;
+    size_t res;
+    size_t head = 0;
+    int zeros = 0; /* positive for trailing, negative for leading */
+    uint8_t expLen = 0;
+    int precisionFactor = 1; /* Adjusts for inaccuracies caused by power of 10 operations. */
+    unsigned digits;
+
+    if( !length || !string )
+    {
+        return 0;
+    }
+
+    if( data < 0 )
+    {
+        string[ head++ ] = '-';
+        data = -data;
+    }
+
+    /* Handle special cases */
+    if( data < DBL_MIN )
+    {
+        if( length < 3 )
+        {
+            return 0;
+        }
+
+        string[ 0 ] = '0';
+        string[ 1 ] = '.';
+        string[ 2 ] = '0';
+
+        if( length > 3 )
+        {
+            string[ 3 ] = '\0';
+        }
+
+        return 3;
+    }
+    else if( data > DBL_MAX )
+    {
+        if( length < 3 + head )
+        {
+            return 0;
+        }
+
+        string[ head++ ] = 'i';
+        string[ head++ ] = 'n';
+        string[ head++ ] = 'f';
+
+        if( length > head )
+        {
+            string[ head ] = '\0';
+        }
+
+        return head;
+    }
+    else if( isnan( data ) )
+    {
+        if( length < 3 + head )
+        {
+            return 0;
+        }
+
+        string[ head++ ] = 'n';
+        string[ head++ ] = 'a';
+        string[ head++ ] = 'n';
+
+        if( length > head )
+        {
+            string[ head ] = '\0';
+        }
+
+        return head;
+    }
+
+    /* Scale to usable range. Assumes DBL_DIG is 15 (IEEE 754 double) */
+    if( data > 1e15 )
+    {
+        while( data > 1e100 )
+        {
+            data *= 1e-100;
+            zeros += 100;
+            precisionFactor++;
+        }
+
+        if( allowExponential )
+        {
+            /* Take data down below 10 so only 1 digit before the decimal point */
+            while( data > 1e10 )
+            {
+                data *= 1e-10;
+                zeros += 10;
+                precisionFactor++;
+            }
+
+            while( data > 10 )
+            {
+                data *= 0.1;
+                zeros += 1;
+                precisionFactor++;
+            }
+
+            if( zeros >= 100 )
+            {
+                expLen = 4;
+            }
+            else if( zeros >= 10 )
+            {
+                expLen = 3;
+            }
+            else
+            {
+                expLen = 2;
+            }
+        }
+        else
+        {
+            /* Take data down to 15 significant digits before 0s. */
+            while( data >= 1e25 )
+            {
+                data *= 1e-10;
+                zeros += 10;
+                precisionFactor++;
+            }
+
+            while( data > 1e15 )
+            {
+                data *= 0.1;
+                zeros += 1;
+                precisionFactor++;
+            }
+
+            /* Account for lost digits of precision */
+            if( precisionFactor >= 19 )
+            {
+                data *= 0.01;
+                zeros += 2;
+                precisionFactor++;
+            }
+            else if( precisionFactor >= 10 )
+            {
+                data *= 0.1;
+                zeros += 1;
+                precisionFactor++;
+            }
+        }
+    }
+    /* Exponential notation will add at least 3 characters. Make sure we save
+     * at least that many 0s. */
+    else if( data < ( allowExponential ? 1e-3 : 0.1 ) )
+    {
+        /* For exponential notation take data to between 1 and 10, excluding 10.
+         * Otherwise take data to between 0.1 and 1, excluding 1. */
+        while( data < 1e-100 )
+        {
+            data *= 1e100;
+            zeros -= 100;
+            precisionFactor++;
+        }
+
+        while( data < 1e-10 )
+        {
+            data *= 1e10;
+            zeros -= 10;
+            precisionFactor++;
+        }
+
+        while( data < ( allowExponential ? 1 : 0.1 ) )
+        {
+            data *= 10;
+            zeros -= 1;
+            precisionFactor++;
+        }
+
+        if( allowExponential )
+        {
+            if( zeros <= -100 )
+            {
+                expLen = 5;
+            }
+            else if( zeros <= -10 )
+            {
+                expLen = 4;
+            }
+            else
+            {
+                expLen = 3;
+            }
+        }
+    }
+
+    noiseFloor = DBL_EPSILON * precisionFactor;
+    /* Adjust the noise floor to account for digits left of the decimal point. */
+    intPart = ( uint64_t ) data;
+
+    if( !intPart )
+    {
+        /* Leading 0 and decimal point */
+        digits = 2;
+    }
+    else
+    {
+        /* Decimal point */
+        digits = 1;
+    }
+
+    while( intPart > 0 )
+    {
+        noiseFloor *= 10;
+        intPart /= 10;
+        digits++;
+    }
+
+    intPart = ( uint64_t ) data;
+    decPart = data - intPart;
+
+    if( !allowExponential && zeros > 0 )
+    {
+        /* Ensure all significant digits are left of the zeros */
+        while( zeros > 0 && noiseFloor < 1 )
+        {
+            decPart *= 10;
+            intPart = intPart * 10 + ( unsigned ) decPart;
+            decPart -= ( unsigned ) decPart;
+            zeros--;
+            noiseFloor *= 10;
+            digits++;
+        }
+
+        decPart = 0;
+    }
+
+    if( decPart > noiseFloor )
+    {
+        /* Add 1 to the decimal part so we don't lose leading 0s. */
+        decPart += 1;
+
+        /* Limit the number of digits to space in the buffer and round. */
+        roundCheck = 2;
+
+        do
+        {
+            digits++;
+
+            if( head + expLen + digits > length )
+            {
+                break;
+            }
+
+            decPart *= 10;
+            roundCheck *= 10;
+            noiseFloor *= 10;
+        } while( decPart - ( uint64_t ) decPart > noiseFloor );
+
+        decPart += 0.5;
+
+        if( decPart >= roundCheck )
+        {
+            intPart += 1;
+        }
+    }
+
+    /* Put out the significant digits left of the decimal point or zeros. */
+    res = prvLegacyUintToText( intPart, string + head, length - head );
+
+    if( res == 0 )
+    {
+        return 0;
+    }
+
+    head += res;
+
+    if( decPart <= noiseFloor ||
+        ( !allowExponential && -zeros >= ( int ) ( length - head ) ) )
+    {
+        /* Only 0s right of the significant digits */
+        if( !allowExponential && zeros > 0 )
+        {
+            if( head + zeros > length )
+            {
+                return 0;
+            }
+
+            memset( string + head, '0', zeros );
+            head += zeros;
+        }
+
+        /* Add as much of ".0" as space permits */
+        if( head < length )
+        {
+            string[ head++ ] = '.';
+        }
+
+        if( head < length )
+        {
+            string[ head++ ] = '0';
+        }
+
+        if( head < length )
+        {
+            string[ head ] = '\0';
+        }
+
+        return head;
+    }
+
+    if( !allowExponential && zeros < 0 )
+    {
+        /* Add "." plus leading 0s. Leaving one off to be added back later. */
+        if( head - zeros > length )
+        {
+            return 0;
+        }
+
+        string[ head ] = '.';
+
+        if( zeros < -1 )
+        {
+            memset( string + head + 1, '0', -( zeros ) - 1 );
+        }
+
+        head -= zeros;
+    }
+
+    /* Digits for the fractional part. */
+    res = prvLegacyUintToText( ( uint64_t ) decPart, string + head, length - head );
+
+    if( !res )
+    {
+        return 0;
+    }
+
+    /* Replace the leading 1 with a decimal point or 0 */
+    if( !allowExponential && zeros < 0 )
+    {
+        string[ head ] = '0';
+    }
+    else
+    {
+        string[ head ] = '.';
+    }
+
+    head += res;
+
+    if( allowExponential && zeros )
+    {
+        if( head + expLen > length )
+        {
+            return 0;
+        }
+
+        string[ head++ ] = 'e';
+        res = prvLegacyIntToText( zeros, string + head, length - head );
+
+        if( res == 0 )
+        {
+            return 0;
+        }
+
+        head += res;
+    }
+
+    return head;
+}
+
+/*-----------------------------------------------------------*/
+
+static size_t prvLegacyFloat( double dValue,
+                              uint8_t * pucBuffer,
+                              size_t xLength )
+{
+    return prvLegacyFloatToText( dValue, pucBuffer, xLength, true );
+}
+
+static size_t prvUtilsFloat( double dValue,
+                             uint8_t * pucBuffer,
+                             size_t xLength )
+{
+    return utils_floatToText( dValue, pucBuffer, xLength, true );
+}
+
+static size_t prvSnprintfFloat( double dValue,
+                                uint8_t * pucBuffer,
+                                size_t xLength )
+{
+    return ( size_t ) snprintf( ( char * ) pucBuffer, xLength, "%.17g", dValue );
+}
+
+static size_t prvLegacyInt( double dValue,
+                            uint8_t * pucBuffer,
+                            size_t xLength )
+{
+    return prvLegacyIntToText( ( int64_t ) dValue, pucBuffer, xLength );
+}
+
+static size_t prvUtilsInt( double dValue,
+                           uint8_t * pucBuffer,
+                           size_t xLength )
+{
+    return utils_intToText( ( int64_t ) dValue, pucBuffer, xLength );
+}
+
+static size_t prvSnprintfInt( double dValue,
+                              uint8_t * pucBuffer,
+                              size_t xLength )
+{
+    return ( size_t ) snprintf( ( char * ) pucBuffer, xLength, "%lld", ( long long ) dValue );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvFillSets( BenchSet_t * pxSensor,
+                         BenchSet_t * pxRandom,
+                         BenchSet_t * pxIntegers )
+{
+    uint64_t ullBits;
+    size_t i;
+
+    pxSensor->pcName = "sensor";
+    pxRandom->pcName = "random";
+    pxIntegers->pcName = "integer";
+
+    for( i = 0U; i < benchVALUES; i++ )
+    {
+        /* Two or three decimals in a range of a few thousand. */
+        pxSensor->dValues[ i ] = ( double ) ( ( int64_t ) ( prvRandom() % 2000000U ) - 1000000 ) /
+                                 ( ( ( i & 1U ) != 0U ) ? 100.0 : 1000.0 );
+
+        do
+        {
+            ullBits = prvRandom();
+            ( void ) memcpy( &pxRandom->dValues[ i ], &ullBits, sizeof( double ) );
+        } while( isnan( pxRandom->dValues[ i ] ) || isinf( pxRandom->dValues[ i ] ) );
+
+        pxIntegers->dValues[ i ] = ( double ) ( int32_t ) ( uint32_t ) prvRandom();
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/* Every text of utils_floatToText() has to convert back to the same value. */
+static int prvCheckRoundTrip( const BenchSet_t * pxSet )
+{
+    uint8_t ucBuffer[ benchBUFFER_SIZE ];
+    double dBack;
+    size_t xLength, i;
+    int lMismatches = 0;
+    int lExponential;
+
+    for( i = 0U; i < benchVALUES; i++ )
+    {
+        for( lExponential = 0; lExponential < 2; lExponential++ )
+        {
+            xLength = utils_floatToText( pxSet->dValues[ i ], ucBuffer, sizeof( ucBuffer ), lExponential != 0 );
+
+            if( ( xLength == 0U ) ||
+                ( utils_textToFloat( ucBuffer, ( int ) xLength, &dBack, lExponential != 0 ) == 0 ) ||
+                ( dBack != pxSet->dValues[ i ] ) )
+            {
+                ( void ) printf( "MISMATCH %s %.17g: '%.*s'\n", pxSet->pcName, pxSet->dValues[ i ],
+                                 ( int ) xLength, ( const char * ) ucBuffer );
+                lMismatches++;
+            }
+        }
+    }
+
+    return lMismatches;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvRun( const char * pcName,
+                    BenchFormat_t xFormat,
+                    const BenchSet_t * pxSet,
+                    unsigned long ulPasses )
+{
+    uint8_t ucBuffer[ benchBUFFER_SIZE ];
+    uint64_t ullStart, ullTotalNs;
+    unsigned long ulPass;
+    size_t i, xBytes = 0U;
+
+    ullStart = prvNow();
+
+    for( ulPass = 0UL; ulPass < ulPasses; ulPass++ )
+    {
+        for( i = 0U; i < benchVALUES; i++ )
+        {
+            xBytes += xFormat( pxSet->dValues[ i ], ucBuffer, sizeof( ucBuffer ) );
+        }
+    }
+
+    ullTotalNs = prvNow() - ullStart;
+    xTextBytes += xBytes;
+
+    ( void ) printf( "%-8s %-9s %8.1f ns/value %5.1f chars/value\n", pxSet->pcName, pcName,
+                     ( double ) ullTotalNs / ( double ) ( ( uint64_t ) ulPasses * benchVALUES ),
+                     ( double ) xBytes / ( double ) ( ( uint64_t ) ulPasses * benchVALUES ) );
+}
+
+/*-----------------------------------------------------------*/
+
+int main( int argc,
+          char ** argv )
+{
+    static BenchSet_t xSensor, xRandom, xIntegers;
+    unsigned long ulPasses = benchDEFAULT_PASSES;
+    int lArg;
+
+    for( lArg = 1; lArg < argc; lArg++ )
+    {
+        if( ( strcmp( argv[ lArg ], "-n" ) == 0 ) && ( ( lArg + 1 ) < argc ) )
+        {
+            ulPasses = strtoul( argv[ ++lArg ], NULL, 10 );
+        }
+    }
+
+    if( ulPasses == 0UL )
+    {
+        ( void ) fprintf( stderr, "usage: %s [-n passes]\n", argv[ 0 ] );
+        return 2;
+    }
+
+    prvFillSets( &xSensor, &xRandom, &xIntegers );
+    ( void ) printf( "%u values per set, %lu passes\n", benchVALUES, ulPasses );
+
+    if( ( prvCheckRoundTrip( &xSensor ) + prvCheckRoundTrip( &xRandom ) + prvCheckRoundTrip( &xIntegers ) ) != 0 )
+    {
+        return 1;
+    }
+
+    prvRun( "legacy", prvLegacyFloat, &xSensor, ulPasses );
+    prvRun( "utils", prvUtilsFloat, &xSensor, ulPasses );
+    prvRun( "snprintf", prvSnprintfFloat, &xSensor, ulPasses );
+    prvRun( "legacy", prvLegacyFloat, &xRandom, ulPasses );
+    prvRun( "utils", prvUtilsFloat, &xRandom, ulPasses );
+    prvRun( "snprintf", prvSnprintfFloat, &xRandom, ulPasses );
+    prvRun( "legacy", prvLegacyInt, &xIntegers, ulPasses );
+    prvRun( "utils", prvUtilsInt, &xIntegers, ulPasses );
+    prvRun( "snprintf", prvSnprintfInt, &xIntegers, ulPasses );
+
+    return 0;
+}
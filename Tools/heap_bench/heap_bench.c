@@ -0,0 +1,482 @@
+/*
+ * heap_bench.c
+ *
+ *  Replays an allocation trace recorded by the host build (see NCE_HEAP_TRACE
+ *  in Core/Posix/Src/heap_trace.c) against the FreeRTOS heap implementation
+ *  this file is linked with, and reports allocation latency, failed
+ *  allocations and fragmentation. cmake/posix builds it twice, as
+ *  heap_bench_pool (Core/Src/heap_pool.c) and heap_bench_heap5 (heap_5.c).
+ *
+ *  Usage: heap_bench_<heap> <trace> [-r size[,size...]] [-n passes]
+ *
+ *  -r  sizes in bytes of the heap regions, default two regions of 27 KB and
+ *      32 KB like the firmware. Traces recorded on a 64 bit host need larger
+ *      regions than that.
+ *  -n  number of times the trace is replayed. Blocks still allocated at the
+ *      end of a pass are freed before the next one.
+ *
+ *  1NCE GmbH
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#ifdef HEAP_BENCH_POOL
+    #include "heap_pool.h"
+#endif
+
+#define benchMAX_REGIONS           ( 4 )
+#define benchDEFAULT_REGION_1      ( 27 * 1024 )
+#define benchDEFAULT_REGION_2      ( 32 * 1024 )
+
+/* Fragmentation is sampled every benchSAMPLE_INTERVAL operations. */
+#define benchSAMPLE_INTERVAL       ( 16U )
+
+typedef struct BenchOp
+{
+    uint32_t ulSlot;  /**< Index of the block in pvSlots. */
+    uint32_t ulSize;  /**< Requested size, 0 for a free. */
+} BenchOp_t;
+
+typedef struct BenchTrace
+{
+    BenchOp_t * pxOps;
+    size_t xOpCount;
+    size_t xSlotCount;
+} BenchTrace_t;
+
+typedef struct BenchResult
+{
+    uint64_t ullMallocNs;
+    uint64_t ullMallocMaxNs;
+    uint64_t ullFreeNs;
+    uint64_t ullFreeMaxNs;
+    size_t xMallocs;
+    size_t xFrees;
+    size_t xFailures;
+    size_t xFragmentationMax;
+    uint64_t ullFragmentationSum;
+    size_t xSamples;
+    uint64_t ullReplayNs;
+    size_t xReplayOps;
+} BenchResult_t;
+
+/*-----------------------------------------------------------*/
+
+/* The benchmark is single threaded, the kernel hooks used by the heap
+ * implementations have nothing to do. */
+void vTaskSuspendAll( void )
+{
+}
+
+BaseType_t xTaskResumeAll( void )
+{
+    return pdFALSE;
+}
+
+void vPortEnterCritical( void )
+{
+}
+
+void vPortExitCritical( void )
+{
+}
+
+void vApplicationMallocFailedHook( void )
+{
+}
+
+void vAssertCalled( const char * pcFile,
+                    unsigned long ulLine )
+{
+    ( void ) fprintf( stderr, "ASSERT: %s:%lu\n", pcFile, ulLine );
+    abort();
+}
+
+/*-----------------------------------------------------------*/
+
+static uint64_t prvNow( void )
+{
+    struct timespec xTime;
+
+    ( void ) clock_gettime( CLOCK_MONOTONIC, &xTime );
+
+    return ( ( uint64_t ) xTime.tv_sec * 1000000000ULL ) + ( uint64_t ) xTime.tv_nsec;
+}
+
+/*-----------------------------------------------------------*/
+
+/* Open addressing map from the addresses in the trace to slot indexes. */
+static size_t prvMapFind( const uint64_t * pullKeys,
+                          size_t xCapacity,
+                          uint64_t ullKey )
+{
+    size_t xIndex = ( size_t ) ( ( ullKey >> 3 ) * 0x9E3779B97F4A7C15ULL ) & ( xCapacity - 1U );
+
+    while( ( pullKeys[ xIndex ] != 0U ) && ( pullKeys[ xIndex ] != ullKey ) )
+    {
+        xIndex = ( xIndex + 1U ) & ( xCapacity - 1U );
+    }
+
+    return xIndex;
+}
+
+/*-----------------------------------------------------------*/
+
+/* Tombstones are never reused, the map is sized for every line of the trace. */
+#define benchTOMBSTONE    ( ~0ULL )
+
+static int prvLoadTrace( const char * pcFile,
+                         BenchTrace_t * pxTrace )
+{
+    FILE * pxFile = fopen( pcFile, "r" );
+    char cLine[ 128 ];
+    size_t xLines = 0U, xCapacity = 1U, xIndex;
+    uint64_t * pullKeys;
+    uint32_t * pulSlots;
+    unsigned long long ullAddress;
+    unsigned long ulSize;
+
+    if( pxFile == NULL )
+    {
+        perror( pcFile );
+        return -1;
+    }
+
+    while( fgets( cLine, sizeof( cLine ), pxFile ) != NULL )
+    {
+        xLines++;
+    }
+
+    while( xCapacity < ( xLines * 2U ) )
+    {
+        xCapacity <<= 1;
+    }
+
+    pxTrace->pxOps = calloc( xLines, sizeof( BenchOp_t ) );
+    pullKeys = calloc( xCapacity, sizeof( uint64_t ) );
+    pulSlots = calloc( xCapacity, sizeof( uint32_t ) );
+
+    if( ( pxTrace->pxOps == NULL ) || ( pullKeys == NULL ) || ( pulSlots == NULL ) )
+    {
+        ( void ) fclose( pxFile );
+        return -1;
+    }
+
+    pxTrace->xOpCount = 0U;
+    pxTrace->xSlotCount = 0U;
+    rewind( pxFile );
+
+    while( fgets( cLine, sizeof( cLine ), pxFile ) != NULL )
+    {
+        BenchOp_t * pxOp = &( pxTrace->pxOps[ pxTrace->xOpCount ] );
+
+        if( sscanf( cLine, "m %llx %lu", &ullAddress, &ulSize ) == 2 )
+        {
+            pxOp->ulSlot = ( uint32_t ) pxTrace->xSlotCount++;
+            pxOp->ulSize = ( ulSize > 0U ) ? ( uint32_t ) ulSize : 1U;
+            pxTrace->xOpCount++;
+
+            /* Failed allocations are replayed but never freed by the trace. */
+            if( ullAddress != 0U )
+            {
+                xIndex = prvMapFind( pullKeys, xCapacity, ullAddress );
+                pullKeys[ xIndex ] = ullAddress;
+                pulSlots[ xIndex ] = pxOp->ulSlot;
+            }
+        }
+        else if( sscanf( cLine, "f %llx", &ullAddress ) == 1 )
+        {
+            xIndex = prvMapFind( pullKeys, xCapacity, ullAddress );
+
+            if( pullKeys[ xIndex ] == ullAddress )
+            {
+                pxOp->ulSlot = pulSlots[ xIndex ];
+                pxOp->ulSize = 0U;
+                pxTrace->xOpCount++;
+                pullKeys[ xIndex ] = benchTOMBSTONE;
+            }
+        }
+    }
+
+    ( void ) fclose( pxFile );
+    free( pullKeys );
+    free( pulSlots );
+
+    return 0;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvSampleFragmentation( BenchResult_t * pxResult )
+{
+    size_t xFragmentation = 0U;
+
+    #ifdef HEAP_BENCH_POOL
+        HeapPoolStats_t xStats;
+
+        vPortGetHeapPoolStats( &xStats );
+        xFragmentation = xStats.xRegionFragmentation;
+    #else
+        HeapStats_t xStats;
+
+        vPortGetHeapStats( &xStats );
+
+        if( xStats.xAvailableHeapSpaceInBytes > 0U )
+        {
+            xFragmentation = 100U - ( ( xStats.xSizeOfLargestFreeBlockInBytes * 100U ) / xStats.xAvailableHeapSpaceInBytes );
+        }
+    #endif
+
+    if( xFragmentation > pxResult->xFragmentationMax )
+    {
+        pxResult->xFragmentationMax = xFragmentation;
+    }
+
+    pxResult->ullFragmentationSum += xFragmentation;
+    pxResult->xSamples++;
+}
+
+/*-----------------------------------------------------------*/
+
+/* Replays the trace once, timing and sampling every operation. */
+static void prvReplay( const BenchTrace_t * pxTrace,
+                       void ** ppvSlots,
+                       BenchResult_t * pxResult )
+{
+    size_t xOp;
+    uint64_t ullStart, ullElapsed;
+
+    for( xOp = 0U; xOp < pxTrace->xOpCount; xOp++ )
+    {
+        const BenchOp_t * pxOp = &( pxTrace->pxOps[ xOp ] );
+
+        if( pxOp->ulSize > 0U )
+        {
+            ullStart = prvNow();
+            ppvSlots[ pxOp->ulSlot ] = pvPortMalloc( pxOp->ulSize );
+            ullElapsed = prvNow() - ullStart;
+
+            pxResult->ullMallocNs += ullElapsed;
+            pxResult->xMallocs++;
+
+            if( ullElapsed > pxResult->ullMallocMaxNs )
+            {
+                pxResult->ullMallocMaxNs = ullElapsed;
+            }
+
+            if( ppvSlots[ pxOp->ulSlot ] == NULL )
+            {
+                pxResult->xFailures++;
+            }
+        }
+        else if( ppvSlots[ pxOp->ulSlot ] != NULL )
+        {
+            ullStart = prvNow();
+            vPortFree( ppvSlots[ pxOp->ulSlot ] );
+            ullElapsed = prvNow() - ullStart;
+
+            ppvSlots[ pxOp->ulSlot ] = NULL;
+            pxResult->ullFreeNs += ullElapsed;
+            pxResult->xFrees++;
+
+            if( ullElapsed > pxResult->ullFreeMaxNs )
+            {
+                pxResult->ullFreeMaxNs = ullElapsed;
+            }
+        }
+
+        if( ( xOp % benchSAMPLE_INTERVAL ) == 0U )
+        {
+            prvSampleFragmentation( pxResult );
+        }
+    }
+
+    /* Start the next pass from an empty heap. */
+    for( xOp = 0U; xOp < pxTrace->xSlotCount; xOp++ )
+    {
+        if( ppvSlots[ xOp ] != NULL )
+        {
+            vPortFree( ppvSlots[ xOp ] );
+            ppvSlots[ xOp ] = NULL;
+        }
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/* Replays the trace once without per operation measurements, to get the
+ * throughput without the cost of reading the clock. */
+static void prvReplayUntimed( const BenchTrace_t * pxTrace,
+                              void ** ppvSlots,
+                              BenchResult_t * pxResult )
+{
+    size_t xOp;
+    uint64_t ullStart = prvNow();
+
+    for( xOp = 0U; xOp < pxTrace->xOpCount; xOp++ )
+    {
+        const BenchOp_t * pxOp = &( pxTrace->pxOps[ xOp ] );
+
+        if( pxOp->ulSize > 0U )
+        {
+            ppvSlots[ pxOp->ulSlot ] = pvPortMalloc( pxOp->ulSize );
+        }
+        else if( ppvSlots[ pxOp->ulSlot ] != NULL )
+        {
+            vPortFree( ppvSlots[ pxOp->ulSlot ] );
+            ppvSlots[ pxOp->ulSlot ] = NULL;
+        }
+    }
+
+    pxResult->ullReplayNs += prvNow() - ullStart;
+    pxResult->xReplayOps += pxTrace->xOpCount;
+
+    for( xOp = 0U; xOp < pxTrace->xSlotCount; xOp++ )
+    {
+        if( ppvSlots[ xOp ] != NULL )
+        {
+            vPortFree( ppvSlots[ xOp ] );
+            ppvSlots[ xOp ] = NULL;
+        }
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvPrintResult( const BenchResult_t * pxResult )
+{
+    ( void ) printf( "mallocs           %zu\n", pxResult->xMallocs );
+    ( void ) printf( "failed mallocs    %zu\n", pxResult->xFailures );
+    ( void ) printf( "malloc avg/max ns %.1f / %llu\n",
+                     ( pxResult->xMallocs > 0U ) ? ( double ) pxResult->ullMallocNs / ( double ) pxResult->xMallocs : 0.0,
+                     ( unsigned long long ) pxResult->ullMallocMaxNs );
+    ( void ) printf( "frees             %zu\n", pxResult->xFrees );
+    ( void ) printf( "free avg/max ns   %.1f / %llu\n",
+                     ( pxResult->xFrees > 0U ) ? ( double ) pxResult->ullFreeNs / ( double ) pxResult->xFrees : 0.0,
+                     ( unsigned long long ) pxResult->ullFreeMaxNs );
+    ( void ) printf( "replay ns/op      %.1f\n",
+                     ( pxResult->xReplayOps > 0U ) ? ( double ) pxResult->ullReplayNs / ( double ) pxResult->xReplayOps : 0.0 );
+    ( void ) printf( "min ever free     %zu\n", xPortGetMinimumEverFreeHeapSize() );
+    ( void ) printf( "fragmentation     avg %.1f%% max %zu%%\n",
+                     ( pxResult->xSamples > 0U ) ? ( double ) pxResult->ullFragmentationSum / ( double ) pxResult->xSamples : 0.0,
+                     pxResult->xFragmentationMax );
+
+    #ifdef HEAP_BENCH_POOL
+    {
+        HeapPoolStats_t xStats;
+        size_t xClass;
+
+        vPortGetHeapPoolStats( &xStats );
+
+        for( xClass = 0U; xClass < xStats.xClassCount; xClass++ )
+        {
+            const HeapPoolClassStats_t * pxClass = &( xStats.xClasses[ xClass ] );
+
+            ( void ) printf( "class %4zu        blocks %zu high water %zu spills %zu failures %zu\n",
+                             pxClass->xBlockSize, pxClass->xBlockCount, pxClass->xHighWaterMark,
+                             pxClass->xSpills, pxClass->xFailures );
+        }
+
+        ( void ) printf( "region failures   %zu\n", xStats.xRegionFailures );
+    }
+    #endif /* ifdef HEAP_BENCH_POOL */
+}
+
+/*-----------------------------------------------------------*/
+
+int main( int argc,
+          char ** argv )
+{
+    HeapRegion_t xRegions[ benchMAX_REGIONS + 1 ] = { { NULL, 0 } };
+    size_t xRegionSizes[ benchMAX_REGIONS ] = { benchDEFAULT_REGION_1, benchDEFAULT_REGION_2 };
+    size_t xRegionCount = 2U, xRegion;
+    unsigned long ulPasses = 1U, ulPass;
+    const char * pcTrace = NULL;
+    BenchTrace_t xTrace;
+    BenchResult_t xResult;
+    void ** ppvSlots;
+    int iArg;
+    char * pcSize;
+
+    for( iArg = 1; iArg < argc; iArg++ )
+    {
+        if( ( strcmp( argv[ iArg ], "-r" ) == 0 ) && ( ( iArg + 1 ) < argc ) )
+        {
+            xRegionCount = 0U;
+
+            for( pcSize = strtok( argv[ ++iArg ], "," ); ( pcSize != NULL ) && ( xRegionCount < benchMAX_REGIONS ); pcSize = strtok( NULL, "," ) )
+            {
+                xRegionSizes[ xRegionCount++ ] = strtoul( pcSize, NULL, 0 );
+            }
+        }
+        else if( ( strcmp( argv[ iArg ], "-n" ) == 0 ) && ( ( iArg + 1 ) < argc ) )
+        {
+            ulPasses = strtoul( argv[ ++iArg ], NULL, 0 );
+        }
+        else
+        {
+            pcTrace = argv[ iArg ];
+        }
+    }
+
+    if( ( pcTrace == NULL ) || ( xRegionCount == 0U ) )
+    {
+        ( void ) fprintf( stderr, "usage: %s <trace> [-r size[,size...]] [-n passes]\n", argv[ 0 ] );
+        return EXIT_FAILURE;
+    }
+
+    if( prvLoadTrace( pcTrace, &xTrace ) != 0 )
+    {
+        return EXIT_FAILURE;
+    }
+
+    for( xRegion = 0U; xRegion < xRegionCount; xRegion++ )
+    {
+        xRegions[ xRegion ].pucStartAddress = malloc( xRegionSizes[ xRegion ] );
+        xRegions[ xRegion ].xSizeInBytes = xRegionSizes[ xRegion ];
+    }
+
+    /* heap_5 wants the regions sorted by address. */
+    for( xRegion = 1U; xRegion < xRegionCount; xRegion++ )
+    {
+        HeapRegion_t xInsert = xRegions[ xRegion ];
+        size_t xPosition = xRegion;
+
+        while( ( xPosition > 0U ) && ( xRegions[ xPosition - 1U ].pucStartAddress > xInsert.pucStartAddress ) )
+        {
+            xRegions[ xPosition ] = xRegions[ xPosition - 1U ];
+            xPosition--;
+        }
+
+        xRegions[ xPosition ] = xInsert;
+    }
+
+    vPortDefineHeapRegions( xRegions );
+
+    ppvSlots = calloc( xTrace.xSlotCount + 1U, sizeof( void * ) );
+    ( void ) memset( &xResult, 0, sizeof( xResult ) );
+
+    for( ulPass = 0U; ulPass < ulPasses; ulPass++ )
+    {
+        prvReplay( &xTrace, ppvSlots, &xResult );
+    }
+
+    for( ulPass = 0U; ulPass < ulPasses; ulPass++ )
+    {
+        prvReplayUntimed( &xTrace, ppvSlots, &xResult );
+    }
+
+    ( void ) printf( "trace             %s (%zu operations, %lu passes)\n", pcTrace, xTrace.xOpCount, ulPasses );
+    prvPrintResult( &xResult );
+
+    return EXIT_SUCCESS;
+}
+
+/*-----------------------------------------------------------*/
@@ -0,0 +1,454 @@
+/*
+ * lowpower_sim.c
+ *
+ *  Runs the tickless idle policy of Core/Src/low_power.c, which this file is
+ *  linked with, over a simulated telemetry schedule and estimates the energy
+ *  of the MCU and the modem for three configurations:
+ *
+ *  - tick:     configUSE_TICKLESS_IDLE 0, the idle task spins at run current
+ *              and the tick interrupt fires every millisecond.
+ *  - sleep:    tickless idle with SLEEP only, as without PSM timers.
+ *  - psm:      tickless idle with STOP 2 in the PSM windows of the modem.
+ *
+ *  Time advances in ticks of 1 ms. Every period the application wakes up and
+ *  runs a session: the modem exchanges data with the MCU every UART gap for
+ *  the session length. The modem then stays connected for the release time
+ *  (configLOW_POWER_RELEASE_MS), reachable for the active time and in PSM
+ *  until the next periodic TAU. The currents are typical STM32L496 and BG96
+ *  figures, good for comparing configurations, not for a battery budget.
+ *
+ *  Usage: lowpower_sim [-p period_s] [-n cycles] [-s session_ms] [-g gap_ms]
+ *                      [-t tau_s] [-a active_s] [-e edrx] [-b wake_ms]
+ *
+ *  -p  telemetry period, default 900 s.
+ *  -n  number of periods simulated, default 4.
+ *  -s  length of the modem session of each period, default 5000 ms.
+ *  -g  time between two modem transfers in the session, default 50 ms.
+ *  -t  periodic TAU granted by the network, default 3600 s, 0 for no PSM.
+ *  -a  active time granted by the network, default 60 s.
+ *  -e  eDRX value of AT+CEDRXS (0 - 15), default off (DRX of 1.28 s).
+ *  -b  period of an additional timer task, default 0 (none).
+ *
+ *  1NCE GmbH
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "low_power.h"
+
+#define simSUPPLY_V                   ( 3.3 )
+
+/* STM32L496 at 80 MHz from flash, SLEEP, STOP 2 with RTC. */
+#define simMCU_RUN_MA                 ( 10.0 )
+#define simMCU_SLEEP_MA               ( 2.5 )
+#define simMCU_STOP_MA                ( 0.003 )
+
+/* Time at run current to leave SLEEP and STOP 2 (PLL restart). */
+#define simSLEEP_WAKE_MS              ( 0.02 )
+#define simSTOP_WAKE_MS               ( 0.15 )
+
+/* Longest SLEEP of the port with the SysTick on HCLK / 8, and longest STOP 2
+ * of the RTC wakeup timer on ck_spre (65536 periods of 1.024 s). */
+#define simMAX_SUPPRESSED_TICKS       ( 1677U )
+#define simMAX_STOP_TICKS             ( 67108864U )
+
+/* Ticks the MCU runs per wake up of the application or of a transfer. */
+#define simRUN_TICKS                  ( 1U )
+
+/* BG96 connected, idle between pagings, one paging, PSM. */
+#define simMODEM_CONNECTED_MA         ( 80.0 )
+#define simMODEM_IDLE_MA              ( 0.2 )
+#define simMODEM_PAGING_MA            ( 20.0 )
+#define simMODEM_PAGING_MS            ( 40.0 )
+#define simMODEM_PSM_MA               ( 0.01 )
+
+#define simDRX_CYCLE_MS               ( 1280U )
+#define simEDRX_CYCLE_UNIT_MS         ( 5120U )
+
+typedef enum SimConfig
+{
+    eSimTick = 0,
+    eSimSleep,
+    eSimPsm
+} SimConfig_t;
+
+typedef struct SimParams
+{
+    uint32_t ulPeriodMs;
+    uint32_t ulCycles;
+    uint32_t ulSessionMs;
+    uint32_t ulGapMs;
+    uint32_t ulTauSeconds;
+    uint32_t ulActiveSeconds;
+    uint32_t ulPagingCycleMs;
+    uint32_t ulWakeMs;
+} SimParams_t;
+
+typedef struct SimResult
+{
+    double dMcuMaMs;       /**< MCU charge in mA * ms. */
+    uint64_t ullWakeups;   /**< Interrupts taking the MCU out of idle. */
+    uint64_t ullStopMs;    /**< Time spent in STOP 2. */
+    uint64_t ullLostRx;    /**< Modem transfers that arrived during STOP 2. */
+} SimResult_t;
+
+/*-----------------------------------------------------------*/
+
+/* The simulation is single threaded; the kernel only provides the time. */
+static TickType_t xSimNow = 0;
+
+TickType_t xTaskGetTickCount( void )
+{
+    return xSimNow;
+}
+
+void vPortEnterCritical( void )
+{
+}
+
+void vPortExitCritical( void )
+{
+}
+
+void vAssertCalled( const char * pcFile,
+                    unsigned long ulLine )
+{
+    ( void ) fprintf( stderr, "ASSERT: %s:%lu\n", pcFile, ulLine );
+    abort();
+}
+
+/*-----------------------------------------------------------*/
+
+static uint32_t prvEdrxCycleMs( uint32_t ulEdrxValue )
+{
+    /* E-UTRAN cycle lengths of 3GPP TS 27.007, in units of 5.12 s. */
+    static const uint16_t usCycleUnits[ 16 ] =
+    {
+        1U, 2U, 4U, 8U, 12U, 16U, 20U, 24U, 28U, 32U, 64U, 128U, 256U, 512U, 1024U, 2048U
+    };
+
+    return simEDRX_CYCLE_UNIT_MS * usCycleUnits[ ulEdrxValue & 0x0FU ];
+}
+
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvIsTransfer( const SimParams_t * pxParams,
+                                 uint32_t ulTime )
+{
+    uint32_t ulInPeriod = ulTime % pxParams->ulPeriodMs;
+
+    return ( ( ulInPeriod < pxParams->ulSessionMs ) && ( ( ulInPeriod % pxParams->ulGapMs ) == 0U ) ) ? pdTRUE : pdFALSE;
+}
+
+/*-----------------------------------------------------------*/
+
+/* Next time the MCU has work after ulTime, and whether the modem caused it. */
+static uint32_t prvNextEvent( const SimParams_t * pxParams,
+                              uint32_t ulTime,
+                              BaseType_t * pxFromModem )
+{
+    uint32_t ulInPeriod = ulTime % pxParams->ulPeriodMs;
+    uint32_t ulNext = ulTime - ulInPeriod + pxParams->ulPeriodMs;
+    uint32_t ulTransfer = ulInPeriod - ( ulInPeriod % pxParams->ulGapMs ) + pxParams->ulGapMs;
+
+    *pxFromModem = pdFALSE;
+
+    /* Transfers of the session, the first one is sent by the application. */
+    if( ulTransfer < pxParams->ulSessionMs )
+    {
+        ulNext = ulTime - ulInPeriod + ulTransfer;
+        *pxFromModem = pdTRUE;
+    }
+
+    if( pxParams->ulWakeMs != 0U )
+    {
+        uint32_t ulWake = ulTime - ( ulTime % pxParams->ulWakeMs ) + pxParams->ulWakeMs;
+
+        if( ulWake < ulNext )
+        {
+            ulNext = ulWake;
+            *pxFromModem = pdFALSE;
+        }
+    }
+
+    return ulNext;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvRunMcu( const SimParams_t * pxParams,
+                       SimConfig_t eConfig,
+                       SimResult_t * pxResult )
+{
+    uint32_t ulEnd = pxParams->ulPeriodMs * pxParams->ulCycles;
+    uint32_t ulTime = 0U;
+    uint32_t ulNext;
+    TickType_t xIdle;
+    BaseType_t xFromModem;
+    LowPowerMode_t eMode;
+
+    ( void ) memset( pxResult, 0, sizeof( *pxResult ) );
+
+    xSimNow = 0;
+
+    if( eConfig == eSimPsm )
+    {
+        vLowPowerSetModemTimers( pxParams->ulTauSeconds, pxParams->ulActiveSeconds );
+    }
+    else
+    {
+        vLowPowerSetModemTimers( 0U, 0U );
+    }
+
+    while( ulTime < ulEnd )
+    {
+        /* Work of the current event; each one is a modem transfer, apart from
+         * the wake ups of the additional timer task. */
+        xSimNow = ( TickType_t ) ulTime;
+
+        if( prvIsTransfer( pxParams, ulTime ) == pdTRUE )
+        {
+            vLowPowerNotifyModemActivity();
+        }
+
+        pxResult->dMcuMaMs += simMCU_RUN_MA * simRUN_TICKS;
+        ulTime += simRUN_TICKS;
+
+        ulNext = prvNextEvent( pxParams, ulTime - 1U, &xFromModem );
+
+        if( ulNext > ulEnd )
+        {
+            ulNext = ulEnd;
+        }
+
+        if( eConfig == eSimTick )
+        {
+            pxResult->dMcuMaMs += simMCU_RUN_MA * ( double ) ( ulNext - ulTime );
+            pxResult->ullWakeups += ulNext - ulTime;
+            ulTime = ulNext;
+            continue;
+        }
+
+        /* Tickless idle until the next event, in sleeps of at most the
+         * longest suppression the SysTick or the RTC allows. */
+        while( ulTime < ulNext )
+        {
+            xSimNow = ( TickType_t ) ulTime;
+            xIdle = ( TickType_t ) ( ulNext - ulTime );
+
+            /* The kernel does not suppress a single tick. */
+            if( xIdle < 2U )
+            {
+                pxResult->dMcuMaMs += simMCU_RUN_MA * ( double ) xIdle;
+                ulTime += xIdle;
+                continue;
+            }
+
+            eMode = eLowPowerSelectMode( xSimNow, &xIdle );
+
+            if( ( eMode == eLowPowerSleep ) && ( xIdle > simMAX_SUPPRESSED_TICKS ) )
+            {
+                xIdle = simMAX_SUPPRESSED_TICKS;
+            }
+            else if( xIdle > simMAX_STOP_TICKS )
+            {
+                xIdle = simMAX_STOP_TICKS;
+            }
+            vLowPowerRecordSleep( eMode, xIdle );
+            pxResult->ullWakeups++;
+
+            if( eMode == eLowPowerStop )
+            {
+                pxResult->dMcuMaMs += ( simMCU_STOP_MA * ( double ) xIdle ) + ( simMCU_RUN_MA * simSTOP_WAKE_MS );
+                pxResult->ullStopMs += xIdle;
+
+                if( ( ( ulTime + xIdle ) == ulNext ) && ( xFromModem == pdTRUE ) &&
+                    ( ( ulNext % pxParams->ulPeriodMs ) != 0U ) )
+                {
+                    pxResult->ullLostRx++;
+                }
+            }
+            else
+            {
+                pxResult->dMcuMaMs += ( simMCU_SLEEP_MA * ( double ) xIdle ) + ( simMCU_RUN_MA * simSLEEP_WAKE_MS );
+            }
+
+            ulTime += xIdle;
+        }
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/* Modem charge in mA * ms, following the same timers as low_power.c. */
+static double prvRunModem( const SimParams_t * pxParams )
+{
+    uint32_t ulEnd = pxParams->ulPeriodMs * pxParams->ulCycles;
+    uint32_t ulTauMs = pxParams->ulTauSeconds * 1000U;
+    uint32_t ulActiveMs = pxParams->ulActiveSeconds * 1000U;
+    uint32_t ulLastActivity = 0U;
+    uint32_t ulSince;
+    uint32_t ulTime;
+    double dIdleMa = simMODEM_IDLE_MA + ( ( simMODEM_PAGING_MA * simMODEM_PAGING_MS ) / ( double ) pxParams->ulPagingCycleMs );
+    double dMaMs = 0.0;
+
+    if( ( ulTauMs != 0U ) && ( ulTauMs <= ( ulActiveMs + configLOW_POWER_RELEASE_MS ) ) )
+    {
+        ulTauMs = 0U;
+    }
+
+    for( ulTime = 0U; ulTime < ulEnd; ulTime++ )
+    {
+        if( prvIsTransfer( pxParams, ulTime ) == pdTRUE )
+        {
+            ulLastActivity = ulTime;
+        }
+
+        ulSince = ulTime - ulLastActivity;
+
+        if( ulTauMs != 0U )
+        {
+            ulSince %= ulTauMs;
+        }
+
+        if( ulSince < configLOW_POWER_RELEASE_MS )
+        {
+            dMaMs += simMODEM_CONNECTED_MA;
+        }
+        else if( ( ulTauMs == 0U ) || ( ulSince < ( configLOW_POWER_RELEASE_MS + ulActiveMs ) ) )
+        {
+            dMaMs += dIdleMa;
+        }
+        else
+        {
+            dMaMs += simMODEM_PSM_MA;
+        }
+    }
+
+    return dMaMs;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvPrintResult( const char * pcName,
+                            const SimParams_t * pxParams,
+                            const SimResult_t * pxResult,
+                            double dModemMaMs )
+{
+    double dTotalMs = ( double ) pxParams->ulPeriodMs * ( double ) pxParams->ulCycles;
+    double dMcuMj = ( pxResult->dMcuMaMs * simSUPPLY_V ) / ( 1000.0 * pxParams->ulCycles );
+    double dModemMj = ( dModemMaMs * simSUPPLY_V ) / ( 1000.0 * pxParams->ulCycles );
+
+    ( void ) printf( "%-6s %10llu %10.1f %10.1f %10.1f %10.1f %6.1f%% %6llu\n",
+                     pcName,
+                     ( unsigned long long ) ( pxResult->ullWakeups / pxParams->ulCycles ),
+                     dMcuMj,
+                     dModemMj,
+                     dMcuMj + dModemMj,
+                     ( ( pxResult->dMcuMaMs + dModemMaMs ) * 1000.0 ) / dTotalMs,
+                     ( ( double ) pxResult->ullStopMs * 100.0 ) / dTotalMs,
+                     ( unsigned long long ) pxResult->ullLostRx );
+}
+
+/*-----------------------------------------------------------*/
+
+int main( int argc,
+          char ** argv )
+{
+    SimParams_t xParams =
+    {
+        .ulPeriodMs      = 900000U,
+        .ulCycles        = 4U,
+        .ulSessionMs     = 5000U,
+        .ulGapMs         = 50U,
+        .ulTauSeconds    = 3600U,
+        .ulActiveSeconds = 60U,
+        .ulPagingCycleMs = simDRX_CYCLE_MS,
+        .ulWakeMs        = 0U
+    };
+    SimResult_t xResult;
+    double dModemMaMs;
+    int iArg;
+    uint32_t ulValue;
+
+    for( iArg = 1; ( iArg + 1 ) < argc; iArg += 2 )
+    {
+        ulValue = ( uint32_t ) strtoul( argv[ iArg + 1 ], NULL, 0 );
+
+        if( strcmp( argv[ iArg ], "-p" ) == 0 )
+        {
+            xParams.ulPeriodMs = ulValue * 1000U;
+        }
+        else if( strcmp( argv[ iArg ], "-n" ) == 0 )
+        {
+            xParams.ulCycles = ulValue;
+        }
+        else if( strcmp( argv[ iArg ], "-s" ) == 0 )
+        {
+            xParams.ulSessionMs = ulValue;
+        }
+        else if( strcmp( argv[ iArg ], "-g" ) == 0 )
+        {
+            xParams.ulGapMs = ulValue;
+        }
+        else if( strcmp( argv[ iArg ], "-t" ) == 0 )
+        {
+            xParams.ulTauSeconds = ulValue;
+        }
+        else if( strcmp( argv[ iArg ], "-a" ) == 0 )
+        {
+            xParams.ulActiveSeconds = ulValue;
+        }
+        else if( strcmp( argv[ iArg ], "-e" ) == 0 )
+        {
+            xParams.ulPagingCycleMs = prvEdrxCycleMs( ulValue );
+        }
+        else if( strcmp( argv[ iArg ], "-b" ) == 0 )
+        {
+            xParams.ulWakeMs = ulValue;
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    if( ( iArg < argc ) || ( xParams.ulCycles == 0U ) || ( xParams.ulGapMs == 0U ) ||
+        ( xParams.ulSessionMs >= xParams.ulPeriodMs ) )
+    {
+        ( void ) fprintf( stderr, "usage: %s [-p period_s] [-n cycles] [-s session_ms] [-g gap_ms]"
+                                  " [-t tau_s] [-a active_s] [-e edrx] [-b wake_ms]\n", argv[ 0 ] );
+        return EXIT_FAILURE;
+    }
+
+    ( void ) printf( "period %lu s, session %lu ms every %lu ms, TAU %lu s, active %lu s, paging %lu ms\n\n",
+                     ( unsigned long ) ( xParams.ulPeriodMs / 1000U ),
+                     ( unsigned long ) xParams.ulSessionMs,
+                     ( unsigned long ) xParams.ulGapMs,
+                     ( unsigned long ) xParams.ulTauSeconds,
+                     ( unsigned long ) xParams.ulActiveSeconds,
+                     ( unsigned long ) xParams.ulPagingCycleMs );
+    ( void ) printf( "%-6s %10s %10s %10s %10s %10s %7s %6s\n",
+                     "config", "wakes", "MCU mJ", "modem mJ", "total mJ", "avg uA", "STOP 2", "lost" );
+
+    dModemMaMs = prvRunModem( &xParams );
+
+    prvRunMcu( &xParams, eSimTick, &xResult );
+    prvPrintResult( "tick", &xParams, &xResult, dModemMaMs );
+
+    prvRunMcu( &xParams, eSimSleep, &xResult );
+    prvPrintResult( "sleep", &xParams, &xResult, dModemMaMs );
+
+    prvRunMcu( &xParams, eSimPsm, &xResult );
+    prvPrintResult( "psm", &xParams, &xResult, dModemMaMs );
+
+    return ( xResult.ullLostRx == 0U ) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/*-----------------------------------------------------------*/